@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "timer.h"
+
+// ----------------------------------------------------------------------------
+// Benchmark registry
+// ----------------------------------------------------------------------------
+
+static const struct BenchEntry {
+    const char *name;
+    const char *description;
+    Bench_Func func;
+} benchmarks[] = {
+        { "binds",    "texture binds of the first person scene in culling, texture and render queue order", Bench_Binds },
+        { "cluster",  "clustered light binning of 4096 point lights, checked by brute force", Bench_Cluster },
+        { "cull",     "BVH frustum culling of 100k objects vs brute force", Bench_Cull },
+        { "entity",   "SoA transform updates of 1M spinning entities vs per object raymath, handle churn", Bench_Entity },
+        { "job",      "job scheduler overhead per job, parallel-for speedup from 1 to N threads, dependencies", Bench_Job },
+        { "lightmap", "path traced light baking from 1 to N threads, light loop per fragment with the lightmap", Bench_Lightmap },
+        { "loader",   "parallel .glb parsing of data/models vs serial", Bench_Loader },
+        { "lod",      "LOD chain generation of the decorated props, triangles drawn walking a dense scene of them", Bench_Lod },
+        { "occlusion", "software occlusion culling of props in a level of walled rooms, checked by ray casts", Bench_Occlusion },
+        { "pack",     "cooked model pack vs .glb loading (--gpu=1 for the full LoadModel path)", Bench_Pack },
+        { "profiler", "profiler zone cost disabled / enabled, lock-free collection from 4 threads", Bench_Profiler },
+        { "quant",    "compact vertex layout of data/models, memory vs float and decode error", Bench_Quant },
+        { "raycast",  "SIMD packet DDA over a 1024x1024 tile map, rays per second vs scalar, threaded", Bench_Raycast },
+        { "rendergraph", "transient target aliasing, pass culling and skipping checked with stand-in textures", Bench_RenderGraph },
+        { "renderqueue", "record / radix sort / execute of 100k keyed draws, state changes vs submission order", Bench_RenderQueue },
+        { "sim",      "headless fixed timestep fast-forward, ticks per second and replay determinism", Bench_Sim },
+        { "str8",     "ui key hashing throughput and scratch arena formatting", Bench_Str8 },
+        { "tilemap",  "greedy meshed 4096x4096 tile map, per frame view cost vs a 512x512 map", Bench_TileMap },
+        { "ui",       "autolayout of a 10k widget tree rebuilt every frame", Bench_UI },
+};
+
+static const int benchmarkCount = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+// ----------------------------------------------------------------------------
+// Shared helpers
+// ----------------------------------------------------------------------------
+
+static u64 randomState = 0x9E3779B97F4A7C15ull;
+
+f64 Bench_Seconds(void) {
+    return Timer_Seconds();
+}
+
+void Bench_Seed(u64 seed) {
+    randomState = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+u32 Bench_RandomU32(void) {
+    // xorshift64*, deterministic across platforms unlike rand()
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return (u32) ((randomState * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+f32 Bench_RandomRange(f32 min, f32 max) {
+    return min + (max - min) * ((f32) Bench_RandomU32() / 4294967296.0f);
+}
+
+const char *Bench_ArgString(int argc, char **argv, const char *name, const char *fallback) {
+    size_t length = strlen(name);
+    for (int i = 0; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--", 2) == 0 && strncmp(arg + 2, name, length) == 0 && arg[2 + length] == '=') {
+            return arg + 3 + length;
+        }
+    }
+    return fallback;
+}
+
+i64 Bench_ArgInt(int argc, char **argv, const char *name, i64 fallback) {
+    const char *value = Bench_ArgString(argc, argv, name, NULL);
+    return value ? strtoll(value, NULL, 10) : fallback;
+}
+
+void Bench_Report(const char *name, f64 value, const char *unit) {
+    printf("  %-32s %14.4f %s\n", name, value, unit);
+}
+
+// ----------------------------------------------------------------------------
+// Entry point
+// ----------------------------------------------------------------------------
+
+static void PrintUsage(const char *program) {
+    printf("usage: %s <benchmark|all> [--option=value ...]\n\n", program);
+    for (int i = 0; i < benchmarkCount; i++) {
+        printf("  %-12s %s\n", benchmarks[i].name, benchmarks[i].description);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    b8 runAll = (strcmp(argv[1], "all") == 0);
+    int result = 0;
+    b8 found = false;
+    for (int i = 0; i < benchmarkCount; i++) {
+        if (runAll || strcmp(argv[1], benchmarks[i].name) == 0) {
+            found = true;
+            printf("[%s]\n", benchmarks[i].name);
+            result |= benchmarks[i].func(argc - 2, argv + 2);
+        }
+    }
+
+    if (!found) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef FIDDLE_BENCH_H
+#define FIDDLE_BENCH_H
+
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Headless benchmarks
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - each benchmark is a subcommand of the fiddle-bench executable, eg. 'fiddle-bench cull'
+// - benchmarks never open a window or create a GL context, so they run on any box
+// - results are printed as 'name: value unit' lines so they're easy to diff between commits
+
+typedef int (*Bench_Func)(int argc, char **argv);
+
+// timing + deterministic random helpers shared by all benchmarks
+f64 Bench_Seconds(void);
+void Bench_Seed(u64 seed);
+u32 Bench_RandomU32(void);
+f32 Bench_RandomRange(f32 min, f32 max);
+
+// read an option of the form '--name=value', returns fallback if not present
+i64 Bench_ArgInt(int argc, char **argv, const char *name, i64 fallback);
+const char *Bench_ArgString(int argc, char **argv, const char *name, const char *fallback);
+
+void Bench_Report(const char *name, f64 value, const char *unit);
+
+// benchmark entry points
+int Bench_Binds(int argc, char **argv);
+int Bench_Cluster(int argc, char **argv);
+int Bench_Cull(int argc, char **argv);
+int Bench_Entity(int argc, char **argv);
+int Bench_Job(int argc, char **argv);
+int Bench_Lightmap(int argc, char **argv);
+int Bench_Loader(int argc, char **argv);
+int Bench_Lod(int argc, char **argv);
+int Bench_Occlusion(int argc, char **argv);
+int Bench_Pack(int argc, char **argv);
+int Bench_Profiler(int argc, char **argv);
+int Bench_Quant(int argc, char **argv);
+int Bench_Raycast(int argc, char **argv);
+int Bench_RenderGraph(int argc, char **argv);
+int Bench_RenderQueue(int argc, char **argv);
+int Bench_Sim(int argc, char **argv);
+int Bench_Str8(int argc, char **argv);
+int Bench_TileMap(int argc, char **argv);
+int Bench_UI(int argc, char **argv);
+
+#endif //FIDDLE_BENCH_H
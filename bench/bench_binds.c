@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "bench.h"
+#include "cull.h"
+#include "level.h"
+#include "renderqueue.h"
+
+// ----------------------------------------------------------------------------
+// Texture bind benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - the first person scene's layout: the level's boxes (see level.h) on raylib's default texture, each model
+//   with a material of its own, and a gallery of props behind the trees sharing the one atlas texture of
+//   data/models, culled with the BVH from the framebench path's first person keys
+// - texture binds are counted the way batch.c counts them, a change of diffuse texture between consecutive draws,
+//   for three draw orders: culling order, batched groups sorted by texture (what Batch_End() did before the
+//   render queue) and render queue key order (what the first person pass does now)
+// - batched draws are one per group of (mesh, material), groups drawn in the order they first show up
+// - the CPU cost of each ordering is timed per frame, GPU frame times need a GL context, compare
+//   'fiddle --benchmark' runs instead, the report has texture binds per frame next to the pass times
+
+enum BenchBindsConstExpr {
+    BENCH_BINDS_DEFAULT_TEXTURE = 1,
+    BENCH_BINDS_ATLAS_TEXTURE = 2,
+    BENCH_BINDS_GALLERY_COLUMNS = 20,
+    BENCH_BINDS_MAX_OBJECTS = LEVEL_MAX_BOXES + 1024,
+};
+
+struct BenchObject {
+    BoundingBox bounds;
+    u32 model;                          // mesh and material, trees share theirs, everything else has its own
+    u32 texture;
+};
+
+struct BenchScene {
+    struct BenchObject objects[BENCH_BINDS_MAX_OBJECTS];
+    MaterialMap maps[BENCH_BINDS_MAX_OBJECTS];      // diffuse map of each model's material
+    u32 objectCount;
+    u32 modelCount;
+};
+
+// first person keys of main.c's benchmark path
+static const struct BenchView {
+    Vector3 eye;
+    Vector3 target;
+} benchViews[] = {
+        { {  -3.0f,  3.0f,   0.0f }, {  0.0f, 2.25f, 0.0f } },
+        { { -15.0f,  4.0f, -15.0f }, {  0.0f, 2.00f, 0.0f } },
+        { {   0.0f,  8.0f, -22.0f }, {  0.0f, 1.00f, 0.0f } },
+        { {  18.0f,  3.0f,  -5.0f }, { -5.0f, 2.00f, 5.0f } },
+        { {  10.0f,  2.0f,  15.0f }, {  0.0f, 2.00f, 0.0f } },
+        { { -10.0f, 12.0f,  10.0f }, {  0.0f, 0.00f, 0.0f } },
+};
+
+static void AddObject(struct BenchScene *scene, Vector3 center, Vector3 size, u32 model, u32 texture) {
+    if (scene->objectCount >= BENCH_BINDS_MAX_OBJECTS) return;
+    Vector3 half = Vector3Scale(size, 0.5f);
+    scene->objects[scene->objectCount++] = (struct BenchObject) {
+            .bounds = { Vector3Subtract(center, half), Vector3Add(center, half) },
+            .model = model,
+            .texture = texture
+    };
+    scene->maps[model].texture.id = texture;
+    if (model >= scene->modelCount) scene->modelCount = model + 1;
+}
+
+static void BuildScene(struct BenchScene *scene, u32 props) {
+    static Level_Box boxes[LEVEL_MAX_BOXES];
+    u32 boxCount = Level_StaticBoxes(Level_StartingRoom, boxes, LEVEL_MAX_BOXES);
+    if (boxCount > LEVEL_MAX_BOXES) boxCount = LEVEL_MAX_BOXES;
+
+    // ground, trunk and canopy models are shared, walls get one each, like AddLevel() in main.c
+    u32 wallModel = 3;
+    for (u32 i = 0; i < boxCount; i++) {
+        u32 model = (boxes[i].kind == Level_Box_Wall) ? wallModel++ : (u32) boxes[i].kind;
+        AddObject(scene, boxes[i].center, boxes[i].size, model, BENCH_BINDS_DEFAULT_TEXTURE);
+    }
+
+    // the coin, then the gallery rows behind the tree grid and the wall
+    AddObject(scene, (Vector3) { 0, 3, 0 }, (Vector3) { 1, 1, 0.2f }, wallModel, BENCH_BINDS_ATLAS_TEXTURE);
+    for (u32 i = 0; i < props; i++) {
+        Vector3 position = {
+                -30 + (f32) (i % BENCH_BINDS_GALLERY_COLUMNS) * 3,
+                0.5f,
+                30 + (f32) (i / BENCH_BINDS_GALLERY_COLUMNS) * 3
+        };
+        AddObject(scene, position, (Vector3) { 1, 1, 1 }, wallModel + 1 + i, BENCH_BINDS_ATLAS_TEXTURE);
+    }
+}
+
+static u32 CountBinds(const struct BenchScene *scene, const u32 *order, u32 count) {
+    u32 bound = 0, binds = 0;
+    for (u32 i = 0; i < count; i++) {
+        u32 texture = scene->objects[order[i]].texture;
+        binds += texture != bound;
+        bound = texture;
+    }
+    return binds;
+}
+
+// one draw per model, in the order each model first shows up
+static u32 GroupDraws(const struct BenchScene *scene, const u32 *order, u32 count, u32 *groups, u8 *seen) {
+    for (u32 i = 0; i < scene->modelCount; i++) seen[i] = 0;
+    u32 groupCount = 0;
+    for (u32 i = 0; i < count; i++) {
+        u32 model = scene->objects[order[i]].model;
+        if (seen[model]) continue;
+        seen[model] = 1;
+        groups[groupCount++] = order[i];
+    }
+    return groupCount;
+}
+
+static const struct BenchScene *sortScene;
+
+// texture, then group creation order, like CompareGroupTextures() did
+static int CompareGroupTextures(const void *a, const void *b) {
+    const struct BenchObject *objectA = &sortScene->objects[*(const u32 *) a];
+    const struct BenchObject *objectB = &sortScene->objects[*(const u32 *) b];
+    if (objectA->texture != objectB->texture) return (objectA->texture < objectB->texture) ? -1 : 1;
+    return (objectA->model > objectB->model) - (objectA->model < objectB->model);
+}
+
+struct BenchQueueOrder {
+    u32 *order;
+    u32 count;
+};
+
+static void CollectDraw(u64 key, const void *payload, void *user) {
+    (void) key;
+    struct BenchQueueOrder *queued = user;
+    queued->order[queued->count++] = *(const u32 *) payload;
+}
+
+int Bench_Binds(int argc, char **argv) {
+    const u32 props = (u32) Bench_ArgInt(argc, argv, "props", 203);
+    const u32 frames = (u32) Bench_ArgInt(argc, argv, "frames", 1000);
+    const f32 aspect = 640.0f / 720.0f; // one half of the split screen view
+
+    static struct BenchScene scene;
+    BuildScene(&scene, props);
+
+    BoundingBox *bounds = malloc(scene.objectCount * sizeof(BoundingBox));
+    u32 *visible = malloc(scene.objectCount * sizeof(u32));
+    u32 *groups = malloc(scene.objectCount * sizeof(u32));
+    u32 *queued = malloc(scene.objectCount * sizeof(u32));
+    u8 *seen = malloc(scene.modelCount);
+    for (u32 i = 0; i < scene.objectCount; i++) bounds[i] = scene.objects[i].bounds;
+    Cull_BVH *bvh = Cull_BVHBuild(bounds, scene.objectCount);
+    RenderQueue_Init();
+    sortScene = &scene;
+
+    u64 draws = 0, culledBinds = 0, culledGroupBinds = 0, textureGroupBinds = 0, queueBinds = 0, queueGroupBinds = 0;
+    u64 groupCount = 0;
+    f64 textureSeconds = 0, queueSeconds = 0;
+    const u32 viewCount = sizeof(benchViews) / sizeof(benchViews[0]);
+    for (u32 frame = 0; frame < frames; frame++) {
+        const struct BenchView *view = &benchViews[frame % viewCount];
+        Camera3D camera = { .position = view->eye, .target = view->target, .up = { 0, 1, 0 }, .fovy = 45 };
+        Cull_Frustum frustum = Cull_FrustumFromCamera(camera, aspect);
+        u32 count = Cull_BVHQuery(bvh, &frustum, visible, scene.objectCount, NULL);
+        if (count > scene.objectCount) count = scene.objectCount;
+
+        // culling order, before anything sorted draws
+        u32 groupsDrawn = GroupDraws(&scene, visible, count, groups, seen);
+        draws += count;
+        groupCount += groupsDrawn;
+        culledBinds += CountBinds(&scene, visible, count);
+        culledGroupBinds += CountBinds(&scene, groups, groupsDrawn);
+
+        // batched groups sorted by texture
+        f64 start = Bench_Seconds();
+        qsort(groups, groupsDrawn, sizeof(u32), CompareGroupTextures);
+        textureSeconds += Bench_Seconds() - start;
+        textureGroupBinds += CountBinds(&scene, groups, groupsDrawn);
+
+        // render queue keys, recorded in culling order like DrawFirstPersonPass() does
+        start = Bench_Seconds();
+        RenderQueue_Begin();
+        for (u32 i = 0; i < count; i++) {
+            const struct BenchObject *object = &scene.objects[visible[i]];
+            Material material = { .maps = &scene.maps[object->model] };
+            Vector3 center = Vector3Lerp(object->bounds.min, object->bounds.max, 0.5f);
+            f32 depth = Clamp(Vector3Distance(center, view->eye) / 100.0f, 0, 1);
+            u64 key = RenderQueue_Key(0, RenderQueue_Layer_Opaque, 1, RenderQueue_MaterialId(material), object->model, depth);
+            u32 *payload = RenderQueue_Push(0, key, sizeof(u32));
+            if (payload != NULL) *payload = visible[i];
+        }
+        RenderQueue_Sort();
+        struct BenchQueueOrder order = { queued, 0 };
+        RenderQueue_Execute(CollectDraw, &order);
+        queueSeconds += Bench_Seconds() - start;
+
+        queueBinds += CountBinds(&scene, queued, order.count);
+        queueGroupBinds += CountBinds(&scene, groups, GroupDraws(&scene, queued, order.count, groups, seen));
+    }
+
+    Bench_Report("objects", scene.objectCount, "");
+    Bench_Report("draws (avg)", (f64) draws / frames, "");
+    Bench_Report("batched groups (avg)", (f64) groupCount / frames, "");
+    Bench_Report("binds, culling order", (f64) culledBinds / frames, "");
+    Bench_Report("binds, queue order", (f64) queueBinds / frames, "");
+    Bench_Report("batched binds, culling order", (f64) culledGroupBinds / frames, "");
+    Bench_Report("batched binds, texture order", (f64) textureGroupBinds / frames, "");
+    Bench_Report("batched binds, queue order", (f64) queueGroupBinds / frames, "");
+    Bench_Report("texture sort (per frame)", textureSeconds * 1e6 / frames, "us");
+    Bench_Report("queue record + sort (per frame)", queueSeconds * 1e6 / frames, "us");
+
+    RenderQueue_Shutdown();
+    Cull_BVHUnload(bvh);
+    free(seen);
+    free(queued);
+    free(groups);
+    free(visible);
+    free(bounds);
+    return 0;
+}
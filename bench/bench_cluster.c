@@ -0,0 +1,184 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "bench.h"
+#include "cluster.h"
+
+// ----------------------------------------------------------------------------
+// Clustered light binning benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - point lights are scattered over a 400x400 unit area around the camera, most of them
+//   are off screen or past the far slice in any given frame, like lights in a large level
+// - the camera turns a full circle over the run, so every direction is sampled
+// - every few frames the binning is validated: listed lights must touch their cluster's bounds,
+//   and random points inside each light must find it in the cluster the shader would look in
+
+enum BenchClusterConstExpr {
+    BENCH_CLUSTER_MAX_LIST = 4096,
+    BENCH_CLUSTER_SAMPLES = 64,         // points tested inside each light when validating
+};
+
+static Cluster_Light RandomLight(void) {
+    return (Cluster_Light) {
+            .position = {
+                    Bench_RandomRange(-200, 200),
+                    Bench_RandomRange(0, 10),
+                    Bench_RandomRange(-200, 200)
+            },
+            .radius = Bench_RandomRange(1, 8),
+            .color = { (u8) Bench_RandomU32(), (u8) Bench_RandomU32(), (u8) Bench_RandomU32(), 255 },
+            .intensity = 1
+    };
+}
+
+static f32 DistanceSqToBox(Vector3 point, BoundingBox box) {
+    f32 dx = fmaxf(box.min.x - point.x, 0) + fmaxf(point.x - box.max.x, 0);
+    f32 dy = fmaxf(box.min.y - point.y, 0) + fmaxf(point.y - box.max.y, 0);
+    f32 dz = fmaxf(box.min.z - point.z, 0) + fmaxf(point.z - box.max.z, 0);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+static b8 Listed(const u32 *list, u32 count, u32 light) {
+    for (u32 i = 0; i < count; i++) {
+        if (list[i] == light) return true;
+    }
+    return false;
+}
+
+// returns the number of binning errors found for one camera
+static u32 Validate(Camera3D camera, f32 aspect, Vector3 *viewPositions, u32 *list) {
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    u32 lightCount = Cluster_LightCount();
+    for (u32 i = 0; i < lightCount; i++) {
+        viewPositions[i] = Vector3Transform(Cluster_GetLight(i).position, view);
+    }
+
+    // every listed light must actually reach the cluster's bounds
+    u32 errors = 0;
+    for (u32 cluster = 0; cluster < Cluster_ClusterCount(); cluster++) {
+        BoundingBox bounds = Cluster_GetClusterBounds(cluster);
+        u32 count = Cluster_GetClusterLights(cluster, list, BENCH_CLUSTER_MAX_LIST);
+        if (count > BENCH_CLUSTER_MAX_LIST) count = BENCH_CLUSTER_MAX_LIST;
+
+        for (u32 i = 0; i < count; i++) {
+            f32 radius = Cluster_GetLight(list[i]).radius;
+            if (DistanceSqToBox(viewPositions[list[i]], bounds) > radius * radius * 1.001f) errors++;
+        }
+    }
+
+    // the cluster bounds are loose boxes around the froxels, so misses are checked the way the shader
+    // sees them: points just inside each light must find it in the cluster they land in
+    f32 tanHalfFovY = tanf(camera.fovy * 0.5f * DEG2RAD);
+    f32 tanHalfFovX = tanHalfFovY * aspect;
+    f32 farDepth = -Cluster_GetClusterBounds(Cluster_ClusterCount() - 1).min.z;
+    for (u32 light = 0; light < lightCount; light++) {
+        f32 radius = Cluster_GetLight(light).radius * 0.99f;
+        for (int sample = 0; sample < BENCH_CLUSTER_SAMPLES; sample++) {
+            Vector3 offset = { Bench_RandomRange(-1, 1), Bench_RandomRange(-1, 1), Bench_RandomRange(-1, 1) };
+            if (Vector3LengthSqr(offset) > 1.0f) continue;
+
+            Vector3 point = Vector3Add(viewPositions[light], Vector3Scale(offset, radius));
+            f32 depth = -point.z;
+            if (depth <= 0.0f || depth > farDepth) continue;
+
+            Vector2 ndc = { point.x / (depth * tanHalfFovX), point.y / (depth * tanHalfFovY) };
+            if (fabsf(ndc.x) > 1.0f || fabsf(ndc.y) > 1.0f) continue;
+
+            u32 cluster = Cluster_ClusterAt(ndc, depth);
+            u32 count = Cluster_GetClusterLights(cluster, list, BENCH_CLUSTER_MAX_LIST);
+            if (count > BENCH_CLUSTER_MAX_LIST) count = BENCH_CLUSTER_MAX_LIST;
+            if (!Listed(list, count, light)) errors++;
+        }
+    }
+    return errors;
+}
+
+int Bench_Cluster(int argc, char **argv) {
+    const u32 lightCount = (u32) Bench_ArgInt(argc, argv, "lights", 4096);
+    const int iterations = (int) Bench_ArgInt(argc, argv, "iterations", 200);
+    const int validateEvery = (int) Bench_ArgInt(argc, argv, "validate", 25);
+    const f32 aspect = 640.0f / 720.0f; // one half of the split screen view
+
+    Bench_Seed(1);
+    Cluster_Init(lightCount);
+    for (u32 i = 0; i < lightCount; i++) {
+        Cluster_AddLight(RandomLight());
+    }
+
+    Vector3 *viewPositions = malloc(lightCount * sizeof(Vector3));
+    u32 *list = malloc(BENCH_CLUSTER_MAX_LIST * sizeof(u32));
+
+    f64 binTime = 0;
+    f64 worstTime = 0;
+    u64 binnedTotal = 0;
+    u64 indicesTotal = 0;
+    u64 litTotal = 0;
+    u64 testsTotal = 0;
+    u32 maxClusterLights = 0;
+    u32 dropped = 0;
+    u32 errors = 0;
+    int validated = 0;
+
+    for (int i = 0; i < iterations; i++) {
+        f32 angle = 2.0f * PI * (f32) i / (f32) iterations;
+        Camera3D camera = {
+                .position = { 0, 3, 0 },
+                .target = { cosf(angle), 3, sinf(angle) },
+                .up = { 0, 1, 0 },
+                .fovy = 45,
+                .projection = CAMERA_PERSPECTIVE
+        };
+
+        f64 start = Bench_Seconds();
+        Cluster_BinLights(camera, aspect);
+        f64 elapsed = Bench_Seconds() - start;
+        binTime += elapsed;
+        if (elapsed > worstTime) worstTime = elapsed;
+
+        Cluster_Stats stats = Cluster_GetStats();
+        binnedTotal += stats.lightsBinned;
+        indicesTotal += stats.indices;
+        litTotal += stats.clustersLit;
+        testsTotal += stats.clustersTested;
+        dropped += stats.indicesDropped;
+        if (stats.maxClusterLights > maxClusterLights) maxClusterLights = stats.maxClusterLights;
+
+        if (validateEvery > 0 && i % validateEvery == 0 && stats.indicesDropped == 0) {
+            errors += Validate(camera, aspect, viewPositions, list);
+            validated++;
+        }
+    }
+
+    f64 avgLit = (f64) litTotal / iterations;
+    Bench_Report("lights", lightCount, "");
+    Bench_Report("clusters", Cluster_ClusterCount(), "");
+    Bench_Report("bin lights (per frame)", binTime * 1000.0 / iterations, "ms");
+    Bench_Report("bin lights (worst frame)", worstTime * 1000.0, "ms");
+    Bench_Report("lights binned (avg)", (f64) binnedTotal / iterations, "");
+    Bench_Report("sphere tests (avg)", (f64) testsTotal / iterations, "");
+    Bench_Report("light indices (avg)", (f64) indicesTotal / iterations, "");
+    Bench_Report("lit clusters (avg)", avgLit, "");
+    Bench_Report("lights per lit cluster (avg)", avgLit > 0 ? (f64) indicesTotal / iterations / avgLit : 0, "");
+    Bench_Report("lights per cluster (max)", maxClusterLights, "");
+    Bench_Report("frames validated", validated, "");
+
+    free(list);
+    free(viewPositions);
+    Cluster_Unload();
+
+    if (dropped > 0) {
+        printf("  ERROR: %u light indices didn't fit in the index list\n", dropped);
+        return 1;
+    }
+    if (errors > 0) {
+        printf("  ERROR: %u binning errors against the brute force checks\n", errors);
+        return 1;
+    }
+    return 0;
+}
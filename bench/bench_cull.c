@@ -0,0 +1,122 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "bench.h"
+#include "cull.h"
+
+// ----------------------------------------------------------------------------
+// BVH frustum culling benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - objects are scattered over a 1000x1000 unit ground area, like props in a large level
+// - the camera sits in the middle and turns a full circle over the run, so every direction is sampled
+// - a slice of the objects move each frame to exercise the refit path (like the rotating coin)
+// - BVH results are checked against the brute force test, they must match exactly
+
+static BoundingBox RandomBox(void) {
+    Vector3 center = {
+            Bench_RandomRange(-500, 500),
+            Bench_RandomRange(0, 10),
+            Bench_RandomRange(-500, 500)
+    };
+    Vector3 half = {
+            Bench_RandomRange(0.25f, 2),
+            Bench_RandomRange(0.25f, 2),
+            Bench_RandomRange(0.25f, 2)
+    };
+    return (BoundingBox) { Vector3Subtract(center, half), Vector3Add(center, half) };
+}
+
+int Bench_Cull(int argc, char **argv) {
+    const u32 objectCount = (u32) Bench_ArgInt(argc, argv, "objects", 100000);
+    const u32 dynamicCount = (u32) Bench_ArgInt(argc, argv, "dynamic", objectCount / 100);
+    const int iterations = (int) Bench_ArgInt(argc, argv, "iterations", 200);
+    const f32 aspect = 640.0f / 720.0f; // one half of the split screen view
+
+    Bench_Seed(1);
+    BoundingBox *boxes = malloc(objectCount * sizeof(BoundingBox));
+    u32 *visible = malloc(objectCount * sizeof(u32));
+    for (u32 i = 0; i < objectCount; i++) {
+        boxes[i] = RandomBox();
+    }
+
+    f64 start = Bench_Seconds();
+    Cull_BVH *bvh = Cull_BVHBuild(boxes, objectCount);
+    f64 buildTime = Bench_Seconds() - start;
+
+    f64 bruteTime = 0;
+    f64 queryTime = 0;
+    f64 refitTime = 0;
+    u64 visibleTotal = 0;
+    u64 nodesTotal = 0;
+    int mismatches = 0;
+
+    for (int i = 0; i < iterations; i++) {
+        f32 angle = 2.0f * PI * (f32) i / (f32) iterations;
+        Camera3D camera = {
+                .position = { 0, 3, 0 },
+                .target = { cosf(angle), 3, sinf(angle) },
+                .up = { 0, 1, 0 },
+                .fovy = 45,
+                .projection = CAMERA_PERSPECTIVE
+        };
+        Cull_Frustum frustum = Cull_FrustumFromCamera(camera, aspect);
+
+        // move the dynamic slice
+        start = Bench_Seconds();
+        for (u32 j = 0; j < dynamicCount; j++) {
+            u32 object = (j * 7919u) % objectCount;
+            BoundingBox box = boxes[object];
+            Vector3 offset = { sinf(angle + (f32) j) * 0.1f, 0, cosf(angle + (f32) j) * 0.1f };
+            box.min = Vector3Add(box.min, offset);
+            box.max = Vector3Add(box.max, offset);
+            boxes[object] = box;
+            Cull_BVHUpdateObject(bvh, object, box);
+        }
+        Cull_BVHRefit(bvh);
+        refitTime += Bench_Seconds() - start;
+
+        start = Bench_Seconds();
+        u32 bruteVisible = 0;
+        for (u32 j = 0; j < objectCount; j++) {
+            bruteVisible += Cull_FrustumTestBox(&frustum, boxes[j]);
+        }
+        bruteTime += Bench_Seconds() - start;
+
+        Cull_Stats stats;
+        start = Bench_Seconds();
+        u32 bvhVisible = Cull_BVHQuery(bvh, &frustum, visible, objectCount, &stats);
+        queryTime += Bench_Seconds() - start;
+
+        if (bvhVisible != bruteVisible) mismatches++;
+        visibleTotal += bvhVisible;
+        nodesTotal += stats.nodesVisited;
+    }
+
+    f64 avgVisible = (f64) visibleTotal / iterations;
+    Bench_Report("objects", objectCount, "");
+    Bench_Report("dynamic objects", dynamicCount, "");
+    Bench_Report("bvh build", buildTime * 1000.0, "ms");
+    Bench_Report("refit (per frame)", refitTime * 1000.0 / iterations, "ms");
+    Bench_Report("brute force cull (per frame)", bruteTime * 1000.0 / iterations, "ms");
+    Bench_Report("bvh cull (per frame)", queryTime * 1000.0 / iterations, "ms");
+    Bench_Report("bvh speedup", bruteTime / queryTime, "x");
+    Bench_Report("nodes visited (avg)", (f64) nodesTotal / iterations, "");
+    Bench_Report("visible (avg)", avgVisible, "");
+    Bench_Report("culled", 100.0 * (1.0 - avgVisible / objectCount), "%");
+
+    Cull_BVHUnload(bvh);
+    free(visible);
+    free(boxes);
+
+    if (mismatches > 0) {
+        printf("  ERROR: bvh and brute force results differ in %i of %i frames\n", mismatches, iterations);
+        return 1;
+    }
+    return 0;
+}
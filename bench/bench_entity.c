@@ -0,0 +1,157 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "bench.h"
+#include "entity.h"
+
+// ----------------------------------------------------------------------------
+// Entity transform benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - 1M spinning entities updated every frame by Entity_Update() against the same update done per object with
+//   raymath on an array of structs, the way the coin is animated in main.c
+// - both paths start from the same entities, the largest difference between their world matrices is reported
+//   so a faster kernel that computes something else doesn't go unnoticed, the SSE path rounds differently from
+//   raymath, so they're not bit identical, past a tolerance that grows with the frames run the benchmark fails
+// - handles are checked by destroying a random half of the entities and creating as many again, every handle
+//   kept must still find its entity and every destroyed one must be rejected
+
+// per frame of rotation integrated, a few float ulps on matrix entries up to the largest scale of 2
+static const f64 BENCH_ENTITY_TOLERANCE_PER_FRAME = 5e-7;
+
+struct BenchObject {
+    Vector3 position;
+    Quaternion rotation;
+    f32 scale;
+    Vector3 angularVelocity;
+    u32 model;
+    Matrix world;
+};
+
+static Entity_Desc RandomEntity(void) {
+    Vector3 axis = { Bench_RandomRange(-1, 1), Bench_RandomRange(-1, 1), Bench_RandomRange(-1, 1) };
+    return (Entity_Desc) {
+            .position = { Bench_RandomRange(-500, 500), Bench_RandomRange(0, 10), Bench_RandomRange(-500, 500) },
+            .rotation = QuaternionFromAxisAngle(axis, Bench_RandomRange(0, 2 * PI)),
+            .scale = Bench_RandomRange(0.5f, 2),
+            .angularVelocity = Vector3Scale(Vector3Normalize(axis), Bench_RandomRange(0, 2 * PI)),
+            .model = Bench_RandomU32() % 16
+    };
+}
+
+// what animating each object with raymath looks like
+static void UpdateObject(struct BenchObject *object, f32 dt) {
+    Vector3 spin = Vector3Scale(object->angularVelocity, 0.5f * dt);
+    Quaternion step = QuaternionMultiply((Quaternion) { spin.x, spin.y, spin.z, 0 }, object->rotation);
+    object->rotation = QuaternionNormalize(QuaternionAdd(object->rotation, step));
+
+    Matrix matScale = MatrixScale(object->scale, object->scale, object->scale);
+    Matrix matTranslation = MatrixTranslate(object->position.x, object->position.y, object->position.z);
+    object->world = MatrixMultiply(MatrixMultiply(matScale, QuaternionToMatrix(object->rotation)), matTranslation);
+}
+
+int Bench_Entity(int argc, char **argv) {
+    const u32 entityCount = (u32) Bench_ArgInt(argc, argv, "entities", 1000000);
+    const u32 frames = (u32) Bench_ArgInt(argc, argv, "frames", 20);
+    const f32 dt = 1.0f / 60.0f;
+
+    Entity_Store *store = Entity_StoreCreate(entityCount);
+    struct BenchObject *objects = malloc(entityCount * sizeof(struct BenchObject));
+    Entity_Handle *handles = malloc(entityCount * sizeof(Entity_Handle));
+    if (store == NULL || objects == NULL || handles == NULL) {
+        printf("  ERROR: out of memory for %u entities\n", entityCount);
+        Entity_StoreUnload(store);
+        free(objects);
+        free(handles);
+        return 1;
+    }
+
+    Bench_Seed(22);
+    for (u32 i = 0; i < entityCount; i++) {
+        Entity_Desc desc = RandomEntity();
+        handles[i] = Entity_Create(store, desc);
+        objects[i] = (struct BenchObject) {
+                desc.position, desc.rotation, desc.scale, desc.angularVelocity, desc.model, MatrixIdentity()
+        };
+    }
+
+    f64 soaSeconds = 0, aosSeconds = 0;
+    for (u32 frame = 0; frame < frames; frame++) {
+        f64 start = Bench_Seconds();
+        Entity_Update(store, dt);
+        soaSeconds += Bench_Seconds() - start;
+
+        start = Bench_Seconds();
+        for (u32 i = 0; i < entityCount; i++) {
+            UpdateObject(&objects[i], dt);
+        }
+        aosSeconds += Bench_Seconds() - start;
+    }
+
+    // nothing's been destroyed yet, so entity i is still at index i
+    Entity_Arrays arrays = Entity_GetArrays(store);
+    f64 maxDifference = 0;
+    for (u32 i = 0; i < entityCount; i++) {
+        const f32 *soa = (const f32 *) &arrays.world[i];
+        const f32 *aos = (const f32 *) &objects[i].world;
+        for (u32 m = 0; m < 16; m++) {
+            maxDifference = fmax(maxDifference, fabsf(soa[m] - aos[m]));
+        }
+    }
+
+    // churn: destroy a random half, create as many again, then look every handle up
+    u32 destroyed = 0;
+    for (u32 i = 0; i < entityCount; i++) {
+        if (Bench_RandomU32() & 1) {
+            Entity_Destroy(store, handles[i]);
+            destroyed++;
+        }
+    }
+    for (u32 i = 0; i < destroyed; i++) {
+        Entity_Create(store, RandomEntity());
+    }
+
+    arrays = Entity_GetArrays(store);
+    u32 broken = 0;
+    for (u32 i = 0; i < entityCount; i++) {
+        u32 index = Entity_Index(store, handles[i]);
+        if (index == ENTITY_MAX_CAPACITY) continue;
+        // a kept entity hasn't been updated since, so its matrix still matches the raymath one
+        broken += arrays.world[index].m12 != objects[i].world.m12 || arrays.handles[index] != handles[i];
+    }
+    u32 alive = 0;
+    for (u32 i = 0; i < entityCount; i++) alive += Entity_IsAlive(store, handles[i]);
+
+    const f64 perFrame = 1000.0 / frames;
+    Bench_Report("entities", entityCount, "");
+    Bench_Report("per object raymath, AoS", aosSeconds * perFrame, "ms");
+    Bench_Report("Entity_Update, SoA", soaSeconds * perFrame, "ms");
+    Bench_Report("Entity_Update per entity", soaSeconds * 1e9 / ((f64) frames * entityCount), "ns");
+    Bench_Report("speedup", aosSeconds / soaSeconds, "x");
+    const f64 tolerance = BENCH_ENTITY_TOLERANCE_PER_FRAME * frames;
+    Bench_Report("max world matrix difference", maxDifference * 1e6, "x 1e-6");
+    Bench_Report("  tolerance", tolerance * 1e6, "x 1e-6");
+    Bench_Report("handles alive after churn", alive, "");
+    Bench_Report("handles destroyed", destroyed, "");
+    broken += alive + destroyed != entityCount;
+    Bench_Report("handles broken (should be 0)", broken, "");
+
+    Entity_StoreUnload(store);
+    free(objects);
+    free(handles);
+
+    if (maxDifference > tolerance) {
+        printf("  ERROR: SoA matrices differ from raymath by %g, more than %g\n", maxDifference, tolerance);
+        return 1;
+    }
+    if (broken > 0) {
+        printf("  ERROR: %u handles broken by the churn\n", broken);
+        return 1;
+    }
+    return 0;
+}
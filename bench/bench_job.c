@@ -0,0 +1,210 @@
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "bench.h"
+#include "entity.h"
+#include "job.h"
+#include "thread.h"
+
+// ----------------------------------------------------------------------------
+// Job scheduler benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - scheduling overhead is the time per empty job, added one at a time from the main thread and waited on,
+//   with no workers (the main thread runs them all while waiting) and with all of them
+// - scaling runs two parallel-fors at 1 thread and then at more, a compute bound kernel and the entity
+//   transform update from bench_entity.c, which is mostly memory traffic and stops scaling much earlier
+// - dependencies are checked with a chain of Job_RunAfter() jobs that must run strictly in order,
+//   and a job held back on a parallel-for that must only see it finished
+
+enum BenchJobConstExpr {
+    BENCH_JOB_KERNEL_ITERATIONS = 64,
+    BENCH_JOB_CHAIN = 1000,
+};
+
+struct BenchKernel {
+    f32 *values;
+};
+
+// a few dozen dependent multiply-adds per element, enough that memory isn't what limits it
+static void RunKernel(void *arg, u32 first, u32 end) {
+    f32 *values = ((struct BenchKernel *) arg)->values;
+    for (u32 i = first; i < end; i++) {
+        f32 x = values[i];
+        for (u32 k = 0; k < BENCH_JOB_KERNEL_ITERATIONS; k++) {
+            x = x * 0.999f + sqrtf(x + 1.0f) * 0.001f;
+        }
+        values[i] = x;
+    }
+}
+
+struct BenchEntityUpdate {
+    Entity_Store *store;
+    f32 dt;
+};
+
+static void RunEntityUpdate(void *arg, u32 first, u32 end) {
+    const struct BenchEntityUpdate *update = arg;
+    Entity_UpdateRange(update->store, first, end, update->dt);
+}
+
+static void EmptyJob(void *arg) {
+    (void) arg;
+}
+
+struct BenchChain {
+    atomic_uint next;
+    atomic_uint violations;
+};
+
+struct BenchLink {
+    struct BenchChain *chain;
+    u32 position;
+};
+
+static void RunLink(void *arg) {
+    const struct BenchLink *link = arg;
+    u32 expected = link->position;
+    if (!atomic_compare_exchange_strong(&link->chain->next, &expected, link->position + 1)) {
+        atomic_fetch_add(&link->chain->violations, 1);
+    }
+}
+
+struct BenchFanIn {
+    atomic_uint done;
+    u32 count;
+    atomic_uint violations;
+};
+
+static void RunFanInPiece(void *arg, u32 first, u32 end) {
+    atomic_fetch_add(&((struct BenchFanIn *) arg)->done, end - first);
+}
+
+static void RunFanInCheck(void *arg) {
+    struct BenchFanIn *fanIn = arg;
+    if (atomic_load(&fanIn->done) != fanIn->count) atomic_fetch_add(&fanIn->violations, 1);
+}
+
+static f64 TimeEmptyJobs(u32 count) {
+    Job_Counter counter = {0};
+    f64 start = Bench_Seconds();
+    for (u32 i = 0; i < count; i++) {
+        Job_Run(EmptyJob, NULL, &counter);
+        // the main thread's deque holds JOB_DEQUE_CAPACITY jobs, past that they'd run inline and not be measured
+        if ((i + 1) % (JOB_DEQUE_CAPACITY / 2) == 0) Job_Wait(&counter);
+    }
+    Job_Wait(&counter);
+    return Bench_Seconds() - start;
+}
+
+static f64 TimeParallelFor(Job_RangeFunc func, void *arg, u32 count, u32 grain, u32 repeats) {
+    f64 start = Bench_Seconds();
+    for (u32 r = 0; r < repeats; r++) {
+        Job_Counter counter = {0};
+        Job_ParallelFor(func, arg, count, grain, &counter);
+        Job_Wait(&counter);
+    }
+    return (Bench_Seconds() - start) / repeats;
+}
+
+static u32 CheckDependencies(void) {
+    struct BenchChain chain = {0};
+    struct BenchLink links[BENCH_JOB_CHAIN];
+    Job_Counter counters[BENCH_JOB_CHAIN] = {0};
+    for (u32 i = 0; i < BENCH_JOB_CHAIN; i++) {
+        links[i] = (struct BenchLink) { &chain, i };
+        if (i == 0) {
+            Job_Run(RunLink, &links[i], &counters[i]);
+        } else {
+            Job_RunAfter(&counters[i - 1], RunLink, &links[i], &counters[i]);
+        }
+    }
+    Job_Wait(&counters[BENCH_JOB_CHAIN - 1]);
+
+    struct BenchFanIn fanIn = { .count = 100000 };
+    Job_Counter pieces = {0}, check = {0};
+    Job_ParallelFor(RunFanInPiece, &fanIn, fanIn.count, 64, &pieces);
+    Job_RunAfter(&pieces, RunFanInCheck, &fanIn, &check);
+    Job_Wait(&check);
+
+    return atomic_load(&chain.violations) + (atomic_load(&chain.next) != BENCH_JOB_CHAIN) + atomic_load(&fanIn.violations);
+}
+
+int Bench_Job(int argc, char **argv) {
+    const u32 jobCount = (u32) Bench_ArgInt(argc, argv, "jobs", 100000);
+    const u32 elements = (u32) Bench_ArgInt(argc, argv, "elements", 1000000);
+    const u32 repeats = (u32) Bench_ArgInt(argc, argv, "repeats", 10);
+    i64 maxThreads = Bench_ArgInt(argc, argv, "threads", Thread_HardwareConcurrency());
+    if (maxThreads < 1) maxThreads = 1;
+    if (maxThreads > JOB_MAX_WORKERS + 1) maxThreads = JOB_MAX_WORKERS + 1;
+
+    struct BenchKernel kernel = { malloc(elements * sizeof(f32)) };
+    Entity_Store *store = Entity_StoreCreate(elements);
+    if (kernel.values == NULL || store == NULL) {
+        printf("  ERROR: out of memory for %u elements\n", elements);
+        free(kernel.values);
+        Entity_StoreUnload(store);
+        return 1;
+    }
+
+    Bench_Seed(23);
+    for (u32 i = 0; i < elements; i++) {
+        kernel.values[i] = Bench_RandomRange(0, 100);
+        Vector3 axis = { Bench_RandomRange(-1, 1), Bench_RandomRange(-1, 1), Bench_RandomRange(-1, 1) };
+        Entity_Create(store, (Entity_Desc) {
+                .position = { Bench_RandomRange(-500, 500), 0, Bench_RandomRange(-500, 500) },
+                .rotation = QuaternionFromAxisAngle(axis, Bench_RandomRange(0, 2 * PI)),
+                .scale = 1,
+                .angularVelocity = Vector3Scale(Vector3Normalize(axis), 3)
+        });
+    }
+    struct BenchEntityUpdate update = { store, 1.0f / 60.0f };
+
+    f64 kernelBase = 0, entityBase = 0;
+    // 1, 2, 4, ... threads, and the most asked for
+    for (i64 threads = 1;; threads = (threads * 2 < maxThreads) ? threads * 2 : maxThreads) {
+        Job_Init((int) threads - 1);
+
+        char name[64];
+        if (threads == 1 || threads == maxThreads) {
+            f64 seconds = TimeEmptyJobs(jobCount);
+            snprintf(name, sizeof(name), "empty job, %i threads", (int) threads);
+            Bench_Report(name, seconds * 1e9 / jobCount, "ns");
+        }
+
+        f64 kernelSeconds = TimeParallelFor(RunKernel, &kernel, elements, 4096, repeats);
+        f64 entitySeconds = TimeParallelFor(RunEntityUpdate, &update, elements, 16384, repeats);
+        if (threads == 1) {
+            kernelBase = kernelSeconds;
+            entityBase = entitySeconds;
+        }
+
+        snprintf(name, sizeof(name), "compute kernel, %i threads", (int) threads);
+        Bench_Report(name, kernelSeconds * 1000.0, "ms");
+        Bench_Report("  speedup", kernelBase / kernelSeconds, "x");
+        snprintf(name, sizeof(name), "entity update, %i threads", (int) threads);
+        Bench_Report(name, entitySeconds * 1000.0, "ms");
+        Bench_Report("  speedup", entityBase / entitySeconds, "x");
+
+        if (threads == maxThreads) {
+            Bench_Report("dependency violations", CheckDependencies(), "");
+            Job_Stats stats = Job_GetStats();
+            Bench_Report("jobs run", (f64) stats.jobs, "");
+            Bench_Report("stolen", (f64) stats.steals, "");
+            Bench_Report("run inline, queue full", (f64) stats.inlined, "");
+        }
+        Job_Shutdown();
+
+        if (threads == maxThreads) break;
+    }
+
+    free(kernel.values);
+    Entity_StoreUnload(store);
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "bench.h"
+#include "cluster.h"
+#include "job.h"
+#include "level.h"
+#include "lightmap.h"
+#include "thread.h"
+
+// ----------------------------------------------------------------------------
+// Light baking benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - bakes the static level (see level.h) at a lower resolution and sample count than fiddle-bake's defaults,
+//   at 1 thread and then at more, samples per second and speedup, the baked texels must hash the same every time
+// - fragment cost is estimated from the cluster lists: the first person views of the framebench path are ray cast
+//   against the level's boxes, and every hit counts the lights lighting.frag loops over in its cluster against
+//   the ones left once the baked lights are skipped, with a light circling the coin kept live like in the game
+// - the GPU side of the same comparison is 'fiddle --benchmark' against 'fiddle --benchmark --lightmap=off'
+
+enum BenchLightmapConstExpr {
+    BENCH_LIGHTMAP_MAX_LIST = 1024,
+    BENCH_LIGHTMAP_VIEW_WIDTH = 160,        // a quarter of one half of the split screen, in each direction
+    BENCH_LIGHTMAP_VIEW_HEIGHT = 180,
+};
+
+// first person keys of main.c's benchmark path
+static const struct BenchView {
+    Vector3 eye;
+    Vector3 target;
+} benchViews[] = {
+        { {  -3.0f,  3.0f,   0.0f }, {  0.0f, 2.25f, 0.0f } },
+        { { -15.0f,  4.0f, -15.0f }, {  0.0f, 2.00f, 0.0f } },
+        { {   0.0f,  8.0f, -22.0f }, {  0.0f, 1.00f, 0.0f } },
+        { {  18.0f,  3.0f,  -5.0f }, { -5.0f, 2.00f, 5.0f } },
+        { {  10.0f,  2.0f,  15.0f }, {  0.0f, 2.00f, 0.0f } },
+        { { -10.0f, 12.0f,  10.0f }, {  0.0f, 0.00f, 0.0f } },
+};
+
+static void BakeRows(void *arg, u32 first, u32 end) {
+    Lightmap_Bake(arg, first, end);
+}
+
+// nearest box along the ray, t in units of direction
+static f32 CastRay(Vector3 origin, Vector3 direction, const Level_Box *boxes, u32 count) {
+    Vector3 inverse = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+    f32 nearest = INFINITY;
+    for (u32 i = 0; i < count; i++) {
+        Vector3 half = Vector3Scale(boxes[i].size, 0.5f);
+        Vector3 min = Vector3Subtract(boxes[i].center, half);
+        Vector3 max = Vector3Add(boxes[i].center, half);
+
+        f32 tx0 = (min.x - origin.x) * inverse.x, tx1 = (max.x - origin.x) * inverse.x;
+        f32 ty0 = (min.y - origin.y) * inverse.y, ty1 = (max.y - origin.y) * inverse.y;
+        f32 tz0 = (min.z - origin.z) * inverse.z, tz1 = (max.z - origin.z) * inverse.z;
+        f32 enter = fmaxf(fmaxf(fminf(tx0, tx1), fminf(ty0, ty1)), fminf(tz0, tz1));
+        f32 exit = fminf(fminf(fmaxf(tx0, tx1), fmaxf(ty0, ty1)), fmaxf(tz0, tz1));
+        if (enter <= exit && exit > 0 && enter < nearest) nearest = fmaxf(enter, 0);
+    }
+    return nearest;
+}
+
+struct BenchFragments {
+    u64 fragments;
+    u64 liveIterations;         // every light in the cluster, lighting.frag
+    u64 bakedIterations;        // past the baked ones, lighting_baked.frag
+    u32 orderErrors;            // baked lights listed after a live one
+};
+
+static void CountFragments(struct BenchFragments *result, struct BenchView view, f32 aspect,
+                           const Level_Box *boxes, u32 boxCount, u32 *list) {
+    Camera3D camera = { .position = view.eye, .target = view.target, .up = { 0, 1, 0 }, .fovy = 45 };
+    Cluster_BinLights(camera, aspect);
+
+    Vector3 forward = Vector3Normalize(Vector3Subtract(view.target, view.eye));
+    Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+    Vector3 up = Vector3CrossProduct(right, forward);
+    f32 tanHalfFovY = tanf(camera.fovy * 0.5f * DEG2RAD);
+    f32 tanHalfFovX = tanHalfFovY * aspect;
+
+    for (u32 y = 0; y < BENCH_LIGHTMAP_VIEW_HEIGHT; y++) {
+        for (u32 x = 0; x < BENCH_LIGHTMAP_VIEW_WIDTH; x++) {
+            Vector2 ndc = {
+                    ((f32) x + 0.5f) / BENCH_LIGHTMAP_VIEW_WIDTH * 2.0f - 1.0f,
+                    1.0f - ((f32) y + 0.5f) / BENCH_LIGHTMAP_VIEW_HEIGHT * 2.0f
+            };
+            // forward is 1 unit long in the direction, so t is the fragment's view depth
+            Vector3 direction = Vector3Add(forward, Vector3Add(Vector3Scale(right, ndc.x * tanHalfFovX),
+                                                               Vector3Scale(up, ndc.y * tanHalfFovY)));
+            f32 depth = CastRay(view.eye, direction, boxes, boxCount);
+            if (depth == INFINITY) continue;
+
+            u32 count = Cluster_GetClusterLights(Cluster_ClusterAt(ndc, depth), list, BENCH_LIGHTMAP_MAX_LIST);
+            if (count > BENCH_LIGHTMAP_MAX_LIST) count = BENCH_LIGHTMAP_MAX_LIST;
+
+            u32 baked = 0;
+            for (u32 i = 0; i < count; i++) {
+                if (!Cluster_GetLight(list[i]).baked) continue;
+                if (baked != i) result->orderErrors++;
+                baked++;
+            }
+            result->fragments++;
+            result->liveIterations += count;
+            result->bakedIterations += count - baked;
+        }
+    }
+}
+
+int Bench_Lightmap(int argc, char **argv) {
+    Lightmap_BakeDesc desc = {
+            .texelsPerUnit = (f32) Bench_ArgInt(argc, argv, "texels", 1),
+            .samples = (u32) Bench_ArgInt(argc, argv, "samples", 8),
+            .bounces = (u32) Bench_ArgInt(argc, argv, "bounces", 2)
+    };
+    i64 maxThreads = Bench_ArgInt(argc, argv, "threads", Thread_HardwareConcurrency());
+    if (maxThreads < 1) maxThreads = 1;
+    if (maxThreads > JOB_MAX_WORKERS + 1) maxThreads = JOB_MAX_WORKERS + 1;
+
+    static Level_Box boxes[LEVEL_MAX_BOXES];
+    static Cluster_Light lights[LEVEL_MAX_LIGHTS];
+    desc.boxes = boxes;
+    desc.boxCount = Level_StaticBoxes(Level_StartingRoom, boxes, LEVEL_MAX_BOXES);
+    desc.lights = lights;
+    desc.lightCount = Level_StaticLights(lights, LEVEL_MAX_LIGHTS);
+
+    Bench_Report("boxes", desc.boxCount, "");
+    Bench_Report("lights", desc.lightCount, "");
+
+    f64 base = 0;
+    u64 firstHash = 0;
+    u32 mismatches = 0;
+    // 1, 2, 4, ... threads, and the most asked for
+    for (i64 threads = 1;; threads = (threads * 2 < maxThreads) ? threads * 2 : maxThreads) {
+        Lightmap_Baker *baker = Lightmap_BakerCreate(desc);
+        if (baker == NULL) {
+            printf("  ERROR: couldn't set up the bake\n");
+            return 1;
+        }
+
+        Job_Init((int) threads - 1);
+        f64 start = Bench_Seconds();
+        Job_Counter counter = {0};
+        Job_ParallelFor(BakeRows, baker, Lightmap_BakeRows(baker), 1, &counter);
+        Job_Wait(&counter);
+        f64 seconds = Bench_Seconds() - start;
+        Job_Shutdown();
+
+        Lightmap_BakeStats stats = Lightmap_GetBakeStats(baker);
+        u64 hash = Lightmap_BakerHash(baker);
+        if (threads == 1) {
+            base = seconds;
+            firstHash = hash;
+            Bench_Report("atlas texels baked", (f64) stats.texels, "");
+            Bench_Report("rays per sample", stats.samples ? (f64) stats.rays / (f64) stats.samples : 0, "");
+        } else if (hash != firstHash) {
+            mismatches++;
+        }
+        Lightmap_BakerUnload(baker);
+
+        char name[64];
+        snprintf(name, sizeof(name), "bake, %i threads", (int) threads);
+        Bench_Report(name, seconds * 1000.0, "ms");
+        Bench_Report("  samples per second", (f64) stats.samples / seconds, "");
+        Bench_Report("  speedup", base / seconds, "x");
+
+        if (threads == maxThreads) break;
+    }
+
+    // every level light is baked, the coin's stays live
+    Cluster_Init(LEVEL_MAX_LIGHTS + 1);
+    for (u32 i = 0; i < desc.lightCount; i++) {
+        Cluster_Light light = lights[i];
+        light.baked = true;
+        Cluster_AddLight(light);
+    }
+    Cluster_AddLight((Cluster_Light) { .position = { 2, 2, 0 }, .radius = 6, .color = GOLD, .intensity = 2 });
+
+    const f32 aspect = 640.0f / 720.0f; // one half of the split screen view
+    u32 *list = malloc(BENCH_LIGHTMAP_MAX_LIST * sizeof(u32));
+    struct BenchFragments fragments = {0};
+    for (u32 i = 0; i < sizeof(benchViews) / sizeof(benchViews[0]); i++) {
+        CountFragments(&fragments, benchViews[i], aspect, boxes, desc.boxCount, list);
+    }
+    free(list);
+    Cluster_Unload();
+
+    f64 live = fragments.fragments ? (f64) fragments.liveIterations / (f64) fragments.fragments : 0;
+    f64 baked = fragments.fragments ? (f64) fragments.bakedIterations / (f64) fragments.fragments : 0;
+    Bench_Report("static fragments", (f64) fragments.fragments, "");
+    Bench_Report("light loop per fragment, all live", live, "lights");
+    Bench_Report("light loop per fragment, baked", baked, "lights");
+    Bench_Report("  reduction", live > 0 ? (1.0 - baked / live) * 100.0 : 0, "%");
+
+    if (mismatches > 0) {
+        printf("  ERROR: %u bakes came out different from the single threaded one\n", mismatches);
+        return 1;
+    }
+    if (fragments.orderErrors > 0) {
+        printf("  ERROR: %u cluster lists with a baked light after a live one\n", fragments.orderErrors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+
+#include "bench.h"
+#include "glb.h"
+#include "loader.h"
+#include "lod.h"
+#include "resource.h"
+#include "thread.h"
+
+// ----------------------------------------------------------------------------
+// Model loading benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - measures the CPU half of model loading for a whole directory, serially and through the loader's worker pool
+//   at increasing thread counts: file read, glTF parse and image decode, the content hashes the resource cache
+//   dedups on, and the LOD chain, the serial run reports the three separately and the speedup is against their sum
+// - GPU upload needs a GL context, so it's measured in game instead (see the LOADER log line at startup)
+
+static f64 ParseWithLoader(FilePathList files, int workers, u64 *bytes) {
+    Loader_Init(workers);
+
+    f64 start = Bench_Seconds();
+    for (u32 i = 0; i < files.count; i++) {
+        Loader_LoadModel(files.paths[i]);
+    }
+
+    // wait for the workers, nothing gets uploaded without a call to Loader_Update()
+    Loader_Stats stats = Loader_GetStats();
+    while (stats.parsed + stats.failed < stats.requested) {
+        Thread_Yield();
+        stats = Loader_GetStats();
+    }
+    f64 elapsed = Bench_Seconds() - start;
+
+    *bytes = stats.bytesParsed;
+    Loader_Shutdown();
+    return elapsed;
+}
+
+int Bench_Loader(int argc, char **argv) {
+    const char *directory = Bench_ArgString(argc, argv, "dir", "data/models");
+    int maxWorkers = (int) Bench_ArgInt(argc, argv, "workers", Thread_HardwareConcurrency());
+    if (maxWorkers < 1) maxWorkers = 1;
+
+    SetTraceLogLevel(LOG_WARNING);
+    FilePathList files = LoadDirectoryFilesEx(directory, ".glb", false);
+    if (files.count == 0) {
+        printf("  ERROR: no .glb files found in '%s' (run from the repository root or pass --dir=)\n", directory);
+        UnloadDirectoryFiles(files);
+        return 1;
+    }
+
+    // serial baseline, the same work a loader worker does for each model, minus the GPU upload on the main thread
+    u64 serialBytes = 0;
+    int failed = 0;
+    f64 parseSeconds = 0, hashSeconds = 0, lodSeconds = 0;
+    Mesh *levels = NULL;
+    u32 levelCapacity = 0;
+    for (u32 i = 0; i < files.count; i++) {
+        f64 start = Bench_Seconds();
+        GLB_ModelData data;
+        b8 parsed = GLB_LoadModelData(files.paths[i], &data);
+        parseSeconds += Bench_Seconds() - start;
+        if (!parsed) {
+            failed++;
+            continue;
+        }
+        serialBytes += GLB_ModelDataSize(&data);
+
+        start = Bench_Seconds();
+        for (int m = 0; m < data.meshCount; m++) {
+            Resource_HashMesh(&data.meshes[m]);
+        }
+        for (int m = 0; m < data.materialCount; m++) {
+            Resource_HashImage(data.materials[m].albedo);
+        }
+        hashSeconds += Bench_Seconds() - start;
+
+        u32 meshCount = (u32) data.meshCount;
+        if ((LOD_MAX_LEVELS - 1) * meshCount > levelCapacity) {
+            levelCapacity = (LOD_MAX_LEVELS - 1) * meshCount;
+            levels = realloc(levels, levelCapacity * sizeof(Mesh));
+        }
+        start = Bench_Seconds();
+        u32 levelCount = Lod_GenerateLevels(data.meshes, meshCount, levels);
+        for (u32 m = 0; m < levelCount * meshCount; m++) {
+            Resource_HashMesh(&levels[m]);
+        }
+        lodSeconds += Bench_Seconds() - start;
+
+        for (u32 m = 0; m < levelCount * meshCount; m++) {
+            Lod_FreeMesh(&levels[m]);
+        }
+        GLB_UnloadModelData(&data);
+    }
+    free(levels);
+    f64 serial = parseSeconds + hashSeconds + lodSeconds;
+
+    Bench_Report("models", files.count, "");
+    Bench_Report("failed", failed, "");
+    Bench_Report("cpu side data", (f64) serialBytes / (1024.0 * 1024.0), "MiB");
+    Bench_Report("serial parse", parseSeconds * 1000.0, "ms");
+    Bench_Report("serial hash", hashSeconds * 1000.0, "ms");
+    Bench_Report("serial lod", lodSeconds * 1000.0, "ms");
+    Bench_Report("serial total", serial * 1000.0, "ms");
+
+    // powers of two up to the requested count, then the requested count itself
+    for (int workers = 1;; workers *= 2) {
+        if (workers > maxWorkers) workers = maxWorkers;
+        u64 bytes = 0;
+        f64 elapsed = ParseWithLoader(files, workers, &bytes);
+
+        char name[64];
+        snprintf(name, sizeof(name), "loader total (%i workers)", workers);
+        Bench_Report(name, elapsed * 1000.0, "ms");
+        snprintf(name, sizeof(name), "speedup (%i workers)", workers);
+        Bench_Report(name, serial / elapsed, "x");
+
+        if (workers == maxWorkers) break;
+    }
+
+    UnloadDirectoryFiles(files);
+    return (failed > 0) ? 1 : 0;
+}
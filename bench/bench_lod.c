@@ -0,0 +1,176 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "bench.h"
+#include "cull.h"
+#include "glb.h"
+#include "lod.h"
+
+// ----------------------------------------------------------------------------
+// Mesh LOD generation and selection benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - generates the LOD chain of the decorated props (or every model in data/models with --all=1),
+//   reports how long that takes and the triangles each level is left with
+// - then walks a first person camera through a dense scene of those props, the same frustum and
+//   screen size selection the game does each frame, and compares the triangles submitted with and without LODs
+// - that's the CPU side of it, 'fiddle --benchmark' vs 'fiddle --benchmark --lod=off' gives frame times
+//   and triangle throughput of the real thing, see readme.md
+
+static const char *propFiles[] = {
+        "data/models/keg_decorated.gltf.glb",
+        "data/models/stairs_wood_decorated.gltf.glb",
+        "data/models/table_long_decorated_C.gltf.glb",
+};
+
+struct BenchLodModel {
+    u32 levelCount;                     // including level 0
+    u32 triangles[LOD_MAX_LEVELS];
+    BoundingBox bounds;
+};
+
+static u32 CountTriangles(const Mesh *meshes, int meshCount) {
+    u32 count = 0;
+    for (int i = 0; i < meshCount; i++) count += (u32) meshes[i].triangleCount;
+    return count;
+}
+
+static BoundingBox MeshBounds(const Mesh *meshes, int meshCount) {
+    BoundingBox bounds = { { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+    for (int i = 0; i < meshCount; i++) {
+        BoundingBox box = GetMeshBoundingBox(meshes[i]);
+        bounds.min = Vector3Min(bounds.min, box.min);
+        bounds.max = Vector3Max(bounds.max, box.max);
+    }
+    return bounds;
+}
+
+static b8 GenerateModel(const char *fileName, struct BenchLodModel *model, f64 *seconds) {
+    GLB_ModelData data;
+    if (!GLB_LoadModelData(fileName, &data)) return false;
+
+    u32 meshCount = (u32) data.meshCount;
+    Mesh *levels = calloc((LOD_MAX_LEVELS - 1) * meshCount + 1, sizeof(Mesh));
+
+    f64 start = Bench_Seconds();
+    u32 generated = Lod_GenerateLevels(data.meshes, meshCount, levels);
+    *seconds += Bench_Seconds() - start;
+
+    model->levelCount = generated + 1;
+    model->triangles[0] = CountTriangles(data.meshes, data.meshCount);
+    model->bounds = MeshBounds(data.meshes, data.meshCount);
+    for (u32 l = 0; l < generated; l++) {
+        model->triangles[l + 1] = CountTriangles(&levels[l * meshCount], data.meshCount);
+    }
+
+    for (u32 i = 0; i < generated * meshCount; i++) Lod_FreeMesh(&levels[i]);
+    free(levels);
+    GLB_UnloadModelData(&data);
+    return true;
+}
+
+int Bench_Lod(int argc, char **argv) {
+    const b8 all = Bench_ArgInt(argc, argv, "all", 0) != 0;
+    const u32 objectCount = (u32) Bench_ArgInt(argc, argv, "objects", 4096);
+    const u32 frames = (u32) Bench_ArgInt(argc, argv, "frames", 600);
+    const f32 aspect = 640.0f / 720.0f; // one half of the split screen view
+
+    FilePathList files = {0};
+    if (all) files = LoadDirectoryFilesEx("data/models", ".glb", false);
+    u32 fileCount = all ? files.count : (u32) (sizeof(propFiles) / sizeof(propFiles[0]));
+
+    struct BenchLodModel *models = calloc(fileCount + 1, sizeof(struct BenchLodModel));
+    u32 modelCount = 0;
+    u64 sourceTriangles = 0, lowestTriangles = 0;
+    f64 generateSeconds = 0;
+    for (u32 i = 0; i < fileCount; i++) {
+        const char *fileName = all ? files.paths[i] : propFiles[i];
+        struct BenchLodModel *model = &models[modelCount];
+        if (!GenerateModel(fileName, model, &generateSeconds)) {
+            printf("  failed to load %s, run from the repository root\n", fileName);
+            continue;
+        }
+        modelCount++;
+
+        sourceTriangles += model->triangles[0];
+        lowestTriangles += model->triangles[model->levelCount - 1];
+        if (!all) {
+            for (u32 l = 0; l < model->levelCount; l++) {
+                char name[64];
+                const char *baseName = GetFileName(fileName);
+                snprintf(name, sizeof(name), "%.*s lod%u", (int) strcspn(baseName, "."), baseName, l);
+                Bench_Report(name, model->triangles[l], "triangles");
+            }
+        }
+    }
+    if (all) UnloadDirectoryFiles(files);
+    if (modelCount == 0) {
+        free(models);
+        return 1;
+    }
+
+    Bench_Report("models", modelCount, "");
+    Bench_Report("generate levels", generateSeconds * 1000.0, "ms");
+    Bench_Report("generate per 1k source triangles", generateSeconds * 1000.0 / ((f64) sourceTriangles / 1000.0), "ms");
+    Bench_Report("lowest level / source", (f64) lowestTriangles / (f64) sourceTriangles, "");
+
+    // dense scene: props scattered around a camera walking through them at eye height
+    Bench_Seed(7);
+    u32 *objectModels = malloc(objectCount * sizeof(u32));
+    u32 *objectLevels = calloc(objectCount, sizeof(u32));
+    BoundingBox *objectBounds = malloc(objectCount * sizeof(BoundingBox));
+    for (u32 i = 0; i < objectCount; i++) {
+        objectModels[i] = Bench_RandomU32() % modelCount;
+        Vector3 position = { Bench_RandomRange(-60, 60), 0, Bench_RandomRange(-60, 60) };
+        BoundingBox bounds = models[objectModels[i]].bounds;
+        objectBounds[i] = (BoundingBox) { Vector3Add(bounds.min, position), Vector3Add(bounds.max, position) };
+    }
+
+    u64 fullTriangles = 0, lodTriangles = 0, visibleTotal = 0, switches = 0;
+    f64 selectSeconds = 0;
+    for (u32 frame = 0; frame < frames; frame++) {
+        f32 t = (f32) frame / (f32) frames;
+        Camera3D camera = {
+                .position = { -50 + 100 * t, 1.7f, 10 * sinf(t * 2 * PI) },
+                .target = { -50 + 100 * t + cosf(t * 6 * PI), 1.5f, 10 * sinf(t * 2 * PI) + sinf(t * 6 * PI) },
+                .up = { 0, 1, 0 },
+                .fovy = 45,
+                .projection = CAMERA_PERSPECTIVE
+        };
+        Cull_Frustum frustum = Cull_FrustumFromCamera(camera, aspect);
+
+        f64 start = Bench_Seconds();
+        for (u32 i = 0; i < objectCount; i++) {
+            if (!Cull_FrustumTestBox(&frustum, objectBounds[i])) continue;
+
+            const struct BenchLodModel *model = &models[objectModels[i]];
+            u32 level = Lod_Select(Lod_ScreenSize(objectBounds[i], camera), objectLevels[i], model->levelCount);
+            if (level != objectLevels[i]) switches++;
+            objectLevels[i] = level;
+
+            visibleTotal++;
+            fullTriangles += model->triangles[0];
+            lodTriangles += model->triangles[level];
+        }
+        selectSeconds += Bench_Seconds() - start;
+    }
+
+    Bench_Report("visible objects per frame", (f64) visibleTotal / frames, "");
+    Bench_Report("triangles per frame, full detail", (f64) fullTriangles / frames, "");
+    Bench_Report("triangles per frame, lod", (f64) lodTriangles / frames, "");
+    Bench_Report("triangle reduction", (f64) fullTriangles / (f64) (lodTriangles ? lodTriangles : 1), "x");
+    Bench_Report("level switches per frame", (f64) switches / frames, "");
+    Bench_Report("cull + select per frame", selectSeconds * 1000.0 / frames, "ms");
+
+    free(objectModels);
+    free(objectLevels);
+    free(objectBounds);
+    free(models);
+    return 0;
+}
@@ -0,0 +1,245 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "bench.h"
+#include "cull.h"
+#include "job.h"
+#include "occlusion.h"
+
+// ----------------------------------------------------------------------------
+// Occlusion culling benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - an indoor level: a 128x128 tile grid of 16 tile rooms with doorways, like the overhead map, 2 units per tile
+//   and walls 3 units high, every wall run from Occlusion_MergeTiles() is an occluder
+// - props are boxes standing on open tiles, the camera stands at eye height in a random room looking a random way
+// - the buffer is the size the game uses, its rows are rasterized as jobs, tests run on the main thread
+// - every rejected prop is checked against the occluders by ray casting a grid of points on its faces from the
+//   eye, a point on screen with a clear line of sight is a false rejection, there must be none
+
+enum BenchOcclusionConstExpr {
+    BENCH_OCCLUSION_MAP_SIZE = 128,
+    BENCH_OCCLUSION_ROOM_SIZE = 16,
+    BENCH_OCCLUSION_MAX_WALLS = 4096,
+    BENCH_OCCLUSION_WIDTH = 128,
+    BENCH_OCCLUSION_HEIGHT = 144,
+    BENCH_OCCLUSION_SAMPLES = 4,        // per face side, so 96 points per prop
+};
+
+static const f32 BENCH_OCCLUSION_TILE = 2.0f;
+static const f32 BENCH_OCCLUSION_WALL_HEIGHT = 3.0f;
+
+static void RasterizeRows(void *arg, u32 first, u32 end) {
+    Occlusion_Buffer *buffer = arg;
+    Occlusion_Rasterize(buffer, first, end);
+}
+
+// slab test of the segment from origin to origin + direction
+static b8 SegmentHitsBox(Vector3 origin, Vector3 direction, BoundingBox box) {
+    f32 enter = 0, exit = 1;
+    f32 o[3] = { origin.x, origin.y, origin.z };
+    f32 d[3] = { direction.x, direction.y, direction.z };
+    f32 lo[3] = { box.min.x, box.min.y, box.min.z };
+    f32 hi[3] = { box.max.x, box.max.y, box.max.z };
+    for (int axis = 0; axis < 3; axis++) {
+        if (fabsf(d[axis]) < 1e-9f) {
+            if (o[axis] < lo[axis] || o[axis] > hi[axis]) return false;
+            continue;
+        }
+        f32 t0 = (lo[axis] - o[axis]) / d[axis];
+        f32 t1 = (hi[axis] - o[axis]) / d[axis];
+        if (t0 > t1) {
+            f32 t = t0;
+            t0 = t1;
+            t1 = t;
+        }
+        enter = fmaxf(enter, t0);
+        exit = fminf(exit, t1);
+        if (enter > exit) return false;
+    }
+    return true;
+}
+
+// whether the point lands inside the view, box corners often don't even when the frustum test keeps the box
+static b8 PointOnScreen(Matrix m, Vector3 p) {
+    f32 x = p.x * m.m0 + p.y * m.m4 + p.z * m.m8 + m.m12;
+    f32 y = p.x * m.m1 + p.y * m.m5 + p.z * m.m9 + m.m13;
+    f32 w = p.x * m.m3 + p.y * m.m7 + p.z * m.m11 + m.m15;
+    return w > 0 && fabsf(x) <= w && fabsf(y) <= w;
+}
+
+// whether any sample point on the box's faces is on screen and can be seen from the eye past all the occluders
+static b8 AnyPointVisible(Vector3 eye, Matrix viewProjection, BoundingBox box, const BoundingBox *occluders,
+                          u32 occluderCount) {
+    const u32 n = BENCH_OCCLUSION_SAMPLES;
+    Vector3 size = Vector3Subtract(box.max, box.min);
+    for (int axis = 0; axis < 3; axis++) {
+        for (int side = 0; side < 2; side++) {
+            for (u32 i = 0; i < n; i++) {
+                for (u32 j = 0; j < n; j++) {
+                    f32 u = ((f32) i + 0.5f) / (f32) n, v = ((f32) j + 0.5f) / (f32) n;
+                    f32 t[3];
+                    t[axis] = (f32) side;
+                    t[(axis + 1) % 3] = u;
+                    t[(axis + 2) % 3] = v;
+                    Vector3 point = { box.min.x + size.x * t[0], box.min.y + size.y * t[1], box.min.z + size.z * t[2] };
+
+                    if (!PointOnScreen(viewProjection, point)) continue;
+
+                    Vector3 toPoint = Vector3Subtract(point, eye);
+                    b8 blocked = false;
+                    for (u32 o = 0; !blocked && o < occluderCount; o++) {
+                        blocked = SegmentHitsBox(eye, toPoint, occluders[o]);
+                    }
+                    if (!blocked) return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+int Bench_Occlusion(int argc, char **argv) {
+    const u32 propCount = (u32) Bench_ArgInt(argc, argv, "props", 20000);
+    const u32 viewCount = (u32) Bench_ArgInt(argc, argv, "views", 50);
+    const f32 aspect = 640.0f / 720.0f; // one half of the split screen view
+
+    // rooms with two tile doorways in the middle of each wall, the same layout as the overhead map
+    static u8 tiles[BENCH_OCCLUSION_MAP_SIZE * BENCH_OCCLUSION_MAP_SIZE];
+    const u32 size = BENCH_OCCLUSION_MAP_SIZE, room = BENCH_OCCLUSION_ROOM_SIZE;
+    for (u32 y = 0; y < size; y++) {
+        for (u32 x = 0; x < size; x++) {
+            b8 wall = (x % room == 0) || (y % room == 0) || x == size - 1 || y == size - 1;
+            b8 doorway = (x % room == 0 && x > 0 && x < size - 1 && (y % room == room / 2 - 1 || y % room == room / 2))
+                      || (y % room == 0 && y > 0 && y < size - 1 && (x % room == room / 2 - 1 || x % room == room / 2));
+            tiles[y * size + x] = wall && !doorway;
+        }
+    }
+
+    static Rectangle rects[BENCH_OCCLUSION_MAX_WALLS];
+    static BoundingBox walls[BENCH_OCCLUSION_MAX_WALLS];
+    u32 wallCount = Occlusion_MergeTiles(tiles, size, size, 1, rects, BENCH_OCCLUSION_MAX_WALLS);
+    if (wallCount > BENCH_OCCLUSION_MAX_WALLS) wallCount = BENCH_OCCLUSION_MAX_WALLS;
+    for (u32 i = 0; i < wallCount; i++) {
+        walls[i] = (BoundingBox) {
+                { rects[i].x * BENCH_OCCLUSION_TILE, 0, rects[i].y * BENCH_OCCLUSION_TILE },
+                { (rects[i].x + rects[i].width) * BENCH_OCCLUSION_TILE, BENCH_OCCLUSION_WALL_HEIGHT,
+                  (rects[i].y + rects[i].height) * BENCH_OCCLUSION_TILE }
+        };
+    }
+
+    BoundingBox *props = malloc(propCount * sizeof(BoundingBox));
+    u32 *candidates = malloc(propCount * sizeof(u32));
+    BoundingBox *occluders = malloc(wallCount * sizeof(BoundingBox));
+    Occlusion_Buffer *buffer = Occlusion_Create(BENCH_OCCLUSION_WIDTH, BENCH_OCCLUSION_HEIGHT);
+    if (props == NULL || candidates == NULL || occluders == NULL || buffer == NULL) {
+        printf("  ERROR: out of memory for %u props\n", propCount);
+        free(props);
+        free(candidates);
+        free(occluders);
+        Occlusion_Unload(buffer);
+        return 1;
+    }
+
+    Bench_Seed(24);
+    for (u32 i = 0; i < propCount;) {
+        u32 x = Bench_RandomU32() % size, y = Bench_RandomU32() % size;
+        if (tiles[y * size + x]) continue;
+        Vector3 center = {
+                ((f32) x + 0.5f) * BENCH_OCCLUSION_TILE,
+                0,
+                ((f32) y + 0.5f) * BENCH_OCCLUSION_TILE
+        };
+        Vector3 half = { Bench_RandomRange(0.2f, 0.9f), Bench_RandomRange(0.3f, 1.2f), Bench_RandomRange(0.2f, 0.9f) };
+        props[i++] = (BoundingBox) {
+                { center.x - half.x, 0, center.z - half.z },
+                { center.x + half.x, 2 * half.y, center.z + half.z }
+        };
+    }
+
+    Job_Init(-1);
+
+    f64 rasterSeconds = 0, testSeconds = 0;
+    u64 frustumVisible = 0, rejected = 0, occluderTotal = 0, faceTotal = 0, falseRejections = 0;
+    for (u32 view = 0; view < viewCount; view++) {
+        // somewhere in the middle of a room, eye height
+        u32 roomX = Bench_RandomU32() % (size / room), roomY = Bench_RandomU32() % (size / room);
+        Vector3 eye = {
+                ((f32) (roomX * room) + Bench_RandomRange(2, (f32) room - 2)) * BENCH_OCCLUSION_TILE,
+                1.7f,
+                ((f32) (roomY * room) + Bench_RandomRange(2, (f32) room - 2)) * BENCH_OCCLUSION_TILE
+        };
+        f32 angle = Bench_RandomRange(0, 2 * PI);
+        Camera3D camera = {
+                .position = eye,
+                .target = Vector3Add(eye, (Vector3) { cosf(angle), Bench_RandomRange(-0.2f, 0.2f), sinf(angle) }),
+                .up = { 0, 1, 0 },
+                .fovy = 45,
+                .projection = CAMERA_PERSPECTIVE
+        };
+        Matrix viewProjection = Cull_ViewProjection(camera, aspect);
+        Cull_Frustum frustum = Cull_FrustumFromMatrix(viewProjection);
+
+        u32 candidateCount = 0;
+        for (u32 i = 0; i < propCount; i++) {
+            if (Cull_FrustumTestBox(&frustum, props[i])) candidates[candidateCount++] = i;
+        }
+
+        // occluders in view, rasterized a tile row per job
+        f64 start = Bench_Seconds();
+        u32 occluderCount = 0;
+        Occlusion_Begin(buffer, viewProjection);
+        for (u32 i = 0; i < wallCount; i++) {
+            if (!Cull_FrustumTestBox(&frustum, walls[i])) continue;
+            Occlusion_AddBox(buffer, walls[i]);
+            occluders[occluderCount++] = walls[i];
+        }
+        Job_Counter counter = {0};
+        Job_ParallelFor(RasterizeRows, buffer, Occlusion_TileRows(buffer), 1, &counter);
+        Job_Wait(&counter);
+        f64 rasterized = Bench_Seconds();
+
+        u32 viewRejected = 0;
+        for (u32 i = 0; i < candidateCount; i++) {
+            if (!Occlusion_TestBox(buffer, props[candidates[i]])) candidates[viewRejected++] = candidates[i];
+        }
+        f64 tested = Bench_Seconds();
+
+        for (u32 i = 0; i < viewRejected; i++) {
+            falseRejections += AnyPointVisible(eye, viewProjection, props[candidates[i]], occluders, occluderCount);
+        }
+
+        rasterSeconds += rasterized - start;
+        testSeconds += tested - rasterized;
+        frustumVisible += candidateCount;
+        rejected += viewRejected;
+        occluderTotal += occluderCount;
+        faceTotal += Occlusion_GetStats(buffer).faces;
+    }
+
+    Job_Shutdown();
+
+    char name[64];
+    snprintf(name, sizeof(name), "buffer %ux%u, walls", BENCH_OCCLUSION_WIDTH, BENCH_OCCLUSION_HEIGHT);
+    Bench_Report(name, wallCount, "");
+    Bench_Report("occluders per view", (f64) occluderTotal / viewCount, "");
+    Bench_Report("faces per view", (f64) faceTotal / viewCount, "");
+    Bench_Report("props in frustum per view", (f64) frustumVisible / viewCount, "");
+    Bench_Report("props occluded per view", (f64) rejected / viewCount, "");
+    Bench_Report("occluded / in frustum", frustumVisible ? (f64) rejected / (f64) frustumVisible : 0, "");
+    Bench_Report("rasterize per view", rasterSeconds * 1000.0 / viewCount, "ms");
+    Bench_Report("test per prop", frustumVisible ? testSeconds * 1e9 / (f64) frustumVisible : 0, "ns");
+    Bench_Report("cull cost per view", (rasterSeconds + testSeconds) * 1000.0 / viewCount, "ms");
+    Bench_Report("false rejections", (f64) falseRejections, "");
+
+    free(props);
+    free(candidates);
+    free(occluders);
+    Occlusion_Unload(buffer);
+    return falseRejections > 0;
+}
@@ -0,0 +1,128 @@
+#include <stdio.h>
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#include "bench.h"
+#include "glb.h"
+#include "pack.h"
+
+// ----------------------------------------------------------------------------
+// Cooked pack vs .glb loading benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - needs a cooked pack, build the fiddle-cook-models target (or run fiddle-cook data/models data/models.pack)
+// - default mode is headless and compares the CPU side only: parsing + decoding every .glb
+//   against mapping the pack and reading every byte that would be uploaded
+// - --gpu=1 opens a hidden window and compares the full path, raylib's LoadModel() against Pack_LoadModel()
+
+static u64 TouchBytes(const void *data, u64 size) {
+    // stride through the data like an upload would, so the pages actually get read in
+    const u8 *bytes = data;
+    u64 sum = 0;
+    for (u64 i = 0; i < size; i += 64) sum += bytes[i];
+    return sum;
+}
+
+static int CompareCpu(FilePathList files, const char *packFile) {
+    f64 start = Bench_Seconds();
+    u64 glbBytes = 0;
+    for (u32 i = 0; i < files.count; i++) {
+        GLB_ModelData data;
+        if (!GLB_LoadModelData(files.paths[i], &data)) continue;
+        glbBytes += GLB_ModelDataSize(&data);
+        GLB_UnloadModelData(&data);
+    }
+    f64 glbSeconds = Bench_Seconds() - start;
+
+    start = Bench_Seconds();
+    Pack *pack = Pack_Open(packFile);
+    if (pack == NULL) return 1;
+
+    u64 packBytes = 0;
+    u64 checksum = 0;
+    for (u32 i = 0; i < files.count; i++) {
+        i32 model = Pack_FindModel(pack, files.paths[i]);
+        if (model < 0) continue;
+
+        for (u32 m = 0; m < Pack_MeshCount(pack, (u32) model); m++) {
+            Mesh mesh = Pack_GetMesh(pack, (u32) model, m);
+            u64 vertexCount = (u64) mesh.vertexCount;
+            checksum += TouchBytes(mesh.vertices, vertexCount * 3 * sizeof(f32));
+            packBytes += vertexCount * 3 * sizeof(f32);
+            if (mesh.normals)   { checksum += TouchBytes(mesh.normals, vertexCount * 3 * sizeof(f32)); packBytes += vertexCount * 3 * sizeof(f32); }
+            if (mesh.texcoords) { checksum += TouchBytes(mesh.texcoords, vertexCount * 2 * sizeof(f32)); packBytes += vertexCount * 2 * sizeof(f32); }
+            if (mesh.colors)    { checksum += TouchBytes(mesh.colors, vertexCount * 4); packBytes += vertexCount * 4; }
+            if (mesh.indices)   { checksum += TouchBytes(mesh.indices, (u64) mesh.triangleCount * 3 * sizeof(u16)); packBytes += (u64) mesh.triangleCount * 3 * sizeof(u16); }
+        }
+    }
+    Pack_Close(pack);
+    f64 packSeconds = Bench_Seconds() - start;
+
+    Bench_Report("glb parse + decode", glbSeconds * 1000.0, "ms");
+    Bench_Report("glb cpu side data", (f64) glbBytes / (1024.0 * 1024.0), "MiB");
+    Bench_Report("pack map + read", packSeconds * 1000.0, "ms");
+    Bench_Report("pack mesh data", (f64) packBytes / (1024.0 * 1024.0), "MiB");
+    Bench_Report("speedup", glbSeconds / packSeconds, "x");
+    Bench_Report("checksum", (f64) (checksum & 0xffff), "");
+    return 0;
+}
+
+static int CompareGpu(FilePathList files, const char *packFile) {
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(64, 64, "fiddle-bench pack");
+
+    f64 start = Bench_Seconds();
+    for (u32 i = 0; i < files.count; i++) {
+        Model model = LoadModel(files.paths[i]);
+        // NOTE: UnloadModel() leaves textures alone
+        for (int m = 0; m < model.materialCount; m++) {
+            Texture2D albedo = model.materials[m].maps[MATERIAL_MAP_DIFFUSE].texture;
+            if (albedo.id != rlGetTextureIdDefault()) UnloadTexture(albedo);
+        }
+        UnloadModel(model);
+    }
+    f64 loadModelSeconds = Bench_Seconds() - start;
+
+    start = Bench_Seconds();
+    Pack *pack = Pack_Open(packFile);
+    if (pack == NULL) {
+        CloseWindow();
+        return 1;
+    }
+    for (u32 i = 0; i < files.count; i++) {
+        i32 index = Pack_FindModel(pack, files.paths[i]);
+        if (index < 0) continue;
+        Pack_UnloadModel(Pack_LoadModel(pack, (u32) index));
+    }
+    Pack_Close(pack);
+    f64 packSeconds = Bench_Seconds() - start;
+
+    CloseWindow();
+
+    Bench_Report("LoadModel", loadModelSeconds * 1000.0, "ms");
+    Bench_Report("Pack_LoadModel", packSeconds * 1000.0, "ms");
+    Bench_Report("speedup", loadModelSeconds / packSeconds, "x");
+    return 0;
+}
+
+int Bench_Pack(int argc, char **argv) {
+    const char *directory = Bench_ArgString(argc, argv, "dir", "data/models");
+    const char *packFile = Bench_ArgString(argc, argv, "pack", "data/models.pack");
+    const b8 gpu = Bench_ArgInt(argc, argv, "gpu", 0) != 0;
+
+    SetTraceLogLevel(LOG_WARNING);
+    if (!FileExists(packFile)) {
+        printf("  ERROR: '%s' not found, cook it first with: fiddle-cook %s %s\n", packFile, directory, packFile);
+        return 1;
+    }
+
+    FilePathList files = LoadDirectoryFilesEx(directory, ".glb", false);
+    Bench_Report("models", files.count, "");
+
+    int result = gpu ? CompareGpu(files, packFile) : CompareCpu(files, packFile);
+
+    UnloadDirectoryFiles(files);
+    return result;
+}
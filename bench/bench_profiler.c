@@ -0,0 +1,113 @@
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "profiler.h"
+#include "thread.h"
+
+// ----------------------------------------------------------------------------
+// Profiler overhead benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - cost of a nested pair of zones while the profiler is disabled and while it's enabled, in ns per zone
+// - then worker threads record zones as fast as they can while the main thread collects 'frames' every millisecond,
+//   every zone has to arrive exactly once unless a ring overflowed and counted it as dropped
+
+enum BenchProfilerConstExpr {
+    BENCH_PROFILER_THREADS = 4,
+};
+
+static atomic_bool stopWorkers;
+
+static int RecordZones(void *arg) {
+    u64 *recorded = arg;
+    Profiler_SetThreadName("worker");
+    while (!atomic_load_explicit(&stopWorkers, memory_order_relaxed)) {
+        Profiler_Zone outer = Profiler_Begin("outer");
+        for (int i = 0; i < 8; i++) {
+            Profiler_Zone inner = Profiler_Begin("inner");
+            Profiler_End(inner);
+        }
+        Profiler_End(outer);
+        *recorded += 9;
+    }
+    return 0;
+}
+
+// a zone around a few nested ones, repeated, returns ns per zone
+static f64 TimeZones(u64 count) {
+    f64 start = Bench_Seconds();
+    for (u64 i = 0; i < count; i += 4) {
+        Profiler_Zone outer = Profiler_Begin("outer");
+        Profiler_Zone a = Profiler_Begin("a");
+        Profiler_End(a);
+        Profiler_Zone b = Profiler_Begin("b");
+        Profiler_Zone c = Profiler_Begin("c");
+        Profiler_End(c);
+        Profiler_End(b);
+        Profiler_End(outer);
+
+        // the enabled run would overflow the ring without a collector
+        if ((i & 1023) == 0 && Profiler_IsEnabled()) Profiler_EndFrame();
+    }
+    return (Bench_Seconds() - start) * 1e9 / (f64) count;
+}
+
+int Bench_Profiler(int argc, char **argv) {
+    const u64 zones = (u64) Bench_ArgInt(argc, argv, "zones", 20 * 1000 * 1000);
+    const f64 seconds = (f64) Bench_ArgInt(argc, argv, "ms", 500) / 1000.0;
+
+    Profiler_Init();
+    Bench_Report("disabled", TimeZones(zones), "ns/zone");
+
+    Profiler_SetEnabled(true);
+    Bench_Report("enabled", TimeZones(zones / 4), "ns/zone");
+    Profiler_EndFrame();
+
+    Profiler_Stats before = Profiler_GetStats();
+    Thread threads[BENCH_PROFILER_THREADS];
+    u64 recorded[BENCH_PROFILER_THREADS] = {0};
+    atomic_store(&stopWorkers, false);
+    for (int i = 0; i < BENCH_PROFILER_THREADS; i++) {
+        Thread_Create(&threads[i], RecordZones, &recorded[i]);
+    }
+
+    u64 frames = 0;
+    f64 start = Bench_Seconds();
+    while (Bench_Seconds() - start < seconds) {
+        f64 frameStart = Bench_Seconds();
+        while (Bench_Seconds() - frameStart < 0.001) {}
+        Profiler_EndFrame();
+        frames++;
+    }
+    atomic_store(&stopWorkers, true);
+    for (int i = 0; i < BENCH_PROFILER_THREADS; i++) {
+        Thread_Join(&threads[i]);
+    }
+    f64 elapsed = Bench_Seconds() - start;
+    Profiler_EndFrame();
+
+    Profiler_Stats after = Profiler_GetStats();
+    u64 total = 0;
+    for (int i = 0; i < BENCH_PROFILER_THREADS; i++) {
+        total += recorded[i];
+    }
+    u64 collected = after.zones - before.zones;
+    u64 dropped = after.dropped - before.dropped;
+
+    Bench_Report("threads", BENCH_PROFILER_THREADS, "");
+    Bench_Report("collector frames", (f64) frames, "");
+    Bench_Report("recorded", (f64) total / elapsed / 1e6, "Mzones/s");
+    Bench_Report("dropped", (f64) dropped, "zones");
+    Bench_Report("timestamp rate", after.ticksPerSecond / 1e9, "GHz");
+
+    Profiler_Shutdown();
+
+    if (collected + dropped != total) {
+        printf("  ERROR: %llu zones recorded, %llu collected and %llu dropped\n", (unsigned long long) total,
+               (unsigned long long) collected, (unsigned long long) dropped);
+        return 1;
+    }
+    return 0;
+}
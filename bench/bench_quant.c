@@ -0,0 +1,115 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "bench.h"
+#include "glb.h"
+#include "quant.h"
+
+// ----------------------------------------------------------------------------
+// Compact vertex layout benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - encodes every mesh in data/models the way Quant_UploadMesh() does and decodes it back the way the shaders do,
+//   reports buffer memory in both layouts and the largest differences against the float data
+// - position error is also given as pixels at 720p for a mesh filling the view height, the worst case on screen
+// - uv error is in texels of a 1024 texture, normal error in degrees
+
+int Bench_Quant(int argc, char **argv) {
+    const char *directory = Bench_ArgString(argc, argv, "dir", "data/models");
+
+    SetTraceLogLevel(LOG_WARNING);
+    FilePathList files = LoadDirectoryFilesEx(directory, ".glb", false);
+    if (files.count == 0) {
+        printf("  ERROR: no .glb files found in '%s' (run from the repository root or pass --dir=)\n", directory);
+        UnloadDirectoryFiles(files);
+        return 1;
+    }
+
+    u32 modelCount = 0, meshCount = 0;
+    u64 vertexCount = 0, indexBytes = 0, floatBytes = 0, compactBytes = 0;
+    f64 encodeSeconds = 0;
+    f64 maxPosition = 0, maxPositionRelative = 0, maxTexcoord = 0, maxNormal = 0, sumNormal = 0;
+    u64 normalCount = 0;
+
+    for (u32 f = 0; f < files.count; f++) {
+        GLB_ModelData data;
+        if (!GLB_LoadModelData(files.paths[f], &data)) continue;
+        modelCount++;
+
+        for (int m = 0; m < data.meshCount; m++) {
+            const Mesh *mesh = &data.meshes[m];
+            if (mesh->vertices == NULL || mesh->vertexCount == 0) continue;
+
+            u32 count = (u32) mesh->vertexCount;
+            Quant_Vertex *encoded = malloc(count * sizeof(Quant_Vertex));
+
+            f64 start = Bench_Seconds();
+            Vector4 decode = Quant_EncodeVertices(mesh, encoded);
+            encodeSeconds += Bench_Seconds() - start;
+
+            meshCount++;
+            vertexCount += count;
+            floatBytes += Quant_MeshBytes(mesh, false);
+            compactBytes += Quant_MeshBytes(mesh, true);
+            if (mesh->indices) indexBytes += (u64) mesh->triangleCount * 3 * sizeof(unsigned short);
+
+            const Vector3 *positions = (const Vector3 *) mesh->vertices;
+            const Vector3 *normals = (const Vector3 *) mesh->normals;
+            const Vector2 *texcoords = (const Vector2 *) mesh->texcoords;
+            for (u32 i = 0; i < count; i++) {
+                Vector3 position, normal;
+                Vector2 texcoord;
+                Quant_DecodeVertex(&encoded[i], decode, &position, &texcoord, &normal);
+
+                f64 positionError = Vector3Distance(position, positions[i]);
+                maxPosition = fmax(maxPosition, positionError);
+                maxPositionRelative = fmax(maxPositionRelative, positionError / decode.w);
+
+                if (texcoords) {
+                    maxTexcoord = fmax(maxTexcoord, fabsf(texcoord.x - texcoords[i].x));
+                    maxTexcoord = fmax(maxTexcoord, fabsf(texcoord.y - texcoords[i].y));
+                }
+
+                if (normals && Vector3Length(normals[i]) > 0) {
+                    f32 cosine = Clamp(Vector3DotProduct(normal, Vector3Normalize(normals[i])), -1.0f, 1.0f);
+                    f64 degrees = acosf(cosine) * RAD2DEG;
+                    maxNormal = fmax(maxNormal, degrees);
+                    sumNormal += degrees;
+                    normalCount++;
+                }
+            }
+            free(encoded);
+        }
+        GLB_UnloadModelData(&data);
+    }
+    UnloadDirectoryFiles(files);
+
+    if (meshCount == 0) {
+        printf("  ERROR: no meshes found in '%s'\n", directory);
+        return 1;
+    }
+
+    const f64 megabyte = 1024.0 * 1024.0;
+    Bench_Report("models", modelCount, "");
+    Bench_Report("meshes", meshCount, "");
+    Bench_Report("vertices", (f64) vertexCount, "");
+    Bench_Report("vertex buffers, float", (f64) (floatBytes - indexBytes) / megabyte, "MB");
+    Bench_Report("vertex buffers, compact", (f64) (compactBytes - indexBytes) / megabyte, "MB");
+    Bench_Report("with index buffers, float", (f64) floatBytes / megabyte, "MB");
+    Bench_Report("with index buffers, compact", (f64) compactBytes / megabyte, "MB");
+    Bench_Report("vertex memory saved", 100.0 * (1.0 - (f64) (compactBytes - indexBytes) / (f64) (floatBytes - indexBytes)), "%");
+    Bench_Report("encode", encodeSeconds * 1000.0, "ms");
+    Bench_Report("encode per vertex", encodeSeconds * 1e9 / (f64) vertexCount, "ns");
+    Bench_Report("max position error", maxPosition * 1000.0, "mm");
+    Bench_Report("max position error / mesh extent", maxPositionRelative * 1e6, "ppm");
+    Bench_Report("max position error at 720p", maxPositionRelative * 720.0, "px");
+    Bench_Report("max uv error, 1024 texture", maxTexcoord * 1024.0, "texels");
+    Bench_Report("max normal error", maxNormal, "deg");
+    Bench_Report("mean normal error", normalCount ? sumNormal / (f64) normalCount : 0, "deg");
+    return 0;
+}
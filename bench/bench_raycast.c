@@ -0,0 +1,221 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+
+#include "bench.h"
+#include "raycast.h"
+
+// ----------------------------------------------------------------------------
+// Tile map raycasting benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - the map is a grid of 16x16 rooms with doorways plus scattered wall blocks, like the tilemap benchmark
+// - three workloads: incoherent rays (random origins and directions, think AI probes), view column fans
+//   from random spots (the first-person visibility pass) and line of sight checks between nearby points
+// - each is cast one ray at a time through Raycast_Cast(), then as SIMD batches on one thread, then threaded
+// - every batch result is checked against the one ray at a time result, they have to agree exactly
+
+enum BenchRaycastConstExpr {
+    BENCH_RAYCAST_ROOM_SIZE = 16,
+    BENCH_RAYCAST_COLUMNS = 1280,
+};
+
+static TileMap *CreateMap(u32 size) {
+    TileMap *map = TileMap_Create(size, size, 4);
+
+    for (u32 i = 0; i < size; i += BENCH_RAYCAST_ROOM_SIZE) {
+        TileMap_Fill(map, (i32) i, 0, 1, (i32) size, 1);
+        TileMap_Fill(map, 0, (i32) i, (i32) size, 1, 1);
+    }
+    TileMap_Fill(map, (i32) size - 1, 0, 1, (i32) size, 1);
+    TileMap_Fill(map, 0, (i32) size - 1, (i32) size, 1, 1);
+    for (u32 y = 0; y < size; y += BENCH_RAYCAST_ROOM_SIZE) {
+        for (u32 x = 0; x < size; x += BENCH_RAYCAST_ROOM_SIZE) {
+            TileMap_Fill(map, (i32) (x + 6), (i32) y, 4, 1, 0);
+            TileMap_Fill(map, (i32) x, (i32) (y + 6), 1, 4, 0);
+        }
+    }
+
+    u32 blocks = size * size / 512;
+    for (u32 i = 0; i < blocks; i++) {
+        i32 x = (i32) (Bench_RandomU32() % size);
+        i32 y = (i32) (Bench_RandomU32() % size);
+        TileMap_Fill(map, x, y, 1 + (i32) (Bench_RandomU32() % 3), 1 + (i32) (Bench_RandomU32() % 3), 1);
+    }
+    return map;
+}
+
+// somewhere not inside a wall
+static Vector2 RandomOpenPoint(const TileMap *map) {
+    f32 extent = (f32) TileMap_Width(map) * TileMap_TileSize(map);
+    for (;;) {
+        Vector2 point = { Bench_RandomRange(0, extent), Bench_RandomRange(0, extent) };
+        i32 x = (i32) (point.x / TileMap_TileSize(map));
+        i32 y = (i32) (point.y / TileMap_TileSize(map));
+        if (TileMap_Get(map, x, y) != 1) return point;
+    }
+}
+
+static b8 SameHit(Raycast_Hit a, Raycast_Hit b) {
+    return a.hit == b.hit && a.tileX == b.tileX && a.tileY == b.tileY && a.tile == b.tile && a.side == b.side
+        && fabsf(a.distance - b.distance) <= 1e-3f * (1 + fabsf(a.distance));
+}
+
+// casts the rays every way there is, reports rays per second for each, returns the number of mismatches
+static u32 RunCasts(const TileMap *map, const Raycast_Ray *rays, u32 count, int repeats, const char *label) {
+    Raycast_Hit *reference = malloc(sizeof(Raycast_Hit) * count);
+    Raycast_Hit *hits = malloc(sizeof(Raycast_Hit) * count);
+    char name[64];
+
+    u64 hitCount = 0;
+    f64 start = Bench_Seconds();
+    for (int r = 0; r < repeats; r++) {
+        for (u32 i = 0; i < count; i++) {
+            reference[i] = Raycast_Cast(map, rays[i]);
+        }
+    }
+    f64 scalar = Bench_Seconds() - start;
+    for (u32 i = 0; i < count; i++) {
+        hitCount += reference[i].hit;
+    }
+
+    Raycast_SetThreaded(false);
+    start = Bench_Seconds();
+    for (int r = 0; r < repeats; r++) {
+        Raycast_CastBatch(map, rays, hits, count);
+    }
+    f64 packet = Bench_Seconds() - start;
+
+    u32 errors = 0;
+    for (u32 i = 0; i < count; i++) {
+        errors += !SameHit(reference[i], hits[i]);
+    }
+
+    Raycast_SetThreaded(true);
+    start = Bench_Seconds();
+    for (int r = 0; r < repeats; r++) {
+        Raycast_CastBatch(map, rays, hits, count);
+    }
+    f64 threaded = Bench_Seconds() - start;
+
+    for (u32 i = 0; i < count; i++) {
+        errors += !SameHit(reference[i], hits[i]);
+    }
+
+    f64 total = (f64) count * repeats;
+    snprintf(name, sizeof(name), "%s scalar", label);
+    Bench_Report(name, total / scalar / 1e6, "Mrays/s");
+    snprintf(name, sizeof(name), "%s SIMD batch", label);
+    Bench_Report(name, total / packet / 1e6, "Mrays/s");
+    snprintf(name, sizeof(name), "%s SIMD batch threaded", label);
+    Bench_Report(name, total / threaded / 1e6, "Mrays/s");
+    snprintf(name, sizeof(name), "%s hit rate", label);
+    Bench_Report(name, 100.0 * (f64) hitCount / count, "%");
+
+    free(hits);
+    free(reference);
+    return errors;
+}
+
+static u32 RunLineOfSight(const TileMap *map, u32 count, int repeats) {
+    Vector2 *from = malloc(sizeof(Vector2) * count);
+    Vector2 *to = malloc(sizeof(Vector2) * count);
+    b8 *reference = malloc(count);
+    b8 *visible = malloc(count);
+
+    f32 range = 24 * TileMap_TileSize(map);
+    for (u32 i = 0; i < count; i++) {
+        from[i] = RandomOpenPoint(map);
+        to[i] = (Vector2) { from[i].x + Bench_RandomRange(-range, range), from[i].y + Bench_RandomRange(-range, range) };
+    }
+
+    u64 visibleCount = 0;
+    f64 start = Bench_Seconds();
+    for (int r = 0; r < repeats; r++) {
+        for (u32 i = 0; i < count; i++) {
+            reference[i] = Raycast_LineOfSight(map, from[i], to[i]);
+        }
+    }
+    f64 scalar = Bench_Seconds() - start;
+    for (u32 i = 0; i < count; i++) {
+        visibleCount += reference[i];
+    }
+
+    Raycast_SetThreaded(true);
+    start = Bench_Seconds();
+    for (int r = 0; r < repeats; r++) {
+        Raycast_LineOfSightBatch(map, from, to, visible, count);
+    }
+    f64 threaded = Bench_Seconds() - start;
+
+    u32 errors = 0;
+    for (u32 i = 0; i < count; i++) {
+        errors += (reference[i] != visible[i]);
+    }
+
+    f64 total = (f64) count * repeats;
+    Bench_Report("line of sight scalar", total / scalar / 1e6, "Mchecks/s");
+    Bench_Report("line of sight SIMD batch threaded", total / threaded / 1e6, "Mchecks/s");
+    Bench_Report("line of sight visible", 100.0 * (f64) visibleCount / count, "%");
+
+    free(visible);
+    free(reference);
+    free(to);
+    free(from);
+    return errors;
+}
+
+int Bench_Raycast(int argc, char **argv) {
+    const u32 size = (u32) Bench_ArgInt(argc, argv, "size", 1024);
+    const u32 count = (u32) Bench_ArgInt(argc, argv, "rays", 1 << 20);
+    const int repeats = (int) Bench_ArgInt(argc, argv, "repeats", 4);
+    const int workers = (int) Bench_ArgInt(argc, argv, "workers", 0);
+
+    Bench_Seed(1);
+    TileMap *map = CreateMap(size);
+    Raycast_Init(workers);
+    f32 maxDistance = 64 * TileMap_TileSize(map);
+
+    Raycast_Ray *rays = malloc(sizeof(Raycast_Ray) * count);
+    for (u32 i = 0; i < count; i++) {
+        f32 angle = Bench_RandomRange(0, 2 * PI);
+        rays[i] = (Raycast_Ray) { RandomOpenPoint(map), { cosf(angle), sinf(angle) }, maxDistance };
+    }
+
+    Bench_Report("map tiles", (f64) size * size, "");
+    Bench_Report("rays per pass", count, "");
+
+    u32 errors = RunCasts(map, rays, count, repeats, "incoherent");
+
+    // whole view fans, each packet is 4 neighbouring columns
+    u32 fans = count / BENCH_RAYCAST_COLUMNS;
+    for (u32 f = 0; f < fans; f++) {
+        Vector2 origin = RandomOpenPoint(map);
+        f32 angle = Bench_RandomRange(0, 2 * PI);
+        Vector2 forward = { cosf(angle), sinf(angle) };
+        for (u32 c = 0; c < BENCH_RAYCAST_COLUMNS; c++) {
+            f32 x = 2.0f * (f32) c / (BENCH_RAYCAST_COLUMNS - 1) - 1.0f;
+            rays[f * BENCH_RAYCAST_COLUMNS + c] = (Raycast_Ray) {
+                    .origin = origin,
+                    .direction = { forward.x - forward.y * x, forward.y + forward.x * x },
+                    .maxDistance = maxDistance,
+            };
+        }
+    }
+    errors += RunCasts(map, rays, fans * BENCH_RAYCAST_COLUMNS, repeats, "view columns");
+
+    errors += RunLineOfSight(map, count, repeats);
+
+    Raycast_Shutdown();
+    free(rays);
+    TileMap_Unload(map);
+
+    if (errors > 0) {
+        printf("  ERROR: %u batched results differ from single ray casts\n", errors);
+        return 1;
+    }
+    return 0;
+}
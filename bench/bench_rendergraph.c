@@ -0,0 +1,232 @@
+#include <stdio.h>
+
+#include "raylib.h"
+
+#include "bench.h"
+#include "rendergraph.h"
+
+// ----------------------------------------------------------------------------
+// Render graph benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - the graph is handed stand-in textures, only ids and sizes, and the passes' draw functions record which
+//   texture they got instead of drawing, so it runs without a GL context
+// - aliasing: transients whose lifetimes don't overlap must share one pooled texture, ones that do must not,
+//   and a chain of transients each read by the next only needs two
+// - culling: a pass whose transient output nobody reads must not run, and a culled pass reading a transient
+//   must neither free its texture before the passes that do run have read it nor hold on to it after them
+// - skipping: a pass drawing to an imported target runs again only when its inputs change
+// - then a frame of a long transient chain is executed repeatedly for the cost of the graph itself
+
+enum BenchRenderGraphConstExpr {
+    BENCH_GRAPH_SIZE = 64,
+    BENCH_GRAPH_CHAIN = 8,
+};
+
+static struct BenchTextures {
+    u32 nextId;
+    u32 loaded;
+    u32 unloaded;
+} benchTextures = {0};
+
+static RenderTexture2D LoadStandIn(int width, int height) {
+    benchTextures.loaded++;
+    return (RenderTexture2D) {
+            .id = ++benchTextures.nextId,
+            .texture = { .id = benchTextures.nextId, .width = width, .height = height }
+    };
+}
+
+static void UnloadStandIn(RenderTexture2D texture) {
+    (void) texture;
+    benchTextures.unloaded++;
+}
+
+// what a pass saw when it ran
+struct BenchPass {
+    u32 draws;
+    u32 output;                         // texture id drawn to, 0 for the screen
+    RenderGraph_Target reads[RENDERGRAPH_MAX_READS];
+    u32 readCount;
+    u32 readIds[RENDERGRAPH_MAX_READS];
+};
+
+static void RecordPass(RenderTexture2D target, void *user) {
+    struct BenchPass *pass = user;
+    pass->draws++;
+    pass->output = target.id;
+    for (u32 i = 0; i < pass->readCount; i++) {
+        pass->readIds[i] = RenderGraph_GetTexture(pass->reads[i]).id;
+    }
+}
+
+static void AddPass(struct BenchPass *record, RenderGraph_Target output, const RenderGraph_Target *reads, u32 readCount,
+                    u64 inputs) {
+    RenderGraph_Pass pass = { .name = "bench", .draw = RecordPass, .user = record, .output = output, .inputs = inputs };
+    record->readCount = readCount;
+    for (u32 i = 0; i < readCount; i++) {
+        pass.reads[i] = record->reads[i] = reads[i];
+    }
+    pass.readCount = readCount;
+    RenderGraph_AddPass(&pass);
+}
+
+static u32 Check(b8 ok, const char *what) {
+    if (!ok) printf("  ERROR: %s\n", what);
+    return ok ? 0 : 1;
+}
+
+// A is drawn and read, then B is drawn and read, B can take A's texture
+static u32 CheckDisjoint(void) {
+    RenderGraph_Target a = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    RenderGraph_Target b = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    struct BenchPass passes[4] = {0};
+    AddPass(&passes[0], a, NULL, 0, 0);
+    AddPass(&passes[1], RENDERGRAPH_SCREEN, &a, 1, 0);
+    AddPass(&passes[2], b, NULL, 0, 0);
+    AddPass(&passes[3], RENDERGRAPH_SCREEN, &b, 1, 0);
+    RenderGraph_Execute();
+
+    RenderGraph_Stats stats = RenderGraph_GetStats();
+    u32 errors = 0;
+    errors += Check(stats.executed == 4, "disjoint: every pass should run");
+    errors += Check(passes[0].output != 0 && passes[0].output == passes[2].output,
+                    "disjoint: transients with separate lifetimes should share a texture");
+    errors += Check(passes[1].readIds[0] == passes[0].output && passes[3].readIds[0] == passes[2].output,
+                    "disjoint: readers should see the texture their transient was drawn to");
+    errors += Check(stats.transients == 2 && stats.pooled == 1, "disjoint: 2 transients should need 1 texture");
+    return errors;
+}
+
+// A and B are both read by the last pass, they can't share
+static u32 CheckOverlapping(void) {
+    RenderGraph_Target a = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    RenderGraph_Target b = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    struct BenchPass passes[3] = {0};
+    AddPass(&passes[0], a, NULL, 0, 0);
+    AddPass(&passes[1], b, NULL, 0, 0);
+    AddPass(&passes[2], RENDERGRAPH_SCREEN, (RenderGraph_Target[]) { a, b }, 2, 0);
+    RenderGraph_Execute();
+
+    RenderGraph_Stats stats = RenderGraph_GetStats();
+    u32 errors = 0;
+    errors += Check(passes[0].output != passes[1].output, "overlapping: live transients shouldn't share a texture");
+    errors += Check(passes[2].readIds[0] == passes[0].output && passes[2].readIds[1] == passes[1].output,
+                    "overlapping: the reader should see both textures as drawn");
+    errors += Check(stats.pooled == 2, "overlapping: 2 live transients should need 2 textures");
+    return errors;
+}
+
+// C is drawn from A but nobody reads C, that pass is culled and must not end A's lifetime before the last pass
+static u32 CheckCulled(void) {
+    RenderGraph_Target a = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    RenderGraph_Target b = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    RenderGraph_Target c = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    struct BenchPass passes[4] = {0};
+    AddPass(&passes[0], a, NULL, 0, 0);
+    AddPass(&passes[1], c, &a, 1, 0);
+    AddPass(&passes[2], b, NULL, 0, 0);
+    AddPass(&passes[3], RENDERGRAPH_SCREEN, (RenderGraph_Target[]) { a, b }, 2, 0);
+    RenderGraph_Execute();
+
+    RenderGraph_Stats stats = RenderGraph_GetStats();
+    u32 errors = 0;
+    errors += Check(passes[1].draws == 0 && stats.culled == 1, "culled: a pass nobody needs should not run");
+    errors += Check(passes[2].output != passes[0].output, "culled: a culled reader freed its input early");
+    errors += Check(passes[3].readIds[0] == passes[0].output, "culled: the last reader lost its input");
+    errors += Check(stats.transients == 2 && stats.pooled == 2, "culled: the culled output should get no texture");
+    return errors;
+}
+
+// the culled pass is the last to read A, it mustn't keep A's texture from B either
+static u32 CheckCulledLastReader(void) {
+    RenderGraph_Target a = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    RenderGraph_Target b = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    RenderGraph_Target c = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    struct BenchPass passes[5] = {0};
+    AddPass(&passes[0], a, NULL, 0, 0);
+    AddPass(&passes[1], RENDERGRAPH_SCREEN, &a, 1, 0);
+    AddPass(&passes[2], c, &a, 1, 0);
+    AddPass(&passes[3], b, NULL, 0, 0);
+    AddPass(&passes[4], RENDERGRAPH_SCREEN, &b, 1, 0);
+    RenderGraph_Execute();
+
+    RenderGraph_Stats stats = RenderGraph_GetStats();
+    u32 errors = 0;
+    errors += Check(passes[2].draws == 0 && stats.culled == 1, "culled last reader: a pass nobody needs should not run");
+    errors += Check(passes[3].output == passes[0].output && stats.pooled == 1,
+                    "culled last reader: a culled reader kept its input alive");
+    return errors;
+}
+
+// a pass into an imported target only runs again when its inputs change
+static u32 CheckSkipped(void) {
+    RenderTexture2D texture = { .id = 1000, .texture = { .id = 1000, .width = BENCH_GRAPH_SIZE, .height = BENCH_GRAPH_SIZE } };
+    RenderGraph_Target imported = RenderGraph_ImportTarget(texture);
+    struct BenchPass passes[2] = {0};
+    const u64 inputs[] = { 1, 1, 2 };
+    u32 errors = 0;
+    for (u32 frame = 0; frame < sizeof(inputs) / sizeof(inputs[0]); frame++) {
+        AddPass(&passes[0], imported, NULL, 0, inputs[frame]);
+        AddPass(&passes[1], RENDERGRAPH_SCREEN, &imported, 1, 0);
+        RenderGraph_Execute();
+    }
+    RenderGraph_Stats stats = RenderGraph_GetStats();
+    errors += Check(passes[0].draws == 2, "skipped: the imported pass should run on the first and the changed frame");
+    errors += Check(passes[1].draws == 3, "skipped: passes to the screen always run");
+    errors += Check(stats.skipped == 0 && stats.executed == 2, "skipped: the last frame's inputs changed");
+    return errors;
+}
+
+// T0 -> T1 -> ... -> screen, each transient read by the next pass, drawn while the previous one is still read
+static void AddChain(const RenderGraph_Target *chain, struct BenchPass *passes, u64 inputs) {
+    AddPass(&passes[0], chain[0], NULL, 0, inputs);
+    for (u32 i = 1; i < BENCH_GRAPH_CHAIN; i++) {
+        AddPass(&passes[i], chain[i], &chain[i - 1], 1, 0);
+    }
+    AddPass(&passes[BENCH_GRAPH_CHAIN], RENDERGRAPH_SCREEN, &chain[BENCH_GRAPH_CHAIN - 1], 1, 0);
+}
+
+int Bench_RenderGraph(int argc, char **argv) {
+    const u32 frames = (u32) Bench_ArgInt(argc, argv, "frames", 100000);
+
+    u32 (*checks[])(void) = { CheckDisjoint, CheckOverlapping, CheckCulled, CheckCulledLastReader, CheckSkipped };
+    u32 errors = 0;
+    for (u32 i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+        RenderGraph_Init(LoadStandIn, UnloadStandIn);
+        errors += checks[i]();
+        RenderGraph_Shutdown();
+    }
+
+    RenderGraph_Init(LoadStandIn, UnloadStandIn);
+    RenderGraph_Target chain[BENCH_GRAPH_CHAIN];
+    for (u32 i = 0; i < BENCH_GRAPH_CHAIN; i++) {
+        chain[i] = RenderGraph_CreateTransient(BENCH_GRAPH_SIZE, BENCH_GRAPH_SIZE);
+    }
+    struct BenchPass passes[BENCH_GRAPH_CHAIN + 1] = {0};
+    f64 start = Bench_Seconds();
+    for (u32 frame = 0; frame < frames; frame++) {
+        AddChain(chain, passes, frame);
+        RenderGraph_Execute();
+    }
+    f64 seconds = Bench_Seconds() - start;
+    RenderGraph_Stats stats = RenderGraph_GetStats();
+    RenderGraph_Shutdown();
+
+    errors += Check(stats.pooled == 2, "chain: a transient chain should ping-pong between 2 textures");
+    errors += Check(benchTextures.loaded == benchTextures.unloaded, "every pooled texture should be unloaded");
+
+    Bench_Report("chain passes", BENCH_GRAPH_CHAIN + 1, "");
+    Bench_Report("chain transients", stats.transients, "");
+    Bench_Report("chain pooled textures", stats.pooled, "");
+    Bench_Report("execute (per frame)", seconds * 1e6 / frames, "us");
+    Bench_Report("textures loaded", benchTextures.loaded, "");
+    Bench_Report("errors", errors, "");
+
+    if (errors > 0) {
+        printf("  ERROR: %u render graph checks failed\n", errors);
+        return 1;
+    }
+    return 0;
+}
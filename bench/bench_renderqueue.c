@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+
+#include "bench.h"
+#include "renderqueue.h"
+#include "thread.h"
+
+// ----------------------------------------------------------------------------
+// Render queue benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - 100k draws over a few shaders, materials and a couple thousand meshes at random depths, submitted in random
+//   order like culling hands them out, then recorded, sorted and executed every frame for a number of frames
+// - state changes are counted in submission order and after sorting, the sort is compared with qsort() on the
+//   same keys, recording is timed on one thread and split over several lanes
+// - execution only visits the payloads, the draws themselves need a GL context
+// - material ids are checked to keep a thousand diffuse textures with sparse GL ids apart
+
+enum BenchRenderQueueConstExpr {
+    BENCH_QUEUE_SHADERS = 4,
+    BENCH_QUEUE_MATERIALS = 64,
+    BENCH_QUEUE_MESHES = 2048,
+    BENCH_QUEUE_TEXTURES = 1000,
+    BENCH_QUEUE_TEXTURE_ID_STRIDE = 977,    // ids left sparse by loads and unloads
+};
+
+struct BenchDraw {
+    u32 shader;
+    u32 material;
+    u32 mesh;
+    f32 depth;
+};
+
+// about the size of what the first person pass records
+struct BenchPayload {
+    const void *mesh;
+    const void *material;
+    f32 transform[16];
+    u32 tint;
+};
+
+struct BenchRecordJob {
+    const struct BenchDraw *draws;
+    u32 first;
+    u32 count;
+    u32 lane;
+};
+
+static int RecordDraws(void *arg) {
+    const struct BenchRecordJob *job = arg;
+    for (u32 i = job->first; i < job->first + job->count; i++) {
+        const struct BenchDraw *draw = &job->draws[i];
+        u64 key = RenderQueue_Key(0, RenderQueue_Layer_Opaque, draw->shader, draw->material, draw->mesh, draw->depth);
+        struct BenchPayload *payload = RenderQueue_Push(job->lane, key, sizeof(struct BenchPayload));
+        if (payload == NULL) continue;
+        *payload = (struct BenchPayload) { .mesh = draw, .tint = i };
+        payload->transform[12] = draw->depth;
+    }
+    return 0;
+}
+
+struct BenchVisit {
+    u64 checksum;
+    u64 previousKey;
+    u32 outOfOrder;
+};
+
+static void VisitPayload(u64 key, const void *payload, void *user) {
+    struct BenchVisit *visit = user;
+    const struct BenchPayload *draw = payload;
+    visit->checksum += draw->tint;
+    visit->outOfOrder += key < visit->previousKey;
+    visit->previousKey = key;
+}
+
+static int CompareKeys(const void *a, const void *b) {
+    u64 keyA = *(const u64 *) a;
+    u64 keyB = *(const u64 *) b;
+    return (keyA > keyB) - (keyA < keyB);
+}
+
+int Bench_RenderQueue(int argc, char **argv) {
+    const u32 drawCount = (u32) Bench_ArgInt(argc, argv, "draws", 100000);
+    const u32 frames = (u32) Bench_ArgInt(argc, argv, "frames", 50);
+    u32 threads = (u32) Bench_ArgInt(argc, argv, "threads", 4);
+    if (threads < 1) threads = 1;
+    if (threads > RENDERQUEUE_MAX_LANES) threads = RENDERQUEUE_MAX_LANES;
+
+    Bench_Seed(21);
+    struct BenchDraw *draws = malloc(drawCount * sizeof(struct BenchDraw));
+    u64 *keys = malloc(drawCount * sizeof(u64));
+    for (u32 i = 0; i < drawCount; i++) {
+        // meshes stick to a material and materials to a shader, like models do
+        u32 mesh = Bench_RandomU32() % BENCH_QUEUE_MESHES;
+        u32 material = mesh % BENCH_QUEUE_MATERIALS;
+        draws[i] = (struct BenchDraw) {
+                .shader = 1 + material % BENCH_QUEUE_SHADERS,
+                .material = 1 + material,
+                .mesh = 1 + mesh,
+                .depth = Bench_RandomRange(0, 1)
+        };
+    }
+
+    // state changes drawing in submission order
+    u32 unsortedShader = 0, unsortedMaterial = 0, unsortedMesh = 0;
+    for (u32 i = 0; i < drawCount; i++) {
+        const struct BenchDraw *draw = &draws[i];
+        const struct BenchDraw *previous = (i > 0) ? &draws[i - 1] : NULL;
+        unsortedShader += previous == NULL || previous->shader != draw->shader;
+        unsortedMaterial += previous == NULL || previous->material != draw->material;
+        unsortedMesh += previous == NULL || previous->mesh != draw->mesh;
+    }
+
+    RenderQueue_Init();
+
+    f64 recordSeconds = 0, threadedSeconds = 0, sortSeconds = 0, executeSeconds = 0;
+    struct BenchVisit visit = {0};
+    for (u32 frame = 0; frame < frames; frame++) {
+        // one lane
+        RenderQueue_Begin();
+        f64 start = Bench_Seconds();
+        RecordDraws(&(struct BenchRecordJob) { draws, 0, drawCount, 0 });
+        recordSeconds += Bench_Seconds() - start;
+
+        // the same draws split over threads, this is the set that gets sorted and executed
+        RenderQueue_Begin();
+        Thread workers[RENDERQUEUE_MAX_LANES];
+        struct BenchRecordJob jobs[RENDERQUEUE_MAX_LANES];
+        start = Bench_Seconds();
+        for (u32 t = 0; t < threads; t++) {
+            u32 first = drawCount * t / threads;
+            jobs[t] = (struct BenchRecordJob) { draws, first, drawCount * (t + 1) / threads - first, t };
+            Thread_Create(&workers[t], RecordDraws, &jobs[t]);
+        }
+        for (u32 t = 0; t < threads; t++) Thread_Join(&workers[t]);
+        threadedSeconds += Bench_Seconds() - start;
+
+        RenderQueue_Sort();
+        sortSeconds += RenderQueue_GetStats().sortSeconds;
+
+        visit.previousKey = 0;
+        start = Bench_Seconds();
+        RenderQueue_Execute(VisitPayload, &visit);
+        executeSeconds += Bench_Seconds() - start;
+    }
+    RenderQueue_Stats stats = RenderQueue_GetStats();
+
+    // baseline: qsort of the bare keys, without the payload pointers the radix sort carries along
+    f64 qsortSeconds = 0;
+    for (u32 frame = 0; frame < frames; frame++) {
+        for (u32 i = 0; i < drawCount; i++) {
+            const struct BenchDraw *draw = &draws[i];
+            keys[i] = RenderQueue_Key(0, RenderQueue_Layer_Opaque, draw->shader, draw->material, draw->mesh, draw->depth);
+        }
+        f64 start = Bench_Seconds();
+        qsort(keys, drawCount, sizeof(u64), CompareKeys);
+        qsortSeconds += Bench_Seconds() - start;
+    }
+
+    char name[64];
+    Bench_Report("draws", drawCount, "");
+    Bench_Report("record, 1 thread", recordSeconds * 1000.0 / frames, "ms");
+    snprintf(name, sizeof(name), "record, %u threads", threads);
+    Bench_Report(name, threadedSeconds * 1000.0 / frames, "ms");
+    Bench_Report("radix sort (merge included)", sortSeconds * 1000.0 / frames, "ms");
+    Bench_Report("qsort of the keys", qsortSeconds * 1000.0 / frames, "ms");
+    Bench_Report("sort speedup", qsortSeconds / sortSeconds, "x");
+    Bench_Report("execute (payload visit)", executeSeconds * 1000.0 / frames, "ms");
+    Bench_Report("shader changes, submission order", unsortedShader, "");
+    Bench_Report("shader changes, sorted", stats.shaderChanges, "");
+    Bench_Report("material changes, submission order", unsortedMaterial, "");
+    Bench_Report("material changes, sorted", stats.materialChanges, "");
+    Bench_Report("mesh changes, submission order", unsortedMesh, "");
+    Bench_Report("mesh changes, sorted", stats.meshChanges, "");
+    Bench_Report("draws out of key order", visit.outOfOrder, "");
+    Bench_Report("checksum", (f64) (visit.checksum % 1000000), "");
+
+    // materials with different textures must never share an id or they'd sort together, one set of maps
+    // retextured so the maps hash can't tell them apart either
+    MaterialMap map = {0};
+    static u8 seen[1 << 16];
+    u32 sharedIds = 0;
+    for (u32 i = 0; i < BENCH_QUEUE_TEXTURES; i++) {
+        map.texture.id = 1 + i * BENCH_QUEUE_TEXTURE_ID_STRIDE;
+        u32 id = RenderQueue_MaterialId((Material) { .maps = &map }) & 0xffff;
+        sharedIds += seen[id];
+        seen[id] = 1;
+    }
+    Bench_Report("textures sharing a material id", sharedIds, "");
+
+    RenderQueue_Shutdown();
+    free(keys);
+    free(draws);
+
+    if (sharedIds > 0) {
+        printf("  ERROR: %u of %u textures got another texture's material id\n", sharedIds, BENCH_QUEUE_TEXTURES);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+
+#include "bench.h"
+#include "sim.h"
+
+// ----------------------------------------------------------------------------
+// Fixed timestep simulation benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - headless fast-forward: ticks run back to back with no window, reported as ticks per second
+// - input comes from a recording made in the game with F9 (--input=input.rec), or a generated minute of
+//   random button mashing when there isn't one
+// - determinism is checked three ways, all have to land on the same final state hash:
+//   the fast-forward run twice, and the same ticks driven through Sim_ClockAdvance() by frames of random length
+
+enum BenchSimConstExpr {
+    BENCH_SIM_GENERATED_TICKS = 60 * SIM_TICK_RATE,
+};
+
+static void GenerateRecording(Sim_Recording *recording) {
+    recording->start = Sim_InitState((Vector2) { 100, 100 }, (Vector2) { 500, 500 });
+
+    Sim_Input input = {0};
+    for (u32 i = 0; i < BENCH_SIM_GENERATED_TICKS; i++) {
+        // hold a set of buttons for a while, with the odd wheel nudge and view reset
+        if (Bench_RandomU32() % 20 == 0) input.buttons = Bench_RandomU32() & ~(u32) Sim_Button_ResetView & 0x3f;
+        Sim_Input tick = input;
+        if (Bench_RandomU32() % 30 == 0) tick.zoom = Bench_RandomRange(-2, 2);
+        if (Bench_RandomU32() % 200 == 0) tick.buttons |= Sim_Button_ResetView;
+        Sim_RecordingAppend(recording, tick);
+    }
+}
+
+// the game's loop without the drawing: frames of random length, each running the ticks that are due
+static Sim_State RunFrames(const Sim_Recording *recording, u64 ticks, u64 *frames) {
+    Sim_State state = recording->start;
+    Sim_Clock clock = {0};
+    const Sim_Input none = {0};
+
+    u64 tick = 0;
+    *frames = 0;
+    while (tick < ticks) {
+        u32 due = Sim_ClockAdvance(&clock, Bench_RandomRange(0.002f, 0.05f));
+        for (u32 i = 0; i < due && tick < ticks; i++, tick++) {
+            Sim_Step(&state, recording->count > 0 ? recording->inputs[tick % recording->count] : none);
+        }
+        (*frames)++;
+    }
+    return state;
+}
+
+int Bench_Sim(int argc, char **argv) {
+    const u64 ticks = (u64) Bench_ArgInt(argc, argv, "ticks", 10 * 1000 * 1000);
+    const char *inputFile = Bench_ArgString(argc, argv, "input", NULL);
+
+    Bench_Seed(1);
+    Sim_Recording recording = {0};
+    if (inputFile != NULL) {
+        if (!Sim_RecordingLoad(&recording, inputFile)) {
+            printf("  ERROR: couldn't load input recording '%s'\n", inputFile);
+            return 1;
+        }
+    } else {
+        GenerateRecording(&recording);
+    }
+
+    Sim_State first = recording.start;
+    f64 ticksPerSecond = Sim_FastForward(&first, &recording, ticks);
+
+    Sim_State second = recording.start;
+    Sim_FastForward(&second, &recording, ticks);
+
+    u64 frames;
+    Sim_State framed = RunFrames(&recording, ticks, &frames);
+
+    Bench_Report("recorded ticks", recording.count, "");
+    Bench_Report("fast-forward ticks", (f64) ticks, "");
+    Bench_Report("fast-forward", ticksPerSecond / 1e6, "Mticks/s");
+    Bench_Report("faster than real time", ticksPerSecond / SIM_TICK_RATE, "x");
+    Bench_Report("variable rate frames", (f64) frames, "");
+    printf("  final state hash: %016llx\n", (unsigned long long) Sim_Hash(&first));
+
+    b8 deterministic = Sim_Hash(&first) == Sim_Hash(&second) && Sim_Hash(&first) == Sim_Hash(&framed);
+    Sim_RecordingFree(&recording);
+
+    if (!deterministic) {
+        printf("  ERROR: final states differ (%016llx, %016llx, %016llx)\n", (unsigned long long) Sim_Hash(&first),
+               (unsigned long long) Sim_Hash(&second), (unsigned long long) Sim_Hash(&framed));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "str8.h"
+
+// ----------------------------------------------------------------------------
+// String hashing and formatting benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - keys look like ui builder strings ("cell 42", "batching: on###batching", ...) at a few lengths,
+//   hashed with the byte at a time FNV-1a that ui keys used before and with Str8_Hash()
+// - hashes are accumulated into a checksum so the compiler can't drop the loops
+// - formatting pushes shader uniform names onto the scratch arena the way CreateLight() does,
+//   the arena must not grow after the first round
+
+enum BenchStr8ConstExpr {
+    BENCH_STR8_KEY_COUNT = 4096,
+};
+
+static u64 HashFNV1a(String8 string, u64 seed) {
+    u64 hash = 0xcbf29ce484222325ull ^ seed;
+    for (u64 i = 0; i < string.size; i++) {
+        hash ^= string.str[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static void BenchKeys(u32 length, int rounds) {
+    String8 *keys = malloc(BENCH_STR8_KEY_COUNT * sizeof(String8));
+    u8 *bytes = malloc((u64) BENCH_STR8_KEY_COUNT * length);
+    for (u32 i = 0; i < BENCH_STR8_KEY_COUNT; i++) {
+        u8 *key = bytes + (u64) i * length;
+        for (u32 j = 0; j < length; j++) {
+            key[j] = (u8) ('a' + Bench_RandomU32() % 26);
+        }
+        keys[i] = Str8_Make(key, length);
+    }
+
+    u64 checksum = 0;
+    f64 start = Bench_Seconds();
+    for (int round = 0; round < rounds; round++) {
+        for (u32 i = 0; i < BENCH_STR8_KEY_COUNT; i++) {
+            checksum += HashFNV1a(keys[i], (u64) round);
+        }
+    }
+    f64 fnvTime = Bench_Seconds() - start;
+
+    start = Bench_Seconds();
+    for (int round = 0; round < rounds; round++) {
+        for (u32 i = 0; i < BENCH_STR8_KEY_COUNT; i++) {
+            checksum += Str8_Hash(keys[i], (u64) round);
+        }
+    }
+    f64 str8Time = Bench_Seconds() - start;
+
+    f64 hashes = (f64) BENCH_STR8_KEY_COUNT * rounds;
+    char name[64];
+    snprintf(name, sizeof(name), "fnv-1a %u byte keys", length);
+    Bench_Report(name, hashes / fnvTime / 1e6, "Mkeys/s");
+    snprintf(name, sizeof(name), "str8 hash %u byte keys", length);
+    Bench_Report(name, hashes / str8Time / 1e6, "Mkeys/s");
+    snprintf(name, sizeof(name), "str8 hash %u byte keys throughput", length);
+    Bench_Report(name, hashes * length / str8Time / (1024.0 * 1024.0 * 1024.0), "GB/s");
+    snprintf(name, sizeof(name), "speedup %u byte keys", length);
+    Bench_Report(name, fnvTime / str8Time, "x");
+
+    // keeps the checksum alive
+    if (checksum == 0) printf("  (checksum 0)\n");
+
+    free(bytes);
+    free(keys);
+}
+
+int Bench_Str8(int argc, char **argv) {
+    const int rounds = (int) Bench_ArgInt(argc, argv, "rounds", 2000);
+    const int formats = (int) Bench_ArgInt(argc, argv, "formats", 200000);
+    const u32 lengths[] = { 6, 12, 24, 64 };
+
+    Bench_Seed(1);
+    for (u32 i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        BenchKeys(lengths[i], rounds);
+    }
+
+    // five uniform names per light, like CreateLight()
+    const char *fields[] = { "enabled", "type", "position", "target", "color" };
+    u64 capacity = 0;
+    u64 bytes = 0;
+    f64 start = Bench_Seconds();
+    for (int i = 0; i < formats; i++) {
+        Arena_Temp scratch = Arena_ScratchBegin();
+        for (int field = 0; field < 5; field++) {
+            bytes += Str8_PushF(scratch.arena, "lights[%i].%s", i & 3, fields[field]).size;
+        }
+        if (i == 0) capacity = Arena_Capacity(scratch.arena);
+        else if (Arena_Capacity(scratch.arena) != capacity) capacity = 0;
+        Arena_ScratchEnd(scratch);
+    }
+    f64 formatTime = Bench_Seconds() - start;
+
+    Bench_Report("scratch formats", (f64) formats * 5 / formatTime / 1e6, "M/s");
+    Bench_Report("scratch bytes formatted", (f64) bytes / (1024.0 * 1024.0), "MB");
+
+    if (capacity == 0) {
+        printf("  ERROR: scratch arena grew after the first round\n");
+        return 1;
+    }
+    return 0;
+}
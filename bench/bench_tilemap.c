@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+
+#include "bench.h"
+#include "tilemap.h"
+
+// ----------------------------------------------------------------------------
+// Chunked tile map benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - maps are a grid of 16x16 rooms with doorways, plus scattered colored blocks, using the overhead view's palette
+// - the camera pans diagonally across the map at 4 pixels per tile in a 640x720 view (one half of the split screen),
+//   and a few tiles in view are edited every frame, so every frame re-meshes a handful of chunks
+// - the same pan is run on a small and a large map, per frame cost should barely change between them
+// - every chunk's rectangles are checked against its tiles: each tile covered exactly once, in its own color
+
+enum BenchTileMapConstExpr {
+    BENCH_TILEMAP_ROOM_SIZE = 16,
+};
+
+static TileMap *CreateMap(u32 size) {
+    const Color palette[] = { DARKGRAY, BLUE, GREEN, YELLOW, RED };
+    TileMap *map = TileMap_Create(size, size, 4);
+    for (u8 i = 0; i < sizeof(palette) / sizeof(palette[0]); i++) {
+        TileMap_SetColor(map, i, palette[i]);
+    }
+
+    // room walls with a doorway in every wall segment
+    for (u32 i = 0; i < size; i += BENCH_TILEMAP_ROOM_SIZE) {
+        TileMap_Fill(map, (i32) i, 0, 1, (i32) size, 1);
+        TileMap_Fill(map, 0, (i32) i, (i32) size, 1, 1);
+    }
+    for (u32 y = 0; y < size; y += BENCH_TILEMAP_ROOM_SIZE) {
+        for (u32 x = 0; x < size; x += BENCH_TILEMAP_ROOM_SIZE) {
+            TileMap_Fill(map, (i32) (x + 6), (i32) y, 4, 1, 0);
+            TileMap_Fill(map, (i32) x, (i32) (y + 6), 1, 4, 0);
+        }
+    }
+
+    // props
+    u32 blocks = size * size / 256;
+    for (u32 i = 0; i < blocks; i++) {
+        i32 x = (i32) (Bench_RandomU32() % size);
+        i32 y = (i32) (Bench_RandomU32() % size);
+        TileMap_Fill(map, x, y, 2 + (i32) (Bench_RandomU32() % 3), 2 + (i32) (Bench_RandomU32() % 3), (u8) (2 + Bench_RandomU32() % 3));
+    }
+    return map;
+}
+
+// returns the number of chunks whose rectangles don't exactly cover their tiles
+static u32 Validate(TileMap *map) {
+    u32 chunksX, chunksY;
+    TileMap_ChunkCount(map, &chunksX, &chunksY);
+
+    u32 errors = 0;
+    u8 coverage[TILEMAP_CHUNK_SIZE * TILEMAP_CHUNK_SIZE];
+    for (u32 chunkY = 0; chunkY < chunksY; chunkY++) {
+        for (u32 chunkX = 0; chunkX < chunksX; chunkX++) {
+            u32 count;
+            const TileMap_Quad *quads = TileMap_GetChunkQuads(map, chunkX, chunkY, &count);
+            memset(coverage, 0, sizeof(coverage));
+
+            b8 error = false;
+            for (u32 q = 0; q < count; q++) {
+                for (u32 y = quads[q].y; y < (u32) quads[q].y + quads[q].height; y++) {
+                    for (u32 x = quads[q].x; x < (u32) quads[q].x + quads[q].width; x++) {
+                        coverage[y * TILEMAP_CHUNK_SIZE + x]++;
+                        Color color = TileMap_GetColor(map, TileMap_Get(map, (i32) (chunkX * TILEMAP_CHUNK_SIZE + x),
+                                                                             (i32) (chunkY * TILEMAP_CHUNK_SIZE + y)));
+                        if (memcmp(&color, &quads[q].color, sizeof(Color)) != 0) error = true;
+                    }
+                }
+            }
+
+            for (u32 y = 0; y < TILEMAP_CHUNK_SIZE; y++) {
+                for (u32 x = 0; x < TILEMAP_CHUNK_SIZE; x++) {
+                    b8 inside = chunkX * TILEMAP_CHUNK_SIZE + x < TileMap_Width(map)
+                             && chunkY * TILEMAP_CHUNK_SIZE + y < TileMap_Height(map);
+                    if (coverage[y * TILEMAP_CHUNK_SIZE + x] != (inside ? 1 : 0)) error = true;
+                }
+            }
+            errors += error;
+        }
+    }
+    return errors;
+}
+
+// per frame view preparation while panning, returns seconds per frame
+static f64 Pan(TileMap *map, int frames, const char *label) {
+    const Vector2 viewport = { 640, 720 };
+    f32 extent = (f32) TileMap_Width(map) * TileMap_TileSize(map);
+
+    f64 total = 0;
+    u64 visible = 0, rebuilt = 0, tiles = 0, quads = 0;
+    for (int i = 0; i < frames; i++) {
+        f32 t = (f32) i / (f32) frames;
+        Camera2D camera = {
+                .offset = { viewport.x / 2, viewport.y / 2 },
+                .target = { t * extent, t * extent },
+                .rotation = 0,
+                .zoom = 1
+        };
+
+        // a few edits in view, the chunks they land in are re-meshed below
+        i32 centerX = (i32) (camera.target.x / TileMap_TileSize(map));
+        i32 centerY = (i32) (camera.target.y / TileMap_TileSize(map));
+        for (int e = 0; e < 8; e++) {
+            TileMap_Set(map, centerX + (i32) (Bench_RandomU32() % 128) - 64, centerY + (i32) (Bench_RandomU32() % 128) - 64,
+                        (u8) (Bench_RandomU32() % 5));
+        }
+
+        f64 start = Bench_Seconds();
+        TileMap_PrepareView(map, camera, viewport);
+        total += Bench_Seconds() - start;
+
+        TileMap_Stats stats = TileMap_GetStats(map);
+        visible += stats.chunksVisible;
+        rebuilt += stats.chunksRebuilt;
+        tiles += stats.tilesVisible;
+        quads += stats.quadsVisible;
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s prepare view (per frame)", label);
+    Bench_Report(name, total * 1000.0 / frames, "ms");
+    snprintf(name, sizeof(name), "%s chunks visible (avg)", label);
+    Bench_Report(name, (f64) visible / frames, "");
+    snprintf(name, sizeof(name), "%s chunks rebuilt (avg)", label);
+    Bench_Report(name, (f64) rebuilt / frames, "");
+    snprintf(name, sizeof(name), "%s tiles visible (avg)", label);
+    Bench_Report(name, (f64) tiles / frames, "");
+    snprintf(name, sizeof(name), "%s rectangles drawn (avg)", label);
+    Bench_Report(name, (f64) quads / frames, "");
+    return total / frames;
+}
+
+int Bench_TileMap(int argc, char **argv) {
+    const u32 size = (u32) Bench_ArgInt(argc, argv, "size", 4096);
+    const u32 smallSize = (u32) Bench_ArgInt(argc, argv, "small", 512);
+    const int frames = (int) Bench_ArgInt(argc, argv, "frames", 500);
+
+    Bench_Seed(1);
+    f64 start = Bench_Seconds();
+    TileMap *map = CreateMap(size);
+    f64 createTime = Bench_Seconds() - start;
+
+    // mesh everything once, the worst case a freshly loaded map could ever cost
+    u32 chunksX, chunksY;
+    u32 chunkCount = TileMap_ChunkCount(map, &chunksX, &chunksY);
+    u64 quadCount = 0;
+    start = Bench_Seconds();
+    for (u32 chunkY = 0; chunkY < chunksY; chunkY++) {
+        for (u32 chunkX = 0; chunkX < chunksX; chunkX++) {
+            u32 count;
+            TileMap_GetChunkQuads(map, chunkX, chunkY, &count);
+            quadCount += count;
+        }
+    }
+    f64 meshTime = Bench_Seconds() - start;
+    u32 errors = Validate(map);
+
+    char name[64];
+    snprintf(name, sizeof(name), "%ux%u", size, size);
+    Bench_Report("map tiles", (f64) size * size, "");
+    Bench_Report("chunks", chunkCount, "");
+    Bench_Report("create + fill", createTime * 1000.0, "ms");
+    Bench_Report("greedy mesh all chunks", meshTime * 1000.0, "ms");
+    Bench_Report("greedy mesh per chunk", meshTime * 1e6 / chunkCount, "us");
+    Bench_Report("tiles per rectangle", (f64) size * size / (f64) quadCount, "");
+
+    TileMap *small = CreateMap(smallSize);
+    char smallName[64];
+    snprintf(smallName, sizeof(smallName), "%ux%u", smallSize, smallSize);
+    f64 smallFrame = Pan(small, frames, smallName);
+    f64 largeFrame = Pan(map, frames, name);
+    Bench_Report("large / small map frame cost", largeFrame / smallFrame, "x");
+
+    errors += Validate(map);
+    TileMap_Unload(small);
+    TileMap_Unload(map);
+
+    if (errors > 0) {
+        printf("  ERROR: %u chunks don't cover their tiles exactly\n", errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "ui.h"
+
+// ----------------------------------------------------------------------------
+// UI autolayout benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - a full tree is rebuilt and laid out every frame, as immediate mode builder code would:
+//   a scrollable panel of rows, each row a strip of buttons sized to their text
+// - the 'cells' are keyed buttons so every one goes through the widget cache and interaction,
+//   key strings are built once up front, same as string literals in real builder code
+// - the mouse sweeps across the panel so hot/active state and animations are exercised
+// - after warm up the frame must not allocate, neither new widgets nor frame arena blocks
+// - the second phase builds only half the rows, the other half must be evicted
+
+enum BenchUIConstExpr {
+    BENCH_UI_LABEL_SIZE = 16,
+};
+
+static void BuildFrame(u32 rows, u32 columns, char (*rowKeys)[BENCH_UI_LABEL_SIZE], char (*cellKeys)[BENCH_UI_LABEL_SIZE]) {
+    UI_PushPrefSize(Axis2_X, UI_SizePct(1, 0));
+    UI_PushPrefSize(Axis2_Y, UI_SizePct(1, 0));
+    UI_Widget *panel = UI_WidgetMake(UI_WidgetFlag_DrawBackground | UI_WidgetFlag_Clip | UI_WidgetFlag_OverflowY, Str8Lit("###panel"));
+    UI_WidgetEquipChildLayoutAxis(panel, Axis2_Y);
+    UI_PopPrefSize(Axis2_X);
+    UI_PopPrefSize(Axis2_Y);
+
+    UI_PushParent(panel);
+    for (u32 row = 0; row < rows; row++) {
+        UI_PushPrefSize(Axis2_X, UI_SizeChildrenSum(1));
+        UI_PushPrefSize(Axis2_Y, UI_SizeChildrenSum(1));
+        UI_Widget *rowWidget = UI_WidgetMake(UI_WidgetFlag_DrawBorder, (String8) { (u8 *) rowKeys[row], strlen(rowKeys[row]) });
+        UI_PopPrefSize(Axis2_X);
+        UI_PopPrefSize(Axis2_Y);
+
+        // shrinkable cells, the row is wider than the panel
+        UI_PushParent(rowWidget);
+        UI_PushPrefSize(Axis2_X, UI_SizeText(4, 0.5f));
+        UI_PushPrefSize(Axis2_Y, UI_SizePx(20, 1));
+        for (u32 column = 0; column < columns; column++) {
+            UI_Button((String8) { (u8 *) cellKeys[column], strlen(cellKeys[column]) });
+        }
+        UI_PopPrefSize(Axis2_X);
+        UI_PopPrefSize(Axis2_Y);
+        UI_PopParent();
+    }
+    UI_PopParent();
+}
+
+int Bench_UI(int argc, char **argv) {
+    const u32 rows = (u32) Bench_ArgInt(argc, argv, "rows", 100);
+    const u32 columns = (u32) Bench_ArgInt(argc, argv, "columns", 99);
+    const int frames = (int) Bench_ArgInt(argc, argv, "frames", 500);
+    const int warmup = 10;
+    const Vector2 screen = { 1280, 720 };
+
+    char (*rowKeys)[BENCH_UI_LABEL_SIZE] = malloc(rows * sizeof(*rowKeys));
+    char (*cellKeys)[BENCH_UI_LABEL_SIZE] = malloc(columns * sizeof(*cellKeys));
+    for (u32 row = 0; row < rows; row++) snprintf(rowKeys[row], BENCH_UI_LABEL_SIZE, "##row%u", row);
+    for (u32 column = 0; column < columns; column++) snprintf(cellKeys[column], BENCH_UI_LABEL_SIZE, "cell %u", column);
+
+    UI_Init(NULL, 10);
+
+    f64 buildTime = 0;
+    f64 layoutTime = 0;
+    f64 worstFrame = 0;
+    u32 createdAfterWarmup = 0;
+    u64 arenaCapacity = 0;
+    u64 arenaGrowth = 0;
+    u32 widgets = 0;
+
+    for (int i = 0; i < warmup + frames; i++) {
+        f32 t = (f32) i / (f32) (warmup + frames);
+        UI_Input input = {
+                .mouse = { screen.x * t, screen.y * (1 - t) },
+                .mouseDown = (i % 20) < 5,
+                .mousePressed = (i % 20) == 0,
+                .mouseReleased = (i % 20) == 5
+        };
+
+        f64 start = Bench_Seconds();
+        UI_BeginFrame(screen, input, 1.0f / 60.0f);
+        BuildFrame(rows, columns, rowKeys, cellKeys);
+        f64 built = Bench_Seconds();
+        UI_EndFrame();
+        f64 end = Bench_Seconds();
+
+        if (i == warmup - 1) arenaCapacity = Arena_Capacity(UI_FrameArena());
+        if (i < warmup) continue;
+
+        buildTime += built - start;
+        layoutTime += end - built;
+        if (end - start > worstFrame) worstFrame = end - start;
+        createdAfterWarmup += UI_GetStats().created;
+        widgets = UI_GetStats().widgets;
+    }
+    arenaGrowth = Arena_Capacity(UI_FrameArena()) - arenaCapacity;
+    UI_Stats steady = UI_GetStats();
+
+    // stop building half the rows, their widgets go stale and are evicted on the following frame
+    UI_Input idle = {0};
+    UI_BeginFrame(screen, idle, 1.0f / 60.0f);
+    BuildFrame(rows / 2, columns, rowKeys, cellKeys);
+    UI_EndFrame();
+    UI_BeginFrame(screen, idle, 1.0f / 60.0f);
+    BuildFrame(rows / 2, columns, rowKeys, cellKeys);
+    UI_EndFrame();
+    UI_Stats evicted = UI_GetStats();
+
+    f64 frameTime = (buildTime + layoutTime) / frames;
+    Bench_Report("widgets (per frame)", widgets, "");
+    Bench_Report("build (per frame)", buildTime * 1000.0 / frames, "ms");
+    Bench_Report("layout (per frame)", layoutTime * 1000.0 / frames, "ms");
+    Bench_Report("total (per frame)", frameTime * 1000.0, "ms");
+    Bench_Report("total (worst frame)", worstFrame * 1000.0, "ms");
+    Bench_Report("per widget", frameTime * 1e9 / widgets, "ns");
+    Bench_Report("cached widgets", steady.cached, "");
+    Bench_Report("frame arena high water", (f64) steady.frameArenaBytes / 1024.0, "KB");
+    Bench_Report("widgets created after warm up", createdAfterWarmup, "");
+    Bench_Report("frame arena growth after warm up", (f64) arenaGrowth, "bytes");
+    Bench_Report("evicted (half the rows dropped)", evicted.evicted, "");
+
+    UI_Shutdown();
+    free(cellKeys);
+    free(rowKeys);
+
+    int result = 0;
+    if (createdAfterWarmup > 0 || arenaGrowth > 0) {
+        printf("  ERROR: steady state frames allocated (%u widgets, %llu arena bytes)\n",
+               createdAfterWarmup, (unsigned long long) arenaGrowth);
+        result = 1;
+    }
+    if (evicted.evicted != (rows - rows / 2) * (columns + 1)) {
+        printf("  ERROR: expected %u widgets evicted, got %u\n", (rows - rows / 2) * (columns + 1), evicted.evicted);
+        result = 1;
+    }
+    if (frameTime * 1000.0 >= 1.0) {
+        printf("  WARNING: frame time is over the 1 ms budget\n");
+    }
+    return result;
+}
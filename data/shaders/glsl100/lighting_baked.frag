@@ -0,0 +1,37 @@
+#version 100
+
+precision mediump float;
+
+// Input vertex attributes (from vertex shader)
+varying vec3 fragPosition;
+varying vec2 fragTexCoord;
+varying vec2 fragTexCoord2;
+varying vec4 fragColor;
+varying vec3 fragNormal;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+
+// NOTE: Add here your custom variables
+
+// Light baked by fiddle-bake (see lightmap.h), RGBM: rgb*a*range
+// NOTE: rlights' four lights never move, static geometry takes all of its light from the lightmap
+uniform sampler2D lightmap;
+#define     LIGHTMAP_RGBM_RANGE     8.0
+
+uniform vec4 ambient;
+
+void main()
+{
+    // Texel color fetching from texture sampler
+    vec4 texelColor = texture2D(texture0, fragTexCoord);
+    vec4 baked = texture2D(lightmap, fragTexCoord2);
+    vec3 bakedLight = baked.rgb*baked.a*LIGHTMAP_RGBM_RANGE;
+
+    vec4 finalColor = texelColor*colDiffuse*vec4(bakedLight, 1.0);
+    finalColor += texelColor*(ambient/10.0);
+
+    // Gamma correction
+    gl_FragColor = pow(finalColor, vec4(1.0/2.2));
+}
@@ -15,29 +15,26 @@ out vec4 finalColor;
 
 // NOTE: Add here your custom variables
 
-#define     MAX_LIGHTS              4
-#define     LIGHT_DIRECTIONAL       0
-#define     LIGHT_POINT             1
-
-struct MaterialProperty {
-    vec3 color;
-    int useSampler;
-    sampler2D sampler;
-};
-
-struct Light {
-    int enabled;
-    int type;
-    vec3 position;
-    vec3 target;
-    vec4 color;
-};
-
-// Input lighting values
-uniform Light lights[MAX_LIGHTS];
+// Clustered point lights, binned on the CPU each frame by cluster.c
+// - clusterLights: 2 texels per light, world position + radius, color * intensity
+// - clusterOffsets: 1 texel per cluster, first index + light count
+// - clusterIndices: flat list of light indices, clusters are contiguous ranges in it
+uniform sampler2D clusterLights;
+uniform sampler2D clusterOffsets;
+uniform sampler2D clusterIndices;
+uniform vec4 clusterGrid;           // tiles x, tiles y, depth slices, texture width
+uniform vec2 clusterDepth;          // slice = log(view depth)*x - y
+uniform vec2 clusterViewport;       // render target size in pixels
+uniform vec3 clusterViewDir;
+
 uniform vec4 ambient;
 uniform vec3 viewPos;
 
+ivec2 ClusterTexel(int index, int width)
+{
+    return ivec2(index % width, index / width);
+}
+
 void main()
 {
     // Texel color fetching from texture sampler
@@ -47,31 +44,39 @@ void main()
     vec3 viewD = normalize(viewPos - fragPosition);
     vec3 specular = vec3(0.0);
 
-    // NOTE: Implement here your fragment shader code
+    // Find the cluster this fragment falls in, tiles count up from the bottom like gl_FragCoord
+    int width = int(clusterGrid.w);
+    ivec2 tiles = ivec2(clusterGrid.xy);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy/clusterViewport*clusterGrid.xy), ivec2(0), tiles - 1);
+    float depth = max(dot(fragPosition - viewPos, clusterViewDir), 0.0001);
+    int slice = clamp(int(floor(log(depth)*clusterDepth.x - clusterDepth.y)), 0, int(clusterGrid.z) - 1);
+    int cluster = (slice*tiles.y + tile.y)*tiles.x + tile.x;
+
+    vec2 range = texelFetch(clusterOffsets, ClusterTexel(cluster, width), 0).xy;
+    int first = int(range.x);
+    int count = int(range.y);
 
-    for (int i = 0; i < MAX_LIGHTS; i++)
+    for (int i = 0; i < count; i++)
     {
-        if (lights[i].enabled == 1)
-        {
-            vec3 light = vec3(0.0);
-
-            if (lights[i].type == LIGHT_DIRECTIONAL)
-            {
-                light = -normalize(lights[i].target - lights[i].position);
-            }
-
-            if (lights[i].type == LIGHT_POINT)
-            {
-                light = normalize(lights[i].position - fragPosition);
-            }
-
-            float NdotL = max(dot(normal, light), 0.0);
-            lightDot += lights[i].color.rgb*NdotL;
-
-            float specCo = 0.0;
-            if (NdotL > 0.0) specCo = pow(max(0.0, dot(viewD, reflect(-(light), normal))), 16.0); // 16 refers to shine
-            specular += specCo;
-        }
+        int index = int(texelFetch(clusterIndices, ClusterTexel(first + i, width), 0).r);
+        vec4 positionRadius = texelFetch(clusterLights, ClusterTexel(index*2, width), 0);
+        vec3 color = texelFetch(clusterLights, ClusterTexel(index*2 + 1, width), 0).rgb;
+
+        // Smooth falloff to zero at the light's radius, binning relies on it
+        vec3 toLight = positionRadius.xyz - fragPosition;
+        float distanceSq = dot(toLight, toLight);
+        float falloff = clamp(1.0 - distanceSq/(positionRadius.w*positionRadius.w), 0.0, 1.0);
+        falloff *= falloff;
+        if (falloff <= 0.0) continue;
+
+        vec3 light = toLight*inversesqrt(distanceSq);
+
+        float NdotL = max(dot(normal, light), 0.0);
+        lightDot += color*NdotL*falloff;
+
+        float specCo = 0.0;
+        if (NdotL > 0.0) specCo = pow(max(0.0, dot(viewD, reflect(-(light), normal))), 16.0); // 16 refers to shine
+        specular += specCo*falloff;
     }
 
     finalColor = (texelColor*((colDiffuse + vec4(specular, 1.0))*vec4(lightDot, 1.0)));
@@ -3,7 +3,7 @@
 // Input vertex attributes
 in vec3 vertexPosition;
 in vec2 vertexTexCoord;
-in vec3 vertexNormal;
+in vec4 vertexNormal;
 in vec4 vertexColor;
 
 // Input uniform values
@@ -19,13 +19,25 @@ out vec3 fragNormal;
 
 // NOTE: Add here your custom variables
 
+// Normals of compact meshes (see quant.h) are octahedral encoded, flagged by w = -1, float normals read w = 1
+vec3 DecodeNormal(vec4 normal)
+{
+    if (normal.w >= 0.0) return normal.xyz;
+
+    vec3 n = vec3(normal.xy, 1.0 - abs(normal.x) - abs(normal.y));
+    float t = max(-n.z, 0.0);
+    n.x += (n.x >= 0.0) ? -t : t;
+    n.y += (n.y >= 0.0) ? -t : t;
+    return normalize(n);
+}
+
 void main()
 {
     // Send vertex attributes to fragment shader
     fragPosition = vec3(matModel * vec4(vertexPosition, 1.0));
     fragTexCoord = vertexTexCoord;
     fragColor = vertexColor;
-    fragNormal = normalize(vec3(matNormal * vec4(vertexNormal, 1.0)));
+    fragNormal = normalize(vec3(matNormal * vec4(DecodeNormal(vertexNormal), 1.0)));
 
     // Calculate final vertex position
     gl_Position = mvp * vec4(vertexPosition, 1.0);
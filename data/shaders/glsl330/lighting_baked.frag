@@ -0,0 +1,94 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec3 fragPosition;
+in vec2 fragTexCoord;
+in vec2 fragTexCoord2;
+//in vec4 fragColor;
+in vec3 fragNormal;
+
+// Input uniform values
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+
+// Output fragment color
+out vec4 finalColor;
+
+// NOTE: Add here your custom variables
+
+// Light baked by fiddle-bake (see lightmap.h), RGBM: rgb*a*range
+uniform sampler2D lightmap;
+#define     LIGHTMAP_RGBM_RANGE     8.0
+
+// Clustered point lights, the same as lighting.frag, each cluster lists its baked lights first
+// - clusterOffsets: 1 texel per cluster, first index + light count + baked light count
+uniform sampler2D clusterLights;
+uniform sampler2D clusterOffsets;
+uniform sampler2D clusterIndices;
+uniform vec4 clusterGrid;           // tiles x, tiles y, depth slices, texture width
+uniform vec2 clusterDepth;          // slice = log(view depth)*x - y
+uniform vec2 clusterViewport;       // render target size in pixels
+uniform vec3 clusterViewDir;
+
+uniform vec4 ambient;
+uniform vec3 viewPos;
+
+ivec2 ClusterTexel(int index, int width)
+{
+    return ivec2(index % width, index / width);
+}
+
+void main()
+{
+    // Texel color fetching from texture sampler
+    vec4 texelColor = texture(texture0, fragTexCoord);
+    vec4 baked = texture(lightmap, fragTexCoord2);
+    vec3 bakedLight = baked.rgb*baked.a*LIGHTMAP_RGBM_RANGE;
+    vec3 lightDot = vec3(0.0);
+    vec3 normal = normalize(fragNormal);
+    vec3 viewD = normalize(viewPos - fragPosition);
+    vec3 specular = vec3(0.0);
+
+    // Find the cluster this fragment falls in, tiles count up from the bottom like gl_FragCoord
+    int width = int(clusterGrid.w);
+    ivec2 tiles = ivec2(clusterGrid.xy);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy/clusterViewport*clusterGrid.xy), ivec2(0), tiles - 1);
+    float depth = max(dot(fragPosition - viewPos, clusterViewDir), 0.0001);
+    int slice = clamp(int(floor(log(depth)*clusterDepth.x - clusterDepth.y)), 0, int(clusterGrid.z) - 1);
+    int cluster = (slice*tiles.y + tile.y)*tiles.x + tile.x;
+
+    // Only the lights that aren't in the lightmap
+    vec3 range = texelFetch(clusterOffsets, ClusterTexel(cluster, width), 0).xyz;
+    int first = int(range.x);
+    int count = int(range.y);
+
+    for (int i = int(range.z); i < count; i++)
+    {
+        int index = int(texelFetch(clusterIndices, ClusterTexel(first + i, width), 0).r);
+        vec4 positionRadius = texelFetch(clusterLights, ClusterTexel(index*2, width), 0);
+        vec3 color = texelFetch(clusterLights, ClusterTexel(index*2 + 1, width), 0).rgb;
+
+        // Smooth falloff to zero at the light's radius, binning relies on it
+        vec3 toLight = positionRadius.xyz - fragPosition;
+        float distanceSq = dot(toLight, toLight);
+        float falloff = clamp(1.0 - distanceSq/(positionRadius.w*positionRadius.w), 0.0, 1.0);
+        falloff *= falloff;
+        if (falloff <= 0.0) continue;
+
+        vec3 light = toLight*inversesqrt(distanceSq);
+
+        float NdotL = max(dot(normal, light), 0.0);
+        lightDot += color*NdotL*falloff;
+
+        float specCo = 0.0;
+        if (NdotL > 0.0) specCo = pow(max(0.0, dot(viewD, reflect(-(light), normal))), 16.0); // 16 refers to shine
+        specular += specCo*falloff;
+    }
+
+    finalColor = (texelColor*((colDiffuse + vec4(specular, 1.0))*vec4(lightDot, 1.0)));
+    finalColor += texelColor*colDiffuse*vec4(bakedLight, 0.0);
+    finalColor += texelColor*(ambient/10.0)*colDiffuse;
+
+    // Gamma correction
+    finalColor = pow(finalColor, vec4(1.0/2.2));
+}
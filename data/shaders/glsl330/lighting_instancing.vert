@@ -0,0 +1,51 @@
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec4 vertexNormal;
+in vec4 vertexColor;
+
+// Input per-instance attributes
+in mat4 instanceTransform;
+
+// Input uniform values
+uniform mat4 mvp;
+
+// Output vertex attributes (to fragment shader)
+out vec3 fragPosition;
+out vec2 fragTexCoord;
+out vec4 fragColor;
+out vec3 fragNormal;
+
+// NOTE: Add here your custom variables
+
+// Normals of compact meshes (see quant.h) are octahedral encoded, flagged by w = -1, float normals read w = 1
+vec3 DecodeNormal(vec4 normal)
+{
+    if (normal.w >= 0.0) return normal.xyz;
+
+    vec3 n = vec3(normal.xy, 1.0 - abs(normal.x) - abs(normal.y));
+    float t = max(-n.z, 0.0);
+    n.x += (n.x >= 0.0) ? -t : t;
+    n.y += (n.y >= 0.0) ? -t : t;
+    return normalize(n);
+}
+
+void main()
+{
+    // Compute world space position from the per-instance model transform
+    vec4 worldPosition = instanceTransform * vec4(vertexPosition, 1.0);
+
+    // Send vertex attributes to fragment shader
+    fragPosition = vec3(worldPosition);
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor;
+
+    // Derive the normal matrix from the instance transform
+    mat3 normalMatrix = transpose(inverse(mat3(instanceTransform)));
+    fragNormal = normalize(normalMatrix * DecodeNormal(vertexNormal));
+
+    // Calculate final vertex position, mvp only holds view-projection for instanced draws
+    gl_Position = mvp * worldPosition;
+}
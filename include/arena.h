@@ -0,0 +1,58 @@
+#ifndef FIDDLE_ARENA_H
+#define FIDDLE_ARENA_H
+
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Arena allocator
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - linear allocator over a chain of blocks, individual allocations are never freed,
+//   the whole arena is reset (or rolled back to a temp marker) at once
+// - blocks are kept on reset, so an arena that's reset every frame stops allocating
+//   once it has grown to its high water mark
+// - pushes are zeroed unless the NoZero variant is used, default alignment is 16 bytes
+// - every thread gets a scratch arena for short lived allocations, scratch temps must end in the reverse
+//   order they began, and nothing allocated from scratch should outlive the function that began it
+
+typedef struct Arena_Block Arena_Block;
+
+typedef struct Arena Arena;
+struct Arena {
+    Arena_Block *first;
+    Arena_Block *current;
+    u64 blockSize;          // minimum size of newly allocated blocks
+};
+
+// marker for rolling an arena back, e.g. for scratch allocations inside a function
+typedef struct Arena_Temp Arena_Temp;
+struct Arena_Temp {
+    Arena *arena;
+    Arena_Block *block;
+    u64 used;
+};
+
+void Arena_Init(Arena *arena, u64 blockSize);
+void Arena_Release(Arena *arena);
+void Arena_Reset(Arena *arena);
+
+void *Arena_Push(Arena *arena, u64 size);
+void *Arena_PushNoZero(Arena *arena, u64 size);
+void *Arena_PushAligned(Arena *arena, u64 size, u64 alignment);
+
+#define Arena_PushStruct(arena, type)           ((type *) Arena_Push((arena), sizeof(type)))
+#define Arena_PushArray(arena, type, count)     ((type *) Arena_Push((arena), sizeof(type) * (u64) (count)))
+
+Arena_Temp Arena_TempBegin(Arena *arena);
+void Arena_TempEnd(Arena_Temp temp);
+
+// the calling thread's scratch arena, created on first use
+Arena_Temp Arena_ScratchBegin(void);
+void Arena_ScratchEnd(Arena_Temp temp);
+
+// total bytes handed out / reserved across all blocks
+u64 Arena_Used(const Arena *arena);
+u64 Arena_Capacity(const Arena *arena);
+
+#endif //FIDDLE_ARENA_H
@@ -0,0 +1,53 @@
+#ifndef FIDDLE_BATCH_H
+#define FIDDLE_BATCH_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Instance batching
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - draws submitted between Batch_Begin() and Batch_End() are gathered by (mesh, texture, tint)
+//   into per-frame instance buffers, then each group is drawn with a single DrawMeshInstanced() call
+// - batch storage persists between frames and only grows, so steady state submission doesn't allocate
+// - the batch shader must expose an 'instanceTransform' mat4 attribute (see lighting_instancing.vert),
+//   it replaces the material's own shader for batched draws
+// - when batching is disabled submissions are drawn immediately via DrawMesh(),
+//   with the same counters, so both paths can be compared directly
+// - groups are drawn in the order of their first submission, submitting through renderqueue.h sorts them by state,
+//   texture binds count texture switches between consecutive draws, raylib binds on every draw but redundant binds
+//   are next to free, the streamed models all share one texture through the resource cache (see resource.h)
+// - meshes uploaded in the compact vertex layout (see quant.h) get their decode folded into the transform
+// - materials with a lightmap (see lightmap.h) are drawn immediately with their own shader, their meshes are unique
+
+typedef struct Batch_Stats Batch_Stats;
+struct Batch_Stats {
+    int drawCalls;      // number of draw calls issued for the last completed frame
+    int instances;      // number of mesh instances drawn for the last completed frame
+    int batches;        // number of distinct (mesh, texture, tint) groups in the last completed frame
+    int triangles;      // number of triangles drawn for the last completed frame
+    int textureBinds;   // number of times the diffuse texture changed between draws in the last completed frame
+};
+
+void Batch_Init(Shader instancingShader);
+void Batch_Unload(void);
+
+// a reloaded instancing shader, same requirements as the one passed to Batch_Init()
+void Batch_SetShader(Shader instancingShader);
+
+void Batch_SetEnabled(b8 enabled);
+b8 Batch_IsEnabled(void);
+
+// frame bracketing, Batch_End() flushes all pending instances
+void Batch_Begin(void);
+void Batch_End(void);
+
+// submission, mirrors DrawMesh() / DrawModel()
+void Batch_AddMesh(Mesh mesh, Material material, Matrix transform, Color tint);
+void Batch_AddModel(Model model, Vector3 position, f32 scale, Color tint);
+
+Batch_Stats Batch_GetStats(void);
+
+#endif //FIDDLE_BATCH_H
@@ -0,0 +1,80 @@
+#ifndef FIDDLE_CLUSTER_H
+#define FIDDLE_CLUSTER_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Clustered forward lighting
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - the view frustum is split into a grid of 'froxels', 16x9 screen tiles by 24 depth slices,
+//   slices are exponential in view depth so near clusters stay small
+// - each frame the CPU bins every point light into the clusters its sphere touches (4 clusters per SIMD test),
+//   the fragment shader then only loops over the lights of the one cluster it falls in
+// - results go to the GPU as three float textures read with texelFetch(), see lighting.frag:
+//   lights (2 texels per light), grid (offset + count per cluster) and the flat light index list
+// - slicing covers view depths up to CLUSTER_Z_FAR, fragments further away use the last slice
+//   and lights beyond it are dropped, perspective cameras only
+// - each cluster lists its baked lights first and the grid texel's third channel counts them, lighting_baked.frag
+//   starts its loop past them, so lightmapped geometry (see lightmap.h) only evaluates the lights still live
+// - binning is plain CPU work and runs headless, textures are created on the first Cluster_BeginDraw()
+
+#define CLUSTER_NO_LIGHT ((u32) -1)
+
+typedef struct Cluster_Light Cluster_Light;
+struct Cluster_Light {
+    Vector3 position;       // world space
+    f32 radius;             // light has no effect past this distance
+    Color color;
+    f32 intensity;
+    b8 baked;               // static geometry has this light in its lightmap
+};
+
+typedef struct Cluster_Stats Cluster_Stats;
+struct Cluster_Stats {
+    u32 lights;
+    u32 lightsBinned;       // lights that touched at least one cluster
+    u32 clusters;
+    u32 clustersLit;        // clusters with at least one light
+    u32 clustersTested;     // sphere vs cluster tests, summed over SIMD lanes
+    u32 indices;            // entries in the light index list
+    u32 indicesBaked;       // of those, baked lights that lightmapped geometry skips
+    u32 indicesDropped;     // (cluster, light) pairs that didn't fit in the index list
+    u32 maxClusterLights;
+};
+
+void Cluster_Init(u32 maxLights);
+void Cluster_Unload(void);
+
+// lights keep their index until Cluster_ClearLights(), CLUSTER_NO_LIGHT once maxLights are added
+u32 Cluster_AddLight(Cluster_Light light);
+void Cluster_SetLight(u32 index, Cluster_Light light);
+Cluster_Light Cluster_GetLight(u32 index);
+u32 Cluster_LightCount(void);
+void Cluster_ClearLights(void);
+
+// assign lights to clusters for a camera, aspect ratio of the render target like Cull_FrustumFromCamera()
+void Cluster_BinLights(Camera3D camera, f32 aspect);
+
+// grid inspection, mostly for validating the binning
+u32 Cluster_ClusterCount(void);
+BoundingBox Cluster_GetClusterBounds(u32 cluster);     // view space, camera looks down -z
+u32 Cluster_GetClusterLights(u32 cluster, u32 *lights, u32 maxLights);
+
+// cluster a fragment falls in, the same lookup lighting.frag does, ndc in [-1, 1] with +y up
+u32 Cluster_ClusterAt(Vector2 ndc, f32 viewDepth);
+
+// shaders using the clustered lighting uniforms, samplers are bound to fixed texture units
+void Cluster_BindShader(Shader shader);
+void Cluster_UnbindShader(Shader shader);
+
+// uploads the last binning, sets per-frame uniforms on bound shaders and binds the cluster textures,
+// viewport is the size in pixels of the render target being drawn to
+void Cluster_BeginDraw(Camera3D camera, Vector2 viewport);
+void Cluster_EndDraw(void);
+
+Cluster_Stats Cluster_GetStats(void);
+
+#endif //FIDDLE_CLUSTER_H
@@ -4,6 +4,14 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "raylib.h"
+
+// NOTE - rlights.h only guards its declarations, not its implementation,
+//  so skip it if the including file already pulled it in with RLIGHTS_IMPLEMENTATION
+#ifndef RLIGHTS_H
+#include "rlights.h"
+#endif
+
 typedef float f32;
 typedef double f64;
 typedef uint8_t b8;
@@ -21,9 +29,29 @@ typedef int64_t i64;
 // ----------------------------------------------------------------------------
 
 enum ConstExpr {
-    MAP_SIZE = 9
+    MAP_SIZE = 9,                   // hand made starting room, stamped into the world map's corner
+    WORLD_MAP_SIZE = 4096,
+    VIEW_RAY_COLUMNS = 160,         // overhead visibility fan, one ray per 4 pixels of the first person view
+    MAX_SCENE_OBJECTS = 512,
+    MAX_SCENE_WALLS = 32,           // wall runs of the starting room, see level.h
+    MAX_SCENE_LIGHTS = 4096         // clustered lights, see cluster.h
 };
 
+// defined in cull.h
+struct Cull_BVH;
+
+// defined in tilemap.h
+struct TileMap;
+
+// defined in entity.h
+struct Entity_Store;
+
+// defined in occlusion.h
+struct Occlusion_Buffer;
+
+// defined in lightmap.h
+struct Lightmap;
+
 typedef struct State {
     struct Window {
         int width;
@@ -41,28 +69,127 @@ typedef struct State {
         Vector2 speed;
     } player;
 
+    // allocated at full size, dynres.h draws them at a lower resolution when the frame runs over budget,
+    // rendergraph.h only redraws them when what they show changed
     struct RenderTextures {
         RenderTexture overhead;
         RenderTexture firstPerson;
+        u32 overheadView;
+        u32 firstPersonView;
+        u32 overheadTarget;
+        u32 firstPersonTarget;
     } renderTextures;
 
-    Rectangle splitScreenRect;
-
     u8 map[MAP_SIZE * MAP_SIZE];
-    Rectangle tiles[MAP_SIZE * MAP_SIZE];
+    struct TileMap *tileMap;
 
     struct Scene {
         Light lights[MAX_LIGHTS];
         Shader shader;
+        u32 shaderHandle;               // ShaderCache_Handle, the shader is swapped out when its sources change
+
+        Light instancingLights[MAX_LIGHTS];
+        Shader instancingShader;
+        u32 instancingShaderHandle;
+
+        // per-frame constants shared by both lighting shaders, uniform.h frame block fields
+        struct SceneUniforms {
+            u32 viewPos;
+            u32 ambient;
+        } uniforms;
 
-        Model coin;
+        Model *coin;                    // streamed in, owned by the loader
+        Model placeholder;              // drawn in place of streamed models that aren't ready yet
         Model ground;
         Model treeTrunk;
         Model treeCanopy;
+        Model walls[MAX_SCENE_WALLS];   // the starting room's walls, each run of wall tiles is one box
+        u32 wallCount;
+        u32 firstWallObject;            // the walls' scene objects follow one another from here
+        u32 coinLight;                  // clustered light circling the coin, CLUSTER_NO_LIGHT if it didn't fit
 
         float coinRotY;
         float coinRotZ;
+
+        // everything drawn in the first person view, culled against the camera frustum each frame
+        struct SceneObject {
+            Model *model;
+            Vector3 position;
+            f32 scale;
+            Color tint;
+            BoundingBox localBounds;    // model space, computed once
+            BoundingBox bounds;         // world space, refreshed for moving objects
+            u32 asset;                  // Loader_Handle for streamed models, 0 otherwise
+            b8 pending;                 // streamed model isn't ready, draw the placeholder instead
+            u32 lod;                    // level drawn last frame, streamed models only, see lod.h
+            Model *baked;               // the same box with its light baked in, static level boxes only
+        } objects[MAX_SCENE_OBJECTS];
+        u32 objectCount;
+        u32 coinObject;
+        u32 version;                    // bumped whenever an object is added or swaps in its streamed model
+
+        struct Cull_BVH *bvh;
+        u32 visibleObjects[MAX_SCENE_OBJECTS];
+        u32 visibleCount;
     } scene;
+
+    struct Loading {
+        f64 startTime;                  // Timer_Seconds() at the top of main()
+        f64 firstFrameTime;             // seconds from startTime until the first frame
+        f32 worstFrameTime;             // longest frame while models were streaming in
+        b8 complete;
+        b8 quantize;                    // 'fiddle --quantize', compact vertex layout for loaded meshes, see quant.h
+    } loading;
+
+    // 'fiddle --benchmark', see framebench.h
+    struct Benchmark {
+        b8 enabled;
+        u32 frames;                     // frames to record
+        u32 warmup;                     // frames drawn after loading finished, before recording
+        u32 frame;                      // frames since recording started, drives the script
+        const char *output;             // report file name, without the .json / .csv
+    } benchmark;
+
+    // F3 overlay and F4 trace captures, see profiler.h
+    struct Profiling {
+        b8 overlay;
+    } profiling;
+
+    // simplified levels for distant streamed models, [L] toggles, 'fiddle --lod=off' starts without
+    struct LevelOfDetail {
+        b8 enabled;
+    } lod;
+
+    // scene objects and pickups hidden behind the walls aren't drawn, [O] toggles, 'fiddle --occlusion=off'
+    // starts without, see occlusion.h
+    struct OcclusionCulling {
+        b8 enabled;
+        struct Occlusion_Buffer *buffer;
+        u32 tested;                     // last frame, objects and pickups inside the frustum
+        u32 rejected;                   // of those, hidden
+        f64 seconds;                    // last frame, adding the walls, waiting on their raster, testing objects
+    } occlusion;
+
+    // the static level drawn with light baked by fiddle-bake when data/level.lightmap is there, only the lights that
+    // move are evaluated on it, [B] toggles, 'fiddle --lightmap=off' starts without, see lightmap.h
+    struct BakedLighting {
+        b8 enabled;
+        struct Lightmap *lightmap;      // NULL without a lightmap for this level
+        Texture2D texture;
+        Shader shader;
+        u32 shaderHandle;
+        Model *models;                  // one per level box, in level order
+        u32 modelCount;
+    } lightmap;
+
+    // 'fiddle --pickups=N', coins spinning around the tree grid, kept in an entity store, see entity.h
+    struct Pickups {
+        u32 count;
+        struct Entity_Store *entities;
+        u32 *visible;                   // entity indices, culled every frame
+        u32 visibleCount;
+        f64 updateSeconds;              // last Entity_Update()
+    } pickups;
 } State;
 
 #endif //FIDDLE_COMMON_H
@@ -0,0 +1,78 @@
+#ifndef FIDDLE_CULL_H
+#define FIDDLE_CULL_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Frustum culling
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - planes are stored as (a, b, c, d) with normals pointing inwards, a point p is inside when dot(n, p) + d >= 0
+// - boxes are tested against the 'positive vertex' of each plane, so the test is conservative:
+//   a box may be kept when it is actually outside near a frustum corner, but never culled when visible
+
+enum Cull_FrustumPlane {
+    Cull_FrustumPlane_Left,
+    Cull_FrustumPlane_Right,
+    Cull_FrustumPlane_Bottom,
+    Cull_FrustumPlane_Top,
+    Cull_FrustumPlane_Near,
+    Cull_FrustumPlane_Far,
+    Cull_FrustumPlane_COUNT,
+};
+
+typedef struct Cull_Frustum Cull_Frustum;
+struct Cull_Frustum {
+    Vector4 planes[Cull_FrustumPlane_COUNT];
+};
+
+// build a frustum matching what BeginMode3D() sets up for a render target with the given aspect ratio
+Cull_Frustum Cull_FrustumFromCamera(Camera3D camera, f32 aspect);
+Cull_Frustum Cull_FrustumFromMatrix(Matrix viewProjection);
+
+// the view projection matrix Cull_FrustumFromCamera() extracts its planes from
+Matrix Cull_ViewProjection(Camera3D camera, f32 aspect);
+
+// scalar reference test, used as a baseline and for one-off checks
+b8 Cull_FrustumTestBox(const Cull_Frustum *frustum, BoundingBox box);
+
+// world space bounds of a transformed box (Arvo's method)
+BoundingBox Cull_TransformBox(BoundingBox box, Matrix transform);
+
+// ----------------------------------------------------------------------------
+// Bounding volume hierarchy
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - 4-wide BVH, each node stores its children's bounds as SoA so one node is tested
+//   against a plane with a single 4-lane SIMD operation (scalar fallback where SSE isn't available)
+// - leaves are single objects, so object bounds get the same SIMD treatment as interior nodes
+// - built once from the initial object bounds (top-down median splits on the widest centroid axis)
+// - moving objects update their bounds in place with Cull_BVHUpdateObject(),
+//   Cull_BVHRefit() then recomputes only the dirty paths up to the root (topology is not rebuilt)
+// - subtrees fully inside a plane stop testing against it, fully inside subtrees are emitted without tests
+
+typedef struct Cull_BVH Cull_BVH;
+
+typedef struct Cull_Stats Cull_Stats;
+struct Cull_Stats {
+    u32 nodesVisited;
+    u32 objectsTested;      // objects whose bounds were tested against at least one plane
+    u32 objectsVisible;
+};
+
+Cull_BVH *Cull_BVHBuild(const BoundingBox *boxes, u32 count);
+void Cull_BVHUnload(Cull_BVH *bvh);
+
+u32 Cull_BVHObjectCount(const Cull_BVH *bvh);
+
+void Cull_BVHUpdateObject(Cull_BVH *bvh, u32 objectIndex, BoundingBox box);
+void Cull_BVHRefit(Cull_BVH *bvh);
+
+// writes indices of objects that intersect the frustum into 'visible', returns the number of visible objects,
+// which may be larger than maxVisible in which case the output is truncated
+u32 Cull_BVHQuery(const Cull_BVH *bvh, const Cull_Frustum *frustum, u32 *visible, u32 maxVisible, Cull_Stats *stats);
+
+#endif //FIDDLE_CULL_H
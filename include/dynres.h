@@ -0,0 +1,64 @@
+#ifndef FIDDLE_DYNRES_H
+#define FIDDLE_DYNRES_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Dynamic resolution
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - render textures are allocated once at full size, a view draws into a sub-rect of its texture by shrinking the
+//   viewport and keeping the full size projection, so nothing is ever reallocated and draw code doesn't change
+// - the composite samples just that sub-rect (DynRes_GetSource()) and stretches it over the view, bilinear filtered
+// - the frame's cost is the larger of the CPU time passed to DynRes_Update() and the GPU time of the frame's passes
+//   (gputimer.h, a few frames old), over budget the views shrink, well under it they grow back, slowly
+// - each view's share of a change follows its share of the cost, its own pass time matched up by pass name
+// - scales move in steps of 1/DYNRES_SCALE_STEPS and wait for the GPU times of a new size before moving again,
+//   new scales only apply from the next DynRes_BeginView(), never halfway through a frame
+
+enum DynRes_ConstExpr {
+    DYNRES_MAX_VIEWS = 4,
+    DYNRES_SCALE_STEPS = 32,
+};
+
+typedef u32 DynRes_View;
+
+typedef struct DynRes_Stats DynRes_Stats;
+struct DynRes_Stats {
+    f64 budget;                         // seconds per frame
+    f64 cost;                           // smoothed seconds per frame the controller is looking at
+    f64 cpu;                            // latest frame
+    f64 gpu;                            // latest frame with results, 0 without timer queries
+};
+
+void DynRes_Init(f64 budgetSeconds);
+
+void DynRes_SetEnabled(b8 enabled);
+b8 DynRes_IsEnabled(void);
+
+void DynRes_SetBudget(f64 seconds);
+f64 DynRes_GetBudget(void);
+
+// linear scale limits, per axis, 0.5 renders a quarter of the pixels
+void DynRes_SetScaleRange(f32 min, f32 max);
+
+// pass is the name the view's pass is timed under (Profiler_BeginPass()), the target is never resized
+DynRes_View DynRes_AddView(const char *pass, RenderTexture2D target);
+
+f32 DynRes_GetScale(DynRes_View view);
+// pixels drawn this frame
+Vector2 DynRes_GetSize(DynRes_View view);
+// the drawn part of the texture, flipped for DrawTexturePro()
+Rectangle DynRes_GetSource(DynRes_View view);
+
+// right after BeginTextureMode() / right after EndTextureMode()
+void DynRes_BeginView(DynRes_View view);
+void DynRes_EndView(DynRes_View view);
+
+// once a frame, with the CPU time of everything but the buffer swap
+void DynRes_Update(f64 cpuSeconds);
+DynRes_Stats DynRes_GetStats(void);
+
+#endif //FIDDLE_DYNRES_H
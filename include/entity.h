@@ -0,0 +1,71 @@
+#ifndef FIDDLE_ENTITY_H
+#define FIDDLE_ENTITY_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Entity storage
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - components are kept as structure of arrays, one array per float, packed at the front by swapping the last
+//   entity into a destroyed one's place, so updates stream through contiguous memory with no holes
+// - handles stay valid while the dense index moves, they're a slot index plus a generation that's bumped when the
+//   slot is reused, so a handle to a destroyed entity is rejected instead of finding whatever lives there now
+// - Entity_Update() spins every rotation by its angular velocity and rebuilds the world matrices, 4 entities per
+//   SSE operation (scalar fallback where SSE isn't available), the matrices come out as raylib Matrix values
+//   ready for Batch_AddMesh()
+// - rotations integrate to first order and are renormalized every update, at a turn per second and 60 updates
+//   a second that spins about 0.1% slow, which nobody sees on a pickup
+// - the model component is opaque to the store, the game keeps a Loader_Handle in it
+
+typedef u32 Entity_Handle;              // 0 is never a valid handle
+
+enum Entity_ConstExpr {
+    ENTITY_INDEX_BITS = 22,
+    ENTITY_MAX_CAPACITY = (1 << ENTITY_INDEX_BITS) - 1,
+};
+
+typedef struct Entity_Store Entity_Store;
+
+typedef struct Entity_Desc Entity_Desc;
+struct Entity_Desc {
+    Vector3 position;
+    Quaternion rotation;                // normalized
+    f32 scale;
+    Vector3 angularVelocity;            // world space axis times radians per second
+    u32 model;
+};
+
+// the store's arrays, entity i is element i of each, valid until the next create or destroy
+typedef struct Entity_Arrays Entity_Arrays;
+struct Entity_Arrays {
+    u32 count;
+    f32 *positionX, *positionY, *positionZ;
+    f32 *rotationX, *rotationY, *rotationZ, *rotationW;
+    f32 *scale;
+    f32 *angularX, *angularY, *angularZ;
+    u32 *model;
+    const Matrix *world;                // as of the last Entity_Update()
+    const Entity_Handle *handles;
+};
+
+Entity_Store *Entity_StoreCreate(u32 capacity);
+void Entity_StoreUnload(Entity_Store *store);
+
+// returns 0 when the store is full
+Entity_Handle Entity_Create(Entity_Store *store, Entity_Desc desc);
+void Entity_Destroy(Entity_Store *store, Entity_Handle handle);
+b8 Entity_IsAlive(const Entity_Store *store, Entity_Handle handle);
+
+// index into the arrays, changes when other entities are destroyed, ENTITY_MAX_CAPACITY for dead handles
+u32 Entity_Index(const Entity_Store *store, Entity_Handle handle);
+u32 Entity_Count(const Entity_Store *store);
+Entity_Arrays Entity_GetArrays(Entity_Store *store);
+
+void Entity_Update(Entity_Store *store, f32 dt);
+// entities [first, end) only, ranges that don't overlap can be updated on different threads at once, see job.h
+void Entity_UpdateRange(Entity_Store *store, u32 first, u32 end, f32 dt);
+
+#endif //FIDDLE_ENTITY_H
@@ -0,0 +1,24 @@
+#ifndef FIDDLE_FILEMAP_H
+#define FIDDLE_FILEMAP_H
+
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Read-only memory mapped files
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - thin wrapper over mmap / MapViewOfFile, pages are brought in by the OS on first touch
+// - the mapping is read-only, writing through data faults
+
+typedef struct FileMap FileMap;
+struct FileMap {
+    const u8 *data;
+    u64 size;
+    void *handle;       // platform specific, NULL on posix
+};
+
+b8 FileMap_Open(const char *fileName, FileMap *map);
+void FileMap_Close(FileMap *map);
+
+#endif //FIDDLE_FILEMAP_H
@@ -0,0 +1,65 @@
+#ifndef FIDDLE_FRAMEBENCH_H
+#define FIDDLE_FRAMEBENCH_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Scripted frame benchmark
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - 'fiddle --benchmark' flies the player and both cameras along a scripted path with frame limiting off,
+//   every frame moves the script forward by exactly one 60 Hz step however long it took to draw,
+//   so every run draws the same frames and only the time they take changes
+// - recording starts once model streaming has finished, CPU times come from Timer_Seconds(),
+//   GPU times from gputimer.h, which lag a few frames behind, so a run draws a few extra frames at the end
+// - the whole frame's timer query is made here, the passes' ones are the profiler's (Profiler_BeginPass()),
+//   picked up by name
+// - passes are matched up by name, the report has p50 / p95 / p99 / max (nearest rank) of the whole frame
+//   and of each pass as JSON, and every frame's times as CSV
+// - triangles counted into a frame are reported per frame and as throughput over the frames' wall time,
+//   texture binds per frame alongside them
+// - runs under Mesa's software GL too, see readme.md
+
+enum FrameBench_ConstExpr {
+    FRAMEBENCH_MAX_PASSES = 8,
+};
+
+// where the player and the cameras are at a point of the script
+typedef struct FrameBench_Key FrameBench_Key;
+struct FrameBench_Key {
+    f32 time;                           // seconds from the start of the script
+    Vector2 playerPos;
+    Vector3 eye;                        // first person camera
+    Vector3 target;
+    f32 overheadRotation;
+    f32 overheadZoom;
+};
+
+// positions follow a Catmull-Rom spline through the keys, the rest is blended linearly,
+// times past either end clamp to the first / last key
+FrameBench_Key FrameBench_SamplePath(const FrameBench_Key *keys, u32 count, f32 time);
+
+// records the next frames, GPU times included when timer queries work
+void FrameBench_Start(u32 frames);
+void FrameBench_Shutdown(void);
+b8 FrameBench_IsRecording(void);
+b8 FrameBench_IsDone(void);
+
+void FrameBench_BeginFrame(void);
+void FrameBench_EndFrame(void);
+
+// name must be a string literal, passes shouldn't nest
+u32 FrameBench_BeginPass(const char *name);
+void FrameBench_EndPass(u32 pass);
+
+// triangles drawn this frame, adds up over the frame's passes
+void FrameBench_AddTriangles(u64 triangles);
+// same for texture binds
+void FrameBench_AddTextureBinds(u32 binds);
+
+b8 FrameBench_WriteJSON(const char *fileName);
+b8 FrameBench_WriteCSV(const char *fileName);
+
+#endif //FIDDLE_FRAMEBENCH_H
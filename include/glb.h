@@ -0,0 +1,49 @@
+#ifndef FIDDLE_GLB_H
+#define FIDDLE_GLB_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// CPU side GLB (binary glTF 2.0) loading
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - split of raylib's LoadModel() into a CPU half (parse + decode, no GL calls, safe on any thread)
+//   and a GPU half (UploadMesh / LoadTextureFromImage, main thread only)
+// - output follows raylib's glTF loader conventions so the uploaded Model is interchangeable with LoadModel():
+//   one mesh per primitive, material 0 is the default material and glTF material i maps to i + 1
+// - supports what our content uses: triangle primitives with position/normal/texcoord/color attributes,
+//   8/16/32 bit indices and embedded png/jpg base color textures
+// - like raylib 4.5 node transforms are not applied, skins and animations are ignored
+
+typedef struct GLB_MaterialData GLB_MaterialData;
+struct GLB_MaterialData {
+    Color color;        // base color factor
+    Image albedo;       // decoded base color texture, data is NULL if the material isn't textured
+};
+
+typedef struct GLB_ModelData GLB_ModelData;
+struct GLB_ModelData {
+    Mesh *meshes;                   // CPU side only, vaoId stays 0 until uploaded
+    int meshCount;
+    int *meshMaterial;
+    GLB_MaterialData *materials;
+    int materialCount;
+};
+
+b8 GLB_LoadModelData(const char *fileName, GLB_ModelData *data);
+b8 GLB_LoadModelDataFromMemory(const u8 *fileData, u32 dataSize, GLB_ModelData *data);
+void GLB_UnloadModelData(GLB_ModelData *data);
+
+// CPU side memory held by the model data (vertex attributes, indices and decoded images)
+u64 GLB_ModelDataSize(const GLB_ModelData *data);
+
+// upload everything in one go and hand ownership of the CPU side arrays to the returned Model,
+// the model data is left empty, main thread only
+Model GLB_UploadModelData(GLB_ModelData *data);
+
+// create the raylib material for an (already uploaded or untextured) material slot
+Material GLB_MaterialFromData(const GLB_MaterialData *material, Texture2D albedo);
+
+#endif //FIDDLE_GLB_H
@@ -0,0 +1,50 @@
+#ifndef FIDDLE_GPUTIMER_H
+#define FIDDLE_GPUTIMER_H
+
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// GPU timer queries
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - GPU time of a stretch of draw calls, measured with GL timestamp queries (core since GL 3.3)
+// - results show up GPUTIMER_LATENCY frames after they were recorded, so reading them never waits on the GPU
+// - zones nest, each Begin / End is a timestamp and the rlgl batch is flushed first,
+//   so draws batched before the mark are counted on the right side of it
+// - without timer queries (GLES2, web, no GL context in the headless benchmarks) everything quietly does nothing
+
+enum GpuTimer_ConstExpr {
+    GPUTIMER_MAX_ZONES = 64,            // per frame, zones past that are ignored
+    GPUTIMER_LATENCY = 3,               // frames between recording a zone and reading it back
+};
+
+#define GPUTIMER_INVALID_ZONE ((u32) -1)
+
+typedef struct GpuTimer_Zone GpuTimer_Zone;
+struct GpuTimer_Zone {
+    const char *name;                   // not copied, use string literals
+    u32 depth;                          // 0 for top level zones
+    f64 start;                          // seconds since the frame's first timestamp
+    f64 duration;                       // seconds
+};
+
+// after the GL context is up
+void GpuTimer_Init(void);
+void GpuTimer_Shutdown(void);
+b8 GpuTimer_IsAvailable(void);
+
+// GL_RENDERER, eg. "llvmpipe (LLVM 15.0.7, 256 bits)", empty without a context
+const char *GpuTimer_Renderer(void);
+
+void GpuTimer_BeginFrame(void);
+u32 GpuTimer_Begin(const char *name);
+void GpuTimer_End(u32 zone);
+
+// zones of the newest frame whose results are in, in the order they began, 0 until there is one
+u32 GpuTimer_Results(const GpuTimer_Zone **zones, u64 *frame);
+
+// frame counter, incremented by every GpuTimer_BeginFrame()
+u64 GpuTimer_Frame(void);
+
+#endif //FIDDLE_GPUTIMER_H
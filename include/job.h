@@ -0,0 +1,68 @@
+#ifndef FIDDLE_JOB_H
+#define FIDDLE_JOB_H
+
+#include <stdatomic.h>
+
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Job scheduler
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - a pool of worker threads, each with a fixed size Chase-Lev deque: its owner pushes and pops at the bottom
+//   without locks, idle workers steal the oldest job from the top of another's, the main thread is worker 0
+// - threads that aren't job workers (the loader's, say) push into a small locked queue instead, and may wait
+//   on jobs like anyone else
+// - a Job_Counter counts the unfinished jobs added with it, Job_Wait() runs other jobs until it's zero,
+//   Job_RunAfter() holds a job back until another counter is zero, that's all there is to dependencies
+// - Job_ParallelFor() pushes the whole range, whoever runs it pushes half back and keeps halving its own part
+//   until it's grain long, so thieves take big pieces first and split them in turn
+// - a full deque or job pool runs the job right away on the calling thread, nothing is dropped
+// - without Job_Init() everything runs on the calling thread inside the call that added it, so code using jobs
+//   works the same in tools that never start the workers
+// - counters start zeroed and may be reused once waited on, they must outlive their jobs
+
+enum Job_ConstExpr {
+    JOB_MAX_WORKERS = 31,               // plus the main thread
+    JOB_DEQUE_CAPACITY = 4096,          // jobs queued per thread, and in flight from it
+};
+
+typedef void (*Job_Func)(void *arg);
+typedef void (*Job_RangeFunc)(void *arg, u32 first, u32 end);
+
+typedef struct Job_Counter Job_Counter;
+struct Job_Counter {
+    atomic_uint pending;
+    atomic_uint lock;                   // guards waiting, held while the last job finishes
+    struct Job *waiting;                // Job_RunAfter() jobs held back until pending is zero
+};
+
+typedef struct Job_Stats Job_Stats;
+struct Job_Stats {
+    u32 workers;                        // not counting the main thread
+    u64 jobs;                           // run since Job_Init()
+    u64 steals;                         // of those, taken from another thread's deque
+    u64 inlined;                        // run on the spot because a deque or pool was full
+};
+
+// workerCount < 0 picks one less than the hardware thread count, 0 runs jobs on threads waiting for them only,
+// has to be called from the main thread
+void Job_Init(int workerCount);
+void Job_Shutdown(void);
+u32 Job_WorkerCount(void);
+
+// counter may be NULL for jobs nobody waits on
+void Job_Run(Job_Func func, void *arg, Job_Counter *counter);
+void Job_RunAfter(Job_Counter *dependency, Job_Func func, void *arg, Job_Counter *counter);
+
+// func is called on pieces [first, end) of [0, count), none longer than grain
+void Job_ParallelFor(Job_RangeFunc func, void *arg, u32 count, u32 grain, Job_Counter *counter);
+
+// runs queued jobs on the calling thread until the counter's jobs are done
+void Job_Wait(Job_Counter *counter);
+b8 Job_IsDone(Job_Counter *counter);
+
+Job_Stats Job_GetStats(void);
+
+#endif //FIDDLE_JOB_H
@@ -0,0 +1,56 @@
+#ifndef FIDDLE_JSON_H
+#define FIDDLE_JSON_H
+
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Minimal JSON reader
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - parses into a flat array of tokens (pre-order), tokens reference the source text instead of copying it
+// - each token knows where its subtree ends, so siblings can be walked without recursion
+// - read-only and allocation-light, just enough for glTF headers, no unicode escape decoding
+// - thread safe, a document is only ever touched by the thread that parsed it
+
+enum JSON_Type {
+    JSON_Type_Null,
+    JSON_Type_Bool,
+    JSON_Type_Number,
+    JSON_Type_String,
+    JSON_Type_Array,
+    JSON_Type_Object,
+};
+
+typedef struct JSON_Token JSON_Token;
+struct JSON_Token {
+    enum JSON_Type type;
+    i32 start;          // byte range in the source text, strings exclude their quotes
+    i32 end;
+    i32 size;           // number of direct children, object keys and values count as one pair
+    i32 subtreeEnd;     // index of the first token after this token's subtree
+};
+
+typedef struct JSON_Document JSON_Document;
+struct JSON_Document {
+    const char *text;
+    JSON_Token *tokens;
+    i32 count;
+    i32 capacity;
+};
+
+b8 JSON_Parse(const char *text, i32 length, JSON_Document *doc);
+void JSON_Free(JSON_Document *doc);
+
+// navigation, all return -1 when the requested token doesn't exist
+i32 JSON_ObjectGet(const JSON_Document *doc, i32 object, const char *key);
+i32 JSON_ArrayGet(const JSON_Document *doc, i32 array, i32 index);
+i32 JSON_Count(const JSON_Document *doc, i32 token);
+
+// value accessors, fall back when the token is missing or of a different type
+f64 JSON_Number(const JSON_Document *doc, i32 token, f64 fallback);
+i64 JSON_Int(const JSON_Document *doc, i32 token, i64 fallback);
+b8 JSON_Bool(const JSON_Document *doc, i32 token, b8 fallback);
+b8 JSON_StringEquals(const JSON_Document *doc, i32 token, const char *string);
+
+#endif //FIDDLE_JSON_H
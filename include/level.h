@@ -0,0 +1,52 @@
+#ifndef FIDDLE_LEVEL_H
+#define FIDDLE_LEVEL_H
+
+#include "raylib.h"
+#include "common.h"
+#include "cluster.h"
+
+// ----------------------------------------------------------------------------
+// Static level layout
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - the part of the first person scene that never moves: the ground, the tree grid, the starting room's walls
+//   and the lights around the trees, described as plain data so the game and the light baker (tools/bake.c)
+//   build exactly the same thing
+// - every piece of geometry is an axis aligned box, a box without height is a plane facing up
+// - walls are the wall tiles of the starting room stood up, 6 units to a tile, merged into runs
+//   (see Occlusion_MergeTiles()), so there are a few big boxes instead of one per tile
+// - boxes come in a fixed order: ground, then a trunk and a canopy per tree, then the walls
+
+enum Level_ConstExpr {
+    LEVEL_TREES_PER_SIDE = 11,
+    LEVEL_MAX_BOXES = 1 + 2 * LEVEL_TREES_PER_SIDE * LEVEL_TREES_PER_SIDE + MAX_SCENE_WALLS,
+    LEVEL_MAX_LIGHTS = 4 + (LEVEL_TREES_PER_SIDE - 1) * (LEVEL_TREES_PER_SIDE - 1),
+};
+
+enum Level_BoxKind {
+    Level_Box_Ground,
+    Level_Box_TreeTrunk,
+    Level_Box_TreeCanopy,
+    Level_Box_Wall,
+};
+
+typedef struct Level_Box Level_Box;
+struct Level_Box {
+    Vector3 center;
+    Vector3 size;                   // y = 0 for a plane
+    Color color;                    // tint, and the albedo light bounces off
+    enum Level_BoxKind kind;
+};
+
+// hand made starting room, 1 is a wall, stamped into the world map's corner
+extern const u8 Level_StartingRoom[MAP_SIZE * MAP_SIZE];
+
+// returns how many boxes there are, which may be more than maxBoxes in which case the output is truncated
+u32 Level_StaticBoxes(const u8 *map, Level_Box *boxes, u32 maxBoxes);
+
+// the four colored lights that reach the whole scene and a small one between every four trees,
+// same truncation as Level_StaticBoxes()
+u32 Level_StaticLights(Cluster_Light *lights, u32 maxLights);
+
+#endif //FIDDLE_LEVEL_H
@@ -0,0 +1,92 @@
+#ifndef FIDDLE_LIGHTMAP_H
+#define FIDDLE_LIGHTMAP_H
+
+#include "raylib.h"
+#include "common.h"
+#include "cluster.h"
+#include "level.h"
+
+// ----------------------------------------------------------------------------
+// Baked lighting
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - light from the static level's lights (see level.h) on the static level's boxes, direct and bounced,
+//   is baked offline by fiddle-bake into data/level.lightmap, the game draws those boxes with lighting_baked.frag
+//   which reads it back and only evaluates the lights that aren't baked
+// - every box face is unwrapped into its own rectangle of texels (a chart) in one atlas, at a fixed number of
+//   texels per world unit, with a texel of gutter around it filled from its edge so filtering doesn't bleed,
+//   the ground is a single face and keeps its own 0..1 uvs, scaled into its chart, faces resting on the ground
+//   are never seen and get no chart
+// - the baker is a CPU path tracer: a texel averages samples jittered over its patch of the face, each sample
+//   gathers every light in range through a shadow ray and then follows cosine weighted bounces off the boxes'
+//   colors, gathering again at each hit, rays that leave the level see black
+// - light from a light is computed the way lighting.frag does it, color * N.L * smooth falloff to its radius,
+//   specular depends on the view and stays with the live lights
+// - rays go through a BVH of the boxes, Lightmap_Bake() works on rows of the atlas, ranges that don't overlap
+//   can run on different threads at once (see job.h), every texel seeds its own random numbers so the result
+//   doesn't depend on how the rows were split
+// - texels are stored RGBM, rgb * a * LIGHTMAP_RGBM_RANGE, so bright and dark texels both keep their precision,
+//   with a hash of the level they were baked for, a file baked for another level isn't loaded
+// - Lightmap_GenBoxMesh() builds a box like GenMeshCube() with the atlas uvs of its charts in texcoords2, the atlas
+//   goes in the LIGHTMAP_MATERIAL_MAP slot of its material, lightmapped materials aren't batched (see batch.h)
+
+typedef struct Lightmap Lightmap;
+typedef struct Lightmap_Baker Lightmap_Baker;
+
+enum Lightmap_ConstExpr {
+    LIGHTMAP_MATERIAL_MAP = MATERIAL_MAP_OCCLUSION,     // raylib has no slot of its own for it, ours don't use this one
+    LIGHTMAP_RGBM_RANGE = 8,
+};
+
+typedef struct Lightmap_BakeDesc Lightmap_BakeDesc;
+struct Lightmap_BakeDesc {
+    const Level_Box *boxes;
+    u32 boxCount;
+    const Cluster_Light *lights;
+    u32 lightCount;
+    f32 texelsPerUnit;
+    u32 samples;                        // per texel
+    u32 bounces;                        // 0 for direct light only
+};
+
+typedef struct Lightmap_BakeStats Lightmap_BakeStats;
+struct Lightmap_BakeStats {
+    u32 width, height;
+    u32 charts;
+    u64 texels;                         // covered by a chart, baked so far
+    u64 samples;
+    u64 rays;                           // bounces and shadow rays
+};
+
+// identifies what a lightmap was baked for, the lights' baked flags don't count
+u64 Lightmap_LevelHash(const Level_Box *boxes, u32 boxCount, const Cluster_Light *lights, u32 lightCount);
+
+// unwraps and packs the charts and builds the BVH, boxes and lights are copied
+Lightmap_Baker *Lightmap_BakerCreate(Lightmap_BakeDesc desc);
+void Lightmap_BakerUnload(Lightmap_Baker *baker);
+
+// bakes atlas rows [firstRow, endRow)
+u32 Lightmap_BakeRows(const Lightmap_Baker *baker);
+void Lightmap_Bake(Lightmap_Baker *baker, u32 firstRow, u32 endRow);
+
+Lightmap_BakeStats Lightmap_GetBakeStats(const Lightmap_Baker *baker);
+
+// of the texels baked so far, the same for any split of the rows between threads
+u64 Lightmap_BakerHash(const Lightmap_Baker *baker);
+
+// fills the gutters and writes the file, once every row was baked
+b8 Lightmap_BakerSave(Lightmap_Baker *baker, const char *fileName);
+
+// NULL when the file is missing, broken or baked for a different level
+Lightmap *Lightmap_Load(const char *fileName, u64 levelHash);
+void Lightmap_Unload(Lightmap *lightmap);
+
+// the atlas as RGBM texels, owned by the lightmap
+Image Lightmap_GetImage(const Lightmap *lightmap);
+u32 Lightmap_BoxCount(const Lightmap *lightmap);
+
+// the box centered on the origin with its charts' atlas uvs in texcoords2, uploaded
+Mesh Lightmap_GenBoxMesh(const Lightmap *lightmap, u32 box);
+
+#endif //FIDDLE_LIGHTMAP_H
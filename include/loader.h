@@ -0,0 +1,78 @@
+#ifndef FIDDLE_LOADER_H
+#define FIDDLE_LOADER_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Asynchronous model loading
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - a pool of worker threads reads and parses .glb files into CPU side mesh + image data (see glb.h)
+// - the main thread uploads parsed models to the GPU from Loader_Update(), one mesh or texture at a time,
+//   stopping once the per-frame time budget is spent so streaming never causes a long frame
+// - handles are requested up front and report their state, Loader_GetModel() returns a stable pointer
+//   to an empty model (meshCount == 0) until the model is ready, so callers can draw a placeholder meanwhile
+// - requesting the same file twice returns the same handle, the loader owns all models it loads
+// - with a cooked pack mounted (see pack.h) models found in it skip the workers entirely,
+//   they're uploaded straight from the mapped file, everything else still goes through the workers
+// - meshes and textures parsed from .glb go through the resource cache (see resource.h), identical
+//   content across models is uploaded once, packs already share their textures by construction
+// - detailed models get simplified LOD levels (see lod.h), generated on the workers after parsing
+//   or read from the pack, where the cooker stored them, they're uploaded along with the model
+
+typedef u32 Loader_Handle;      // 0 is never a valid handle
+
+enum Loader_State {
+    Loader_State_Invalid,
+    Loader_State_Queued,        // waiting for a worker
+    Loader_State_Parsing,       // being read and decoded on a worker
+    Loader_State_Uploading,     // parsed, waiting for (or part way through) GPU upload
+    Loader_State_Ready,
+    Loader_State_Failed,
+};
+
+typedef struct Loader_Stats Loader_Stats;
+struct Loader_Stats {
+    u32 requested;
+    u32 parsed;                 // parsed on a worker, ready for (or done with) upload
+    u32 ready;
+    u32 failed;
+    u64 bytesParsed;            // CPU side data produced by the workers
+    f64 firstRequestTime;       // Timer_Seconds() of the first request
+    f64 lastReadyTime;          // Timer_Seconds() when the most recent model became ready (or failed)
+    f64 parseSeconds;           // summed over all workers
+    f64 uploadSeconds;          // summed over all frames
+    f64 worstUploadSeconds;     // most time spent uploading in a single Loader_Update()
+};
+
+// workerCount <= 0 picks one worker per hardware thread, minus one for the main thread
+void Loader_Init(int workerCount);
+void Loader_Shutdown(void);
+
+// call before requesting models, the loader keeps the pack open until shutdown
+b8 Loader_MountPack(const char *fileName);
+
+Loader_Handle Loader_LoadModel(const char *fileName);
+
+// main thread only, uploads parsed models until budgetSeconds is spent (at least one step per call)
+void Loader_Update(f64 budgetSeconds);
+
+// blocks until every requested model is ready or failed, for tools and benchmarks
+void Loader_Flush(void);
+
+enum Loader_State Loader_GetState(Loader_Handle handle);
+b8 Loader_IsReady(Loader_Handle handle);
+b8 Loader_IsIdle(void);
+Model *Loader_GetModel(Loader_Handle handle);
+// levels including the model itself, 1 for models without simplified levels or that aren't ready yet
+u32 Loader_GetLodCount(Loader_Handle handle);
+// copy of the model with a level's meshes swapped in, it shares the model's materials and transform,
+// level 0, or a level the model doesn't have, is the model itself
+Model Loader_GetModelLod(Loader_Handle handle, u32 level);
+const char *Loader_GetFileName(Loader_Handle handle);
+
+Loader_Stats Loader_GetStats(void);
+
+#endif //FIDDLE_LOADER_H
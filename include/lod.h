@@ -0,0 +1,52 @@
+#ifndef FIDDLE_LOD_H
+#define FIDDLE_LOD_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Mesh level of detail
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - simplification is quadric error edge collapse (Garland & Heckbert) that only collapses onto existing vertices,
+//   so every level indexes the source mesh's vertices and the next level can be simplified from the previous one
+// - vertices sharing a position collapse together, a collapse moves each uv / normal wedge onto the closest one
+//   at the other end, open borders and uv / normal seams carry extra planes so silhouettes and seams stay put
+// - collapses that would flip a triangle are rejected, a level stops at its triangle target or its error limit,
+//   whichever comes first, levels that can't get meaningfully smaller repeat the previous level
+// - error limits scale with the model's extent and line up with the selection thresholds below,
+//   so whichever level is picked the geometric error stays around 2 pixels at 720p
+// - everything but Lod_Select() and Lod_ScreenSize() is pure CPU work and safe on any thread,
+//   the loader runs it on its workers and the cooker stores the results in the pack
+// - Lod_GenerateLevels() simplifies each mesh of a model as its own job (see job.h), so a model with several
+//   meshes spreads over the job workers instead of keeping one loader thread busy
+
+enum Lod_ConstExpr {
+    LOD_MAX_LEVELS = 4,                 // including the source mesh as level 0
+    LOD_MIN_TRIANGLES = 512,            // models with fewer triangles in total get no levels
+};
+
+// simplified index list over the same vertices, at most indexCount indices are written to destination,
+// returns how many were, error is set to the largest collapse error in model units
+u32 Lod_Simplify(const Mesh *mesh, const u16 *indices, u32 indexCount, u32 targetIndexCount, f32 maxError,
+                 u16 *destination, f32 *error);
+
+// a standalone mesh (CPU side only) with just the vertices the indices use
+Mesh Lod_BuildMesh(const Mesh *source, const u16 *indices, u32 indexCount);
+
+// levels 1.. of every mesh of a model, level l of mesh i goes to levels[(l - 1) * meshCount + i],
+// levels needs room for (LOD_MAX_LEVELS - 1) * meshCount meshes, returns how many levels were written
+u32 Lod_GenerateLevels(const Mesh *meshes, u32 meshCount, Mesh *levels);
+
+// frees the CPU arrays of a generated mesh that was never uploaded
+void Lod_FreeMesh(Mesh *mesh);
+
+// fraction of the view height the bounds' enclosing sphere covers, above 1 when the camera is inside it
+f32 Lod_ScreenSize(BoundingBox bounds, Camera3D camera);
+
+// level for an object of that screen size that's currently drawn at current, levelCount includes level 0,
+// moving to another level takes a margin past the threshold so objects near one don't flicker between two
+u32 Lod_Select(f32 screenSize, u32 current, u32 levelCount);
+
+#endif //FIDDLE_LOD_H
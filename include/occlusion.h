@@ -0,0 +1,56 @@
+#ifndef FIDDLE_OCCLUSION_H
+#define FIDDLE_OCCLUSION_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Occlusion culling
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - occluders are boxes, all six faces are rasterized on the CPU into a small depth buffer of 1/w values
+//   (bigger is closer), 4 pixels per SSE operation (scalar fallback where SSE isn't available)
+// - a face only writes pixels it covers entirely, at the farthest depth it has anywhere in the pixel,
+//   so the buffer never claims more than the boxes really hide, back faces fill in the seams between front faces
+// - the buffer is split in 8x8 pixel tiles that keep their farthest depth, a box behind that is hidden in
+//   the whole tile without looking at its pixels, the rest are compared 4 at a time
+// - tested boxes are projected to their screen rectangle at the depth of their nearest corner, a box that
+//   crosses the near plane is always visible
+// - Occlusion_Rasterize() works on rows of tiles, ranges that don't overlap can run on different threads at
+//   once (see job.h), tests only read the buffer and are safe on any number of threads after that
+// - occluders are meant to be few and big: Occlusion_MergeTiles() turns a grid of wall tiles into rectangles
+
+typedef struct Occlusion_Buffer Occlusion_Buffer;
+
+enum Occlusion_ConstExpr {
+    OCCLUSION_TILE_SIZE = 8,            // pixels per tile side, buffer sizes are rounded up to whole tiles
+};
+
+typedef struct Occlusion_Stats Occlusion_Stats;
+struct Occlusion_Stats {
+    u32 occluders;                      // boxes added since Occlusion_Begin()
+    u32 faces;                          // of theirs, in front of the near plane and not edge on
+};
+
+Occlusion_Buffer *Occlusion_Create(u32 width, u32 height);
+void Occlusion_Unload(Occlusion_Buffer *buffer);
+
+// forgets the previous occluders, viewProjection as from Cull_ViewProjection()
+void Occlusion_Begin(Occlusion_Buffer *buffer, Matrix viewProjection);
+void Occlusion_AddBox(Occlusion_Buffer *buffer, BoundingBox box);
+
+// clears tile rows [firstRow, endRow) and draws every occluder into them
+u32 Occlusion_TileRows(const Occlusion_Buffer *buffer);
+void Occlusion_Rasterize(Occlusion_Buffer *buffer, u32 firstRow, u32 endRow);
+
+// false when the box is certainly hidden, only meaningful once every tile row was rasterized
+b8 Occlusion_TestBox(const Occlusion_Buffer *buffer, BoundingBox box);
+
+Occlusion_Stats Occlusion_GetStats(const Occlusion_Buffer *buffer);
+
+// tiles equal to value merged into rectangles in tile units, runs along rows first, what's left along columns,
+// returns how many rectangles there are, which may be more than maxRects in which case the output is truncated
+u32 Occlusion_MergeTiles(const u8 *tiles, u32 width, u32 height, u8 value, Rectangle *rects, u32 maxRects);
+
+#endif //FIDDLE_OCCLUSION_H
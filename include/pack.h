@@ -0,0 +1,116 @@
+#ifndef FIDDLE_PACK_H
+#define FIDDLE_PACK_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Cooked model packs
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - a pack is a directory of .glb files cooked offline (see tools/cook.c) into one file
+//   that's memory mapped at runtime, nothing is parsed or decoded when loading from it
+// - vertex attributes are stored in exactly the layout raylib's Mesh expects, so meshes point
+//   straight into the mapping and UploadMesh() reads from it without intermediate copies
+// - textures are stored decoded (RGBA8) and deduplicated at cook time, each one is uploaded
+//   once per pack and shared by every model that references it
+// - models loaded from a pack reference the mapping and the pack's textures,
+//   unload them with Pack_UnloadModel() before closing the pack
+// - the cooker also stores each model's LOD chain (see lod.h), generated once offline instead of on every load
+
+// ----------------------------------------------------------------------------
+// File format
+// ----------------------------------------------------------------------------
+
+// all offsets are in bytes from the start of the file, blobs are PACK_ALIGNMENT aligned,
+// integers are little endian (the cooker and the runtime only target little endian machines)
+
+#define PACK_MAGIC      0x4B415046u     // 'FPAK'
+#define PACK_VERSION    2u
+#define PACK_ALIGNMENT  64u
+#define PACK_NAME_SIZE  64u
+
+typedef struct Pack_Header Pack_Header;
+struct Pack_Header {
+    u32 magic;
+    u32 version;
+    u32 modelCount;
+    u32 meshCount;
+    u32 materialCount;
+    u32 textureCount;
+    u64 modelsOffset;       // Pack_ModelRecord[modelCount], sorted by name
+    u64 meshesOffset;       // Pack_MeshRecord[meshCount]
+    u64 materialsOffset;    // Pack_MaterialRecord[materialCount]
+    u64 texturesOffset;     // Pack_TextureRecord[textureCount]
+};
+
+typedef struct Pack_ModelRecord Pack_ModelRecord;
+struct Pack_ModelRecord {
+    char name[PACK_NAME_SIZE];  // source file name without directory, null terminated
+    u32 firstMesh;
+    u32 meshCount;
+    u32 firstMaterial;
+    u32 materialCount;
+    u32 lodCount;               // levels past the model itself, level l's meshes follow at firstMesh + l * meshCount
+};
+
+typedef struct Pack_MeshRecord Pack_MeshRecord;
+struct Pack_MeshRecord {
+    u32 vertexCount;
+    u32 triangleCount;
+    u32 material;               // model relative, like Model.meshMaterial
+    u32 reserved;
+    u64 vertices;               // f32 x3, required
+    u64 texcoords;              // f32 x2, 0 if absent
+    u64 normals;                // f32 x3, 0 if absent
+    u64 colors;                 // u8 x4, 0 if absent
+    u64 indices;                // u16 x3 per triangle, 0 for non-indexed meshes
+};
+
+typedef struct Pack_MaterialRecord Pack_MaterialRecord;
+struct Pack_MaterialRecord {
+    Color color;
+    i32 texture;                // index into the texture records, -1 if untextured
+};
+
+typedef struct Pack_TextureRecord Pack_TextureRecord;
+struct Pack_TextureRecord {
+    u32 width;
+    u32 height;
+    u32 format;                 // PixelFormat
+    u32 mipmaps;
+    u64 data;
+    u64 dataSize;
+};
+
+// ----------------------------------------------------------------------------
+// Runtime
+// ----------------------------------------------------------------------------
+
+typedef struct Pack Pack;
+
+// returns NULL if the file is missing or isn't a valid pack
+Pack *Pack_Open(const char *fileName);
+// unloads the pack's textures and unmaps the file
+void Pack_Close(Pack *pack);
+
+u32 Pack_ModelCount(const Pack *pack);
+const char *Pack_ModelName(const Pack *pack, u32 model);
+// looks a model up by source file name, directories are ignored, returns -1 if not found
+i32 Pack_FindModel(const Pack *pack, const char *fileName);
+
+// CPU side view of a mesh, arrays point into the mapping and must not be freed or written to
+u32 Pack_MeshCount(const Pack *pack, u32 model);
+Mesh Pack_GetMesh(const Pack *pack, u32 model, u32 mesh);
+// same for the simplified levels, level 0 is the model itself
+u32 Pack_LodCount(const Pack *pack, u32 model);
+Mesh Pack_GetLodMesh(const Pack *pack, u32 model, u32 level, u32 mesh);
+
+// upload a model, main thread only
+Model Pack_LoadModel(Pack *pack, u32 model);
+void Pack_UnloadModel(Model model);
+// for meshes from Pack_GetLodMesh() uploaded by the caller, with Quant_UploadMesh() (see quant.h)
+void Pack_UnloadMesh(Mesh mesh);
+
+#endif //FIDDLE_PACK_H
@@ -0,0 +1,101 @@
+#ifndef FIDDLE_PROFILER_H
+#define FIDDLE_PROFILER_H
+
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Hierarchical CPU / GPU profiler
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - zones nest, each thread writes the zones it finishes into its own ring buffer (single producer, single consumer),
+//   the main thread drains every ring in Profiler_EndFrame(), nothing is locked on the way
+// - timestamps are the cycle counter on x86 (rdtsc, calibrated against Timer_Seconds()), Timer_Seconds() elsewhere
+// - disabled zones cost a relaxed load and a branch, building with FIDDLE_PROFILER=0 removes the PROFILE_* macros entirely
+// - a full ring drops whole zones, never half of one, the drops are counted
+// - passes are zones that also get a GPU timer query (gputimer.h), the queries are made even while the profiler
+//   is disabled, the frame benchmark and dynamic resolution read their per pass GPU times from them
+// - threads show up by the name they gave Profiler_SetThreadName(), threads sharing a name are added up
+// - the overlay rows are per frame averages, refreshed every half second, captures are written as Chrome trace_event JSON
+//   (chrome://tracing or ui.perfetto.dev), GPU zones go on their own track lined up with the CPU frame they belong to
+
+#if !defined(FIDDLE_PROFILER)
+    #define FIDDLE_PROFILER 1
+#endif
+
+enum Profiler_ConstExpr {
+    PROFILER_MAX_THREADS = 32,
+    PROFILER_MAX_DEPTH = 32,            // zones nested deeper than this aren't recorded
+    PROFILER_RING_SIZE = 8192,          // finished zones per thread between two Profiler_EndFrame() calls, power of 2
+    PROFILER_MAX_ROWS = 128,
+    PROFILER_MAX_CAPTURE_EVENTS = 1 << 20,
+};
+
+// 0 when the zone wasn't recorded
+typedef u32 Profiler_Zone;
+
+typedef struct Profiler_Pass Profiler_Pass;
+struct Profiler_Pass {
+    Profiler_Zone cpu;
+    u32 gpu;
+};
+
+// one line of the overlay, children follow their parent
+typedef struct Profiler_Row Profiler_Row;
+struct Profiler_Row {
+    const char *thread;                 // "gpu" for timer queries
+    const char *name;
+    u32 depth;
+    f32 calls;                          // per frame
+    f64 seconds;                        // per frame
+};
+
+typedef struct Profiler_Stats Profiler_Stats;
+struct Profiler_Stats {
+    u32 threads;
+    u64 zones;                          // recorded since Profiler_Init()
+    u64 dropped;                        // lost to full rings
+    f64 ticksPerSecond;
+};
+
+// call on the main thread before any other thread records zones
+void Profiler_Init(void);
+void Profiler_Shutdown(void);
+
+void Profiler_SetEnabled(b8 enabled);
+b8 Profiler_IsEnabled(void);
+
+// name must be a string literal or otherwise outlive the profiler
+void Profiler_SetThreadName(const char *name);
+
+// on the main thread, after GpuTimer_BeginFrame()
+void Profiler_BeginFrame(void);
+void Profiler_EndFrame(void);
+
+// name must be a string literal, zones end in the reverse order they began
+Profiler_Zone Profiler_Begin(const char *name);
+void Profiler_End(Profiler_Zone zone);
+
+// render passes, a zone and a GPU timer query around everything drawn in between
+Profiler_Pass Profiler_BeginPass(const char *name);
+void Profiler_EndPass(Profiler_Pass pass);
+
+u32 Profiler_GetRows(const Profiler_Row **rows);
+Profiler_Stats Profiler_GetStats(void);
+
+// records every zone of the next frames, enables the profiler
+void Profiler_StartCapture(u32 frames);
+b8 Profiler_IsCapturing(void);
+b8 Profiler_CaptureFinished(void);
+// writes the capture and throws it away
+b8 Profiler_WriteTrace(const char *fileName);
+
+#if FIDDLE_PROFILER
+    #define PROFILE_BEGIN(name) Profiler_Begin(name)
+    #define PROFILE_END(zone) Profiler_End(zone)
+#else
+    #define PROFILE_BEGIN(name) ((Profiler_Zone) 0)
+    #define PROFILE_END(zone) ((void) (zone))
+#endif
+
+#endif //FIDDLE_PROFILER_H
@@ -0,0 +1,57 @@
+#ifndef FIDDLE_QUANT_H
+#define FIDDLE_QUANT_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Compact vertex layout
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - opt in with Quant_SetEnabled() before models load ('fiddle --quantize'), meshes are uploaded as one
+//   interleaved 16 byte vertex instead of 32 bytes of floats, colors (when present) stay a separate u8x4 stream
+// - positions are 16 bit unorm relative to the mesh bounds, with one scale for all three axes so the decode
+//   is a uniform scale plus an offset, it's folded into the model transform at draw time (see Quant_GetDecode())
+//   and normals pass through the usual normal matrix untouched, the shaders read positions as is
+// - normals are octahedral encoded into 2 x 8 bit snorm, w is -1 so lighting.vert can tell them apart from
+//   float normals (w defaults to 1) and both layouts draw with the same programs, uvs are half floats
+// - the CPU side arrays stay floats, culling, picking and the resource cache keep working on them unchanged
+// - needs GL 3.3 for half float attributes, elsewhere meshes are uploaded as usual
+
+typedef struct Quant_Vertex Quant_Vertex;
+struct Quant_Vertex {
+    u16 position[4];        // unorm, w unused
+    u16 texcoord[2];        // half floats
+    i8 normal[4];           // snorm octahedral x, y, z unused, w = -1
+};
+
+typedef struct Quant_Stats Quant_Stats;
+struct Quant_Stats {
+    u32 meshes;             // meshes alive in the compact layout
+    u64 floatBytes;         // what their vertex and index buffers would take as floats
+    u64 compactBytes;       // what they take
+};
+
+void Quant_SetEnabled(b8 enabled);
+b8 Quant_IsEnabled(void);
+
+// encodes the mesh's vertices, returns the decode: position = decode.xyz + encoded * decode.w
+Vector4 Quant_EncodeVertices(const Mesh *mesh, Quant_Vertex *destination);
+// CPU mirror of the shader side decode
+void Quant_DecodeVertex(const Quant_Vertex *vertex, Vector4 decode, Vector3 *position, Vector2 *texcoord, Vector3 *normal);
+
+// GPU buffer bytes for the mesh in either layout, vertices and indices
+u64 Quant_MeshBytes(const Mesh *mesh, b8 compact);
+
+// stand ins for UploadMesh(mesh, false) / UnloadMesh() that use the compact layout when enabled,
+// every mesh uploaded by Quant_UploadMesh() has to be unloaded by Quant_UnloadMesh()
+void Quant_UploadMesh(Mesh *mesh);
+void Quant_UnloadMesh(Mesh mesh);
+
+// matrix to put in front of the model transform when drawing the mesh, false for float meshes
+b8 Quant_GetDecode(Mesh mesh, Matrix *decode);
+
+Quant_Stats Quant_GetStats(void);
+
+#endif //FIDDLE_QUANT_H
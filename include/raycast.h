@@ -0,0 +1,60 @@
+#ifndef FIDDLE_RAYCAST_H
+#define FIDDLE_RAYCAST_H
+
+#include "raylib.h"
+#include "common.h"
+#include "tilemap.h"
+
+// ----------------------------------------------------------------------------
+// Tile map raycasting
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - grid traversal (DDA, Amanatides & Woo) over a TileMap, stepping one tile boundary at a time
+//   until a solid tile, the edge of the map or the ray's max distance
+// - positions and distances are in world units (the map's tileSize per tile), y grows downwards like the overhead view
+// - batches are cast as packets of 4 rays, one per SSE lane, lanes that finish early are masked off
+//   until the whole packet is done, so coherent rays (a fan of view columns) make the best packets
+// - batches above a few thousand rays are split across worker threads, the calling thread works too
+// - the tile a ray starts in is never tested, a ray leaving a wall still sees past it
+// - only tile value 1 (walls) is solid until changed with Raycast_SetSolid()
+
+typedef struct Raycast_Ray Raycast_Ray;
+struct Raycast_Ray {
+    Vector2 origin;
+    Vector2 direction;      // doesn't have to be normalized
+    f32 maxDistance;
+};
+
+typedef struct Raycast_Hit Raycast_Hit;
+struct Raycast_Hit {
+    Vector2 point;          // where the ray entered the hit tile, or its end point on a miss
+    f32 distance;
+    i32 tileX, tileY;
+    u8 tile;
+    u8 side;                // 0 when a vertical tile edge was hit (the ray was stepping in x), 1 for horizontal
+    b8 hit;
+};
+
+// workerCount <= 0 picks one less than the hardware thread count
+void Raycast_Init(int workerCount);
+void Raycast_Shutdown(void);
+
+// batches are cast on the calling thread only while threading is off
+void Raycast_SetThreaded(b8 threaded);
+b8 Raycast_IsThreaded(void);
+
+void Raycast_SetSolid(u8 tile, b8 solid);
+
+// single rays, eg. picking a tile under the mouse
+Raycast_Hit Raycast_Cast(const TileMap *map, Raycast_Ray ray);
+b8 Raycast_LineOfSight(const TileMap *map, Vector2 from, Vector2 to);
+
+// many rays, SIMD packets + worker threads
+void Raycast_CastBatch(const TileMap *map, const Raycast_Ray *rays, Raycast_Hit *hits, u32 count);
+void Raycast_LineOfSightBatch(const TileMap *map, const Vector2 *from, const Vector2 *to, b8 *visible, u32 count);
+
+// one ray per column of a view, left to right across fov radians centered on angle (0 is +x)
+void Raycast_Columns(const TileMap *map, Vector2 origin, f32 angle, f32 fov, f32 maxDistance, Raycast_Hit *hits, u32 columns);
+
+#endif //FIDDLE_RAYCAST_H
@@ -0,0 +1,77 @@
+#ifndef FIDDLE_RENDERGRAPH_H
+#define FIDDLE_RENDERGRAPH_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Render pass graph
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - the frame's passes are added every frame, each with the target it draws to, the targets it samples and a hash of
+//   everything else it draws from (cameras, map version, scene state), RenderGraph_Execute() runs them in that order
+// - a pass drawing to an imported target is skipped when its hash, together with the hashes of what it samples,
+//   is the same as when the target was last drawn, the texture still holds that picture
+// - transient targets only live within a frame, they're drawn only when a pass that runs samples them,
+//   and share pooled render textures with other transients of the same size whenever their lifetimes don't overlap
+// - passes to RENDERGRAPH_SCREEN always run
+// - pooled textures are created and freed through the functions given to RenderGraph_Init(), raylib's
+//   LoadRenderTexture() / UnloadRenderTexture() in the game, stand-ins in the headless benchmark
+// - the graph doesn't begin / end texture mode, the draw function gets its target and does that itself,
+//   so it can wrap the pass in whatever timing or viewport setup it needs
+
+enum RenderGraph_ConstExpr {
+    RENDERGRAPH_MAX_PASSES = 16,
+    RENDERGRAPH_MAX_TARGETS = 16,
+    RENDERGRAPH_MAX_READS = 4,
+};
+
+#define RENDERGRAPH_SCREEN ((u32) -1)
+
+typedef u32 RenderGraph_Target;
+
+typedef void (*RenderGraph_DrawFunc)(RenderTexture2D target, void *user);
+typedef RenderTexture2D (*RenderGraph_LoadTextureFunc)(int width, int height);
+typedef void (*RenderGraph_UnloadTextureFunc)(RenderTexture2D texture);
+
+typedef struct RenderGraph_Pass RenderGraph_Pass;
+struct RenderGraph_Pass {
+    const char *name;
+    RenderGraph_DrawFunc draw;
+    void *user;
+    RenderGraph_Target output;
+    RenderGraph_Target reads[RENDERGRAPH_MAX_READS];
+    u32 readCount;
+    u64 inputs;                         // RenderGraph_Hash() of what the pass draws from besides its reads
+};
+
+typedef struct RenderGraph_Stats RenderGraph_Stats;
+struct RenderGraph_Stats {
+    u32 passes;                         // last RenderGraph_Execute()
+    u32 executed;
+    u32 skipped;                        // output unchanged
+    u32 culled;                         // transient output nobody needed
+    u32 transients;                     // transient targets drawn
+    u32 pooled;                         // render textures backing them, fewer than transients when they're aliased
+};
+
+void RenderGraph_Init(RenderGraph_LoadTextureFunc loadTexture, RenderGraph_UnloadTextureFunc unloadTexture);
+void RenderGraph_Shutdown(void);
+
+// cached across frames, the texture stays owned by the caller
+RenderGraph_Target RenderGraph_ImportTarget(RenderTexture2D texture);
+RenderGraph_Target RenderGraph_CreateTransient(int width, int height);
+// redraws the target next frame whatever the hashes say, eg. after its texture was reloaded
+void RenderGraph_Invalidate(RenderGraph_Target target);
+
+void RenderGraph_AddPass(const RenderGraph_Pass *pass);
+void RenderGraph_Execute(void);
+
+// inside a pass that reads or writes the target, a transient's texture is only borrowed for the frame
+RenderTexture2D RenderGraph_GetTexture(RenderGraph_Target target);
+
+u64 RenderGraph_Hash(u64 hash, const void *data, u64 size);
+RenderGraph_Stats RenderGraph_GetStats(void);
+
+#endif //FIDDLE_RENDERGRAPH_H
@@ -0,0 +1,66 @@
+#ifndef FIDDLE_RENDERQUEUE_H
+#define FIDDLE_RENDERQUEUE_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Sorted draw submission
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - draws are recorded as a 64 bit sort key plus a payload in a per frame arena, then sorted and executed
+//   as separate steps, RenderQueue_Execute() hands each payload back to a draw callback in key order
+// - recording goes through lanes, one per recording thread, each with its own arena and item list,
+//   so threads record without locks, RenderQueue_Sort() merges the lanes once they're done (main thread)
+// - opaque keys are pass | layer | shader | material | mesh | depth, so state changes are minimal and draws
+//   sharing state go front to back for early z, transparent keys put depth (back to front) ahead of the state
+// - sorting is an LSD radix sort over the key bytes, bytes that are the same in every key are skipped,
+//   which with few passes and shaders is most of the top ones
+// - state changes are counted on execute from the key fields of consecutive draws
+
+enum RenderQueue_ConstExpr {
+    RENDERQUEUE_MAX_LANES = 16,
+    RENDERQUEUE_MAX_PASSES = 16,
+    RENDERQUEUE_DEPTH_BITS = 19,
+};
+
+enum RenderQueue_Layer {
+    RenderQueue_Layer_Opaque,
+    RenderQueue_Layer_Transparent,
+};
+
+typedef struct RenderQueue_Stats RenderQueue_Stats;
+struct RenderQueue_Stats {
+    u32 draws;                      // last RenderQueue_Execute()
+    u32 shaderChanges;              // the first draw counts as a change of everything
+    u32 materialChanges;
+    u32 meshChanges;
+    f64 sortSeconds;                // last RenderQueue_Sort(), merging the lanes included
+};
+
+// draws with the same pass, layer, shader, material and mesh share state, ids are truncated to their fields
+// (shader 8 bits, material and mesh 16 bits), depth is 0 at the near plane and 1 at the far plane
+u64 RenderQueue_Key(u32 pass, enum RenderQueue_Layer layer, u32 shader, u32 material, u32 mesh, f32 depth);
+// a 16 bit material id that keeps materials with the same diffuse texture next to each other,
+// diffuse textures get dense ids the first time they're seen, so it's main thread only like RenderQueue_Sort()
+u32 RenderQueue_MaterialId(Material material);
+
+void RenderQueue_Init(void);
+void RenderQueue_Shutdown(void);
+
+// drops the previous frame's draws, call before recording
+void RenderQueue_Begin(void);
+
+// payload memory for a draw, not zeroed, valid until the next RenderQueue_Begin(), NULL when out of memory,
+// a lane must only be recorded into by one thread at a time
+void *RenderQueue_Push(u32 lane, u64 key, u64 payloadSize);
+
+typedef void (*RenderQueue_DrawFunc)(u64 key, const void *payload, void *user);
+
+void RenderQueue_Sort(void);
+void RenderQueue_Execute(RenderQueue_DrawFunc draw, void *user);
+
+RenderQueue_Stats RenderQueue_GetStats(void);
+
+#endif //FIDDLE_RENDERQUEUE_H
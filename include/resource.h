@@ -0,0 +1,46 @@
+#ifndef FIDDLE_RESOURCE_H
+#define FIDDLE_RESOURCE_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Shared GPU resource cache
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - meshes and textures are identified by a hash of their content (vertex/index data, pixels),
+//   identical content is uploaded once and shared between models with reference counting
+// - hashing is pure and safe on any thread so the loader does it on its workers,
+//   acquire/release make GL calls and are main thread only
+// - matches are confirmed byte for byte, meshes against the shared mesh's CPU arrays, textures against
+//   a copy of their source pixels kept while they're resident, so a hash collision only costs a compare
+// - anything that can't be tracked (cache full) is uploaded unshared and released normally,
+//   so callers never need to care whether a resource ended up shared
+
+typedef struct Resource_Stats Resource_Stats;
+struct Resource_Stats {
+    u32 meshes;             // distinct meshes alive on the GPU
+    u32 meshRefs;           // meshes handed out, including shared ones
+    u32 textures;
+    u32 textureRefs;
+    u64 vramUsed;           // approximate, vertex/index buffers plus base texture levels
+    u64 vramSaved;          // what the duplicates would have added on top
+    u64 ramSaved;           // CPU side mesh arrays freed because an identical copy was already resident
+};
+
+u64 Resource_HashMesh(const Mesh *mesh);
+u64 Resource_HashImage(Image image);
+
+// uploads the mesh, or frees its CPU arrays and replaces it with an identical resident one,
+// the mesh must own its arrays like any raylib mesh (not the case for meshes from a pack)
+void Resource_AcquireMesh(Mesh *mesh, u64 hash);
+Texture2D Resource_AcquireTexture(Image image, u64 hash);
+
+// drop a reference, the GPU resource and CPU arrays go away with the last one
+void Resource_ReleaseMesh(Mesh mesh);
+void Resource_ReleaseTexture(Texture2D texture);
+
+Resource_Stats Resource_GetStats(void);
+
+#endif //FIDDLE_RESOURCE_H
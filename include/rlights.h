@@ -9,6 +9,10 @@
 *       If not defined, the library is in header only mode and can be included in other headers
 *       or source files without problems. But only ONE file should hold the implementation.
 *
+*   NOTE: altered for fiddle, uniform names are formatted into a scratch arena (str8.h)
+*   instead of going through TextFormat()'s static buffers, and light values go through
+*   the uniform cache (uniform.h) so unchanged lights aren't uploaded again
+*
 *   LICENSE: zlib/libpng
 *
 *   Copyright (c) 2017-2023 Victor Fisac (@victorfisac) and Ramon Santamaria (@raysan5)
@@ -92,6 +96,8 @@ void UpdateLightValues(Shader shader, Light light);         // Send light proper
 #if defined(RLIGHTS_IMPLEMENTATION)
 
 #include "raylib.h"
+#include "str8.h"
+#include "uniform.h"
 
 //----------------------------------------------------------------------------------
 // Defines and Macros
@@ -131,11 +137,13 @@ Light CreateLight(int type, Vector3 position, Vector3 target, Color color, Shade
         light.color = color;
 
         // NOTE: Lighting shader naming must be the provided ones
-        light.enabledLoc = GetShaderLocation(shader, TextFormat("lights[%i].enabled", lightsCount));
-        light.typeLoc = GetShaderLocation(shader, TextFormat("lights[%i].type", lightsCount));
-        light.positionLoc = GetShaderLocation(shader, TextFormat("lights[%i].position", lightsCount));
-        light.targetLoc = GetShaderLocation(shader, TextFormat("lights[%i].target", lightsCount));
-        light.colorLoc = GetShaderLocation(shader, TextFormat("lights[%i].color", lightsCount));
+        Arena_Temp scratch = Arena_ScratchBegin();
+        light.enabledLoc = GetShaderLocation(shader, (const char *)Str8_PushF(scratch.arena, "lights[%i].enabled", lightsCount).str);
+        light.typeLoc = GetShaderLocation(shader, (const char *)Str8_PushF(scratch.arena, "lights[%i].type", lightsCount).str);
+        light.positionLoc = GetShaderLocation(shader, (const char *)Str8_PushF(scratch.arena, "lights[%i].position", lightsCount).str);
+        light.targetLoc = GetShaderLocation(shader, (const char *)Str8_PushF(scratch.arena, "lights[%i].target", lightsCount).str);
+        light.colorLoc = GetShaderLocation(shader, (const char *)Str8_PushF(scratch.arena, "lights[%i].color", lightsCount).str);
+        Arena_ScratchEnd(scratch);
 
         UpdateLightValues(shader, light);
 
@@ -150,21 +158,23 @@ Light CreateLight(int type, Vector3 position, Vector3 target, Color color, Shade
 void UpdateLightValues(Shader shader, Light light)
 {
     // Send to shader light enabled state and type
-    SetShaderValue(shader, light.enabledLoc, &light.enabled, SHADER_UNIFORM_INT);
-    SetShaderValue(shader, light.typeLoc, &light.type, SHADER_UNIFORM_INT);
+    // NOTE: enabled is a bool, widen it so the uniform (and its cached copy) read a whole int
+    int enabled = light.enabled;
+    Uniform_Set(shader, light.enabledLoc, &enabled, SHADER_UNIFORM_INT);
+    Uniform_Set(shader, light.typeLoc, &light.type, SHADER_UNIFORM_INT);
 
     // Send to shader light position values
     float position[3] = { light.position.x, light.position.y, light.position.z };
-    SetShaderValue(shader, light.positionLoc, position, SHADER_UNIFORM_VEC3);
+    Uniform_Set(shader, light.positionLoc, position, SHADER_UNIFORM_VEC3);
 
     // Send to shader light target position values
     float target[3] = { light.target.x, light.target.y, light.target.z };
-    SetShaderValue(shader, light.targetLoc, target, SHADER_UNIFORM_VEC3);
+    Uniform_Set(shader, light.targetLoc, target, SHADER_UNIFORM_VEC3);
 
     // Send to shader light color values
     float color[4] = { (float)light.color.r/(float)255, (float)light.color.g/(float)255,
                        (float)light.color.b/(float)255, (float)light.color.a/(float)255 };
-    SetShaderValue(shader, light.colorLoc, color, SHADER_UNIFORM_VEC4);
+    Uniform_Set(shader, light.colorLoc, color, SHADER_UNIFORM_VEC4);
 }
 
 #endif // RLIGHTS_IMPLEMENTATION
@@ -0,0 +1,52 @@
+#ifndef FIDDLE_SHADERCACHE_H
+#define FIDDLE_SHADERCACHE_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Shader program cache and hot reload
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - linked programs are saved with glGetProgramBinary() and linked straight from that on later runs, skipping
+//   the GLSL compiler, the key is a hash of both sources and the GL vendor / renderer / version strings,
+//   so an edit or a driver update just misses and writes a new entry (old ones stay behind, delete the directory)
+// - without program binaries (no raylib sources to get its GL loader from, GL ES, or a driver that reports
+//   no binary formats) programs are compiled from source every time, like LoadShader()
+// - the directories of loaded sources are watched, inotify on linux and a file time poll elsewhere,
+//   an edited program is rebuilt in ShaderCache_Update() once its files have been quiet for a moment
+// - a rebuilt program only replaces the old one if it compiled and linked, it's a new program object so the reload
+//   callback has to move everything holding the old one or its locations over, the old one is unloaded after it
+// - programs are owned by the cache, ShaderCache_Shutdown() unloads them
+
+typedef u32 ShaderCache_Handle;
+
+typedef void (*ShaderCache_ReloadFunc)(Shader previous, Shader current, void *user);
+
+typedef struct ShaderCache_Stats ShaderCache_Stats;
+struct ShaderCache_Stats {
+    u32 programs;
+    u32 cached;                         // linked from a saved binary
+    u32 compiled;                       // compiled from source, a cache miss or no binaries
+    f64 loadSeconds;                    // time spent in ShaderCache_Load()
+    u32 reloads;
+    u32 failedReloads;                  // edits that didn't compile, the previous program stayed
+    b8 binaries;                        // the driver can save programs
+};
+
+// cacheDir is created if it's missing, NULL doesn't cache
+void ShaderCache_Init(const char *cacheDir);
+void ShaderCache_Shutdown(void);
+
+// 0 if the program doesn't build
+ShaderCache_Handle ShaderCache_Load(const char *vsFileName, const char *fsFileName);
+Shader ShaderCache_Get(ShaderCache_Handle handle);
+void ShaderCache_OnReload(ShaderCache_Handle handle, ShaderCache_ReloadFunc func, void *user);
+
+// between frames, rebuilds edited programs and runs their reload callbacks, returns how many were swapped
+u32 ShaderCache_Update(void);
+
+ShaderCache_Stats ShaderCache_GetStats(void);
+
+#endif //FIDDLE_SHADERCACHE_H
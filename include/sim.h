@@ -0,0 +1,89 @@
+#ifndef FIDDLE_SIM_H
+#define FIDDLE_SIM_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Fixed timestep simulation
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - the game state that changes over time (player, overhead camera, coin) advances in ticks of exactly
+//   SIM_TICK_SECONDS, however fast or slow frames are drawn
+// - a frame runs as many ticks as Sim_ClockAdvance() says are due and draws a blend of the last two
+//   states, Sim_Interpolate() with Sim_ClockAlpha(), so motion stays smooth at any frame rate
+// - a tick reads nothing but its Sim_Input, so replaying recorded inputs from the same starting state
+//   reproduces every tick bit for bit (same build, no fast-math flags), Sim_Hash() is there to check
+// - nothing here touches the window or GL, the headless fast-forward is Sim_Step() in a loop
+
+enum Sim_ConstExpr {
+    SIM_TICK_RATE = 60,                 // ticks per second
+    SIM_MAX_TICKS_PER_FRAME = 8,        // a long frame drops time instead of spiralling into ever longer frames
+};
+
+#define SIM_TICK_SECONDS (1.0 / SIM_TICK_RATE)
+
+enum Sim_Button {
+    Sim_Button_Left       = 1 << 0,
+    Sim_Button_Right      = 1 << 1,
+    Sim_Button_Up         = 1 << 2,
+    Sim_Button_Down       = 1 << 3,
+    Sim_Button_RotateCW   = 1 << 4,
+    Sim_Button_RotateCCW  = 1 << 5,
+    Sim_Button_ResetView  = 1 << 6,     // pressed, not held
+};
+
+typedef struct Sim_Input Sim_Input;
+struct Sim_Input {
+    u32 buttons;                        // enum Sim_Button flags
+    f32 zoom;                           // mouse wheel movement since the previous tick
+};
+
+typedef struct Sim_State Sim_State;
+struct Sim_State {
+    u64 tick;
+    Vector2 playerPos;
+    Vector2 playerSpeed;
+    f32 cameraRotation;                 // overhead camera, degrees
+    f32 cameraZoom;
+    f32 coinRotation;                   // degrees around y, kept in [0, 360)
+};
+
+typedef struct Sim_Clock Sim_Clock;
+struct Sim_Clock {
+    f64 accumulator;                    // frame time not yet simulated
+};
+
+// inputs for one tick each, in order, and the state they were recorded from
+typedef struct Sim_Recording Sim_Recording;
+struct Sim_Recording {
+    Sim_State start;
+    Sim_Input *inputs;
+    u32 count;
+    u32 capacity;
+};
+
+Sim_State Sim_InitState(Vector2 playerPos, Vector2 playerSpeed);
+void Sim_Step(Sim_State *state, Sim_Input input);
+
+// blend for drawing, alpha 0 is previous and 1 is current
+Sim_State Sim_Interpolate(const Sim_State *previous, const Sim_State *current, f32 alpha);
+
+// order sensitive hash of every field's exact bits
+u64 Sim_Hash(const Sim_State *state);
+
+// adds a frame's worth of time, returns the number of ticks to run now
+u32 Sim_ClockAdvance(Sim_Clock *clock, f64 frameSeconds);
+f32 Sim_ClockAlpha(const Sim_Clock *clock);
+
+void Sim_RecordingAppend(Sim_Recording *recording, Sim_Input input);
+void Sim_RecordingFree(Sim_Recording *recording);
+b8 Sim_RecordingSave(const Sim_Recording *recording, const char *fileName);
+b8 Sim_RecordingLoad(Sim_Recording *recording, const char *fileName);
+
+// headless, runs ticks back to back as fast as they go, tick i reads input i of the recording
+// (wrapping around, no input at all for an empty one), returns the ticks per second achieved
+f64 Sim_FastForward(Sim_State *state, const Sim_Recording *recording, u64 ticks);
+
+#endif //FIDDLE_SIM_H
@@ -0,0 +1,51 @@
+#ifndef FIDDLE_STR8_H
+#define FIDDLE_STR8_H
+
+#include <stdarg.h>
+
+#include "common.h"
+#include "arena.h"
+
+// ----------------------------------------------------------------------------
+// Length based strings
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - a String8 is a view, pointer + size, it doesn't own its bytes and isn't necessarily null terminated
+// - slicing never copies, anything that produces new bytes takes an arena to put them in
+// - strings pushed onto an arena (copies, formatting) are null terminated, so .str can go straight
+//   to raylib and other C APIs, the terminator isn't counted in .size
+// - use a scratch arena (Arena_ScratchBegin) instead of TextFormat() for short lived strings,
+//   TextFormat() hands out a small ring of static buffers that silently wraps around
+
+typedef struct String8 String8;
+struct String8 {
+    u8 *str;
+    u64 size;
+};
+
+#define Str8Lit(literal) ((String8) { (u8 *) (literal), sizeof(literal) - 1 })
+
+String8 Str8_Make(u8 *str, u64 size);
+String8 Str8_FromCString(const char *cstring);
+
+// slicing, sizes and offsets are clamped to the string
+String8 Str8_Prefix(String8 string, u64 size);
+String8 Str8_Suffix(String8 string, u64 size);
+String8 Str8_Skip(String8 string, u64 amount);
+String8 Str8_Chop(String8 string, u64 amount);
+String8 Str8_Substr(String8 string, u64 first, u64 onePastLast);
+
+b8 Str8_Match(String8 a, String8 b);
+
+// index of the first occurrence of needle at or after start, string.size if there isn't one
+u64 Str8_FindFirst(String8 string, String8 needle, u64 start);
+
+// fast non-cryptographic 64 bit hash, reads 8 bytes at a time, suitable for hash table keys
+u64 Str8_Hash(String8 string, u64 seed);
+
+String8 Str8_PushCopy(Arena *arena, String8 string);
+String8 Str8_PushF(Arena *arena, const char *format, ...);
+String8 Str8_PushFV(Arena *arena, const char *format, va_list args);
+
+#endif //FIDDLE_STR8_H
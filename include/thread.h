@@ -0,0 +1,48 @@
+#ifndef FIDDLE_THREAD_H
+#define FIDDLE_THREAD_H
+
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Threading primitives
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - thin wrapper over win32 / pthreads, C11 <threads.h> isn't available on every toolchain we build with
+// - atomics come straight from <stdatomic.h>
+// - types are opaque-sized blobs so this header doesn't drag in platform headers
+
+typedef struct Thread Thread;
+struct Thread {
+    void *handle;
+};
+
+typedef struct Mutex Mutex;
+struct Mutex {
+    _Alignas(8) u8 storage[64];
+};
+
+typedef struct CondVar CondVar;
+struct CondVar {
+    _Alignas(8) u8 storage[64];
+};
+
+typedef int (*Thread_Func)(void *arg);
+
+b8 Thread_Create(Thread *thread, Thread_Func func, void *arg);
+void Thread_Join(Thread *thread);
+void Thread_Yield(void);
+int Thread_HardwareConcurrency(void);
+
+void Mutex_Init(Mutex *mutex);
+void Mutex_Destroy(Mutex *mutex);
+void Mutex_Lock(Mutex *mutex);
+void Mutex_Unlock(Mutex *mutex);
+
+void CondVar_Init(CondVar *cond);
+void CondVar_Destroy(CondVar *cond);
+void CondVar_Wait(CondVar *cond, Mutex *mutex);
+void CondVar_Signal(CondVar *cond);
+void CondVar_Broadcast(CondVar *cond);
+
+#endif //FIDDLE_THREAD_H
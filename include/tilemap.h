@@ -0,0 +1,82 @@
+#ifndef FIDDLE_TILEMAP_H
+#define FIDDLE_TILEMAP_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Chunked tile maps
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - tiles are u8 values stored in 32x32 chunks, each chunk's tiles are contiguous
+// - every tile value maps to a color through the map's palette, a chunk is drawn as a cached list
+//   of rectangles built by greedily merging runs of same colored tiles, rows first then down
+// - edits only mark their chunk dirty, its rectangles are rebuilt the next time it's in view,
+//   so a freshly filled map costs nothing until it's looked at
+// - TileMap_PrepareView() culls chunks against a Camera2D and rebuilds the dirty visible ones,
+//   it's plain CPU work and runs headless, TileMap_Draw() submits the prepared chunks through rlgl
+//   and has to be called inside BeginMode2D() with the same camera
+// - dirty chunks in view are rebuilt as jobs, spread over the job workers when they're running (see job.h)
+// - overhead cost follows the number of chunks in view, not the size of the map
+
+typedef struct TileMap TileMap;
+
+// tile storage layout, for hot loops that can't afford a TileMap_Get() per tile, see TileMap_Tiles()
+enum TileMap_Layout {
+    TILEMAP_CHUNK_SHIFT = 5,
+    TILEMAP_CHUNK_SIZE = 1 << TILEMAP_CHUNK_SHIFT,      // tiles per chunk side
+    TILEMAP_CHUNK_MASK = TILEMAP_CHUNK_SIZE - 1,
+    TILEMAP_CHUNK_TILES = TILEMAP_CHUNK_SIZE * TILEMAP_CHUNK_SIZE,
+};
+
+typedef struct TileMap_Quad TileMap_Quad;
+struct TileMap_Quad {
+    u8 x, y;                // chunk local tile coordinates
+    u8 width, height;       // in tiles
+    Color color;
+};
+
+typedef struct TileMap_Stats TileMap_Stats;
+struct TileMap_Stats {
+    u32 chunks;
+    u32 chunksVisible;      // chunks overlapping the view in the last TileMap_PrepareView()
+    u32 chunksRebuilt;      // dirty chunks re-meshed by it
+    u32 tilesVisible;
+    u32 quadsVisible;       // rectangles submitted for those tiles
+};
+
+TileMap *TileMap_Create(u32 width, u32 height, f32 tileSize);
+void TileMap_Unload(TileMap *map);
+
+u32 TileMap_Width(const TileMap *map);
+u32 TileMap_Height(const TileMap *map);
+f32 TileMap_TileSize(const TileMap *map);
+
+// out of range reads return 0, out of range writes are ignored
+u8 TileMap_Get(const TileMap *map, i32 x, i32 y);
+void TileMap_Set(TileMap *map, i32 x, i32 y, u8 value);
+void TileMap_Fill(TileMap *map, i32 x, i32 y, i32 width, i32 height, u8 value);
+
+// changes whenever a tile or a palette color does, compare against a copy to tell if the map was edited since
+u32 TileMap_Version(const TileMap *map);
+
+// raw read only tiles, tile (x, y) is at ((y >> SHIFT) * chunksX + (x >> SHIFT)) * CHUNK_TILES
+// + (y & MASK) * CHUNK_SIZE + (x & MASK), partial edge chunks are padded with zeroes
+const u8 *TileMap_Tiles(const TileMap *map);
+
+// every value starts out MAGENTA, changing a color re-meshes the whole map lazily
+void TileMap_SetColor(TileMap *map, u8 value, Color color);
+Color TileMap_GetColor(const TileMap *map, u8 value);
+
+// cull + rebuild for a camera, viewport is the size in pixels of the target being drawn to
+u32 TileMap_PrepareView(TileMap *map, Camera2D camera, Vector2 viewport);
+void TileMap_Draw(const TileMap *map);
+
+// cached rectangles of one chunk, rebuilt first if it's dirty
+u32 TileMap_ChunkCount(const TileMap *map, u32 *chunksX, u32 *chunksY);
+const TileMap_Quad *TileMap_GetChunkQuads(TileMap *map, u32 chunkX, u32 chunkY, u32 *count);
+
+TileMap_Stats TileMap_GetStats(const TileMap *map);
+
+#endif //FIDDLE_TILEMAP_H
@@ -0,0 +1,17 @@
+#ifndef FIDDLE_TIMER_H
+#define FIDDLE_TIMER_H
+
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Monotonic timer
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - unlike raylib's GetTime() this works before InitWindow() and without a window at all,
+//   which the headless benchmarks and worker threads depend on
+// - safe to call from any thread
+
+f64 Timer_Seconds(void);
+
+#endif //FIDDLE_TIMER_H
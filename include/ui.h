@@ -2,10 +2,10 @@
 #define FIDDLE_UI_H
 
 #include <stdbool.h>
+#include "raylib.h"
 #include "common.h"
-
-// TODO - implement...
-typedef struct str {} String8;
+#include "arena.h"
+#include "str8.h"
 
 // ----------------------------------------------------------------------------
 // UI Data Structures
@@ -24,6 +24,7 @@ enum UI_SizeKind {
     UI_SizeKind_ChildrenSum,          // widget size is sum of child widget sizes laid out in order (on a given axis)
 };
 
+typedef struct UI_Size UI_Size;
 struct UI_Size {
     enum UI_SizeKind kind;
     f32 value;                      // the size value for the current kind of sizing
@@ -47,6 +48,8 @@ enum {
     UI_WidgetFlag_Clip            = (1<<6),
     UI_WidgetFlag_HotAnimation    = (1<<7),
     UI_WidgetFlag_ActiveAnimation = (1<<8),
+    UI_WidgetFlag_OverflowX       = (1<<9),     // children may extend past this widget on the given axis,
+    UI_WidgetFlag_OverflowY       = (1<<10),    // violations aren't solved (scrollable containers)
     // ...
 };
 
@@ -57,6 +60,7 @@ enum {
 //   - output size on frame immediately following the autolayout pass, and rendering pass of current frame
 // - struct doubles as cache and immediate-mode data structure
 // - despite being cached as if a 'retained-mode' data struct, the API remains immediate-mode
+typedef struct UI_Widget UI_Widget;
 struct UI_Widget {
     // tree links
     struct UI_Widget *first;
@@ -75,13 +79,14 @@ struct UI_Widget {
 
     // per-frame info provided by builders
     UI_WidgetFlags flags;
-    String8 string;
+    String8 string;                             // display part of the builder's string, in the frame arena
     struct UI_Size semantic_size[Axis2_COUNT];    // widget 'input' (semantic info about layout and sizing)
+    enum Axis2 child_layout_axis;               // children are laid out one after another on this axis
 
     // widget 'output' (computed every frame)
     f32 computed_rel_position[Axis2_COUNT];     // computed position (relative to parent position)
     f32 computed_size[Axis2_COUNT];             // computed size (in pixels)
-//    struct Rect2f rect;                           // final on-screen rectangular coords produced when taking into account computed values and rest of hierarchy
+    Rectangle rect;                             // final on-screen rectangular coords produced when taking into account computed values and rest of hierarchy
 
     // persistent data (for things like transitions)
     f32 hot;
@@ -110,9 +115,59 @@ struct UI_Widget {
 // UI API
 // ----------------------------------------------------------------------------
 
+// NOTES
+// - widgets live in a persistent pool and are found again each frame through a hash table on their key,
+//   widgets not touched during a frame are evicted at the start of the next one
+// - keys hash the full builder string combined with the parent's key, only the part before '##' is displayed,
+//   everything after '###' alone is hashed (so a label can change without losing the widget's state)
+// - widgets built with an empty key string aren't cached, they're allocated from the frame arena
+// - per-frame builder data (display strings, stacks, keyless widgets) comes from a frame arena
+//   that's reset by UI_BeginFrame(), in steady state building a frame doesn't allocate at all
+
+typedef f32 (*UI_MeasureTextFunc)(String8 text, f32 fontSize);
+
+typedef struct UI_Input UI_Input;
+struct UI_Input {
+    Vector2 mouse;
+    b8 mouseDown;
+    b8 mousePressed;
+    b8 mouseReleased;
+};
+
+typedef struct UI_Stats UI_Stats;
+struct UI_Stats {
+    u32 widgets;            // widgets built last frame
+    u32 cached;             // widgets alive in the cache
+    u32 created;            // widgets newly created last frame
+    u32 evicted;            // widgets evicted at the start of the frame
+    u64 frameArenaBytes;    // frame arena high water mark
+};
+
+// measureText can be NULL, which falls back to a fixed advance of half the font size per character
+void UI_Init(UI_MeasureTextFunc measureText, f32 fontSize);
+void UI_Shutdown(void);
+
+// frame bracketing, UI_EndFrame() runs autolayout for everything built in between
+void UI_BeginFrame(Vector2 rootSize, UI_Input input, f32 dt);
+void UI_EndFrame(void);
+void UI_Draw(void);
+
+UI_Widget *UI_Root(void);
+UI_Stats UI_GetStats(void);
+Arena *UI_FrameArena(void);
+
+// semantic size of widgets built while pushed
+void UI_PushPrefSize(enum Axis2 axis, UI_Size size);
+void UI_PopPrefSize(enum Axis2 axis);
+UI_Size UI_SizePx(f32 pixels, f32 strictness);
+UI_Size UI_SizeText(f32 padding, f32 strictness);
+UI_Size UI_SizePct(f32 percent, f32 strictness);
+UI_Size UI_SizeChildrenSum(f32 strictness);
+
 // basic key type helpers
 UI_Key UI_KeyNull(void);
 UI_Key UI_KeyFromString(String8 string);
+UI_Key UI_KeyFromStringSeeded(UI_Key seed, String8 string);
 b8 UI_KeyMatch(UI_Key a, UI_Key b);
 
 // construct a widget, looking up from cache if possible,
@@ -143,26 +198,12 @@ struct UI_Interaction {
 struct UI_Interaction UI_InteractionFromWidget(struct UI_Widget *widget);
 
 
-
-// example implementation for something like a button...
-struct UI_Interaction UI_Button(String8 string) {
-    UI_WidgetFlags flags =
-              UI_WidgetFlag_Clickable
-            | UI_WidgetFlag_DrawBorder
-            | UI_WidgetFlag_DrawText
-            | UI_WidgetFlag_DrawBackground
-            | UI_WidgetFlag_HotAnimation
-            | UI_WidgetFlag_ActiveAnimation
-            ;
-    struct UI_Widget *widget = UI_WidgetMake(flags, string);
-    struct UI_Interaction interaction = UI_InteractionFromWidget(widget);
-    return interaction;
-}
+// basic widgets
+struct UI_Interaction UI_Button(String8 string);
+struct UI_Widget *UI_Label(String8 string);
 // usage example:
-//if (UI_Button("Foo").clicked) {
+//if (UI_Button(Str8Lit("Foo")).clicked) {
 //    // handle button click...
 //}
 
-
-
 #endif //FIDDLE_UI_H
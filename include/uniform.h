@@ -0,0 +1,55 @@
+#ifndef FIDDLE_UNIFORM_H
+#define FIDDLE_UNIFORM_H
+
+#include "raylib.h"
+#include "common.h"
+
+// ----------------------------------------------------------------------------
+// Uniform state cache
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - sits between game code and SetShaderValue(), remembers the last value sent to each (shader, location)
+//   and skips the upload when it hasn't changed, GL keeps uniform values per program so that's safe
+// - only for locations game code owns, raylib sets its own matrices / colDiffuse on every DrawMesh()
+//   behind the cache's back, so those can't go through here
+// - values up to a mat4 are cached, larger arrays always upload (and are counted as such)
+// - the frame block gathers per-frame constants (camera, ambient, ...) that many shaders share:
+//   fields are declared once, shaders attached once, values set whenever, and Uniform_FrameFlush()
+//   uploads only the fields that changed to every attached shader in one go
+// - rlgl has no uniform buffer object api, so the frame block is a CPU side block flushed through the cache
+// - a reloaded shader can come back with the same id, call Uniform_Invalidate() for it
+
+typedef struct Uniform_Stats Uniform_Stats;
+struct Uniform_Stats {
+    u32 uploads;            // SetShaderValue() calls made in the last completed frame
+    u32 skipped;            // redundant uploads dropped in the last completed frame
+    u64 bytesUploaded;
+    u64 bytesSkipped;
+    u32 cached;             // (shader, location) pairs with a remembered value
+};
+
+void Uniform_Init(void);
+void Uniform_Shutdown(void);
+
+// cached replacements for SetShaderValue() / SetShaderValueV() / SetShaderValueMatrix()
+void Uniform_Set(Shader shader, int loc, const void *value, int uniformType);
+void Uniform_SetV(Shader shader, int loc, const void *value, int uniformType, int count);
+void Uniform_SetMatrix(Shader shader, int loc, Matrix mat);
+
+// forget everything remembered for a shader, its next uploads always go through
+void Uniform_Invalidate(Shader shader);
+
+// per-frame constants shared by several shaders, fields are looked up by uniform name in each attached shader
+u32 Uniform_FrameField(const char *name, int uniformType);
+void Uniform_FrameAttach(Shader shader);
+// a shader that's about to be unloaded, eg. replaced by a reload
+void Uniform_FrameDetach(Shader shader);
+void Uniform_FrameSet(u32 field, const void *value);
+void Uniform_FrameFlush(void);
+
+// closes the frame's counters, Uniform_GetStats() reports the frame that just ended
+void Uniform_EndFrame(void);
+Uniform_Stats Uniform_GetStats(void);
+
+#endif //FIDDLE_UNIFORM_H
@@ -0,0 +1,174 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum ArenaConstExpr {
+    ARENA_DEFAULT_ALIGNMENT = 16,
+    ARENA_DEFAULT_BLOCK_SIZE = 64 * 1024,
+};
+
+#if defined(_MSC_VER)
+    #define ARENA_THREAD_LOCAL __declspec(thread)
+#else
+    #define ARENA_THREAD_LOCAL _Thread_local
+#endif
+
+struct Arena_Block {
+    Arena_Block *next;
+    u64 size;
+    u64 used;
+    _Alignas(16) u8 data[];
+};
+
+// NOTE: blocks of a thread's scratch arena are never freed, threads here live as long as the program
+static ARENA_THREAD_LOCAL Arena scratch = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u64 AlignUp(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// offset into the block's data where an allocation would start, or the block size if it doesn't fit
+static u64 FitInBlock(const Arena_Block *block, u64 size, u64 alignment) {
+    u64 start = AlignUp((u64) (uintptr_t) (block->data + block->used), alignment) - (u64) (uintptr_t) block->data;
+    return (start + size <= block->size) ? start : block->size + 1;
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void Arena_Init(Arena *arena, u64 blockSize) {
+    *arena = (Arena) {
+            .blockSize = blockSize ? blockSize : ARENA_DEFAULT_BLOCK_SIZE
+    };
+}
+
+void Arena_Release(Arena *arena) {
+    Arena_Block *block = arena->first;
+    while (block != NULL) {
+        Arena_Block *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->first = NULL;
+    arena->current = NULL;
+}
+
+void Arena_Reset(Arena *arena) {
+    for (Arena_Block *block = arena->first; block != NULL; block = block->next) {
+        block->used = 0;
+    }
+    arena->current = arena->first;
+}
+
+void *Arena_PushAligned(Arena *arena, u64 size, u64 alignment) {
+    void *result = NULL;
+
+    // reuse blocks kept from before the last reset before growing the chain
+    Arena_Block *block = arena->current;
+    while (block != NULL) {
+        u64 start = FitInBlock(block, size, alignment);
+        if (start <= block->size) {
+            result = block->data + start;
+            block->used = start + size;
+            break;
+        }
+        block = block->next;
+        if (block != NULL) block->used = 0;
+    }
+
+    if (result == NULL) {
+        u64 blockSize = arena->blockSize;
+        if (blockSize < size + alignment) blockSize = size + alignment;
+
+        block = malloc(sizeof(Arena_Block) + blockSize);
+        if (block == NULL) return NULL;
+        *block = (Arena_Block) { .size = blockSize };
+
+        // append after the current block, keeping any later (unused) blocks in the chain
+        if (arena->current == NULL) {
+            block->next = arena->first;
+            arena->first = block;
+        } else {
+            Arena_Block *tail = arena->current;
+            while (tail->next != NULL) tail = tail->next;
+            tail->next = block;
+        }
+
+        u64 start = FitInBlock(block, size, alignment);
+        result = block->data + start;
+        block->used = start + size;
+    }
+
+    arena->current = block;
+    return result;
+}
+
+void *Arena_PushNoZero(Arena *arena, u64 size) {
+    return Arena_PushAligned(arena, size, ARENA_DEFAULT_ALIGNMENT);
+}
+
+void *Arena_Push(Arena *arena, u64 size) {
+    void *result = Arena_PushAligned(arena, size, ARENA_DEFAULT_ALIGNMENT);
+    if (result != NULL) memset(result, 0, size);
+    return result;
+}
+
+Arena_Temp Arena_TempBegin(Arena *arena) {
+    return (Arena_Temp) {
+            .arena = arena,
+            .block = arena->current,
+            .used = arena->current ? arena->current->used : 0
+    };
+}
+
+void Arena_TempEnd(Arena_Temp temp) {
+    Arena *arena = temp.arena;
+    if (temp.block == NULL) {
+        Arena_Reset(arena);
+        return;
+    }
+
+    // everything after the marker's block becomes free again
+    for (Arena_Block *block = temp.block->next; block != NULL; block = block->next) {
+        block->used = 0;
+    }
+    temp.block->used = temp.used;
+    arena->current = temp.block;
+}
+
+Arena_Temp Arena_ScratchBegin(void) {
+    if (scratch.blockSize == 0) {
+        Arena_Init(&scratch, ARENA_DEFAULT_BLOCK_SIZE);
+    }
+    return Arena_TempBegin(&scratch);
+}
+
+void Arena_ScratchEnd(Arena_Temp temp) {
+    Arena_TempEnd(temp);
+}
+
+u64 Arena_Used(const Arena *arena) {
+    u64 used = 0;
+    for (Arena_Block *block = arena->first; block != NULL; block = block->next) {
+        used += block->used;
+    }
+    return used;
+}
+
+u64 Arena_Capacity(const Arena *arena) {
+    u64 capacity = 0;
+    for (Arena_Block *block = arena->first; block != NULL; block = block->next) {
+        capacity += block->size;
+    }
+    return capacity;
+}
@@ -0,0 +1,260 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "batch.h"
+#include "lightmap.h"
+#include "quant.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum BatchConstExpr {
+    BATCH_MAX_GROUPS = 1024,                        // max distinct (mesh, material, tint) groups
+    BATCH_HASH_SIZE = BATCH_MAX_GROUPS * 2,         // open addressing table size, must be a power of 2
+    BATCH_INITIAL_CAPACITY = 64,                    // initial instance capacity for a newly created group
+};
+
+struct BatchGroup {
+    // key
+    u32 vaoId;
+    MaterialMap *maps;
+    Color tint;
+
+    // draw data
+    Mesh mesh;
+    Material material;
+
+    // per-frame instance buffer
+    Matrix *transforms;
+    int count;
+    int capacity;
+};
+
+static struct Batch {
+    b8 initialized;
+    b8 enabled;
+    Shader shader;
+
+    struct BatchGroup groups[BATCH_MAX_GROUPS];
+    int groupCount;
+
+    // maps hashed keys to index+1 in groups, 0 means empty slot
+    u16 table[BATCH_HASH_SIZE];
+
+    // groups that received at least one instance this frame, in submission order
+    u16 active[BATCH_MAX_GROUPS];
+    int activeCount;
+
+    u32 boundTexture;   // diffuse texture of the previous draw this frame
+
+    Batch_Stats frame;
+    Batch_Stats last;
+} batch = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u32 HashGroupKey(u32 vaoId, const MaterialMap *maps, Color tint) {
+    // FNV-1a over the key fields
+    u32 hash = 2166136261u;
+    u64 mapsBits = (u64) (uintptr_t) maps;
+    u32 tintBits = (u32) tint.r | ((u32) tint.g << 8) | ((u32) tint.b << 16) | ((u32) tint.a << 24);
+    u32 words[4] = { vaoId, (u32) mapsBits, (u32) (mapsBits >> 32), tintBits };
+    for (int i = 0; i < 4; i++) {
+        hash ^= words[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static b8 ColorMatch(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+static Color ColorTint(Color color, Color tint) {
+    // same tint math as raylib's DrawModelEx()
+    return (Color) {
+            .r = (unsigned char) ((((f32) color.r / 255.0f) * ((f32) tint.r / 255.0f)) * 255.0f),
+            .g = (unsigned char) ((((f32) color.g / 255.0f) * ((f32) tint.g / 255.0f)) * 255.0f),
+            .b = (unsigned char) ((((f32) color.b / 255.0f) * ((f32) tint.b / 255.0f)) * 255.0f),
+            .a = (unsigned char) ((((f32) color.a / 255.0f) * ((f32) tint.a / 255.0f)) * 255.0f),
+    };
+}
+
+static struct BatchGroup *FindOrCreateGroup(Mesh mesh, Material material, Color tint) {
+    u32 hash = HashGroupKey(mesh.vaoId, material.maps, tint);
+    for (u32 probe = 0; probe < BATCH_HASH_SIZE; probe++) {
+        u32 slot = (hash + probe) & (BATCH_HASH_SIZE - 1);
+        u16 entry = batch.table[slot];
+
+        if (entry == 0) {
+            // not found, create a new group in this slot
+            if (batch.groupCount >= BATCH_MAX_GROUPS) {
+                return NULL;
+            }
+
+            struct BatchGroup *group = &batch.groups[batch.groupCount++];
+            *group = (struct BatchGroup) {
+                    .vaoId = mesh.vaoId,
+                    .maps = material.maps,
+                    .tint = tint,
+                    .mesh = mesh,
+                    .material = material,
+                    .transforms = malloc(BATCH_INITIAL_CAPACITY * sizeof(Matrix)),
+                    .count = 0,
+                    .capacity = BATCH_INITIAL_CAPACITY
+            };
+            group->material.shader = batch.shader;
+
+            batch.table[slot] = (u16) batch.groupCount;
+            return group;
+        }
+
+        struct BatchGroup *group = &batch.groups[entry - 1];
+        if (group->vaoId == mesh.vaoId && group->maps == material.maps && ColorMatch(group->tint, tint)) {
+            return group;
+        }
+    }
+    return NULL;
+}
+
+static void CountTextureBind(const Material *material) {
+    u32 texture = material->maps[MATERIAL_MAP_DIFFUSE].texture.id;
+    if (texture != batch.boundTexture) {
+        batch.boundTexture = texture;
+        batch.frame.textureBinds++;
+    }
+}
+
+static void DrawMeshDirect(Mesh mesh, Material material, Matrix transform, Color tint) {
+    MaterialMap *diffuse = &material.maps[MATERIAL_MAP_DIFFUSE];
+    Color color = diffuse->color;
+    diffuse->color = ColorTint(color, tint);
+    DrawMesh(mesh, material, transform);
+    diffuse->color = color;
+    CountTextureBind(&material);
+
+    batch.frame.drawCalls++;
+    batch.frame.instances++;
+    batch.frame.triangles += mesh.triangleCount;
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void Batch_Init(Shader instancingShader) {
+    memset(&batch, 0, sizeof(batch));
+    batch.initialized = true;
+    batch.enabled = true;
+    batch.shader = instancingShader;
+}
+
+void Batch_Unload(void) {
+    for (int i = 0; i < batch.groupCount; i++) {
+        free(batch.groups[i].transforms);
+    }
+    memset(&batch, 0, sizeof(batch));
+}
+
+void Batch_SetShader(Shader instancingShader) {
+    batch.shader = instancingShader;
+    for (int i = 0; i < batch.groupCount; i++) {
+        batch.groups[i].material.shader = instancingShader;
+    }
+}
+
+void Batch_SetEnabled(b8 enabled) {
+    batch.enabled = enabled;
+}
+
+b8 Batch_IsEnabled(void) {
+    return batch.enabled;
+}
+
+void Batch_Begin(void) {
+    batch.frame = (Batch_Stats) {0};
+    batch.activeCount = 0;
+    batch.boundTexture = 0;
+}
+
+void Batch_End(void) {
+    for (int i = 0; i < batch.activeCount; i++) {
+        struct BatchGroup *group = &batch.groups[batch.active[i]];
+
+        MaterialMap *diffuse = &group->material.maps[MATERIAL_MAP_DIFFUSE];
+        Color color = diffuse->color;
+        diffuse->color = ColorTint(color, group->tint);
+        DrawMeshInstanced(group->mesh, group->material, group->transforms, group->count);
+        diffuse->color = color;
+        CountTextureBind(&group->material);
+
+        batch.frame.drawCalls++;
+        batch.frame.instances += group->count;
+        batch.frame.batches++;
+        batch.frame.triangles += group->mesh.triangleCount * group->count;
+
+        group->count = 0;
+    }
+    batch.activeCount = 0;
+
+    batch.last = batch.frame;
+}
+
+void Batch_AddMesh(Mesh mesh, Material material, Matrix transform, Color tint) {
+    // compact meshes store positions relative to their bounds, the decode goes in front of the model transform
+    Matrix decode;
+    if (Quant_GetDecode(mesh, &decode)) {
+        transform = MatrixMultiply(decode, transform);
+    }
+
+    // lightmapped meshes are each a box of their own, there's nothing to instance and they keep their shader
+    b8 lightmapped = material.maps[LIGHTMAP_MATERIAL_MAP].texture.id != 0;
+    if (!batch.initialized || !batch.enabled || mesh.vaoId == 0 || lightmapped) {
+        DrawMeshDirect(mesh, material, transform, tint);
+        return;
+    }
+
+    struct BatchGroup *group = FindOrCreateGroup(mesh, material, tint);
+    if (group == NULL) {
+        // out of group slots, fall back to an immediate draw rather than dropping it
+        DrawMeshDirect(mesh, material, transform, tint);
+        return;
+    }
+
+    if (group->count == group->capacity) {
+        int capacity = group->capacity * 2;
+        Matrix *transforms = realloc(group->transforms, capacity * sizeof(Matrix));
+        if (transforms == NULL) {
+            DrawMeshDirect(mesh, material, transform, tint);
+            return;
+        }
+        group->transforms = transforms;
+        group->capacity = capacity;
+    }
+
+    if (group->count == 0) {
+        batch.active[batch.activeCount++] = (u16) (group - batch.groups);
+    }
+    group->transforms[group->count++] = transform;
+}
+
+void Batch_AddModel(Model model, Vector3 position, f32 scale, Color tint) {
+    // same transform composition as raylib's DrawModel() -> DrawModelEx()
+    Matrix matScale = MatrixScale(scale, scale, scale);
+    Matrix matTranslation = MatrixTranslate(position.x, position.y, position.z);
+    Matrix matTransform = MatrixMultiply(model.transform, MatrixMultiply(matScale, matTranslation));
+
+    for (int i = 0; i < model.meshCount; i++) {
+        Batch_AddMesh(model.meshes[i], model.materials[model.meshMaterial[i]], matTransform, tint);
+    }
+}
+
+Batch_Stats Batch_GetStats(void) {
+    return batch.last;
+}
@@ -0,0 +1,565 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include "cluster.h"
+#include "uniform.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CLUSTER_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum ClusterConstExpr {
+    CLUSTER_TILES_X = 16,
+    CLUSTER_TILES_Y = 9,
+    CLUSTER_SLICES = 24,
+    CLUSTER_COUNT = CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES,
+    CLUSTER_LANES = 4,                          // SoA arrays are padded so a 4-wide load never runs off the end
+    CLUSTER_MAX_INDICES = 128 * 1024,           // (cluster, light) pairs per frame
+    CLUSTER_TEXTURE_WIDTH = 1024,               // every cluster texture is this wide, GL 3.3's minimum max size
+    CLUSTER_GRID_ROWS = (CLUSTER_COUNT + CLUSTER_TEXTURE_WIDTH - 1) / CLUSTER_TEXTURE_WIDTH,
+    CLUSTER_TEXTURE_UNIT_LIGHTS = 13,           // past the MAX_MATERIAL_MAPS units DrawMesh() binds, GL 3.3 guarantees 16
+    CLUSTER_TEXTURE_UNIT_GRID = 14,
+    CLUSTER_TEXTURE_UNIT_INDICES = 15,
+    CLUSTER_MAX_SHADERS = 4,
+};
+
+static const f32 CLUSTER_Z_NEAR = 0.1f;
+static const f32 CLUSTER_Z_FAR = 200.0f;
+
+struct ClusterShader {
+    u32 id;
+    int viewDirLoc;
+    int gridLoc;            // tiles x, tiles y, slices, texture width
+    int depthLoc;           // slice = log(depth) * scale - bias
+    int viewportLoc;
+};
+
+struct ClusterPair {
+    u32 cluster;
+    u32 light;
+};
+
+static struct Cluster {
+    b8 initialized;
+
+    // lights, SoA for the view space transform
+    u32 maxLights;
+    u32 lightCount;
+    f32 *posX, *posY, *posZ, *radius;
+    b8 *baked;
+    f32 *viewX, *viewY, *viewZ;
+    f32 *lightTexels;           // 2 RGBA texels per light: world position + radius, color * intensity
+    b8 lightsDirty;
+
+    // view space cluster bounds, SoA, rebuilt when the projection changes
+    f32 minX[CLUSTER_COUNT + CLUSTER_LANES], minY[CLUSTER_COUNT + CLUSTER_LANES], minZ[CLUSTER_COUNT + CLUSTER_LANES];
+    f32 maxX[CLUSTER_COUNT + CLUSTER_LANES], maxY[CLUSTER_COUNT + CLUSTER_LANES], maxZ[CLUSTER_COUNT + CLUSTER_LANES];
+    f32 sliceDepth[CLUSTER_SLICES + 1];
+    f32 tanHalfFovY;
+    f32 aspect;
+
+    // binning output
+    u32 counts[CLUSTER_COUNT];
+    u32 bakedCounts[CLUSTER_COUNT];
+    struct ClusterPair *pairs;
+    // RGBA per cluster: first index, light count, baked light count, whole rows like the other texel arrays,
+    // the tail past the last cluster stays zero
+    f32 gridTexels[CLUSTER_GRID_ROWS * CLUSTER_TEXTURE_WIDTH * 4];
+    f32 *indexTexels;                       // one R texel per index
+    u32 indexCount;
+
+    // gpu side
+    Texture2D lightTexture;
+    Texture2D gridTexture;
+    Texture2D indexTexture;
+    struct ClusterShader shaders[CLUSTER_MAX_SHADERS];
+    int shaderCount;
+
+    Cluster_Stats stats;
+} cluster = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u32 Rows(u32 texels) {
+    return (texels + CLUSTER_TEXTURE_WIDTH - 1) / CLUSTER_TEXTURE_WIDTH;
+}
+
+static u32 ClusterIndex(int tileX, int tileY, int slice) {
+    return ((u32) slice * CLUSTER_TILES_Y + (u32) tileY) * CLUSTER_TILES_X + (u32) tileX;
+}
+
+static f32 DepthScale(void) {
+    return (f32) CLUSTER_SLICES / logf(CLUSTER_Z_FAR / CLUSTER_Z_NEAR);
+}
+
+static int SliceFromDepth(f32 depth) {
+    if (depth <= CLUSTER_Z_NEAR) return 0;
+    int slice = (int) (logf(depth / CLUSTER_Z_NEAR) * DepthScale());
+    return (slice < CLUSTER_SLICES) ? slice : CLUSTER_SLICES - 1;
+}
+
+static int TileFromNdc(f32 ndc, int tiles) {
+    int tile = (int) floorf((ndc * 0.5f + 0.5f) * (f32) tiles);
+    if (tile < 0) return 0;
+    return (tile < tiles) ? tile : tiles - 1;
+}
+
+static void BuildClusterBounds(f32 tanHalfFovY, f32 aspect) {
+    cluster.tanHalfFovY = tanHalfFovY;
+    cluster.aspect = aspect;
+
+    for (int slice = 0; slice <= CLUSTER_SLICES; slice++) {
+        cluster.sliceDepth[slice] = CLUSTER_Z_NEAR * powf(CLUSTER_Z_FAR / CLUSTER_Z_NEAR, (f32) slice / (f32) CLUSTER_SLICES);
+    }
+
+    f32 tanHalfFovX = tanHalfFovY * aspect;
+    for (int slice = 0; slice < CLUSTER_SLICES; slice++) {
+        f32 nearDepth = cluster.sliceDepth[slice];
+        f32 farDepth = cluster.sliceDepth[slice + 1];
+
+        for (int tileY = 0; tileY < CLUSTER_TILES_Y; tileY++) {
+            f32 y0 = (-1.0f + 2.0f * (f32) tileY / CLUSTER_TILES_Y) * tanHalfFovY;
+            f32 y1 = (-1.0f + 2.0f * (f32) (tileY + 1) / CLUSTER_TILES_Y) * tanHalfFovY;
+
+            for (int tileX = 0; tileX < CLUSTER_TILES_X; tileX++) {
+                f32 x0 = (-1.0f + 2.0f * (f32) tileX / CLUSTER_TILES_X) * tanHalfFovX;
+                f32 x1 = (-1.0f + 2.0f * (f32) (tileX + 1) / CLUSTER_TILES_X) * tanHalfFovX;
+
+                // the tile's four corner rays at both slice depths, the box around those 8 points
+                u32 index = ClusterIndex(tileX, tileY, slice);
+                cluster.minX[index] = fminf(x0 * nearDepth, x0 * farDepth);
+                cluster.maxX[index] = fmaxf(x1 * nearDepth, x1 * farDepth);
+                cluster.minY[index] = fminf(y0 * nearDepth, y0 * farDepth);
+                cluster.maxY[index] = fmaxf(y1 * nearDepth, y1 * farDepth);
+                cluster.minZ[index] = -farDepth;
+                cluster.maxZ[index] = -nearDepth;
+            }
+        }
+    }
+}
+
+static void TransformLights(Matrix view) {
+#if defined(CLUSTER_USE_SSE)
+    __m128 m0 = _mm_set1_ps(view.m0), m4 = _mm_set1_ps(view.m4), m8 = _mm_set1_ps(view.m8), m12 = _mm_set1_ps(view.m12);
+    __m128 m1 = _mm_set1_ps(view.m1), m5 = _mm_set1_ps(view.m5), m9 = _mm_set1_ps(view.m9), m13 = _mm_set1_ps(view.m13);
+    __m128 m2 = _mm_set1_ps(view.m2), m6 = _mm_set1_ps(view.m6), m10 = _mm_set1_ps(view.m10), m14 = _mm_set1_ps(view.m14);
+
+    // arrays are padded to a multiple of 4, the extra lanes are never read back
+    for (u32 i = 0; i < cluster.lightCount; i += CLUSTER_LANES) {
+        __m128 x = _mm_loadu_ps(cluster.posX + i);
+        __m128 y = _mm_loadu_ps(cluster.posY + i);
+        __m128 z = _mm_loadu_ps(cluster.posZ + i);
+        _mm_storeu_ps(cluster.viewX + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_add_ps(_mm_mul_ps(m8, z), m12)));
+        _mm_storeu_ps(cluster.viewY + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_add_ps(_mm_mul_ps(m9, z), m13)));
+        _mm_storeu_ps(cluster.viewZ + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_add_ps(_mm_mul_ps(m10, z), m14)));
+    }
+#else
+    for (u32 i = 0; i < cluster.lightCount; i++) {
+        Vector3 position = Vector3Transform((Vector3) { cluster.posX[i], cluster.posY[i], cluster.posZ[i] }, view);
+        cluster.viewX[i] = position.x;
+        cluster.viewY[i] = position.y;
+        cluster.viewZ[i] = position.z;
+    }
+#endif
+}
+
+// bitmask of the 4 clusters starting at 'first' that the sphere touches
+static int TestSphere4(u32 first, f32 x, f32 y, f32 z, f32 radiusSq) {
+#if defined(CLUSTER_USE_SSE)
+    __m128 zero = _mm_setzero_ps();
+    __m128 px = _mm_set1_ps(x), py = _mm_set1_ps(y), pz = _mm_set1_ps(z);
+
+    // distance from the center to the box on each axis, 0 when inside the slab
+    __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(cluster.minX + first), px), zero),
+                           _mm_max_ps(_mm_sub_ps(px, _mm_loadu_ps(cluster.maxX + first)), zero));
+    __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(cluster.minY + first), py), zero),
+                           _mm_max_ps(_mm_sub_ps(py, _mm_loadu_ps(cluster.maxY + first)), zero));
+    __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(cluster.minZ + first), pz), zero),
+                           _mm_max_ps(_mm_sub_ps(pz, _mm_loadu_ps(cluster.maxZ + first)), zero));
+    __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+    return _mm_movemask_ps(_mm_cmple_ps(distSq, _mm_set1_ps(radiusSq)));
+#else
+    int mask = 0;
+    for (int lane = 0; lane < CLUSTER_LANES; lane++) {
+        u32 i = first + (u32) lane;
+        f32 dx = fmaxf(cluster.minX[i] - x, 0) + fmaxf(x - cluster.maxX[i], 0);
+        f32 dy = fmaxf(cluster.minY[i] - y, 0) + fmaxf(y - cluster.maxY[i], 0);
+        f32 dz = fmaxf(cluster.minZ[i] - z, 0) + fmaxf(z - cluster.maxZ[i], 0);
+        if (dx * dx + dy * dy + dz * dz <= radiusSq) mask |= 1 << lane;
+    }
+    return mask;
+#endif
+}
+
+// screen tile range covered by a view space box, false when it's off screen
+static b8 TileRange(f32 v0, f32 v1, f32 nearDepth, f32 farDepth, f32 tanHalfFov, int tiles, int *first, int *last) {
+    // most extreme projections of the box's edges over its depth range
+    f32 ndcMin = ((v0 >= 0) ? v0 / farDepth : v0 / nearDepth) / tanHalfFov;
+    f32 ndcMax = ((v1 >= 0) ? v1 / nearDepth : v1 / farDepth) / tanHalfFov;
+    if (ndcMax < -1.0f || ndcMin > 1.0f) return false;
+
+    *first = TileFromNdc(ndcMin, tiles);
+    *last = TileFromNdc(ndcMax, tiles);
+    return true;
+}
+
+static void UploadTextures(void) {
+    if (cluster.lightTexture.id == 0) {
+        Image lights = {
+                .data = cluster.lightTexels,
+                .width = CLUSTER_TEXTURE_WIDTH,
+                .height = (int) Rows(cluster.maxLights * 2),
+                .mipmaps = 1,
+                .format = PIXELFORMAT_UNCOMPRESSED_R32G32B32A32
+        };
+        Image grid = {
+                .data = cluster.gridTexels,
+                .width = CLUSTER_TEXTURE_WIDTH,
+                .height = CLUSTER_GRID_ROWS,
+                .mipmaps = 1,
+                .format = PIXELFORMAT_UNCOMPRESSED_R32G32B32A32
+        };
+        Image indices = {
+                .data = cluster.indexTexels,
+                .width = CLUSTER_TEXTURE_WIDTH,
+                .height = (int) Rows(CLUSTER_MAX_INDICES),
+                .mipmaps = 1,
+                .format = PIXELFORMAT_UNCOMPRESSED_R32
+        };
+        cluster.lightTexture = LoadTextureFromImage(lights);
+        cluster.gridTexture = LoadTextureFromImage(grid);
+        cluster.indexTexture = LoadTextureFromImage(indices);
+        cluster.lightsDirty = false;
+        return;
+    }
+
+    // only the rows in use, the index list is usually a small part of its texture
+    if (cluster.lightsDirty && cluster.lightCount > 0) {
+        rlUpdateTexture(cluster.lightTexture.id, 0, 0, CLUSTER_TEXTURE_WIDTH, (int) Rows(cluster.lightCount * 2),
+                        PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, cluster.lightTexels);
+        cluster.lightsDirty = false;
+    }
+    rlUpdateTexture(cluster.gridTexture.id, 0, 0, CLUSTER_TEXTURE_WIDTH, CLUSTER_GRID_ROWS,
+                    PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, cluster.gridTexels);
+    if (cluster.indexCount > 0) {
+        rlUpdateTexture(cluster.indexTexture.id, 0, 0, CLUSTER_TEXTURE_WIDTH, (int) Rows(cluster.indexCount),
+                        PIXELFORMAT_UNCOMPRESSED_R32, cluster.indexTexels);
+    }
+}
+
+static void *AllocPadded(u32 count, u64 size) {
+    // rounded up to whole SIMD lanes, zeroed so the padding lanes hold finite values
+    u64 padded = ((u64) count + CLUSTER_LANES - 1) / CLUSTER_LANES * CLUSTER_LANES;
+    return calloc(padded ? padded : CLUSTER_LANES, size);
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void Cluster_Init(u32 maxLights) {
+    if (cluster.initialized) Cluster_Unload();
+
+    cluster.maxLights = maxLights;
+    cluster.posX = AllocPadded(maxLights, sizeof(f32));
+    cluster.posY = AllocPadded(maxLights, sizeof(f32));
+    cluster.posZ = AllocPadded(maxLights, sizeof(f32));
+    cluster.radius = AllocPadded(maxLights, sizeof(f32));
+    cluster.baked = AllocPadded(maxLights, sizeof(b8));
+    cluster.viewX = AllocPadded(maxLights, sizeof(f32));
+    cluster.viewY = AllocPadded(maxLights, sizeof(f32));
+    cluster.viewZ = AllocPadded(maxLights, sizeof(f32));
+
+    // texel storage covers whole rows, the textures are created from these arrays
+    cluster.lightTexels = calloc((u64) Rows(maxLights * 2) * CLUSTER_TEXTURE_WIDTH * 4, sizeof(f32));
+    cluster.indexTexels = calloc((u64) Rows(CLUSTER_MAX_INDICES) * CLUSTER_TEXTURE_WIDTH, sizeof(f32));
+    cluster.pairs = malloc(CLUSTER_MAX_INDICES * sizeof(struct ClusterPair));
+
+    cluster.stats = (Cluster_Stats) { .clusters = CLUSTER_COUNT };
+    cluster.initialized = true;
+}
+
+void Cluster_Unload(void) {
+    if (cluster.lightTexture.id != 0) UnloadTexture(cluster.lightTexture);
+    if (cluster.gridTexture.id != 0) UnloadTexture(cluster.gridTexture);
+    if (cluster.indexTexture.id != 0) UnloadTexture(cluster.indexTexture);
+
+    free(cluster.posX);
+    free(cluster.posY);
+    free(cluster.posZ);
+    free(cluster.radius);
+    free(cluster.baked);
+    free(cluster.viewX);
+    free(cluster.viewY);
+    free(cluster.viewZ);
+    free(cluster.lightTexels);
+    free(cluster.indexTexels);
+    free(cluster.pairs);
+
+    memset(&cluster, 0, sizeof(cluster));
+}
+
+u32 Cluster_AddLight(Cluster_Light light) {
+    if (cluster.lightCount >= cluster.maxLights) {
+        TraceLog(LOG_WARNING, "CLUSTER: Light limit (%u) reached, light dropped", cluster.maxLights);
+        return CLUSTER_NO_LIGHT;
+    }
+
+    u32 index = cluster.lightCount++;
+    Cluster_SetLight(index, light);
+    return index;
+}
+
+void Cluster_SetLight(u32 index, Cluster_Light light) {
+    if (index >= cluster.lightCount) return;
+
+    cluster.posX[index] = light.position.x;
+    cluster.posY[index] = light.position.y;
+    cluster.posZ[index] = light.position.z;
+    cluster.radius[index] = light.radius;
+    cluster.baked[index] = light.baked;
+
+    f32 *texels = cluster.lightTexels + (u64) index * 8;
+    texels[0] = light.position.x;
+    texels[1] = light.position.y;
+    texels[2] = light.position.z;
+    texels[3] = light.radius;
+    texels[4] = (f32) light.color.r / 255.0f * light.intensity;
+    texels[5] = (f32) light.color.g / 255.0f * light.intensity;
+    texels[6] = (f32) light.color.b / 255.0f * light.intensity;
+    texels[7] = light.intensity;
+    cluster.lightsDirty = true;
+}
+
+Cluster_Light Cluster_GetLight(u32 index) {
+    if (index >= cluster.lightCount) return (Cluster_Light) {0};
+
+    const f32 *texels = cluster.lightTexels + (u64) index * 8;
+    f32 intensity = texels[7];
+    f32 scale = (intensity > 0) ? 255.0f / intensity : 0;
+    return (Cluster_Light) {
+            .position = { texels[0], texels[1], texels[2] },
+            .radius = texels[3],
+            .color = { (u8) (texels[4] * scale + 0.5f), (u8) (texels[5] * scale + 0.5f), (u8) (texels[6] * scale + 0.5f), 255 },
+            .intensity = intensity,
+            .baked = cluster.baked[index]
+    };
+}
+
+u32 Cluster_LightCount(void) {
+    return cluster.lightCount;
+}
+
+void Cluster_ClearLights(void) {
+    cluster.lightCount = 0;
+    cluster.lightsDirty = true;
+}
+
+void Cluster_BinLights(Camera3D camera, f32 aspect) {
+    if (!cluster.initialized) return;
+
+    f32 tanHalfFovY = tanf(camera.fovy * 0.5f * DEG2RAD);
+    if (tanHalfFovY != cluster.tanHalfFovY || aspect != cluster.aspect) {
+        BuildClusterBounds(tanHalfFovY, aspect);
+    }
+
+    TransformLights(MatrixLookAt(camera.position, camera.target, camera.up));
+    memset(cluster.counts, 0, sizeof(cluster.counts));
+    memset(cluster.bakedCounts, 0, sizeof(cluster.bakedCounts));
+
+    Cluster_Stats stats = { .lights = cluster.lightCount, .clusters = CLUSTER_COUNT };
+    u32 pairCount = 0;
+    f32 tanHalfFovX = tanHalfFovY * aspect;
+
+    for (u32 light = 0; light < cluster.lightCount; light++) {
+        f32 x = cluster.viewX[light];
+        f32 y = cluster.viewY[light];
+        f32 z = cluster.viewZ[light];
+        f32 radius = cluster.radius[light];
+        f32 depth = -z;
+
+        if (depth + radius < CLUSTER_Z_NEAR || depth - radius > CLUSTER_Z_FAR) continue;
+
+        // conservative cluster range from the sphere's view space box, the SIMD test does the exact work
+        f32 nearDepth = fmaxf(depth - radius, CLUSTER_Z_NEAR);
+        f32 farDepth = depth + radius;
+        int tileX0, tileX1, tileY0, tileY1;
+        if (!TileRange(x - radius, x + radius, nearDepth, farDepth, tanHalfFovX, CLUSTER_TILES_X, &tileX0, &tileX1)) continue;
+        if (!TileRange(y - radius, y + radius, nearDepth, farDepth, tanHalfFovY, CLUSTER_TILES_Y, &tileY0, &tileY1)) continue;
+        int slice0 = SliceFromDepth(nearDepth);
+        int slice1 = SliceFromDepth(farDepth);
+
+        f32 radiusSq = radius * radius;
+        b8 baked = cluster.baked[light];
+        b8 binned = false;
+        for (int slice = slice0; slice <= slice1; slice++) {
+            for (int tileY = tileY0; tileY <= tileY1; tileY++) {
+                u32 row = ClusterIndex(0, tileY, slice);
+                for (int tileX = tileX0; tileX <= tileX1; tileX += CLUSTER_LANES) {
+                    int mask = TestSphere4(row + (u32) tileX, x, y, z, radiusSq);
+                    stats.clustersTested += CLUSTER_LANES;
+
+                    // lanes past the end of the range belong to tiles (or rows) the light wasn't meant to test
+                    int lanes = tileX1 - tileX + 1;
+                    if (lanes < CLUSTER_LANES) mask &= (1 << lanes) - 1;
+
+                    for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+                        if ((mask & 1) == 0) continue;
+
+                        u32 index = row + (u32) (tileX + lane);
+                        if (pairCount >= CLUSTER_MAX_INDICES) {
+                            stats.indicesDropped++;
+                            continue;
+                        }
+                        cluster.pairs[pairCount++] = (struct ClusterPair) { index, light };
+                        cluster.counts[index]++;
+                        cluster.bakedCounts[index] += baked;
+                        binned = true;
+                    }
+                }
+            }
+        }
+        stats.lightsBinned += binned;
+    }
+
+    // counting sort of the pairs into one contiguous light list per cluster, baked lights ahead of the live ones,
+    // from here on counts and bakedCounts are where the next live and baked light of each cluster go
+    u32 offset = 0;
+    for (u32 i = 0; i < CLUSTER_COUNT; i++) {
+        u32 count = cluster.counts[i];
+        u32 bakedCount = cluster.bakedCounts[i];
+        cluster.gridTexels[i * 4 + 0] = (f32) offset;
+        cluster.gridTexels[i * 4 + 1] = (f32) count;
+        cluster.gridTexels[i * 4 + 2] = (f32) bakedCount;
+        cluster.bakedCounts[i] = offset;
+        cluster.counts[i] = offset + bakedCount;
+        offset += count;
+
+        stats.clustersLit += (count > 0);
+        stats.indicesBaked += bakedCount;
+        if (count > stats.maxClusterLights) stats.maxClusterLights = count;
+    }
+    for (u32 i = 0; i < pairCount; i++) {
+        struct ClusterPair pair = cluster.pairs[i];
+        u32 *next = cluster.baked[pair.light] ? &cluster.bakedCounts[pair.cluster] : &cluster.counts[pair.cluster];
+        cluster.indexTexels[(*next)++] = (f32) pair.light;
+    }
+
+    cluster.indexCount = pairCount;
+    stats.indices = pairCount;
+    cluster.stats = stats;
+}
+
+u32 Cluster_ClusterCount(void) {
+    return CLUSTER_COUNT;
+}
+
+BoundingBox Cluster_GetClusterBounds(u32 index) {
+    if (index >= CLUSTER_COUNT) return (BoundingBox) {0};
+    return (BoundingBox) {
+            { cluster.minX[index], cluster.minY[index], cluster.minZ[index] },
+            { cluster.maxX[index], cluster.maxY[index], cluster.maxZ[index] }
+    };
+}
+
+u32 Cluster_GetClusterLights(u32 index, u32 *lights, u32 maxLights) {
+    if (index >= CLUSTER_COUNT) return 0;
+
+    u32 first = (u32) cluster.gridTexels[index * 4 + 0];
+    u32 count = (u32) cluster.gridTexels[index * 4 + 1];
+    for (u32 i = 0; i < count && i < maxLights; i++) {
+        lights[i] = (u32) cluster.indexTexels[first + i];
+    }
+    return count;
+}
+
+u32 Cluster_ClusterAt(Vector2 ndc, f32 viewDepth) {
+    return ClusterIndex(TileFromNdc(ndc.x, CLUSTER_TILES_X), TileFromNdc(ndc.y, CLUSTER_TILES_Y), SliceFromDepth(viewDepth));
+}
+
+void Cluster_BindShader(Shader shader) {
+    if (cluster.shaderCount >= CLUSTER_MAX_SHADERS) {
+        TraceLog(LOG_WARNING, "CLUSTER: Shader limit (%i) reached", CLUSTER_MAX_SHADERS);
+        return;
+    }
+
+    struct ClusterShader *bound = &cluster.shaders[cluster.shaderCount++];
+    *bound = (struct ClusterShader) {
+            .id = shader.id,
+            .viewDirLoc = GetShaderLocation(shader, "clusterViewDir"),
+            .gridLoc = GetShaderLocation(shader, "clusterGrid"),
+            .depthLoc = GetShaderLocation(shader, "clusterDepth"),
+            .viewportLoc = GetShaderLocation(shader, "clusterViewport")
+    };
+
+    // samplers never change units, set them once
+    int units[3] = { CLUSTER_TEXTURE_UNIT_LIGHTS, CLUSTER_TEXTURE_UNIT_GRID, CLUSTER_TEXTURE_UNIT_INDICES };
+    Uniform_Set(shader, GetShaderLocation(shader, "clusterLights"), &units[0], SHADER_UNIFORM_INT);
+    Uniform_Set(shader, GetShaderLocation(shader, "clusterOffsets"), &units[1], SHADER_UNIFORM_INT);
+    Uniform_Set(shader, GetShaderLocation(shader, "clusterIndices"), &units[2], SHADER_UNIFORM_INT);
+
+    f32 grid[4] = { CLUSTER_TILES_X, CLUSTER_TILES_Y, CLUSTER_SLICES, CLUSTER_TEXTURE_WIDTH };
+    f32 depth[2] = { DepthScale(), logf(CLUSTER_Z_NEAR) * DepthScale() };
+    Uniform_Set(shader, bound->gridLoc, grid, SHADER_UNIFORM_VEC4);
+    Uniform_Set(shader, bound->depthLoc, depth, SHADER_UNIFORM_VEC2);
+}
+
+void Cluster_UnbindShader(Shader shader) {
+    for (int i = 0; i < cluster.shaderCount; i++) {
+        if (cluster.shaders[i].id == shader.id) {
+            cluster.shaders[i] = cluster.shaders[--cluster.shaderCount];
+            return;
+        }
+    }
+}
+
+void Cluster_BeginDraw(Camera3D camera, Vector2 viewport) {
+    if (!cluster.initialized) return;
+
+    UploadTextures();
+
+    Vector3 viewDir = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    for (int i = 0; i < cluster.shaderCount; i++) {
+        struct ClusterShader *bound = &cluster.shaders[i];
+        Shader shader = { .id = bound->id };
+        // unchanged while the camera only moves, the uniform cache drops those
+        Uniform_Set(shader, bound->viewDirLoc, &viewDir, SHADER_UNIFORM_VEC3);
+        Uniform_Set(shader, bound->viewportLoc, &viewport, SHADER_UNIFORM_VEC2);
+    }
+
+    rlActiveTextureSlot(CLUSTER_TEXTURE_UNIT_LIGHTS);
+    rlEnableTexture(cluster.lightTexture.id);
+    rlActiveTextureSlot(CLUSTER_TEXTURE_UNIT_GRID);
+    rlEnableTexture(cluster.gridTexture.id);
+    rlActiveTextureSlot(CLUSTER_TEXTURE_UNIT_INDICES);
+    rlEnableTexture(cluster.indexTexture.id);
+    rlActiveTextureSlot(0);
+}
+
+void Cluster_EndDraw(void) {
+    if (!cluster.initialized) return;
+
+    rlActiveTextureSlot(CLUSTER_TEXTURE_UNIT_LIGHTS);
+    rlDisableTexture();
+    rlActiveTextureSlot(CLUSTER_TEXTURE_UNIT_GRID);
+    rlDisableTexture();
+    rlActiveTextureSlot(CLUSTER_TEXTURE_UNIT_INDICES);
+    rlDisableTexture();
+    rlActiveTextureSlot(0);
+}
+
+Cluster_Stats Cluster_GetStats(void) {
+    return cluster.stats;
+}
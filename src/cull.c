@@ -0,0 +1,493 @@
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include "cull.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CULL_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum CullConstExpr {
+    CULL_BVH_WIDTH = 4,                 // children per node, matches the SIMD lane count
+    CULL_BVH_STACK_SIZE = 256,          // traversal stack, plenty for log4(n) depth with 4 pushes per level
+    CULL_ALL_PLANES = (1 << Cull_FrustumPlane_COUNT) - 1,
+};
+
+struct BVHNode {
+    // child bounds, SoA so that all 4 children are tested against a plane at once
+    f32 minX[CULL_BVH_WIDTH];
+    f32 minY[CULL_BVH_WIDTH];
+    f32 minZ[CULL_BVH_WIDTH];
+    f32 maxX[CULL_BVH_WIDTH];
+    f32 maxY[CULL_BVH_WIDTH];
+    f32 maxZ[CULL_BVH_WIDTH];
+
+    // node index for interior children, object index for leaf children (see leafMask)
+    u32 child[CULL_BVH_WIDTH];
+
+    i32 parent;
+    u8 parentSlot;
+    u8 validMask;
+    u8 leafMask;
+};
+
+struct Cull_BVH {
+    struct BVHNode *nodes;
+    u8 *dirty;          // per node refit flags, kept apart from the nodes so the refit sweep stays cache friendly
+    u32 nodeCount;
+    u32 nodeCapacity;
+
+    // where each object's bounds live in the tree, for refitting
+    u32 objectCount;
+    u32 *objectNode;
+    u8 *objectSlot;
+};
+
+struct BVHBuildContext {
+    u32 *indices;
+    Vector3 *centroids;
+    const BoundingBox *boxes;
+};
+
+// ----------------------------------------------------------------------------
+// Frustum helpers
+// ----------------------------------------------------------------------------
+
+static Vector4 NormalizePlane(Vector4 plane) {
+    f32 length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    if (length > 0) {
+        f32 inv = 1.0f / length;
+        plane.x *= inv;
+        plane.y *= inv;
+        plane.z *= inv;
+        plane.w *= inv;
+    }
+    return plane;
+}
+
+Cull_Frustum Cull_FrustumFromMatrix(Matrix m) {
+    // Gribb/Hartmann plane extraction, raymath names matrix elements so that row i is (m[i], m[i+4], m[i+8], m[i+12])
+    Vector4 row0 = { m.m0, m.m4, m.m8,  m.m12 };
+    Vector4 row1 = { m.m1, m.m5, m.m9,  m.m13 };
+    Vector4 row2 = { m.m2, m.m6, m.m10, m.m14 };
+    Vector4 row3 = { m.m3, m.m7, m.m11, m.m15 };
+
+    Cull_Frustum frustum;
+    frustum.planes[Cull_FrustumPlane_Left]   = NormalizePlane((Vector4) { row3.x + row0.x, row3.y + row0.y, row3.z + row0.z, row3.w + row0.w });
+    frustum.planes[Cull_FrustumPlane_Right]  = NormalizePlane((Vector4) { row3.x - row0.x, row3.y - row0.y, row3.z - row0.z, row3.w - row0.w });
+    frustum.planes[Cull_FrustumPlane_Bottom] = NormalizePlane((Vector4) { row3.x + row1.x, row3.y + row1.y, row3.z + row1.z, row3.w + row1.w });
+    frustum.planes[Cull_FrustumPlane_Top]    = NormalizePlane((Vector4) { row3.x - row1.x, row3.y - row1.y, row3.z - row1.z, row3.w - row1.w });
+    frustum.planes[Cull_FrustumPlane_Near]   = NormalizePlane((Vector4) { row3.x + row2.x, row3.y + row2.y, row3.z + row2.z, row3.w + row2.w });
+    frustum.planes[Cull_FrustumPlane_Far]    = NormalizePlane((Vector4) { row3.x - row2.x, row3.y - row2.y, row3.z - row2.z, row3.w - row2.w });
+    return frustum;
+}
+
+Cull_Frustum Cull_FrustumFromCamera(Camera3D camera, f32 aspect) {
+    return Cull_FrustumFromMatrix(Cull_ViewProjection(camera, aspect));
+}
+
+Matrix Cull_ViewProjection(Camera3D camera, f32 aspect) {
+    // same projection setup as BeginMode3D()
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix projection;
+    if (camera.projection == CAMERA_PERSPECTIVE) {
+        projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    } else {
+        double top = camera.fovy / 2.0;
+        double right = top * aspect;
+        projection = MatrixOrtho(-right, right, -top, top, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    }
+    return MatrixMultiply(view, projection);
+}
+
+b8 Cull_FrustumTestBox(const Cull_Frustum *frustum, BoundingBox box) {
+    for (int i = 0; i < Cull_FrustumPlane_COUNT; i++) {
+        Vector4 plane = frustum->planes[i];
+        f32 px = (plane.x > 0) ? box.max.x : box.min.x;
+        f32 py = (plane.y > 0) ? box.max.y : box.min.y;
+        f32 pz = (plane.z > 0) ? box.max.z : box.min.z;
+        if (plane.x * px + plane.y * py + plane.z * pz + plane.w < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BoundingBox Cull_TransformBox(BoundingBox box, Matrix m) {
+    Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    Vector3 extent = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+
+    Vector3 newCenter = Vector3Transform(center, m);
+    Vector3 newExtent = {
+            fabsf(m.m0) * extent.x + fabsf(m.m4) * extent.y + fabsf(m.m8)  * extent.z,
+            fabsf(m.m1) * extent.x + fabsf(m.m5) * extent.y + fabsf(m.m9)  * extent.z,
+            fabsf(m.m2) * extent.x + fabsf(m.m6) * extent.y + fabsf(m.m10) * extent.z,
+    };
+
+    return (BoundingBox) {
+            .min = Vector3Subtract(newCenter, newExtent),
+            .max = Vector3Add(newCenter, newExtent)
+    };
+}
+
+// ----------------------------------------------------------------------------
+// BVH construction
+// ----------------------------------------------------------------------------
+
+static void SetSlotBounds(struct BVHNode *node, int slot, BoundingBox box) {
+    node->minX[slot] = box.min.x;
+    node->minY[slot] = box.min.y;
+    node->minZ[slot] = box.min.z;
+    node->maxX[slot] = box.max.x;
+    node->maxY[slot] = box.max.y;
+    node->maxZ[slot] = box.max.z;
+}
+
+static BoundingBox GetNodeBounds(const struct BVHNode *node) {
+    BoundingBox box = {
+            .min = {  FLT_MAX,  FLT_MAX,  FLT_MAX },
+            .max = { -FLT_MAX, -FLT_MAX, -FLT_MAX }
+    };
+    for (int i = 0; i < CULL_BVH_WIDTH; i++) {
+        if (!(node->validMask & (1 << i))) continue;
+        box.min.x = fminf(box.min.x, node->minX[i]);
+        box.min.y = fminf(box.min.y, node->minY[i]);
+        box.min.z = fminf(box.min.z, node->minZ[i]);
+        box.max.x = fmaxf(box.max.x, node->maxX[i]);
+        box.max.y = fmaxf(box.max.y, node->maxY[i]);
+        box.max.z = fmaxf(box.max.z, node->maxZ[i]);
+    }
+    return box;
+}
+
+static u32 AllocNode(Cull_BVH *bvh, i32 parent, u8 parentSlot) {
+    if (bvh->nodeCount == bvh->nodeCapacity) {
+        bvh->nodeCapacity = (bvh->nodeCapacity == 0) ? 64 : bvh->nodeCapacity * 2;
+        bvh->nodes = realloc(bvh->nodes, bvh->nodeCapacity * sizeof(struct BVHNode));
+        bvh->dirty = realloc(bvh->dirty, bvh->nodeCapacity * sizeof(u8));
+    }
+
+    u32 index = bvh->nodeCount++;
+    struct BVHNode *node = &bvh->nodes[index];
+    memset(node, 0, sizeof(*node));
+    bvh->dirty[index] = false;
+    node->parent = parent;
+    node->parentSlot = parentSlot;
+
+    // empty slots get inverted bounds so they fail every plane test even without masking
+    for (int i = 0; i < CULL_BVH_WIDTH; i++) {
+        node->minX[i] = node->minY[i] = node->minZ[i] = FLT_MAX;
+        node->maxX[i] = node->maxY[i] = node->maxZ[i] = -FLT_MAX;
+    }
+    return index;
+}
+
+static f32 CentroidAxis(const struct BVHBuildContext *ctx, u32 index, int axis) {
+    const Vector3 *c = &ctx->centroids[index];
+    return (axis == 0) ? c->x : (axis == 1) ? c->y : c->z;
+}
+
+// partially sort indices[first, first + count) so the element at 'nth' is in its sorted position on the given axis
+static void SelectNth(struct BVHBuildContext *ctx, u32 first, u32 count, u32 nth, int axis) {
+    u32 *indices = ctx->indices;
+    u32 lo = first;
+    u32 hi = first + count - 1;
+    while (lo < hi) {
+        f32 pivot = CentroidAxis(ctx, indices[lo + (hi - lo) / 2], axis);
+        u32 i = lo;
+        u32 j = hi;
+        while (i <= j) {
+            while (CentroidAxis(ctx, indices[i], axis) < pivot) i++;
+            while (CentroidAxis(ctx, indices[j], axis) > pivot) j--;
+            if (i <= j) {
+                u32 tmp = indices[i];
+                indices[i] = indices[j];
+                indices[j] = tmp;
+                i++;
+                if (j == 0) break;
+                j--;
+            }
+        }
+        if (nth <= j) hi = j;
+        else if (nth >= i) lo = i;
+        else break;
+    }
+}
+
+// split a range in half at the median centroid of its widest axis, returns the size of the first half
+static u32 SplitRange(struct BVHBuildContext *ctx, u32 first, u32 count) {
+    Vector3 lo = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+    Vector3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (u32 i = first; i < first + count; i++) {
+        lo = Vector3Min(lo, ctx->centroids[ctx->indices[i]]);
+        hi = Vector3Max(hi, ctx->centroids[ctx->indices[i]]);
+    }
+
+    Vector3 size = Vector3Subtract(hi, lo);
+    int axis = (size.x > size.y && size.x > size.z) ? 0 : (size.y > size.z) ? 1 : 2;
+
+    u32 half = count / 2;
+    SelectNth(ctx, first, count, first + half, axis);
+    return half;
+}
+
+static u32 BuildNode(Cull_BVH *bvh, struct BVHBuildContext *ctx, u32 first, u32 count, i32 parent, u8 parentSlot) {
+    u32 nodeIndex = AllocNode(bvh, parent, parentSlot);
+
+    // partition the range into (up to) one part per child slot
+    u32 partFirst[CULL_BVH_WIDTH] = {0};
+    u32 partCount[CULL_BVH_WIDTH] = {0};
+    int partTotal = 0;
+    if (count <= CULL_BVH_WIDTH) {
+        for (u32 i = 0; i < count; i++) {
+            partFirst[partTotal] = first + i;
+            partCount[partTotal] = 1;
+            partTotal++;
+        }
+    } else {
+        u32 left = SplitRange(ctx, first, count);
+        u32 right = count - left;
+        u32 leftLeft = SplitRange(ctx, first, left);
+        u32 rightLeft = SplitRange(ctx, first + left, right);
+
+        partFirst[0] = first;                   partCount[0] = leftLeft;
+        partFirst[1] = first + leftLeft;        partCount[1] = left - leftLeft;
+        partFirst[2] = first + left;            partCount[2] = rightLeft;
+        partFirst[3] = first + left + rightLeft; partCount[3] = right - rightLeft;
+        partTotal = 4;
+    }
+
+    for (int slot = 0; slot < partTotal; slot++) {
+        if (partCount[slot] == 1) {
+            u32 object = ctx->indices[partFirst[slot]];
+            struct BVHNode *node = &bvh->nodes[nodeIndex];
+            node->child[slot] = object;
+            node->leafMask |= (u8) (1 << slot);
+            node->validMask |= (u8) (1 << slot);
+            SetSlotBounds(node, slot, ctx->boxes[object]);
+
+            bvh->objectNode[object] = nodeIndex;
+            bvh->objectSlot[object] = (u8) slot;
+        } else {
+            u32 childIndex = BuildNode(bvh, ctx, partFirst[slot], partCount[slot], (i32) nodeIndex, (u8) slot);
+            // NOTE - nodes array may have been reallocated while building the child
+            struct BVHNode *node = &bvh->nodes[nodeIndex];
+            node->child[slot] = childIndex;
+            node->validMask |= (u8) (1 << slot);
+            SetSlotBounds(node, slot, GetNodeBounds(&bvh->nodes[childIndex]));
+        }
+    }
+
+    return nodeIndex;
+}
+
+Cull_BVH *Cull_BVHBuild(const BoundingBox *boxes, u32 count) {
+    Cull_BVH *bvh = calloc(1, sizeof(Cull_BVH));
+    bvh->objectCount = count;
+    bvh->objectNode = malloc((count > 0 ? count : 1) * sizeof(u32));
+    bvh->objectSlot = malloc((count > 0 ? count : 1) * sizeof(u8));
+
+    if (count == 0) {
+        AllocNode(bvh, -1, 0);
+        return bvh;
+    }
+
+    struct BVHBuildContext ctx = {
+            .indices = malloc(count * sizeof(u32)),
+            .centroids = malloc(count * sizeof(Vector3)),
+            .boxes = boxes
+    };
+    for (u32 i = 0; i < count; i++) {
+        ctx.indices[i] = i;
+        ctx.centroids[i] = Vector3Scale(Vector3Add(boxes[i].min, boxes[i].max), 0.5f);
+    }
+
+    BuildNode(bvh, &ctx, 0, count, -1, 0);
+
+    free(ctx.indices);
+    free(ctx.centroids);
+    return bvh;
+}
+
+void Cull_BVHUnload(Cull_BVH *bvh) {
+    if (bvh == NULL) return;
+    free(bvh->nodes);
+    free(bvh->dirty);
+    free(bvh->objectNode);
+    free(bvh->objectSlot);
+    free(bvh);
+}
+
+u32 Cull_BVHObjectCount(const Cull_BVH *bvh) {
+    return bvh->objectCount;
+}
+
+// ----------------------------------------------------------------------------
+// BVH refit
+// ----------------------------------------------------------------------------
+
+void Cull_BVHUpdateObject(Cull_BVH *bvh, u32 objectIndex, BoundingBox box) {
+    if (objectIndex >= bvh->objectCount) return;
+
+    i32 nodeIndex = (i32) bvh->objectNode[objectIndex];
+    SetSlotBounds(&bvh->nodes[nodeIndex], bvh->objectSlot[objectIndex], box);
+
+    // mark the path to the root, stopping early if it's already marked
+    while (nodeIndex >= 0 && !bvh->dirty[nodeIndex]) {
+        bvh->dirty[nodeIndex] = true;
+        nodeIndex = bvh->nodes[nodeIndex].parent;
+    }
+}
+
+void Cull_BVHRefit(Cull_BVH *bvh) {
+    // children are always allocated after their parent, so a reverse sweep visits them first
+    for (u32 i = bvh->nodeCount; i-- > 0;) {
+        if (!bvh->dirty[i]) continue;
+        bvh->dirty[i] = false;
+
+        const struct BVHNode *node = &bvh->nodes[i];
+        if (node->parent >= 0) {
+            SetSlotBounds(&bvh->nodes[node->parent], node->parentSlot, GetNodeBounds(node));
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// BVH query
+// ----------------------------------------------------------------------------
+
+// test the 4 child bounds of a node against the planes in planeMask,
+// returns a lane mask of children that are outside any plane,
+// and for each plane a lane mask of children that are entirely inside it
+static int TestNode(const struct BVHNode *node, const Cull_Frustum *frustum, int planeMask, int insideMasks[Cull_FrustumPlane_COUNT]) {
+#if defined(CULL_USE_SSE)
+    __m128 minX = _mm_loadu_ps(node->minX);
+    __m128 minY = _mm_loadu_ps(node->minY);
+    __m128 minZ = _mm_loadu_ps(node->minZ);
+    __m128 maxX = _mm_loadu_ps(node->maxX);
+    __m128 maxY = _mm_loadu_ps(node->maxY);
+    __m128 maxZ = _mm_loadu_ps(node->maxZ);
+    __m128 zero = _mm_setzero_ps();
+    __m128 outside = zero;
+
+    for (int p = 0; p < Cull_FrustumPlane_COUNT; p++) {
+        if (!(planeMask & (1 << p))) continue;
+        Vector4 plane = frustum->planes[p];
+
+        // plane normal is uniform across lanes, so picking the positive/negative vertex is a scalar branch
+        __m128 posX = (plane.x > 0) ? maxX : minX;
+        __m128 posY = (plane.y > 0) ? maxY : minY;
+        __m128 posZ = (plane.z > 0) ? maxZ : minZ;
+        __m128 negX = (plane.x > 0) ? minX : maxX;
+        __m128 negY = (plane.y > 0) ? minY : maxY;
+        __m128 negZ = (plane.z > 0) ? minZ : maxZ;
+
+        __m128 a = _mm_set1_ps(plane.x);
+        __m128 b = _mm_set1_ps(plane.y);
+        __m128 c = _mm_set1_ps(plane.z);
+        __m128 d = _mm_set1_ps(plane.w);
+
+        __m128 posDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, posX), _mm_mul_ps(b, posY)), _mm_add_ps(_mm_mul_ps(c, posZ), d));
+        __m128 negDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, negX), _mm_mul_ps(b, negY)), _mm_add_ps(_mm_mul_ps(c, negZ), d));
+
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(posDist, zero));
+        insideMasks[p] = _mm_movemask_ps(_mm_cmpge_ps(negDist, zero));
+    }
+
+    return _mm_movemask_ps(outside);
+#else
+    int outsideMask = 0;
+    for (int p = 0; p < Cull_FrustumPlane_COUNT; p++) {
+        if (!(planeMask & (1 << p))) continue;
+        Vector4 plane = frustum->planes[p];
+
+        insideMasks[p] = 0;
+        for (int i = 0; i < CULL_BVH_WIDTH; i++) {
+            f32 posX = (plane.x > 0) ? node->maxX[i] : node->minX[i];
+            f32 posY = (plane.y > 0) ? node->maxY[i] : node->minY[i];
+            f32 posZ = (plane.z > 0) ? node->maxZ[i] : node->minZ[i];
+            f32 negX = (plane.x > 0) ? node->minX[i] : node->maxX[i];
+            f32 negY = (plane.y > 0) ? node->minY[i] : node->maxY[i];
+            f32 negZ = (plane.z > 0) ? node->minZ[i] : node->maxZ[i];
+
+            if (plane.x * posX + plane.y * posY + plane.z * posZ + plane.w < 0) outsideMask |= (1 << i);
+            if (plane.x * negX + plane.y * negY + plane.z * negZ + plane.w >= 0) insideMasks[p] |= (1 << i);
+        }
+    }
+    return outsideMask;
+#endif
+}
+
+static u32 CountLanes(int mask) {
+    u32 count = 0;
+    for (int i = 0; i < CULL_BVH_WIDTH; i++) {
+        count += (mask >> i) & 1;
+    }
+    return count;
+}
+
+u32 Cull_BVHQuery(const Cull_BVH *bvh, const Cull_Frustum *frustum, u32 *visible, u32 maxVisible, Cull_Stats *stats) {
+    Cull_Stats localStats = {0};
+    if (bvh->objectCount == 0) {
+        if (stats) *stats = localStats;
+        return 0;
+    }
+
+    struct StackEntry {
+        u32 node;
+        u8 planeMask;   // planes the node still needs to be tested against, 0 means fully inside
+    } stack[CULL_BVH_STACK_SIZE];
+    int top = 0;
+    stack[top++] = (struct StackEntry) { 0, CULL_ALL_PLANES };
+
+    u32 visibleCount = 0;
+    while (top > 0) {
+        struct StackEntry entry = stack[--top];
+        const struct BVHNode *node = &bvh->nodes[entry.node];
+        localStats.nodesVisited++;
+
+        int acceptMask = node->validMask;
+        int insideMasks[Cull_FrustumPlane_COUNT] = {0};
+        if (entry.planeMask != 0) {
+            acceptMask &= ~TestNode(node, frustum, entry.planeMask, insideMasks);
+            localStats.objectsTested += CountLanes(node->leafMask & node->validMask);
+        }
+
+        for (int i = 0; i < CULL_BVH_WIDTH; i++) {
+            if (!(acceptMask & (1 << i))) continue;
+
+            if (node->leafMask & (1 << i)) {
+                if (visibleCount < maxVisible) {
+                    visible[visibleCount] = node->child[i];
+                }
+                visibleCount++;
+                continue;
+            }
+
+            // drop planes this child is entirely inside of
+            u8 childMask = entry.planeMask;
+            for (int p = 0; p < Cull_FrustumPlane_COUNT; p++) {
+                if (insideMasks[p] & (1 << i)) childMask &= (u8) ~(1 << p);
+            }
+
+            if (top < CULL_BVH_STACK_SIZE) {
+                stack[top++] = (struct StackEntry) { node->child[i], childMask };
+            }
+        }
+    }
+
+    localStats.objectsVisible = visibleCount;
+    if (stats) *stats = localStats;
+    return visibleCount;
+}
@@ -0,0 +1,251 @@
+#include <math.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#include "dynres.h"
+#include "gputimer.h"
+#include "timer.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum DynResConstExpr {
+    DYNRES_SETTLE_FRAMES = GPUTIMER_LATENCY + 2,    // frames after a change before its GPU times are in
+    DYNRES_MIN_SIZE = 16,
+};
+
+static const f64 DYNRES_HEADROOM = 0.9;             // aim below the budget, frame times aren't steady
+static const f64 DYNRES_GROW_BELOW = 0.75;          // of the aim, grow back only with clear room to spare
+static const f64 DYNRES_SMOOTHING = 0.2;
+static const f64 DYNRES_SHRINK_GAIN = 0.6;
+static const f64 DYNRES_GROW_GAIN = 0.15;
+
+struct DynResView {
+    const char *pass;
+    RenderTexture2D target;
+    f64 area;                           // fraction of the full size pixels, unquantized
+    f32 scale;                          // applied, quantized
+    f32 drawnScale;                     // what this frame's BeginView() used
+    f64 cpuStart;
+    f64 cpu;
+    f64 gpu;
+    f64 cost;                           // smoothed
+};
+
+static struct DynRes {
+    b8 enabled;
+    f64 budget;
+    f32 minScale;
+    f32 maxScale;
+
+    struct DynResView views[DYNRES_MAX_VIEWS];
+    u32 viewCount;
+
+    f64 cost;
+    f64 cpu;
+    f64 gpu;
+    u64 gpuFrame;
+    u32 settle;
+} dynRes = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static f32 Quantize(f64 area) {
+    f32 scale = (f32) sqrt(area);
+    scale = roundf(scale * DYNRES_SCALE_STEPS) / DYNRES_SCALE_STEPS;
+    if (scale < dynRes.minScale) scale = dynRes.minScale;
+    if (scale > dynRes.maxScale) scale = dynRes.maxScale;
+    return scale;
+}
+
+static f64 Smooth(f64 smoothed, f64 value) {
+    return (smoothed > 0) ? smoothed + (value - smoothed) * DYNRES_SMOOTHING : value;
+}
+
+// the newest frame with timer results, its top level zones added up and each view's pass
+static void CollectGpuTimes(void) {
+    const GpuTimer_Zone *zones;
+    u64 frame;
+    u32 zoneCount = GpuTimer_Results(&zones, &frame);
+    if (zoneCount == 0 || frame == dynRes.gpuFrame) return;
+    dynRes.gpuFrame = frame;
+
+    dynRes.gpu = 0;
+    for (u32 v = 0; v < dynRes.viewCount; v++) {
+        dynRes.views[v].gpu = 0;
+    }
+    for (u32 i = 0; i < zoneCount; i++) {
+        if (zones[i].depth == 0) dynRes.gpu += zones[i].duration;
+        for (u32 v = 0; v < dynRes.viewCount; v++) {
+            if (strcmp(zones[i].name, dynRes.views[v].pass) == 0) dynRes.views[v].gpu += zones[i].duration;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void DynRes_Init(f64 budgetSeconds) {
+    memset(&dynRes, 0, sizeof(dynRes));
+    dynRes.enabled = true;
+    dynRes.budget = budgetSeconds;
+    dynRes.minScale = 0.5f;
+    dynRes.maxScale = 1.0f;
+}
+
+void DynRes_SetEnabled(b8 enabled) {
+    dynRes.enabled = enabled;
+    if (enabled) return;
+
+    for (u32 v = 0; v < dynRes.viewCount; v++) {
+        dynRes.views[v].area = 1;
+        dynRes.views[v].scale = 1;
+    }
+}
+
+b8 DynRes_IsEnabled(void) {
+    return dynRes.enabled;
+}
+
+void DynRes_SetBudget(f64 seconds) {
+    if (seconds > 0) dynRes.budget = seconds;
+}
+
+f64 DynRes_GetBudget(void) {
+    return dynRes.budget;
+}
+
+void DynRes_SetScaleRange(f32 min, f32 max) {
+    if (min <= 0 || max > 1 || min > max) {
+        TraceLog(LOG_WARNING, "DYNRES: Invalid scale range %.2f - %.2f", min, max);
+        return;
+    }
+    dynRes.minScale = min;
+    dynRes.maxScale = max;
+    for (u32 v = 0; v < dynRes.viewCount; v++) {
+        dynRes.views[v].scale = Quantize(dynRes.views[v].area);
+    }
+}
+
+DynRes_View DynRes_AddView(const char *pass, RenderTexture2D target) {
+    if (dynRes.viewCount >= DYNRES_MAX_VIEWS) {
+        TraceLog(LOG_WARNING, "DYNRES: More than %d views, '%s' stays at full size", DYNRES_MAX_VIEWS, pass);
+        return DYNRES_MAX_VIEWS;
+    }
+
+    // bilinear, the texture is stretched over the view whenever it's scaled down
+    SetTextureFilter(target.texture, TEXTURE_FILTER_BILINEAR);
+
+    dynRes.views[dynRes.viewCount] = (struct DynResView) {
+            .pass = pass, .target = target, .area = 1, .scale = 1, .drawnScale = 1
+    };
+    return dynRes.viewCount++;
+}
+
+f32 DynRes_GetScale(DynRes_View view) {
+    return (view < dynRes.viewCount) ? dynRes.views[view].scale : 1;
+}
+
+Vector2 DynRes_GetSize(DynRes_View view) {
+    if (view >= dynRes.viewCount) return (Vector2) {0};
+
+    const struct DynResView *v = &dynRes.views[view];
+    f32 width = roundf((f32) v->target.texture.width * v->drawnScale);
+    f32 height = roundf((f32) v->target.texture.height * v->drawnScale);
+    return (Vector2) { fmaxf(width, DYNRES_MIN_SIZE), fmaxf(height, DYNRES_MIN_SIZE) };
+}
+
+Rectangle DynRes_GetSource(DynRes_View view) {
+    Vector2 size = DynRes_GetSize(view);
+    return (Rectangle) { 0, 0, size.x, -size.y };
+}
+
+void DynRes_BeginView(DynRes_View view) {
+    if (view >= dynRes.viewCount) return;
+
+    struct DynResView *v = &dynRes.views[view];
+    v->drawnScale = v->scale;
+    v->cpuStart = Timer_Seconds();
+
+    // the projection BeginTextureMode() set up still covers the full texture, it just lands in fewer pixels,
+    // GL viewports start in the bottom left, which is where DynRes_GetSource() samples from
+    Vector2 size = DynRes_GetSize(view);
+    rlViewport(0, 0, (int) size.x, (int) size.y);
+}
+
+void DynRes_EndView(DynRes_View view) {
+    if (view >= dynRes.viewCount) return;
+
+    struct DynResView *v = &dynRes.views[view];
+    v->cpu = Timer_Seconds() - v->cpuStart;
+}
+
+void DynRes_Update(f64 cpuSeconds) {
+    dynRes.cpu = cpuSeconds;
+    CollectGpuTimes();
+
+    f64 frameCost = (dynRes.gpu > cpuSeconds) ? dynRes.gpu : cpuSeconds;
+    dynRes.cost = Smooth(dynRes.cost, frameCost);
+
+    f64 totalViewCost = 0;
+    for (u32 v = 0; v < dynRes.viewCount; v++) {
+        struct DynResView *view = &dynRes.views[v];
+        view->cost = Smooth(view->cost, (view->gpu > view->cpu) ? view->gpu : view->cpu);
+        totalViewCost += view->cost;
+    }
+
+    if (!dynRes.enabled || dynRes.viewCount == 0 || dynRes.cost <= 0) return;
+    if (dynRes.settle > 0) {
+        dynRes.settle--;
+        return;
+    }
+
+    // every view takes the part of the correction its share of the views' cost says, the rest of the frame
+    // doesn't scale with resolution, so this undershoots and the next rounds make up the difference
+    f64 aim = dynRes.budget * DYNRES_HEADROOM;
+    f64 gain;
+    if (dynRes.cost > aim) {
+        gain = DYNRES_SHRINK_GAIN;
+    } else if (dynRes.cost < aim * DYNRES_GROW_BELOW) {
+        gain = DYNRES_GROW_GAIN;
+    } else {
+        return;
+    }
+    f64 ratio = aim / dynRes.cost;
+    if (ratio < 0.5) ratio = 0.5;
+    if (ratio > 2.0) ratio = 2.0;
+
+    b8 changed = false;
+    f64 minArea = (f64) dynRes.minScale * dynRes.minScale, maxArea = (f64) dynRes.maxScale * dynRes.maxScale;
+    for (u32 v = 0; v < dynRes.viewCount; v++) {
+        struct DynResView *view = &dynRes.views[v];
+        // views that barely show up in the frame's cost mean it went somewhere the timers don't see, split evenly
+        f64 share = (totalViewCost > dynRes.cost * 0.25) ? view->cost / totalViewCost : 1.0 / dynRes.viewCount;
+
+        view->area *= 1 + gain * share * (ratio - 1);
+        if (view->area < minArea) view->area = minArea;
+        if (view->area > maxArea) view->area = maxArea;
+
+        f32 scale = Quantize(view->area);
+        if (scale != view->scale) {
+            view->scale = scale;
+            changed = true;
+        }
+    }
+    if (changed) dynRes.settle = DYNRES_SETTLE_FRAMES;
+}
+
+DynRes_Stats DynRes_GetStats(void) {
+    return (DynRes_Stats) {
+            .budget = dynRes.budget,
+            .cost = dynRes.cost,
+            .cpu = dynRes.cpu,
+            .gpu = dynRes.gpu,
+    };
+}
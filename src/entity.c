@@ -0,0 +1,350 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "entity.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define ENTITY_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum EntityConstExpr {
+    ENTITY_GENERATION_BITS = 32 - ENTITY_INDEX_BITS,
+    ENTITY_GENERATION_MASK = (1 << ENTITY_GENERATION_BITS) - 1,
+    ENTITY_NO_SLOT = ENTITY_MAX_CAPACITY,
+    ENTITY_LANES = 4,                   // entities per SIMD operation
+};
+
+// one array per float component, in the order they're swapped around on destroy
+enum EntityFloat {
+    EntityFloat_PositionX,
+    EntityFloat_PositionY,
+    EntityFloat_PositionZ,
+    EntityFloat_RotationX,
+    EntityFloat_RotationY,
+    EntityFloat_RotationZ,
+    EntityFloat_RotationW,
+    EntityFloat_Scale,
+    EntityFloat_AngularX,
+    EntityFloat_AngularY,
+    EntityFloat_AngularZ,
+    EntityFloat_COUNT,
+};
+
+struct Entity_Store {
+    u32 capacity;
+    u32 count;
+
+    // dense, entity i is element i of each
+    f32 *floats[EntityFloat_COUNT];
+    u32 *model;
+    Matrix *world;
+    Entity_Handle *handles;
+
+    // sparse, indexed by a handle's slot: the dense index of a live entity, the next free slot of a dead one
+    u32 *slotIndex;
+    u16 *slotGeneration;
+    u32 slotCount;                      // slots handed out so far, the rest have never been used
+    u32 freeSlot;
+};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u32 HandleSlot(Entity_Handle handle) {
+    return handle & ENTITY_MAX_CAPACITY;
+}
+
+static u32 HandleGeneration(Entity_Handle handle) {
+    return handle >> ENTITY_INDEX_BITS;
+}
+
+// reference for the SIMD kernel, also handles the entities that don't fill a last group of 4
+static void UpdateEntity(Entity_Store *store, u32 i, f32 halfDt) {
+    f32 **floats = store->floats;
+    f32 x = floats[EntityFloat_RotationX][i];
+    f32 y = floats[EntityFloat_RotationY][i];
+    f32 z = floats[EntityFloat_RotationZ][i];
+    f32 w = floats[EntityFloat_RotationW][i];
+    f32 ax = floats[EntityFloat_AngularX][i] * halfDt;
+    f32 ay = floats[EntityFloat_AngularY][i] * halfDt;
+    f32 az = floats[EntityFloat_AngularZ][i] * halfDt;
+
+    // q += (w * dt / 2) * q, with the angular velocity as a pure quaternion on the left (world space axis)
+    f32 nx = x + (ax * w + ay * z - az * y);
+    f32 ny = y + (ay * w + az * x - ax * z);
+    f32 nz = z + (az * w + ax * y - ay * x);
+    f32 nw = w - (ax * x + ay * y + az * z);
+    f32 invLength = 1.0f / sqrtf(nx * nx + ny * ny + nz * nz + nw * nw);
+    x = nx * invLength;
+    y = ny * invLength;
+    z = nz * invLength;
+    w = nw * invLength;
+    floats[EntityFloat_RotationX][i] = x;
+    floats[EntityFloat_RotationY][i] = y;
+    floats[EntityFloat_RotationZ][i] = z;
+    floats[EntityFloat_RotationW][i] = w;
+
+    // MatrixScale() * QuaternionToMatrix() * MatrixTranslate(), written out
+    f32 s = floats[EntityFloat_Scale][i];
+    f32 s2 = 2.0f * s;
+    store->world[i] = (Matrix) {
+            s - s2 * (y * y + z * z), s2 * (x * y - z * w), s2 * (x * z + y * w), floats[EntityFloat_PositionX][i],
+            s2 * (x * y + z * w), s - s2 * (x * x + z * z), s2 * (y * z - x * w), floats[EntityFloat_PositionY][i],
+            s2 * (x * z - y * w), s2 * (y * z + x * w), s - s2 * (x * x + y * y), floats[EntityFloat_PositionZ][i],
+            0, 0, 0, 1
+    };
+}
+
+#if defined(ENTITY_USE_SSE)
+// UpdateEntity() for entities i..i+3
+static void UpdateEntities4(Entity_Store *store, u32 i, f32 halfDt) {
+    f32 **floats = store->floats;
+    __m128 h = _mm_set1_ps(halfDt);
+    __m128 x = _mm_loadu_ps(floats[EntityFloat_RotationX] + i);
+    __m128 y = _mm_loadu_ps(floats[EntityFloat_RotationY] + i);
+    __m128 z = _mm_loadu_ps(floats[EntityFloat_RotationZ] + i);
+    __m128 w = _mm_loadu_ps(floats[EntityFloat_RotationW] + i);
+    __m128 ax = _mm_mul_ps(_mm_loadu_ps(floats[EntityFloat_AngularX] + i), h);
+    __m128 ay = _mm_mul_ps(_mm_loadu_ps(floats[EntityFloat_AngularY] + i), h);
+    __m128 az = _mm_mul_ps(_mm_loadu_ps(floats[EntityFloat_AngularZ] + i), h);
+
+    __m128 nx = _mm_add_ps(x, _mm_sub_ps(_mm_add_ps(_mm_mul_ps(ax, w), _mm_mul_ps(ay, z)), _mm_mul_ps(az, y)));
+    __m128 ny = _mm_add_ps(y, _mm_sub_ps(_mm_add_ps(_mm_mul_ps(ay, w), _mm_mul_ps(az, x)), _mm_mul_ps(ax, z)));
+    __m128 nz = _mm_add_ps(z, _mm_sub_ps(_mm_add_ps(_mm_mul_ps(az, w), _mm_mul_ps(ax, y)), _mm_mul_ps(ay, x)));
+    __m128 nw = _mm_sub_ps(w, _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, x), _mm_mul_ps(ay, y)), _mm_mul_ps(az, z)));
+    __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)),
+                                 _mm_add_ps(_mm_mul_ps(nz, nz), _mm_mul_ps(nw, nw)));
+    // a full divide rather than _mm_rsqrt_ps(), its 12 bits would let the rotations drift off unit length
+    __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSq));
+    x = _mm_mul_ps(nx, invLength);
+    y = _mm_mul_ps(ny, invLength);
+    z = _mm_mul_ps(nz, invLength);
+    w = _mm_mul_ps(nw, invLength);
+    _mm_storeu_ps(floats[EntityFloat_RotationX] + i, x);
+    _mm_storeu_ps(floats[EntityFloat_RotationY] + i, y);
+    _mm_storeu_ps(floats[EntityFloat_RotationZ] + i, z);
+    _mm_storeu_ps(floats[EntityFloat_RotationW] + i, w);
+
+    __m128 s = _mm_loadu_ps(floats[EntityFloat_Scale] + i);
+    __m128 s2 = _mm_add_ps(s, s);
+    __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+    __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+    __m128 xw = _mm_mul_ps(x, w), yw = _mm_mul_ps(y, w), zw = _mm_mul_ps(z, w);
+
+    // the first three rows of each matrix, one component of 4 matrices per register, transposed on the way out
+    __m128 rows[3][4] = {
+            {
+                    _mm_sub_ps(s, _mm_mul_ps(s2, _mm_add_ps(yy, zz))),
+                    _mm_mul_ps(s2, _mm_sub_ps(xy, zw)),
+                    _mm_mul_ps(s2, _mm_add_ps(xz, yw)),
+                    _mm_loadu_ps(floats[EntityFloat_PositionX] + i)
+            },
+            {
+                    _mm_mul_ps(s2, _mm_add_ps(xy, zw)),
+                    _mm_sub_ps(s, _mm_mul_ps(s2, _mm_add_ps(xx, zz))),
+                    _mm_mul_ps(s2, _mm_sub_ps(yz, xw)),
+                    _mm_loadu_ps(floats[EntityFloat_PositionY] + i)
+            },
+            {
+                    _mm_mul_ps(s2, _mm_sub_ps(xz, yw)),
+                    _mm_mul_ps(s2, _mm_add_ps(yz, xw)),
+                    _mm_sub_ps(s, _mm_mul_ps(s2, _mm_add_ps(xx, yy))),
+                    _mm_loadu_ps(floats[EntityFloat_PositionZ] + i)
+            },
+    };
+    __m128 lastRow = _mm_setr_ps(0, 0, 0, 1);
+
+    f32 *world = (f32 *) (store->world + i);
+    for (u32 row = 0; row < 3; row++) {
+        _MM_TRANSPOSE4_PS(rows[row][0], rows[row][1], rows[row][2], rows[row][3]);
+        for (u32 lane = 0; lane < ENTITY_LANES; lane++) {
+            _mm_storeu_ps(world + lane * 16 + row * 4, rows[row][lane]);
+        }
+    }
+    for (u32 lane = 0; lane < ENTITY_LANES; lane++) {
+        _mm_storeu_ps(world + lane * 16 + 12, lastRow);
+    }
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+Entity_Store *Entity_StoreCreate(u32 capacity) {
+    if (capacity == 0 || capacity > ENTITY_MAX_CAPACITY) {
+        TraceLog(LOG_WARNING, "ENTITY: Capacity %u out of range (1..%u)", capacity, (u32) ENTITY_MAX_CAPACITY);
+        return NULL;
+    }
+
+    Entity_Store *store = calloc(1, sizeof(Entity_Store));
+    if (store == NULL) return NULL;
+
+    store->capacity = capacity;
+    store->freeSlot = ENTITY_NO_SLOT;
+    b8 allocated = true;
+    for (u32 i = 0; i < EntityFloat_COUNT; i++) {
+        store->floats[i] = malloc(capacity * sizeof(f32));
+        allocated &= store->floats[i] != NULL;
+    }
+    store->model = malloc(capacity * sizeof(u32));
+    store->world = malloc(capacity * sizeof(Matrix));
+    store->handles = malloc(capacity * sizeof(Entity_Handle));
+    store->slotIndex = malloc(capacity * sizeof(u32));
+    store->slotGeneration = calloc(capacity, sizeof(u16));
+    allocated &= store->model && store->world && store->handles && store->slotIndex && store->slotGeneration;
+
+    if (!allocated) {
+        TraceLog(LOG_WARNING, "ENTITY: Out of memory creating a store of %u entities", capacity);
+        Entity_StoreUnload(store);
+        return NULL;
+    }
+    return store;
+}
+
+void Entity_StoreUnload(Entity_Store *store) {
+    if (store == NULL) return;
+
+    for (u32 i = 0; i < EntityFloat_COUNT; i++) {
+        free(store->floats[i]);
+    }
+    free(store->model);
+    free(store->world);
+    free(store->handles);
+    free(store->slotIndex);
+    free(store->slotGeneration);
+    free(store);
+}
+
+Entity_Handle Entity_Create(Entity_Store *store, Entity_Desc desc) {
+    if (store == NULL || store->count >= store->capacity) return 0;
+
+    u32 slot;
+    if (store->freeSlot != ENTITY_NO_SLOT) {
+        slot = store->freeSlot;
+        store->freeSlot = store->slotIndex[slot];
+    } else {
+        slot = store->slotCount++;
+    }
+
+    // generation 0 is skipped so no handle is ever 0
+    u32 generation = (store->slotGeneration[slot] + 1u) & ENTITY_GENERATION_MASK;
+    if (generation == 0) generation = 1;
+    store->slotGeneration[slot] = (u16) generation;
+
+    u32 i = store->count++;
+    store->slotIndex[slot] = i;
+    store->handles[i] = (generation << ENTITY_INDEX_BITS) | slot;
+
+    f32 **floats = store->floats;
+    floats[EntityFloat_PositionX][i] = desc.position.x;
+    floats[EntityFloat_PositionY][i] = desc.position.y;
+    floats[EntityFloat_PositionZ][i] = desc.position.z;
+    floats[EntityFloat_RotationX][i] = desc.rotation.x;
+    floats[EntityFloat_RotationY][i] = desc.rotation.y;
+    floats[EntityFloat_RotationZ][i] = desc.rotation.z;
+    floats[EntityFloat_RotationW][i] = desc.rotation.w;
+    floats[EntityFloat_Scale][i] = desc.scale;
+    floats[EntityFloat_AngularX][i] = desc.angularVelocity.x;
+    floats[EntityFloat_AngularY][i] = desc.angularVelocity.y;
+    floats[EntityFloat_AngularZ][i] = desc.angularVelocity.z;
+    store->model[i] = desc.model;
+
+    // the world matrix is good from the start, a zero step doesn't turn it
+    UpdateEntity(store, i, 0);
+    return store->handles[i];
+}
+
+void Entity_Destroy(Entity_Store *store, Entity_Handle handle) {
+    u32 i = Entity_Index(store, handle);
+    if (i == ENTITY_MAX_CAPACITY) return;
+
+    // the last entity moves into the hole
+    u32 last = --store->count;
+    if (i != last) {
+        for (u32 f = 0; f < EntityFloat_COUNT; f++) {
+            store->floats[f][i] = store->floats[f][last];
+        }
+        store->model[i] = store->model[last];
+        store->world[i] = store->world[last];
+        store->handles[i] = store->handles[last];
+        store->slotIndex[HandleSlot(store->handles[i])] = i;
+    }
+
+    u32 slot = HandleSlot(handle);
+    store->slotIndex[slot] = store->freeSlot;
+    store->freeSlot = slot;
+}
+
+b8 Entity_IsAlive(const Entity_Store *store, Entity_Handle handle) {
+    return Entity_Index(store, handle) != ENTITY_MAX_CAPACITY;
+}
+
+u32 Entity_Index(const Entity_Store *store, Entity_Handle handle) {
+    if (store == NULL || handle == 0) return ENTITY_MAX_CAPACITY;
+
+    u32 slot = HandleSlot(handle);
+    if (slot >= store->slotCount || store->slotGeneration[slot] != HandleGeneration(handle)) return ENTITY_MAX_CAPACITY;
+
+    // a free slot's generation still matches the last handle it gave out, its index is a free list link
+    u32 i = store->slotIndex[slot];
+    if (i >= store->count || store->handles[i] != handle) return ENTITY_MAX_CAPACITY;
+    return i;
+}
+
+u32 Entity_Count(const Entity_Store *store) {
+    return store ? store->count : 0;
+}
+
+Entity_Arrays Entity_GetArrays(Entity_Store *store) {
+    if (store == NULL) return (Entity_Arrays) {0};
+
+    f32 **floats = store->floats;
+    return (Entity_Arrays) {
+            .count = store->count,
+            .positionX = floats[EntityFloat_PositionX],
+            .positionY = floats[EntityFloat_PositionY],
+            .positionZ = floats[EntityFloat_PositionZ],
+            .rotationX = floats[EntityFloat_RotationX],
+            .rotationY = floats[EntityFloat_RotationY],
+            .rotationZ = floats[EntityFloat_RotationZ],
+            .rotationW = floats[EntityFloat_RotationW],
+            .scale = floats[EntityFloat_Scale],
+            .angularX = floats[EntityFloat_AngularX],
+            .angularY = floats[EntityFloat_AngularY],
+            .angularZ = floats[EntityFloat_AngularZ],
+            .model = store->model,
+            .world = store->world,
+            .handles = store->handles,
+    };
+}
+
+void Entity_Update(Entity_Store *store, f32 dt) {
+    Entity_UpdateRange(store, 0, Entity_Count(store), dt);
+}
+
+void Entity_UpdateRange(Entity_Store *store, u32 first, u32 end, f32 dt) {
+    if (store == NULL) return;
+    if (end > store->count) end = store->count;
+
+    f32 halfDt = 0.5f * dt;
+    u32 i = first;
+#if defined(ENTITY_USE_SSE)
+    for (; i + ENTITY_LANES <= end; i += ENTITY_LANES) {
+        UpdateEntities4(store, i, halfDt);
+    }
+#endif
+    for (; i < end; i++) {
+        UpdateEntity(store, i, halfDt);
+    }
+}
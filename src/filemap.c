@@ -0,0 +1,71 @@
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "filemap.h"
+
+b8 FileMap_Open(const char *fileName, FileMap *map) {
+    *map = (FileMap) {0};
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);  // the mapping keeps the file open
+    if (mapping == NULL) return false;
+
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    map->data = data;
+    map->size = (u64) size.QuadPart;
+    map->handle = mapping;
+#else
+    int file = open(fileName, O_RDONLY);
+    if (file < 0) return false;
+
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0) {
+        close(file);
+        return false;
+    }
+
+    void *data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);        // the mapping keeps the file open
+    if (data == MAP_FAILED) return false;
+
+    map->data = data;
+    map->size = (u64) info.st_size;
+#endif
+    return true;
+}
+
+void FileMap_Close(FileMap *map) {
+    if (map->data == NULL) return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(map->data);
+    CloseHandle((HANDLE) map->handle);
+#else
+    munmap((void *) map->data, (size_t) map->size);
+#endif
+    *map = (FileMap) {0};
+}
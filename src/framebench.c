@@ -0,0 +1,370 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+
+#include "framebench.h"
+#include "gputimer.h"
+#include "timer.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum FrameBenchConstExpr {
+    FRAMEBENCH_INVALID_PASS = FRAMEBENCH_MAX_PASSES,
+    FRAMEBENCH_GPU_GRACE_FRAMES = GPUTIMER_LATENCY + 4,     // extra frames to wait for the last GPU times
+};
+
+// seconds, gpu values are negative until their results are in
+struct FrameBenchFrame {
+    f64 cpu;
+    f64 gpu;
+    f64 passCpu[FRAMEBENCH_MAX_PASSES];
+    f64 passGpu[FRAMEBENCH_MAX_PASSES];
+    u64 gpuFrame;                       // GpuTimer_Frame() it was drawn in
+    u64 triangles;
+    u32 textureBinds;
+};
+
+static struct FrameBench {
+    struct FrameBenchFrame *frames;
+    u32 frameCount;
+    u32 recorded;
+    u32 gpuPending;                     // recorded frames still waiting for GPU times
+    u32 framesAfter;                    // drawn since the last recorded one
+    b8 recording;
+    b8 inFrame;
+
+    const char *passNames[FRAMEBENCH_MAX_PASSES];
+    u32 passCount;
+
+    f64 frameStart;
+    u32 frameZone;
+    f64 passStart[FRAMEBENCH_MAX_PASSES];
+} frameBench = {0};
+
+struct FrameBenchSummary {
+    f64 p50, p95, p99, max, mean;
+    u32 count;
+};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static f32 CatmullRom(f32 p0, f32 p1, f32 p2, f32 p3, f32 t) {
+    f32 t2 = t * t;
+    f32 t3 = t2 * t;
+    return 0.5f * ((2 * p1) + (-p0 + p2) * t + (2 * p0 - 5 * p1 + 4 * p2 - p3) * t2 + (-p0 + 3 * p1 - 3 * p2 + p3) * t3);
+}
+
+static f32 Lerp32(f32 a, f32 b, f32 t) {
+    return a + (b - a) * t;
+}
+
+static u32 FindPass(const char *name) {
+    for (u32 i = 0; i < frameBench.passCount; i++) {
+        if (frameBench.passNames[i] == name || strcmp(frameBench.passNames[i], name) == 0) return i;
+    }
+    if (frameBench.passCount >= FRAMEBENCH_MAX_PASSES) return FRAMEBENCH_INVALID_PASS;
+
+    frameBench.passNames[frameBench.passCount] = name;
+    return frameBench.passCount++;
+}
+
+// file the newest GPU results under the recorded frame they belong to
+static void CollectGpuTimes(void) {
+    const GpuTimer_Zone *zones;
+    u64 gpuFrame;
+    u32 zoneCount = GpuTimer_Results(&zones, &gpuFrame);
+    if (zoneCount == 0 || frameBench.recorded == 0) return;
+
+    u64 first = frameBench.frames[0].gpuFrame;
+    if (gpuFrame < first || gpuFrame - first >= frameBench.recorded) return;
+
+    struct FrameBenchFrame *frame = &frameBench.frames[gpuFrame - first];
+    if (frame->gpu >= 0) return;
+
+    for (u32 z = 0; z < zoneCount; z++) {
+        if (strcmp(zones[z].name, "frame") == 0) {
+            frame->gpu = zones[z].duration;
+            continue;
+        }
+        for (u32 p = 0; p < frameBench.passCount; p++) {
+            if (strcmp(zones[z].name, frameBench.passNames[p]) == 0) {
+                frame->passGpu[p] = (frame->passGpu[p] < 0 ? 0 : frame->passGpu[p]) + zones[z].duration;
+            }
+        }
+    }
+    if (frame->gpu < 0) frame->gpu = 0;
+    if (frameBench.gpuPending > 0) frameBench.gpuPending--;
+}
+
+static int CompareF64(const void *a, const void *b) {
+    f64 x = *(const f64 *) a, y = *(const f64 *) b;
+    return (x > y) - (x < y);
+}
+
+// values below zero are missing and left out
+static struct FrameBenchSummary Summarize(f64 *values, u32 count) {
+    u32 n = 0;
+    f64 sum = 0;
+    for (u32 i = 0; i < count; i++) {
+        if (values[i] < 0) continue;
+        values[n++] = values[i];
+        sum += values[i];
+    }
+
+    struct FrameBenchSummary summary = { .count = n };
+    if (n == 0) return summary;
+
+    qsort(values, n, sizeof(f64), CompareF64);
+    // nearest rank
+    u32 p50 = (n * 50 + 99) / 100, p95 = (n * 95 + 99) / 100, p99 = (n * 99 + 99) / 100;
+    summary.p50 = values[(p50 > 0 ? p50 : 1) - 1];
+    summary.p95 = values[(p95 > 0 ? p95 : 1) - 1];
+    summary.p99 = values[(p99 > 0 ? p99 : 1) - 1];
+    summary.max = values[n - 1];
+    summary.mean = sum / n;
+    return summary;
+}
+
+// offset is the byte offset of the f64 field to summarize inside struct FrameBenchFrame
+static struct FrameBenchSummary SummarizeField(f64 *scratch, u64 offset) {
+    for (u32 i = 0; i < frameBench.recorded; i++) {
+        scratch[i] = *(const f64 *) ((const u8 *) &frameBench.frames[i] + offset);
+    }
+    return Summarize(scratch, frameBench.recorded);
+}
+
+static void WriteSummary(FILE *file, const char *key, struct FrameBenchSummary summary) {
+    if (summary.count == 0) {
+        fprintf(file, "\"%s\": null", key);
+        return;
+    }
+    fprintf(file, "\"%s\": { \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"mean\": %.4f }",
+            key, summary.p50 * 1000.0, summary.p95 * 1000.0, summary.p99 * 1000.0, summary.max * 1000.0, summary.mean * 1000.0);
+}
+
+static void WriteJSONString(FILE *file, const char *text) {
+    fputc('"', file);
+    for (const char *c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        if ((unsigned char) *c >= 0x20) fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static void WriteMs(FILE *file, f64 seconds) {
+    if (seconds >= 0) fprintf(file, "%.4f", seconds * 1000.0);
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+FrameBench_Key FrameBench_SamplePath(const FrameBench_Key *keys, u32 count, f32 time) {
+    if (count == 0) return (FrameBench_Key) {0};
+    if (count == 1 || time <= keys[0].time) return keys[0];
+    if (time >= keys[count - 1].time) return keys[count - 1];
+
+    u32 i = 0;
+    while (i + 2 < count && time >= keys[i + 1].time) i++;
+
+    const FrameBench_Key *k0 = &keys[i > 0 ? i - 1 : 0];
+    const FrameBench_Key *k1 = &keys[i];
+    const FrameBench_Key *k2 = &keys[i + 1];
+    const FrameBench_Key *k3 = &keys[i + 2 < count ? i + 2 : count - 1];
+    f32 span = k2->time - k1->time;
+    f32 t = (span > 0) ? (time - k1->time) / span : 0;
+
+    return (FrameBench_Key) {
+            .time = time,
+            .playerPos = {
+                    CatmullRom(k0->playerPos.x, k1->playerPos.x, k2->playerPos.x, k3->playerPos.x, t),
+                    CatmullRom(k0->playerPos.y, k1->playerPos.y, k2->playerPos.y, k3->playerPos.y, t)
+            },
+            .eye = {
+                    CatmullRom(k0->eye.x, k1->eye.x, k2->eye.x, k3->eye.x, t),
+                    CatmullRom(k0->eye.y, k1->eye.y, k2->eye.y, k3->eye.y, t),
+                    CatmullRom(k0->eye.z, k1->eye.z, k2->eye.z, k3->eye.z, t)
+            },
+            .target = {
+                    CatmullRom(k0->target.x, k1->target.x, k2->target.x, k3->target.x, t),
+                    CatmullRom(k0->target.y, k1->target.y, k2->target.y, k3->target.y, t),
+                    CatmullRom(k0->target.z, k1->target.z, k2->target.z, k3->target.z, t)
+            },
+            .overheadRotation = Lerp32(k1->overheadRotation, k2->overheadRotation, t),
+            .overheadZoom = Lerp32(k1->overheadZoom, k2->overheadZoom, t),
+    };
+}
+
+void FrameBench_Start(u32 frames) {
+    FrameBench_Shutdown();
+    if (frames == 0) return;
+
+    frameBench.frames = calloc(frames, sizeof(struct FrameBenchFrame));
+    if (frameBench.frames == NULL) {
+        TraceLog(LOG_WARNING, "FRAMEBENCH: Out of memory for %u frames", frames);
+        return;
+    }
+    frameBench.frameCount = frames;
+    frameBench.recording = true;
+}
+
+void FrameBench_Shutdown(void) {
+    free(frameBench.frames);
+    memset(&frameBench, 0, sizeof(frameBench));
+}
+
+b8 FrameBench_IsRecording(void) {
+    return frameBench.recording;
+}
+
+b8 FrameBench_IsDone(void) {
+    if (!frameBench.recording || frameBench.recorded < frameBench.frameCount) return false;
+    return frameBench.gpuPending == 0 || frameBench.framesAfter > FRAMEBENCH_GPU_GRACE_FRAMES;
+}
+
+void FrameBench_BeginFrame(void) {
+    if (!frameBench.recording) return;
+
+    CollectGpuTimes();
+    if (frameBench.recorded >= frameBench.frameCount) {
+        frameBench.framesAfter++;
+        return;
+    }
+
+    struct FrameBenchFrame *frame = &frameBench.frames[frameBench.recorded];
+    frame->gpu = -1;
+    for (u32 p = 0; p < FRAMEBENCH_MAX_PASSES; p++) {
+        frame->passGpu[p] = -1;
+    }
+    frame->gpuFrame = GpuTimer_Frame();
+
+    frameBench.inFrame = true;
+    frameBench.frameZone = GpuTimer_Begin("frame");
+    frameBench.frameStart = Timer_Seconds();
+}
+
+void FrameBench_EndFrame(void) {
+    if (!frameBench.inFrame) return;
+
+    struct FrameBenchFrame *frame = &frameBench.frames[frameBench.recorded];
+    frame->cpu = Timer_Seconds() - frameBench.frameStart;
+    GpuTimer_End(frameBench.frameZone);
+
+    frameBench.inFrame = false;
+    frameBench.recorded++;
+    if (GpuTimer_IsAvailable()) frameBench.gpuPending++;
+}
+
+u32 FrameBench_BeginPass(const char *name) {
+    if (!frameBench.inFrame) return FRAMEBENCH_INVALID_PASS;
+
+    u32 pass = FindPass(name);
+    if (pass == FRAMEBENCH_INVALID_PASS) return pass;
+
+    frameBench.passStart[pass] = Timer_Seconds();
+    return pass;
+}
+
+void FrameBench_EndPass(u32 pass) {
+    if (!frameBench.inFrame || pass >= frameBench.passCount) return;
+
+    frameBench.frames[frameBench.recorded].passCpu[pass] += Timer_Seconds() - frameBench.passStart[pass];
+}
+
+void FrameBench_AddTriangles(u64 triangles) {
+    if (!frameBench.inFrame) return;
+
+    frameBench.frames[frameBench.recorded].triangles += triangles;
+}
+
+void FrameBench_AddTextureBinds(u32 binds) {
+    if (!frameBench.inFrame) return;
+
+    frameBench.frames[frameBench.recorded].textureBinds += binds;
+}
+
+b8 FrameBench_WriteJSON(const char *fileName) {
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) {
+        TraceLog(LOG_WARNING, "FRAMEBENCH: [%s] Couldn't open for writing", fileName);
+        return false;
+    }
+
+    f64 *scratch = malloc(sizeof(f64) * (frameBench.recorded + 1));
+    fprintf(file, "{\n");
+    fprintf(file, "  \"renderer\": ");
+    WriteJSONString(file, GpuTimer_Renderer());
+    fprintf(file, ",\n  \"frames\": %u,\n  ", frameBench.recorded);
+    WriteSummary(file, "cpu_ms", SummarizeField(scratch, offsetof(struct FrameBenchFrame, cpu)));
+    fprintf(file, ",\n  ");
+    WriteSummary(file, "gpu_ms", SummarizeField(scratch, offsetof(struct FrameBenchFrame, gpu)));
+
+    u64 triangles = 0, textureBinds = 0;
+    f64 seconds = 0;
+    for (u32 i = 0; i < frameBench.recorded; i++) {
+        triangles += frameBench.frames[i].triangles;
+        textureBinds += frameBench.frames[i].textureBinds;
+        seconds += frameBench.frames[i].cpu;
+    }
+    fprintf(file, ",\n  \"triangles_per_frame\": %.1f,\n  \"mtris_per_second\": %.3f",
+            frameBench.recorded ? (f64) triangles / frameBench.recorded : 0.0, seconds > 0 ? (f64) triangles / seconds / 1e6 : 0.0);
+    fprintf(file, ",\n  \"texture_binds_per_frame\": %.1f", frameBench.recorded ? (f64) textureBinds / frameBench.recorded : 0.0);
+    fprintf(file, ",\n  \"passes\": [");
+    for (u32 p = 0; p < frameBench.passCount; p++) {
+        fprintf(file, "%s\n    { \"name\": ", p > 0 ? "," : "");
+        WriteJSONString(file, frameBench.passNames[p]);
+        fprintf(file, ", ");
+        WriteSummary(file, "cpu_ms", SummarizeField(scratch, offsetof(struct FrameBenchFrame, passCpu) + p * sizeof(f64)));
+        fprintf(file, ", ");
+        WriteSummary(file, "gpu_ms", SummarizeField(scratch, offsetof(struct FrameBenchFrame, passGpu) + p * sizeof(f64)));
+        fprintf(file, " }");
+    }
+    fprintf(file, "\n  ]\n}\n");
+    free(scratch);
+
+    b8 written = ferror(file) == 0;
+    fclose(file);
+    return written;
+}
+
+b8 FrameBench_WriteCSV(const char *fileName) {
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) {
+        TraceLog(LOG_WARNING, "FRAMEBENCH: [%s] Couldn't open for writing", fileName);
+        return false;
+    }
+
+    // gpu columns are left empty where timer queries didn't deliver
+    fprintf(file, "frame,cpu_ms,gpu_ms,triangles,texture_binds");
+    for (u32 p = 0; p < frameBench.passCount; p++) {
+        fprintf(file, ",%s_cpu_ms,%s_gpu_ms", frameBench.passNames[p], frameBench.passNames[p]);
+    }
+    fprintf(file, "\n");
+
+    for (u32 i = 0; i < frameBench.recorded; i++) {
+        const struct FrameBenchFrame *frame = &frameBench.frames[i];
+        fprintf(file, "%u,", i);
+        WriteMs(file, frame->cpu);
+        fprintf(file, ",");
+        WriteMs(file, frame->gpu);
+        fprintf(file, ",%llu,%u", (unsigned long long) frame->triangles, frame->textureBinds);
+        for (u32 p = 0; p < frameBench.passCount; p++) {
+            fprintf(file, ",");
+            WriteMs(file, frame->passCpu[p]);
+            fprintf(file, ",");
+            WriteMs(file, frame->passGpu[p]);
+        }
+        fprintf(file, "\n");
+    }
+
+    b8 written = ferror(file) == 0;
+    fclose(file);
+    return written;
+}
@@ -0,0 +1,458 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+
+#include "glb.h"
+#include "json.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum GlbConstExpr {
+    GLB_MAGIC = 0x46546C67,         // 'glTF'
+    GLB_CHUNK_JSON = 0x4E4F534A,    // 'JSON'
+    GLB_CHUNK_BIN = 0x004E4942,     // 'BIN\0'
+    GLB_HEADER_SIZE = 12,
+    GLB_CHUNK_HEADER_SIZE = 8,
+
+    GLTF_BYTE = 5120,
+    GLTF_UNSIGNED_BYTE = 5121,
+    GLTF_SHORT = 5122,
+    GLTF_UNSIGNED_SHORT = 5123,
+    GLTF_UNSIGNED_INT = 5125,
+    GLTF_FLOAT = 5126,
+
+    GLTF_MODE_TRIANGLES = 4,
+};
+
+struct GlbContext {
+    JSON_Document json;
+    i32 root;
+    const u8 *bin;
+    u32 binSize;
+};
+
+struct GlbAccessor {
+    const u8 *data;
+    i32 count;
+    i32 components;
+    i32 componentType;
+    i32 componentSize;
+    i32 stride;
+    b8 normalized;
+};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u32 ReadU32(const u8 *data) {
+    return (u32) data[0] | ((u32) data[1] << 8) | ((u32) data[2] << 16) | ((u32) data[3] << 24);
+}
+
+static i32 ComponentSize(i32 componentType) {
+    switch (componentType) {
+        case GLTF_BYTE:
+        case GLTF_UNSIGNED_BYTE: return 1;
+        case GLTF_SHORT:
+        case GLTF_UNSIGNED_SHORT: return 2;
+        case GLTF_UNSIGNED_INT:
+        case GLTF_FLOAT: return 4;
+        default: return 0;
+    }
+}
+
+static i32 TypeComponents(const JSON_Document *json, i32 type) {
+    if (JSON_StringEquals(json, type, "SCALAR")) return 1;
+    if (JSON_StringEquals(json, type, "VEC2")) return 2;
+    if (JSON_StringEquals(json, type, "VEC3")) return 3;
+    if (JSON_StringEquals(json, type, "VEC4")) return 4;
+    if (JSON_StringEquals(json, type, "MAT4")) return 16;
+    return 0;
+}
+
+// resolve a bufferView to a byte range within the binary chunk
+static const u8 *GetBufferView(const struct GlbContext *ctx, i32 viewIndex, u32 *length, i32 *stride) {
+    const JSON_Document *json = &ctx->json;
+    i32 view = JSON_ArrayGet(json, JSON_ObjectGet(json, ctx->root, "bufferViews"), viewIndex);
+    if (view < 0) return NULL;
+
+    // only the embedded GLB buffer (0) is supported
+    if (JSON_Int(json, JSON_ObjectGet(json, view, "buffer"), 0) != 0) return NULL;
+
+    u64 offset = (u64) JSON_Int(json, JSON_ObjectGet(json, view, "byteOffset"), 0);
+    u64 size = (u64) JSON_Int(json, JSON_ObjectGet(json, view, "byteLength"), 0);
+    if (offset + size > ctx->binSize) return NULL;
+
+    if (length) *length = (u32) size;
+    if (stride) *stride = (i32) JSON_Int(json, JSON_ObjectGet(json, view, "byteStride"), 0);
+    return ctx->bin + offset;
+}
+
+static b8 GetAccessor(const struct GlbContext *ctx, i32 accessorIndex, struct GlbAccessor *accessor) {
+    const JSON_Document *json = &ctx->json;
+    i32 token = JSON_ArrayGet(json, JSON_ObjectGet(json, ctx->root, "accessors"), accessorIndex);
+    if (token < 0) return false;
+
+    *accessor = (struct GlbAccessor) {
+            .count = (i32) JSON_Int(json, JSON_ObjectGet(json, token, "count"), 0),
+            .components = TypeComponents(json, JSON_ObjectGet(json, token, "type")),
+            .componentType = (i32) JSON_Int(json, JSON_ObjectGet(json, token, "componentType"), 0),
+            .normalized = JSON_Bool(json, JSON_ObjectGet(json, token, "normalized"), false)
+    };
+    accessor->componentSize = ComponentSize(accessor->componentType);
+    if (accessor->count <= 0 || accessor->components == 0 || accessor->componentSize == 0) return false;
+
+    u32 viewLength = 0;
+    i32 viewStride = 0;
+    const u8 *view = GetBufferView(ctx, (i32) JSON_Int(json, JSON_ObjectGet(json, token, "bufferView"), -1), &viewLength, &viewStride);
+    if (view == NULL) return false;
+
+    u32 offset = (u32) JSON_Int(json, JSON_ObjectGet(json, token, "byteOffset"), 0);
+    i32 elementSize = accessor->components * accessor->componentSize;
+    accessor->stride = (viewStride > 0) ? viewStride : elementSize;
+
+    // make sure the last element is inside the view
+    u64 lastByte = (u64) offset + (u64) accessor->stride * (u64) (accessor->count - 1) + (u64) elementSize;
+    if (lastByte > viewLength) return false;
+
+    accessor->data = view + offset;
+    return true;
+}
+
+static f32 ReadComponent(const struct GlbAccessor *accessor, const u8 *element, i32 component) {
+    const u8 *p = element + component * accessor->componentSize;
+    switch (accessor->componentType) {
+        case GLTF_FLOAT: {
+            f32 value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+        case GLTF_UNSIGNED_BYTE: {
+            u8 value = *p;
+            return accessor->normalized ? (f32) value / 255.0f : (f32) value;
+        }
+        case GLTF_BYTE: {
+            i8 value = (i8) *p;
+            if (!accessor->normalized) return (f32) value;
+            f32 v = (f32) value / 127.0f;
+            return (v < -1.0f) ? -1.0f : v;
+        }
+        case GLTF_UNSIGNED_SHORT: {
+            u16 value;
+            memcpy(&value, p, sizeof(value));
+            return accessor->normalized ? (f32) value / 65535.0f : (f32) value;
+        }
+        case GLTF_SHORT: {
+            i16 value;
+            memcpy(&value, p, sizeof(value));
+            if (!accessor->normalized) return (f32) value;
+            f32 v = (f32) value / 32767.0f;
+            return (v < -1.0f) ? -1.0f : v;
+        }
+        case GLTF_UNSIGNED_INT: {
+            u32 value;
+            memcpy(&value, p, sizeof(value));
+            return (f32) value;
+        }
+        default: return 0;
+    }
+}
+
+// read an attribute as floats, padding or truncating to the requested component count
+static f32 *ReadFloatAttribute(const struct GlbContext *ctx, i32 accessorIndex, i32 components, i32 expectedCount) {
+    struct GlbAccessor accessor;
+    if (!GetAccessor(ctx, accessorIndex, &accessor) || accessor.count != expectedCount) return NULL;
+
+    f32 *out = RL_MALLOC(accessor.count * components * sizeof(f32));
+    if (out == NULL) return NULL;
+
+    for (i32 i = 0; i < accessor.count; i++) {
+        const u8 *element = accessor.data + (size_t) i * accessor.stride;
+        for (i32 c = 0; c < components; c++) {
+            out[i * components + c] = (c < accessor.components) ? ReadComponent(&accessor, element, c) : 0.0f;
+        }
+    }
+    return out;
+}
+
+static u8 *ReadColorAttribute(const struct GlbContext *ctx, i32 accessorIndex, i32 expectedCount) {
+    struct GlbAccessor accessor;
+    if (!GetAccessor(ctx, accessorIndex, &accessor) || accessor.count != expectedCount) return NULL;
+    if (accessor.componentType != GLTF_FLOAT) accessor.normalized = true;
+
+    u8 *out = RL_MALLOC(accessor.count * 4);
+    if (out == NULL) return NULL;
+
+    for (i32 i = 0; i < accessor.count; i++) {
+        const u8 *element = accessor.data + (size_t) i * accessor.stride;
+        for (i32 c = 0; c < 4; c++) {
+            f32 value = (c < accessor.components) ? ReadComponent(&accessor, element, c) : 1.0f;
+            value = (value < 0) ? 0 : (value > 1) ? 1 : value;
+            out[i * 4 + c] = (u8) (value * 255.0f + 0.5f);
+        }
+    }
+    return out;
+}
+
+static unsigned short *ReadIndices(const struct GlbContext *ctx, i32 accessorIndex, i32 *count) {
+    struct GlbAccessor accessor;
+    if (!GetAccessor(ctx, accessorIndex, &accessor) || accessor.components != 1) return NULL;
+
+    unsigned short *out = RL_MALLOC(accessor.count * sizeof(unsigned short));
+    if (out == NULL) return NULL;
+
+    // NOTE - raylib meshes use 16 bit indices, same truncation as raylib's own glTF loader
+    for (i32 i = 0; i < accessor.count; i++) {
+        out[i] = (unsigned short) ReadComponent(&accessor, accessor.data + (size_t) i * accessor.stride, 0);
+    }
+    *count = accessor.count;
+    return out;
+}
+
+// NOTE - UnloadMesh() also releases GL objects, which must not happen off the main thread,
+//  so meshes that were never uploaded only get their CPU side arrays freed
+static void FreeMeshArrays(Mesh *mesh) {
+    RL_FREE(mesh->vertices);
+    RL_FREE(mesh->normals);
+    RL_FREE(mesh->texcoords);
+    RL_FREE(mesh->colors);
+    RL_FREE(mesh->indices);
+    *mesh = (Mesh) {0};
+}
+
+static b8 LoadPrimitive(const struct GlbContext *ctx, i32 primitive, Mesh *mesh, int *material) {
+    const JSON_Document *json = &ctx->json;
+    *mesh = (Mesh) {0};
+    *material = 0;
+
+    i64 mode = JSON_Int(json, JSON_ObjectGet(json, primitive, "mode"), GLTF_MODE_TRIANGLES);
+    if (mode != GLTF_MODE_TRIANGLES) return false;
+
+    i32 attributes = JSON_ObjectGet(json, primitive, "attributes");
+    i32 positionAccessor = (i32) JSON_Int(json, JSON_ObjectGet(json, attributes, "POSITION"), -1);
+
+    struct GlbAccessor positions;
+    if (!GetAccessor(ctx, positionAccessor, &positions)) return false;
+
+    mesh->vertexCount = positions.count;
+    mesh->vertices = ReadFloatAttribute(ctx, positionAccessor, 3, mesh->vertexCount);
+    if (mesh->vertices == NULL) return false;
+
+    i32 normal = JSON_ObjectGet(json, attributes, "NORMAL");
+    if (normal >= 0) mesh->normals = ReadFloatAttribute(ctx, (i32) JSON_Int(json, normal, -1), 3, mesh->vertexCount);
+
+    i32 texcoord = JSON_ObjectGet(json, attributes, "TEXCOORD_0");
+    if (texcoord >= 0) mesh->texcoords = ReadFloatAttribute(ctx, (i32) JSON_Int(json, texcoord, -1), 2, mesh->vertexCount);
+
+    i32 color = JSON_ObjectGet(json, attributes, "COLOR_0");
+    if (color >= 0) mesh->colors = ReadColorAttribute(ctx, (i32) JSON_Int(json, color, -1), mesh->vertexCount);
+
+    i32 indices = JSON_ObjectGet(json, primitive, "indices");
+    if (indices >= 0) {
+        i32 indexCount = 0;
+        mesh->indices = ReadIndices(ctx, (i32) JSON_Int(json, indices, -1), &indexCount);
+        mesh->triangleCount = indexCount / 3;
+    } else {
+        mesh->triangleCount = mesh->vertexCount / 3;
+    }
+
+    i64 materialIndex = JSON_Int(json, JSON_ObjectGet(json, primitive, "material"), -1);
+    *material = (materialIndex >= 0) ? (int) materialIndex + 1 : 0;
+    return true;
+}
+
+static Image LoadMaterialImage(const struct GlbContext *ctx, i32 textureIndex) {
+    const JSON_Document *json = &ctx->json;
+    i32 texture = JSON_ArrayGet(json, JSON_ObjectGet(json, ctx->root, "textures"), textureIndex);
+    i32 image = JSON_ArrayGet(json, JSON_ObjectGet(json, ctx->root, "images"), (i32) JSON_Int(json, JSON_ObjectGet(json, texture, "source"), -1));
+    if (image < 0) return (Image) {0};
+
+    // only embedded images, external uris aren't used by .glb content
+    u32 length = 0;
+    const u8 *bytes = GetBufferView(ctx, (i32) JSON_Int(json, JSON_ObjectGet(json, image, "bufferView"), -1), &length, NULL);
+    if (bytes == NULL) return (Image) {0};
+
+    const char *fileType = JSON_StringEquals(json, JSON_ObjectGet(json, image, "mimeType"), "image/jpeg") ? ".jpg" : ".png";
+    return LoadImageFromMemory(fileType, bytes, (int) length);
+}
+
+static void LoadMaterial(const struct GlbContext *ctx, i32 material, GLB_MaterialData *out) {
+    const JSON_Document *json = &ctx->json;
+    *out = (GLB_MaterialData) { .color = WHITE };
+
+    i32 pbr = JSON_ObjectGet(json, material, "pbrMetallicRoughness");
+    i32 factor = JSON_ObjectGet(json, pbr, "baseColorFactor");
+    if (JSON_Count(json, factor) == 4) {
+        f32 rgba[4];
+        for (i32 c = 0; c < 4; c++) {
+            f64 value = JSON_Number(json, JSON_ArrayGet(json, factor, c), 1.0);
+            rgba[c] = (f32) ((value < 0) ? 0 : (value > 1) ? 1 : value);
+        }
+        out->color = (Color) {
+                (unsigned char) (rgba[0] * 255.0f),
+                (unsigned char) (rgba[1] * 255.0f),
+                (unsigned char) (rgba[2] * 255.0f),
+                (unsigned char) (rgba[3] * 255.0f)
+        };
+    }
+
+    i32 baseColorTexture = JSON_ObjectGet(json, pbr, "baseColorTexture");
+    if (baseColorTexture >= 0) {
+        out->albedo = LoadMaterialImage(ctx, (i32) JSON_Int(json, JSON_ObjectGet(json, baseColorTexture, "index"), -1));
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+b8 GLB_LoadModelData(const char *fileName, GLB_ModelData *data) {
+    *data = (GLB_ModelData) {0};
+
+    unsigned int size = 0;
+    unsigned char *fileData = LoadFileData(fileName, &size);
+    if (fileData == NULL) return false;
+
+    b8 result = GLB_LoadModelDataFromMemory(fileData, size, data);
+    if (!result) {
+        TraceLog(LOG_WARNING, "GLB: [%s] Failed to parse model data", fileName);
+    }
+
+    UnloadFileData(fileData);
+    return result;
+}
+
+b8 GLB_LoadModelDataFromMemory(const u8 *fileData, u32 dataSize, GLB_ModelData *data) {
+    *data = (GLB_ModelData) {0};
+
+    if (dataSize < GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE) return false;
+    if (ReadU32(fileData) != GLB_MAGIC || ReadU32(fileData + 4) != 2) return false;
+
+    // JSON chunk is always first, the BIN chunk is optional
+    u32 jsonLength = ReadU32(fileData + GLB_HEADER_SIZE);
+    if (ReadU32(fileData + GLB_HEADER_SIZE + 4) != GLB_CHUNK_JSON) return false;
+    u32 jsonStart = GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE;
+    if ((u64) jsonStart + jsonLength > dataSize) return false;
+
+    struct GlbContext ctx = {0};
+    u32 binHeader = jsonStart + jsonLength;
+    if ((u64) binHeader + GLB_CHUNK_HEADER_SIZE <= dataSize && ReadU32(fileData + binHeader + 4) == GLB_CHUNK_BIN) {
+        ctx.binSize = ReadU32(fileData + binHeader);
+        ctx.bin = fileData + binHeader + GLB_CHUNK_HEADER_SIZE;
+        if ((u64) binHeader + GLB_CHUNK_HEADER_SIZE + ctx.binSize > dataSize) return false;
+    }
+
+    if (!JSON_Parse((const char *) fileData + jsonStart, (i32) jsonLength, &ctx.json)) return false;
+    ctx.root = 0;
+
+    const JSON_Document *json = &ctx.json;
+
+    // count primitives, each becomes a raylib mesh
+    i32 meshes = JSON_ObjectGet(json, ctx.root, "meshes");
+    i32 primitiveTotal = 0;
+    for (i32 i = 0; i < JSON_Count(json, meshes); i++) {
+        primitiveTotal += JSON_Count(json, JSON_ObjectGet(json, JSON_ArrayGet(json, meshes, i), "primitives"));
+    }
+
+    i32 materials = JSON_ObjectGet(json, ctx.root, "materials");
+    data->materialCount = JSON_Count(json, materials) + 1;
+    data->materials = RL_CALLOC(data->materialCount, sizeof(GLB_MaterialData));
+    data->meshes = RL_CALLOC((primitiveTotal > 0) ? primitiveTotal : 1, sizeof(Mesh));
+    data->meshMaterial = RL_CALLOC((primitiveTotal > 0) ? primitiveTotal : 1, sizeof(int));
+
+    data->materials[0] = (GLB_MaterialData) { .color = WHITE };
+    for (i32 i = 1; i < data->materialCount; i++) {
+        LoadMaterial(&ctx, JSON_ArrayGet(json, materials, i - 1), &data->materials[i]);
+    }
+
+    for (i32 i = 0; i < JSON_Count(json, meshes); i++) {
+        i32 primitives = JSON_ObjectGet(json, JSON_ArrayGet(json, meshes, i), "primitives");
+        for (i32 p = 0; p < JSON_Count(json, primitives); p++) {
+            Mesh *mesh = &data->meshes[data->meshCount];
+            int *material = &data->meshMaterial[data->meshCount];
+            if (LoadPrimitive(&ctx, JSON_ArrayGet(json, primitives, p), mesh, material)) {
+                if (*material >= data->materialCount) *material = 0;
+                data->meshCount++;
+            } else {
+                FreeMeshArrays(mesh);
+            }
+        }
+    }
+
+    JSON_Free(&ctx.json);
+
+    if (data->meshCount == 0) {
+        GLB_UnloadModelData(data);
+        return false;
+    }
+    return true;
+}
+
+void GLB_UnloadModelData(GLB_ModelData *data) {
+    for (int i = 0; i < data->meshCount; i++) {
+        if (data->meshes[i].vaoId != 0) UnloadMesh(data->meshes[i]);
+        else FreeMeshArrays(&data->meshes[i]);
+    }
+    for (int i = 0; i < data->materialCount; i++) {
+        if (data->materials[i].albedo.data != NULL) UnloadImage(data->materials[i].albedo);
+    }
+    RL_FREE(data->meshes);
+    RL_FREE(data->meshMaterial);
+    RL_FREE(data->materials);
+    *data = (GLB_ModelData) {0};
+}
+
+u64 GLB_ModelDataSize(const GLB_ModelData *data) {
+    u64 size = 0;
+    for (int i = 0; i < data->meshCount; i++) {
+        const Mesh *mesh = &data->meshes[i];
+        if (mesh->vertices)  size += (u64) mesh->vertexCount * 3 * sizeof(f32);
+        if (mesh->normals)   size += (u64) mesh->vertexCount * 3 * sizeof(f32);
+        if (mesh->texcoords) size += (u64) mesh->vertexCount * 2 * sizeof(f32);
+        if (mesh->colors)    size += (u64) mesh->vertexCount * 4;
+        if (mesh->indices)   size += (u64) mesh->triangleCount * 3 * sizeof(unsigned short);
+    }
+    for (int i = 0; i < data->materialCount; i++) {
+        const Image *image = &data->materials[i].albedo;
+        if (image->data) size += (u64) GetPixelDataSize(image->width, image->height, image->format);
+    }
+    return size;
+}
+
+Material GLB_MaterialFromData(const GLB_MaterialData *material, Texture2D albedo) {
+    Material result = LoadMaterialDefault();
+    result.maps[MATERIAL_MAP_DIFFUSE].color = material->color;
+    if (albedo.id != 0) result.maps[MATERIAL_MAP_DIFFUSE].texture = albedo;
+    return result;
+}
+
+Model GLB_UploadModelData(GLB_ModelData *data) {
+    Model model = {0};
+    model.transform = (Matrix) { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+    model.meshCount = data->meshCount;
+    model.meshes = data->meshes;
+    model.meshMaterial = data->meshMaterial;
+    for (int i = 0; i < model.meshCount; i++) {
+        UploadMesh(&model.meshes[i], false);
+    }
+
+    model.materialCount = data->materialCount;
+    model.materials = RL_CALLOC(model.materialCount, sizeof(Material));
+    for (int i = 0; i < model.materialCount; i++) {
+        GLB_MaterialData *material = &data->materials[i];
+        Texture2D albedo = {0};
+        if (material->albedo.data != NULL) {
+            albedo = LoadTextureFromImage(material->albedo);
+            UnloadImage(material->albedo);
+        }
+        model.materials[i] = GLB_MaterialFromData(material, albedo);
+    }
+    RL_FREE(data->materials);
+
+    *data = (GLB_ModelData) {0};
+    return model;
+}
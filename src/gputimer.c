@@ -0,0 +1,177 @@
+#include <string.h>
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#include "gputimer.h"
+
+// raylib's GL loader, only found when raylib is built from source (see CMakeLists.txt)
+#if defined(FIDDLE_GPU_TIMERS)
+#include "glad.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum GpuTimerConstExpr {
+    GPUTIMER_SLOTS = GPUTIMER_LATENCY + 1,
+};
+
+struct GpuTimerZoneSlot {
+    const char *name;
+    u32 depth;
+    b8 ended;
+};
+
+// one frame's worth of queries, two timestamps per zone
+struct GpuTimerFrame {
+    u32 queries[GPUTIMER_MAX_ZONES * 2];
+    struct GpuTimerZoneSlot zones[GPUTIMER_MAX_ZONES];
+    u32 zoneCount;
+    u64 frame;
+    b8 pending;                         // recorded, not read back yet
+};
+
+static struct GpuTimer {
+    b8 available;
+    char renderer[128];
+
+    struct GpuTimerFrame frames[GPUTIMER_SLOTS];
+    struct GpuTimerFrame *current;
+    u64 frame;
+    u32 depth;
+
+    GpuTimer_Zone results[GPUTIMER_MAX_ZONES];
+    u32 resultCount;
+    u64 resultFrame;
+} gpuTimer = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+#if defined(FIDDLE_GPU_TIMERS)
+static void Timestamp(u32 query) {
+    rlDrawRenderBatchActive();
+    glQueryCounter(query, GL_TIMESTAMP);
+}
+
+// blocks only if the GPU is more than GPUTIMER_LATENCY frames behind
+static void ReadBack(struct GpuTimerFrame *frame) {
+    GLuint64 origin = 0;
+    gpuTimer.resultCount = 0;
+    for (u32 i = 0; i < frame->zoneCount; i++) {
+        if (!frame->zones[i].ended) continue;
+
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame->queries[i * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame->queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+        if (gpuTimer.resultCount == 0) origin = begin;
+
+        gpuTimer.results[gpuTimer.resultCount++] = (GpuTimer_Zone) {
+                .name = frame->zones[i].name,
+                .depth = frame->zones[i].depth,
+                .start = (f64) (begin - origin) * 1e-9,
+                .duration = (end > begin) ? (f64) (end - begin) * 1e-9 : 0,
+        };
+    }
+    gpuTimer.resultFrame = frame->frame;
+    frame->pending = false;
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void GpuTimer_Init(void) {
+    memset(&gpuTimer, 0, sizeof(gpuTimer));
+
+#if defined(FIDDLE_GPU_TIMERS)
+    int version = rlGetVersion();
+    if ((version != RL_OPENGL_33 && version != RL_OPENGL_43) || glad_glQueryCounter == NULL) {
+        TraceLog(LOG_INFO, "GPUTIMER: Timer queries not supported, GPU times won't be available");
+        return;
+    }
+
+    const char *renderer = (const char *) glGetString(GL_RENDERER);
+    if (renderer != NULL) strncpy(gpuTimer.renderer, renderer, sizeof(gpuTimer.renderer) - 1);
+
+    for (u32 i = 0; i < GPUTIMER_SLOTS; i++) {
+        glGenQueries(GPUTIMER_MAX_ZONES * 2, gpuTimer.frames[i].queries);
+    }
+    gpuTimer.available = true;
+    TraceLog(LOG_INFO, "GPUTIMER: Timer queries on %s", gpuTimer.renderer);
+#endif
+}
+
+void GpuTimer_Shutdown(void) {
+#if defined(FIDDLE_GPU_TIMERS)
+    if (gpuTimer.available) {
+        for (u32 i = 0; i < GPUTIMER_SLOTS; i++) {
+            glDeleteQueries(GPUTIMER_MAX_ZONES * 2, gpuTimer.frames[i].queries);
+        }
+    }
+#endif
+    memset(&gpuTimer, 0, sizeof(gpuTimer));
+}
+
+b8 GpuTimer_IsAvailable(void) {
+    return gpuTimer.available;
+}
+
+const char *GpuTimer_Renderer(void) {
+    return gpuTimer.renderer;
+}
+
+void GpuTimer_BeginFrame(void) {
+    gpuTimer.frame++;
+    gpuTimer.depth = 0;
+    gpuTimer.current = NULL;
+    if (!gpuTimer.available) return;
+
+    // the slot about to be reused is the oldest frame in flight, its results are due
+    struct GpuTimerFrame *frame = &gpuTimer.frames[gpuTimer.frame % GPUTIMER_SLOTS];
+#if defined(FIDDLE_GPU_TIMERS)
+    if (frame->pending) ReadBack(frame);
+#endif
+
+    frame->zoneCount = 0;
+    frame->frame = gpuTimer.frame;
+    frame->pending = true;
+    gpuTimer.current = frame;
+}
+
+u32 GpuTimer_Begin(const char *name) {
+    struct GpuTimerFrame *frame = gpuTimer.current;
+    if (frame == NULL || frame->zoneCount >= GPUTIMER_MAX_ZONES) return GPUTIMER_INVALID_ZONE;
+
+    u32 zone = frame->zoneCount++;
+    frame->zones[zone] = (struct GpuTimerZoneSlot) { .name = name, .depth = gpuTimer.depth++ };
+#if defined(FIDDLE_GPU_TIMERS)
+    Timestamp(frame->queries[zone * 2]);
+#endif
+    return zone;
+}
+
+void GpuTimer_End(u32 zone) {
+    struct GpuTimerFrame *frame = gpuTimer.current;
+    if (frame == NULL || zone >= frame->zoneCount || frame->zones[zone].ended) return;
+
+    frame->zones[zone].ended = true;
+    if (gpuTimer.depth > 0) gpuTimer.depth--;
+#if defined(FIDDLE_GPU_TIMERS)
+    Timestamp(frame->queries[zone * 2 + 1]);
+#endif
+}
+
+u32 GpuTimer_Results(const GpuTimer_Zone **zones, u64 *frame) {
+    if (zones != NULL) *zones = gpuTimer.results;
+    if (frame != NULL) *frame = gpuTimer.resultFrame;
+    return gpuTimer.resultCount;
+}
+
+u64 GpuTimer_Frame(void) {
+    return gpuTimer.frame;
+}
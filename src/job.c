@@ -0,0 +1,552 @@
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+
+#include "job.h"
+#include "profiler.h"
+#include "thread.h"
+
+#if defined(_MSC_VER)
+    #define JOB_THREAD_LOCAL __declspec(thread)
+#else
+    #define JOB_THREAD_LOCAL _Thread_local
+#endif
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum JobConstExpr {
+    JOB_THREADS = JOB_MAX_WORKERS + 1,
+    JOB_DEQUE_MASK = JOB_DEQUE_CAPACITY - 1,
+    JOB_POOL_PROBES = 64,               // busy pool slots skipped before giving up and running inline
+    JOB_SPIN_ROUNDS = 64,               // empty searches before an idle worker goes to sleep
+    JOB_FOREIGN = -1,                   // thread index of threads that aren't job workers
+};
+
+struct Job {
+    Job_Func func;                      // one or the other
+    Job_RangeFunc rangeFunc;
+    void *arg;
+    u32 first;
+    u32 end;
+    u32 grain;
+    Job_Counter *counter;
+    struct Job *next;                   // in a counter's waiting list
+    atomic_uint busy;                   // taken from its pool until it has run
+};
+
+struct JobCounts {
+    atomic_ullong jobs;
+    atomic_ullong steals;
+    atomic_ullong inlined;
+};
+
+// Chase-Lev work stealing deque, fixed size (Le et al. 2013, "Correct and Efficient Work-Stealing for Weak
+// Memory Models"), top and bottom on their own cache lines since thieves hammer one and the owner the other
+struct JobDeque {
+    _Alignas(64) _Atomic i64 top;
+    _Alignas(64) _Atomic i64 bottom;
+    _Atomic(struct Job *) *buffer;
+};
+
+struct JobThread {
+    struct JobDeque deque;
+    struct Job *pool;                   // jobs this thread adds, reused once they've run
+    u32 poolNext;
+    struct JobCounts counts;
+    Thread thread;
+};
+
+static struct JobScheduler {
+    b8 initialized;
+    u32 threadCount;                    // deques, the main thread's included
+    u32 workerCount;                    // worker threads that actually started
+    struct JobThread threads[JOB_THREADS];
+
+    // jobs added from threads that aren't job workers, and the pool they come from, both under the mutex
+    Mutex mutex;
+    struct Job *foreignPool;
+    u32 foreignPoolNext;
+    struct Job *foreignQueue[JOB_DEQUE_CAPACITY];
+    u32 foreignHead;
+    atomic_uint foreignCount;
+    struct JobCounts foreignCounts;
+
+    // idle workers sleep while nothing is queued
+    CondVar workAvailable;
+    atomic_uint queued;
+    atomic_uint sleeping;
+    atomic_bool quit;
+} scheduler = {0};
+
+static JOB_THREAD_LOCAL i32 threadIndex = JOB_FOREIGN;
+static JOB_THREAD_LOCAL u32 stealSeed = 0;
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static b8 DequePush(struct JobDeque *deque, struct Job *job) {
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= JOB_DEQUE_CAPACITY) return false;
+
+    atomic_store_explicit(&deque->buffer[bottom & JOB_DEQUE_MASK], job, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return true;
+}
+
+// owner only, newest first
+static struct Job *DequePop(struct JobDeque *deque) {
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    struct Job *job = atomic_load_explicit(&deque->buffer[bottom & JOB_DEQUE_MASK], memory_order_relaxed);
+    if (top == bottom) {
+        // the last job, a thief may be after it too
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed)) {
+            job = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+// any thread, oldest first, NULL when empty or when another thief got there first
+static struct Job *DequeSteal(struct JobDeque *deque) {
+    i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) return NULL;
+
+    struct Job *job = atomic_load_explicit(&deque->buffer[top & JOB_DEQUE_MASK], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+    return job;
+}
+
+static struct JobCounts *CountsFor(i32 self) {
+    return (self >= 0) ? &scheduler.threads[self].counts : &scheduler.foreignCounts;
+}
+
+static void Count(atomic_ullong *count) {
+    atomic_fetch_add_explicit(count, 1, memory_order_relaxed);
+}
+
+static struct Job *ProbePool(struct Job *pool, u32 *next) {
+    for (u32 probe = 0; probe < JOB_POOL_PROBES; probe++) {
+        struct Job *job = &pool[(*next)++ & JOB_DEQUE_MASK];
+        if (!atomic_load_explicit(&job->busy, memory_order_acquire)) {
+            atomic_store_explicit(&job->busy, 1, memory_order_relaxed);
+            return job;
+        }
+    }
+    return NULL;
+}
+
+// NULL when the calling thread has too many jobs in flight
+static struct Job *AllocJob(void) {
+    i32 self = threadIndex;
+    if (self >= 0) {
+        struct JobThread *thread = &scheduler.threads[self];
+        return ProbePool(thread->pool, &thread->poolNext);
+    }
+
+    Mutex_Lock(&scheduler.mutex);
+    struct Job *job = ProbePool(scheduler.foreignPool, &scheduler.foreignPoolNext);
+    Mutex_Unlock(&scheduler.mutex);
+    return job;
+}
+
+static void FreeJob(struct Job *job) {
+    atomic_store_explicit(&job->busy, 0, memory_order_release);
+}
+
+// false when the calling thread's queue is full
+static b8 Enqueue(struct Job *job) {
+    // counted before it can be taken, so the count never dips below what's really there
+    atomic_fetch_add(&scheduler.queued, 1);
+
+    i32 self = threadIndex;
+    b8 queued = false;
+    if (self >= 0) {
+        queued = DequePush(&scheduler.threads[self].deque, job);
+    } else {
+        Mutex_Lock(&scheduler.mutex);
+        u32 count = atomic_load_explicit(&scheduler.foreignCount, memory_order_relaxed);
+        if (count < JOB_DEQUE_CAPACITY) {
+            scheduler.foreignQueue[(scheduler.foreignHead + count) & JOB_DEQUE_MASK] = job;
+            atomic_store_explicit(&scheduler.foreignCount, count + 1, memory_order_relaxed);
+            queued = true;
+        }
+        Mutex_Unlock(&scheduler.mutex);
+    }
+
+    if (!queued) {
+        atomic_fetch_sub(&scheduler.queued, 1);
+        return false;
+    }
+
+    // a worker going to sleep bumps sleeping before it checks queued, so one of the two sees the other
+    if (atomic_load(&scheduler.sleeping) > 0) {
+        Mutex_Lock(&scheduler.mutex);
+        CondVar_Signal(&scheduler.workAvailable);
+        Mutex_Unlock(&scheduler.mutex);
+    }
+    return true;
+}
+
+static struct Job *FindJob(i32 self) {
+    struct Job *job = NULL;
+    if (self >= 0) {
+        job = DequePop(&scheduler.threads[self].deque);
+    }
+
+    if (job == NULL && atomic_load_explicit(&scheduler.foreignCount, memory_order_relaxed) > 0) {
+        Mutex_Lock(&scheduler.mutex);
+        u32 count = atomic_load_explicit(&scheduler.foreignCount, memory_order_relaxed);
+        if (count > 0) {
+            job = scheduler.foreignQueue[scheduler.foreignHead++ & JOB_DEQUE_MASK];
+            atomic_store_explicit(&scheduler.foreignCount, count - 1, memory_order_relaxed);
+        }
+        Mutex_Unlock(&scheduler.mutex);
+    }
+
+    if (job == NULL) {
+        // xorshift, a different starting victim each time keeps thieves from piling onto the same deque
+        if (stealSeed == 0) stealSeed = (u32) (uintptr_t) &stealSeed | 1;
+        stealSeed ^= stealSeed << 13;
+        stealSeed ^= stealSeed >> 17;
+        stealSeed ^= stealSeed << 5;
+        u32 start = stealSeed % scheduler.threadCount;
+        for (u32 i = 0; i < scheduler.threadCount && job == NULL; i++) {
+            u32 victim = (start + i) % scheduler.threadCount;
+            if ((i32) victim == self) continue;
+            job = DequeSteal(&scheduler.threads[victim].deque);
+        }
+        if (job != NULL) Count(&CountsFor(self)->steals);
+    }
+
+    if (job != NULL) atomic_fetch_sub(&scheduler.queued, 1);
+    return job;
+}
+
+static void LockCounter(Job_Counter *counter) {
+    while (atomic_exchange_explicit(&counter->lock, 1, memory_order_acquire)) {
+        Thread_Yield();
+    }
+}
+
+static void UnlockCounter(Job_Counter *counter) {
+    atomic_store_explicit(&counter->lock, 0, memory_order_release);
+}
+
+static void Execute(struct Job *job);
+
+static void RunRange(Job_RangeFunc func, void *arg, u32 first, u32 end, u32 grain) {
+    for (u32 piece = first; piece < end; piece += grain) {
+        func(arg, piece, (end - piece > grain) ? piece + grain : end);
+    }
+}
+
+// one job of a counter is done, the last one lets the jobs waiting on it go
+static void FinishJob(Job_Counter *counter) {
+    if (counter == NULL) return;
+
+    u32 pending = atomic_load(&counter->pending);
+    while (pending > 1) {
+        if (atomic_compare_exchange_weak(&counter->pending, &pending, pending - 1)) return;
+    }
+
+    // probably the last one, dropped under the lock so a waiter can't see zero and let the counter go out of
+    // scope while it's still being looked at here, see Job_IsDone()
+    LockCounter(counter);
+    struct Job *released = NULL;
+    if (atomic_fetch_sub(&counter->pending, 1) == 1) {
+        released = counter->waiting;
+        counter->waiting = NULL;
+    }
+    UnlockCounter(counter);
+
+    while (released != NULL) {
+        struct Job *next = released->next;
+        if (!Enqueue(released)) {
+            Count(&CountsFor(threadIndex)->inlined);
+            Execute(released);
+        }
+        released = next;
+    }
+}
+
+static void Execute(struct Job *job) {
+    if (job->rangeFunc != NULL) {
+        Job_RangeFunc func = job->rangeFunc;
+        u32 first = job->first;
+        u32 end = job->end;
+
+        // push the back half for someone else until what's left is one piece
+        while (end - first > job->grain) {
+            struct Job *half = AllocJob();
+            if (half == NULL) break;
+
+            u32 middle = first + (end - first) / 2;
+            half->func = NULL;
+            half->rangeFunc = func;
+            half->arg = job->arg;
+            half->first = middle;
+            half->end = end;
+            half->grain = job->grain;
+            half->counter = job->counter;
+            half->next = NULL;
+            if (half->counter != NULL) atomic_fetch_add(&half->counter->pending, 1);
+            if (!Enqueue(half)) {
+                // this job still holds the counter up, it can't reach zero here
+                if (half->counter != NULL) atomic_fetch_sub(&half->counter->pending, 1);
+                FreeJob(half);
+                break;
+            }
+            end = middle;
+        }
+        RunRange(func, job->arg, first, end, job->grain);
+    } else {
+        job->func(job->arg);
+    }
+
+    Job_Counter *counter = job->counter;
+    FreeJob(job);
+    Count(&CountsFor(threadIndex)->jobs);
+    FinishJob(counter);
+}
+
+// fills in and queues a job, or runs it right here when that's not possible
+static void Submit(Job_Func func, Job_RangeFunc rangeFunc, void *arg, u32 first, u32 end, u32 grain,
+                   Job_Counter *counter) {
+    if (counter != NULL) atomic_fetch_add(&counter->pending, 1);
+
+    struct Job *job = scheduler.initialized ? AllocJob() : NULL;
+    if (job != NULL) {
+        job->func = func;
+        job->rangeFunc = rangeFunc;
+        job->arg = arg;
+        job->first = first;
+        job->end = end;
+        job->grain = grain;
+        job->counter = counter;
+        job->next = NULL;
+        if (Enqueue(job)) return;
+        FreeJob(job);
+    }
+
+    if (scheduler.initialized) Count(&CountsFor(threadIndex)->inlined);
+    if (rangeFunc != NULL) {
+        RunRange(rangeFunc, arg, first, end, grain);
+    } else {
+        func(arg);
+    }
+    FinishJob(counter);
+}
+
+static int WorkerMain(void *arg) {
+    threadIndex = (i32) (intptr_t) arg;
+    Profiler_SetThreadName("jobs");
+
+    u32 idle = 0;
+    while (!atomic_load(&scheduler.quit)) {
+        struct Job *job = FindJob(threadIndex);
+        if (job != NULL) {
+            Execute(job);
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < JOB_SPIN_ROUNDS) {
+            Thread_Yield();
+            continue;
+        }
+
+        Mutex_Lock(&scheduler.mutex);
+        atomic_fetch_add(&scheduler.sleeping, 1);
+        while (!atomic_load(&scheduler.quit) && atomic_load(&scheduler.queued) == 0) {
+            CondVar_Wait(&scheduler.workAvailable, &scheduler.mutex);
+        }
+        atomic_fetch_sub(&scheduler.sleeping, 1);
+        Mutex_Unlock(&scheduler.mutex);
+        idle = 0;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void Job_Init(int workerCount) {
+    if (scheduler.initialized) return;
+
+    if (workerCount < 0) workerCount = Thread_HardwareConcurrency() - 1;
+    if (workerCount < 0) workerCount = 0;
+    if (workerCount > JOB_MAX_WORKERS) workerCount = JOB_MAX_WORKERS;
+
+    memset(&scheduler, 0, sizeof(scheduler));
+    scheduler.threadCount = (u32) workerCount + 1;
+    for (u32 i = 0; i < scheduler.threadCount; i++) {
+        struct JobThread *thread = &scheduler.threads[i];
+        thread->deque.buffer = calloc(JOB_DEQUE_CAPACITY, sizeof(thread->deque.buffer[0]));
+        thread->pool = calloc(JOB_DEQUE_CAPACITY, sizeof(struct Job));
+        if (thread->deque.buffer == NULL || thread->pool == NULL) {
+            // fewer workers then
+            free(thread->deque.buffer);
+            free(thread->pool);
+            scheduler.threadCount = i;
+            break;
+        }
+    }
+    scheduler.foreignPool = calloc(JOB_DEQUE_CAPACITY, sizeof(struct Job));
+    if (scheduler.threadCount == 0 || scheduler.foreignPool == NULL) {
+        TraceLog(LOG_WARNING, "JOB: Out of memory, jobs will run where they're added");
+        for (u32 i = 0; i < scheduler.threadCount; i++) {
+            free(scheduler.threads[i].deque.buffer);
+            free(scheduler.threads[i].pool);
+        }
+        free(scheduler.foreignPool);
+        memset(&scheduler, 0, sizeof(scheduler));
+        return;
+    }
+
+    Mutex_Init(&scheduler.mutex);
+    CondVar_Init(&scheduler.workAvailable);
+    threadIndex = 0;
+    scheduler.initialized = true;
+
+    for (u32 i = 1; i < scheduler.threadCount; i++) {
+        if (!Thread_Create(&scheduler.threads[i].thread, WorkerMain, (void *) (intptr_t) i)) break;
+        scheduler.workerCount++;
+    }
+    TraceLog(LOG_INFO, "JOB: Started %u worker threads", scheduler.workerCount);
+}
+
+void Job_Shutdown(void) {
+    if (!scheduler.initialized) return;
+
+    Mutex_Lock(&scheduler.mutex);
+    atomic_store(&scheduler.quit, true);
+    CondVar_Broadcast(&scheduler.workAvailable);
+    Mutex_Unlock(&scheduler.mutex);
+
+    for (u32 i = 1; i <= scheduler.workerCount; i++) {
+        Thread_Join(&scheduler.threads[i].thread);
+    }
+
+    for (u32 i = 0; i < scheduler.threadCount; i++) {
+        free(scheduler.threads[i].deque.buffer);
+        free(scheduler.threads[i].pool);
+    }
+    free(scheduler.foreignPool);
+    CondVar_Destroy(&scheduler.workAvailable);
+    Mutex_Destroy(&scheduler.mutex);
+    memset(&scheduler, 0, sizeof(scheduler));
+    threadIndex = JOB_FOREIGN;
+}
+
+u32 Job_WorkerCount(void) {
+    return scheduler.workerCount;
+}
+
+void Job_Run(Job_Func func, void *arg, Job_Counter *counter) {
+    Submit(func, NULL, arg, 0, 0, 0, counter);
+}
+
+void Job_RunAfter(Job_Counter *dependency, Job_Func func, void *arg, Job_Counter *counter) {
+    if (dependency == NULL || !scheduler.initialized) {
+        // without workers everything added so far has already run, the dependency included
+        Job_Run(func, arg, counter);
+        return;
+    }
+
+    struct Job *job = AllocJob();
+    if (job == NULL) {
+        Count(&CountsFor(threadIndex)->inlined);
+        Job_Wait(dependency);
+        Job_Run(func, arg, counter);
+        return;
+    }
+
+    if (counter != NULL) atomic_fetch_add(&counter->pending, 1);
+    job->func = func;
+    job->rangeFunc = NULL;
+    job->arg = arg;
+    job->counter = counter;
+
+    // the last job of the dependency takes the waiting list under the same lock, so this either parks the job
+    // before that happens or sees the dependency done
+    LockCounter(dependency);
+    b8 parked = atomic_load(&dependency->pending) > 0;
+    if (parked) {
+        job->next = dependency->waiting;
+        dependency->waiting = job;
+    }
+    UnlockCounter(dependency);
+
+    if (!parked) {
+        job->next = NULL;
+        if (!Enqueue(job)) {
+            Count(&CountsFor(threadIndex)->inlined);
+            Execute(job);
+        }
+    }
+}
+
+void Job_ParallelFor(Job_RangeFunc func, void *arg, u32 count, u32 grain, Job_Counter *counter) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+    Submit(NULL, func, arg, 0, count, grain, counter);
+}
+
+void Job_Wait(Job_Counter *counter) {
+    if (counter == NULL) return;
+
+    i32 self = threadIndex;
+    while (!Job_IsDone(counter)) {
+        struct Job *job = scheduler.initialized ? FindJob(self) : NULL;
+        if (job != NULL) {
+            Execute(job);
+        } else {
+            Thread_Yield();
+        }
+    }
+}
+
+b8 Job_IsDone(Job_Counter *counter) {
+    // zero isn't enough, the thread that got it there may still hold the lock, see FinishJob()
+    return atomic_load_explicit(&counter->pending, memory_order_acquire) == 0
+        && atomic_load_explicit(&counter->lock, memory_order_acquire) == 0;
+}
+
+Job_Stats Job_GetStats(void) {
+    Job_Stats stats = { .workers = scheduler.workerCount };
+    for (u32 i = 0; i < scheduler.threadCount; i++) {
+        const struct JobCounts *counts = &scheduler.threads[i].counts;
+        stats.jobs += atomic_load_explicit(&counts->jobs, memory_order_relaxed);
+        stats.steals += atomic_load_explicit(&counts->steals, memory_order_relaxed);
+        stats.inlined += atomic_load_explicit(&counts->inlined, memory_order_relaxed);
+    }
+    stats.jobs += atomic_load_explicit(&scheduler.foreignCounts.jobs, memory_order_relaxed);
+    stats.steals += atomic_load_explicit(&scheduler.foreignCounts.steals, memory_order_relaxed);
+    stats.inlined += atomic_load_explicit(&scheduler.foreignCounts.inlined, memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,189 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "json.h"
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+enum JsonConstExpr {
+    JSON_MAX_DEPTH = 128,
+    JSON_INITIAL_TOKENS = 256,
+};
+
+static i32 PushToken(JSON_Document *doc, enum JSON_Type type, i32 start, i32 end) {
+    if (doc->count == doc->capacity) {
+        i32 capacity = (doc->capacity == 0) ? JSON_INITIAL_TOKENS : doc->capacity * 2;
+        JSON_Token *tokens = realloc(doc->tokens, capacity * sizeof(JSON_Token));
+        if (tokens == NULL) return -1;
+        doc->tokens = tokens;
+        doc->capacity = capacity;
+    }
+
+    i32 index = doc->count++;
+    doc->tokens[index] = (JSON_Token) {
+            .type = type,
+            .start = start,
+            .end = end,
+            .size = 0,
+            .subtreeEnd = index + 1
+    };
+    return index;
+}
+
+static b8 IsWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static b8 IsDelimiter(char c) {
+    return IsWhitespace(c) || c == ',' || c == ':' || c == ']' || c == '}';
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+b8 JSON_Parse(const char *text, i32 length, JSON_Document *doc) {
+    *doc = (JSON_Document) { .text = text };
+
+    i32 stack[JSON_MAX_DEPTH];
+    i32 depth = 0;
+    char lastSignificant = 0;
+
+    for (i32 pos = 0; pos < length; pos++) {
+        char c = text[pos];
+        if (IsWhitespace(c)) continue;
+
+        i32 parent = (depth > 0) ? stack[depth - 1] : -1;
+        enum JSON_Type parentType = (parent >= 0) ? doc->tokens[parent].type : JSON_Type_Null;
+
+        switch (c) {
+            case '{':
+            case '[': {
+                if (depth == JSON_MAX_DEPTH) goto fail;
+                i32 token = PushToken(doc, (c == '{') ? JSON_Type_Object : JSON_Type_Array, pos, pos);
+                if (token < 0) goto fail;
+                if (parentType == JSON_Type_Array) doc->tokens[parent].size++;
+                stack[depth++] = token;
+            } break;
+
+            case '}':
+            case ']': {
+                if (depth == 0) goto fail;
+                i32 token = stack[--depth];
+                if (doc->tokens[token].type != ((c == '}') ? JSON_Type_Object : JSON_Type_Array)) goto fail;
+                doc->tokens[token].end = pos + 1;
+                doc->tokens[token].subtreeEnd = doc->count;
+            } break;
+
+            case '"': {
+                i32 start = pos + 1;
+                for (pos = start; pos < length && text[pos] != '"'; pos++) {
+                    if (text[pos] == '\\') pos++;
+                }
+                if (pos >= length) goto fail;
+
+                i32 token = PushToken(doc, JSON_Type_String, start, pos);
+                if (token < 0) goto fail;
+
+                // object sizes count keys, a string right after '{' or ',' inside an object is a key
+                b8 isKey = (parentType == JSON_Type_Object) && (lastSignificant == '{' || lastSignificant == ',');
+                if (parentType == JSON_Type_Array || isKey) doc->tokens[parent].size++;
+            } break;
+
+            case ':':
+            case ',':
+                break;
+
+            default: {
+                i32 start = pos;
+                while (pos < length && !IsDelimiter(text[pos])) pos++;
+
+                enum JSON_Type type = JSON_Type_Number;
+                if (c == 't' || c == 'f') type = JSON_Type_Bool;
+                else if (c == 'n') type = JSON_Type_Null;
+                else if (c != '-' && (c < '0' || c > '9')) goto fail;
+
+                if (PushToken(doc, type, start, pos) < 0) goto fail;
+                if (parentType == JSON_Type_Array) doc->tokens[parent].size++;
+
+                // step back so the delimiter is seen by the next iteration
+                pos--;
+                c = text[pos];
+            } break;
+        }
+
+        lastSignificant = c;
+    }
+
+    if (depth != 0 || doc->count == 0) goto fail;
+    return true;
+
+fail:
+    JSON_Free(doc);
+    return false;
+}
+
+void JSON_Free(JSON_Document *doc) {
+    free(doc->tokens);
+    *doc = (JSON_Document) {0};
+}
+
+i32 JSON_ObjectGet(const JSON_Document *doc, i32 object, const char *key) {
+    if (object < 0 || object >= doc->count || doc->tokens[object].type != JSON_Type_Object) return -1;
+
+    i32 end = doc->tokens[object].subtreeEnd;
+    for (i32 i = object + 1; i < end;) {
+        i32 value = doc->tokens[i].subtreeEnd;
+        if (value >= end) break;
+        if (JSON_StringEquals(doc, i, key)) return value;
+        i = doc->tokens[value].subtreeEnd;
+    }
+    return -1;
+}
+
+i32 JSON_ArrayGet(const JSON_Document *doc, i32 array, i32 index) {
+    if (array < 0 || array >= doc->count || doc->tokens[array].type != JSON_Type_Array) return -1;
+    if (index < 0 || index >= doc->tokens[array].size) return -1;
+
+    i32 token = array + 1;
+    for (i32 i = 0; i < index; i++) {
+        token = doc->tokens[token].subtreeEnd;
+    }
+    return token;
+}
+
+i32 JSON_Count(const JSON_Document *doc, i32 token) {
+    if (token < 0 || token >= doc->count) return 0;
+    return doc->tokens[token].size;
+}
+
+f64 JSON_Number(const JSON_Document *doc, i32 token, f64 fallback) {
+    if (token < 0 || token >= doc->count || doc->tokens[token].type != JSON_Type_Number) return fallback;
+
+    // NOTE - tokens aren't null terminated, copy into a small buffer for strtod
+    char buffer[64];
+    i32 length = doc->tokens[token].end - doc->tokens[token].start;
+    if (length >= (i32) sizeof(buffer)) return fallback;
+    memcpy(buffer, doc->text + doc->tokens[token].start, length);
+    buffer[length] = '\0';
+    return strtod(buffer, NULL);
+}
+
+i64 JSON_Int(const JSON_Document *doc, i32 token, i64 fallback) {
+    if (token < 0 || token >= doc->count || doc->tokens[token].type != JSON_Type_Number) return fallback;
+    return (i64) JSON_Number(doc, token, (f64) fallback);
+}
+
+b8 JSON_Bool(const JSON_Document *doc, i32 token, b8 fallback) {
+    if (token < 0 || token >= doc->count || doc->tokens[token].type != JSON_Type_Bool) return fallback;
+    return doc->text[doc->tokens[token].start] == 't';
+}
+
+b8 JSON_StringEquals(const JSON_Document *doc, i32 token, const char *string) {
+    if (token < 0 || token >= doc->count || doc->tokens[token].type != JSON_Type_String) return false;
+
+    i32 length = doc->tokens[token].end - doc->tokens[token].start;
+    return (i32) strlen(string) == length && memcmp(doc->text + doc->tokens[token].start, string, length) == 0;
+}
@@ -0,0 +1,127 @@
+#include "raylib.h"
+
+#include "level.h"
+#include "occlusion.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+static const f32 LEVEL_GROUND_SIZE = 50;
+static const f32 LEVEL_TREE_SPACING = 4;
+static const f32 LEVEL_WALL_TILE_SIZE = 6;
+static const f32 LEVEL_WALL_HEIGHT = 4;
+
+const u8 Level_StartingRoom[MAP_SIZE * MAP_SIZE] = {
+        1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 0, 0, 0, 0, 0, 0, 0, 1,
+        1, 0, 0, 3, 0, 0, 0, 4, 1,
+        1, 0, 0, 0, 0, 0, 0, 0, 1,
+        1, 0, 0, 0, 0, 0, 0, 4, 1,
+        1, 0, 2, 0, 0, 0, 0, 0, 1,
+        1, 0, 0, 0, 0, 0, 0, 0, 1,
+        1, 0, 0, 0, 0, 0, 0, 0, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1,
+};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static void PushBox(Level_Box *boxes, u32 maxBoxes, u32 *count, Level_Box box) {
+    if (*count < maxBoxes) boxes[*count] = box;
+    (*count)++;
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+u32 Level_StaticBoxes(const u8 *map, Level_Box *boxes, u32 maxBoxes) {
+    u32 count = 0;
+
+    PushBox(boxes, maxBoxes, &count, (Level_Box) {
+            .center = { 0, 0, 0 },
+            .size = { LEVEL_GROUND_SIZE, 0, LEVEL_GROUND_SIZE },
+            .color = BEIGE,
+            .kind = Level_Box_Ground
+    });
+
+    // a grid of cube trees centered on the origin
+    const f32 extent = (LEVEL_TREES_PER_SIDE - 1) / 2 * LEVEL_TREE_SPACING;
+    for (u32 i = 0; i < LEVEL_TREES_PER_SIDE; i++) {
+        for (u32 j = 0; j < LEVEL_TREES_PER_SIDE; j++) {
+            f32 x = -extent + (f32) i * LEVEL_TREE_SPACING;
+            f32 z = -extent + (f32) j * LEVEL_TREE_SPACING;
+            PushBox(boxes, maxBoxes, &count, (Level_Box) {
+                    .center = { x, 1.5f, z },
+                    .size = { 1, 1, 1 },
+                    .color = LIME,
+                    .kind = Level_Box_TreeTrunk
+            });
+            PushBox(boxes, maxBoxes, &count, (Level_Box) {
+                    .center = { x, 0.5f, z },
+                    .size = { 0.25f, 1, 0.25f },
+                    .color = BROWN,
+                    .kind = Level_Box_TreeCanopy
+            });
+        }
+    }
+
+    // the starting room's walls around the trees, centered on them, blue like the overhead map's walls
+    Rectangle runs[MAX_SCENE_WALLS];
+    u32 runCount = Occlusion_MergeTiles(map, MAP_SIZE, MAP_SIZE, 1, runs, MAX_SCENE_WALLS);
+    if (runCount > MAX_SCENE_WALLS) {
+        TraceLog(LOG_WARNING, "LEVEL: Wall limit (%i) reached, %u runs of wall tiles", MAX_SCENE_WALLS, runCount);
+        runCount = MAX_SCENE_WALLS;
+    }
+
+    const f32 origin = -0.5f * MAP_SIZE * LEVEL_WALL_TILE_SIZE;
+    for (u32 i = 0; i < runCount; i++) {
+        PushBox(boxes, maxBoxes, &count, (Level_Box) {
+                .center = {
+                        origin + (runs[i].x + runs[i].width / 2) * LEVEL_WALL_TILE_SIZE,
+                        LEVEL_WALL_HEIGHT / 2,
+                        origin + (runs[i].y + runs[i].height / 2) * LEVEL_WALL_TILE_SIZE
+                },
+                .size = { runs[i].width * LEVEL_WALL_TILE_SIZE, LEVEL_WALL_HEIGHT, runs[i].height * LEVEL_WALL_TILE_SIZE },
+                .color = BLUE,
+                .kind = Level_Box_Wall
+        });
+    }
+
+    return count;
+}
+
+u32 Level_StaticLights(Cluster_Light *lights, u32 maxLights) {
+    u32 count = 0;
+
+    const Color colors[] = { YELLOW, RED, GREEN, BLUE };
+    const Vector3 positions[] = { { -2, 1, -2 }, { 2, 1, 2 }, { -2, 1, 2 }, { 2, 1, -2 } };
+    for (int i = 0; i < 4; i++, count++) {
+        if (count >= maxLights) continue;
+        lights[count] = (Cluster_Light) { .position = positions[i], .radius = 100, .color = colors[i], .intensity = 1 };
+    }
+
+    const Color treeColors[] = { GOLD, PINK, SKYBLUE, VIOLET, LIME, ORANGE };
+    const f32 extent = (LEVEL_TREES_PER_SIDE - 1) / 2 * LEVEL_TREE_SPACING;
+    u32 index = 0;
+    for (u32 i = 0; i + 1 < LEVEL_TREES_PER_SIDE; i++) {
+        for (u32 j = 0; j + 1 < LEVEL_TREES_PER_SIDE; j++, count++) {
+            Color color = treeColors[index++ % (sizeof(treeColors) / sizeof(treeColors[0]))];
+            if (count >= maxLights) continue;
+            lights[count] = (Cluster_Light) {
+                    .position = {
+                            -extent + ((f32) i + 0.5f) * LEVEL_TREE_SPACING,
+                            0.5f,
+                            -extent + ((f32) j + 0.5f) * LEVEL_TREE_SPACING
+                    },
+                    .radius = 3,
+                    .color = color,
+                    .intensity = 2
+            };
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,771 @@
+#include <float.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "lightmap.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum LightmapConstExpr {
+    LIGHTMAP_VERSION = 1,
+    LIGHTMAP_GUTTER = 1,                // texels around each chart
+    LIGHTMAP_MIN_WIDTH = 64,
+    LIGHTMAP_BVH_LEAF_SIZE = 2,
+    LIGHTMAP_BVH_STACK = 64,
+};
+
+static const char LIGHTMAP_MAGIC[4] = { 'F', 'L', 'M', 'P' };
+static const f32 LIGHTMAP_RAY_OFFSET = 1e-3f;   // rays start this far off the surface so they don't hit it again
+
+// faces are numbered axis * 2, + 1 on the positive side, each spans the other two axes as (u, v)
+static const u8 LIGHTMAP_FACE_AXES[3][2] = { { 2, 1 }, { 0, 2 }, { 0, 1 } };
+
+// stored as is in the file
+struct LightmapChart {
+    u32 box;
+    u32 face;
+    u32 x, y;                           // first texel inside the gutter
+    u32 width, height;
+};
+
+struct LightmapFileHeader {
+    char magic[4];
+    u32 version;
+    u64 levelHash;
+    u32 width, height;
+    u32 boxCount;
+    u32 chartCount;
+    // followed by a Vector3 size per box, the charts and width * height RGBM texels
+};
+
+struct Lightmap {
+    u32 width, height;
+    u32 boxCount, chartCount;
+    Vector3 *sizes;
+    struct LightmapChart *charts;
+    u8 *texels;
+};
+
+// a box face, its points are origin + u * s + v * t for s, t in [0, 1]
+struct LightmapFace {
+    Vector3 origin, u, v;
+    Vector3 normal;
+};
+
+struct LightmapNode {
+    Vector3 min, max;
+    u32 first;                          // leaves: first entry in boxOrder, inner nodes: left child, right follows it
+    u32 count;                          // boxes in a leaf, 0 for inner nodes
+};
+
+struct LightmapRay {
+    Vector3 origin, direction, inverse;
+};
+
+struct LightmapHit {
+    f32 t;                              // 0 when the ray started inside the box
+    u32 box;
+    Vector3 normal;
+};
+
+struct Lightmap_Baker {
+    Lightmap_BakeDesc desc;             // boxes and lights point at the copies
+    u64 levelHash;
+
+    Vector3 *boxMin, *boxMax;
+    Vector3 *albedo;
+
+    u32 width, height;
+    struct LightmapChart *charts;
+    struct LightmapFace *faces;         // world space, per chart
+    u32 chartCount;
+    u32 *texelCharts;                   // chart + 1 for texels inside a chart, 0 for gutters and unused texels
+    Vector3 *texels;                    // linear light
+
+    struct LightmapNode *nodes;
+    u32 nodeCount;
+    u32 *boxOrder;
+
+    atomic_ullong texelsBaked;
+    atomic_ullong samples;
+    atomic_ullong rays;
+};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u64 HashBytes(u64 hash, const void *data, u64 size) {
+    // FNV-1a
+    const u8 *bytes = data;
+    for (u64 i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static f32 Component(Vector3 v, u32 axis) {
+    return (axis == 0) ? v.x : (axis == 1) ? v.y : v.z;
+}
+
+static Vector3 WithComponent(Vector3 v, u32 axis, f32 value) {
+    if (axis == 0) v.x = value;
+    else if (axis == 1) v.y = value;
+    else v.z = value;
+    return v;
+}
+
+static struct LightmapFace BoxFace(Vector3 min, Vector3 max, u32 face) {
+    u32 axis = face / 2;
+    u32 axisU = LIGHTMAP_FACE_AXES[axis][0], axisV = LIGHTMAP_FACE_AXES[axis][1];
+    b8 positive = face & 1;
+    return (struct LightmapFace) {
+            .origin = WithComponent(min, axis, positive ? Component(max, axis) : Component(min, axis)),
+            .u = WithComponent(Vector3Zero(), axisU, Component(max, axisU) - Component(min, axisU)),
+            .v = WithComponent(Vector3Zero(), axisV, Component(max, axisV) - Component(min, axisV)),
+            .normal = WithComponent(Vector3Zero(), axis, positive ? 1.0f : -1.0f)
+    };
+}
+
+// flat boxes only face up, faces resting on the ground can't be seen
+static b8 FaceVisible(const Level_Box *box, u32 face) {
+    if (box->size.y <= 0) return face == 3;
+    if (face == 2 && box->center.y - box->size.y / 2 <= 0) return false;
+    u32 axis = face / 2;
+    return Component(box->size, LIGHTMAP_FACE_AXES[axis][0]) > 0 && Component(box->size, LIGHTMAP_FACE_AXES[axis][1]) > 0;
+}
+
+static u32 ChartTexels(f32 length, f32 texelsPerUnit) {
+    u32 texels = (u32) ceilf(length * texelsPerUnit - 0.01f);
+    return texels ? texels : 1;
+}
+
+static int CompareCharts(const void *a, const void *b) {
+    // tallest first for the shelves, ties in level order so the layout is the same everywhere
+    const struct LightmapChart *ca = a, *cb = b;
+    if (ca->height != cb->height) return (ca->height > cb->height) ? -1 : 1;
+    if (ca->box != cb->box) return (ca->box < cb->box) ? -1 : 1;
+    return (ca->face < cb->face) ? -1 : (ca->face > cb->face);
+}
+
+// shelf packing of the charts sorted by height, the atlas is a power of two wide and as tall as it takes
+static void PackCharts(Lightmap_Baker *baker) {
+    qsort(baker->charts, baker->chartCount, sizeof(struct LightmapChart), CompareCharts);
+
+    u64 area = 0;
+    u32 widest = 0;
+    for (u32 i = 0; i < baker->chartCount; i++) {
+        u32 w = baker->charts[i].width + 2 * LIGHTMAP_GUTTER, h = baker->charts[i].height + 2 * LIGHTMAP_GUTTER;
+        area += (u64) w * h;
+        if (w > widest) widest = w;
+    }
+    u32 width = LIGHTMAP_MIN_WIDTH;
+    while ((f32) width < sqrtf((f32) area * 1.1f) || width < widest) width *= 2;
+
+    u32 x = 0, y = 0, shelfHeight = 0;
+    for (u32 i = 0; i < baker->chartCount; i++) {
+        struct LightmapChart *chart = &baker->charts[i];
+        u32 w = chart->width + 2 * LIGHTMAP_GUTTER, h = chart->height + 2 * LIGHTMAP_GUTTER;
+        if (x + w > width) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        chart->x = x + LIGHTMAP_GUTTER;
+        chart->y = y + LIGHTMAP_GUTTER;
+        x += w;
+        if (h > shelfHeight) shelfHeight = h;
+    }
+
+    baker->width = width;
+    baker->height = (y + shelfHeight + 3) & ~3u;
+}
+
+static void BuildNode(Lightmap_Baker *baker, u32 index, u32 first, u32 end) {
+    struct LightmapNode *node = &baker->nodes[index];
+    node->min = (Vector3) { FLT_MAX, FLT_MAX, FLT_MAX };
+    node->max = (Vector3) { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    Vector3 centerMin = node->min, centerMax = node->max;
+    for (u32 i = first; i < end; i++) {
+        u32 box = baker->boxOrder[i];
+        node->min = Vector3Min(node->min, baker->boxMin[box]);
+        node->max = Vector3Max(node->max, baker->boxMax[box]);
+        Vector3 center = Vector3Scale(Vector3Add(baker->boxMin[box], baker->boxMax[box]), 0.5f);
+        centerMin = Vector3Min(centerMin, center);
+        centerMax = Vector3Max(centerMax, center);
+    }
+
+    if (end - first <= LIGHTMAP_BVH_LEAF_SIZE) {
+        node->first = first;
+        node->count = end - first;
+        return;
+    }
+
+    // split the widest spread of centers in the middle, in half by count when they're all in one place
+    Vector3 extent = Vector3Subtract(centerMax, centerMin);
+    u32 axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z) ? 1 : 2;
+    f32 split = (Component(centerMin, axis) + Component(centerMax, axis)) / 2;
+    u32 middle = first;
+    for (u32 i = first; i < end; i++) {
+        u32 box = baker->boxOrder[i];
+        f32 center = (Component(baker->boxMin[box], axis) + Component(baker->boxMax[box], axis)) / 2;
+        if (center < split) {
+            baker->boxOrder[i] = baker->boxOrder[middle];
+            baker->boxOrder[middle++] = box;
+        }
+    }
+    if (middle == first || middle == end) middle = first + (end - first) / 2;
+
+    u32 left = baker->nodeCount;
+    baker->nodeCount += 2;
+    node->first = left;
+    node->count = 0;
+    BuildNode(baker, left, first, middle);
+    BuildNode(baker, left + 1, middle, end);
+}
+
+static struct LightmapRay MakeRay(Vector3 origin, Vector3 direction) {
+    // far off instead of infinite, so a ray along a box's side doesn't make a NaN
+    Vector3 inverse = {
+            (fabsf(direction.x) > 1e-12f) ? 1.0f / direction.x : copysignf(1e30f, direction.x),
+            (fabsf(direction.y) > 1e-12f) ? 1.0f / direction.y : copysignf(1e30f, direction.y),
+            (fabsf(direction.z) > 1e-12f) ? 1.0f / direction.z : copysignf(1e30f, direction.z)
+    };
+    return (struct LightmapRay) { origin, direction, inverse };
+}
+
+// slab test, where the ray enters the box (negative from inside it) and the axis of the side it enters through
+static b8 IntersectBox(const struct LightmapRay *ray, Vector3 min, Vector3 max, f32 tMax, f32 *enter, u32 *axis) {
+    f32 t0 = (min.x - ray->origin.x) * ray->inverse.x, t1 = (max.x - ray->origin.x) * ray->inverse.x;
+    f32 near = fminf(t0, t1), far = fmaxf(t0, t1);
+    u32 nearAxis = 0;
+
+    t0 = (min.y - ray->origin.y) * ray->inverse.y;
+    t1 = (max.y - ray->origin.y) * ray->inverse.y;
+    if (fminf(t0, t1) > near) {
+        near = fminf(t0, t1);
+        nearAxis = 1;
+    }
+    far = fminf(far, fmaxf(t0, t1));
+
+    t0 = (min.z - ray->origin.z) * ray->inverse.z;
+    t1 = (max.z - ray->origin.z) * ray->inverse.z;
+    if (fminf(t0, t1) > near) {
+        near = fminf(t0, t1);
+        nearAxis = 2;
+    }
+    far = fminf(far, fmaxf(t0, t1));
+
+    if (near > far || far < 0 || near > tMax) return false;
+    *enter = near;
+    *axis = nearAxis;
+    return true;
+}
+
+static b8 TraceClosest(const Lightmap_Baker *baker, const struct LightmapRay *ray, struct LightmapHit *hit) {
+    u32 stack[LIGHTMAP_BVH_STACK];
+    u32 top = 0;
+    stack[top++] = 0;
+
+    f32 tMax = FLT_MAX;
+    b8 found = false;
+    while (top > 0) {
+        const struct LightmapNode *node = &baker->nodes[stack[--top]];
+        f32 enter;
+        u32 axis;
+        if (!IntersectBox(ray, node->min, node->max, tMax, &enter, &axis)) continue;
+
+        if (node->count == 0) {
+            if (top + 2 > LIGHTMAP_BVH_STACK) continue;
+            stack[top++] = node->first + 1;
+            stack[top++] = node->first;
+            continue;
+        }
+
+        for (u32 i = node->first; i < node->first + node->count; i++) {
+            u32 box = baker->boxOrder[i];
+            if (!IntersectBox(ray, baker->boxMin[box], baker->boxMax[box], tMax, &enter, &axis)) continue;
+            tMax = fmaxf(enter, 0);
+            f32 sign = (Component(ray->direction, axis) > 0) ? -1.0f : 1.0f;
+            *hit = (struct LightmapHit) { tMax, box, WithComponent(Vector3Zero(), axis, sign) };
+            found = true;
+        }
+    }
+    return found;
+}
+
+static b8 TraceAny(const Lightmap_Baker *baker, const struct LightmapRay *ray, f32 tMax) {
+    u32 stack[LIGHTMAP_BVH_STACK];
+    u32 top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const struct LightmapNode *node = &baker->nodes[stack[--top]];
+        f32 enter;
+        u32 axis;
+        if (!IntersectBox(ray, node->min, node->max, tMax, &enter, &axis)) continue;
+
+        if (node->count == 0) {
+            if (top + 2 > LIGHTMAP_BVH_STACK) continue;
+            stack[top++] = node->first + 1;
+            stack[top++] = node->first;
+            continue;
+        }
+
+        for (u32 i = node->first; i < node->first + node->count; i++) {
+            u32 box = baker->boxOrder[i];
+            if (IntersectBox(ray, baker->boxMin[box], baker->boxMax[box], tMax, &enter, &axis)) return true;
+        }
+    }
+    return false;
+}
+
+static u64 SplitMix64(u64 x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// xorshift64*, uniform in [0, 1)
+static f32 Random01(u64 *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    u64 bits = *state * 0x2545f4914f6cdd1dull;
+    return (f32) (bits >> 40) * (1.0f / 16777216.0f);
+}
+
+static Vector3 CosineDirection(Vector3 normal, u64 *random) {
+    // orthonormal basis around the normal (Duff et al.), then a point on the disk projected up onto the hemisphere
+    f32 sign = copysignf(1.0f, normal.z);
+    f32 a = -1.0f / (sign + normal.z);
+    f32 b = normal.x * normal.y * a;
+    Vector3 tangent = { 1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x };
+    Vector3 bitangent = { b, sign + normal.y * normal.y * a, -normal.y };
+
+    f32 angle = 2 * PI * Random01(random);
+    f32 radiusSq = Random01(random);
+    f32 radius = sqrtf(radiusSq);
+    Vector3 direction = Vector3Add(Vector3Scale(tangent, radius * cosf(angle)), Vector3Scale(bitangent, radius * sinf(angle)));
+    return Vector3Add(direction, Vector3Scale(normal, sqrtf(fmaxf(1.0f - radiusSq, 0))));
+}
+
+// every light in range that the point can see, the way lighting.frag adds them up minus the specular
+static Vector3 GatherLights(const Lightmap_Baker *baker, Vector3 point, Vector3 normal, u64 *rays) {
+    Vector3 sum = Vector3Zero();
+    Vector3 origin = Vector3Add(point, Vector3Scale(normal, LIGHTMAP_RAY_OFFSET));
+    for (u32 i = 0; i < baker->desc.lightCount; i++) {
+        const Cluster_Light *light = &baker->desc.lights[i];
+        Vector3 toLight = Vector3Subtract(light->position, point);
+        f32 distanceSq = Vector3DotProduct(toLight, toLight);
+        f32 falloff = 1.0f - distanceSq / (light->radius * light->radius);
+        if (falloff <= 0) continue;
+
+        f32 distance = sqrtf(distanceSq);
+        Vector3 direction = Vector3Scale(toLight, 1.0f / distance);
+        f32 NdotL = Vector3DotProduct(normal, direction);
+        if (NdotL <= 0) continue;
+
+        struct LightmapRay ray = MakeRay(origin, direction);
+        (*rays)++;
+        if (TraceAny(baker, &ray, distance - LIGHTMAP_RAY_OFFSET)) continue;
+
+        f32 scale = NdotL * falloff * falloff * light->intensity / 255.0f;
+        sum = Vector3Add(sum, (Vector3) { light->color.r * scale, light->color.g * scale, light->color.b * scale });
+    }
+    return sum;
+}
+
+// one path from a point on a face, light gathered where it starts and wherever it bounces
+static Vector3 SamplePath(const Lightmap_Baker *baker, Vector3 point, Vector3 normal, u64 *random, u64 *rays) {
+    Vector3 result = GatherLights(baker, point, normal, rays);
+    Vector3 throughput = { 1, 1, 1 };
+    for (u32 bounce = 0; bounce < baker->desc.bounces; bounce++) {
+        Vector3 direction = CosineDirection(normal, random);
+        struct LightmapRay ray = MakeRay(Vector3Add(point, Vector3Scale(normal, LIGHTMAP_RAY_OFFSET)), direction);
+        struct LightmapHit hit;
+        (*rays)++;
+        // nothing out there, or a point tucked inside another box that nothing sees anyway
+        if (!TraceClosest(baker, &ray, &hit) || hit.t <= 0) break;
+
+        throughput = Vector3Multiply(throughput, baker->albedo[hit.box]);
+        point = Vector3Add(ray.origin, Vector3Scale(direction, hit.t));
+        normal = hit.normal;
+        result = Vector3Add(result, Vector3Multiply(throughput, GatherLights(baker, point, normal, rays)));
+    }
+    return result;
+}
+
+static void EncodeRgbm(Vector3 light, u8 *texel) {
+    f32 peak = fmaxf(fmaxf(light.x, light.y), fmaxf(light.z, 1e-6f));
+    f32 multiplier = ceilf(Clamp(peak / LIGHTMAP_RGBM_RANGE, 1.0f / 255.0f, 1.0f) * 255.0f) / 255.0f;
+    f32 scale = 255.0f / (multiplier * LIGHTMAP_RGBM_RANGE);
+    texel[0] = (u8) (Clamp(light.x * scale, 0, 255) + 0.5f);
+    texel[1] = (u8) (Clamp(light.y * scale, 0, 255) + 0.5f);
+    texel[2] = (u8) (Clamp(light.z * scale, 0, 255) + 0.5f);
+    texel[3] = (u8) (multiplier * 255.0f + 0.5f);
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+u64 Lightmap_LevelHash(const Level_Box *boxes, u32 boxCount, const Cluster_Light *lights, u32 lightCount) {
+    // field by field, the structs have padding and the baked flag doesn't change what was baked
+    u64 hash = 0xcbf29ce484222325ull;
+    for (u32 i = 0; i < boxCount; i++) {
+        hash = HashBytes(hash, &boxes[i].center, sizeof(boxes[i].center));
+        hash = HashBytes(hash, &boxes[i].size, sizeof(boxes[i].size));
+        hash = HashBytes(hash, &boxes[i].color, sizeof(boxes[i].color));
+    }
+    for (u32 i = 0; i < lightCount; i++) {
+        hash = HashBytes(hash, &lights[i].position, sizeof(lights[i].position));
+        hash = HashBytes(hash, &lights[i].radius, sizeof(lights[i].radius));
+        hash = HashBytes(hash, &lights[i].color, sizeof(lights[i].color));
+        hash = HashBytes(hash, &lights[i].intensity, sizeof(lights[i].intensity));
+    }
+    return hash;
+}
+
+Lightmap_Baker *Lightmap_BakerCreate(Lightmap_BakeDesc desc) {
+    if (desc.boxCount == 0 || desc.texelsPerUnit <= 0 || desc.samples == 0) return NULL;
+
+    Lightmap_Baker *baker = calloc(1, sizeof(Lightmap_Baker));
+    if (baker == NULL) return NULL;
+
+    Level_Box *boxes = malloc(desc.boxCount * sizeof(Level_Box));
+    Cluster_Light *lights = malloc((desc.lightCount ? desc.lightCount : 1) * sizeof(Cluster_Light));
+    baker->boxMin = malloc(desc.boxCount * sizeof(Vector3));
+    baker->boxMax = malloc(desc.boxCount * sizeof(Vector3));
+    baker->albedo = malloc(desc.boxCount * sizeof(Vector3));
+    baker->charts = malloc(desc.boxCount * 6 * sizeof(struct LightmapChart));
+    baker->nodes = malloc(desc.boxCount * 2 * sizeof(struct LightmapNode));
+    baker->boxOrder = malloc(desc.boxCount * sizeof(u32));
+    baker->desc = desc;
+    baker->desc.boxes = boxes;
+    baker->desc.lights = lights;
+    if (boxes == NULL || lights == NULL || baker->boxMin == NULL || baker->boxMax == NULL || baker->albedo == NULL
+        || baker->charts == NULL || baker->nodes == NULL || baker->boxOrder == NULL) {
+        Lightmap_BakerUnload(baker);
+        return NULL;
+    }
+    memcpy(boxes, desc.boxes, desc.boxCount * sizeof(Level_Box));
+    if (desc.lightCount > 0) memcpy(lights, desc.lights, desc.lightCount * sizeof(Cluster_Light));
+    baker->levelHash = Lightmap_LevelHash(desc.boxes, desc.boxCount, desc.lights, desc.lightCount);
+
+    for (u32 i = 0; i < desc.boxCount; i++) {
+        Vector3 half = Vector3Scale(boxes[i].size, 0.5f);
+        baker->boxMin[i] = Vector3Subtract(boxes[i].center, half);
+        baker->boxMax[i] = Vector3Add(boxes[i].center, half);
+        baker->albedo[i] = (Vector3) { boxes[i].color.r / 255.0f, boxes[i].color.g / 255.0f, boxes[i].color.b / 255.0f };
+        baker->boxOrder[i] = i;
+
+        for (u32 face = 0; face < 6; face++) {
+            if (!FaceVisible(&boxes[i], face)) continue;
+            u32 axis = face / 2;
+            baker->charts[baker->chartCount++] = (struct LightmapChart) {
+                    .box = i,
+                    .face = face,
+                    .width = ChartTexels(Component(boxes[i].size, LIGHTMAP_FACE_AXES[axis][0]), desc.texelsPerUnit),
+                    .height = ChartTexels(Component(boxes[i].size, LIGHTMAP_FACE_AXES[axis][1]), desc.texelsPerUnit)
+            };
+        }
+    }
+
+    PackCharts(baker);
+    baker->nodeCount = 1;
+    BuildNode(baker, 0, 0, desc.boxCount);
+
+    u64 texelCount = (u64) baker->width * baker->height;
+    baker->faces = malloc((baker->chartCount ? baker->chartCount : 1) * sizeof(struct LightmapFace));
+    baker->texelCharts = calloc(texelCount, sizeof(u32));
+    baker->texels = calloc(texelCount, sizeof(Vector3));
+    if (baker->faces == NULL || baker->texelCharts == NULL || baker->texels == NULL) {
+        Lightmap_BakerUnload(baker);
+        return NULL;
+    }
+
+    for (u32 i = 0; i < baker->chartCount; i++) {
+        const struct LightmapChart *chart = &baker->charts[i];
+        baker->faces[i] = BoxFace(baker->boxMin[chart->box], baker->boxMax[chart->box], chart->face);
+        for (u32 y = chart->y; y < chart->y + chart->height; y++) {
+            for (u32 x = chart->x; x < chart->x + chart->width; x++) {
+                baker->texelCharts[(u64) y * baker->width + x] = i + 1;
+            }
+        }
+    }
+
+    return baker;
+}
+
+void Lightmap_BakerUnload(Lightmap_Baker *baker) {
+    if (baker == NULL) return;
+    free((void *) baker->desc.boxes);
+    free((void *) baker->desc.lights);
+    free(baker->boxMin);
+    free(baker->boxMax);
+    free(baker->albedo);
+    free(baker->charts);
+    free(baker->faces);
+    free(baker->texelCharts);
+    free(baker->texels);
+    free(baker->nodes);
+    free(baker->boxOrder);
+    free(baker);
+}
+
+u32 Lightmap_BakeRows(const Lightmap_Baker *baker) {
+    return baker->height;
+}
+
+void Lightmap_Bake(Lightmap_Baker *baker, u32 firstRow, u32 endRow) {
+    if (endRow > baker->height) endRow = baker->height;
+
+    const u32 samples = baker->desc.samples;
+    u64 texels = 0, rays = 0;
+    for (u32 y = firstRow; y < endRow; y++) {
+        for (u32 x = 0; x < baker->width; x++) {
+            u64 index = (u64) y * baker->width + x;
+            u32 chartIndex = baker->texelCharts[index];
+            if (chartIndex == 0) continue;
+
+            const struct LightmapChart *chart = &baker->charts[chartIndex - 1];
+            const struct LightmapFace *face = &baker->faces[chartIndex - 1];
+            u64 random = SplitMix64(index) | 1;
+
+            Vector3 sum = Vector3Zero();
+            for (u32 i = 0; i < samples; i++) {
+                f32 s = ((f32) (x - chart->x) + Random01(&random)) / (f32) chart->width;
+                f32 t = ((f32) (y - chart->y) + Random01(&random)) / (f32) chart->height;
+                Vector3 point = Vector3Add(face->origin, Vector3Add(Vector3Scale(face->u, s), Vector3Scale(face->v, t)));
+                sum = Vector3Add(sum, SamplePath(baker, point, face->normal, &random, &rays));
+            }
+            baker->texels[index] = Vector3Scale(sum, 1.0f / (f32) samples);
+            texels++;
+        }
+    }
+
+    atomic_fetch_add(&baker->texelsBaked, texels);
+    atomic_fetch_add(&baker->samples, texels * samples);
+    atomic_fetch_add(&baker->rays, rays);
+}
+
+Lightmap_BakeStats Lightmap_GetBakeStats(const Lightmap_Baker *baker) {
+    return (Lightmap_BakeStats) {
+            .width = baker->width,
+            .height = baker->height,
+            .charts = baker->chartCount,
+            .texels = atomic_load(&baker->texelsBaked),
+            .samples = atomic_load(&baker->samples),
+            .rays = atomic_load(&baker->rays)
+    };
+}
+
+u64 Lightmap_BakerHash(const Lightmap_Baker *baker) {
+    return HashBytes(0xcbf29ce484222325ull, baker->texels, (u64) baker->width * baker->height * sizeof(baker->texels[0]));
+}
+
+b8 Lightmap_BakerSave(Lightmap_Baker *baker, const char *fileName) {
+    // gutters repeat the nearest texel of their chart, so bilinear filtering at a chart's edge stays inside it
+    const u32 width = baker->width;
+    for (u32 i = 0; i < baker->chartCount; i++) {
+        const struct LightmapChart *chart = &baker->charts[i];
+        for (u32 y = chart->y - LIGHTMAP_GUTTER; y < chart->y + chart->height + LIGHTMAP_GUTTER; y++) {
+            for (u32 x = chart->x - LIGHTMAP_GUTTER; x < chart->x + chart->width + LIGHTMAP_GUTTER; x++) {
+                u32 insideX = (x < chart->x) ? chart->x : (x >= chart->x + chart->width) ? chart->x + chart->width - 1 : x;
+                u32 insideY = (y < chart->y) ? chart->y : (y >= chart->y + chart->height) ? chart->y + chart->height - 1 : y;
+                baker->texels[(u64) y * width + x] = baker->texels[(u64) insideY * width + insideX];
+            }
+        }
+    }
+
+    u64 sizesSize = (u64) baker->desc.boxCount * sizeof(Vector3);
+    u64 chartsSize = (u64) baker->chartCount * sizeof(struct LightmapChart);
+    u64 texelCount = (u64) width * baker->height;
+    u64 size = sizeof(struct LightmapFileHeader) + sizesSize + chartsSize + texelCount * 4;
+    u8 *data = malloc(size);
+    if (data == NULL) return false;
+
+    struct LightmapFileHeader header = {
+            .version = LIGHTMAP_VERSION,
+            .levelHash = baker->levelHash,
+            .width = width,
+            .height = baker->height,
+            .boxCount = baker->desc.boxCount,
+            .chartCount = baker->chartCount
+    };
+    memcpy(header.magic, LIGHTMAP_MAGIC, sizeof(header.magic));
+
+    u8 *cursor = data;
+    memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    for (u32 i = 0; i < baker->desc.boxCount; i++) {
+        memcpy(cursor, &baker->desc.boxes[i].size, sizeof(Vector3));
+        cursor += sizeof(Vector3);
+    }
+    memcpy(cursor, baker->charts, chartsSize);
+    cursor += chartsSize;
+    for (u64 i = 0; i < texelCount; i++) {
+        EncodeRgbm(baker->texels[i], cursor + i * 4);
+    }
+
+    b8 saved = SaveFileData(fileName, data, (unsigned int) size);
+    free(data);
+    return saved;
+}
+
+Lightmap *Lightmap_Load(const char *fileName, u64 levelHash) {
+    if (!FileExists(fileName)) return NULL;
+
+    unsigned int size = 0;
+    unsigned char *data = LoadFileData(fileName, &size);
+    if (data == NULL) return NULL;
+
+    struct LightmapFileHeader header;
+    b8 valid = size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, data, sizeof(header));
+        valid = memcmp(header.magic, LIGHTMAP_MAGIC, sizeof(header.magic)) == 0
+             && header.version == LIGHTMAP_VERSION
+             && size == sizeof(header) + (u64) header.boxCount * sizeof(Vector3)
+                        + (u64) header.chartCount * sizeof(struct LightmapChart) + (u64) header.width * header.height * 4;
+    }
+    if (!valid) {
+        TraceLog(LOG_WARNING, "LIGHTMAP: [%s] Not a version %i lightmap", fileName, LIGHTMAP_VERSION);
+        UnloadFileData(data);
+        return NULL;
+    }
+    if (header.levelHash != levelHash) {
+        TraceLog(LOG_WARNING, "LIGHTMAP: [%s] Baked for a different level, run fiddle-bake again", fileName);
+        UnloadFileData(data);
+        return NULL;
+    }
+
+    Lightmap *lightmap = calloc(1, sizeof(Lightmap));
+    u64 texelsSize = (u64) header.width * header.height * 4;
+    if (lightmap != NULL) {
+        lightmap->sizes = malloc((header.boxCount ? header.boxCount : 1) * sizeof(Vector3));
+        lightmap->charts = malloc((header.chartCount ? header.chartCount : 1) * sizeof(struct LightmapChart));
+        lightmap->texels = malloc(texelsSize ? texelsSize : 1);
+    }
+    if (lightmap == NULL || lightmap->sizes == NULL || lightmap->charts == NULL || lightmap->texels == NULL) {
+        Lightmap_Unload(lightmap);
+        UnloadFileData(data);
+        return NULL;
+    }
+
+    const u8 *cursor = data + sizeof(header);
+    memcpy(lightmap->sizes, cursor, header.boxCount * sizeof(Vector3));
+    cursor += header.boxCount * sizeof(Vector3);
+    memcpy(lightmap->charts, cursor, header.chartCount * sizeof(struct LightmapChart));
+    cursor += header.chartCount * sizeof(struct LightmapChart);
+    memcpy(lightmap->texels, cursor, texelsSize);
+    UnloadFileData(data);
+
+    lightmap->width = header.width;
+    lightmap->height = header.height;
+    lightmap->boxCount = header.boxCount;
+    lightmap->chartCount = header.chartCount;
+
+    // a chart that doesn't fit the atlas would have us read past it
+    for (u32 i = 0; i < lightmap->chartCount; i++) {
+        const struct LightmapChart *chart = &lightmap->charts[i];
+        if (chart->box >= lightmap->boxCount || chart->face >= 6 || chart->x < LIGHTMAP_GUTTER || chart->y < LIGHTMAP_GUTTER
+            || (u64) chart->x + chart->width + LIGHTMAP_GUTTER > lightmap->width
+            || (u64) chart->y + chart->height + LIGHTMAP_GUTTER > lightmap->height) {
+            TraceLog(LOG_WARNING, "LIGHTMAP: [%s] Chart %u is out of bounds", fileName, i);
+            Lightmap_Unload(lightmap);
+            return NULL;
+        }
+    }
+
+    TraceLog(LOG_INFO, "LIGHTMAP: [%s] %ux%u texels, %u charts for %u boxes", fileName,
+             lightmap->width, lightmap->height, lightmap->chartCount, lightmap->boxCount);
+    return lightmap;
+}
+
+void Lightmap_Unload(Lightmap *lightmap) {
+    if (lightmap == NULL) return;
+    free(lightmap->sizes);
+    free(lightmap->charts);
+    free(lightmap->texels);
+    free(lightmap);
+}
+
+Image Lightmap_GetImage(const Lightmap *lightmap) {
+    return (Image) {
+            .data = lightmap->texels,
+            .width = (int) lightmap->width,
+            .height = (int) lightmap->height,
+            .mipmaps = 1,
+            .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+    };
+}
+
+u32 Lightmap_BoxCount(const Lightmap *lightmap) {
+    return lightmap->boxCount;
+}
+
+Mesh Lightmap_GenBoxMesh(const Lightmap *lightmap, u32 box) {
+    Mesh mesh = {0};
+    if (box >= lightmap->boxCount) return mesh;
+
+    u32 faceCount = 0;
+    for (u32 i = 0; i < lightmap->chartCount; i++) {
+        faceCount += lightmap->charts[i].box == box;
+    }
+    if (faceCount == 0) return mesh;
+
+    mesh.vertexCount = (int) faceCount * 4;
+    mesh.triangleCount = (int) faceCount * 2;
+    mesh.vertices = RL_MALLOC(mesh.vertexCount * 3 * sizeof(float));
+    mesh.normals = RL_MALLOC(mesh.vertexCount * 3 * sizeof(float));
+    mesh.texcoords = RL_MALLOC(mesh.vertexCount * 2 * sizeof(float));
+    mesh.texcoords2 = RL_MALLOC(mesh.vertexCount * 2 * sizeof(float));
+    mesh.indices = RL_MALLOC(mesh.triangleCount * 3 * sizeof(unsigned short));
+
+    Vector3 half = Vector3Scale(lightmap->sizes[box], 0.5f);
+    const f32 corners[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+    u32 vertex = 0, index = 0;
+    for (u32 i = 0; i < lightmap->chartCount; i++) {
+        const struct LightmapChart *chart = &lightmap->charts[i];
+        if (chart->box != box) continue;
+
+        struct LightmapFace face = BoxFace(Vector3Negate(half), half, chart->face);
+        for (u32 c = 0; c < 4; c++) {
+            f32 s = corners[c][0], t = corners[c][1];
+            Vector3 position = Vector3Add(face.origin, Vector3Add(Vector3Scale(face.u, s), Vector3Scale(face.v, t)));
+            u32 v = vertex + c;
+            mesh.vertices[v * 3 + 0] = position.x;
+            mesh.vertices[v * 3 + 1] = position.y;
+            mesh.vertices[v * 3 + 2] = position.z;
+            mesh.normals[v * 3 + 0] = face.normal.x;
+            mesh.normals[v * 3 + 1] = face.normal.y;
+            mesh.normals[v * 3 + 2] = face.normal.z;
+            mesh.texcoords[v * 2 + 0] = s;
+            mesh.texcoords[v * 2 + 1] = t;
+            mesh.texcoords2[v * 2 + 0] = ((f32) chart->x + s * (f32) chart->width) / (f32) lightmap->width;
+            mesh.texcoords2[v * 2 + 1] = ((f32) chart->y + t * (f32) chart->height) / (f32) lightmap->height;
+        }
+
+        // counter clockwise seen from outside
+        b8 flip = Vector3DotProduct(Vector3CrossProduct(face.u, face.v), face.normal) < 0;
+        const u32 order[2][6] = { { 0, 1, 2, 0, 2, 3 }, { 0, 2, 1, 0, 3, 2 } };
+        for (u32 k = 0; k < 6; k++) {
+            mesh.indices[index++] = (unsigned short) (vertex + order[flip][k]);
+        }
+        vertex += 4;
+    }
+
+    UploadMesh(&mesh, false);
+    return mesh;
+}
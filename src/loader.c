@@ -0,0 +1,538 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include "glb.h"
+#include "loader.h"
+#include "lod.h"
+#include "pack.h"
+#include "profiler.h"
+#include "quant.h"
+#include "resource.h"
+#include "thread.h"
+#include "timer.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum LoaderConstExpr {
+    LOADER_MAX_MODELS = 1024,
+    LOADER_MAX_WORKERS = 32,
+    LOADER_MAX_PATH = 256,
+};
+
+struct LoaderEntry {
+    char fileName[LOADER_MAX_PATH];
+    _Atomic int state;          // enum Loader_State
+
+    // CPU side data, owned by the worker until the entry is queued for upload, then by the main thread
+    GLB_ModelData data;
+    u64 *meshHashes;            // content hashes for the resource cache, computed on the worker
+    u64 *textureHashes;
+    u64 *lodHashes;
+
+    // simplified levels past the model itself, level l of mesh i at lodMeshes[(l - 1) * meshCount + i]
+    Mesh *lodMeshes;
+    u32 lodCount;
+
+    // cooked models skip the workers and upload straight from the mapped pack
+    b8 packed;
+    u32 packModel;
+
+    // upload progress
+    Texture2D *textures;
+    int meshesUploaded;
+    int lodMeshesUploaded;
+    int materialsUploaded;
+
+    // published once ready, empty before that
+    Model model;
+};
+
+// single producer / single consumer index queue, guarded by the loader mutex
+struct LoaderQueue {
+    u32 items[LOADER_MAX_MODELS];
+    u32 head;
+    u32 tail;
+};
+
+static struct Loader {
+    b8 initialized;
+
+    struct LoaderEntry entries[LOADER_MAX_MODELS];
+    u32 entryCount;
+
+    Mutex mutex;
+    CondVar workAvailable;
+    struct LoaderQueue pending;     // requested, waiting for a worker
+    struct LoaderQueue parsed;      // parsed, waiting for upload on the main thread
+    b8 quit;
+
+    Thread workers[LOADER_MAX_WORKERS];
+    int workerCount;
+
+    Pack *pack;
+
+    Loader_Stats stats;
+} loader = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static b8 QueueEmpty(const struct LoaderQueue *queue) {
+    return queue->head == queue->tail;
+}
+
+static void QueuePush(struct LoaderQueue *queue, u32 item) {
+    queue->items[queue->tail++ % LOADER_MAX_MODELS] = item;
+}
+
+static u32 QueuePeek(const struct LoaderQueue *queue) {
+    return queue->items[queue->head % LOADER_MAX_MODELS];
+}
+
+static void FreeHashes(struct LoaderEntry *entry) {
+    RL_FREE(entry->meshHashes);
+    RL_FREE(entry->textureHashes);
+    RL_FREE(entry->lodHashes);
+    entry->meshHashes = NULL;
+    entry->textureHashes = NULL;
+    entry->lodHashes = NULL;
+}
+
+// hashing is the expensive half of deduplication (every vertex and pixel), keep it off the main thread
+static b8 HashModelData(struct LoaderEntry *entry) {
+    const GLB_ModelData *data = &entry->data;
+    entry->meshHashes = RL_CALLOC(data->meshCount + 1, sizeof(u64));
+    entry->textureHashes = RL_CALLOC(data->materialCount + 1, sizeof(u64));
+    if (entry->meshHashes == NULL || entry->textureHashes == NULL) {
+        FreeHashes(entry);
+        return false;
+    }
+
+    for (int i = 0; i < data->meshCount; i++) {
+        entry->meshHashes[i] = Resource_HashMesh(&data->meshes[i]);
+    }
+    for (int i = 0; i < data->materialCount; i++) {
+        entry->textureHashes[i] = Resource_HashImage(data->materials[i].albedo);
+    }
+    return true;
+}
+
+// a model without levels still loads, it's just always drawn at full detail
+static void GenerateLods(struct LoaderEntry *entry) {
+    const GLB_ModelData *data = &entry->data;
+    u32 meshCount = (u32) data->meshCount;
+    entry->lodMeshes = RL_CALLOC((LOD_MAX_LEVELS - 1) * meshCount + 1, sizeof(Mesh));
+    entry->lodHashes = RL_CALLOC((LOD_MAX_LEVELS - 1) * meshCount + 1, sizeof(u64));
+    if (entry->lodMeshes == NULL || entry->lodHashes == NULL) {
+        RL_FREE(entry->lodMeshes);
+        entry->lodMeshes = NULL;
+        return;
+    }
+
+    entry->lodCount = Lod_GenerateLevels(data->meshes, meshCount, entry->lodMeshes);
+    for (u32 i = 0; i < entry->lodCount * meshCount; i++) {
+        entry->lodHashes[i] = Resource_HashMesh(&entry->lodMeshes[i]);
+    }
+}
+
+// levels repeating the previous one share its mapped data, and its GPU buffers
+static void LoadPackedLods(struct LoaderEntry *entry) {
+    u32 meshCount = (u32) entry->model.meshCount;
+    entry->lodCount = Pack_LodCount(loader.pack, entry->packModel);
+    if (entry->lodCount == 0) return;
+
+    entry->lodMeshes = RL_CALLOC(entry->lodCount * meshCount, sizeof(Mesh));
+    if (entry->lodMeshes == NULL) {
+        entry->lodCount = 0;
+        return;
+    }
+
+    for (u32 l = 0; l < entry->lodCount; l++) {
+        for (u32 i = 0; i < meshCount; i++) {
+            Mesh *mesh = &entry->lodMeshes[l * meshCount + i];
+            *mesh = Pack_GetLodMesh(loader.pack, entry->packModel, l + 1, i);
+            if (l > 0 && mesh->vertices == (mesh - meshCount)->vertices) {
+                *mesh = *(mesh - meshCount);
+            } else {
+                Quant_UploadMesh(mesh);
+            }
+        }
+    }
+}
+
+static void UnloadPackedLods(struct LoaderEntry *entry) {
+    u32 meshCount = (u32) entry->model.meshCount;
+    for (u32 i = 0; i < entry->lodCount * meshCount; i++) {
+        const Mesh *mesh = &entry->lodMeshes[i];
+        if (i >= meshCount && mesh->vaoId == (mesh - meshCount)->vaoId) continue;
+        Pack_UnloadMesh(*mesh);
+    }
+}
+
+// like UnloadModel() minus the meshes and textures, which belong to the resource cache
+static void FreeModelArrays(Model model) {
+    for (int i = 0; i < model.materialCount; i++) {
+        RL_FREE(model.materials[i].maps);
+    }
+    RL_FREE(model.materials);
+    RL_FREE(model.meshes);
+    RL_FREE(model.meshMaterial);
+}
+
+static struct LoaderEntry *GetEntry(Loader_Handle handle) {
+    if (handle == 0 || handle > loader.entryCount) return NULL;
+    return &loader.entries[handle - 1];
+}
+
+static int WorkerMain(void *arg) {
+    (void) arg;
+    Profiler_SetThreadName("loader");
+
+    for (;;) {
+        Mutex_Lock(&loader.mutex);
+        while (!loader.quit && QueueEmpty(&loader.pending)) {
+            CondVar_Wait(&loader.workAvailable, &loader.mutex);
+        }
+        if (loader.quit) {
+            Mutex_Unlock(&loader.mutex);
+            return 0;
+        }
+        u32 index = QueuePeek(&loader.pending);
+        loader.pending.head++;
+        Mutex_Unlock(&loader.mutex);
+
+        struct LoaderEntry *entry = &loader.entries[index];
+        atomic_store(&entry->state, Loader_State_Parsing);
+
+        f64 start = Timer_Seconds();
+        Profiler_Zone zone = PROFILE_BEGIN("parse");
+        b8 parsed = GLB_LoadModelData(entry->fileName, &entry->data);
+        if (parsed && !HashModelData(entry)) {
+            GLB_UnloadModelData(&entry->data);
+            parsed = false;
+        }
+        PROFILE_END(zone);
+
+        if (parsed) {
+            zone = PROFILE_BEGIN("lod");
+            GenerateLods(entry);
+            PROFILE_END(zone);
+        }
+        f64 elapsed = Timer_Seconds() - start;
+
+        Mutex_Lock(&loader.mutex);
+        loader.stats.parseSeconds += elapsed;
+        if (parsed) {
+            loader.stats.parsed++;
+            loader.stats.bytesParsed += GLB_ModelDataSize(&entry->data);
+            QueuePush(&loader.parsed, index);
+            atomic_store(&entry->state, Loader_State_Uploading);
+        } else {
+            loader.stats.failed++;
+            loader.stats.lastReadyTime = Timer_Seconds();
+            atomic_store(&entry->state, Loader_State_Failed);
+        }
+        Mutex_Unlock(&loader.mutex);
+    }
+}
+
+// upload one piece of the entry, returns true once the model is complete
+static b8 UploadStep(struct LoaderEntry *entry) {
+    if (entry->packed) {
+        // the model's transform may have been set while it was loading
+        Matrix transform = entry->model.transform;
+        entry->model = Pack_LoadModel(loader.pack, entry->packModel);
+        entry->model.transform = transform;
+        LoadPackedLods(entry);
+        return true;
+    }
+
+    GLB_ModelData *data = &entry->data;
+
+    if (entry->meshesUploaded < data->meshCount) {
+        int mesh = entry->meshesUploaded++;
+        Resource_AcquireMesh(&data->meshes[mesh], entry->meshHashes[mesh]);
+        return false;
+    }
+
+    if (entry->lodMeshesUploaded < (int) entry->lodCount * data->meshCount) {
+        int mesh = entry->lodMeshesUploaded++;
+        Resource_AcquireMesh(&entry->lodMeshes[mesh], entry->lodHashes[mesh]);
+        return false;
+    }
+
+    if (entry->textures == NULL) {
+        entry->textures = RL_CALLOC(data->materialCount, sizeof(Texture2D));
+    }
+
+    while (entry->materialsUploaded < data->materialCount) {
+        int index = entry->materialsUploaded++;
+        GLB_MaterialData *material = &data->materials[index];
+        if (material->albedo.data != NULL) {
+            entry->textures[index] = Resource_AcquireTexture(material->albedo, entry->textureHashes[index]);
+            UnloadImage(material->albedo);
+            material->albedo = (Image) {0};
+            return false;
+        }
+    }
+
+    // everything is on the GPU, build the model around the uploaded data
+    Model *model = &entry->model;
+    model->meshCount = data->meshCount;
+    model->meshes = data->meshes;
+    model->meshMaterial = data->meshMaterial;
+    model->materialCount = data->materialCount;
+    model->materials = RL_CALLOC(data->materialCount, sizeof(Material));
+    for (int i = 0; i < data->materialCount; i++) {
+        model->materials[i] = GLB_MaterialFromData(&data->materials[i], entry->textures[i]);
+    }
+
+    RL_FREE(entry->textures);
+    RL_FREE(data->materials);
+    entry->textures = NULL;
+    FreeHashes(entry);
+    *data = (GLB_ModelData) {0};
+    return true;
+}
+
+static void UnloadEntry(struct LoaderEntry *entry) {
+    if (entry->packed) {
+        if (atomic_load(&entry->state) == Loader_State_Ready) {
+            UnloadPackedLods(entry);
+            Pack_UnloadModel(entry->model);
+        }
+    } else if (atomic_load(&entry->state) == Loader_State_Ready) {
+        Model *model = &entry->model;
+        for (int i = 0; i < model->materialCount; i++) {
+            Texture2D albedo = model->materials[i].maps[MATERIAL_MAP_DIFFUSE].texture;
+            if (albedo.id != rlGetTextureIdDefault()) Resource_ReleaseTexture(albedo);
+        }
+        for (int i = 0; i < model->meshCount; i++) {
+            Resource_ReleaseMesh(model->meshes[i]);
+        }
+        for (int i = 0; i < (int) entry->lodCount * model->meshCount; i++) {
+            Resource_ReleaseMesh(entry->lodMeshes[i]);
+        }
+        FreeModelArrays(*model);
+    } else {
+        // part way through upload, release whatever already made it to the GPU
+        if (entry->textures != NULL) {
+            for (int i = 0; i < entry->materialsUploaded; i++) {
+                Resource_ReleaseTexture(entry->textures[i]);
+            }
+            RL_FREE(entry->textures);
+        }
+        for (int i = 0; i < entry->meshesUploaded; i++) {
+            Resource_ReleaseMesh(entry->data.meshes[i]);
+            entry->data.meshes[i] = (Mesh) {0};
+        }
+        for (int i = 0; i < (int) entry->lodCount * entry->data.meshCount; i++) {
+            if (i < entry->lodMeshesUploaded) Resource_ReleaseMesh(entry->lodMeshes[i]);
+            else Lod_FreeMesh(&entry->lodMeshes[i]);
+        }
+        GLB_UnloadModelData(&entry->data);
+        FreeHashes(entry);
+    }
+    RL_FREE(entry->lodMeshes);
+    memset(entry, 0, sizeof(*entry));
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void Loader_Init(int workerCount) {
+    if (loader.initialized) return;
+
+    memset(&loader, 0, sizeof(loader));
+    Mutex_Init(&loader.mutex);
+    CondVar_Init(&loader.workAvailable);
+
+    if (workerCount <= 0) workerCount = Thread_HardwareConcurrency() - 1;
+    if (workerCount < 1) workerCount = 1;
+    if (workerCount > LOADER_MAX_WORKERS) workerCount = LOADER_MAX_WORKERS;
+
+    for (int i = 0; i < workerCount; i++) {
+        if (!Thread_Create(&loader.workers[loader.workerCount], WorkerMain, NULL)) break;
+        loader.workerCount++;
+    }
+
+    loader.initialized = true;
+    TraceLog(LOG_INFO, "LOADER: Started %i worker threads", loader.workerCount);
+}
+
+void Loader_Shutdown(void) {
+    if (!loader.initialized) return;
+
+    Mutex_Lock(&loader.mutex);
+    loader.quit = true;
+    CondVar_Broadcast(&loader.workAvailable);
+    Mutex_Unlock(&loader.mutex);
+
+    for (int i = 0; i < loader.workerCount; i++) {
+        Thread_Join(&loader.workers[i]);
+    }
+
+    for (u32 i = 0; i < loader.entryCount; i++) {
+        UnloadEntry(&loader.entries[i]);
+    }
+
+    Pack_Close(loader.pack);
+
+    CondVar_Destroy(&loader.workAvailable);
+    Mutex_Destroy(&loader.mutex);
+    memset(&loader, 0, sizeof(loader));
+}
+
+b8 Loader_MountPack(const char *fileName) {
+    if (!loader.initialized || loader.pack != NULL) return false;
+
+    loader.pack = Pack_Open(fileName);
+    return loader.pack != NULL;
+}
+
+Loader_Handle Loader_LoadModel(const char *fileName) {
+    if (!loader.initialized) return 0;
+
+    for (u32 i = 0; i < loader.entryCount; i++) {
+        if (strcmp(loader.entries[i].fileName, fileName) == 0) {
+            return i + 1;
+        }
+    }
+
+    if (loader.entryCount >= LOADER_MAX_MODELS || strlen(fileName) >= LOADER_MAX_PATH) {
+        TraceLog(LOG_WARNING, "LOADER: [%s] Unable to queue model", fileName);
+        return 0;
+    }
+
+    u32 index = loader.entryCount++;
+    struct LoaderEntry *entry = &loader.entries[index];
+    memset(entry, 0, sizeof(*entry));
+    strcpy(entry->fileName, fileName);
+    entry->model.transform = MatrixIdentity();
+
+    i32 packModel = loader.pack ? Pack_FindModel(loader.pack, fileName) : -1;
+    entry->packed = (packModel >= 0);
+    entry->packModel = entry->packed ? (u32) packModel : 0;
+    atomic_store(&entry->state, entry->packed ? Loader_State_Uploading : Loader_State_Queued);
+
+    Mutex_Lock(&loader.mutex);
+    if (loader.stats.requested == 0) loader.stats.firstRequestTime = Timer_Seconds();
+    loader.stats.requested++;
+    if (entry->packed) {
+        // nothing to parse, queue it for upload directly
+        loader.stats.parsed++;
+        QueuePush(&loader.parsed, index);
+    } else {
+        QueuePush(&loader.pending, index);
+        CondVar_Signal(&loader.workAvailable);
+    }
+    Mutex_Unlock(&loader.mutex);
+
+    return index + 1;
+}
+
+void Loader_Update(f64 budgetSeconds) {
+    if (!loader.initialized) return;
+
+    f64 start = Timer_Seconds();
+    b8 worked = false;
+    for (;;) {
+        Mutex_Lock(&loader.mutex);
+        b8 empty = QueueEmpty(&loader.parsed);
+        u32 index = empty ? 0 : QueuePeek(&loader.parsed);
+        Mutex_Unlock(&loader.mutex);
+        if (empty) break;
+
+        struct LoaderEntry *entry = &loader.entries[index];
+        b8 complete = UploadStep(entry);
+        worked = true;
+
+        if (complete) {
+            f64 now = Timer_Seconds();
+            Mutex_Lock(&loader.mutex);
+            loader.parsed.head++;
+            loader.stats.ready++;
+            loader.stats.lastReadyTime = now;
+            Mutex_Unlock(&loader.mutex);
+            atomic_store(&entry->state, Loader_State_Ready);
+        }
+
+        if (Timer_Seconds() - start >= budgetSeconds) break;
+    }
+
+    if (worked) {
+        f64 elapsed = Timer_Seconds() - start;
+        loader.stats.uploadSeconds += elapsed;
+        if (elapsed > loader.stats.worstUploadSeconds) loader.stats.worstUploadSeconds = elapsed;
+    }
+}
+
+void Loader_Flush(void) {
+    while (!Loader_IsIdle()) {
+        Loader_Update(1.0);
+        Thread_Yield();
+    }
+}
+
+enum Loader_State Loader_GetState(Loader_Handle handle) {
+    struct LoaderEntry *entry = GetEntry(handle);
+    return entry ? (enum Loader_State) atomic_load(&entry->state) : Loader_State_Invalid;
+}
+
+b8 Loader_IsReady(Loader_Handle handle) {
+    return Loader_GetState(handle) == Loader_State_Ready;
+}
+
+b8 Loader_IsIdle(void) {
+    if (!loader.initialized) return true;
+
+    Mutex_Lock(&loader.mutex);
+    b8 idle = (loader.stats.ready + loader.stats.failed == loader.stats.requested);
+    Mutex_Unlock(&loader.mutex);
+    return idle;
+}
+
+Model *Loader_GetModel(Loader_Handle handle) {
+    struct LoaderEntry *entry = GetEntry(handle);
+    return entry ? &entry->model : NULL;
+}
+
+u32 Loader_GetLodCount(Loader_Handle handle) {
+    struct LoaderEntry *entry = GetEntry(handle);
+    if (entry == NULL || atomic_load(&entry->state) != Loader_State_Ready) return 1;
+    return entry->lodCount + 1;
+}
+
+Model Loader_GetModelLod(Loader_Handle handle, u32 level) {
+    struct LoaderEntry *entry = GetEntry(handle);
+    if (entry == NULL) return (Model) {0};
+
+    Model model = entry->model;
+    if (level > 0 && level <= entry->lodCount && atomic_load(&entry->state) == Loader_State_Ready) {
+        model.meshes = &entry->lodMeshes[(level - 1) * (u32) model.meshCount];
+    }
+    return model;
+}
+
+const char *Loader_GetFileName(Loader_Handle handle) {
+    struct LoaderEntry *entry = GetEntry(handle);
+    return entry ? entry->fileName : NULL;
+}
+
+Loader_Stats Loader_GetStats(void) {
+    if (!loader.initialized) return loader.stats;
+
+    Mutex_Lock(&loader.mutex);
+    Loader_Stats stats = loader.stats;
+    Mutex_Unlock(&loader.mutex);
+    return stats;
+}
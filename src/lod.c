@@ -0,0 +1,588 @@
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "job.h"
+#include "lod.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum LodConstExpr {
+    LOD_NONE = -1,
+};
+
+// per generated level, the share of the source's triangles to aim for and the error limit relative to the model's extent
+static const f32 LOD_TRIANGLE_RATIOS[LOD_MAX_LEVELS - 1] = { 0.5f, 0.25f, 0.125f };
+static const f32 LOD_ERROR_LIMITS[LOD_MAX_LEVELS - 1] = { 0.01f, 0.02f, 0.04f };
+// a level that doesn't drop at least this share of the previous level's triangles repeats the previous level
+static const f32 LOD_MIN_REDUCTION = 0.2f;
+
+// view height fraction below which each generated level takes over, and the margin to cross before switching
+static const f32 LOD_SCREEN_SIZES[LOD_MAX_LEVELS - 1] = { 0.3f, 0.15f, 0.07f };
+static const f32 LOD_HYSTERESIS = 0.15f;
+
+// planes along borders and seams weigh this much more than the triangles around them
+static const f64 LOD_BORDER_WEIGHT = 10.0;
+// collapses that turn a triangle further than this (cosine of the angle between normals) are rejected
+static const f64 LOD_MAX_FLIP = 0.05;
+static const f32 LOD_PASS_COST_SLACK = 1.5f;
+
+// symmetric 4x4 plane quadric, area weighted, the summed weight normalizes the error to a squared distance
+struct LodQuadric {
+    f64 a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+    f64 weight;
+};
+
+struct LodCollapse {
+    f32 cost;                           // squared error
+    u32 from;
+    u32 to;
+};
+
+// vertices sharing a position form a group, named after its first vertex, collapses happen between groups
+struct LodContext {
+    const Mesh *mesh;
+    u32 vertexCount;
+    u32 *group;
+    u32 *next;                          // ring of the vertices (uv / normal wedges) in a group
+    u32 *remap;                         // the vertex a collapsed vertex moved onto, itself while it's alive
+    struct LodQuadric *quadrics;        // per group
+    u8 *locked;                         // per group, already part of a collapse this pass
+
+    // triangles around each group, rebuilt every pass
+    u32 *adjacencyOffsets;
+    u32 *adjacency;
+
+    u32 *corners;                       // current triangles, 3 vertices each
+    u32 triangleCount;
+    struct LodCollapse *collapses;
+};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static Vector3 Position(const struct LodContext *ctx, u32 vertex) {
+    const f32 *p = &ctx->mesh->vertices[vertex * 3];
+    return (Vector3) { p[0], p[1], p[2] };
+}
+
+static u32 HashPosition(const f32 *p) {
+    u32 bits[3];
+    for (int i = 0; i < 3; i++) {
+        // -0 and 0 are the same position
+        f32 value = (p[i] == 0) ? 0 : p[i];
+        memcpy(&bits[i], &value, sizeof(u32));
+    }
+    return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+}
+
+static b8 BuildGroups(struct LodContext *ctx) {
+    u32 tableSize = 1;
+    while (tableSize < ctx->vertexCount * 2) tableSize *= 2;
+
+    u32 *table = RL_MALLOC(tableSize * sizeof(u32));
+    if (table == NULL) return false;
+    memset(table, 0xff, tableSize * sizeof(u32));
+
+    const f32 *positions = ctx->mesh->vertices;
+    for (u32 v = 0; v < ctx->vertexCount; v++) {
+        u32 slot = HashPosition(&positions[v * 3]) & (tableSize - 1);
+        for (;;) {
+            u32 entry = table[slot];
+            if (entry == (u32) LOD_NONE) {
+                table[slot] = v;
+                ctx->group[v] = v;
+                ctx->next[v] = v;
+                break;
+            }
+            const f32 *a = &positions[entry * 3];
+            const f32 *b = &positions[v * 3];
+            if (a[0] == b[0] && a[1] == b[1] && a[2] == b[2]) {
+                ctx->group[v] = entry;
+                ctx->next[v] = ctx->next[entry];
+                ctx->next[entry] = v;
+                break;
+            }
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        ctx->remap[v] = v;
+    }
+
+    RL_FREE(table);
+    return true;
+}
+
+static void AddPlane(struct LodQuadric *q, Vector3 n, f64 d, f64 weight) {
+    q->a2 += weight * n.x * n.x;
+    q->ab += weight * n.x * n.y;
+    q->ac += weight * n.x * n.z;
+    q->ad += weight * n.x * d;
+    q->b2 += weight * n.y * n.y;
+    q->bc += weight * n.y * n.z;
+    q->bd += weight * n.y * d;
+    q->c2 += weight * n.z * n.z;
+    q->cd += weight * n.z * d;
+    q->d2 += weight * d * d;
+    q->weight += weight;
+}
+
+static void AddQuadric(struct LodQuadric *q, const struct LodQuadric *r) {
+    q->a2 += r->a2; q->ab += r->ab; q->ac += r->ac; q->ad += r->ad;
+    q->b2 += r->b2; q->bc += r->bc; q->bd += r->bd;
+    q->c2 += r->c2; q->cd += r->cd;
+    q->d2 += r->d2;
+    q->weight += r->weight;
+}
+
+static f64 QuadricError(const struct LodQuadric *q, Vector3 p) {
+    f64 x = p.x, y = p.y, z = p.z;
+    f64 error = q->a2 * x * x + 2 * q->ab * x * y + 2 * q->ac * x * z + 2 * q->ad * x
+              + q->b2 * y * y + 2 * q->bc * y * z + 2 * q->bd * y
+              + q->c2 * z * z + 2 * q->cd * z
+              + q->d2;
+    return (error > 0 && q->weight > 0) ? error / q->weight : 0;
+}
+
+static u32 Resolve(const struct LodContext *ctx, u32 vertex) {
+    while (ctx->remap[vertex] != vertex) vertex = ctx->remap[vertex];
+    return vertex;
+}
+
+static void BuildAdjacency(struct LodContext *ctx) {
+    memset(ctx->adjacencyOffsets, 0, (ctx->vertexCount + 1) * sizeof(u32));
+    for (u32 i = 0; i < ctx->triangleCount * 3; i++) {
+        ctx->adjacencyOffsets[ctx->group[ctx->corners[i]] + 1]++;
+    }
+    for (u32 v = 0; v < ctx->vertexCount; v++) {
+        ctx->adjacencyOffsets[v + 1] += ctx->adjacencyOffsets[v];
+    }
+    // fill using the offsets as cursors, then shift them back
+    for (u32 i = 0; i < ctx->triangleCount * 3; i++) {
+        u32 group = ctx->group[ctx->corners[i]];
+        ctx->adjacency[ctx->adjacencyOffsets[group]++] = i / 3;
+    }
+    for (u32 v = ctx->vertexCount; v > 0; v--) {
+        ctx->adjacencyOffsets[v] = ctx->adjacencyOffsets[v - 1];
+    }
+    ctx->adjacencyOffsets[0] = 0;
+}
+
+// the corner of b in the triangle across the edge from a to b, LOD_NONE on an open border
+static u32 FindOppositeCorner(const struct LodContext *ctx, u32 triangle, u32 groupA, u32 groupB) {
+    for (u32 i = ctx->adjacencyOffsets[groupA]; i < ctx->adjacencyOffsets[groupA + 1]; i++) {
+        u32 other = ctx->adjacency[i];
+        if (other == triangle) continue;
+
+        const u32 *corners = &ctx->corners[other * 3];
+        for (u32 k = 0; k < 3; k++) {
+            if (ctx->group[corners[k]] == groupB && ctx->group[corners[(k + 1) % 3]] == groupA) return other * 3 + k;
+        }
+    }
+    return (u32) LOD_NONE;
+}
+
+static void InitQuadrics(struct LodContext *ctx) {
+    BuildAdjacency(ctx);
+
+    for (u32 t = 0; t < ctx->triangleCount; t++) {
+        const u32 *corners = &ctx->corners[t * 3];
+        u32 g[3] = { ctx->group[corners[0]], ctx->group[corners[1]], ctx->group[corners[2]] };
+        if (g[0] == g[1] || g[1] == g[2] || g[0] == g[2]) continue;
+
+        Vector3 p[3] = { Position(ctx, g[0]), Position(ctx, g[1]), Position(ctx, g[2]) };
+        Vector3 normal = Vector3CrossProduct(Vector3Subtract(p[1], p[0]), Vector3Subtract(p[2], p[0]));
+        f32 length = Vector3Length(normal);
+        if (length == 0) continue;
+
+        normal = Vector3Scale(normal, 1.0f / length);
+        f64 d = -Vector3DotProduct(normal, p[0]);
+        for (u32 k = 0; k < 3; k++) {
+            AddPlane(&ctx->quadrics[g[k]], normal, d, length * 0.5);
+        }
+
+        // open borders and attribute seams get a plane standing up on the edge, collapses off the edge cost extra
+        for (u32 k = 0; k < 3; k++) {
+            u32 a = k, b = (k + 1) % 3;
+            u32 opposite = FindOppositeCorner(ctx, t, g[a], g[b]);
+            b8 seam = (opposite != (u32) LOD_NONE)
+                      && (ctx->corners[opposite] != corners[b] || ctx->corners[opposite - opposite % 3 + (opposite % 3 + 1) % 3] != corners[a]);
+            if (opposite != (u32) LOD_NONE && !seam) continue;
+
+            Vector3 edge = Vector3Subtract(p[b], p[a]);
+            Vector3 side = Vector3CrossProduct(edge, normal);
+            f32 sideLength = Vector3Length(side);
+            if (sideLength == 0) continue;
+
+            side = Vector3Scale(side, 1.0f / sideLength);
+            f64 weight = Vector3DotProduct(edge, edge) * LOD_BORDER_WEIGHT;
+            f64 sideD = -Vector3DotProduct(side, p[a]);
+            AddPlane(&ctx->quadrics[g[a]], side, sideD, weight);
+            AddPlane(&ctx->quadrics[g[b]], side, sideD, weight);
+        }
+    }
+}
+
+static int CompareCollapses(const void *a, const void *b) {
+    f32 x = ((const struct LodCollapse *) a)->cost, y = ((const struct LodCollapse *) b)->cost;
+    return (x > y) - (x < y);
+}
+
+static u32 GatherCollapses(struct LodContext *ctx, f64 maxCost) {
+    u32 count = 0;
+    for (u32 t = 0; t < ctx->triangleCount; t++) {
+        const u32 *corners = &ctx->corners[t * 3];
+        for (u32 k = 0; k < 3; k++) {
+            u32 a = ctx->group[corners[k]];
+            u32 b = ctx->group[corners[(k + 1) % 3]];
+
+            struct LodQuadric q = ctx->quadrics[a];
+            AddQuadric(&q, &ctx->quadrics[b]);
+            f64 costAB = QuadricError(&q, Position(ctx, b));
+            f64 costBA = QuadricError(&q, Position(ctx, a));
+
+            struct LodCollapse collapse = (costAB <= costBA)
+                    ? (struct LodCollapse) { (f32) costAB, a, b }
+                    : (struct LodCollapse) { (f32) costBA, b, a };
+            if (collapse.cost <= maxCost) ctx->collapses[count++] = collapse;
+        }
+    }
+    qsort(ctx->collapses, count, sizeof(struct LodCollapse), CompareCollapses);
+    return count;
+}
+
+// moving every triangle around from onto to mustn't turn any of them over
+static b8 CollapseFlips(const struct LodContext *ctx, u32 from, u32 to) {
+    Vector3 target = Position(ctx, to);
+    for (u32 i = ctx->adjacencyOffsets[from]; i < ctx->adjacencyOffsets[from + 1]; i++) {
+        const u32 *corners = &ctx->corners[ctx->adjacency[i] * 3];
+        u32 g[3];
+        for (u32 k = 0; k < 3; k++) g[k] = ctx->group[Resolve(ctx, corners[k])];
+        if (g[0] == to || g[1] == to || g[2] == to) continue;
+        if (g[0] == g[1] || g[1] == g[2] || g[0] == g[2]) continue;
+
+        Vector3 p[3] = { Position(ctx, g[0]), Position(ctx, g[1]), Position(ctx, g[2]) };
+        Vector3 before = Vector3CrossProduct(Vector3Subtract(p[1], p[0]), Vector3Subtract(p[2], p[0]));
+        for (u32 k = 0; k < 3; k++) {
+            if (g[k] == from) p[k] = target;
+        }
+        Vector3 after = Vector3CrossProduct(Vector3Subtract(p[1], p[0]), Vector3Subtract(p[2], p[0]));
+
+        f64 dot = Vector3DotProduct(before, after);
+        if (dot <= LOD_MAX_FLIP * Vector3Length(before) * Vector3Length(after)) return true;
+    }
+    return false;
+}
+
+static f32 AttributeDistance(const Mesh *mesh, u32 a, u32 b) {
+    f32 distance = 0;
+    if (mesh->normals != NULL) {
+        const f32 *na = &mesh->normals[a * 3], *nb = &mesh->normals[b * 3];
+        distance += 1 - (na[0] * nb[0] + na[1] * nb[1] + na[2] * nb[2]);
+    }
+    if (mesh->texcoords != NULL) {
+        f32 du = mesh->texcoords[a * 2] - mesh->texcoords[b * 2];
+        f32 dv = mesh->texcoords[a * 2 + 1] - mesh->texcoords[b * 2 + 1];
+        distance += du * du + dv * dv;
+    }
+    return distance;
+}
+
+// every wedge of from moves onto the wedge of to with the closest uv and normal
+static void Collapse(struct LodContext *ctx, u32 from, u32 to) {
+    u32 wedge = from;
+    do {
+        u32 best = to;
+        f32 bestDistance = FLT_MAX;
+        u32 candidate = to;
+        do {
+            f32 distance = AttributeDistance(ctx->mesh, wedge, candidate);
+            if (distance < bestDistance) {
+                best = candidate;
+                bestDistance = distance;
+            }
+            candidate = ctx->next[candidate];
+        } while (candidate != to);
+
+        ctx->remap[wedge] = best;
+        wedge = ctx->next[wedge];
+    } while (wedge != from);
+
+    AddQuadric(&ctx->quadrics[to], &ctx->quadrics[from]);
+}
+
+// applies the pass's collapses to the triangles and drops the ones that collapsed away
+static void CompactTriangles(struct LodContext *ctx) {
+    u32 count = 0;
+    for (u32 t = 0; t < ctx->triangleCount; t++) {
+        u32 v[3];
+        for (u32 k = 0; k < 3; k++) v[k] = Resolve(ctx, ctx->corners[t * 3 + k]);
+
+        u32 g0 = ctx->group[v[0]], g1 = ctx->group[v[1]], g2 = ctx->group[v[2]];
+        if (g0 == g1 || g1 == g2 || g0 == g2) continue;
+
+        memcpy(&ctx->corners[count * 3], v, sizeof(v));
+        count++;
+    }
+    ctx->triangleCount = count;
+}
+
+static void FreeContext(struct LodContext *ctx) {
+    RL_FREE(ctx->group);
+    RL_FREE(ctx->next);
+    RL_FREE(ctx->remap);
+    RL_FREE(ctx->quadrics);
+    RL_FREE(ctx->locked);
+    RL_FREE(ctx->adjacencyOffsets);
+    RL_FREE(ctx->adjacency);
+    RL_FREE(ctx->corners);
+    RL_FREE(ctx->collapses);
+}
+
+static Mesh CopyMesh(const Mesh *source) {
+    u32 indexCount = source->indices ? (u32) source->triangleCount * 3 : 0;
+    Mesh mesh = { .vertexCount = source->vertexCount, .triangleCount = source->triangleCount };
+    u64 vertexCount = (u64) source->vertexCount;
+
+#define COPY_ARRAY(field, size) do {                                            \
+        if (source->field != NULL) {                                            \
+            mesh.field = RL_MALLOC(size);                                       \
+            if (mesh.field != NULL) memcpy(mesh.field, source->field, size);    \
+        }                                                                       \
+    } while (0)
+
+    COPY_ARRAY(vertices, vertexCount * 3 * sizeof(f32));
+    COPY_ARRAY(texcoords, vertexCount * 2 * sizeof(f32));
+    COPY_ARRAY(normals, vertexCount * 3 * sizeof(f32));
+    COPY_ARRAY(colors, vertexCount * 4);
+    COPY_ARRAY(indices, indexCount * sizeof(u16));
+#undef COPY_ARRAY
+
+    return mesh;
+}
+
+struct LodLevelsJob {
+    const Mesh *meshes;
+    u32 meshCount;
+    Mesh *levels;
+    f32 extent;
+};
+
+// the levels of meshes [first, end), each mesh only reads itself and writes its own levels
+static void GenerateMeshLevels(void *arg, u32 first, u32 end) {
+    const struct LodLevelsJob *job = arg;
+    for (u32 i = first; i < end; i++) {
+        const Mesh *mesh = &job->meshes[i];
+        u32 indexCount = (u32) mesh->triangleCount * 3;
+
+        // non-indexed meshes are simplified as if indexed in order, as long as 16 bits can index them
+        u16 *source = mesh->indices;
+        if (source == NULL && mesh->vertexCount <= 0xffff) {
+            source = RL_MALLOC(indexCount * sizeof(u16));
+            for (u32 v = 0; source != NULL && v < indexCount; v++) source[v] = (u16) v;
+        }
+
+        u16 *current = RL_MALLOC(indexCount * sizeof(u16));
+        u16 *scratch = RL_MALLOC(indexCount * sizeof(u16));
+        if (source == NULL || current == NULL || scratch == NULL) {
+            for (u32 l = 0; l < LOD_MAX_LEVELS - 1; l++) job->levels[l * job->meshCount + i] = CopyMesh(mesh);
+        } else {
+            memcpy(current, source, indexCount * sizeof(u16));
+            u32 currentCount = indexCount;
+            for (u32 l = 0; l < LOD_MAX_LEVELS - 1; l++) {
+                u32 target = (u32) ((f32) indexCount * LOD_TRIANGLE_RATIOS[l]) / 3 * 3;
+                u32 count = Lod_Simplify(mesh, current, currentCount, target, LOD_ERROR_LIMITS[l] * job->extent, scratch, NULL);
+                if (count > 0 && (f32) count <= (f32) currentCount * (1 - LOD_MIN_REDUCTION)) {
+                    memcpy(current, scratch, count * sizeof(u16));
+                    currentCount = count;
+                }
+                job->levels[l * job->meshCount + i] = Lod_BuildMesh(mesh, current, currentCount);
+            }
+        }
+
+        if (source != mesh->indices) RL_FREE(source);
+        RL_FREE(current);
+        RL_FREE(scratch);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+u32 Lod_Simplify(const Mesh *mesh, const u16 *indices, u32 indexCount, u32 targetIndexCount, f32 maxError,
+                 u16 *destination, f32 *error) {
+    if (error != NULL) *error = 0;
+    indexCount -= indexCount % 3;
+    if (targetIndexCount >= indexCount || mesh->vertices == NULL || mesh->vertexCount <= 0) {
+        memcpy(destination, indices, indexCount * sizeof(u16));
+        return indexCount;
+    }
+
+    struct LodContext ctx = {
+            .mesh = mesh,
+            .vertexCount = (u32) mesh->vertexCount,
+            .group = RL_MALLOC(mesh->vertexCount * sizeof(u32)),
+            .next = RL_MALLOC(mesh->vertexCount * sizeof(u32)),
+            .remap = RL_MALLOC(mesh->vertexCount * sizeof(u32)),
+            .quadrics = RL_CALLOC(mesh->vertexCount, sizeof(struct LodQuadric)),
+            .locked = RL_MALLOC(mesh->vertexCount),
+            .adjacencyOffsets = RL_MALLOC((mesh->vertexCount + 1) * sizeof(u32)),
+            .adjacency = RL_MALLOC(indexCount * sizeof(u32)),
+            .corners = RL_MALLOC(indexCount * sizeof(u32)),
+            .triangleCount = indexCount / 3,
+            .collapses = RL_MALLOC(indexCount * sizeof(struct LodCollapse)),
+    };
+    if (ctx.group == NULL || ctx.next == NULL || ctx.remap == NULL || ctx.quadrics == NULL || ctx.locked == NULL
+        || ctx.adjacencyOffsets == NULL || ctx.adjacency == NULL || ctx.corners == NULL || ctx.collapses == NULL
+        || !BuildGroups(&ctx)) {
+        FreeContext(&ctx);
+        memcpy(destination, indices, indexCount * sizeof(u16));
+        return indexCount;
+    }
+
+    for (u32 i = 0; i < indexCount; i++) {
+        ctx.corners[i] = (indices[i] < ctx.vertexCount) ? indices[i] : 0;
+    }
+    CompactTriangles(&ctx);
+    InitQuadrics(&ctx);
+
+    u32 targetTriangles = targetIndexCount / 3;
+    f64 maxCost = (f64) maxError * maxError;
+    f64 worstCost = 0;
+
+    // greedy passes, each collapses the cheapest edges whose ends nothing else touched yet this pass
+    while (ctx.triangleCount > targetTriangles) {
+        BuildAdjacency(&ctx);
+        u32 collapseCount = GatherCollapses(&ctx, maxCost);
+        memset(ctx.locked, 0, ctx.vertexCount);
+
+        // interior collapses remove two triangles, a pass doesn't go far past the cost of the goal'th cheapest
+        // collapse, anything dearer waits until the cheap ones around it have been done
+        u32 goal = (ctx.triangleCount - targetTriangles + 1) / 2;
+        f32 passCost = (goal < collapseCount) ? ctx.collapses[goal].cost * LOD_PASS_COST_SLACK : FLT_MAX;
+        u32 collapsed = 0;
+        for (u32 i = 0; i < collapseCount && collapsed < goal; i++) {
+            const struct LodCollapse *collapse = &ctx.collapses[i];
+            if (collapse->cost > passCost) break;
+            if (ctx.locked[collapse->from] || ctx.locked[collapse->to]) continue;
+            if (CollapseFlips(&ctx, collapse->from, collapse->to)) continue;
+
+            Collapse(&ctx, collapse->from, collapse->to);
+            ctx.locked[collapse->from] = true;
+            ctx.locked[collapse->to] = true;
+            if (collapse->cost > worstCost) worstCost = collapse->cost;
+            collapsed++;
+        }
+        if (collapsed == 0) break;
+
+        CompactTriangles(&ctx);
+    }
+
+    for (u32 i = 0; i < ctx.triangleCount * 3; i++) {
+        destination[i] = (u16) ctx.corners[i];
+    }
+    u32 result = ctx.triangleCount * 3;
+    FreeContext(&ctx);
+
+    if (error != NULL) *error = (f32) sqrt(worstCost);
+    return result;
+}
+
+Mesh Lod_BuildMesh(const Mesh *source, const u16 *indices, u32 indexCount) {
+    u32 *map = RL_MALLOC(source->vertexCount * sizeof(u32));
+    if (map == NULL) return (Mesh) {0};
+    memset(map, 0xff, source->vertexCount * sizeof(u32));
+
+    u32 vertexCount = 0;
+    for (u32 i = 0; i < indexCount; i++) {
+        if (map[indices[i]] == (u32) LOD_NONE) map[indices[i]] = vertexCount++;
+    }
+
+    Mesh mesh = {
+            .vertexCount = (int) vertexCount,
+            .triangleCount = (int) (indexCount / 3),
+            .vertices = RL_MALLOC(vertexCount * 3 * sizeof(f32)),
+            .texcoords = source->texcoords ? RL_MALLOC(vertexCount * 2 * sizeof(f32)) : NULL,
+            .normals = source->normals ? RL_MALLOC(vertexCount * 3 * sizeof(f32)) : NULL,
+            .colors = source->colors ? RL_MALLOC(vertexCount * 4) : NULL,
+            .indices = RL_MALLOC(indexCount * sizeof(u16)),
+    };
+
+    for (u32 v = 0; v < (u32) source->vertexCount; v++) {
+        u32 target = map[v];
+        if (target == (u32) LOD_NONE) continue;
+
+        memcpy(&mesh.vertices[target * 3], &source->vertices[v * 3], 3 * sizeof(f32));
+        if (mesh.texcoords) memcpy(&mesh.texcoords[target * 2], &source->texcoords[v * 2], 2 * sizeof(f32));
+        if (mesh.normals) memcpy(&mesh.normals[target * 3], &source->normals[v * 3], 3 * sizeof(f32));
+        if (mesh.colors) memcpy(&mesh.colors[target * 4], &source->colors[v * 4], 4);
+    }
+    for (u32 i = 0; i < indexCount; i++) {
+        mesh.indices[i] = (u16) map[indices[i]];
+    }
+
+    RL_FREE(map);
+    return mesh;
+}
+
+u32 Lod_GenerateLevels(const Mesh *meshes, u32 meshCount, Mesh *levels) {
+    u64 triangleCount = 0;
+    Vector3 min = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Vector3 max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (u32 i = 0; i < meshCount; i++) {
+        const Mesh *mesh = &meshes[i];
+        triangleCount += (u64) mesh->triangleCount;
+        for (int v = 0; v < mesh->vertexCount; v++) {
+            Vector3 p = { mesh->vertices[v * 3], mesh->vertices[v * 3 + 1], mesh->vertices[v * 3 + 2] };
+            min = Vector3Min(min, p);
+            max = Vector3Max(max, p);
+        }
+    }
+    if (triangleCount < LOD_MIN_TRIANGLES) return 0;
+
+    // one job per mesh, models with several meshes simplify them on the job workers at once
+    struct LodLevelsJob job = { meshes, meshCount, levels, Vector3Distance(min, max) };
+    Job_Counter counter = {0};
+    Job_ParallelFor(GenerateMeshLevels, &job, meshCount, 1, &counter);
+    Job_Wait(&counter);
+    return LOD_MAX_LEVELS - 1;
+}
+
+void Lod_FreeMesh(Mesh *mesh) {
+    RL_FREE(mesh->vertices);
+    RL_FREE(mesh->texcoords);
+    RL_FREE(mesh->normals);
+    RL_FREE(mesh->colors);
+    RL_FREE(mesh->indices);
+    *mesh = (Mesh) {0};
+}
+
+f32 Lod_ScreenSize(BoundingBox bounds, Camera3D camera) {
+    Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+    f32 radius = Vector3Distance(bounds.min, bounds.max) * 0.5f;
+
+    if (camera.projection == CAMERA_ORTHOGRAPHIC) {
+        return (camera.fovy > 0) ? 2 * radius / camera.fovy : FLT_MAX;
+    }
+
+    f32 distance = Vector3Distance(camera.position, center);
+    if (distance <= radius) return FLT_MAX;
+    return radius / (distance * tanf(camera.fovy * 0.5f * DEG2RAD));
+}
+
+u32 Lod_Select(f32 screenSize, u32 current, u32 levelCount) {
+    if (levelCount <= 1) return 0;
+    if (levelCount > LOD_MAX_LEVELS) levelCount = LOD_MAX_LEVELS;
+
+    u32 level = (current < levelCount) ? current : levelCount - 1;
+    while (level > 0 && screenSize > LOD_SCREEN_SIZES[level - 1] * (1 + LOD_HYSTERESIS)) level--;
+    while (level + 1 < levelCount && screenSize < LOD_SCREEN_SIZES[level] * (1 - LOD_HYSTERESIS)) level++;
+    return level;
+}
@@ -1,4 +1,7 @@
+#include <stdatomic.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "raylib.h"
 #include "raymath.h"
@@ -22,7 +25,38 @@
 #define GLSL_VERSION            100
 #endif
 
+// glsl330 lighting.frag shades with any number of clustered point lights (cluster.h),
+// glsl100 keeps the fixed MAX_LIGHTS uniform array from rlights.h
+#if GLSL_VERSION == 330
+#define CLUSTERED_LIGHTING
+#endif
+
 #include "common.h"
+#include "batch.h"
+#include "cluster.h"
+#include "cull.h"
+#include "dynres.h"
+#include "entity.h"
+#include "framebench.h"
+#include "gputimer.h"
+#include "job.h"
+#include "level.h"
+#include "lightmap.h"
+#include "loader.h"
+#include "lod.h"
+#include "occlusion.h"
+#include "profiler.h"
+#include "quant.h"
+#include "raycast.h"
+#include "rendergraph.h"
+#include "renderqueue.h"
+#include "resource.h"
+#include "shadercache.h"
+#include "sim.h"
+#include "tilemap.h"
+#include "timer.h"
+#include "ui.h"
+#include "uniform.h"
 
 // NOTE - for convenience when primary monitor is otherwise in use
 //#define USE_SECONDARY_MONITOR
@@ -36,21 +70,59 @@ static State state = {
                 .width = 1280,
                 .height = 720,
                 .title = "Fiddle"
-        },
-
-        .map = {
-                1, 1, 1, 1, 1, 1, 1, 1, 1,
-                1, 0, 0, 0, 0, 0, 0, 0, 1,
-                1, 0, 0, 3, 0, 0, 0, 4, 1,
-                1, 0, 0, 0, 0, 0, 0, 0, 1,
-                1, 0, 0, 0, 0, 0, 0, 4, 1,
-                1, 0, 2, 0, 0, 0, 0, 0, 1,
-                1, 0, 0, 0, 0, 0, 0, 0, 1,
-                1, 0, 0, 0, 0, 0, 0, 0, 1,
-                1, 1, 1, 1, 1, 1, 1, 1, 1,
         }
 };
 
+// what the player can see from where they stand, cast every frame and drawn in the overhead view
+static Raycast_Hit viewRays[VIEW_RAY_COLUMNS];
+
+// fixed timestep simulation, the player, overhead camera and coin in state are blended from its last two ticks
+static struct Simulation {
+    Sim_State previous;
+    Sim_State current;
+    Sim_Clock clock;
+    Sim_Input pending;              // input gathered since the last tick
+    Sim_Recording recording;        // F9 toggles, saved to SIM_RECORDING_FILE for 'fiddle-bench sim'
+    b8 recordingActive;
+} simulation = {0};
+
+#define SIM_RECORDING_FILE "input.rec"
+
+// 'fiddle --benchmark' path through both views, first person around the tree grid, overhead across the rooms
+static const FrameBench_Key benchmarkPath[] = {
+        //  time     player pos      first person eye          first person target   overhead rot, zoom
+        {  0.0f, {  100,  100 }, {  -3.0f,  3.0f,   0.0f }, {  0.0f, 2.25f, 0.0f },    0, 1.00f },
+        {  5.0f, {  400,  150 }, { -15.0f,  4.0f, -15.0f }, {  0.0f, 2.00f, 0.0f },    0, 0.50f },
+        { 10.0f, {  800,  700 }, {   0.0f,  8.0f, -22.0f }, {  0.0f, 1.00f, 0.0f },   20, 0.25f },
+        { 15.0f, { 1500, 1200 }, {  18.0f,  3.0f,  -5.0f }, { -5.0f, 2.00f, 5.0f },    0, 0.10f },
+        { 20.0f, { 2400, 1600 }, {  10.0f,  2.0f,  15.0f }, {  0.0f, 2.00f, 0.0f },  -30, 0.50f },
+        { 25.0f, { 3000, 2400 }, { -10.0f, 12.0f,  10.0f }, {  0.0f, 0.00f, 0.0f },    0, 2.00f },
+        { 30.0f, { 3200, 3200 }, {  -3.0f,  3.0f,   0.0f }, {  0.0f, 2.25f, 0.0f },    0, 1.00f },
+};
+
+enum BenchmarkConstExpr {
+    BENCHMARK_DEFAULT_FRAMES = 30 * SIM_TICK_RATE,      // the whole path once
+    BENCHMARK_WARMUP_FRAMES = 60,
+};
+
+enum PickupConstExpr {
+    PICKUP_JOB_GRAIN = 4096,            // pickups per job when updating and culling them
+};
+
+enum OcclusionCullingConstExpr {
+    OCCLUSION_BUFFER_WIDTH = 128,       // the first person view's aspect, a pixel for every 5x5 of it
+    OCCLUSION_BUFFER_HEIGHT = 144,
+};
+
+enum ProfilingConstExpr {
+    PROFILE_CAPTURE_FRAMES = 5 * SIM_TICK_RATE,
+};
+
+#define PROFILE_TRACE_FILE "profile.json"
+
+// baked by the fiddle-bake-lightmap target, see lightmap.h
+#define LIGHTMAP_FILE "data/level.lightmap"
+
 // ----------------------------------------------------------------------------
 // Forward declarations
 // ----------------------------------------------------------------------------
@@ -58,12 +130,50 @@ static State state = {
 static void InitGameData(void);
 static void UnloadGameData(void);
 static void UpdateDrawFrame(void);
+static const char *ShaderPath(Arena *arena, const char *fileName);
+#if !defined(CLUSTERED_LIGHTING)
+static Light BindLightToShader(Light light, int index, Shader shader);
+#endif
+static void OnLightingShaderReload(Shader previous, Shader current, void *user);
+static void LoadLightmap(Arena *arena, u64 levelHash);
+#if defined(CLUSTERED_LIGHTING)
+static void AddSceneLights(const Cluster_Light *lights, u32 count);
+static Cluster_Light CoinLight(f32 rotation);
+#endif
+static u32 AddSceneObject(Model *model, Vector3 position, f32 scale, Color tint);
+static u32 AddStreamedSceneObject(Loader_Handle asset, Vector3 position, f32 scale, Color tint);
+static BoundingBox GetSceneObjectBounds(const struct SceneObject *object);
+static void ResolveStreamedSceneObjects(struct Scene *scene);
+static void SelectLods(struct Scene *scene, Camera3D camera);
+static void AddLevel(const Level_Box *boxes, u32 count);
+static void AddPickups(Loader_Handle model, u32 count);
+static void UpdatePickups(void *arg, u32 first, u32 end);
+static void CullPickups(const Cull_Frustum *frustum);
+static void CullPickupRange(void *arg, u32 first, u32 end);
+static void BeginOcclusion(Matrix viewProjection, const Cull_Frustum *frustum, Job_Counter *counter);
+static void RasterizeOcclusion(void *arg, u32 first, u32 end);
+static void OccludeSceneObjects(void);
+static void TestSceneObjectRange(void *arg, u32 first, u32 end);
+static f32 MeasureUIText(String8 text, f32 fontSize);
+static void BuildUI(void);
+static void BuildTileMap(void);
+static Color getMapColor(u8 tile);
+static void CastViewRays(const struct Player *player, const Camera3D *firstPersonCamera);
+static void PickWall(const struct Player *player, Camera2D camera);
+static Sim_Input PollSimInput(Sim_Input pending);
+static void ParseArgs(int argc, char **argv);
+static void ApplyBenchmarkPath(struct Player *player, Camera2D *camera, Camera3D *firstPersonCamera);
+static void WriteBenchmarkReport(void);
+static void ToggleSimRecording(void);
 
 // ----------------------------------------------------------------------------
 // Entry point
 // ----------------------------------------------------------------------------
 
-int main() {
+int main(int argc, char **argv) {
+    state.loading.startTime = Timer_Seconds();
+    ParseArgs(argc, argv);
+
     SetConfigFlags(FLAG_MSAA_4X_HINT);  // Enable Multi Sampling Anti Aliasing 4x (if available)
 
     InitWindow(state.window.width, state.window.height, state.window.title);
@@ -86,9 +196,17 @@ int main() {
 #if defined(PLATFORM_WEB)
     emscripten_set_main_loop(UpdateDrawFrame, 0, 1);
 #else
-    SetTargetFPS(60);
-    while (!WindowShouldClose()) {
-        UpdateDrawFrame();
+    if (state.benchmark.enabled) {
+        // no frame limiting, the script moves on one step per frame however long it takes
+        while (!WindowShouldClose() && !FrameBench_IsDone()) {
+            UpdateDrawFrame();
+        }
+        WriteBenchmarkReport();
+    } else {
+        SetTargetFPS(60);
+        while (!WindowShouldClose()) {
+            UpdateDrawFrame();
+        }
     }
 #endif
 
@@ -116,6 +234,9 @@ static void InitGameData() {
             .rotation = 0,
             .zoom = 1
     };
+    simulation.current = Sim_InitState(state.player.pos, state.player.speed);
+    simulation.previous = simulation.current;
+
     state.cameras.firstPerson = (Camera3D) {
             .position = (Vector3) { -3, 3, 0 },
             .target = (Vector3) { 0, 2.25f, 0 },
@@ -129,32 +250,65 @@ static void InitGameData() {
             .firstPerson = LoadRenderTexture(state.window.width / 2, state.window.height)
     };
 
-    state.splitScreenRect = (Rectangle) {
-            0, 0,
-            (float) state.renderTextures.overhead.texture.width,
-            (float) -state.renderTextures.overhead.texture.height
-    };
+    // both views shrink while frames take longer than a 60 fps frame, the benchmark always draws them at full size
+    DynRes_Init(1.0 / 60.0);
+    state.renderTextures.overheadView = DynRes_AddView("overhead", state.renderTextures.overhead);
+    state.renderTextures.firstPersonView = DynRes_AddView("first_person", state.renderTextures.firstPerson);
+    DynRes_SetEnabled(!state.benchmark.enabled);
+
+    // both views are kept from frame to frame and only drawn again when their inputs change
+    RenderGraph_Init(LoadRenderTexture, UnloadRenderTexture);
+    state.renderTextures.overheadTarget = RenderGraph_ImportTarget(state.renderTextures.overhead);
+    state.renderTextures.firstPersonTarget = RenderGraph_ImportTarget(state.renderTextures.firstPerson);
 
     // load map data for visualization
-    const float tileSize = 50;
-    for (int i = 0; i < MAP_SIZE * MAP_SIZE; i++) {
-        int x = i % MAP_SIZE;
-        int y = i / MAP_SIZE;
-        state.tiles[i] = (Rectangle) {
-                .x = x * tileSize,
-                .y = y * tileSize,
-                .width = tileSize,
-                .height = tileSize
-        };
+    memcpy(state.map, Level_StartingRoom, sizeof(state.map));
+    BuildTileMap();
+
+    // debug panel, laid out by ui.h and drawn over the overhead view
+    UI_Init(MeasureUIText, 10);
+
+    // GPU pass times for the profiler and the benchmark, needs the GL context
+    GpuTimer_Init();
+
+    // zones from here on, off until F3 / F4 turns it on
+    Profiler_Init();
+
+    // frame work (pickups, tile map chunks) and the loader's mesh simplification are split into jobs,
+    // one worker per core besides this thread, which runs jobs too while it waits on them
+    Job_Init(-1);
+
+    // models are parsed on worker threads and uploaded a bit at a time from UpdateFrame()
+    Quant_SetEnabled(state.loading.quantize);
+    Loader_Init(0);
+
+    // visibility and picking rays against the tile map, big batches are spread over worker threads
+    Raycast_Init(0);
+    if (FileExists("data/models.pack")) {
+        // cooked by the fiddle-cook-models target, skips parsing and image decoding entirely
+        Loader_MountPack("data/models.pack");
     }
+    Loader_Handle coinAsset = Loader_LoadModel("data/models/coin.gltf.glb");
+
+    // uniforms set by game code go through a cache that drops redundant uploads
+    Uniform_Init();
+
+    // linked programs are cached on disk, edits to their sources are picked up while running
+    ShaderCache_Init("shadercache");
+
+    // shader paths and uniform names are only needed until the shaders are loaded and bound
+    Arena_Temp scratch = Arena_ScratchBegin();
 
     // load scene data
+    ShaderCache_Handle lightingShader = ShaderCache_Load(
+            ShaderPath(scratch.arena, "lighting.vert"),
+            ShaderPath(scratch.arena, "lighting.frag"));
     state.scene = (struct Scene) {
         .lights = {0},
-        .shader =LoadShader(
-                TextFormat("data/shaders/glsl%i/lighting.vert", GLSL_VERSION),
-                TextFormat("data/shaders/glsl%i/lighting.frag", GLSL_VERSION)),
-        .coin = LoadModel("data/models/coin.gltf.glb"),
+        .shader = ShaderCache_Get(lightingShader),
+        .shaderHandle = lightingShader,
+        .coin = Loader_GetModel(coinAsset),
+        .placeholder = LoadModelFromMesh(GenMeshCube(1, 1, 1)),
         .ground = LoadModelFromMesh(GenMeshPlane(50, 50, 50, 50)),
         .treeTrunk = LoadModelFromMesh(GenMeshCube(1, 1, 1)),
         .treeCanopy = LoadModelFromMesh(GenMeshCube(0.25f, 1, 0.25f)),
@@ -162,47 +316,605 @@ static void InitGameData() {
         .coinRotZ = 90.f
     };
 
-    // Get some required shader locations
-    state.scene.shader.locs[SHADER_LOC_VECTOR_VIEW] = GetShaderLocation(state.scene.shader, "viewPos");
     // NOTE: "matModel" location name is automatically assigned on shader loading,
     // no need to get the location again if using that uniform name
     //state.scene.shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocation(state.scene.shader, "matModel");
 
-    // Ambient light level (some basic lighting)
-    int ambientLoc = GetShaderLocation(state.scene.shader, "ambient");
-    SetShaderValue(state.scene.shader, ambientLoc, (float[4]) { 0.1f, 0.1f, 0.1f, 1.0f }, SHADER_UNIFORM_VEC4);
-
     // Assign out lighting shader to models
-    state.scene.coin.materials[0].shader = state.scene.shader;
+    // NOTE: streamed models get the shader assigned once they're ready, see ResolveStreamedSceneObjects()
+    state.scene.placeholder.materials[0].shader = state.scene.shader;
     state.scene.ground.materials[0].shader = state.scene.shader;
     state.scene.treeTrunk.materials[0].shader = state.scene.shader;
     state.scene.treeCanopy.materials[0].shader = state.scene.shader;
 
+#if !defined(CLUSTERED_LIGHTING)
     // Create lights
     state.scene.lights[0] = CreateLight(LIGHT_POINT, (Vector3){ -2, 1, -2 }, Vector3Zero(), YELLOW, state.scene.shader);
     state.scene.lights[1] = CreateLight(LIGHT_POINT, (Vector3){  2, 1,  2 }, Vector3Zero(), RED,    state.scene.shader);
     state.scene.lights[2] = CreateLight(LIGHT_POINT, (Vector3){ -2, 1,  2 }, Vector3Zero(), GREEN,  state.scene.shader);
     state.scene.lights[3] = CreateLight(LIGHT_POINT, (Vector3){  2, 1, -2 }, Vector3Zero(), BLUE,   state.scene.shader);
+#endif
+
+    // Instanced variant of the lighting shader, used by the batch renderer for repeated meshes
+    state.scene.instancingShaderHandle = ShaderCache_Load(
+            ShaderPath(scratch.arena, "lighting_instancing.vert"),
+            ShaderPath(scratch.arena, "lighting.frag"));
+    state.scene.instancingShader = ShaderCache_Get(state.scene.instancingShaderHandle);
+    // NOTE: DrawMeshInstanced() binds the per-instance transforms to the SHADER_LOC_MATRIX_MODEL attribute,
+    // a program that didn't build is raylib's default shader, its locations are shared and left alone
+    if (state.scene.instancingShaderHandle != 0) {
+        state.scene.instancingShader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(state.scene.instancingShader, "instanceTransform");
+    }
+
+    // the first run compiles and caches, later ones link the cached binaries
+    ShaderCache_Stats shaderStats = ShaderCache_GetStats();
+    TraceLog(LOG_INFO, "SHADERCACHE: %u programs ready in %.1f ms, %u from cached binaries, %u compiled",
+             shaderStats.programs, shaderStats.loadSeconds * 1000.0, shaderStats.cached, shaderStats.compiled);
+    ShaderCache_OnReload(state.scene.shaderHandle, OnLightingShaderReload, &state.scene.shaderHandle);
+    ShaderCache_OnReload(state.scene.instancingShaderHandle, OnLightingShaderReload, &state.scene.instancingShaderHandle);
+
+    // Camera position and ambient light level are shared by both lighting shaders,
+    // they're only uploaded when they change, see Uniform_FrameFlush() in UpdateFrame()
+    state.scene.uniforms.viewPos = Uniform_FrameField("viewPos", SHADER_UNIFORM_VEC3);
+    state.scene.uniforms.ambient = Uniform_FrameField("ambient", SHADER_UNIFORM_VEC4);
+    Uniform_FrameAttach(state.scene.shader);
+    Uniform_FrameAttach(state.scene.instancingShader);
+    Uniform_FrameSet(state.scene.uniforms.ambient, (float[4]) { 0.1f, 0.1f, 0.1f, 1.0f });
+
+#if defined(CLUSTERED_LIGHTING)
+    Cluster_Init(MAX_SCENE_LIGHTS);
+    Cluster_BindShader(state.scene.shader);
+    Cluster_BindShader(state.scene.instancingShader);
+#else
+    for (int i = 0; i < MAX_LIGHTS; i++) {
+        state.scene.instancingLights[i] = BindLightToShader(state.scene.lights[i], i, state.scene.instancingShader);
+    }
+#endif
+
+    // the static level, and the light fiddle-bake baked into it if it was baked for this same level
+    Level_Box levelBoxes[LEVEL_MAX_BOXES];
+    Cluster_Light levelLights[LEVEL_MAX_LIGHTS];
+    u32 levelBoxCount = Level_StaticBoxes(state.map, levelBoxes, LEVEL_MAX_BOXES);
+    u32 levelLightCount = Level_StaticLights(levelLights, LEVEL_MAX_LIGHTS);
+    LoadLightmap(scratch.arena, Lightmap_LevelHash(levelBoxes, levelBoxCount, levelLights, levelLightCount));
+
+    Arena_ScratchEnd(scratch);
+
+    Batch_Init(state.scene.instancingShader);
+    RenderQueue_Init();
+
+    // Build the scene object list: grid of cube trees on a plane to make a "world",
+    // and the starting room's walls around it, they hide the gallery from inside
+    AddLevel(levelBoxes, levelBoxCount);
+    state.occlusion.buffer = Occlusion_Create(OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT);
+
+    // A 3d model for testing, it rotates so its bounds are refit every frame
+    state.scene.coinObject = AddStreamedSceneObject(coinAsset, (Vector3) { 0, 3.f, 0 }, 1, WHITE);
+
+    // and any number of smaller ones spinning on their own, they're entities rather than scene objects
+    if (state.pickups.count > 0) {
+        AddPickups(coinAsset, state.pickups.count);
+    }
+
+    // Gallery of every model in the content set, rows behind the tree grid and the wall
+    FilePathList modelFiles = LoadDirectoryFilesEx("data/models", ".glb", false);
+    const int galleryColumns = 20;
+    const float gallerySpacing = 3;
+    int galleryIndex = 0;
+    for (u32 i = 0; i < modelFiles.count; i++) {
+        Loader_Handle asset = Loader_LoadModel(modelFiles.paths[i]);
+        if (asset == 0 || asset == coinAsset) continue;
+
+        Vector3 position = {
+                -30 + (galleryIndex % galleryColumns) * gallerySpacing,
+                0,
+                30 + (galleryIndex / galleryColumns) * gallerySpacing
+        };
+        AddStreamedSceneObject(asset, position, 1, WHITE);
+        galleryIndex++;
+
+#if defined(CLUSTERED_LIGHTING)
+        // candles and torches in the gallery give off a little light of their own
+        const char *fileName = GetFileName(modelFiles.paths[i]);
+        if (strncmp(fileName, "candle", 6) == 0 || strncmp(fileName, "torch", 5) == 0) {
+            Cluster_AddLight((Cluster_Light) {
+                    .position = Vector3Add(position, (Vector3) { 0, 1.5f, 0 }),
+                    .radius = 3,
+                    .color = ORANGE,
+                    .intensity = 1.5f
+            });
+        }
+#endif
+    }
+    UnloadDirectoryFiles(modelFiles);
+
+#if defined(CLUSTERED_LIGHTING)
+    AddSceneLights(levelLights, levelLightCount);
+#endif
+
+    BoundingBox bounds[MAX_SCENE_OBJECTS];
+    for (u32 i = 0; i < state.scene.objectCount; i++) {
+        bounds[i] = state.scene.objects[i].bounds;
+    }
+    state.scene.bvh = Cull_BVHBuild(bounds, state.scene.objectCount);
+}
+
+static u32 AddSceneObject(Model *model, Vector3 position, f32 scale, Color tint) {
+    if (state.scene.objectCount >= MAX_SCENE_OBJECTS) {
+        TraceLog(LOG_WARNING, "SCENE: Object limit (%i) reached", MAX_SCENE_OBJECTS);
+        return state.scene.objectCount - 1;
+    }
+
+    u32 index = state.scene.objectCount++;
+    state.scene.version++;
+    struct SceneObject *object = &state.scene.objects[index];
+    *object = (struct SceneObject) {
+            .model = model,
+            .position = position,
+            .scale = scale,
+            .tint = tint,
+            .localBounds = GetModelBoundingBox(*model)
+    };
+    object->bounds = GetSceneObjectBounds(object);
+    return index;
+}
+
+// Scene object for a model that may still be loading, it's drawn as a placeholder until ready
+static u32 AddStreamedSceneObject(Loader_Handle asset, Vector3 position, f32 scale, Color tint) {
+    u32 index = AddSceneObject(Loader_GetModel(asset), position, scale, tint);
+
+    struct SceneObject *object = &state.scene.objects[index];
+    object->asset = asset;
+    object->pending = true;
+    object->localBounds = GetModelBoundingBox(state.scene.placeholder);
+    object->bounds = GetSceneObjectBounds(object);
+    return index;
 }
 
+// Swap placeholders for streamed models that finished loading since the last frame
+static void ResolveStreamedSceneObjects(struct Scene *scene) {
+    for (u32 i = 0; i < scene->objectCount; i++) {
+        struct SceneObject *object = &scene->objects[i];
+        if (!object->pending) continue;
+
+        enum Loader_State loaderState = Loader_GetState(object->asset);
+        if (loaderState == Loader_State_Ready) {
+            for (int m = 0; m < object->model->materialCount; m++) {
+                object->model->materials[m].shader = scene->shader;
+            }
+            object->localBounds = GetModelBoundingBox(*object->model);
+        } else if (loaderState == Loader_State_Failed) {
+            // keep the placeholder around so the failure is visible in the scene
+            object->model = &scene->placeholder;
+            object->tint = MAROON;
+        } else {
+            continue;
+        }
+
+        object->pending = false;
+        object->bounds = GetSceneObjectBounds(object);
+        Cull_BVHUpdateObject(scene->bvh, i, object->bounds);
+        scene->version++;
+    }
+}
+
+// Pick a level for each visible streamed model from how much of the view it covers,
+// objects out of view keep their level so they come back in without popping
+static void SelectLods(struct Scene *scene, Camera3D camera) {
+    for (u32 i = 0; i < scene->visibleCount; i++) {
+        struct SceneObject *object = &scene->objects[scene->visibleObjects[i]];
+        if (object->asset == 0 || object->pending) continue;
+
+        u32 levelCount = state.lod.enabled ? Loader_GetLodCount(object->asset) : 1;
+        object->lod = Lod_Select(Lod_ScreenSize(object->bounds, camera), object->lod, levelCount);
+    }
+}
+
+// The static level's boxes (see level.h), the ground and the trees share a model each, every wall run gets its own,
+// with the lightmap loaded each of them also has its baked twin
+static void AddLevel(const Level_Box *boxes, u32 count) {
+    struct Scene *scene = &state.scene;
+    scene->firstWallObject = scene->objectCount;
+    scene->wallCount = 0;
+
+    for (u32 i = 0; i < count; i++) {
+        const Level_Box *box = &boxes[i];
+        Model *model = NULL;
+        switch (box->kind) {
+            case Level_Box_Ground: model = &scene->ground; break;
+            case Level_Box_TreeTrunk: model = &scene->treeTrunk; break;
+            case Level_Box_TreeCanopy: model = &scene->treeCanopy; break;
+            case Level_Box_Wall: {
+                if (scene->wallCount == 0) scene->firstWallObject = scene->objectCount;
+                model = &scene->walls[scene->wallCount++];
+                *model = LoadModelFromMesh(GenMeshCube(box->size.x, box->size.y, box->size.z));
+                model->materials[0].shader = scene->shader;
+            } break;
+        }
+
+        u32 object = AddSceneObject(model, box->center, 1, box->color);
+        if (i < state.lightmap.modelCount && state.lightmap.models[i].meshes[0].vertexCount > 0) {
+            scene->objects[object].baked = &state.lightmap.models[i];
+        }
+    }
+}
+
+// Coins spread over the tree grid on a sunflower spiral, each turning at its own speed
+static void AddPickups(Loader_Handle model, u32 count) {
+    state.pickups.entities = Entity_StoreCreate(count);
+    state.pickups.visible = malloc(count * sizeof(u32));
+    if (state.pickups.entities == NULL || state.pickups.visible == NULL) {
+        TraceLog(LOG_WARNING, "SCENE: Couldn't make room for %u pickups", count);
+        Entity_StoreUnload(state.pickups.entities);
+        free(state.pickups.visible);
+        state.pickups = (struct Pickups) {0};
+        return;
+    }
+
+    const f32 radius = 20;
+    const f32 goldenAngle = PI * (3 - sqrtf(5));
+    for (u32 i = 0; i < count; i++) {
+        f32 distance = radius * sqrtf(((f32) i + 0.5f) / (f32) count);
+        f32 angle = (f32) i * goldenAngle;
+
+        // stood on edge like the big coin, then turned to face a different way
+        Quaternion upright = QuaternionFromAxisAngle((Vector3) { 0, 0, 1 }, 90 * DEG2RAD);
+        Quaternion facing = QuaternionFromAxisAngle((Vector3) { 0, 1, 0 }, angle);
+        Entity_Create(state.pickups.entities, (Entity_Desc) {
+                .position = { distance * cosf(angle), 0.75f, distance * sinf(angle) },
+                .rotation = QuaternionMultiply(facing, upright),
+                .scale = 0.5f,
+                .angularVelocity = { 0, 1.5f + (f32) (i % 8) * 0.25f, 0 },
+                .model = model
+        });
+    }
+}
+
+// Job body for the pickup transform update, arg points at the frame's dt
+static void UpdatePickups(void *arg, u32 first, u32 end) {
+    Entity_UpdateRange(state.pickups.entities, first, end, *(const f32 *) arg);
+}
+
+struct PickupCull {
+    const Cull_Frustum *frustum;
+    const Occlusion_Buffer *occlusion;  // NULL when it's off
+    Entity_Arrays pickups;
+    f32 radius;
+    atomic_uint tested;
+    atomic_uint hidden;
+};
+
+// Bounds of a pickup are a box around the sphere its model spins in, so they don't change as it turns,
+// ranges are tested as jobs and then packed in order, so the visible list doesn't depend on who ran what
+static void CullPickups(const Cull_Frustum *frustum) {
+    state.pickups.visibleCount = 0;
+    const struct SceneObject *coin = &state.scene.objects[state.scene.coinObject];
+    if (state.pickups.entities == NULL || coin->pending) return;
+
+    Vector3 extent = Vector3Max(Vector3Negate(coin->localBounds.min), coin->localBounds.max);
+    struct PickupCull cull = {
+            .frustum = frustum,
+            .occlusion = state.occlusion.enabled ? state.occlusion.buffer : NULL,
+            .pickups = Entity_GetArrays(state.pickups.entities),
+            .radius = Vector3Length(extent)
+    };
+
+    Job_Counter counter = {0};
+    Job_ParallelFor(CullPickupRange, &cull, cull.pickups.count, PICKUP_JOB_GRAIN, &counter);
+    Job_Wait(&counter);
+
+    for (u32 i = 0; i < cull.pickups.count; i++) {
+        if (state.pickups.visible[i] == UINT32_MAX) continue;
+        state.pickups.visible[state.pickups.visibleCount++] = i;
+    }
+    state.occlusion.tested += atomic_load(&cull.tested);
+    state.occlusion.rejected += atomic_load(&cull.hidden);
+}
+
+// Marks each pickup in [first, end) in its own slot of the visible list, UINT32_MAX when it's out of view
+// or behind a wall
+static void CullPickupRange(void *arg, u32 first, u32 end) {
+    struct PickupCull *cull = arg;
+    const Entity_Arrays *pickups = &cull->pickups;
+    u32 tested = 0, hidden = 0;
+    for (u32 i = first; i < end; i++) {
+        Vector3 position = { pickups->positionX[i], pickups->positionY[i], pickups->positionZ[i] };
+        f32 reach = cull->radius * pickups->scale[i];
+        BoundingBox bounds = {
+                Vector3SubtractValue(position, reach),
+                Vector3AddValue(position, reach)
+        };
+        b8 visible = Cull_FrustumTestBox(cull->frustum, bounds);
+        if (visible && cull->occlusion != NULL) {
+            tested++;
+            visible = Occlusion_TestBox(cull->occlusion, bounds);
+            hidden += !visible;
+        }
+        state.pickups.visible[i] = visible ? i : UINT32_MAX;
+    }
+    atomic_fetch_add(&cull->tested, tested);
+    atomic_fetch_add(&cull->hidden, hidden);
+}
+
+// The walls in view go into the occlusion buffer, its rows are rasterized as jobs while this thread carries on
+static void BeginOcclusion(Matrix viewProjection, const Cull_Frustum *frustum, Job_Counter *counter) {
+    Occlusion_Buffer *buffer = state.occlusion.buffer;
+    Occlusion_Begin(buffer, viewProjection);
+    for (u32 i = 0; i < state.scene.wallCount; i++) {
+        BoundingBox bounds = state.scene.objects[state.scene.firstWallObject + i].bounds;
+        if (Cull_FrustumTestBox(frustum, bounds)) Occlusion_AddBox(buffer, bounds);
+    }
+    Job_ParallelFor(RasterizeOcclusion, buffer, Occlusion_TileRows(buffer), 2, counter);
+}
+
+static void RasterizeOcclusion(void *arg, u32 first, u32 end) {
+    Occlusion_Rasterize(arg, first, end);
+}
+
+// Drops the visible objects the walls hide, tested as jobs and then packed in order like the pickups
+static void OccludeSceneObjects(void) {
+    struct Scene *scene = &state.scene;
+    b8 hidden[MAX_SCENE_OBJECTS];
+
+    Job_Counter counter = {0};
+    Job_ParallelFor(TestSceneObjectRange, hidden, scene->visibleCount, 64, &counter);
+    Job_Wait(&counter);
+
+    u32 visibleCount = 0;
+    for (u32 i = 0; i < scene->visibleCount; i++) {
+        if (hidden[i]) continue;
+        scene->visibleObjects[visibleCount++] = scene->visibleObjects[i];
+    }
+    state.occlusion.tested += scene->visibleCount;
+    state.occlusion.rejected += scene->visibleCount - visibleCount;
+    scene->visibleCount = visibleCount;
+}
+
+// the walls themselves are never tested, they'd be compared against their own depth
+static void TestSceneObjectRange(void *arg, u32 first, u32 end) {
+    const struct Scene *scene = &state.scene;
+    b8 *hidden = arg;
+    for (u32 i = first; i < end; i++) {
+        u32 index = scene->visibleObjects[i];
+        b8 wall = index - scene->firstWallObject < scene->wallCount;
+        hidden[i] = !wall && !Occlusion_TestBox(state.occlusion.buffer, scene->objects[index].bounds);
+    }
+}
+
+// World space bounds, using the same transform composition as DrawModel()
+static BoundingBox GetSceneObjectBounds(const struct SceneObject *object) {
+    Matrix matScale = MatrixScale(object->scale, object->scale, object->scale);
+    Matrix matTranslation = MatrixTranslate(object->position.x, object->position.y, object->position.z);
+    Matrix matModel = object->pending ? MatrixIdentity() : object->model->transform;
+    Matrix matTransform = MatrixMultiply(matModel, MatrixMultiply(matScale, matTranslation));
+    return Cull_TransformBox(object->localBounds, matTransform);
+}
+
+// Path of a shader source for the GLSL version this platform builds
+static const char *ShaderPath(Arena *arena, const char *fileName) {
+    return (const char *) Str8_PushF(arena, "data/shaders/glsl%i/%s", GLSL_VERSION, fileName).str;
+}
+
+#if !defined(CLUSTERED_LIGHTING)
+// Copy an existing light, resolving its uniform locations in another lighting shader
+static Light BindLightToShader(Light light, int index, Shader shader) {
+    Arena_Temp scratch = Arena_ScratchBegin();
+    light.enabledLoc  = GetShaderLocation(shader, (const char *) Str8_PushF(scratch.arena, "lights[%i].enabled", index).str);
+    light.typeLoc     = GetShaderLocation(shader, (const char *) Str8_PushF(scratch.arena, "lights[%i].type", index).str);
+    light.positionLoc = GetShaderLocation(shader, (const char *) Str8_PushF(scratch.arena, "lights[%i].position", index).str);
+    light.targetLoc   = GetShaderLocation(shader, (const char *) Str8_PushF(scratch.arena, "lights[%i].target", index).str);
+    light.colorLoc    = GetShaderLocation(shader, (const char *) Str8_PushF(scratch.arena, "lights[%i].color", index).str);
+    Arena_ScratchEnd(scratch);
+
+    UpdateLightValues(shader, light);
+
+    return light;
+}
+#endif
+
+// A lighting shader was rebuilt from edited sources, everything holding on to the old program or its locations
+// moves over to the new one, the old one is unloaded right after this, user points at the reloaded program's handle
+static void OnLightingShaderReload(Shader previous, Shader current, void *user) {
+    struct Scene *scene = &state.scene;
+    ShaderCache_Handle handle = *(const ShaderCache_Handle *) user;
+    b8 instancing = handle == scene->instancingShaderHandle;
+    b8 baked = handle == state.lightmap.shaderHandle;
+
+    if (baked) {
+        current.locs[SHADER_LOC_MAP_DIFFUSE + LIGHTMAP_MATERIAL_MAP] = GetShaderLocation(current, "lightmap");
+        state.lightmap.shader = current;
+        for (u32 i = 0; i < state.lightmap.modelCount; i++) {
+            state.lightmap.models[i].materials[0].shader = current;
+        }
+    } else if (instancing) {
+        current.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(current, "instanceTransform");
+        scene->instancingShader = current;
+        Batch_SetShader(current);
+    } else {
+        scene->shader = current;
+        Model *models[] = { &scene->placeholder, &scene->ground, &scene->treeTrunk, &scene->treeCanopy };
+        for (u32 i = 0; i < sizeof(models) / sizeof(models[0]); i++) {
+            models[i]->materials[0].shader = current;
+        }
+        for (u32 i = 0; i < scene->wallCount; i++) {
+            scene->walls[i].materials[0].shader = current;
+        }
+        // streamed models still loading pick up scene->shader once they're ready
+        for (u32 i = 0; i < scene->objectCount; i++) {
+            Model *model = scene->objects[i].model;
+            for (int m = 0; !scene->objects[i].pending && m < model->materialCount; m++) {
+                if (model->materials[m].shader.id == previous.id) model->materials[m].shader = current;
+            }
+        }
+    }
+
+    // GL may hand out an id the uniform cache still remembers values for
+    Uniform_Invalidate(current);
+    Uniform_FrameDetach(previous);
+    Uniform_FrameAttach(current);
+#if defined(CLUSTERED_LIGHTING)
+    Cluster_UnbindShader(previous);
+    Cluster_BindShader(current);
+#else
+    for (int i = 0; i < MAX_LIGHTS && !baked; i++) {
+        if (instancing) {
+            scene->instancingLights[i] = BindLightToShader(scene->lights[i], i, current);
+        } else {
+            scene->lights[i] = BindLightToShader(scene->lights[i], i, current);
+        }
+    }
+#endif
+
+    RenderGraph_Invalidate(state.renderTextures.firstPersonTarget);
+}
+
+// Light baked into the static level by fiddle-bake, its boxes are drawn with lighting_baked.frag which reads
+// the lightmap back and only evaluates the lights that weren't baked, see lightmap.h
+static void LoadLightmap(Arena *arena, u64 levelHash) {
+    Lightmap *lightmap = Lightmap_Load(LIGHTMAP_FILE, levelHash);
+    if (lightmap == NULL) {
+        TraceLog(LOG_INFO, "LIGHTMAP: Not baked for this level, build the fiddle-bake-lightmap target to bake it");
+        return;
+    }
+
+    // a program that didn't build is raylib's default shader, its locations are shared by everything drawn
+    // without a shader of its own, so the level is lit live instead
+    ShaderCache_Handle shaderHandle = ShaderCache_Load(
+            ShaderPath(arena, "lighting_baked.vert"),
+            ShaderPath(arena, "lighting_baked.frag"));
+    if (shaderHandle == 0) {
+        TraceLog(LOG_WARNING, "LIGHTMAP: lighting_baked shader didn't build, drawing the level without the lightmap");
+        Lightmap_Unload(lightmap);
+        return;
+    }
+
+    state.lightmap.lightmap = lightmap;
+    state.lightmap.texture = LoadTextureFromImage(Lightmap_GetImage(lightmap));
+    SetTextureFilter(state.lightmap.texture, TEXTURE_FILTER_BILINEAR);
+
+    state.lightmap.shaderHandle = shaderHandle;
+    state.lightmap.shader = ShaderCache_Get(shaderHandle);
+    // NOTE: DrawMesh() binds a material's map i to the sampler at location SHADER_LOC_MAP_DIFFUSE + i
+    state.lightmap.shader.locs[SHADER_LOC_MAP_DIFFUSE + LIGHTMAP_MATERIAL_MAP] = GetShaderLocation(state.lightmap.shader, "lightmap");
+    ShaderCache_OnReload(shaderHandle, OnLightingShaderReload, &state.lightmap.shaderHandle);
+    Uniform_FrameAttach(state.lightmap.shader);
+#if defined(CLUSTERED_LIGHTING)
+    Cluster_BindShader(state.lightmap.shader);
+#endif
+
+    state.lightmap.modelCount = Lightmap_BoxCount(lightmap);
+    state.lightmap.models = calloc(state.lightmap.modelCount, sizeof(Model));
+    for (u32 i = 0; i < state.lightmap.modelCount; i++) {
+        Model *model = &state.lightmap.models[i];
+        *model = LoadModelFromMesh(Lightmap_GenBoxMesh(lightmap, i));
+        model->materials[0].shader = state.lightmap.shader;
+        model->materials[0].maps[LIGHTMAP_MATERIAL_MAP].texture = state.lightmap.texture;
+    }
+}
+
+#if defined(CLUSTERED_LIGHTING)
+// Clustered point lights: the static level's lights (see level.h), baked when there's a lightmap so the
+// lightmapped boxes skip them, plus one circling the coin that stays live everywhere
+static void AddSceneLights(const Cluster_Light *lights, u32 count) {
+    for (u32 i = 0; i < count; i++) {
+        Cluster_Light light = lights[i];
+        light.baked = state.lightmap.lightmap != NULL;
+        Cluster_AddLight(light);
+    }
+    state.scene.coinLight = Cluster_AddLight(CoinLight(state.scene.coinRotY));
+}
+
+// goes around the coin as it spins, low enough to light the ground under it
+static Cluster_Light CoinLight(f32 rotation) {
+    const f32 orbit = 2;
+    f32 angle = rotation * DEG2RAD;
+    return (Cluster_Light) {
+            .position = { orbit * cosf(angle), 2, orbit * sinf(angle) },
+            .radius = 6,
+            .color = GOLD,
+            .intensity = 2
+    };
+}
+#endif
+
 static void UnloadGameData() {
-    UnloadModel(state.scene.coin);
+    UI_Shutdown();
+
+#if defined(CLUSTERED_LIGHTING)
+    Cluster_Unload();
+#endif
+    Uniform_Shutdown();
+    TileMap_Unload(state.tileMap);
+
+    Batch_Unload();
+    RenderQueue_Shutdown();
+    Cull_BVHUnload(state.scene.bvh);
+    Entity_StoreUnload(state.pickups.entities);
+    free(state.pickups.visible);
+
+    Loader_Shutdown();
+    Job_Shutdown();
+    Raycast_Shutdown();
+    Sim_RecordingFree(&simulation.recording);
+    FrameBench_Shutdown();
+    Profiler_Shutdown();
+    GpuTimer_Shutdown();
+    RenderGraph_Shutdown();
+
+    UnloadModel(state.scene.placeholder);
     UnloadModel(state.scene.ground);
     UnloadModel(state.scene.treeTrunk);
     UnloadModel(state.scene.treeCanopy);
+    for (u32 i = 0; i < state.scene.wallCount; i++) {
+        UnloadModel(state.scene.walls[i]);
+    }
+    for (u32 i = 0; i < state.lightmap.modelCount; i++) {
+        UnloadModel(state.lightmap.models[i]);
+    }
+    free(state.lightmap.models);
+    if (state.lightmap.lightmap != NULL) {
+        UnloadTexture(state.lightmap.texture);
+        Lightmap_Unload(state.lightmap.lightmap);
+    }
+    Occlusion_Unload(state.occlusion.buffer);
 
-    UnloadShader(state.scene.shader);
+    ShaderCache_Shutdown();
 
     UnloadRenderTexture(state.renderTextures.overhead);
     UnloadRenderTexture(state.renderTextures.firstPerson);
 }
 
-static Color getMapColor(int mapIndex) {
-    if (mapIndex < 0 || mapIndex >= MAP_SIZE * MAP_SIZE) {
-        return MAGENTA;
+// World map: a grid of rooms with doorways, the hand made map in the top left corner
+static void BuildTileMap(void) {
+    const float tileSize = 50;
+    const int roomSize = 16;
+    const int worldSize = WORLD_MAP_SIZE;
+
+    state.tileMap = TileMap_Create(WORLD_MAP_SIZE, WORLD_MAP_SIZE, tileSize);
+    for (int tile = 0; tile < 256; tile++) {
+        TileMap_SetColor(state.tileMap, (u8) tile, getMapColor((u8) tile));
+    }
+
+    for (int i = 0; i < worldSize; i += roomSize) {
+        TileMap_Fill(state.tileMap, i, 0, 1, worldSize, 1);
+        TileMap_Fill(state.tileMap, 0, i, worldSize, 1, 1);
+    }
+    TileMap_Fill(state.tileMap, worldSize - 1, 0, 1, worldSize, 1);
+    TileMap_Fill(state.tileMap, 0, worldSize - 1, worldSize, 1, 1);
+    for (int y = 0; y < worldSize; y += roomSize) {
+        for (int x = 0; x < worldSize; x += roomSize) {
+            if (x > 0) TileMap_Fill(state.tileMap, x, y + roomSize / 2 - 1, 1, 2, 0);
+            if (y > 0) TileMap_Fill(state.tileMap, x + roomSize / 2 - 1, y, 2, 1, 0);
+        }
+    }
+
+    for (int i = 0; i < MAP_SIZE * MAP_SIZE; i++) {
+        TileMap_Set(state.tileMap, i % MAP_SIZE, i / MAP_SIZE, state.map[i]);
     }
+}
 
-    switch (state.map[mapIndex]) {
+static Color getMapColor(u8 tile) {
+    switch (tile) {
         default: return MAGENTA;
         case 0: return DARKGRAY;
         case 1: return BLUE;
@@ -212,65 +924,530 @@ static Color getMapColor(int mapIndex) {
     }
 }
 
+// one ray per column, facing the same way as the first person camera
+static void CastViewRays(const struct Player *player, const Camera3D *firstPersonCamera) {
+    const f32 maxDistance = 1000;
+
+    Vector3 forward = Vector3Subtract(firstPersonCamera->target, firstPersonCamera->position);
+    f32 angle = atan2f(forward.z, forward.x);
+
+    Texture texture = state.renderTextures.firstPerson.texture;
+    f32 aspect = (f32) texture.width / (f32) texture.height;
+    f32 fov = 2.0f * atanf(tanf(DEG2RAD * firstPersonCamera->fovy / 2.0f) * aspect);
+
+    Raycast_Columns(state.tileMap, player->pos, angle, fov, maxDistance, viewRays, VIEW_RAY_COLUMNS);
+}
+
+static void PickWall(const struct Player *player, Camera2D camera) {
+    Vector2 target = GetScreenToWorld2D(GetMousePosition(), camera);
+    Vector2 direction = Vector2Subtract(target, player->pos);
+
+    Raycast_Hit hit = Raycast_Cast(state.tileMap, (Raycast_Ray) { player->pos, direction, Vector2Length(direction) });
+    if (hit.hit) {
+        TileMap_Set(state.tileMap, hit.tileX, hit.tileY, 0);
+    }
+}
+
+// held buttons are sampled every frame, presses and wheel movement add up until a tick uses them
+static Sim_Input PollSimInput(Sim_Input pending) {
+    u32 buttons = pending.buttons & Sim_Button_ResetView;
+    if (IsKeyDown(KEY_A)) buttons |= Sim_Button_Left;
+    if (IsKeyDown(KEY_D)) buttons |= Sim_Button_Right;
+    if (IsKeyDown(KEY_W)) buttons |= Sim_Button_Up;
+    if (IsKeyDown(KEY_S)) buttons |= Sim_Button_Down;
+    if (IsKeyDown(KEY_E)) buttons |= Sim_Button_RotateCW;
+    if (IsKeyDown(KEY_Q)) buttons |= Sim_Button_RotateCCW;
+    if (IsKeyPressed(KEY_R)) buttons |= Sim_Button_ResetView;
+
+    return (Sim_Input) { .buttons = buttons, .zoom = pending.zoom + GetMouseWheelMove() };
+}
+
+static void ToggleSimRecording(void) {
+    if (!simulation.recordingActive) {
+        Sim_RecordingFree(&simulation.recording);
+        simulation.recording.start = simulation.current;
+        simulation.recordingActive = true;
+        TraceLog(LOG_INFO, "SIM: Recording input from tick %llu", (unsigned long long) simulation.current.tick);
+        return;
+    }
+
+    simulation.recordingActive = false;
+    if (Sim_RecordingSave(&simulation.recording, SIM_RECORDING_FILE)) {
+        // a replay of exactly that many ticks has to end on the same hash
+        TraceLog(LOG_INFO, "SIM: Saved %u ticks of input to %s, final state hash %016llx, replay with 'fiddle-bench sim --input=%s --ticks=%u'",
+                 simulation.recording.count, SIM_RECORDING_FILE, (unsigned long long) Sim_Hash(&simulation.current),
+                 SIM_RECORDING_FILE, simulation.recording.count);
+    }
+}
+
+// fiddle [--benchmark[=frames]] [--benchmark-out=name] [--lod=off] [--occlusion=off] [--lightmap=off] [--quantize] [--pickups=count]
+static void ParseArgs(int argc, char **argv) {
+    state.benchmark.frames = BENCHMARK_DEFAULT_FRAMES;
+    state.benchmark.output = "framebench";
+    state.lod.enabled = true;
+    state.occlusion.enabled = true;
+    state.lightmap.enabled = true;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--benchmark") == 0) {
+            state.benchmark.enabled = true;
+        } else if (strncmp(arg, "--benchmark=", 12) == 0) {
+            state.benchmark.enabled = true;
+            u32 frames = (u32) strtoul(arg + 12, NULL, 10);
+            if (frames > 0) state.benchmark.frames = frames;
+        } else if (strncmp(arg, "--benchmark-out=", 16) == 0) {
+            state.benchmark.output = arg + 16;
+        } else if (strcmp(arg, "--lod=off") == 0) {
+            state.lod.enabled = false;
+        } else if (strcmp(arg, "--occlusion=off") == 0) {
+            state.occlusion.enabled = false;
+        } else if (strcmp(arg, "--lightmap=off") == 0) {
+            state.lightmap.enabled = false;
+        } else if (strcmp(arg, "--quantize") == 0) {
+            state.loading.quantize = true;
+        } else if (strncmp(arg, "--pickups=", 10) == 0) {
+            state.pickups.count = (u32) strtoul(arg + 10, NULL, 10);
+        } else {
+            TraceLog(LOG_WARNING, "Unknown argument '%s'", arg);
+        }
+    }
+}
+
+// the script advances one tick per frame, the path repeats for runs longer than it
+static void ApplyBenchmarkPath(struct Player *player, Camera2D *camera, Camera3D *firstPersonCamera) {
+    const u32 keyCount = sizeof(benchmarkPath) / sizeof(benchmarkPath[0]);
+    const u32 pathFrames = (u32) (benchmarkPath[keyCount - 1].time * SIM_TICK_RATE);
+
+    f32 time = (f32) (state.benchmark.frame % pathFrames) / (f32) SIM_TICK_RATE;
+    FrameBench_Key key = FrameBench_SamplePath(benchmarkPath, keyCount, time);
+
+    player->pos = key.playerPos;
+    camera->target = key.playerPos;
+    camera->rotation = key.overheadRotation;
+    camera->zoom = key.overheadZoom;
+    firstPersonCamera->position = key.eye;
+    firstPersonCamera->target = key.target;
+}
+
+static void WriteBenchmarkReport(void) {
+    Arena_Temp scratch = Arena_ScratchBegin();
+    const char *json = (const char *) Str8_PushF(scratch.arena, "%s.json", state.benchmark.output).str;
+    const char *csv = (const char *) Str8_PushF(scratch.arena, "%s.csv", state.benchmark.output).str;
+
+    if (FrameBench_IsDone() && FrameBench_WriteJSON(json) && FrameBench_WriteCSV(csv)) {
+        TraceLog(LOG_INFO, "FRAMEBENCH: %u frames on %s, report in %s and %s", state.benchmark.frames,
+                 GpuTimer_IsAvailable() ? GpuTimer_Renderer() : "(no GPU timers)", json, csv);
+    } else {
+        TraceLog(LOG_WARNING, "FRAMEBENCH: Run didn't finish, no report written");
+    }
+    Arena_ScratchEnd(scratch);
+}
+
 static void UpdateFrame(struct Scene *scene, struct Player *player, Camera2D *camera, Camera3D *firstPersonCamera) {
     float dt = GetFrameTime();
 
+    // shaders edited since the last frame are swapped in before anything draws with them
+    ShaderCache_Update();
+
     // update the first person camera using the raylib built-in camera controls
-    UpdateCamera(firstPersonCamera, CAMERA_PERSPECTIVE);
-    // Update the shader with the camera view vector (points towards { 0.0f, 0.0f, 0.0f })
-    float cameraPos[3] = {
-            firstPersonCamera->position.x,
-            firstPersonCamera->position.y,
-            firstPersonCamera->position.z
-    };
-    SetShaderValue(scene->shader, scene->shader.locs[SHADER_LOC_VECTOR_VIEW], cameraPos, SHADER_UNIFORM_VEC3);
+    if (!state.benchmark.enabled) {
+        UpdateCamera(firstPersonCamera, CAMERA_PERSPECTIVE);
+    }
 
-    // handle movement input
-    if      (IsKeyDown(KEY_A)) player->pos.x -= player->speed.x * dt;
-    else if (IsKeyDown(KEY_D)) player->pos.x += player->speed.x * dt;
-    if      (IsKeyDown(KEY_W)) player->pos.y -= player->speed.y * dt;
-    else if (IsKeyDown(KEY_S)) player->pos.y += player->speed.y * dt;
+    // run the simulation ticks this frame's time pays for, then draw a blend of the last two,
+    // the benchmark ignores input and real time so every run simulates exactly the same ticks
+    simulation.pending = state.benchmark.enabled ? (Sim_Input) {0} : PollSimInput(simulation.pending);
+    u32 ticks = Sim_ClockAdvance(&simulation.clock, state.benchmark.enabled ? SIM_TICK_SECONDS : dt);
+    Profiler_Zone zone = PROFILE_BEGIN("sim");
+    for (u32 i = 0; i < ticks; i++) {
+        simulation.previous = simulation.current;
+        Sim_Step(&simulation.current, simulation.pending);
+        if (simulation.recordingActive) Sim_RecordingAppend(&simulation.recording, simulation.pending);
+
+        // wheel movement and presses are only applied once, held buttons stay down
+        simulation.pending.zoom = 0;
+        simulation.pending.buttons &= ~(u32) Sim_Button_ResetView;
+    }
+    Sim_State view = Sim_Interpolate(&simulation.previous, &simulation.current, Sim_ClockAlpha(&simulation.clock));
+    PROFILE_END(zone);
 
-    // update the camera based on the player's (possibly moved) position
+    player->pos = view.playerPos;
     camera->target = player->pos;
+    camera->rotation = view.cameraRotation;
+    camera->zoom = view.cameraZoom;
+    scene->coinRotY = view.coinRotation;
+#if defined(CLUSTERED_LIGHTING)
+    if (scene->coinLight != CLUSTER_NO_LIGHT) {
+        Cluster_SetLight(scene->coinLight, CoinLight(scene->coinRotY));
+    }
+#endif
+
+    if (state.benchmark.enabled) {
+        ApplyBenchmarkPath(player, camera, firstPersonCamera);
+    }
+
+    // Update the shaders with the camera position, nothing is sent while the camera stands still
+    Uniform_FrameSet(scene->uniforms.viewPos, &firstPersonCamera->position);
+    Uniform_FrameFlush();
 
-    // handle rotation input
-    if      (IsKeyDown(KEY_E)) camera->rotation++;
-    else if (IsKeyDown(KEY_Q)) camera->rotation--;
+    zone = PROFILE_BEGIN("view rays");
+    CastViewRays(player, firstPersonCamera);
+    PROFILE_END(zone);
 
-    // constrain camera rotation
-    const float maxRotation = 40.0f;
-    if      (camera->rotation >  maxRotation) camera->rotation =  maxRotation;
-    else if (camera->rotation < -maxRotation) camera->rotation = -maxRotation;
+    // right click in the overhead view knocks out the first wall between the player and the cursor
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) && GetMousePosition().x < (f32) GetScreenWidth() / 2) {
+        PickWall(player, *camera);
+    }
 
-    // handle zoom input
-    camera->zoom += GetMouseWheelMove() * 0.05f;
+    if (IsKeyPressed(KEY_F9)) {
+        ToggleSimRecording();
+    }
 
-    // constrain camera zoom
-    const float minZoom = 0.1f;
-    const float maxZoom = 3.0f;
-    if      (camera->zoom > maxZoom) camera->zoom = maxZoom;
-    else if (camera->zoom < minZoom) camera->zoom = minZoom;
+    // profiler overlay, and a trace of the next few seconds for chrome://tracing
+    if (IsKeyPressed(KEY_F3)) {
+        state.profiling.overlay = !state.profiling.overlay;
+        Profiler_SetEnabled(state.profiling.overlay || Profiler_IsCapturing());
+    }
+    if (IsKeyPressed(KEY_F4) && !Profiler_IsCapturing()) {
+        Profiler_StartCapture(PROFILE_CAPTURE_FRAMES);
+        TraceLog(LOG_INFO, "PROFILER: Capturing %u frames", PROFILE_CAPTURE_FRAMES);
+    }
 
-    // handle camera reset (rotation and zoom only)
-    if (IsKeyPressed(KEY_R)) {
-        camera->rotation = 0.0f;
-        camera->zoom = 1.0f;
+    // toggle instance batching to compare against individual draws
+    if (IsKeyPressed(KEY_I)) {
+        Batch_SetEnabled(!Batch_IsEnabled());
+    }
+
+    // toggle simplified levels for distant models to compare against full detail
+    if (IsKeyPressed(KEY_L)) {
+        state.lod.enabled = !state.lod.enabled;
+    }
+
+    // toggle culling what the walls hide to compare against drawing it all
+    if (IsKeyPressed(KEY_O)) {
+        state.occlusion.enabled = !state.occlusion.enabled;
+    }
+
+    // toggle the baked light on the static level to compare against shading it with every light live
+    if (IsKeyPressed(KEY_B)) {
+        state.lightmap.enabled = !state.lightmap.enabled;
+    }
+
+    // stream in models, spending a small slice of each frame on GPU uploads
+    if (!state.loading.complete) {
+        const f64 uploadBudget = 0.004;
+        zone = PROFILE_BEGIN("loader upload");
+        Loader_Update(uploadBudget);
+        PROFILE_END(zone);
+        ResolveStreamedSceneObjects(scene);
+
+        if (state.loading.firstFrameTime == 0) {
+            state.loading.firstFrameTime = Timer_Seconds() - state.loading.startTime;
+        } else if (dt > state.loading.worstFrameTime) {
+            // NOTE: the first frame's dt covers window creation, so it's left out of the worst frame
+            state.loading.worstFrameTime = dt;
+        }
+
+        if (Loader_IsIdle()) {
+            state.loading.complete = true;
+
+            Loader_Stats stats = Loader_GetStats();
+            TraceLog(LOG_INFO, "LOADER: %u models ready (%u failed), first frame at %.2f s, everything streamed in at %.2f s",
+                     stats.ready, stats.failed, state.loading.firstFrameTime, Timer_Seconds() - state.loading.startTime);
+            TraceLog(LOG_INFO, "LOADER: parsed %.1f MB in %.2f s of worker time, uploaded in %.2f s, worst upload slice %.1f ms, worst frame %.1f ms",
+                     (f64) stats.bytesParsed / (1024.0 * 1024.0), stats.parseSeconds, stats.uploadSeconds,
+                     stats.worstUploadSeconds * 1000.0, state.loading.worstFrameTime * 1000.0f);
+
+            Resource_Stats resources = Resource_GetStats();
+            TraceLog(LOG_INFO, "LOADER: resource cache holds %u/%u meshes and %u/%u textures (unique/referenced), saved %.1f MB VRAM and %.1f MB RAM",
+                     resources.meshes, resources.meshRefs, resources.textures, resources.textureRefs,
+                     (f64) resources.vramSaved / (1024.0 * 1024.0), (f64) resources.ramSaved / (1024.0 * 1024.0));
+
+            if (Quant_IsEnabled()) {
+                Quant_Stats quantStats = Quant_GetStats();
+                TraceLog(LOG_INFO, "LOADER: %u meshes in the compact vertex layout, %.1f MB of buffers instead of %.1f MB",
+                         quantStats.meshes, (f64) quantStats.compactBytes / (1024.0 * 1024.0),
+                         (f64) quantStats.floatBytes / (1024.0 * 1024.0));
+            }
+        }
     }
 
     // rotate the coin
-    float rotationSpeed = 300.f;
-    state.scene.coinRotY += rotationSpeed * dt;
-    state.scene.coin.transform = MatrixMultiply(
+    state.scene.coin->transform = MatrixMultiply(
             MatrixRotateZ(DEG2RAD * state.scene.coinRotZ),
             MatrixRotateY(DEG2RAD * state.scene.coinRotY));
+
+    struct SceneObject *coin = &scene->objects[scene->coinObject];
+    coin->bounds = GetSceneObjectBounds(coin);
+    Cull_BVHUpdateObject(scene->bvh, scene->coinObject, coin->bounds);
+
+    // spin the pickups, like the simulation the benchmark steps them a fixed amount per frame,
+    // ranges of them are updated as jobs while this thread helps out
+    zone = PROFILE_BEGIN("entities");
+    f64 entityStart = Timer_Seconds();
+    f32 entityDt = state.benchmark.enabled ? (f32) SIM_TICK_SECONDS : dt;
+    Job_Counter entityJobs = {0};
+    Job_ParallelFor(UpdatePickups, &entityDt, Entity_Count(state.pickups.entities), PICKUP_JOB_GRAIN, &entityJobs);
+    Job_Wait(&entityJobs);
+    state.pickups.updateSeconds = Timer_Seconds() - entityStart;
+    PROFILE_END(zone);
+
+    UI_Input input = {
+            .mouse = GetMousePosition(),
+            .mouseDown = IsMouseButtonDown(MOUSE_BUTTON_LEFT),
+            .mousePressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT),
+            .mouseReleased = IsMouseButtonReleased(MOUSE_BUTTON_LEFT)
+    };
+    zone = PROFILE_BEGIN("ui build");
+    UI_BeginFrame((Vector2) { (f32) GetScreenWidth(), (f32) GetScreenHeight() }, input, dt);
+    BuildUI();
+    UI_EndFrame();
+    PROFILE_END(zone);
 }
 
-static void UpdateDrawFrame(void) {
-    UpdateFrame(&state.scene, &state.player, &state.cameras.overhead, &state.cameras.firstPerson);
+static f32 MeasureUIText(String8 text, f32 fontSize) {
+    char buffer[256];
+    u64 size = (text.size < sizeof(buffer) - 1) ? text.size : sizeof(buffer) - 1;
+    memcpy(buffer, text.str, size);
+    buffer[size] = '\0';
+    return (f32) MeasureText(buffer, (int) fontSize);
+}
 
-    // draw to overhead texture
-    BeginTextureMode(state.renderTextures.overhead);
+static void BuildUI(void) {
+    // skip the overhead view's title bar
+    UI_PushPrefSize(Axis2_Y, UI_SizePx(40, 1));
+    UI_WidgetMake(0, Str8Lit(""));
+    UI_PopPrefSize(Axis2_Y);
+
+    UI_PushPrefSize(Axis2_X, UI_SizeChildrenSum(1));
+    UI_PushPrefSize(Axis2_Y, UI_SizeChildrenSum(1));
+    UI_Widget *panel = UI_WidgetMake(UI_WidgetFlag_DrawBackground | UI_WidgetFlag_DrawBorder | UI_WidgetFlag_DrawDropShadow,
+                                     Str8Lit("###debug_panel"));
+    UI_WidgetEquipChildLayoutAxis(panel, Axis2_Y);
+    UI_PopPrefSize(Axis2_X);
+    UI_PopPrefSize(Axis2_Y);
+
+    UI_PushParent(panel);
+    {
+        UI_PushPrefSize(Axis2_X, UI_SizePx(200, 1));
+        UI_PushPrefSize(Axis2_Y, UI_SizePx(20, 1));
+
+        Arena *frame = UI_FrameArena();
+        if (UI_Button(Str8_PushF(frame, "batching: %s###batching", Batch_IsEnabled() ? "on" : "off")).clicked) {
+            Batch_SetEnabled(!Batch_IsEnabled());
+        }
+        if (UI_Button(Str8_PushF(frame, "lod: %s###lod", state.lod.enabled ? "on" : "off")).clicked) {
+            state.lod.enabled = !state.lod.enabled;
+        }
+        if (UI_Button(Str8_PushF(frame, "occlusion: %s###occlusion", state.occlusion.enabled ? "on" : "off")).clicked) {
+            state.occlusion.enabled = !state.occlusion.enabled;
+        }
+        if (state.occlusion.enabled) {
+            UI_Label(Str8_PushF(frame, "occluded: %u/%u, %.3f ms###occluded",
+                                state.occlusion.rejected, state.occlusion.tested, state.occlusion.seconds * 1000.0));
+        }
+
+#if defined(CLUSTERED_LIGHTING)
+        Cluster_Stats clusterStats = Cluster_GetStats();
+        UI_Label(Str8_PushF(frame, "lights: %u, lit clusters %u/%u, max %u###lights",
+                            clusterStats.lightsBinned, clusterStats.clustersLit, clusterStats.clusters,
+                            clusterStats.maxClusterLights));
+#endif
+
+        if (UI_Button(Str8_PushF(frame, "lightmap: %s###lightmap", state.lightmap.enabled ? "on" : "off")).clicked) {
+            state.lightmap.enabled = !state.lightmap.enabled;
+        }
+        if (state.lightmap.lightmap == NULL) {
+            UI_Label(Str8Lit("not baked, see fiddle-bake-lightmap"));
+        }
+#if defined(CLUSTERED_LIGHTING)
+        if (state.lightmap.lightmap != NULL && state.lightmap.enabled) {
+            UI_Label(Str8_PushF(frame, "baked: %u of %u cluster lights skipped###baked",
+                                clusterStats.indicesBaked, clusterStats.indices));
+        }
+#endif
+
+        TileMap_Stats mapStats = TileMap_GetStats(state.tileMap);
+        UI_Label(Str8_PushF(frame, "map: %u/%u chunks, %u rects for %u tiles###map",
+                            mapStats.chunksVisible, mapStats.chunks, mapStats.quadsVisible, mapStats.tilesVisible));
+
+        Uniform_Stats uniformStats = Uniform_GetStats();
+        UI_Label(Str8_PushF(frame, "uniforms: %u sent (%llu B), %u skipped###uniforms",
+                            uniformStats.uploads, (unsigned long long) uniformStats.bytesUploaded, uniformStats.skipped));
+
+        if (UI_Button(Str8_PushF(frame, "dynamic resolution: %s###dynres", DynRes_IsEnabled() ? "on" : "off")).clicked) {
+            DynRes_SetEnabled(!DynRes_IsEnabled());
+        }
+        DynRes_Stats resolution = DynRes_GetStats();
+        UI_Label(Str8_PushF(frame, "scale: %.0f%% / %.0f%%, %.1f of %.1f ms###scale",
+                            DynRes_GetScale(state.renderTextures.overheadView) * 100.0f,
+                            DynRes_GetScale(state.renderTextures.firstPersonView) * 100.0f,
+                            resolution.cost * 1000.0, resolution.budget * 1000.0));
+
+        RenderGraph_Stats graphStats = RenderGraph_GetStats();
+        UI_Label(Str8_PushF(frame, "passes: %u drawn, %u unchanged###passes", graphStats.executed, graphStats.skipped));
+
+        if (state.pickups.entities != NULL) {
+            UI_Label(Str8_PushF(frame, "pickups: %u/%u visible, update %.3f ms###pickups", state.pickups.visibleCount,
+                                Entity_Count(state.pickups.entities), state.pickups.updateSeconds * 1000.0));
+        }
+
+        Job_Stats jobStats = Job_GetStats();
+        UI_Label(Str8_PushF(frame, "jobs: %u workers, %llu run, %llu stolen###jobs", jobStats.workers,
+                            (unsigned long long) jobStats.jobs, (unsigned long long) jobStats.steals));
+
+        RenderQueue_Stats queueStats = RenderQueue_GetStats();
+        UI_Label(Str8_PushF(frame, "queue: %u draws, %u/%u/%u shader/material/mesh changes, sort %.3f ms###queue",
+                            queueStats.draws, queueStats.shaderChanges, queueStats.materialChanges,
+                            queueStats.meshChanges, queueStats.sortSeconds * 1000.0));
+
+        ShaderCache_Stats shaderStats = ShaderCache_GetStats();
+        UI_Label(Str8_PushF(frame, "shaders: %u cached, %u compiled, %u reloads###shaders",
+                            shaderStats.cached, shaderStats.compiled, shaderStats.reloads));
+
+        UI_Stats uiStats = UI_GetStats();
+        UI_Label(Str8_PushF(frame, "ui cache: %u widgets, frame arena %.1f KB###uicache",
+                            uiStats.cached, (f64) uiStats.frameArenaBytes / 1024.0));
+
+        UI_PopPrefSize(Axis2_X);
+        UI_PopPrefSize(Axis2_Y);
+    }
+    UI_PopParent();
+}
+
+// F3, the profiler's rows over the first person view, bars are against a 60 Hz frame
+static void DrawProfilerOverlay(void) {
+    const Profiler_Row *rows;
+    u32 rowCount = Profiler_GetRows(&rows);
+    Profiler_Stats stats = Profiler_GetStats();
+
+    // a heading line for every thread
+    u32 lines = rowCount;
+    for (u32 i = 0; i < rowCount; i++) {
+        if (i == 0 || rows[i].thread != rows[i - 1].thread) lines++;
+    }
+
+    const f32 width = 340, lineHeight = 12, barWidth = 90;
+    const f32 frameSeconds = 1.0f / 60.0f;
+    Rectangle panel = { (f32) GetScreenWidth() - width - 10, 50, width, 34 + (f32) lines * lineHeight };
+
+    int textSize = GuiGetStyle(DEFAULT, TEXT_SIZE);
+    GuiSetStyle(DEFAULT, TEXT_SIZE, 10);
+    GuiPanel(panel, TextFormat("profiler: %u threads, %llu zones dropped%s", stats.threads,
+                               (unsigned long long) stats.dropped, Profiler_IsCapturing() ? ", capturing" : ""));
+
+    f32 x = panel.x + 8, y = panel.y + 28;
+    for (u32 i = 0; i < rowCount; i++) {
+        const Profiler_Row *row = &rows[i];
+        if (i == 0 || row->thread != rows[i - 1].thread) {
+            GuiLabel((Rectangle) { x, y, 150, lineHeight }, TextFormat("[%s]", row->thread));
+            y += lineHeight;
+        }
+
+        GuiLabel((Rectangle) { x + 8 + (f32) row->depth * 10, y, 150, lineHeight }, row->name);
+
+        f32 fill = (f32) row->seconds / frameSeconds;
+        Color color = (strcmp(row->thread, "gpu") == 0) ? ORANGE : SKYBLUE;
+        DrawRectangleRec((Rectangle) { x + 160, y + 3, barWidth * (fill < 1 ? fill : 1), lineHeight - 5 }, Fade(color, 0.8f));
+        DrawRectangleLinesEx((Rectangle) { x + 160, y + 3, barWidth, lineHeight - 5 }, 1, Fade(color, 0.4f));
+
+        GuiLabel((Rectangle) { x + 256, y, 80, lineHeight }, TextFormat("%6.2f ms x%.0f", row->seconds * 1000.0, row->calls));
+        y += lineHeight;
+    }
+    GuiSetStyle(DEFAULT, TEXT_SIZE, textSize);
+}
+
+// passes are timed by the profiler, a zone and a GPU query, and by the benchmark while it records
+struct Pass {
+    u32 bench;
+    Profiler_Pass profiler;
+};
+
+static struct Pass BeginPass(const char *name) {
+    return (struct Pass) { .bench = FrameBench_BeginPass(name), .profiler = Profiler_BeginPass(name) };
+}
+
+static void EndPass(struct Pass pass) {
+    Profiler_EndPass(pass.profiler);
+    FrameBench_EndPass(pass.bench);
+}
+
+// everything the overhead view draws from, its pass is skipped while none of it changes
+static u64 HashOverheadInputs(void) {
+    u64 hash = RenderGraph_Hash(0, &state.cameras.overhead, sizeof(state.cameras.overhead));
+    hash = RenderGraph_Hash(hash, &state.player.pos, sizeof(state.player.pos));
+
+    // the view rays fan out along the first person camera and stop at the map's walls
+    hash = RenderGraph_Hash(hash, &state.cameras.firstPerson, sizeof(state.cameras.firstPerson));
+    u32 mapVersion = TileMap_Version(state.tileMap);
+    hash = RenderGraph_Hash(hash, &mapVersion, sizeof(mapVersion));
+
+    f32 scale = DynRes_GetScale(state.renderTextures.overheadView);
+    return RenderGraph_Hash(hash, &scale, sizeof(scale));
+}
+
+// the first person view is culled before the graph runs, so what's visible is part of its inputs
+static u64 HashFirstPersonInputs(void) {
+    const struct Scene *scene = &state.scene;
+    u64 hash = RenderGraph_Hash(0, &state.cameras.firstPerson, sizeof(state.cameras.firstPerson));
+    hash = RenderGraph_Hash(hash, &scene->version, sizeof(scene->version));
+    hash = RenderGraph_Hash(hash, &scene->visibleCount, sizeof(scene->visibleCount));
+    hash = RenderGraph_Hash(hash, scene->visibleObjects, scene->visibleCount * sizeof(scene->visibleObjects[0]));
+
+    // the coin spins, it only keeps the view redrawing while it's in sight
+    for (u32 i = 0; i < scene->visibleCount; i++) {
+        if (scene->visibleObjects[i] == scene->coinObject) {
+            hash = RenderGraph_Hash(hash, &scene->coin->transform, sizeof(scene->coin->transform));
+            break;
+        }
+    }
+
+#if defined(CLUSTERED_LIGHTING)
+    // its light goes around with it and reaches further, so it counts while anything it reaches is in view
+    if (scene->coinLight != CLUSTER_NO_LIGHT) {
+        Cluster_Light coinLight = Cluster_GetLight(scene->coinLight);
+        Vector3 reach = { coinLight.radius, coinLight.radius, coinLight.radius };
+        BoundingBox lightBounds = { Vector3Subtract(coinLight.position, reach), Vector3Add(coinLight.position, reach) };
+        Texture2D firstPerson = state.renderTextures.firstPerson.texture;
+        Cull_Frustum frustum = Cull_FrustumFromCamera(state.cameras.firstPerson, (f32) firstPerson.width / (f32) firstPerson.height);
+        if (Cull_FrustumTestBox(&frustum, lightBounds)) {
+            hash = RenderGraph_Hash(hash, &coinLight.position, sizeof(coinLight.position));
+        }
+    }
+#endif
+
+    // the static level switches between its baked and live shading
+    hash = RenderGraph_Hash(hash, &state.lightmap.enabled, sizeof(state.lightmap.enabled));
+
+    // the pickups spin every frame, visible ones invalidate the view instead of hashing every matrix,
+    // see UpdateDrawFrame(), the count still changes the hash when the last one leaves the view
+    hash = RenderGraph_Hash(hash, &state.pickups.visibleCount, sizeof(state.pickups.visibleCount));
+
+    // levels only change with the camera, except when one finishes uploading or lod is toggled
+    for (u32 i = 0; i < scene->visibleCount; i++) {
+        const struct SceneObject *object = &scene->objects[scene->visibleObjects[i]];
+        hash = RenderGraph_Hash(hash, &object->lod, sizeof(object->lod));
+    }
+
+    b8 batching = Batch_IsEnabled();
+    hash = RenderGraph_Hash(hash, &batching, sizeof(batching));
+    if (!state.loading.complete) {
+        Loader_Stats loaderStats = Loader_GetStats();
+        u32 progress[] = { loaderStats.ready, loaderStats.failed, loaderStats.requested };
+        hash = RenderGraph_Hash(hash, progress, sizeof(progress));
+    }
+
+    f32 scale = DynRes_GetScale(state.renderTextures.firstPersonView);
+    return RenderGraph_Hash(hash, &scale, sizeof(scale));
+}
+
+static void DrawOverheadPass(RenderTexture2D target, void *user) {
+    (void) user;
+
+    struct Pass pass = BeginPass("overhead");
+    BeginTextureMode(target);
+    DynRes_BeginView(state.renderTextures.overheadView);
     {
         ClearBackground(SKYBLUE);
 
@@ -283,9 +1460,16 @@ static void UpdateDrawFrame(void) {
             DrawGrid(100, 50);
             rlPopMatrix();
 
-            // draw the map tiles
-            for (int i = 0; i < MAP_SIZE * MAP_SIZE; i++) {
-                DrawRectangleRec(state.tiles[i], getMapColor(i));
+            // draw the map tiles, only chunks in view and only as many rectangles as it takes
+            Vector2 overheadSize = { (f32) target.texture.width, (f32) target.texture.height };
+            Profiler_Zone zone = PROFILE_BEGIN("tilemap");
+            TileMap_PrepareView(state.tileMap, state.cameras.overhead, overheadSize);
+            TileMap_Draw(state.tileMap);
+            PROFILE_END(zone);
+
+            // draw what the player can see
+            for (int i = 0; i < VIEW_RAY_COLUMNS; i++) {
+                DrawLineV(state.player.pos, viewRays[i].point, Fade(viewRays[i].hit ? YELLOW : LIGHTGRAY, 0.4f));
             }
 
             // draw the player
@@ -299,44 +1483,151 @@ static void UpdateDrawFrame(void) {
         DrawText("Overhead", 10, 10, 20, MAROON);
     }
     EndTextureMode();
+    DynRes_EndView(state.renderTextures.overheadView);
+    EndPass(pass);
+}
+
+// what the first person pass records per mesh, the models outlive the frame so it only points at them
+struct QueuedMesh {
+    const Mesh *mesh;
+    const Material *material;
+    Matrix transform;
+    Color tint;
+};
+
+static void QueueModel(Model model, Matrix matTransform, Color tint, Vector3 eye) {
+    Vector3 position = { matTransform.m12, matTransform.m13, matTransform.m14 };
+    f32 depth = Vector3Distance(eye, position) / (f32) RL_CULL_DISTANCE_FAR;
+
+    for (int i = 0; i < model.meshCount; i++) {
+        const Mesh *mesh = &model.meshes[i];
+        const Material *material = &model.materials[model.meshMaterial[i]];
+        u64 key = RenderQueue_Key(0, RenderQueue_Layer_Opaque, material->shader.id, RenderQueue_MaterialId(*material),
+                                  mesh->vaoId, depth);
 
+        struct QueuedMesh *queued = RenderQueue_Push(0, key, sizeof(struct QueuedMesh));
+        if (queued == NULL) continue;
+        *queued = (struct QueuedMesh) { mesh, material, matTransform, tint };
+    }
+}
+
+static void QueueSceneModel(Model model, Vector3 position, f32 scale, Color tint, Vector3 eye) {
+    // same transform composition as Batch_AddModel()
+    Matrix matScale = MatrixScale(scale, scale, scale);
+    Matrix matTranslation = MatrixTranslate(position.x, position.y, position.z);
+    QueueModel(model, MatrixMultiply(model.transform, MatrixMultiply(matScale, matTranslation)), tint, eye);
+}
+
+static void DrawQueuedMesh(u64 key, const void *payload, void *user) {
+    (void) key;
+    (void) user;
+    const struct QueuedMesh *queued = payload;
+    Batch_AddMesh(*queued->mesh, *queued->material, queued->transform, queued->tint);
+}
 
-    BeginTextureMode(state.renderTextures.firstPerson);
+static void DrawFirstPersonPass(RenderTexture2D target, void *user) {
+    (void) user;
+
+    struct Pass pass = BeginPass("first_person");
+    BeginTextureMode(target);
+    DynRes_BeginView(state.renderTextures.firstPersonView);
     {
         ClearBackground(SKYBLUE);
 
-        BeginMode3D(state.cameras.firstPerson);
-        {
-            // Draw scene: grid of cube trees on a plane to make a "world"
-            DrawModel(state.scene.ground, (Vector3){ 0, 0, 0 }, 1, BEIGE); // Simple world plane
-
-            const int count = 5;
-            const float spacing = 4;
-            for (float x = -count*spacing; x <= count*spacing; x += spacing) {
-                for (float z = -count*spacing; z <= count*spacing; z += spacing) {
-                    DrawModel(state.scene.treeTrunk, (Vector3) { x, 1.5f, z }, 1, LIME);
-                    DrawModel(state.scene.treeCanopy, (Vector3) { x, 0.5f, z }, 1, BROWN);
-                }
-            }
+#if defined(CLUSTERED_LIGHTING)
+        // lights are binned for the same camera and aspect the scene was culled with
+        Profiler_Zone zone = PROFILE_BEGIN("light binning");
+        Cluster_BinLights(state.cameras.firstPerson, (f32) target.texture.width / (f32) target.texture.height);
+        Cluster_BeginDraw(state.cameras.firstPerson, DynRes_GetSize(state.renderTextures.firstPersonView));
+        PROFILE_END(zone);
 
-            // Draw a 3d model for testing
-            DrawModel(state.scene.coin, (Vector3) { 0, 3.f, 0 }, 1, WHITE);
+        zone = PROFILE_BEGIN("scene");
+#else
+        Profiler_Zone zone = PROFILE_BEGIN("scene");
+#endif
+        // recorded, sorted by state and front to back, then handed to the batch in that order
+        Vector3 eye = state.cameras.firstPerson.position;
+        RenderQueue_Begin();
+        for (u32 i = 0; i < state.scene.visibleCount; i++) {
+            struct SceneObject *object = &state.scene.objects[state.scene.visibleObjects[i]];
+            if (object->pending) {
+                QueueSceneModel(state.scene.placeholder, object->position, object->scale, LIGHTGRAY, eye);
+            } else if (object->lod > 0) {
+                QueueSceneModel(Loader_GetModelLod(object->asset, object->lod), object->position, object->scale, object->tint, eye);
+            } else if (object->baked != NULL && state.lightmap.enabled) {
+                QueueSceneModel(*object->baked, object->position, object->scale, object->tint, eye);
+            } else {
+                QueueSceneModel(*object->model, object->position, object->scale, object->tint, eye);
+            }
         }
+        if (state.pickups.visibleCount > 0) {
+            // the entity's rotation stands the coin up, the model's own transform is the big coin's spin
+            Model coin = *state.scene.objects[state.scene.coinObject].model;
+            Entity_Arrays pickups = Entity_GetArrays(state.pickups.entities);
+            for (u32 i = 0; i < state.pickups.visibleCount; i++) {
+                QueueModel(coin, pickups.world[state.pickups.visible[i]], GOLD, eye);
+            }
+        }
+        RenderQueue_Sort();
+
+        BeginMode3D(state.cameras.firstPerson);
+        Batch_Begin();
+        RenderQueue_Execute(DrawQueuedMesh, NULL);
+        Batch_End();
         EndMode3D();
+        PROFILE_END(zone);
+
+        Batch_Stats batchStats = Batch_GetStats();
+        FrameBench_AddTriangles((u64) batchStats.triangles);
+        FrameBench_AddTextureBinds((u32) batchStats.textureBinds);
+
+#if defined(CLUSTERED_LIGHTING)
+        Cluster_EndDraw();
+#endif
 
         // not sure what this is about
         DrawRectangle(0, 0, GetScreenWidth() / 2, 40, Fade(RAYWHITE, 0.8f));
         DrawText("FirstPerson", 10, 10, 20, MAROON);
+
+        DrawText(TextFormat("[I] batching: %s  draws: %i  binds: %i  instances: %i  visible: %i/%i  [L] lod: %s  tris: %i",
+                            Batch_IsEnabled() ? "on" : "off", batchStats.drawCalls, batchStats.textureBinds, batchStats.instances,
+                            state.scene.visibleCount, state.scene.objectCount,
+                            state.lod.enabled ? "on" : "off", batchStats.triangles),
+                 150, 15, 10, DARKGRAY);
+
+        if (!state.loading.complete) {
+            Loader_Stats loaderStats = Loader_GetStats();
+            DrawText(TextFormat("loading models: %u/%u", loaderStats.ready + loaderStats.failed, loaderStats.requested),
+                     150, 27, 10, DARKGRAY);
+        }
     }
     EndTextureMode();
+    DynRes_EndView(state.renderTextures.firstPersonView);
+    EndPass(pass);
+}
 
+// begins drawing to the screen, UpdateDrawFrame() ends it after the pass so the swap isn't timed with it
+static void DrawCompositePass(RenderTexture2D target, void *user) {
+    (void) target;
+    (void) user;
 
+    struct Pass pass = BeginPass("composite");
     BeginDrawing();
     {
         ClearBackground(BLACK);
 
-        DrawTextureRec(state.renderTextures.overhead.texture, state.splitScreenRect, (Vector2) { 0, 0 }, WHITE);
-        DrawTextureRec(state.renderTextures.firstPerson.texture, state.splitScreenRect, (Vector2) { GetScreenWidth() / 2, 0 }, WHITE);
+        // whatever resolution the views were drawn at, they're stretched over their half of the screen
+        RenderTexture2D overheadTexture = RenderGraph_GetTexture(state.renderTextures.overheadTarget);
+        RenderTexture2D firstPersonTexture = RenderGraph_GetTexture(state.renderTextures.firstPersonTarget);
+        Rectangle overhead = { 0, 0, (f32) overheadTexture.texture.width, (f32) overheadTexture.texture.height };
+        Rectangle firstPerson = { (f32) GetScreenWidth() / 2, 0, (f32) firstPersonTexture.texture.width, (f32) firstPersonTexture.texture.height };
+        DrawTexturePro(overheadTexture.texture, DynRes_GetSource(state.renderTextures.overheadView), overhead, (Vector2) {0}, 0, WHITE);
+        DrawTexturePro(firstPersonTexture.texture, DynRes_GetSource(state.renderTextures.firstPersonView), firstPerson, (Vector2) {0}, 0, WHITE);
+
+        Profiler_Zone zone = PROFILE_BEGIN("ui");
+        UI_Draw();
+        if (state.profiling.overlay) DrawProfilerOverlay();
+        PROFILE_END(zone);
 
         // draw ui
 //        {
@@ -356,5 +1647,106 @@ static void UpdateDrawFrame(void) {
 //            }
 //        }
     }
+    EndPass(pass);
+}
+
+static void UpdateDrawFrame(void) {
+    f64 frameStart = Timer_Seconds();
+    GpuTimer_BeginFrame();
+    Profiler_BeginFrame();
+
+    // the benchmark records once everything is streamed in and the caches are warm
+    if (state.benchmark.enabled && !FrameBench_IsRecording() && state.loading.complete
+        && ++state.benchmark.warmup >= BENCHMARK_WARMUP_FRAMES) {
+        FrameBench_Start(state.benchmark.frames);
+
+        // however long loading took, the recorded frames start from the same simulation state
+        simulation.current = Sim_InitState(state.player.pos, state.player.speed);
+        simulation.previous = simulation.current;
+        simulation.clock = (Sim_Clock) {0};
+    }
+    FrameBench_BeginFrame();
+
+    struct Pass pass = BeginPass("update");
+    UpdateFrame(&state.scene, &state.player, &state.cameras.overhead, &state.cameras.firstPerson);
+    EndPass(pass);
+
+    // culled ahead of the graph, the first person pass is only drawn again when what's visible changes
+    Texture firstPersonTexture = state.renderTextures.firstPerson.texture;
+    Matrix viewProjection = Cull_ViewProjection(state.cameras.firstPerson, (f32) firstPersonTexture.width / (f32) firstPersonTexture.height);
+    Cull_Frustum frustum = Cull_FrustumFromMatrix(viewProjection);
+    Profiler_Zone zone = PROFILE_BEGIN("cull");
+    state.occlusion.tested = 0;
+    state.occlusion.rejected = 0;
+    state.occlusion.seconds = 0;
+    b8 occlusion = state.occlusion.enabled && state.occlusion.buffer != NULL;
+
+    // the walls are rasterized on the job workers while the BVH is refit and queried here
+    f64 occlusionStart = Timer_Seconds();
+    Job_Counter occlusionJobs = {0};
+    if (occlusion) BeginOcclusion(viewProjection, &frustum, &occlusionJobs);
+    state.occlusion.seconds += Timer_Seconds() - occlusionStart;
+
+    Cull_BVHRefit(state.scene.bvh);
+    state.scene.visibleCount = Cull_BVHQuery(state.scene.bvh, &frustum, state.scene.visibleObjects, MAX_SCENE_OBJECTS, NULL);
+
+    occlusionStart = Timer_Seconds();
+    if (occlusion) {
+        Profiler_Zone occlusionZone = PROFILE_BEGIN("occlusion");
+        Job_Wait(&occlusionJobs);
+        OccludeSceneObjects();
+        PROFILE_END(occlusionZone);
+    }
+    state.occlusion.seconds += Timer_Seconds() - occlusionStart;
+
+    SelectLods(&state.scene, state.cameras.firstPerson);
+    CullPickups(&frustum);
+    PROFILE_END(zone);
+
+    // the benchmark times drawing the views, not skipping them
+    if (state.benchmark.enabled) {
+        RenderGraph_Invalidate(state.renderTextures.overheadTarget);
+        RenderGraph_Invalidate(state.renderTextures.firstPersonTarget);
+    }
+    if (state.pickups.visibleCount > 0) {
+        RenderGraph_Invalidate(state.renderTextures.firstPersonTarget);
+    }
+
+    RenderGraph_AddPass(&(RenderGraph_Pass) {
+            .name = "overhead",
+            .draw = DrawOverheadPass,
+            .output = state.renderTextures.overheadTarget,
+            .inputs = HashOverheadInputs()
+    });
+    RenderGraph_AddPass(&(RenderGraph_Pass) {
+            .name = "first_person",
+            .draw = DrawFirstPersonPass,
+            .output = state.renderTextures.firstPersonTarget,
+            .inputs = HashFirstPersonInputs()
+    });
+    RenderGraph_AddPass(&(RenderGraph_Pass) {
+            .name = "composite",
+            .draw = DrawCompositePass,
+            .output = RENDERGRAPH_SCREEN,
+            .reads = { state.renderTextures.overheadTarget, state.renderTextures.firstPersonTarget },
+            .readCount = 2
+    });
+    RenderGraph_Execute();
+
+    // the swap waits out the rest of a limited frame, the time left over is what the views can grow into
+    DynRes_Update(Timer_Seconds() - frameStart);
     EndDrawing();
+
+    Uniform_EndFrame();
+
+    FrameBench_EndFrame();
+    if (FrameBench_IsRecording()) {
+        state.benchmark.frame++;
+    }
+
+    Profiler_EndFrame();
+    if (Profiler_CaptureFinished()) {
+        Profiler_WriteTrace(PROFILE_TRACE_FILE);
+        Profiler_SetEnabled(state.profiling.overlay);
+    }
 }
@@ -0,0 +1,453 @@
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#include "occlusion.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define OCCLUSION_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum OcclusionConstExpr {
+    OCCLUSION_MAX_CORNERS = 8,          // a quad clipped by the near plane has 5 at most
+    OCCLUSION_INITIAL_FACES = 64,
+};
+
+// corners of a box are numbered by bits, x in bit 0, y in bit 1, z in bit 2, each face goes around its quad
+static const u8 OCCLUSION_BOX_FACES[6][4] = {
+        { 0, 2, 6, 4 }, { 1, 5, 7, 3 },
+        { 0, 4, 5, 1 }, { 2, 3, 7, 6 },
+        { 0, 1, 3, 2 }, { 4, 6, 7, 5 },
+};
+
+// a face set up for rasterizing, everything in pixel units with integer x, y naming a pixel
+struct OcclusionFace {
+    // edge functions a x + b y + c, at least 0 when the whole pixel is inside the edge
+    f32 edgeA[OCCLUSION_MAX_CORNERS];
+    f32 edgeB[OCCLUSION_MAX_CORNERS];
+    f32 edgeC[OCCLUSION_MAX_CORNERS];
+    u32 edgeCount;
+
+    // 1/w across the face, at the farthest point of the pixel
+    f32 depthA, depthB, depthC;
+
+    // pixels [minX, maxX) x [minY, maxY)
+    i32 minX, minY, maxX, maxY;
+};
+
+struct ClipVertex {
+    f32 x, y, w;
+};
+
+struct Occlusion_Buffer {
+    u32 width, height;
+    u32 tilesX, tilesY;
+    f32 *depth;                         // row major, 0 is as far as it gets
+    f32 *tileDepth;                     // the farthest depth in each tile
+
+    Matrix viewProjection;
+    struct OcclusionFace *faces;
+    u32 faceCount;
+    u32 faceCapacity;
+    u32 occluderCount;
+};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static void TransformCorners(const Occlusion_Buffer *buffer, BoundingBox box, struct ClipVertex *corners) {
+    const Matrix m = buffer->viewProjection;
+    for (u32 i = 0; i < 8; i++) {
+        f32 x = (i & 1) ? box.max.x : box.min.x;
+        f32 y = (i & 2) ? box.max.y : box.min.y;
+        f32 z = (i & 4) ? box.max.z : box.min.z;
+        corners[i] = (struct ClipVertex) {
+                x * m.m0 + y * m.m4 + z * m.m8  + m.m12,
+                x * m.m1 + y * m.m5 + z * m.m9  + m.m13,
+                x * m.m3 + y * m.m7 + z * m.m11 + m.m15
+        };
+    }
+}
+
+// screen position in pixels (y down) and 1/w
+static Vector3 ProjectVertex(const Occlusion_Buffer *buffer, struct ClipVertex v) {
+    f32 invW = 1.0f / v.w;
+    return (Vector3) {
+            (0.5f + 0.5f * v.x * invW) * (f32) buffer->width,
+            (0.5f - 0.5f * v.y * invW) * (f32) buffer->height,
+            invW
+    };
+}
+
+// Sutherland-Hodgman against w >= near, the only plane that needs it, the rest is clamped to the buffer
+static u32 ClipNear(const struct ClipVertex *input, u32 count, struct ClipVertex *output) {
+    const f32 near = (f32) RL_CULL_DISTANCE_NEAR;
+    u32 outputCount = 0;
+    for (u32 i = 0; i < count; i++) {
+        struct ClipVertex p = input[i];
+        struct ClipVertex q = input[(i + 1) % count];
+        b8 pInside = p.w >= near;
+        b8 qInside = q.w >= near;
+        if (pInside) output[outputCount++] = p;
+        if (pInside != qInside) {
+            f32 t = (near - p.w) / (q.w - p.w);
+            output[outputCount++] = (struct ClipVertex) { p.x + (q.x - p.x) * t, p.y + (q.y - p.y) * t, near };
+        }
+    }
+    return outputCount;
+}
+
+static void AddFace(Occlusion_Buffer *buffer, const Vector3 *points, u32 count) {
+    // twice the signed area, its sign says which way round the polygon goes on screen
+    f32 area = 0;
+    Vector3 center = {0};
+    f32 minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (u32 i = 0; i < count; i++) {
+        Vector3 p = points[i], q = points[(i + 1) % count];
+        area += p.x * q.y - q.x * p.y;
+        center.x += p.x;
+        center.y += p.y;
+        center.z += p.z;
+        minX = fminf(minX, p.x);
+        minY = fminf(minY, p.y);
+        maxX = fmaxf(maxX, p.x);
+        maxY = fmaxf(maxY, p.y);
+    }
+    // edge on, or too small to hide a pixel
+    if (fabsf(area) < 1.0f) return;
+
+    struct OcclusionFace face = {
+            .edgeCount = count,
+            .minX = (minX > 0) ? (i32) minX : 0,
+            .minY = (minY > 0) ? (i32) minY : 0,
+            .maxX = (maxX < (f32) buffer->width) ? (i32) ceilf(maxX) : (i32) buffer->width,
+            .maxY = (maxY < (f32) buffer->height) ? (i32) ceilf(maxY) : (i32) buffer->height
+    };
+    if (face.minX >= face.maxX || face.minY >= face.maxY) return;
+
+    // edge functions pointing inwards, evaluated at the pixel's center and pulled in to its worst corner
+    f32 sign = (area > 0) ? 1.0f : -1.0f;
+    for (u32 i = 0; i < count; i++) {
+        Vector3 p = points[i], q = points[(i + 1) % count];
+        f32 a = -(q.y - p.y) * sign;
+        f32 b = (q.x - p.x) * sign;
+        f32 c = -(a * p.x + b * p.y);
+        face.edgeA[i] = a;
+        face.edgeB[i] = b;
+        face.edgeC[i] = c + 0.5f * (a + b) - 0.5f * (fabsf(a) + fabsf(b));
+    }
+
+    // 1/w is affine in screen space across a flat face, Newell's normal gives its gradient
+    f32 nx = 0, ny = 0, nz = 0;
+    for (u32 i = 0; i < count; i++) {
+        Vector3 p = points[i], q = points[(i + 1) % count];
+        nx += (p.y - q.y) * (p.z + q.z);
+        ny += (p.z - q.z) * (p.x + q.x);
+        nz += (p.x - q.x) * (p.y + q.y);
+    }
+    if (fabsf(nz) < FLT_EPSILON) return;
+    center = (Vector3) { center.x / (f32) count, center.y / (f32) count, center.z / (f32) count };
+    f32 da = -nx / nz;
+    f32 db = -ny / nz;
+    f32 dc = center.z - da * center.x - db * center.y;
+    face.depthA = da;
+    face.depthB = db;
+    face.depthC = dc + 0.5f * (da + db) - 0.5f * (fabsf(da) + fabsf(db));
+
+    if (buffer->faceCount == buffer->faceCapacity) {
+        u32 capacity = buffer->faceCapacity ? buffer->faceCapacity * 2 : OCCLUSION_INITIAL_FACES;
+        struct OcclusionFace *faces = realloc(buffer->faces, capacity * sizeof(struct OcclusionFace));
+        if (faces == NULL) return;
+        buffer->faces = faces;
+        buffer->faceCapacity = capacity;
+    }
+    buffer->faces[buffer->faceCount++] = face;
+}
+
+static void RasterizeFace(Occlusion_Buffer *buffer, const struct OcclusionFace *face, i32 rowStart, i32 rowEnd) {
+    i32 y0 = (face->minY > rowStart) ? face->minY : rowStart;
+    i32 y1 = (face->maxY < rowEnd) ? face->maxY : rowEnd;
+    i32 x0 = face->minX & ~3;
+    i32 x1 = face->maxX;
+
+#if defined(OCCLUSION_USE_SSE)
+    __m128 edgeA[OCCLUSION_MAX_CORNERS];
+    for (u32 e = 0; e < face->edgeCount; e++) {
+        edgeA[e] = _mm_set1_ps(face->edgeA[e]);
+    }
+    const __m128 depthA = _mm_set1_ps(face->depthA);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 lanes = _mm_setr_ps(0, 1, 2, 3);
+
+    for (i32 y = y0; y < y1; y++) {
+        __m128 edgeRow[OCCLUSION_MAX_CORNERS];
+        for (u32 e = 0; e < face->edgeCount; e++) {
+            edgeRow[e] = _mm_set1_ps(face->edgeB[e] * (f32) y + face->edgeC[e]);
+        }
+        const __m128 depthRow = _mm_set1_ps(face->depthB * (f32) y + face->depthC);
+
+        f32 *row = buffer->depth + (u64) y * buffer->width;
+        for (i32 x = x0; x < x1; x += 4) {
+            __m128 px = _mm_add_ps(_mm_set1_ps((f32) x), lanes);
+            __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[0], px), edgeRow[0]), zero);
+            for (u32 e = 1; e < face->edgeCount; e++) {
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[e], px), edgeRow[e]), zero));
+            }
+            if (_mm_movemask_ps(inside) == 0) continue;
+
+            __m128 depth = _mm_add_ps(_mm_mul_ps(depthA, px), depthRow);
+            __m128 current = _mm_loadu_ps(row + x);
+            __m128 closer = _mm_max_ps(current, depth);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closer), _mm_andnot_ps(inside, current)));
+        }
+    }
+#else
+    for (i32 y = y0; y < y1; y++) {
+        f32 *row = buffer->depth + (u64) y * buffer->width;
+        for (i32 x = x0; x < x1; x++) {
+            b8 inside = true;
+            for (u32 e = 0; inside && e < face->edgeCount; e++) {
+                inside = face->edgeA[e] * (f32) x + face->edgeB[e] * (f32) y + face->edgeC[e] >= 0;
+            }
+            if (!inside) continue;
+
+            f32 depth = face->depthA * (f32) x + face->depthB * (f32) y + face->depthC;
+            if (depth > row[x]) row[x] = depth;
+        }
+    }
+#endif
+}
+
+static f32 TileFarthest(const Occlusion_Buffer *buffer, u32 tileX, u32 tileY) {
+    const f32 *tile = buffer->depth + (u64) tileY * OCCLUSION_TILE_SIZE * buffer->width + tileX * OCCLUSION_TILE_SIZE;
+#if defined(OCCLUSION_USE_SSE)
+    __m128 farthest = _mm_loadu_ps(tile);
+    for (u32 y = 0; y < OCCLUSION_TILE_SIZE; y++) {
+        const f32 *row = tile + (u64) y * buffer->width;
+        for (u32 x = 0; x < OCCLUSION_TILE_SIZE; x += 4) {
+            farthest = _mm_min_ps(farthest, _mm_loadu_ps(row + x));
+        }
+    }
+    farthest = _mm_min_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(1, 0, 3, 2)));
+    farthest = _mm_min_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(farthest);
+#else
+    f32 farthest = tile[0];
+    for (u32 y = 0; y < OCCLUSION_TILE_SIZE; y++) {
+        for (u32 x = 0; x < OCCLUSION_TILE_SIZE; x++) {
+            farthest = fminf(farthest, tile[(u64) y * buffer->width + x]);
+        }
+    }
+    return farthest;
+#endif
+}
+
+// whether any pixel of [x0, x1) x [y0, y1), all inside one tile, is as far as depth or farther
+static b8 AnyPixelBehind(const Occlusion_Buffer *buffer, i32 x0, i32 y0, i32 x1, i32 y1, f32 depth) {
+#if defined(OCCLUSION_USE_SSE)
+    const __m128 nearest = _mm_set1_ps(depth);
+    const __m128 lanes = _mm_setr_ps(0, 1, 2, 3);
+    const __m128 first = _mm_set1_ps((f32) x0);
+    const __m128 end = _mm_set1_ps((f32) x1);
+    for (i32 y = y0; y < y1; y++) {
+        const f32 *row = buffer->depth + (u64) y * buffer->width;
+        for (i32 x = x0 & ~3; x < x1; x += 4) {
+            __m128 px = _mm_add_ps(_mm_set1_ps((f32) x), lanes);
+            __m128 inRect = _mm_and_ps(_mm_cmpge_ps(px, first), _mm_cmplt_ps(px, end));
+            __m128 behind = _mm_cmple_ps(_mm_loadu_ps(row + x), nearest);
+            if (_mm_movemask_ps(_mm_and_ps(inRect, behind))) return true;
+        }
+    }
+#else
+    for (i32 y = y0; y < y1; y++) {
+        const f32 *row = buffer->depth + (u64) y * buffer->width;
+        for (i32 x = x0; x < x1; x++) {
+            if (row[x] <= depth) return true;
+        }
+    }
+#endif
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+Occlusion_Buffer *Occlusion_Create(u32 width, u32 height) {
+    Occlusion_Buffer *buffer = calloc(1, sizeof(Occlusion_Buffer));
+    if (buffer == NULL) return NULL;
+
+    buffer->tilesX = (width > 0) ? (width + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE : 1;
+    buffer->tilesY = (height > 0) ? (height + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE : 1;
+    buffer->width = buffer->tilesX * OCCLUSION_TILE_SIZE;
+    buffer->height = buffer->tilesY * OCCLUSION_TILE_SIZE;
+    buffer->depth = calloc((u64) buffer->width * buffer->height, sizeof(f32));
+    buffer->tileDepth = calloc((u64) buffer->tilesX * buffer->tilesY, sizeof(f32));
+    if (buffer->depth == NULL || buffer->tileDepth == NULL) {
+        TraceLog(LOG_WARNING, "OCCLUSION: Out of memory creating a %ux%u buffer", buffer->width, buffer->height);
+        Occlusion_Unload(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+void Occlusion_Unload(Occlusion_Buffer *buffer) {
+    if (buffer == NULL) return;
+    free(buffer->depth);
+    free(buffer->tileDepth);
+    free(buffer->faces);
+    free(buffer);
+}
+
+void Occlusion_Begin(Occlusion_Buffer *buffer, Matrix viewProjection) {
+    buffer->viewProjection = viewProjection;
+    buffer->faceCount = 0;
+    buffer->occluderCount = 0;
+}
+
+void Occlusion_AddBox(Occlusion_Buffer *buffer, BoundingBox box) {
+    buffer->occluderCount++;
+
+    struct ClipVertex corners[8];
+    TransformCorners(buffer, box, corners);
+
+    u32 behind = 0;
+    for (u32 i = 0; i < 8; i++) {
+        behind += corners[i].w < (f32) RL_CULL_DISTANCE_NEAR;
+    }
+    if (behind == 8) return;
+
+    for (u32 f = 0; f < 6; f++) {
+        struct ClipVertex quad[4], clipped[OCCLUSION_MAX_CORNERS];
+        for (u32 i = 0; i < 4; i++) quad[i] = corners[OCCLUSION_BOX_FACES[f][i]];
+
+        u32 count = 4;
+        const struct ClipVertex *polygon = quad;
+        if (behind > 0) {
+            count = ClipNear(quad, 4, clipped);
+            polygon = clipped;
+        }
+        if (count < 3) continue;
+
+        Vector3 points[OCCLUSION_MAX_CORNERS];
+        for (u32 i = 0; i < count; i++) points[i] = ProjectVertex(buffer, polygon[i]);
+        AddFace(buffer, points, count);
+    }
+}
+
+u32 Occlusion_TileRows(const Occlusion_Buffer *buffer) {
+    return buffer->tilesY;
+}
+
+void Occlusion_Rasterize(Occlusion_Buffer *buffer, u32 firstRow, u32 endRow) {
+    if (endRow > buffer->tilesY) endRow = buffer->tilesY;
+    if (firstRow >= endRow) return;
+
+    i32 rowStart = (i32) (firstRow * OCCLUSION_TILE_SIZE);
+    i32 rowEnd = (i32) (endRow * OCCLUSION_TILE_SIZE);
+    memset(buffer->depth + (u64) rowStart * buffer->width, 0, (u64) (rowEnd - rowStart) * buffer->width * sizeof(f32));
+
+    for (u32 i = 0; i < buffer->faceCount; i++) {
+        const struct OcclusionFace *face = &buffer->faces[i];
+        if (face->maxY <= rowStart || face->minY >= rowEnd) continue;
+        RasterizeFace(buffer, face, rowStart, rowEnd);
+    }
+
+    for (u32 tileY = firstRow; tileY < endRow; tileY++) {
+        for (u32 tileX = 0; tileX < buffer->tilesX; tileX++) {
+            buffer->tileDepth[tileY * buffer->tilesX + tileX] = TileFarthest(buffer, tileX, tileY);
+        }
+    }
+}
+
+b8 Occlusion_TestBox(const Occlusion_Buffer *buffer, BoundingBox box) {
+    struct ClipVertex corners[8];
+    TransformCorners(buffer, box, corners);
+
+    f32 minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    f32 nearest = 0;
+    for (u32 i = 0; i < 8; i++) {
+        if (corners[i].w < (f32) RL_CULL_DISTANCE_NEAR) return true;
+
+        Vector3 p = ProjectVertex(buffer, corners[i]);
+        minX = fminf(minX, p.x);
+        minY = fminf(minY, p.y);
+        maxX = fmaxf(maxX, p.x);
+        maxY = fmaxf(maxY, p.y);
+        nearest = fmaxf(nearest, p.z);
+    }
+
+    // every pixel the rectangle touches, off screen is for the frustum to decide
+    i32 x0 = (minX > 0) ? (i32) minX : 0;
+    i32 y0 = (minY > 0) ? (i32) minY : 0;
+    i32 x1 = (maxX < (f32) buffer->width) ? (i32) ceilf(maxX) : (i32) buffer->width;
+    i32 y1 = (maxY < (f32) buffer->height) ? (i32) ceilf(maxY) : (i32) buffer->height;
+    if (x0 >= x1 || y0 >= y1) return true;
+
+    for (i32 tileY = y0 / OCCLUSION_TILE_SIZE; tileY * OCCLUSION_TILE_SIZE < y1; tileY++) {
+        for (i32 tileX = x0 / OCCLUSION_TILE_SIZE; tileX * OCCLUSION_TILE_SIZE < x1; tileX++) {
+            // hidden everywhere in the tile
+            if (buffer->tileDepth[tileY * buffer->tilesX + tileX] > nearest) continue;
+
+            i32 tileX0 = tileX * OCCLUSION_TILE_SIZE, tileY0 = tileY * OCCLUSION_TILE_SIZE;
+            i32 px0 = (x0 > tileX0) ? x0 : tileX0;
+            i32 py0 = (y0 > tileY0) ? y0 : tileY0;
+            i32 px1 = (x1 < tileX0 + OCCLUSION_TILE_SIZE) ? x1 : tileX0 + OCCLUSION_TILE_SIZE;
+            i32 py1 = (y1 < tileY0 + OCCLUSION_TILE_SIZE) ? y1 : tileY0 + OCCLUSION_TILE_SIZE;
+            if (AnyPixelBehind(buffer, px0, py0, px1, py1, nearest)) return true;
+        }
+    }
+    return false;
+}
+
+Occlusion_Stats Occlusion_GetStats(const Occlusion_Buffer *buffer) {
+    return (Occlusion_Stats) { buffer->occluderCount, buffer->faceCount };
+}
+
+u32 Occlusion_MergeTiles(const u8 *tiles, u32 width, u32 height, u8 value, Rectangle *rects, u32 maxRects) {
+    u8 *claimed = calloc((u64) width * height, 1);
+    if (claimed == NULL) return 0;
+
+    u32 count = 0;
+    for (u32 y = 0; y < height; y++) {
+        const u8 *row = tiles + (u64) y * width;
+        for (u32 x = 0; x < width;) {
+            u32 length = 0;
+            while (x + length < width && row[x + length] == value) length++;
+            if (length >= 2) {
+                memset(claimed + (u64) y * width + x, 1, length);
+                if (count < maxRects) rects[count] = (Rectangle) { (f32) x, (f32) y, (f32) length, 1 };
+                count++;
+            }
+            x += length ? length : 1;
+        }
+    }
+
+    for (u32 x = 0; x < width; x++) {
+        for (u32 y = 0; y < height;) {
+            u32 length = 0;
+            while (y + length < height && tiles[(u64) (y + length) * width + x] == value
+                   && !claimed[(u64) (y + length) * width + x]) {
+                length++;
+            }
+            if (length > 0) {
+                if (count < maxRects) rects[count] = (Rectangle) { (f32) x, (f32) y, 1, (f32) length };
+                count++;
+            }
+            y += length ? length : 1;
+        }
+    }
+
+    free(claimed);
+    return count;
+}
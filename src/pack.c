@@ -0,0 +1,248 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "filemap.h"
+#include "lod.h"
+#include "pack.h"
+#include "quant.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+struct Pack {
+    FileMap file;
+
+    const Pack_Header *header;
+    const Pack_ModelRecord *models;
+    const Pack_MeshRecord *meshes;
+    const Pack_MaterialRecord *materials;
+    const Pack_TextureRecord *textures;
+
+    // uploaded on first use, shared by every model in the pack
+    Texture2D *gpuTextures;
+};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static b8 RangeValid(const Pack *pack, u64 offset, u64 size) {
+    return offset <= pack->file.size && size <= pack->file.size - offset;
+}
+
+// check every offset once at open time so lookups afterwards don't need to
+static b8 ValidatePack(Pack *pack) {
+    if (pack->file.size < sizeof(Pack_Header)) return false;
+
+    const Pack_Header *header = (const Pack_Header *) pack->file.data;
+    if (header->magic != PACK_MAGIC || header->version != PACK_VERSION) return false;
+
+    if (!RangeValid(pack, header->modelsOffset, (u64) header->modelCount * sizeof(Pack_ModelRecord))) return false;
+    if (!RangeValid(pack, header->meshesOffset, (u64) header->meshCount * sizeof(Pack_MeshRecord))) return false;
+    if (!RangeValid(pack, header->materialsOffset, (u64) header->materialCount * sizeof(Pack_MaterialRecord))) return false;
+    if (!RangeValid(pack, header->texturesOffset, (u64) header->textureCount * sizeof(Pack_TextureRecord))) return false;
+
+    pack->header = header;
+    pack->models = (const Pack_ModelRecord *) (pack->file.data + header->modelsOffset);
+    pack->meshes = (const Pack_MeshRecord *) (pack->file.data + header->meshesOffset);
+    pack->materials = (const Pack_MaterialRecord *) (pack->file.data + header->materialsOffset);
+    pack->textures = (const Pack_TextureRecord *) (pack->file.data + header->texturesOffset);
+
+    for (u32 i = 0; i < header->modelCount; i++) {
+        const Pack_ModelRecord *model = &pack->models[i];
+        if (memchr(model->name, '\0', PACK_NAME_SIZE) == NULL) return false;
+        if (model->lodCount >= LOD_MAX_LEVELS) return false;
+        if ((u64) model->firstMesh + (u64) model->meshCount * (model->lodCount + 1) > header->meshCount) return false;
+        if ((u64) model->firstMaterial + model->materialCount > header->materialCount) return false;
+
+        for (u32 m = 0; m < model->meshCount * (model->lodCount + 1); m++) {
+            const Pack_MeshRecord *mesh = &pack->meshes[model->firstMesh + m];
+            u64 vertexCount = mesh->vertexCount;
+            if (mesh->material >= model->materialCount) return false;
+            if (mesh->vertices == 0 || !RangeValid(pack, mesh->vertices, vertexCount * 3 * sizeof(f32))) return false;
+            if (mesh->texcoords && !RangeValid(pack, mesh->texcoords, vertexCount * 2 * sizeof(f32))) return false;
+            if (mesh->normals && !RangeValid(pack, mesh->normals, vertexCount * 3 * sizeof(f32))) return false;
+            if (mesh->colors && !RangeValid(pack, mesh->colors, vertexCount * 4)) return false;
+            if (mesh->indices && !RangeValid(pack, mesh->indices, (u64) mesh->triangleCount * 3 * sizeof(u16))) return false;
+        }
+    }
+
+    for (u32 i = 0; i < header->materialCount; i++) {
+        i32 texture = pack->materials[i].texture;
+        if (texture >= (i32) header->textureCount) return false;
+    }
+
+    for (u32 i = 0; i < header->textureCount; i++) {
+        const Pack_TextureRecord *texture = &pack->textures[i];
+        if (!RangeValid(pack, texture->data, texture->dataSize)) return false;
+        if (texture->dataSize < (u64) GetPixelDataSize((int) texture->width, (int) texture->height, (int) texture->format)) return false;
+    }
+
+    return true;
+}
+
+static Texture2D GetTexture(Pack *pack, i32 index) {
+    if (index < 0) return (Texture2D) {0};
+
+    if (pack->gpuTextures[index].id == 0) {
+        const Pack_TextureRecord *record = &pack->textures[index];
+        Image image = {
+                .data = (void *) (pack->file.data + record->data),
+                .width = (int) record->width,
+                .height = (int) record->height,
+                .mipmaps = (int) record->mipmaps,
+                .format = (int) record->format
+        };
+        pack->gpuTextures[index] = LoadTextureFromImage(image);
+    }
+    return pack->gpuTextures[index];
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+Pack *Pack_Open(const char *fileName) {
+    Pack *pack = RL_CALLOC(1, sizeof(Pack));
+    if (pack == NULL) return NULL;
+
+    if (!FileMap_Open(fileName, &pack->file)) {
+        TraceLog(LOG_WARNING, "PACK: [%s] Failed to open file", fileName);
+        RL_FREE(pack);
+        return NULL;
+    }
+
+    if (!ValidatePack(pack)) {
+        TraceLog(LOG_WARNING, "PACK: [%s] Not a valid pack (version %u expected)", fileName, PACK_VERSION);
+        FileMap_Close(&pack->file);
+        RL_FREE(pack);
+        return NULL;
+    }
+
+    pack->gpuTextures = RL_CALLOC(pack->header->textureCount + 1, sizeof(Texture2D));
+
+    TraceLog(LOG_INFO, "PACK: [%s] Mapped %u models, %u meshes, %u textures (%.1f MB)", fileName,
+             pack->header->modelCount, pack->header->meshCount, pack->header->textureCount,
+             (f64) pack->file.size / (1024.0 * 1024.0));
+    return pack;
+}
+
+void Pack_Close(Pack *pack) {
+    if (pack == NULL) return;
+
+    for (u32 i = 0; i < pack->header->textureCount; i++) {
+        if (pack->gpuTextures[i].id != 0) UnloadTexture(pack->gpuTextures[i]);
+    }
+    RL_FREE(pack->gpuTextures);
+
+    FileMap_Close(&pack->file);
+    RL_FREE(pack);
+}
+
+u32 Pack_ModelCount(const Pack *pack) {
+    return pack->header->modelCount;
+}
+
+const char *Pack_ModelName(const Pack *pack, u32 model) {
+    return (model < pack->header->modelCount) ? pack->models[model].name : NULL;
+}
+
+i32 Pack_FindModel(const Pack *pack, const char *fileName) {
+    const char *name = GetFileName(fileName);
+
+    // records are sorted by name
+    i32 low = 0;
+    i32 high = (i32) pack->header->modelCount - 1;
+    while (low <= high) {
+        i32 mid = low + (high - low) / 2;
+        int order = strcmp(pack->models[mid].name, name);
+        if (order == 0) return mid;
+        if (order < 0) low = mid + 1;
+        else           high = mid - 1;
+    }
+    return -1;
+}
+
+u32 Pack_MeshCount(const Pack *pack, u32 model) {
+    return (model < pack->header->modelCount) ? pack->models[model].meshCount : 0;
+}
+
+Mesh Pack_GetMesh(const Pack *pack, u32 model, u32 mesh) {
+    return Pack_GetLodMesh(pack, model, 0, mesh);
+}
+
+u32 Pack_LodCount(const Pack *pack, u32 model) {
+    return (model < pack->header->modelCount) ? pack->models[model].lodCount : 0;
+}
+
+Mesh Pack_GetLodMesh(const Pack *pack, u32 model, u32 level, u32 mesh) {
+    if (mesh >= Pack_MeshCount(pack, model) || level > Pack_LodCount(pack, model)) return (Mesh) {0};
+
+    const Pack_ModelRecord *modelRecord = &pack->models[model];
+    const Pack_MeshRecord *record = &pack->meshes[modelRecord->firstMesh + level * modelRecord->meshCount + mesh];
+    const u8 *base = pack->file.data;
+
+    // NOTE: raylib's Mesh isn't const-correct, the arrays are only ever read from
+    return (Mesh) {
+            .vertexCount = (int) record->vertexCount,
+            .triangleCount = (int) record->triangleCount,
+            .vertices = (float *) (base + record->vertices),
+            .texcoords = record->texcoords ? (float *) (base + record->texcoords) : NULL,
+            .normals = record->normals ? (float *) (base + record->normals) : NULL,
+            .colors = record->colors ? (unsigned char *) (base + record->colors) : NULL,
+            .indices = record->indices ? (unsigned short *) (base + record->indices) : NULL,
+    };
+}
+
+Model Pack_LoadModel(Pack *pack, u32 model) {
+    if (model >= pack->header->modelCount) return (Model) {0};
+
+    const Pack_ModelRecord *record = &pack->models[model];
+    Model result = {
+            .transform = MatrixIdentity(),
+            .meshCount = (int) record->meshCount,
+            .materialCount = (int) record->materialCount,
+            .meshes = RL_CALLOC(record->meshCount, sizeof(Mesh)),
+            .meshMaterial = RL_CALLOC(record->meshCount, sizeof(int)),
+            .materials = RL_CALLOC(record->materialCount, sizeof(Material))
+    };
+
+    for (u32 i = 0; i < record->meshCount; i++) {
+        result.meshes[i] = Pack_GetMesh(pack, model, i);
+        result.meshMaterial[i] = (int) pack->meshes[record->firstMesh + i].material;
+        Quant_UploadMesh(&result.meshes[i]);
+    }
+
+    for (u32 i = 0; i < record->materialCount; i++) {
+        const Pack_MaterialRecord *material = &pack->materials[record->firstMaterial + i];
+        result.materials[i] = LoadMaterialDefault();
+        result.materials[i].maps[MATERIAL_MAP_DIFFUSE].color = material->color;
+
+        Texture2D albedo = GetTexture(pack, material->texture);
+        if (albedo.id != 0) result.materials[i].maps[MATERIAL_MAP_DIFFUSE].texture = albedo;
+    }
+
+    return result;
+}
+
+void Pack_UnloadModel(Model model) {
+    for (int i = 0; i < model.meshCount; i++) {
+        Pack_UnloadMesh(model.meshes[i]);
+    }
+    // the meshes are gone, UnloadModel() only frees the model's own arrays and materials
+    model.meshCount = 0;
+    UnloadModel(model);
+}
+
+void Pack_UnloadMesh(Mesh mesh) {
+    mesh.vertices = NULL;
+    mesh.texcoords = NULL;
+    mesh.normals = NULL;
+    mesh.colors = NULL;
+    mesh.indices = NULL;
+    Quant_UnloadMesh(mesh);
+}
@@ -0,0 +1,557 @@
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define PROFILER_RDTSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+    #include <intrin.h>
+    #define PROFILER_RDTSC 1
+#endif
+
+#include "raylib.h"
+
+#include "gputimer.h"
+#include "profiler.h"
+#include "thread.h"
+#include "timer.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum ProfilerConstExpr {
+    PROFILER_RING_MASK = PROFILER_RING_SIZE - 1,
+    PROFILER_GPU_THREAD = PROFILER_MAX_THREADS,         // trace track of the timer queries
+    PROFILER_FRAME_SLOTS = GPUTIMER_LATENCY + 2,        // cpu start of the frames whose GPU times are still on the way
+};
+
+static const f64 PROFILER_OVERLAY_SECONDS = 0.5;
+static const f64 PROFILER_CALIBRATION_SECONDS = 0.002;
+
+#if defined(_MSC_VER)
+    #define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+    #define PROFILER_THREAD_LOCAL _Thread_local
+#endif
+
+// a finished zone, key identifies the path from the thread's outermost zone down to this one
+struct ProfilerEvent {
+    const char *name;
+    u64 key;
+    u64 parent;
+    u64 begin;
+    u64 end;
+    u32 depth;
+};
+
+struct ProfilerOpenZone {
+    const char *name;
+    u64 key;
+    u64 begin;
+};
+
+struct ProfilerRing {
+    _Alignas(64) atomic_uint head;      // written by the owning thread only
+    _Alignas(64) atomic_uint tail;      // written by the main thread only
+    atomic_uint dropped;
+
+    const char *name;                   // guarded by the profiler mutex
+    u32 index;
+
+    // owning thread only
+    struct ProfilerOpenZone open[PROFILER_MAX_DEPTH];
+    u32 depth;
+
+    struct ProfilerEvent events[PROFILER_RING_SIZE];
+};
+
+// overlay rows being added up until the next publish
+struct ProfilerAccum {
+    u64 key;
+    u64 parent;
+    const char *thread;
+    const char *name;
+    u32 depth;
+    u32 calls;
+    f64 seconds;
+};
+
+struct ProfilerCaptureEvent {
+    const char *name;
+    u64 begin;
+    u64 end;
+    u32 thread;
+};
+
+static struct Profiler {
+    b8 initialized;
+    atomic_bool enabled;
+    u32 generation;                     // tells thread local ring pointers from a previous Init() apart
+
+    Mutex mutex;
+    struct ProfilerRing *rings[PROFILER_MAX_THREADS];
+    u32 ringCount;
+
+    u64 baseTicks;
+    f64 baseSeconds;
+    f64 ticksPerSecond;
+
+    Profiler_Zone frameZone;
+    u64 frameTicks[PROFILER_FRAME_SLOTS];
+    u64 frameGpu[PROFILER_FRAME_SLOTS];
+    u64 gpuSeen;
+
+    struct ProfilerAccum accum[PROFILER_MAX_ROWS];
+    u32 accumCount;
+    u32 windowFrames;
+    f64 windowStart;
+
+    Profiler_Row rows[PROFILER_MAX_ROWS];
+    u32 rowCount;
+
+    u64 zones;
+
+    struct ProfilerCaptureEvent *capture;
+    u32 captureCount;
+    u32 captureCapacity;
+    u32 captureFramesLeft;
+    u32 captureGraceFrames;             // frames waited since the last captured one, for its GPU times
+    u64 captureGpuFirst;
+    u64 captureGpuLast;
+    b8 capturing;
+    b8 captureFinished;
+} profiler = {0};
+
+static PROFILER_THREAD_LOCAL struct ProfilerRing *threadRing = NULL;
+static PROFILER_THREAD_LOCAL u32 threadGeneration = 0;
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static inline u64 ReadTicks(void) {
+#if defined(PROFILER_RDTSC)
+    return __rdtsc();
+#else
+    return (u64) (Timer_Seconds() * 1e9);
+#endif
+}
+
+static inline u64 HashZone(u64 parent, const void *name) {
+    u64 hash = (parent ^ (u64) (uintptr_t) name) * 0x100000001b3ull;
+    return hash ^ (hash >> 29);
+}
+
+static f64 TicksToSeconds(u64 ticks) {
+    return (f64) ticks / profiler.ticksPerSecond;
+}
+
+// the calling thread's ring, registered on first use
+static struct ProfilerRing *ThreadRing(void) {
+    if (threadRing != NULL && threadGeneration == profiler.generation) return threadRing;
+    if (!profiler.initialized) return NULL;
+
+    struct ProfilerRing *ring = NULL;
+    Mutex_Lock(&profiler.mutex);
+    if (profiler.ringCount < PROFILER_MAX_THREADS) {
+        ring = calloc(1, sizeof(struct ProfilerRing));
+        if (ring != NULL) {
+            ring->index = profiler.ringCount;
+            ring->name = (ring->index == 0) ? "main" : "thread";
+            profiler.rings[profiler.ringCount++] = ring;
+        }
+    }
+    Mutex_Unlock(&profiler.mutex);
+
+    if (ring == NULL) return NULL;
+    threadRing = ring;
+    threadGeneration = profiler.generation;
+    return ring;
+}
+
+static void Calibrate(void) {
+#if defined(PROFILER_RDTSC)
+    f64 elapsed = Timer_Seconds() - profiler.baseSeconds;
+    u64 ticks = ReadTicks() - profiler.baseTicks;
+    if (elapsed > 0 && ticks > 0) profiler.ticksPerSecond = (f64) ticks / elapsed;
+#else
+    profiler.ticksPerSecond = 1e9;
+#endif
+}
+
+static void Accumulate(const char *thread, const char *name, u64 key, u64 parent, u32 depth, f64 seconds) {
+    // keys only know the zone path, mixing in the thread name adds up threads of the same name
+    u64 threadKey = HashZone(0, thread);
+    key ^= threadKey;
+    parent = (depth > 0) ? parent ^ threadKey : 0;
+
+    struct ProfilerAccum *accum = NULL;
+    for (u32 i = 0; i < profiler.accumCount; i++) {
+        if (profiler.accum[i].key == key) {
+            accum = &profiler.accum[i];
+            break;
+        }
+    }
+    if (accum == NULL) {
+        if (profiler.accumCount >= PROFILER_MAX_ROWS) return;
+        accum = &profiler.accum[profiler.accumCount++];
+        *accum = (struct ProfilerAccum) {
+                .key = key, .parent = parent, .thread = thread, .name = name, .depth = depth
+        };
+    }
+    accum->calls++;
+    accum->seconds += seconds;
+}
+
+static void CaptureEvent(const char *name, u64 begin, u64 end, u32 thread) {
+    if (profiler.captureCount >= profiler.captureCapacity) {
+        if (profiler.captureCapacity >= PROFILER_MAX_CAPTURE_EVENTS) return;
+
+        u32 capacity = profiler.captureCapacity ? profiler.captureCapacity * 2 : 4096;
+        struct ProfilerCaptureEvent *events = realloc(profiler.capture, capacity * sizeof(struct ProfilerCaptureEvent));
+        if (events == NULL) return;
+        profiler.capture = events;
+        profiler.captureCapacity = capacity;
+    }
+    profiler.capture[profiler.captureCount++] = (struct ProfilerCaptureEvent) {
+            .name = name, .begin = begin, .end = end, .thread = thread
+    };
+}
+
+static void Drain(struct ProfilerRing *ring, const char *thread, b8 capture) {
+    u32 head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    u32 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    for (; tail != head; tail++) {
+        const struct ProfilerEvent *event = &ring->events[tail & PROFILER_RING_MASK];
+        Accumulate(thread, event->name, event->key, event->parent, event->depth, TicksToSeconds(event->end - event->begin));
+        if (capture) CaptureEvent(event->name, event->begin, event->end, ring->index);
+        profiler.zones++;
+    }
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+}
+
+// timer query results trail the frame they were recorded in, they're filed under the frame's cpu start
+static void CollectGpuTimes(void) {
+    const GpuTimer_Zone *zones;
+    u64 gpuFrame;
+    u32 zoneCount = GpuTimer_Results(&zones, &gpuFrame);
+    if (zoneCount == 0 || gpuFrame == profiler.gpuSeen) return;
+    profiler.gpuSeen = gpuFrame;
+
+    u32 slot = (u32) (gpuFrame % PROFILER_FRAME_SLOTS);
+    b8 capture = profiler.capture != NULL && profiler.frameGpu[slot] == gpuFrame
+                 && gpuFrame >= profiler.captureGpuFirst && gpuFrame <= profiler.captureGpuLast;
+
+    u64 keys[PROFILER_MAX_DEPTH] = {0};
+    for (u32 i = 0; i < zoneCount; i++) {
+        const GpuTimer_Zone *zone = &zones[i];
+        if (zone->depth >= PROFILER_MAX_DEPTH) continue;
+
+        u64 parent = (zone->depth > 0) ? keys[zone->depth - 1] : 0;
+        keys[zone->depth] = HashZone(parent, zone->name);
+        Accumulate("gpu", zone->name, keys[zone->depth], parent, zone->depth, zone->duration);
+
+        if (capture) {
+            u64 begin = profiler.frameTicks[slot] + (u64) (zone->start * profiler.ticksPerSecond);
+            CaptureEvent(zone->name, begin, begin + (u64) (zone->duration * profiler.ticksPerSecond), PROFILER_GPU_THREAD);
+        }
+    }
+}
+
+static void PublishRow(u32 index) {
+    if (profiler.rowCount >= PROFILER_MAX_ROWS) return;
+
+    const struct ProfilerAccum *accum = &profiler.accum[index];
+    profiler.rows[profiler.rowCount++] = (Profiler_Row) {
+            .thread = accum->thread,
+            .name = accum->name,
+            .depth = accum->depth,
+            .calls = (f32) accum->calls / (f32) profiler.windowFrames,
+            .seconds = accum->seconds / profiler.windowFrames,
+    };
+
+    // children in the order they first showed up
+    for (u32 i = 0; i < profiler.accumCount; i++) {
+        if (profiler.accum[i].depth == accum->depth + 1 && profiler.accum[i].parent == accum->key) PublishRow(i);
+    }
+}
+
+static void Publish(void) {
+    profiler.rowCount = 0;
+    if (profiler.windowFrames > 0) {
+        for (u32 i = 0; i < profiler.accumCount; i++) {
+            if (profiler.accum[i].depth == 0) PublishRow(i);
+        }
+    }
+    profiler.accumCount = 0;
+    profiler.windowFrames = 0;
+    profiler.windowStart = Timer_Seconds();
+}
+
+static void WriteJSONString(FILE *file, const char *text) {
+    fputc('"', file);
+    for (const char *c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        if ((unsigned char) *c >= 0x20) fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static void WriteThreadName(FILE *file, u32 thread, const char *name) {
+    fprintf(file, "    { \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": { \"name\": ", thread);
+    WriteJSONString(file, name);
+    fprintf(file, " } },\n");
+    fprintf(file, "    { \"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": { \"sort_index\": %u } },\n",
+            thread, thread);
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void Profiler_Init(void) {
+    if (profiler.initialized) return;
+
+    u32 generation = profiler.generation + 1;
+    memset(&profiler, 0, sizeof(profiler));
+    profiler.generation = generation;
+    Mutex_Init(&profiler.mutex);
+
+    // a first guess at the tick rate, refined every frame against the longer baseline
+    profiler.baseSeconds = Timer_Seconds();
+    profiler.baseTicks = ReadTicks();
+    while (Timer_Seconds() - profiler.baseSeconds < PROFILER_CALIBRATION_SECONDS) {}
+    Calibrate();
+
+    profiler.windowStart = Timer_Seconds();
+    profiler.initialized = true;
+
+    // registers the calling thread first, it's the one collecting
+    ThreadRing();
+    TraceLog(LOG_INFO, "PROFILER: Timestamps at %.2f GHz", profiler.ticksPerSecond * 1e-9);
+}
+
+void Profiler_Shutdown(void) {
+    if (!profiler.initialized) return;
+
+    for (u32 i = 0; i < profiler.ringCount; i++) {
+        free(profiler.rings[i]);
+    }
+    free(profiler.capture);
+    Mutex_Destroy(&profiler.mutex);
+
+    // threads still holding a ring pointer register again after the next Init()
+    u32 generation = profiler.generation + 1;
+    memset(&profiler, 0, sizeof(profiler));
+    profiler.generation = generation;
+}
+
+void Profiler_SetEnabled(b8 enabled) {
+    if (!profiler.initialized) return;
+    atomic_store_explicit(&profiler.enabled, enabled, memory_order_relaxed);
+}
+
+b8 Profiler_IsEnabled(void) {
+    return atomic_load_explicit(&profiler.enabled, memory_order_relaxed);
+}
+
+void Profiler_SetThreadName(const char *name) {
+    struct ProfilerRing *ring = ThreadRing();
+    if (ring == NULL) return;
+
+    Mutex_Lock(&profiler.mutex);
+    ring->name = name;
+    Mutex_Unlock(&profiler.mutex);
+}
+
+void Profiler_BeginFrame(void) {
+    if (!profiler.initialized) return;
+
+    u64 gpuFrame = GpuTimer_Frame();
+    u32 slot = (u32) (gpuFrame % PROFILER_FRAME_SLOTS);
+    profiler.frameTicks[slot] = ReadTicks();
+    profiler.frameGpu[slot] = gpuFrame;
+
+    profiler.frameZone = Profiler_Begin("frame");
+}
+
+void Profiler_EndFrame(void) {
+    if (!profiler.initialized) return;
+
+    Profiler_End(profiler.frameZone);
+    profiler.frameZone = 0;
+    Calibrate();
+
+    const char *names[PROFILER_MAX_THREADS];
+    Mutex_Lock(&profiler.mutex);
+    u32 ringCount = profiler.ringCount;
+    for (u32 i = 0; i < ringCount; i++) {
+        names[i] = profiler.rings[i]->name;
+    }
+    Mutex_Unlock(&profiler.mutex);
+
+    // rings are drained even while disabled, zones that began before it was turned off still end in them
+    for (u32 i = 0; i < ringCount; i++) {
+        Drain(profiler.rings[i], names[i], profiler.capturing);
+    }
+    CollectGpuTimes();
+
+    if (profiler.capturing && --profiler.captureFramesLeft == 0) {
+        profiler.capturing = false;
+    }
+    if (!profiler.capturing && profiler.capture != NULL && !profiler.captureFinished) {
+        b8 gpuDone = !GpuTimer_IsAvailable() || profiler.gpuSeen >= profiler.captureGpuLast;
+        profiler.captureFinished = gpuDone || ++profiler.captureGraceFrames > GPUTIMER_LATENCY + 2;
+    }
+
+    profiler.windowFrames++;
+    if (Timer_Seconds() - profiler.windowStart >= PROFILER_OVERLAY_SECONDS) Publish();
+}
+
+Profiler_Zone Profiler_Begin(const char *name) {
+    if (!atomic_load_explicit(&profiler.enabled, memory_order_relaxed)) return 0;
+
+    struct ProfilerRing *ring = ThreadRing();
+    if (ring == NULL || ring->depth >= PROFILER_MAX_DEPTH) return 0;
+
+    struct ProfilerOpenZone *open = &ring->open[ring->depth];
+    open->name = name;
+    open->key = HashZone(ring->depth > 0 ? ring->open[ring->depth - 1].key : 0, name);
+    open->begin = ReadTicks();
+    return ++ring->depth;
+}
+
+void Profiler_End(Profiler_Zone zone) {
+    if (zone == 0) return;
+
+    u64 end = ReadTicks();
+    struct ProfilerRing *ring = threadRing;
+    if (ring == NULL || zone > ring->depth) return;
+
+    // unwinds zones that were never ended along with this one
+    u32 depth = zone - 1;
+    ring->depth = depth;
+
+    u32 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    u32 tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= PROFILER_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    const struct ProfilerOpenZone *open = &ring->open[depth];
+    ring->events[head & PROFILER_RING_MASK] = (struct ProfilerEvent) {
+            .name = open->name,
+            .key = open->key,
+            .parent = depth > 0 ? ring->open[depth - 1].key : 0,
+            .begin = open->begin,
+            .end = end,
+            .depth = depth,
+    };
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+Profiler_Pass Profiler_BeginPass(const char *name) {
+    return (Profiler_Pass) { .cpu = Profiler_Begin(name), .gpu = GpuTimer_Begin(name) };
+}
+
+void Profiler_EndPass(Profiler_Pass pass) {
+    GpuTimer_End(pass.gpu);
+    Profiler_End(pass.cpu);
+}
+
+u32 Profiler_GetRows(const Profiler_Row **rows) {
+    if (rows != NULL) *rows = profiler.rows;
+    return profiler.rowCount;
+}
+
+Profiler_Stats Profiler_GetStats(void) {
+    Profiler_Stats stats = {
+            .threads = profiler.ringCount,
+            .zones = profiler.zones,
+            .ticksPerSecond = profiler.ticksPerSecond,
+    };
+    for (u32 i = 0; i < profiler.ringCount; i++) {
+        stats.dropped += atomic_load_explicit(&profiler.rings[i]->dropped, memory_order_relaxed);
+    }
+    return stats;
+}
+
+void Profiler_StartCapture(u32 frames) {
+    if (!profiler.initialized || frames == 0) return;
+
+    free(profiler.capture);
+    profiler.capture = NULL;
+    profiler.captureCount = 0;
+    profiler.captureCapacity = 0;
+    profiler.captureFramesLeft = frames;
+    profiler.captureGraceFrames = 0;
+    profiler.captureGpuFirst = GpuTimer_Frame();
+    profiler.captureGpuLast = profiler.captureGpuFirst + frames - 1;
+    profiler.capturing = true;
+    profiler.captureFinished = false;
+
+    // the start marker, it also keeps the capture around when nothing else ends up in it
+    u64 now = ReadTicks();
+    CaptureEvent("capture", now, now, 0);
+    Profiler_SetEnabled(true);
+}
+
+b8 Profiler_IsCapturing(void) {
+    return profiler.capturing;
+}
+
+b8 Profiler_CaptureFinished(void) {
+    return profiler.captureFinished;
+}
+
+b8 Profiler_WriteTrace(const char *fileName) {
+    if (profiler.capture == NULL) return false;
+
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) {
+        TraceLog(LOG_WARNING, "PROFILER: [%s] Couldn't open for writing", fileName);
+        return false;
+    }
+
+    u64 origin = profiler.capture[0].begin;
+    for (u32 i = 0; i < profiler.captureCount; i++) {
+        if (profiler.capture[i].begin < origin) origin = profiler.capture[i].begin;
+    }
+
+    fprintf(file, "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [\n");
+    Mutex_Lock(&profiler.mutex);
+    for (u32 i = 0; i < profiler.ringCount; i++) {
+        WriteThreadName(file, i, profiler.rings[i]->name);
+    }
+    Mutex_Unlock(&profiler.mutex);
+    WriteThreadName(file, PROFILER_GPU_THREAD, "gpu");
+
+    // microseconds, the first event marks where the capture was started
+    fprintf(file, "    { \"name\": \"capture\", \"ph\": \"i\", \"s\": \"g\", \"pid\": 1, \"tid\": 0, \"ts\": %.3f },\n",
+            TicksToSeconds(profiler.capture[0].begin - origin) * 1e6);
+    for (u32 i = 1; i < profiler.captureCount; i++) {
+        const struct ProfilerCaptureEvent *event = &profiler.capture[i];
+        fprintf(file, "    { \"name\": ");
+        WriteJSONString(file, event->name);
+        fprintf(file, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f },\n",
+                event->thread, TicksToSeconds(event->begin - origin) * 1e6, TicksToSeconds(event->end - event->begin) * 1e6);
+    }
+    fprintf(file, "    { \"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": { \"name\": \"fiddle\" } }\n  ]\n}\n");
+
+    b8 written = ferror(file) == 0;
+    fclose(file);
+
+    TraceLog(LOG_INFO, "PROFILER: [%s] Wrote %u zones", fileName, profiler.captureCount - 1);
+    free(profiler.capture);
+    profiler.capture = NULL;
+    profiler.captureCount = 0;
+    profiler.captureCapacity = 0;
+    profiler.captureFinished = false;
+    return written;
+}
@@ -0,0 +1,351 @@
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include "quant.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum QuantConstExpr {
+    QUANT_MAX_MESHES = 8192,                        // meshes past this are uploaded as floats
+    QUANT_HASH_SIZE = QUANT_MAX_MESHES * 2,         // open addressing table size, must be a power of 2
+
+    // raylib's default attribute locations, shaders get their inputs bound to these by name when they load
+    QUANT_LOCATION_POSITION = 0,
+    QUANT_LOCATION_TEXCOORD = 1,
+    QUANT_LOCATION_NORMAL = 2,
+    QUANT_LOCATION_COLOR = 3,
+
+    // mesh.vboId slots, UnloadMesh() releases all MAX_MESH_VERTEX_BUFFERS of them
+    QUANT_MESH_VERTEX_BUFFERS = 7,
+    QUANT_VBO_VERTICES = 0,
+    QUANT_VBO_COLORS = 3,
+    QUANT_VBO_INDICES = 6,
+
+    // attribute types rlgl.h doesn't name
+    QUANT_GL_BYTE = 0x1400,
+    QUANT_GL_UNSIGNED_SHORT = 0x1403,
+    QUANT_GL_HALF_FLOAT = 0x140B,
+};
+
+struct QuantMesh {
+    u32 vaoId;                  // 0 means empty slot
+    Vector4 decode;
+    u64 floatBytes;
+    u64 compactBytes;
+};
+
+static struct Quant {
+    b8 enabled;
+
+    // keyed by vaoId, slots are removed by shifting later entries back so probes never need tombstones
+    struct QuantMesh table[QUANT_HASH_SIZE];
+
+    Quant_Stats stats;
+} quant = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u32 HashVao(u32 vaoId) {
+    // murmur3 finalizer, vao ids are small sequential integers
+    vaoId ^= vaoId >> 16;
+    vaoId *= 0x85ebca6bu;
+    vaoId ^= vaoId >> 13;
+    vaoId *= 0xc2b2ae35u;
+    vaoId ^= vaoId >> 16;
+    return vaoId & (QUANT_HASH_SIZE - 1);
+}
+
+static struct QuantMesh *FindMesh(u32 vaoId) {
+    for (u32 slot = HashVao(vaoId); quant.table[slot].vaoId != 0; slot = (slot + 1) & (QUANT_HASH_SIZE - 1)) {
+        if (quant.table[slot].vaoId == vaoId) return &quant.table[slot];
+    }
+    return NULL;
+}
+
+static void InsertMesh(struct QuantMesh mesh) {
+    u32 slot = HashVao(mesh.vaoId);
+    while (quant.table[slot].vaoId != 0) slot = (slot + 1) & (QUANT_HASH_SIZE - 1);
+    quant.table[slot] = mesh;
+
+    quant.stats.meshes++;
+    quant.stats.floatBytes += mesh.floatBytes;
+    quant.stats.compactBytes += mesh.compactBytes;
+}
+
+static void RemoveMesh(struct QuantMesh *mesh) {
+    quant.stats.meshes--;
+    quant.stats.floatBytes -= mesh->floatBytes;
+    quant.stats.compactBytes -= mesh->compactBytes;
+
+    // backward shift deletion, move up any later entry whose probe sequence passes through the hole
+    u32 hole = (u32) (mesh - quant.table);
+    u32 slot = hole;
+    for (;;) {
+        slot = (slot + 1) & (QUANT_HASH_SIZE - 1);
+        if (quant.table[slot].vaoId == 0) break;
+
+        u32 home = HashVao(quant.table[slot].vaoId);
+        b8 movable = (hole <= slot) ? (home <= hole || home > slot) : (home <= hole && home > slot);
+        if (movable) {
+            quant.table[hole] = quant.table[slot];
+            hole = slot;
+        }
+    }
+    quant.table[hole] = (struct QuantMesh) {0};
+}
+
+static b8 CompactSupported(void) {
+    int version = rlGetVersion();
+    return version == RL_OPENGL_33 || version == RL_OPENGL_43;
+}
+
+static u16 HalfFromFloat(f32 value) {
+    u32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    u32 sign = (bits >> 16) & 0x8000u;
+    u32 mantissa = bits & 0x7fffffu;
+    i32 exponent = (i32) ((bits >> 23) & 0xff) - 127 + 15;
+
+    if (((bits >> 23) & 0xff) == 0xff) return (u16) (sign | 0x7c00u | (mantissa ? 0x200u : 0));
+    if (exponent >= 31) return (u16) (sign | 0x7c00u);
+
+    if (exponent <= 0) {
+        // denormal, or too small for one
+        if (exponent < -10) return (u16) sign;
+        mantissa |= 0x800000u;
+        u32 shift = (u32) (14 - exponent);
+        u32 half = mantissa >> shift;
+        u32 rest = mantissa & ((1u << shift) - 1);
+        u32 halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) half++;
+        return (u16) (sign | half);
+    }
+
+    // round to nearest even, a carry out of the mantissa correctly bumps the exponent
+    u32 half = sign | ((u32) exponent << 10) | (mantissa >> 13);
+    u32 rest = mantissa & 0x1fffu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1))) half++;
+    return (u16) half;
+}
+
+static f32 FloatFromHalf(u16 half) {
+    u32 exponent = (half >> 10) & 0x1fu;
+    u32 mantissa = half & 0x3ffu;
+
+    f32 value;
+    if (exponent == 0) value = ldexpf((f32) mantissa, -24);
+    else if (exponent == 31) value = mantissa ? NAN : INFINITY;
+    else value = ldexpf((f32) (mantissa | 0x400u), (i32) exponent - 25);
+    return (half & 0x8000u) ? -value : value;
+}
+
+static f32 SignNotZero(f32 value) {
+    return (value >= 0) ? 1.0f : -1.0f;
+}
+
+// same as OctDecode() in lighting.vert, snorm bytes are read as c / 127
+static Vector3 OctDecode(i8 x, i8 y) {
+    Vector3 n = { fmaxf((f32) x / 127.0f, -1.0f), fmaxf((f32) y / 127.0f, -1.0f), 0 };
+    n.z = 1.0f - fabsf(n.x) - fabsf(n.y);
+    f32 t = fmaxf(-n.z, 0.0f);
+    n.x += (n.x >= 0) ? -t : t;
+    n.y += (n.y >= 0) ? -t : t;
+    return Vector3Normalize(n);
+}
+
+static void OctEncode(Vector3 normal, i8 *encoded) {
+    f32 length = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+    if (length == 0) {
+        encoded[0] = encoded[1] = 0;
+        return;
+    }
+
+    f32 u = normal.x / length;
+    f32 v = normal.y / length;
+    if (normal.z < 0) {
+        f32 foldedU = (1.0f - fabsf(v)) * SignNotZero(u);
+        f32 foldedV = (1.0f - fabsf(u)) * SignNotZero(v);
+        u = foldedU;
+        v = foldedV;
+    }
+
+    // plain rounding can be off by a code in either axis, keep whichever neighbour decodes closest
+    Vector3 target = Vector3Normalize(normal);
+    f32 baseU = floorf(u * 127.0f);
+    f32 baseV = floorf(v * 127.0f);
+    f32 best = -2.0f;
+    for (int i = 0; i < 4; i++) {
+        i8 x = (i8) Clamp(baseU + (f32) (i & 1), -127.0f, 127.0f);
+        i8 y = (i8) Clamp(baseV + (f32) (i >> 1), -127.0f, 127.0f);
+        f32 match = Vector3DotProduct(OctDecode(x, y), target);
+        if (match > best) {
+            best = match;
+            encoded[0] = x;
+            encoded[1] = y;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void Quant_SetEnabled(b8 enabled) {
+    quant.enabled = enabled;
+}
+
+b8 Quant_IsEnabled(void) {
+    return quant.enabled;
+}
+
+Vector4 Quant_EncodeVertices(const Mesh *mesh, Quant_Vertex *destination) {
+    u32 vertexCount = (u32) mesh->vertexCount;
+    const Vector3 *positions = (const Vector3 *) mesh->vertices;
+    const Vector3 *normals = (const Vector3 *) mesh->normals;
+    const Vector2 *texcoords = (const Vector2 *) mesh->texcoords;
+
+    Vector3 min = positions[0];
+    Vector3 max = positions[0];
+    for (u32 i = 1; i < vertexCount; i++) {
+        min = Vector3Min(min, positions[i]);
+        max = Vector3Max(max, positions[i]);
+    }
+    f32 scale = fmaxf(max.x - min.x, fmaxf(max.y - min.y, max.z - min.z));
+    if (scale <= 0) scale = 1.0f;
+
+    for (u32 i = 0; i < vertexCount; i++) {
+        Quant_Vertex *vertex = &destination[i];
+        Vector3 relative = Vector3Scale(Vector3Subtract(positions[i], min), 1.0f / scale);
+        vertex->position[0] = (u16) roundf(Clamp(relative.x, 0, 1) * 65535.0f);
+        vertex->position[1] = (u16) roundf(Clamp(relative.y, 0, 1) * 65535.0f);
+        vertex->position[2] = (u16) roundf(Clamp(relative.z, 0, 1) * 65535.0f);
+        vertex->position[3] = 65535;
+
+        vertex->texcoord[0] = texcoords ? HalfFromFloat(texcoords[i].x) : 0;
+        vertex->texcoord[1] = texcoords ? HalfFromFloat(texcoords[i].y) : 0;
+
+        OctEncode(normals ? normals[i] : (Vector3) { 0, 0, 1 }, vertex->normal);
+        vertex->normal[2] = 0;
+        vertex->normal[3] = -127;
+    }
+
+    return (Vector4) { min.x, min.y, min.z, scale };
+}
+
+void Quant_DecodeVertex(const Quant_Vertex *vertex, Vector4 decode, Vector3 *position, Vector2 *texcoord, Vector3 *normal) {
+    f32 scale = decode.w / 65535.0f;
+    *position = (Vector3) {
+            decode.x + (f32) vertex->position[0] * scale,
+            decode.y + (f32) vertex->position[1] * scale,
+            decode.z + (f32) vertex->position[2] * scale
+    };
+    *texcoord = (Vector2) { FloatFromHalf(vertex->texcoord[0]), FloatFromHalf(vertex->texcoord[1]) };
+    *normal = OctDecode(vertex->normal[0], vertex->normal[1]);
+}
+
+u64 Quant_MeshBytes(const Mesh *mesh, b8 compact) {
+    u64 vertexCount = (u64) mesh->vertexCount;
+    u64 size = 0;
+    if (compact) {
+        size += vertexCount * sizeof(Quant_Vertex);
+    } else {
+        // UploadMesh() always creates the texcoord buffer
+        if (mesh->vertices) size += vertexCount * 3 * sizeof(f32);
+        size += vertexCount * 2 * sizeof(f32);
+        if (mesh->normals) size += vertexCount * 3 * sizeof(f32);
+    }
+    if (mesh->colors)  size += vertexCount * 4;
+    if (mesh->indices) size += (u64) mesh->triangleCount * 3 * sizeof(unsigned short);
+    return size;
+}
+
+void Quant_UploadMesh(Mesh *mesh) {
+    if (!quant.enabled || mesh->vaoId > 0 || mesh->vertices == NULL || mesh->vertexCount == 0
+        || quant.stats.meshes >= QUANT_MAX_MESHES || !CompactSupported()) {
+        UploadMesh(mesh, false);
+        return;
+    }
+
+    u32 vertexCount = (u32) mesh->vertexCount;
+    Quant_Vertex *vertices = RL_MALLOC(vertexCount * sizeof(Quant_Vertex));
+    unsigned int *vboId = RL_CALLOC(QUANT_MESH_VERTEX_BUFFERS, sizeof(unsigned int));
+    if (vertices == NULL || vboId == NULL) {
+        RL_FREE(vertices);
+        RL_FREE(vboId);
+        UploadMesh(mesh, false);
+        return;
+    }
+    Vector4 decode = Quant_EncodeVertices(mesh, vertices);
+
+    mesh->vboId = vboId;
+    mesh->vaoId = rlLoadVertexArray();
+    rlEnableVertexArray(mesh->vaoId);
+
+    // one interleaved buffer, the attribute pointers are offsets into it
+    mesh->vboId[QUANT_VBO_VERTICES] = rlLoadVertexBuffer(vertices, (int) (vertexCount * sizeof(Quant_Vertex)), false);
+    rlSetVertexAttribute(QUANT_LOCATION_POSITION, 4, QUANT_GL_UNSIGNED_SHORT, true, sizeof(Quant_Vertex),
+                         (const void *) offsetof(Quant_Vertex, position));
+    rlEnableVertexAttribute(QUANT_LOCATION_POSITION);
+    rlSetVertexAttribute(QUANT_LOCATION_TEXCOORD, 2, QUANT_GL_HALF_FLOAT, false, sizeof(Quant_Vertex),
+                         (const void *) offsetof(Quant_Vertex, texcoord));
+    rlEnableVertexAttribute(QUANT_LOCATION_TEXCOORD);
+    rlSetVertexAttribute(QUANT_LOCATION_NORMAL, 4, QUANT_GL_BYTE, true, sizeof(Quant_Vertex),
+                         (const void *) offsetof(Quant_Vertex, normal));
+    rlEnableVertexAttribute(QUANT_LOCATION_NORMAL);
+
+    if (mesh->colors) {
+        mesh->vboId[QUANT_VBO_COLORS] = rlLoadVertexBuffer(mesh->colors, (int) (vertexCount * 4), false);
+        rlSetVertexAttribute(QUANT_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, true, 0, 0);
+        rlEnableVertexAttribute(QUANT_LOCATION_COLOR);
+    } else {
+        // same default as UploadMesh()
+        f32 white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        rlSetVertexAttributeDefault(QUANT_LOCATION_COLOR, white, SHADER_ATTRIB_VEC4, 4);
+        rlDisableVertexAttribute(QUANT_LOCATION_COLOR);
+    }
+
+    if (mesh->indices) {
+        mesh->vboId[QUANT_VBO_INDICES] = rlLoadVertexBufferElement(mesh->indices, mesh->triangleCount * 3 * (int) sizeof(unsigned short), false);
+    }
+    rlDisableVertexArray();
+    RL_FREE(vertices);
+
+    InsertMesh((struct QuantMesh) {
+            .vaoId = mesh->vaoId,
+            .decode = decode,
+            .floatBytes = Quant_MeshBytes(mesh, false),
+            .compactBytes = Quant_MeshBytes(mesh, true)
+    });
+}
+
+void Quant_UnloadMesh(Mesh mesh) {
+    struct QuantMesh *entry = (mesh.vaoId != 0) ? FindMesh(mesh.vaoId) : NULL;
+    if (entry != NULL) RemoveMesh(entry);
+    UnloadMesh(mesh);
+}
+
+b8 Quant_GetDecode(Mesh mesh, Matrix *decode) {
+    if (quant.stats.meshes == 0 || mesh.vaoId == 0) return false;
+
+    const struct QuantMesh *entry = FindMesh(mesh.vaoId);
+    if (entry == NULL) return false;
+
+    Vector4 d = entry->decode;
+    *decode = MatrixMultiply(MatrixScale(d.w, d.w, d.w), MatrixTranslate(d.x, d.y, d.z));
+    return true;
+}
+
+Quant_Stats Quant_GetStats(void) {
+    return quant.stats;
+}
@@ -0,0 +1,532 @@
+#include <math.h>
+#include <stdatomic.h>
+
+#include "raylib.h"
+
+#include "arena.h"
+#include "profiler.h"
+#include "raycast.h"
+#include "thread.h"
+
+// integer lanes need SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAYCAST_USE_SSE
+#include <emmintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum RaycastConstExpr {
+    RAYCAST_MAX_WORKERS = 32,
+    RAYCAST_LANES = 4,
+    RAYCAST_GRAIN = 256,                // rays per unit of work handed to a thread
+    RAYCAST_THREADED_MIN = 4096,        // smaller batches aren't worth waking the workers for
+};
+
+// 1 / 0 stand in for an axis the ray doesn't move along, it never crosses a boundary on it
+#define RAYCAST_NEVER 1e30f
+
+enum RaycastJobKind {
+    RAYCAST_JOB_CAST,
+    RAYCAST_JOB_LINE_OF_SIGHT,
+};
+
+// what the traversal needs from a map, looked up once per call instead of once per step
+struct RaycastView {
+    const u8 *tiles;
+    const b8 *solid;
+    i32 width;
+    i32 height;
+    i32 chunksX;
+    f32 tileSize;
+    f32 invTileSize;
+};
+
+// per ray traversal setup, in tile units
+struct RaycastSetup {
+    f32 dirX, dirY;                     // normalized
+    f32 sideX, sideY;                   // distance along the ray to the first x / y tile boundary
+    f32 deltaX, deltaY;                 // distance between boundaries
+    f32 maxT;
+    i32 mapX, mapY;
+    i32 stepX, stepY;
+};
+
+// a batch being cast, lives in the module state so a worker that wakes up late never sees a dangling job
+struct RaycastJob {
+    int kind;
+    struct RaycastView view;
+    u32 count;
+
+    const Raycast_Ray *rays;            // RAYCAST_JOB_CAST
+    Raycast_Hit *hits;
+
+    const Vector2 *from;                // RAYCAST_JOB_LINE_OF_SIGHT
+    const Vector2 *to;
+    b8 *visible;
+
+    atomic_uint next;                   // first ray not handed out yet
+    atomic_uint completed;
+};
+
+static struct Raycast {
+    b8 initialized;
+    b8 threaded;
+    b8 solid[256];
+
+    Mutex mutex;
+    CondVar workAvailable;
+    CondVar workDone;
+    u32 generation;                     // bumped for every job, workers take each one once
+    int busyWorkers;
+    b8 quit;
+
+    Thread workers[RAYCAST_MAX_WORKERS];
+    int workerCount;
+
+    struct RaycastJob job;
+} raycast = {
+        .threaded = true,
+        .solid = { [1] = true },
+};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static struct RaycastView GetView(const TileMap *map) {
+    u32 chunksX, chunksY;
+    TileMap_ChunkCount(map, &chunksX, &chunksY);
+
+    f32 tileSize = TileMap_TileSize(map);
+    return (struct RaycastView) {
+            .tiles = TileMap_Tiles(map),
+            .solid = raycast.solid,
+            .width = (i32) TileMap_Width(map),
+            .height = (i32) TileMap_Height(map),
+            .chunksX = (i32) chunksX,
+            .tileSize = tileSize,
+            .invTileSize = 1.0f / tileSize,
+    };
+}
+
+static u32 TileIndex(const struct RaycastView *view, i32 x, i32 y) {
+    u32 chunk = (u32) (y >> TILEMAP_CHUNK_SHIFT) * (u32) view->chunksX + (u32) (x >> TILEMAP_CHUNK_SHIFT);
+    return (chunk << (2 * TILEMAP_CHUNK_SHIFT))
+         | ((u32) (y & TILEMAP_CHUNK_MASK) << TILEMAP_CHUNK_SHIFT)
+         | (u32) (x & TILEMAP_CHUNK_MASK);
+}
+
+// false for a zero length direction, which can't go anywhere
+static b8 Setup(const struct RaycastView *view, Raycast_Ray ray, struct RaycastSetup *setup) {
+    f32 length = sqrtf(ray.direction.x * ray.direction.x + ray.direction.y * ray.direction.y);
+    if (length <= 0) return false;
+
+    f32 originX = ray.origin.x * view->invTileSize;
+    f32 originY = ray.origin.y * view->invTileSize;
+    setup->dirX = ray.direction.x / length;
+    setup->dirY = ray.direction.y / length;
+    setup->maxT = ray.maxDistance * view->invTileSize;
+    setup->mapX = (i32) floorf(originX);
+    setup->mapY = (i32) floorf(originY);
+
+    setup->deltaX = (setup->dirX != 0) ? fabsf(1.0f / setup->dirX) : RAYCAST_NEVER;
+    setup->deltaY = (setup->dirY != 0) ? fabsf(1.0f / setup->dirY) : RAYCAST_NEVER;
+    setup->stepX = (setup->dirX < 0) ? -1 : 1;
+    setup->stepY = (setup->dirY < 0) ? -1 : 1;
+    setup->sideX = (setup->dirX < 0) ? (originX - (f32) setup->mapX) * setup->deltaX
+                                     : ((f32) setup->mapX + 1 - originX) * setup->deltaX;
+    setup->sideY = (setup->dirY < 0) ? (originY - (f32) setup->mapY) * setup->deltaY
+                                     : ((f32) setup->mapY + 1 - originY) * setup->deltaY;
+    return true;
+}
+
+// tileX / tileY are the last tile the ray got to
+static Raycast_Hit Miss(Raycast_Ray ray, const struct RaycastSetup *setup, i32 tileX, i32 tileY) {
+    return (Raycast_Hit) {
+            .point = {
+                    ray.origin.x + setup->dirX * ray.maxDistance,
+                    ray.origin.y + setup->dirY * ray.maxDistance
+            },
+            .distance = ray.maxDistance,
+            .tileX = tileX,
+            .tileY = tileY,
+    };
+}
+
+static Raycast_Hit Hit(const struct RaycastView *view, Raycast_Ray ray, const struct RaycastSetup *setup,
+                       f32 t, i32 tileX, i32 tileY, u8 tile, u8 side) {
+    f32 distance = t * view->tileSize;
+    return (Raycast_Hit) {
+            .point = { ray.origin.x + setup->dirX * distance, ray.origin.y + setup->dirY * distance },
+            .distance = distance,
+            .tileX = tileX,
+            .tileY = tileY,
+            .tile = tile,
+            .side = side,
+            .hit = true,
+    };
+}
+
+static Raycast_Hit CastScalar(const struct RaycastView *view, Raycast_Ray ray) {
+    struct RaycastSetup s;
+    if (!Setup(view, ray, &s)) {
+        return (Raycast_Hit) { .point = ray.origin, .tileX = (i32) floorf(ray.origin.x * view->invTileSize),
+                                                    .tileY = (i32) floorf(ray.origin.y * view->invTileSize) };
+    }
+
+    i32 mapX = s.mapX, mapY = s.mapY;
+    for (;;) {
+        f32 t;
+        u8 side;
+        if (s.sideX < s.sideY) {
+            t = s.sideX;
+            s.sideX += s.deltaX;
+            mapX += s.stepX;
+            side = 0;
+        } else {
+            t = s.sideY;
+            s.sideY += s.deltaY;
+            mapY += s.stepY;
+            side = 1;
+        }
+
+        if (t > s.maxT) break;
+        if (mapX < 0 || mapY < 0 || mapX >= view->width || mapY >= view->height) break;
+
+        u8 tile = view->tiles[TileIndex(view, mapX, mapY)];
+        if (view->solid[tile]) return Hit(view, ray, &s, t, mapX, mapY, tile, side);
+    }
+    return Miss(ray, &s, mapX, mapY);
+}
+
+#ifdef RAYCAST_USE_SSE
+// up to 4 rays stepped together, the same arithmetic as CastScalar() so the results match it exactly
+static void CastPacket(const struct RaycastView *view, const Raycast_Ray *rays, Raycast_Hit *hits, u32 count) {
+    _Alignas(16) f32 sideX[RAYCAST_LANES], sideY[RAYCAST_LANES], deltaX[RAYCAST_LANES], deltaY[RAYCAST_LANES];
+    _Alignas(16) f32 maxT[RAYCAST_LANES];
+    _Alignas(16) i32 mapX[RAYCAST_LANES], mapY[RAYCAST_LANES], stepX[RAYCAST_LANES], stepY[RAYCAST_LANES];
+    struct RaycastSetup setups[RAYCAST_LANES];
+
+    int active = 0;
+    for (u32 lane = 0; lane < RAYCAST_LANES; lane++) {
+        struct RaycastSetup *s = &setups[lane];
+        if (lane < count && Setup(view, rays[lane], s)) {
+            active |= 1 << lane;
+        } else {
+            if (lane < count) hits[lane] = CastScalar(view, rays[lane]);
+            *s = (struct RaycastSetup) { .deltaX = RAYCAST_NEVER, .deltaY = RAYCAST_NEVER, .stepX = 1, .stepY = 1 };
+        }
+        sideX[lane] = s->sideX;
+        sideY[lane] = s->sideY;
+        deltaX[lane] = s->deltaX;
+        deltaY[lane] = s->deltaY;
+        maxT[lane] = s->maxT;
+        mapX[lane] = s->mapX;
+        mapY[lane] = s->mapY;
+        stepX[lane] = s->stepX;
+        stepY[lane] = s->stepY;
+    }
+
+    __m128 vSideX = _mm_load_ps(sideX), vSideY = _mm_load_ps(sideY);
+    __m128 vDeltaX = _mm_load_ps(deltaX), vDeltaY = _mm_load_ps(deltaY);
+    __m128 vMaxT = _mm_load_ps(maxT);
+    __m128i vMapX = _mm_load_si128((const __m128i *) mapX), vMapY = _mm_load_si128((const __m128i *) mapY);
+    __m128i vStepX = _mm_load_si128((const __m128i *) stepX), vStepY = _mm_load_si128((const __m128i *) stepY);
+
+    const __m128i width = _mm_set1_epi32(view->width), height = _mm_set1_epi32(view->height);
+    const __m128i chunksX = _mm_set1_epi32(view->chunksX);
+    const __m128i chunkMask = _mm_set1_epi32(TILEMAP_CHUNK_MASK);
+    const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi32(1);
+
+    _Alignas(16) i32 index[RAYCAST_LANES];
+    _Alignas(16) f32 t[RAYCAST_LANES];
+    _Alignas(16) i32 side[RAYCAST_LANES];
+    while (active) {
+        // step every lane across its nearest boundary
+        __m128 inX = _mm_cmplt_ps(vSideX, vSideY);
+        __m128i inXi = _mm_castps_si128(inX);
+        __m128 vT = _mm_or_ps(_mm_and_ps(inX, vSideX), _mm_andnot_ps(inX, vSideY));
+        vSideX = _mm_add_ps(vSideX, _mm_and_ps(inX, vDeltaX));
+        vSideY = _mm_add_ps(vSideY, _mm_andnot_ps(inX, vDeltaY));
+        vMapX = _mm_add_epi32(vMapX, _mm_and_si128(inXi, vStepX));
+        vMapY = _mm_add_epi32(vMapY, _mm_andnot_si128(inXi, vStepY));
+
+        // past max distance or off the map
+        __m128i outside = _mm_or_si128(_mm_cmplt_epi32(vMapX, zero), _mm_cmplt_epi32(vMapY, zero));
+        outside = _mm_or_si128(outside, _mm_cmpgt_epi32(vMapX, _mm_sub_epi32(width, one)));
+        outside = _mm_or_si128(outside, _mm_cmpgt_epi32(vMapY, _mm_sub_epi32(height, one)));
+        int done = (_mm_movemask_ps(_mm_cmpgt_ps(vT, vMaxT)) | _mm_movemask_ps(_mm_castsi128_ps(outside))) & active;
+        if (done) {
+            _mm_store_si128((__m128i *) mapX, vMapX);
+            _mm_store_si128((__m128i *) mapY, vMapY);
+            for (u32 lane = 0; done; lane++, done >>= 1) {
+                if (!(done & 1)) continue;
+                hits[lane] = Miss(rays[lane], &setups[lane], mapX[lane], mapY[lane]);
+                active &= ~(1 << lane);
+            }
+            if (!active) break;
+        }
+
+        // chunk major tile index, chunk row * chunksX fits 16 bit halves so madd does the multiply
+        __m128i chunk = _mm_add_epi32(_mm_madd_epi16(_mm_srli_epi32(vMapY, TILEMAP_CHUNK_SHIFT), chunksX),
+                                      _mm_srli_epi32(vMapX, TILEMAP_CHUNK_SHIFT));
+        __m128i vIndex = _mm_or_si128(_mm_slli_epi32(chunk, 2 * TILEMAP_CHUNK_SHIFT),
+                                      _mm_or_si128(_mm_slli_epi32(_mm_and_si128(vMapY, chunkMask), TILEMAP_CHUNK_SHIFT),
+                                                   _mm_and_si128(vMapX, chunkMask)));
+        _mm_store_si128((__m128i *) index, vIndex);
+
+        int solid = 0;
+        for (u32 lane = 0; lane < RAYCAST_LANES; lane++) {
+            if ((active >> lane) & 1) solid |= view->solid[view->tiles[index[lane]]] << lane;
+        }
+        if (!solid) continue;
+
+        _mm_store_ps(t, vT);
+        _mm_store_si128((__m128i *) side, _mm_andnot_si128(inXi, one));
+        _mm_store_si128((__m128i *) mapX, vMapX);
+        _mm_store_si128((__m128i *) mapY, vMapY);
+        for (u32 lane = 0; solid; lane++, solid >>= 1) {
+            if (!(solid & 1)) continue;
+            hits[lane] = Hit(view, rays[lane], &setups[lane], t[lane], mapX[lane], mapY[lane],
+                             view->tiles[index[lane]], (u8) side[lane]);
+            active &= ~(1 << lane);
+        }
+    }
+}
+#else
+static void CastPacket(const struct RaycastView *view, const Raycast_Ray *rays, Raycast_Hit *hits, u32 count) {
+    for (u32 i = 0; i < count; i++) {
+        hits[i] = CastScalar(view, rays[i]);
+    }
+}
+#endif
+
+static void CastRange(const struct RaycastView *view, const Raycast_Ray *rays, Raycast_Hit *hits, u32 count) {
+    for (u32 i = 0; i < count; i += RAYCAST_LANES) {
+        u32 lanes = count - i < RAYCAST_LANES ? count - i : RAYCAST_LANES;
+        CastPacket(view, rays + i, hits + i, lanes);
+    }
+}
+
+static void LineOfSightRange(const struct RaycastView *view, const Vector2 *from, const Vector2 *to, b8 *visible,
+                             u32 count) {
+    Raycast_Ray rays[RAYCAST_GRAIN];
+    Raycast_Hit hits[RAYCAST_GRAIN];
+    for (u32 i = 0; i < count; i += RAYCAST_GRAIN) {
+        u32 n = count - i < RAYCAST_GRAIN ? count - i : RAYCAST_GRAIN;
+        for (u32 r = 0; r < n; r++) {
+            Vector2 delta = { to[i + r].x - from[i + r].x, to[i + r].y - from[i + r].y };
+            rays[r] = (Raycast_Ray) { from[i + r], delta, sqrtf(delta.x * delta.x + delta.y * delta.y) };
+        }
+        CastRange(view, rays, hits, n);
+        for (u32 r = 0; r < n; r++) {
+            visible[i + r] = !hits[r].hit;
+        }
+    }
+}
+
+// grab grains of the current job until there are none left, returns once this thread's share is done
+static void WorkOnJob(struct RaycastJob *job) {
+    for (;;) {
+        u32 first = atomic_fetch_add(&job->next, RAYCAST_GRAIN);
+        if (first >= job->count) return;
+
+        u32 n = job->count - first < RAYCAST_GRAIN ? job->count - first : RAYCAST_GRAIN;
+        if (job->kind == RAYCAST_JOB_CAST) {
+            CastRange(&job->view, job->rays + first, job->hits + first, n);
+        } else {
+            LineOfSightRange(&job->view, job->from + first, job->to + first, job->visible + first, n);
+        }
+
+        if (atomic_fetch_add(&job->completed, n) + n == job->count) {
+            Mutex_Lock(&raycast.mutex);
+            CondVar_Broadcast(&raycast.workDone);
+            Mutex_Unlock(&raycast.mutex);
+        }
+    }
+}
+
+static int WorkerMain(void *arg) {
+    (void) arg;
+    Profiler_SetThreadName("raycast");
+
+    u32 seen = 0;
+    for (;;) {
+        Mutex_Lock(&raycast.mutex);
+        while (!raycast.quit && raycast.generation == seen) {
+            CondVar_Wait(&raycast.workAvailable, &raycast.mutex);
+        }
+        if (raycast.quit) {
+            Mutex_Unlock(&raycast.mutex);
+            return 0;
+        }
+        seen = raycast.generation;
+        raycast.busyWorkers++;
+        Mutex_Unlock(&raycast.mutex);
+
+        Profiler_Zone zone = PROFILE_BEGIN("rays");
+        WorkOnJob(&raycast.job);
+        PROFILE_END(zone);
+
+        Mutex_Lock(&raycast.mutex);
+        raycast.busyWorkers--;
+        CondVar_Broadcast(&raycast.workDone);
+        Mutex_Unlock(&raycast.mutex);
+    }
+}
+
+// the job must be filled in except for its counters, runs it on the workers and the calling thread
+static void RunJob(const struct RaycastJob *job) {
+    if (!raycast.initialized || !raycast.threaded || raycast.workerCount == 0 || job->count < RAYCAST_THREADED_MIN) {
+        if (job->kind == RAYCAST_JOB_CAST) {
+            CastRange(&job->view, job->rays, job->hits, job->count);
+        } else {
+            LineOfSightRange(&job->view, job->from, job->to, job->visible, job->count);
+        }
+        return;
+    }
+
+    // a worker still finishing up the previous job only ever looks at its counters, wait it out before reusing them
+    Mutex_Lock(&raycast.mutex);
+    while (raycast.busyWorkers > 0) {
+        CondVar_Wait(&raycast.workDone, &raycast.mutex);
+    }
+    raycast.job.kind = job->kind;
+    raycast.job.view = job->view;
+    raycast.job.count = job->count;
+    raycast.job.rays = job->rays;
+    raycast.job.hits = job->hits;
+    raycast.job.from = job->from;
+    raycast.job.to = job->to;
+    raycast.job.visible = job->visible;
+    atomic_store(&raycast.job.next, 0);
+    atomic_store(&raycast.job.completed, 0);
+    raycast.generation++;
+    CondVar_Broadcast(&raycast.workAvailable);
+    Mutex_Unlock(&raycast.mutex);
+
+    WorkOnJob(&raycast.job);
+
+    Mutex_Lock(&raycast.mutex);
+    while (atomic_load(&raycast.job.completed) < raycast.job.count) {
+        CondVar_Wait(&raycast.workDone, &raycast.mutex);
+    }
+    Mutex_Unlock(&raycast.mutex);
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void Raycast_Init(int workerCount) {
+    if (raycast.initialized) return;
+
+    Mutex_Init(&raycast.mutex);
+    CondVar_Init(&raycast.workAvailable);
+    CondVar_Init(&raycast.workDone);
+    raycast.generation = 0;
+    raycast.busyWorkers = 0;
+    raycast.quit = false;
+    raycast.workerCount = 0;
+
+    if (workerCount <= 0) workerCount = Thread_HardwareConcurrency() - 1;
+    if (workerCount > RAYCAST_MAX_WORKERS) workerCount = RAYCAST_MAX_WORKERS;
+
+    for (int i = 0; i < workerCount; i++) {
+        if (!Thread_Create(&raycast.workers[raycast.workerCount], WorkerMain, NULL)) break;
+        raycast.workerCount++;
+    }
+
+    raycast.initialized = true;
+    TraceLog(LOG_INFO, "RAYCAST: Started %i worker threads", raycast.workerCount);
+}
+
+void Raycast_Shutdown(void) {
+    if (!raycast.initialized) return;
+
+    Mutex_Lock(&raycast.mutex);
+    raycast.quit = true;
+    CondVar_Broadcast(&raycast.workAvailable);
+    Mutex_Unlock(&raycast.mutex);
+
+    for (int i = 0; i < raycast.workerCount; i++) {
+        Thread_Join(&raycast.workers[i]);
+    }
+
+    CondVar_Destroy(&raycast.workDone);
+    CondVar_Destroy(&raycast.workAvailable);
+    Mutex_Destroy(&raycast.mutex);
+    raycast.workerCount = 0;
+    raycast.initialized = false;
+}
+
+void Raycast_SetThreaded(b8 threaded) {
+    raycast.threaded = threaded;
+}
+
+b8 Raycast_IsThreaded(void) {
+    return raycast.threaded;
+}
+
+void Raycast_SetSolid(u8 tile, b8 solid) {
+    raycast.solid[tile] = solid;
+}
+
+Raycast_Hit Raycast_Cast(const TileMap *map, Raycast_Ray ray) {
+    struct RaycastView view = GetView(map);
+    return CastScalar(&view, ray);
+}
+
+b8 Raycast_LineOfSight(const TileMap *map, Vector2 from, Vector2 to) {
+    Vector2 delta = { to.x - from.x, to.y - from.y };
+    Raycast_Ray ray = { from, delta, sqrtf(delta.x * delta.x + delta.y * delta.y) };
+    return !Raycast_Cast(map, ray).hit;
+}
+
+void Raycast_CastBatch(const TileMap *map, const Raycast_Ray *rays, Raycast_Hit *hits, u32 count) {
+    if (count == 0) return;
+    RunJob(&(struct RaycastJob) {
+            .kind = RAYCAST_JOB_CAST,
+            .view = GetView(map),
+            .count = count,
+            .rays = rays,
+            .hits = hits,
+    });
+}
+
+void Raycast_LineOfSightBatch(const TileMap *map, const Vector2 *from, const Vector2 *to, b8 *visible, u32 count) {
+    if (count == 0) return;
+    RunJob(&(struct RaycastJob) {
+            .kind = RAYCAST_JOB_LINE_OF_SIGHT,
+            .view = GetView(map),
+            .count = count,
+            .from = from,
+            .to = to,
+            .visible = visible,
+    });
+}
+
+void Raycast_Columns(const TileMap *map, Vector2 origin, f32 angle, f32 fov, f32 maxDistance, Raycast_Hit *hits, u32 columns) {
+    if (columns == 0) return;
+
+    Arena_Temp scratch = Arena_ScratchBegin();
+    Raycast_Ray *rays = Arena_PushArray(scratch.arena, Raycast_Ray, columns);
+
+    // evenly spaced on a view plane rather than in angle, like the columns of a perspective projection
+    Vector2 forward = { cosf(angle), sinf(angle) };
+    Vector2 plane = { -forward.y * tanf(fov / 2), forward.x * tanf(fov / 2) };
+    for (u32 i = 0; i < columns; i++) {
+        f32 x = (columns > 1) ? 2.0f * (f32) i / (f32) (columns - 1) - 1.0f : 0.0f;
+        rays[i] = (Raycast_Ray) {
+                .origin = origin,
+                .direction = { forward.x + plane.x * x, forward.y + plane.y * x },
+                .maxDistance = maxDistance,
+        };
+    }
+
+    Raycast_CastBatch(map, rays, hits, columns);
+    Arena_ScratchEnd(scratch);
+}
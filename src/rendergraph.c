@@ -0,0 +1,263 @@
+#include <string.h>
+
+#include "raylib.h"
+
+#include "rendergraph.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum RenderGraphConstExpr {
+    RENDERGRAPH_NONE = -1,
+};
+
+static const u64 RENDERGRAPH_HASH_SEED = 0xcbf29ce484222325ull;
+
+struct RenderGraphTarget {
+    b8 transient;
+    int width;
+    int height;
+    RenderTexture2D texture;            // imported, or the pooled texture a transient borrowed this frame
+
+    // imported targets only, what was last drawn
+    b8 valid;
+    u64 contentHash;
+
+    // per RenderGraph_Execute()
+    u64 frameHash;
+    i32 producer;
+    i32 lastReader;
+    b8 needed;
+    i32 pooled;
+};
+
+struct RenderGraphPooled {
+    RenderTexture2D texture;
+    b8 inUse;
+};
+
+static struct RenderGraph {
+    struct RenderGraphTarget targets[RENDERGRAPH_MAX_TARGETS];
+    u32 targetCount;
+
+    RenderGraph_Pass passes[RENDERGRAPH_MAX_PASSES];
+    u64 passHashes[RENDERGRAPH_MAX_PASSES];
+    b8 passRuns[RENDERGRAPH_MAX_PASSES];
+    u32 passCount;
+
+    // transient backing textures, at most one per transient target
+    struct RenderGraphPooled pool[RENDERGRAPH_MAX_TARGETS];
+    u32 poolCount;
+    RenderGraph_LoadTextureFunc loadTexture;
+    RenderGraph_UnloadTextureFunc unloadTexture;
+
+    RenderGraph_Stats stats;
+} renderGraph = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static b8 IsTarget(RenderGraph_Target target) {
+    return target < renderGraph.targetCount;
+}
+
+static RenderGraph_Target AddTarget(struct RenderGraphTarget target) {
+    if (renderGraph.targetCount >= RENDERGRAPH_MAX_TARGETS) {
+        TraceLog(LOG_WARNING, "RENDERGRAPH: More than %d targets", RENDERGRAPH_MAX_TARGETS);
+        return RENDERGRAPH_SCREEN;
+    }
+    renderGraph.targets[renderGraph.targetCount] = target;
+    return renderGraph.targetCount++;
+}
+
+// a free pooled texture of the transient's size, a new one only when there's none
+static i32 AcquirePooled(const struct RenderGraphTarget *target) {
+    for (u32 i = 0; i < renderGraph.poolCount; i++) {
+        struct RenderGraphPooled *pooled = &renderGraph.pool[i];
+        if (!pooled->inUse && pooled->texture.texture.width == target->width && pooled->texture.texture.height == target->height) {
+            pooled->inUse = true;
+            return (i32) i;
+        }
+    }
+    if (renderGraph.poolCount >= RENDERGRAPH_MAX_TARGETS) return RENDERGRAPH_NONE;
+
+    struct RenderGraphPooled *pooled = &renderGraph.pool[renderGraph.poolCount];
+    pooled->texture = renderGraph.loadTexture(target->width, target->height);
+    pooled->inUse = true;
+    return (i32) renderGraph.poolCount++;
+}
+
+// hashes of every pass and of what each target will hold once the frame is drawn
+static void HashPasses(void) {
+    for (u32 t = 0; t < renderGraph.targetCount; t++) {
+        struct RenderGraphTarget *target = &renderGraph.targets[t];
+        target->frameHash = target->valid ? target->contentHash : 0;
+        target->producer = RENDERGRAPH_NONE;
+        target->lastReader = RENDERGRAPH_NONE;
+        target->needed = false;
+        target->pooled = RENDERGRAPH_NONE;
+    }
+
+    for (u32 p = 0; p < renderGraph.passCount; p++) {
+        const RenderGraph_Pass *pass = &renderGraph.passes[p];
+        u64 hash = RenderGraph_Hash(RENDERGRAPH_HASH_SEED, pass->name, strlen(pass->name));
+        hash = RenderGraph_Hash(hash, &pass->inputs, sizeof(pass->inputs));
+
+        for (u32 r = 0; r < pass->readCount; r++) {
+            if (!IsTarget(pass->reads[r])) continue;
+
+            struct RenderGraphTarget *read = &renderGraph.targets[pass->reads[r]];
+            if (read->transient && read->producer == RENDERGRAPH_NONE) {
+                TraceLog(LOG_WARNING, "RENDERGRAPH: Pass '%s' reads a transient target before anything draws it", pass->name);
+            }
+            hash = RenderGraph_Hash(hash, &read->frameHash, sizeof(read->frameHash));
+        }
+        renderGraph.passHashes[p] = hash;
+
+        if (IsTarget(pass->output)) {
+            renderGraph.targets[pass->output].frameHash = hash;
+            renderGraph.targets[pass->output].producer = (i32) p;
+        }
+    }
+}
+
+// from the screen backwards, a pass runs if its target would change or a pass that runs samples it
+static void DecideRuns(void) {
+    for (i32 p = (i32) renderGraph.passCount - 1; p >= 0; p--) {
+        const RenderGraph_Pass *pass = &renderGraph.passes[p];
+
+        b8 runs;
+        if (!IsTarget(pass->output)) {
+            runs = true;
+        } else {
+            struct RenderGraphTarget *output = &renderGraph.targets[pass->output];
+            if (output->transient) {
+                runs = output->needed;
+                output->needed = false;
+            } else {
+                runs = !output->valid || output->contentHash != renderGraph.passHashes[p];
+            }
+        }
+        renderGraph.passRuns[p] = runs;
+        if (!runs) continue;
+
+        for (u32 r = 0; r < pass->readCount; r++) {
+            if (!IsTarget(pass->reads[r])) continue;
+
+            struct RenderGraphTarget *read = &renderGraph.targets[pass->reads[r]];
+            read->needed = true;
+            if (read->lastReader < p) read->lastReader = p;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void RenderGraph_Init(RenderGraph_LoadTextureFunc loadTexture, RenderGraph_UnloadTextureFunc unloadTexture) {
+    memset(&renderGraph, 0, sizeof(renderGraph));
+    renderGraph.loadTexture = loadTexture;
+    renderGraph.unloadTexture = unloadTexture;
+}
+
+void RenderGraph_Shutdown(void) {
+    for (u32 i = 0; i < renderGraph.poolCount; i++) {
+        renderGraph.unloadTexture(renderGraph.pool[i].texture);
+    }
+    memset(&renderGraph, 0, sizeof(renderGraph));
+}
+
+RenderGraph_Target RenderGraph_ImportTarget(RenderTexture2D texture) {
+    return AddTarget((struct RenderGraphTarget) {
+            .width = texture.texture.width, .height = texture.texture.height, .texture = texture
+    });
+}
+
+RenderGraph_Target RenderGraph_CreateTransient(int width, int height) {
+    return AddTarget((struct RenderGraphTarget) { .transient = true, .width = width, .height = height });
+}
+
+void RenderGraph_Invalidate(RenderGraph_Target target) {
+    if (IsTarget(target)) renderGraph.targets[target].valid = false;
+}
+
+void RenderGraph_AddPass(const RenderGraph_Pass *pass) {
+    if (renderGraph.passCount >= RENDERGRAPH_MAX_PASSES) {
+        TraceLog(LOG_WARNING, "RENDERGRAPH: More than %d passes, '%s' dropped", RENDERGRAPH_MAX_PASSES, pass->name);
+        return;
+    }
+    renderGraph.passes[renderGraph.passCount++] = *pass;
+}
+
+void RenderGraph_Execute(void) {
+    HashPasses();
+    DecideRuns();
+
+    RenderGraph_Stats stats = { .passes = renderGraph.passCount };
+    for (u32 p = 0; p < renderGraph.passCount; p++) {
+        const RenderGraph_Pass *pass = &renderGraph.passes[p];
+        struct RenderGraphTarget *output = IsTarget(pass->output) ? &renderGraph.targets[pass->output] : NULL;
+
+        if (!renderGraph.passRuns[p]) {
+            if (output != NULL && output->transient) {
+                stats.culled++;
+            } else {
+                stats.skipped++;
+            }
+            continue;
+        }
+
+        if (output != NULL && output->transient) {
+            if (output->pooled == RENDERGRAPH_NONE) {
+                output->pooled = AcquirePooled(output);
+                stats.transients++;
+            }
+            output->texture = (output->pooled != RENDERGRAPH_NONE) ? renderGraph.pool[output->pooled].texture : (RenderTexture2D) {0};
+        }
+
+        pass->draw(output != NULL ? output->texture : (RenderTexture2D) {0}, pass->user);
+        stats.executed++;
+
+        if (output != NULL && !output->transient) {
+            output->valid = true;
+            output->contentHash = renderGraph.passHashes[p];
+        }
+
+        // transients last read here give their texture back for the ones drawn later
+        for (u32 t = 0; t < renderGraph.targetCount; t++) {
+            struct RenderGraphTarget *target = &renderGraph.targets[t];
+            if (!target->transient || target->pooled == RENDERGRAPH_NONE || target->lastReader > (i32) p) continue;
+
+            renderGraph.pool[target->pooled].inUse = false;
+            target->pooled = RENDERGRAPH_NONE;
+        }
+    }
+
+    for (u32 i = 0; i < renderGraph.poolCount; i++) {
+        renderGraph.pool[i].inUse = false;
+    }
+    stats.pooled = renderGraph.poolCount;
+    renderGraph.stats = stats;
+    renderGraph.passCount = 0;
+}
+
+RenderTexture2D RenderGraph_GetTexture(RenderGraph_Target target) {
+    return IsTarget(target) ? renderGraph.targets[target].texture : (RenderTexture2D) {0};
+}
+
+// FNV-1a
+u64 RenderGraph_Hash(u64 hash, const void *data, u64 size) {
+    const u8 *bytes = data;
+    for (u64 i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+RenderGraph_Stats RenderGraph_GetStats(void) {
+    return renderGraph.stats;
+}
@@ -0,0 +1,291 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "arena.h"
+#include "renderqueue.h"
+#include "timer.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum RenderQueueConstExpr {
+    RENDERQUEUE_LANE_ARENA_BLOCK = 64 * 1024,
+    RENDERQUEUE_INITIAL_CAPACITY = 1024,            // items per lane, grows by doubling and is kept between frames
+    RENDERQUEUE_RADIX_BITS = 8,
+    RENDERQUEUE_RADIX_BUCKETS = 1 << RENDERQUEUE_RADIX_BITS,
+    RENDERQUEUE_RADIX_PASSES = 64 / RENDERQUEUE_RADIX_BITS,
+    RENDERQUEUE_MATERIAL_HASH_BITS = 4,
+    RENDERQUEUE_MAX_TEXTURES = 1 << (16 - RENDERQUEUE_MATERIAL_HASH_BITS),
+    RENDERQUEUE_TEXTURE_HASH_SIZE = RENDERQUEUE_MAX_TEXTURES * 2,     // open addressing, must be a power of 2
+};
+
+// key layout, high bits first
+//   opaque:      pass 4 | layer 1 | shader 8 | material 16 | mesh 16 | depth 19
+//   transparent: pass 4 | layer 1 | inverted depth 19 | shader 8 | material 16 | mesh 16
+// material ids are texture 12 | maps hash 4, the texture being a dense index handed out in the order diffuse
+// textures are first seen, GL texture ids are sparse after loads and unloads, 4096 textures before they share
+enum RenderQueueKeyBits {
+    KEY_PASS_SHIFT = 60,
+    KEY_LAYER_SHIFT = 59,
+    KEY_OPAQUE_SHADER_SHIFT = 51,
+    KEY_OPAQUE_MATERIAL_SHIFT = 35,
+    KEY_OPAQUE_MESH_SHIFT = RENDERQUEUE_DEPTH_BITS,
+    KEY_TRANSPARENT_DEPTH_SHIFT = 40,
+    KEY_TRANSPARENT_SHADER_SHIFT = 32,
+    KEY_TRANSPARENT_MATERIAL_SHIFT = 16,
+    KEY_TRANSPARENT_MESH_SHIFT = 0,
+};
+
+typedef struct RenderQueueItem RenderQueueItem;
+struct RenderQueueItem {
+    u64 key;
+    void *payload;
+};
+
+struct RenderQueueTexture {
+    u32 id;                             // GL texture id, 0 for an empty slot
+    u32 index;                          // dense, from 1, 0 is kept for materials without a diffuse texture
+};
+
+// written by one thread while recording, aligned so neighbouring lanes don't share cache lines
+struct RenderQueueLane {
+    _Alignas(64) Arena arena;
+    RenderQueueItem *items;
+    u32 count;
+    u32 capacity;
+};
+
+static struct RenderQueue {
+    b8 initialized;
+    struct RenderQueueLane lanes[RENDERQUEUE_MAX_LANES];
+
+    // merged and sorted lanes, and the radix sort's ping pong buffer
+    RenderQueueItem *items;
+    RenderQueueItem *scratch;
+    u32 count;
+    u32 capacity;
+    u32 scratchCapacity;
+
+    // diffuse texture ids to dense material id bits, kept until RenderQueue_Shutdown()
+    struct RenderQueueTexture textures[RENDERQUEUE_TEXTURE_HASH_SIZE];
+    u32 textureCount;
+
+    RenderQueue_Stats stats;
+} renderQueue = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static void KeyState(u64 key, u32 *shader, u32 *material, u32 *mesh) {
+    if ((key >> KEY_LAYER_SHIFT) & 1) {
+        *shader = (u32) (key >> KEY_TRANSPARENT_SHADER_SHIFT) & 0xff;
+        *material = (u32) (key >> KEY_TRANSPARENT_MATERIAL_SHIFT) & 0xffff;
+        *mesh = (u32) (key >> KEY_TRANSPARENT_MESH_SHIFT) & 0xffff;
+    } else {
+        *shader = (u32) (key >> KEY_OPAQUE_SHADER_SHIFT) & 0xff;
+        *material = (u32) (key >> KEY_OPAQUE_MATERIAL_SHIFT) & 0xffff;
+        *mesh = (u32) (key >> KEY_OPAQUE_MESH_SHIFT) & 0xffff;
+    }
+}
+
+static u32 TextureIndex(u32 id) {
+    if (id == 0) return 0;
+
+    u32 hash = id * 2654435761u;
+    for (u32 probe = 0; probe < RENDERQUEUE_TEXTURE_HASH_SIZE; probe++) {
+        struct RenderQueueTexture *slot = &renderQueue.textures[(hash + probe) & (RENDERQUEUE_TEXTURE_HASH_SIZE - 1)];
+        if (slot->id == id) return slot->index;
+        if (slot->id != 0) continue;
+
+        // past the field's range textures share indices, like the ids used to
+        if (renderQueue.textureCount >= RENDERQUEUE_MAX_TEXTURES - 1) break;
+        *slot = (struct RenderQueueTexture) { .id = id, .index = ++renderQueue.textureCount };
+        return slot->index;
+    }
+    return id & (RENDERQUEUE_MAX_TEXTURES - 1);
+}
+
+static b8 Reserve(RenderQueueItem **items, u32 *capacity, u32 count) {
+    if (count <= *capacity) return true;
+
+    u32 grown = *capacity ? *capacity : RENDERQUEUE_INITIAL_CAPACITY;
+    while (grown < count) grown *= 2;
+    RenderQueueItem *resized = realloc(*items, grown * sizeof(RenderQueueItem));
+    if (resized == NULL) return false;
+
+    *items = resized;
+    *capacity = grown;
+    return true;
+}
+
+static void RadixSort(RenderQueueItem *items, RenderQueueItem *scratch, u32 count) {
+    if (count < 2) return;
+
+    // one sweep fills the histograms of every pass
+    u32 histograms[RENDERQUEUE_RADIX_PASSES][RENDERQUEUE_RADIX_BUCKETS];
+    memset(histograms, 0, sizeof(histograms));
+    for (u32 i = 0; i < count; i++) {
+        u64 key = items[i].key;
+        for (u32 pass = 0; pass < RENDERQUEUE_RADIX_PASSES; pass++) {
+            histograms[pass][(key >> (pass * RENDERQUEUE_RADIX_BITS)) & (RENDERQUEUE_RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    RenderQueueItem *source = items;
+    RenderQueueItem *destination = scratch;
+    for (u32 pass = 0; pass < RENDERQUEUE_RADIX_PASSES; pass++) {
+        u32 shift = pass * RENDERQUEUE_RADIX_BITS;
+        u32 *histogram = histograms[pass];
+
+        // a byte that's the same in every key wouldn't move anything
+        if (histogram[(source[0].key >> shift) & (RENDERQUEUE_RADIX_BUCKETS - 1)] == count) continue;
+
+        u32 offset = 0;
+        for (u32 bucket = 0; bucket < RENDERQUEUE_RADIX_BUCKETS; bucket++) {
+            u32 bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+        for (u32 i = 0; i < count; i++) {
+            destination[histogram[(source[i].key >> shift) & (RENDERQUEUE_RADIX_BUCKETS - 1)]++] = source[i];
+        }
+
+        RenderQueueItem *swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    if (source != items) memcpy(items, source, count * sizeof(RenderQueueItem));
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+u64 RenderQueue_Key(u32 pass, enum RenderQueue_Layer layer, u32 shader, u32 material, u32 mesh, f32 depth) {
+    const u64 depthMax = (1ull << RENDERQUEUE_DEPTH_BITS) - 1;
+    u64 quantized = (u64) (Clamp(depth, 0.0f, 1.0f) * (f32) depthMax + 0.5f);
+
+    u64 key = ((u64) (pass & (RENDERQUEUE_MAX_PASSES - 1)) << KEY_PASS_SHIFT) | ((u64) layer << KEY_LAYER_SHIFT);
+    if (layer == RenderQueue_Layer_Transparent) {
+        key |= (depthMax - quantized) << KEY_TRANSPARENT_DEPTH_SHIFT;
+        key |= (u64) (shader & 0xff) << KEY_TRANSPARENT_SHADER_SHIFT;
+        key |= (u64) (material & 0xffff) << KEY_TRANSPARENT_MATERIAL_SHIFT;
+        key |= (u64) (mesh & 0xffff) << KEY_TRANSPARENT_MESH_SHIFT;
+    } else {
+        key |= (u64) (shader & 0xff) << KEY_OPAQUE_SHADER_SHIFT;
+        key |= (u64) (material & 0xffff) << KEY_OPAQUE_MATERIAL_SHIFT;
+        key |= (u64) (mesh & 0xffff) << KEY_OPAQUE_MESH_SHIFT;
+        key |= quantized;
+    }
+    return key;
+}
+
+u32 RenderQueue_MaterialId(Material material) {
+    // diffuse texture up top, then a hash of the maps so draws of one material end up adjacent too
+    u32 texture = TextureIndex((material.maps != NULL) ? material.maps[MATERIAL_MAP_DIFFUSE].texture.id : 0);
+    u64 maps = (u64) (uintptr_t) material.maps;
+    u32 hash = (u32) ((maps ^ (maps >> 32)) * 2654435761u);
+    return (texture << RENDERQUEUE_MATERIAL_HASH_BITS) | (hash >> (32 - RENDERQUEUE_MATERIAL_HASH_BITS));
+}
+
+void RenderQueue_Init(void) {
+    if (renderQueue.initialized) return;
+
+    memset(&renderQueue, 0, sizeof(renderQueue));
+    for (u32 i = 0; i < RENDERQUEUE_MAX_LANES; i++) {
+        Arena_Init(&renderQueue.lanes[i].arena, RENDERQUEUE_LANE_ARENA_BLOCK);
+    }
+    renderQueue.initialized = true;
+}
+
+void RenderQueue_Shutdown(void) {
+    if (!renderQueue.initialized) return;
+
+    for (u32 i = 0; i < RENDERQUEUE_MAX_LANES; i++) {
+        Arena_Release(&renderQueue.lanes[i].arena);
+        free(renderQueue.lanes[i].items);
+    }
+    free(renderQueue.items);
+    free(renderQueue.scratch);
+    memset(&renderQueue, 0, sizeof(renderQueue));
+}
+
+void RenderQueue_Begin(void) {
+    for (u32 i = 0; i < RENDERQUEUE_MAX_LANES; i++) {
+        struct RenderQueueLane *lane = &renderQueue.lanes[i];
+        if (lane->count == 0) continue;
+        Arena_Reset(&lane->arena);
+        lane->count = 0;
+    }
+    renderQueue.count = 0;
+}
+
+void *RenderQueue_Push(u32 lane, u64 key, u64 payloadSize) {
+    if (!renderQueue.initialized || lane >= RENDERQUEUE_MAX_LANES) return NULL;
+
+    struct RenderQueueLane *target = &renderQueue.lanes[lane];
+    if (!Reserve(&target->items, &target->capacity, target->count + 1)) return NULL;
+
+    void *payload = Arena_PushNoZero(&target->arena, payloadSize);
+    if (payload == NULL) return NULL;
+
+    target->items[target->count++] = (RenderQueueItem) { .key = key, .payload = payload };
+    return payload;
+}
+
+void RenderQueue_Sort(void) {
+    f64 start = Timer_Seconds();
+
+    u32 count = 0;
+    for (u32 i = 0; i < RENDERQUEUE_MAX_LANES; i++) count += renderQueue.lanes[i].count;
+
+    if (!Reserve(&renderQueue.items, &renderQueue.capacity, count)
+        || !Reserve(&renderQueue.scratch, &renderQueue.scratchCapacity, count)) {
+        TraceLog(LOG_WARNING, "RENDERQUEUE: Out of memory sorting %u draws", count);
+        renderQueue.count = 0;
+        return;
+    }
+
+    renderQueue.count = 0;
+    for (u32 i = 0; i < RENDERQUEUE_MAX_LANES; i++) {
+        const struct RenderQueueLane *lane = &renderQueue.lanes[i];
+        if (lane->count == 0) continue;
+        memcpy(renderQueue.items + renderQueue.count, lane->items, lane->count * sizeof(RenderQueueItem));
+        renderQueue.count += lane->count;
+    }
+    RadixSort(renderQueue.items, renderQueue.scratch, renderQueue.count);
+
+    renderQueue.stats.sortSeconds = Timer_Seconds() - start;
+}
+
+void RenderQueue_Execute(RenderQueue_DrawFunc draw, void *user) {
+    RenderQueue_Stats *stats = &renderQueue.stats;
+    stats->draws = renderQueue.count;
+    stats->shaderChanges = stats->materialChanges = stats->meshChanges = 0;
+
+    u32 shader = 0, material = 0, mesh = 0;
+    for (u32 i = 0; i < renderQueue.count; i++) {
+        const RenderQueueItem *item = &renderQueue.items[i];
+
+        u32 nextShader, nextMaterial, nextMesh;
+        KeyState(item->key, &nextShader, &nextMaterial, &nextMesh);
+        if (i == 0 || nextShader != shader) stats->shaderChanges++;
+        if (i == 0 || nextMaterial != material) stats->materialChanges++;
+        if (i == 0 || nextMesh != mesh) stats->meshChanges++;
+        shader = nextShader;
+        material = nextMaterial;
+        mesh = nextMesh;
+
+        draw(item->key, item->payload, user);
+    }
+}
+
+RenderQueue_Stats RenderQueue_GetStats(void) {
+    return renderQueue.stats;
+}
@@ -0,0 +1,299 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+
+#include "quant.h"
+#include "resource.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum ResourceConstExpr {
+    RESOURCE_MAX_MESHES = 4096,
+    RESOURCE_MAX_TEXTURES = 1024,
+    RESOURCE_MESH_HASH_SIZE = RESOURCE_MAX_MESHES * 2,         // open addressing table sizes, must be powers of 2
+    RESOURCE_TEXTURE_HASH_SIZE = RESOURCE_MAX_TEXTURES * 2,
+};
+
+struct ResourceMesh {
+    u64 hash;
+    Mesh mesh;
+    u64 bytes;          // CPU side arrays
+    u64 vramBytes;      // buffers as uploaded, smaller than bytes for compact meshes
+    u32 refs;           // 0 once released, the slot stays in the table but never matches again
+};
+
+struct ResourceTexture {
+    u64 hash;
+    Texture2D texture;
+    void *pixels;       // copy of the source image's base level, matches are confirmed against it
+    u64 bytes;
+    u32 refs;
+};
+
+static struct Resource {
+    struct ResourceMesh meshes[RESOURCE_MAX_MESHES];
+    u32 meshCount;
+    u16 meshTable[RESOURCE_MESH_HASH_SIZE];         // index+1 into meshes, 0 means empty slot
+
+    struct ResourceTexture textures[RESOURCE_MAX_TEXTURES];
+    u32 textureCount;
+    u16 textureTable[RESOURCE_TEXTURE_HASH_SIZE];
+
+    Resource_Stats stats;
+} resource = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u64 Mix(u64 hash) {
+    // murmur3 finalizer
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static u64 HashBytes(u64 hash, const void *data, u64 size) {
+    const u8 *bytes = data;
+    u64 i = 0;
+    for (; i + 8 <= size; i += 8) {
+        u64 word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static u64 MeshBytes(const Mesh *mesh) {
+    u64 vertexCount = (u64) mesh->vertexCount;
+    u64 size = 0;
+    if (mesh->vertices)  size += vertexCount * 3 * sizeof(f32);
+    if (mesh->texcoords) size += vertexCount * 2 * sizeof(f32);
+    if (mesh->normals)   size += vertexCount * 3 * sizeof(f32);
+    if (mesh->colors)    size += vertexCount * 4;
+    if (mesh->indices)   size += (u64) mesh->triangleCount * 3 * sizeof(unsigned short);
+    return size;
+}
+
+static u64 VramBytes(Mesh mesh) {
+    Matrix decode;
+    return Quant_MeshBytes(&mesh, Quant_GetDecode(mesh, &decode));
+}
+
+static b8 ArraysEqual(const void *a, const void *b, u64 size) {
+    if (a == NULL || b == NULL) return a == b;
+    return memcmp(a, b, size) == 0;
+}
+
+static b8 MeshesEqual(const Mesh *a, const Mesh *b) {
+    if (a->vertexCount != b->vertexCount || a->triangleCount != b->triangleCount) return false;
+
+    u64 vertexCount = (u64) a->vertexCount;
+    return ArraysEqual(a->vertices, b->vertices, vertexCount * 3 * sizeof(f32))
+        && ArraysEqual(a->texcoords, b->texcoords, vertexCount * 2 * sizeof(f32))
+        && ArraysEqual(a->normals, b->normals, vertexCount * 3 * sizeof(f32))
+        && ArraysEqual(a->colors, b->colors, vertexCount * 4)
+        && ArraysEqual(a->indices, b->indices, (u64) a->triangleCount * 3 * sizeof(unsigned short));
+}
+
+static void FreeMeshArrays(Mesh *mesh) {
+    RL_FREE(mesh->vertices);
+    RL_FREE(mesh->texcoords);
+    RL_FREE(mesh->normals);
+    RL_FREE(mesh->colors);
+    RL_FREE(mesh->indices);
+    *mesh = (Mesh) {0};
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+u64 Resource_HashMesh(const Mesh *mesh) {
+    u64 vertexCount = (u64) mesh->vertexCount;
+    u64 counts[2] = { (u64) mesh->vertexCount, (u64) mesh->triangleCount };
+
+    // array sizes are implied by the counts, a missing array hashes differently from an empty one
+    u64 hash = HashBytes(0xcbf29ce484222325ull, counts, sizeof(counts));
+    hash = mesh->vertices  ? HashBytes(hash, mesh->vertices, vertexCount * 3 * sizeof(f32)) : Mix(hash ^ 1);
+    hash = mesh->texcoords ? HashBytes(hash, mesh->texcoords, vertexCount * 2 * sizeof(f32)) : Mix(hash ^ 2);
+    hash = mesh->normals   ? HashBytes(hash, mesh->normals, vertexCount * 3 * sizeof(f32)) : Mix(hash ^ 3);
+    hash = mesh->colors    ? HashBytes(hash, mesh->colors, vertexCount * 4) : Mix(hash ^ 4);
+    hash = mesh->indices   ? HashBytes(hash, mesh->indices, (u64) mesh->triangleCount * 3 * sizeof(unsigned short)) : Mix(hash ^ 5);
+    return Mix(hash);
+}
+
+u64 Resource_HashImage(Image image) {
+    if (image.data == NULL) return 0;
+
+    i32 header[4] = { image.width, image.height, image.format, image.mipmaps };
+    u64 hash = HashBytes(0xcbf29ce484222325ull, header, sizeof(header));
+    hash = HashBytes(hash, image.data, (u64) GetPixelDataSize(image.width, image.height, image.format));
+    return Mix(hash);
+}
+
+void Resource_AcquireMesh(Mesh *mesh, u64 hash) {
+    u64 bytes = MeshBytes(mesh);
+    u16 *freeSlot = NULL;
+
+    for (u32 probe = 0; probe < RESOURCE_MESH_HASH_SIZE; probe++) {
+        u16 *slot = &resource.meshTable[(hash + probe) & (RESOURCE_MESH_HASH_SIZE - 1)];
+        if (*slot == 0) {
+            freeSlot = slot;
+            break;
+        }
+
+        struct ResourceMesh *entry = &resource.meshes[*slot - 1];
+        if (entry->refs > 0 && entry->hash == hash && MeshesEqual(&entry->mesh, mesh)) {
+            FreeMeshArrays(mesh);
+            *mesh = entry->mesh;
+
+            entry->refs++;
+            resource.stats.meshRefs++;
+            resource.stats.vramSaved += entry->vramBytes;
+            resource.stats.ramSaved += bytes;
+            return;
+        }
+    }
+
+    Quant_UploadMesh(mesh);
+    u64 vramBytes = VramBytes(*mesh);
+    resource.stats.meshes++;
+    resource.stats.meshRefs++;
+    resource.stats.vramUsed += vramBytes;
+
+    if (freeSlot == NULL || resource.meshCount >= RESOURCE_MAX_MESHES) return;
+
+    resource.meshes[resource.meshCount] = (struct ResourceMesh) {
+            .hash = hash,
+            .mesh = *mesh,
+            .bytes = bytes,
+            .vramBytes = vramBytes,
+            .refs = 1
+    };
+    *freeSlot = (u16) ++resource.meshCount;
+}
+
+Texture2D Resource_AcquireTexture(Image image, u64 hash) {
+    u64 bytes = (u64) GetPixelDataSize(image.width, image.height, image.format);
+    u16 *freeSlot = NULL;
+
+    for (u32 probe = 0; probe < RESOURCE_TEXTURE_HASH_SIZE; probe++) {
+        u16 *slot = &resource.textureTable[(hash + probe) & (RESOURCE_TEXTURE_HASH_SIZE - 1)];
+        if (*slot == 0) {
+            freeSlot = slot;
+            break;
+        }
+
+        struct ResourceTexture *entry = &resource.textures[*slot - 1];
+        if (entry->refs > 0 && entry->hash == hash
+            && entry->texture.width == image.width && entry->texture.height == image.height
+            && entry->texture.format == image.format && entry->texture.mipmaps == image.mipmaps
+            && ArraysEqual(entry->pixels, image.data, bytes)) {
+            entry->refs++;
+            resource.stats.textureRefs++;
+            resource.stats.vramSaved += bytes;
+            return entry->texture;
+        }
+    }
+
+    Texture2D texture = LoadTextureFromImage(image);
+    if (texture.id == 0) return texture;
+
+    resource.stats.textures++;
+    resource.stats.textureRefs++;
+    resource.stats.vramUsed += bytes;
+
+    if (freeSlot == NULL || resource.textureCount >= RESOURCE_MAX_TEXTURES) return texture;
+
+    void *pixels = (image.data != NULL) ? RL_MALLOC(bytes) : NULL;
+    if (image.data != NULL && pixels == NULL) return texture;
+    if (pixels != NULL) memcpy(pixels, image.data, bytes);
+
+    resource.textures[resource.textureCount] = (struct ResourceTexture) {
+            .hash = hash,
+            .texture = texture,
+            .pixels = pixels,
+            .bytes = bytes,
+            .refs = 1
+    };
+    *freeSlot = (u16) ++resource.textureCount;
+    return texture;
+}
+
+void Resource_ReleaseMesh(Mesh mesh) {
+    if (mesh.vaoId == 0 && mesh.vboId == NULL) {
+        // never uploaded, just the CPU side
+        FreeMeshArrays(&mesh);
+        return;
+    }
+
+    // NOTE: releases only happen on unload, a linear search keeps the table free of tombstones
+    for (u32 i = 0; i < resource.meshCount; i++) {
+        struct ResourceMesh *entry = &resource.meshes[i];
+        if (entry->refs == 0 || entry->mesh.vboId != mesh.vboId) continue;
+
+        resource.stats.meshRefs--;
+        if (--entry->refs > 0) {
+            resource.stats.vramSaved -= entry->vramBytes;
+            resource.stats.ramSaved -= entry->bytes;
+            return;
+        }
+
+        Quant_UnloadMesh(entry->mesh);
+        entry->mesh = (Mesh) {0};
+        resource.stats.meshes--;
+        resource.stats.vramUsed -= entry->vramBytes;
+        return;
+    }
+
+    // untracked, uploaded while the cache was full
+    resource.stats.meshes--;
+    resource.stats.meshRefs--;
+    resource.stats.vramUsed -= VramBytes(mesh);
+    Quant_UnloadMesh(mesh);
+}
+
+void Resource_ReleaseTexture(Texture2D texture) {
+    if (texture.id == 0) return;
+
+    u64 bytes = (u64) GetPixelDataSize(texture.width, texture.height, texture.format);
+    for (u32 i = 0; i < resource.textureCount; i++) {
+        struct ResourceTexture *entry = &resource.textures[i];
+        if (entry->refs == 0 || entry->texture.id != texture.id) continue;
+
+        resource.stats.textureRefs--;
+        if (--entry->refs > 0) {
+            resource.stats.vramSaved -= bytes;
+            return;
+        }
+
+        UnloadTexture(entry->texture);
+        RL_FREE(entry->pixels);
+        entry->texture = (Texture2D) {0};
+        entry->pixels = NULL;
+        resource.stats.textures--;
+        resource.stats.vramUsed -= bytes;
+        return;
+    }
+
+    // untracked, uploaded while the cache was full
+    resource.stats.textures--;
+    resource.stats.textureRefs--;
+    resource.stats.vramUsed -= bytes;
+    UnloadTexture(texture);
+}
+
+Resource_Stats Resource_GetStats(void) {
+    return resource.stats;
+}
@@ -0,0 +1,457 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#define SHADERCACHE_INOTIFY
+#endif
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#include "shadercache.h"
+#include "timer.h"
+
+// raylib's GL loader, only found when raylib is built from source (see CMakeLists.txt)
+#if defined(FIDDLE_PROGRAM_BINARIES)
+#include "glad.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum ShaderCacheConstExpr {
+    SHADERCACHE_MAX_PROGRAMS = 16,
+    SHADERCACHE_MAX_WATCHES = 8,
+    SHADERCACHE_MAX_PATH = 256,
+    SHADERCACHE_MAX_BINARY_PATH = SHADERCACHE_MAX_PATH + 32,    // the cache directory, '/', 16 hex digits and ".bin"
+    SHADERCACHE_LOCATIONS = 32,         // RL_MAX_SHADER_LOCATIONS, what raylib allocates per shader
+    SHADERCACHE_VERSION = 1,
+};
+
+static const f64 SHADERCACHE_SETTLE_SECONDS = 0.1;  // editors save in more than one write
+#if !defined(SHADERCACHE_INOTIFY)
+static const f64 SHADERCACHE_POLL_SECONDS = 0.5;
+#endif
+
+#if defined(FIDDLE_PROGRAM_BINARIES)
+static const char SHADERCACHE_MAGIC[4] = { 'F', 'S', 'H', 'B' };
+
+struct ShaderCacheHeader {
+    char magic[4];
+    u32 version;
+    u64 key;
+    u32 format;                         // GLenum from glGetProgramBinary()
+    u32 size;                           // binary bytes after the header
+};
+#endif
+
+struct ShaderCacheProgram {
+    char vsFileName[SHADERCACHE_MAX_PATH];
+    char fsFileName[SHADERCACHE_MAX_PATH];
+    Shader shader;
+    ShaderCache_ReloadFunc onReload;
+    void *user;
+
+    long vsModTime;
+    long fsModTime;
+    b8 changed;
+    f64 changedAt;
+};
+
+struct ShaderCacheWatch {
+    char directory[SHADERCACHE_MAX_PATH];
+    int descriptor;
+};
+
+static struct ShaderCache {
+    b8 initialized;
+    char cacheDir[SHADERCACHE_MAX_PATH];        // empty doesn't cache
+    b8 binaries;
+    u64 driverHash;
+
+    struct ShaderCacheProgram programs[SHADERCACHE_MAX_PROGRAMS];     // handle - 1
+    u32 programCount;
+
+    struct ShaderCacheWatch watches[SHADERCACHE_MAX_WATCHES];
+    u32 watchCount;
+    int inotify;
+    f64 lastPoll;
+
+    ShaderCache_Stats stats;
+} shaderCache = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static b8 IsDefaultShader(Shader shader) {
+    return shader.id == 0 || shader.id == rlGetShaderIdDefault();
+}
+
+static Shader DefaultShader(void) {
+    return (Shader) { .id = rlGetShaderIdDefault(), .locs = rlGetShaderLocsDefault() };
+}
+
+static b8 MakeDirectory(const char *path) {
+    if (DirectoryExists(path)) return true;
+#if defined(_WIN32)
+    return _mkdir(path) == 0;
+#else
+    return mkdir(path, 0755) == 0;
+#endif
+}
+
+#if defined(FIDDLE_PROGRAM_BINARIES)
+// FNV-1a
+static u64 Hash(u64 hash, const void *data, u64 size) {
+    const u8 *bytes = data;
+    for (u64 i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static u64 HashString(u64 hash, const char *string) {
+    return (string != NULL) ? Hash(hash, string, strlen(string) + 1) : hash;
+}
+
+static void CachePath(char *buffer, u64 key) {
+    snprintf(buffer, SHADERCACHE_MAX_BINARY_PATH, "%s/%016llx.bin", shaderCache.cacheDir, (unsigned long long) key);
+}
+
+// the names LoadShaderFromMemory() looks up, a program linked from a binary needs the same ones
+static void ResolveDefaultLocations(Shader *shader) {
+    for (int i = 0; i < SHADERCACHE_LOCATIONS; i++) {
+        shader->locs[i] = -1;
+    }
+    shader->locs[SHADER_LOC_VERTEX_POSITION] = GetShaderLocationAttrib(*shader, "vertexPosition");
+    shader->locs[SHADER_LOC_VERTEX_TEXCOORD01] = GetShaderLocationAttrib(*shader, "vertexTexCoord");
+    shader->locs[SHADER_LOC_VERTEX_TEXCOORD02] = GetShaderLocationAttrib(*shader, "vertexTexCoord2");
+    shader->locs[SHADER_LOC_VERTEX_NORMAL] = GetShaderLocationAttrib(*shader, "vertexNormal");
+    shader->locs[SHADER_LOC_VERTEX_TANGENT] = GetShaderLocationAttrib(*shader, "vertexTangent");
+    shader->locs[SHADER_LOC_VERTEX_COLOR] = GetShaderLocationAttrib(*shader, "vertexColor");
+    shader->locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(*shader, "mvp");
+    shader->locs[SHADER_LOC_MATRIX_VIEW] = GetShaderLocation(*shader, "matView");
+    shader->locs[SHADER_LOC_MATRIX_PROJECTION] = GetShaderLocation(*shader, "matProjection");
+    shader->locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocation(*shader, "matModel");
+    shader->locs[SHADER_LOC_MATRIX_NORMAL] = GetShaderLocation(*shader, "matNormal");
+    shader->locs[SHADER_LOC_COLOR_DIFFUSE] = GetShaderLocation(*shader, "colDiffuse");
+    shader->locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(*shader, "texture0");
+    shader->locs[SHADER_LOC_MAP_SPECULAR] = GetShaderLocation(*shader, "texture1");
+    shader->locs[SHADER_LOC_MAP_NORMAL] = GetShaderLocation(*shader, "texture2");
+}
+
+static void DetectBinaries(void) {
+    int version = rlGetVersion();
+    if ((version != RL_OPENGL_33 && version != RL_OPENGL_43) || glad_glGetProgramBinary == NULL || glad_glProgramBinary == NULL) return;
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) return;
+
+    shaderCache.binaries = true;
+    shaderCache.driverHash = HashString(0xcbf29ce484222325ull, (const char *) glGetString(GL_VENDOR));
+    shaderCache.driverHash = HashString(shaderCache.driverHash, (const char *) glGetString(GL_RENDERER));
+    shaderCache.driverHash = HashString(shaderCache.driverHash, (const char *) glGetString(GL_VERSION));
+}
+
+// a binary the driver won't link any more (it changed without changing its strings) is just a miss
+static Shader LoadBinary(u64 key) {
+    char path[SHADERCACHE_MAX_BINARY_PATH];
+    CachePath(path, key);
+    if (!FileExists(path)) return (Shader) {0};
+
+    unsigned int size = 0;
+    unsigned char *data = LoadFileData(path, &size);
+    if (data == NULL) return (Shader) {0};
+
+    struct ShaderCacheHeader header;
+    b8 valid = size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, data, sizeof(header));
+        valid = memcmp(header.magic, SHADERCACHE_MAGIC, sizeof(header.magic)) == 0
+             && header.version == SHADERCACHE_VERSION && header.key == key && header.size == size - sizeof(header);
+    }
+
+    Shader shader = {0};
+    if (valid) {
+        GLuint program = glCreateProgram();
+        glProgramBinary(program, header.format, data + sizeof(header), (GLsizei) header.size);
+
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == GL_TRUE) {
+            shader.id = program;
+            shader.locs = MemAlloc(SHADERCACHE_LOCATIONS * sizeof(int));
+            ResolveDefaultLocations(&shader);
+        } else {
+            glDeleteProgram(program);
+            TraceLog(LOG_INFO, "SHADERCACHE: [%s] Driver rejected the cached binary, compiling", path);
+        }
+    }
+    UnloadFileData(data);
+    return shader;
+}
+
+static void SaveBinary(u64 key, Shader shader) {
+    GLint length = 0;
+    glGetProgramiv(shader.id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    u8 *data = malloc(sizeof(struct ShaderCacheHeader) + (u64) length);
+    if (data == NULL) return;
+
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(shader.id, length, &written, &format, data + sizeof(struct ShaderCacheHeader));
+
+    struct ShaderCacheHeader header = { .version = SHADERCACHE_VERSION, .key = key, .format = format, .size = (u32) written };
+    memcpy(header.magic, SHADERCACHE_MAGIC, sizeof(header.magic));
+    memcpy(data, &header, sizeof(header));
+
+    char path[SHADERCACHE_MAX_BINARY_PATH];
+    CachePath(path, key);
+    if (written > 0 && !SaveFileData(path, data, (unsigned int) (sizeof(header) + (u64) written))) {
+        TraceLog(LOG_WARNING, "SHADERCACHE: [%s] Couldn't save program binary", path);
+    }
+    free(data);
+}
+#endif
+
+// the default shader when either source is missing or doesn't compile
+static Shader BuildProgram(const struct ShaderCacheProgram *program) {
+    char *vsCode = LoadFileText(program->vsFileName);
+    char *fsCode = LoadFileText(program->fsFileName);
+    if (vsCode == NULL || fsCode == NULL) {
+        UnloadFileText(vsCode);
+        UnloadFileText(fsCode);
+        return DefaultShader();
+    }
+
+    Shader shader = {0};
+#if defined(FIDDLE_PROGRAM_BINARIES)
+    b8 caching = shaderCache.binaries && shaderCache.cacheDir[0] != '\0';
+    u64 key = HashString(HashString(shaderCache.driverHash, vsCode), fsCode);
+    if (caching) shader = LoadBinary(key);
+    if (shader.id != 0) {
+        shaderCache.stats.cached++;
+    }
+#endif
+
+    if (shader.id == 0) {
+        shader = LoadShaderFromMemory(vsCode, fsCode);
+        shaderCache.stats.compiled++;
+#if defined(FIDDLE_PROGRAM_BINARIES)
+        if (caching && !IsDefaultShader(shader)) SaveBinary(key, shader);
+#endif
+    }
+
+    UnloadFileText(vsCode);
+    UnloadFileText(fsCode);
+    return shader;
+}
+
+static void Watch(const char *fileName) {
+#if defined(SHADERCACHE_INOTIFY)
+    if (shaderCache.inotify < 0) return;
+
+    const char *directory = GetDirectoryPath(fileName);
+    for (u32 i = 0; i < shaderCache.watchCount; i++) {
+        if (strcmp(shaderCache.watches[i].directory, directory) == 0) return;
+    }
+    if (shaderCache.watchCount >= SHADERCACHE_MAX_WATCHES) {
+        TraceLog(LOG_WARNING, "SHADERCACHE: Watch limit (%i) reached, '%s' won't hot reload", SHADERCACHE_MAX_WATCHES, directory);
+        return;
+    }
+
+    // editors that save through a temporary file and a rename only show up as moves
+    int descriptor = inotify_add_watch(shaderCache.inotify, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (descriptor < 0) {
+        TraceLog(LOG_WARNING, "SHADERCACHE: Couldn't watch '%s'", directory);
+        return;
+    }
+
+    struct ShaderCacheWatch *watch = &shaderCache.watches[shaderCache.watchCount++];
+    watch->descriptor = descriptor;
+    strncpy(watch->directory, directory, SHADERCACHE_MAX_PATH - 1);
+#else
+    (void) fileName;
+#endif
+}
+
+static b8 IsSource(const char *fileName, const char *directory, const char *name) {
+    return strcmp(GetFileName(fileName), name) == 0 && strcmp(GetDirectoryPath(fileName), directory) == 0;
+}
+
+static void MarkChanged(const char *directory, const char *name) {
+    for (u32 i = 0; i < shaderCache.programCount; i++) {
+        struct ShaderCacheProgram *program = &shaderCache.programs[i];
+        if (IsSource(program->vsFileName, directory, name) || IsSource(program->fsFileName, directory, name)) {
+            program->changed = true;
+            program->changedAt = Timer_Seconds();
+        }
+    }
+}
+
+static void CollectChanges(void) {
+#if defined(SHADERCACHE_INOTIFY)
+    if (shaderCache.inotify < 0) return;
+
+    // non-blocking, empty most frames
+    _Alignas(struct inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(shaderCache.inotify, buffer, sizeof(buffer))) > 0) {
+        for (char *at = buffer; at < buffer + length;) {
+            const struct inotify_event *event = (const struct inotify_event *) at;
+            at += sizeof(struct inotify_event) + event->len;
+            if (event->len == 0) continue;
+
+            for (u32 i = 0; i < shaderCache.watchCount; i++) {
+                if (shaderCache.watches[i].descriptor == event->wd) MarkChanged(shaderCache.watches[i].directory, event->name);
+            }
+        }
+    }
+#else
+    f64 now = Timer_Seconds();
+    if (now - shaderCache.lastPoll < SHADERCACHE_POLL_SECONDS) return;
+    shaderCache.lastPoll = now;
+
+    for (u32 i = 0; i < shaderCache.programCount; i++) {
+        struct ShaderCacheProgram *program = &shaderCache.programs[i];
+        long vsModTime = GetFileModTime(program->vsFileName);
+        long fsModTime = GetFileModTime(program->fsFileName);
+        if (vsModTime != program->vsModTime || fsModTime != program->fsModTime) {
+            program->vsModTime = vsModTime;
+            program->fsModTime = fsModTime;
+            program->changed = true;
+            program->changedAt = now;
+        }
+    }
+#endif
+}
+
+static b8 Reload(struct ShaderCacheProgram *program) {
+    program->changed = false;
+
+    Shader shader = BuildProgram(program);
+    if (IsDefaultShader(shader)) {
+        shaderCache.stats.failedReloads++;
+        TraceLog(LOG_WARNING, "SHADERCACHE: [%s, %s] Didn't build, keeping the previous program",
+                 program->vsFileName, program->fsFileName);
+        return false;
+    }
+
+    Shader previous = program->shader;
+    program->shader = shader;
+    if (program->onReload != NULL) program->onReload(previous, shader, program->user);
+    UnloadShader(previous);
+
+    shaderCache.stats.reloads++;
+    TraceLog(LOG_INFO, "SHADERCACHE: [%s, %s] Reloaded", program->vsFileName, program->fsFileName);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void ShaderCache_Init(const char *cacheDir) {
+    memset(&shaderCache, 0, sizeof(shaderCache));
+    shaderCache.initialized = true;
+    shaderCache.inotify = -1;
+
+#if defined(FIDDLE_PROGRAM_BINARIES)
+    DetectBinaries();
+#endif
+    shaderCache.stats.binaries = shaderCache.binaries;
+
+    if (cacheDir != NULL && shaderCache.binaries) {
+        if (MakeDirectory(cacheDir)) {
+            strncpy(shaderCache.cacheDir, cacheDir, SHADERCACHE_MAX_PATH - 1);
+        } else {
+            TraceLog(LOG_WARNING, "SHADERCACHE: Couldn't create '%s', programs won't be cached", cacheDir);
+        }
+    }
+
+#if defined(SHADERCACHE_INOTIFY)
+    shaderCache.inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (shaderCache.inotify < 0) TraceLog(LOG_WARNING, "SHADERCACHE: No inotify, shaders won't hot reload");
+#endif
+}
+
+void ShaderCache_Shutdown(void) {
+    for (u32 i = 0; i < shaderCache.programCount; i++) {
+        UnloadShader(shaderCache.programs[i].shader);
+    }
+#if defined(SHADERCACHE_INOTIFY)
+    if (shaderCache.inotify >= 0) close(shaderCache.inotify);
+#endif
+    memset(&shaderCache, 0, sizeof(shaderCache));
+}
+
+ShaderCache_Handle ShaderCache_Load(const char *vsFileName, const char *fsFileName) {
+    if (!shaderCache.initialized) return 0;
+    if (shaderCache.programCount >= SHADERCACHE_MAX_PROGRAMS) {
+        TraceLog(LOG_WARNING, "SHADERCACHE: Program limit (%i) reached", SHADERCACHE_MAX_PROGRAMS);
+        return 0;
+    }
+
+    f64 start = Timer_Seconds();
+    struct ShaderCacheProgram *program = &shaderCache.programs[shaderCache.programCount];
+    *program = (struct ShaderCacheProgram) {
+            .vsModTime = GetFileModTime(vsFileName),
+            .fsModTime = GetFileModTime(fsFileName),
+    };
+    strncpy(program->vsFileName, vsFileName, SHADERCACHE_MAX_PATH - 1);
+    strncpy(program->fsFileName, fsFileName, SHADERCACHE_MAX_PATH - 1);
+
+    // a program that doesn't build starts out as the default shader and is still watched, fixing it swaps it in
+    program->shader = BuildProgram(program);
+    Watch(vsFileName);
+    Watch(fsFileName);
+
+    shaderCache.stats.programs++;
+    shaderCache.stats.loadSeconds += Timer_Seconds() - start;
+    return ++shaderCache.programCount;
+}
+
+Shader ShaderCache_Get(ShaderCache_Handle handle) {
+    return (handle > 0 && handle <= shaderCache.programCount) ? shaderCache.programs[handle - 1].shader : DefaultShader();
+}
+
+void ShaderCache_OnReload(ShaderCache_Handle handle, ShaderCache_ReloadFunc func, void *user) {
+    if (handle == 0 || handle > shaderCache.programCount) return;
+
+    shaderCache.programs[handle - 1].onReload = func;
+    shaderCache.programs[handle - 1].user = user;
+}
+
+u32 ShaderCache_Update(void) {
+    if (!shaderCache.initialized) return 0;
+
+    CollectChanges();
+
+    u32 swapped = 0;
+    f64 now = Timer_Seconds();
+    for (u32 i = 0; i < shaderCache.programCount; i++) {
+        struct ShaderCacheProgram *program = &shaderCache.programs[i];
+        if (program->changed && now - program->changedAt >= SHADERCACHE_SETTLE_SECONDS) {
+            swapped += Reload(program);
+        }
+    }
+    return swapped;
+}
+
+ShaderCache_Stats ShaderCache_GetStats(void) {
+    return shaderCache.stats;
+}
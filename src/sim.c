@@ -0,0 +1,215 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+
+#include "sim.h"
+#include "timer.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum SimConstExpr {
+    SIM_RECORDING_VERSION = 1,
+    SIM_RECORDING_INITIAL_CAPACITY = 1024,
+};
+
+// world units / degrees per second, and how far the camera is allowed to go
+#define SIM_CAMERA_ROTATION_SPEED   60.0f
+#define SIM_CAMERA_MAX_ROTATION     40.0f
+#define SIM_CAMERA_ZOOM_STEP        0.05f
+#define SIM_CAMERA_MIN_ZOOM         0.1f
+#define SIM_CAMERA_MAX_ZOOM         3.0f
+#define SIM_COIN_ROTATION_SPEED     300.0f
+
+// recording file header, followed by count Sim_Inputs, all in native byte order
+struct SimRecordingHeader {
+    char magic[4];
+    u32 version;
+    u32 count;
+    Sim_State start;
+};
+
+static const char SIM_RECORDING_MAGIC[4] = { 'F', 'S', 'I', 'M' };
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u64 HashBytes(u64 hash, const void *data, u64 size) {
+    const u8 *bytes = data;
+    for (u64 i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static f32 Clamp32(f32 value, f32 min, f32 max) {
+    return (value < min) ? min : (value > max) ? max : value;
+}
+
+static f32 Lerp32(f32 a, f32 b, f32 alpha) {
+    return a + (b - a) * alpha;
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+Sim_State Sim_InitState(Vector2 playerPos, Vector2 playerSpeed) {
+    return (Sim_State) {
+            .playerPos = playerPos,
+            .playerSpeed = playerSpeed,
+            .cameraRotation = 0,
+            .cameraZoom = 1,
+    };
+}
+
+void Sim_Step(Sim_State *state, Sim_Input input) {
+    const f32 dt = (f32) SIM_TICK_SECONDS;
+
+    if      (input.buttons & Sim_Button_Left)  state->playerPos.x -= state->playerSpeed.x * dt;
+    else if (input.buttons & Sim_Button_Right) state->playerPos.x += state->playerSpeed.x * dt;
+    if      (input.buttons & Sim_Button_Up)    state->playerPos.y -= state->playerSpeed.y * dt;
+    else if (input.buttons & Sim_Button_Down)  state->playerPos.y += state->playerSpeed.y * dt;
+
+    if      (input.buttons & Sim_Button_RotateCW)  state->cameraRotation += SIM_CAMERA_ROTATION_SPEED * dt;
+    else if (input.buttons & Sim_Button_RotateCCW) state->cameraRotation -= SIM_CAMERA_ROTATION_SPEED * dt;
+    state->cameraRotation = Clamp32(state->cameraRotation, -SIM_CAMERA_MAX_ROTATION, SIM_CAMERA_MAX_ROTATION);
+
+    state->cameraZoom = Clamp32(state->cameraZoom + input.zoom * SIM_CAMERA_ZOOM_STEP, SIM_CAMERA_MIN_ZOOM, SIM_CAMERA_MAX_ZOOM);
+
+    if (input.buttons & Sim_Button_ResetView) {
+        state->cameraRotation = 0;
+        state->cameraZoom = 1;
+    }
+
+    state->coinRotation += SIM_COIN_ROTATION_SPEED * dt;
+    if (state->coinRotation >= 360) state->coinRotation -= 360;
+
+    state->tick++;
+}
+
+Sim_State Sim_Interpolate(const Sim_State *previous, const Sim_State *current, f32 alpha) {
+    // the coin wraps at 360, blend the short way around
+    f32 coinDelta = current->coinRotation - previous->coinRotation;
+    if      (coinDelta < -180) coinDelta += 360;
+    else if (coinDelta >  180) coinDelta -= 360;
+
+    Sim_State state = *current;
+    state.playerPos.x = Lerp32(previous->playerPos.x, current->playerPos.x, alpha);
+    state.playerPos.y = Lerp32(previous->playerPos.y, current->playerPos.y, alpha);
+    state.cameraRotation = Lerp32(previous->cameraRotation, current->cameraRotation, alpha);
+    state.cameraZoom = Lerp32(previous->cameraZoom, current->cameraZoom, alpha);
+    state.coinRotation = fmodf(previous->coinRotation + coinDelta * alpha + 360, 360);
+    return state;
+}
+
+u64 Sim_Hash(const Sim_State *state) {
+    // field by field, struct padding is never looked at
+    u64 hash = 0xcbf29ce484222325ull;
+    hash = HashBytes(hash, &state->tick, sizeof(state->tick));
+    hash = HashBytes(hash, &state->playerPos, sizeof(state->playerPos));
+    hash = HashBytes(hash, &state->playerSpeed, sizeof(state->playerSpeed));
+    hash = HashBytes(hash, &state->cameraRotation, sizeof(state->cameraRotation));
+    hash = HashBytes(hash, &state->cameraZoom, sizeof(state->cameraZoom));
+    hash = HashBytes(hash, &state->coinRotation, sizeof(state->coinRotation));
+    return hash;
+}
+
+u32 Sim_ClockAdvance(Sim_Clock *clock, f64 frameSeconds) {
+    if (frameSeconds > 0) clock->accumulator += frameSeconds;
+
+    u32 ticks = (u32) (clock->accumulator / SIM_TICK_SECONDS);
+    if (ticks > SIM_MAX_TICKS_PER_FRAME) {
+        // fall behind real time rather than spend the next frame catching up
+        clock->accumulator = fmod(clock->accumulator, SIM_TICK_SECONDS) + SIM_MAX_TICKS_PER_FRAME * SIM_TICK_SECONDS;
+        ticks = SIM_MAX_TICKS_PER_FRAME;
+    }
+    clock->accumulator -= ticks * SIM_TICK_SECONDS;
+    if (clock->accumulator < 0) clock->accumulator = 0;
+    return ticks;
+}
+
+f32 Sim_ClockAlpha(const Sim_Clock *clock) {
+    return Clamp32((f32) (clock->accumulator / SIM_TICK_SECONDS), 0, 1);
+}
+
+void Sim_RecordingAppend(Sim_Recording *recording, Sim_Input input) {
+    if (recording->count == recording->capacity) {
+        u32 capacity = recording->capacity ? recording->capacity * 2 : SIM_RECORDING_INITIAL_CAPACITY;
+        Sim_Input *inputs = realloc(recording->inputs, sizeof(Sim_Input) * capacity);
+        if (inputs == NULL) {
+            TraceLog(LOG_WARNING, "SIM: Out of memory recording input, tick %u dropped", recording->count);
+            return;
+        }
+        recording->inputs = inputs;
+        recording->capacity = capacity;
+    }
+    recording->inputs[recording->count++] = input;
+}
+
+void Sim_RecordingFree(Sim_Recording *recording) {
+    free(recording->inputs);
+    memset(recording, 0, sizeof(*recording));
+}
+
+b8 Sim_RecordingSave(const Sim_Recording *recording, const char *fileName) {
+    u64 size = sizeof(struct SimRecordingHeader) + sizeof(Sim_Input) * (u64) recording->count;
+    u8 *data = malloc(size);
+    if (data == NULL) return false;
+
+    struct SimRecordingHeader header = { .version = SIM_RECORDING_VERSION, .count = recording->count, .start = recording->start };
+    memcpy(header.magic, SIM_RECORDING_MAGIC, sizeof(header.magic));
+    memcpy(data, &header, sizeof(header));
+    if (recording->count > 0) {
+        memcpy(data + sizeof(header), recording->inputs, sizeof(Sim_Input) * recording->count);
+    }
+
+    b8 saved = SaveFileData(fileName, data, (unsigned int) size);
+    free(data);
+    return saved;
+}
+
+b8 Sim_RecordingLoad(Sim_Recording *recording, const char *fileName) {
+    unsigned int size = 0;
+    unsigned char *data = LoadFileData(fileName, &size);
+    if (data == NULL) return false;
+
+    struct SimRecordingHeader header;
+    b8 valid = size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, data, sizeof(header));
+        valid = memcmp(header.magic, SIM_RECORDING_MAGIC, sizeof(header.magic)) == 0
+             && header.version == SIM_RECORDING_VERSION
+             && size - sizeof(header) == sizeof(Sim_Input) * (u64) header.count;
+    }
+    if (!valid) {
+        TraceLog(LOG_WARNING, "SIM: [%s] Not a version %i input recording", fileName, SIM_RECORDING_VERSION);
+        UnloadFileData(data);
+        return false;
+    }
+
+    Sim_RecordingFree(recording);
+    recording->start = header.start;
+    for (u32 i = 0; i < header.count; i++) {
+        Sim_Input input;
+        memcpy(&input, data + sizeof(header) + sizeof(Sim_Input) * i, sizeof(input));
+        Sim_RecordingAppend(recording, input);
+    }
+    UnloadFileData(data);
+    return true;
+}
+
+f64 Sim_FastForward(Sim_State *state, const Sim_Recording *recording, u64 ticks) {
+    const Sim_Input none = {0};
+
+    f64 start = Timer_Seconds();
+    for (u64 i = 0; i < ticks; i++) {
+        Sim_Step(state, recording->count > 0 ? recording->inputs[i % recording->count] : none);
+    }
+    f64 elapsed = Timer_Seconds() - start;
+    return elapsed > 0 ? (f64) ticks / elapsed : 0;
+}
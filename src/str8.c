@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "str8.h"
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u64 Mix(u64 hash) {
+    // murmur3 finalizer
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// 1 to 7 bytes without a variable sized copy, short ui keys almost always end up here
+static u64 ReadTail(const u8 *bytes, u64 size) {
+    if (size >= 4) {
+        u32 first, last;
+        memcpy(&first, bytes, sizeof(first));
+        memcpy(&last, bytes + size - 4, sizeof(last));
+        return ((u64) first << 32) | last;
+    }
+    return ((u64) bytes[0] << 16) | ((u64) bytes[size >> 1] << 8) | bytes[size - 1];
+}
+
+static u64 Min(u64 a, u64 b) {
+    return (a < b) ? a : b;
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+String8 Str8_Make(u8 *str, u64 size) {
+    return (String8) { str, size };
+}
+
+String8 Str8_FromCString(const char *cstring) {
+    return (String8) { (u8 *) cstring, cstring ? strlen(cstring) : 0 };
+}
+
+String8 Str8_Prefix(String8 string, u64 size) {
+    string.size = Min(size, string.size);
+    return string;
+}
+
+String8 Str8_Suffix(String8 string, u64 size) {
+    size = Min(size, string.size);
+    string.str += string.size - size;
+    string.size = size;
+    return string;
+}
+
+String8 Str8_Skip(String8 string, u64 amount) {
+    amount = Min(amount, string.size);
+    string.str += amount;
+    string.size -= amount;
+    return string;
+}
+
+String8 Str8_Chop(String8 string, u64 amount) {
+    string.size -= Min(amount, string.size);
+    return string;
+}
+
+String8 Str8_Substr(String8 string, u64 first, u64 onePastLast) {
+    onePastLast = Min(onePastLast, string.size);
+    first = Min(first, onePastLast);
+    return (String8) { string.str + first, onePastLast - first };
+}
+
+b8 Str8_Match(String8 a, String8 b) {
+    return a.size == b.size && (a.size == 0 || memcmp(a.str, b.str, a.size) == 0);
+}
+
+u64 Str8_FindFirst(String8 string, String8 needle, u64 start) {
+    if (needle.size == 0) return Min(start, string.size);
+    if (needle.size > string.size) return string.size;
+    start = Min(start, string.size);
+
+    // memchr for the first byte does most of the scanning
+    const u8 *last = string.str + string.size - needle.size;
+    for (const u8 *at = string.str + start; at <= last; at++) {
+        at = memchr(at, needle.str[0], (size_t) (last - at + 1));
+        if (at == NULL) break;
+        if (memcmp(at, needle.str, needle.size) == 0) return (u64) (at - string.str);
+    }
+    return string.size;
+}
+
+u64 Str8_Hash(String8 string, u64 seed) {
+    const u64 multiplier = 0x9E3779B97F4A7C15ull;
+    u64 hash = seed ^ (string.size * multiplier);
+
+    const u8 *bytes = string.str;
+    u64 remaining = string.size;
+    for (; remaining >= 8; bytes += 8, remaining -= 8) {
+        u64 word;
+        memcpy(&word, bytes, sizeof(word));
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 32;
+    }
+
+    // the length is already in the hash, so the overlapping tail reads can't collide with a longer string
+    if (remaining > 0) {
+        hash = (hash ^ ReadTail(bytes, remaining)) * multiplier;
+        hash ^= hash >> 32;
+    }
+    return Mix(hash);
+}
+
+String8 Str8_PushCopy(Arena *arena, String8 string) {
+    u8 *str = Arena_PushNoZero(arena, string.size + 1);
+    if (string.size > 0) memcpy(str, string.str, string.size);
+    str[string.size] = '\0';
+    return (String8) { str, string.size };
+}
+
+String8 Str8_PushF(Arena *arena, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    String8 result = Str8_PushFV(arena, format, args);
+    va_end(args);
+    return result;
+}
+
+String8 Str8_PushFV(Arena *arena, const char *format, va_list args) {
+    // most strings are short, try a stack buffer first so the common case formats once
+    char buffer[256];
+    va_list copy;
+    va_copy(copy, args);
+    int size = vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+    if (size < 0) return (String8) {0};
+
+    u8 *str = Arena_PushNoZero(arena, (u64) size + 1);
+    if ((u64) size < sizeof(buffer)) {
+        memcpy(str, buffer, (u64) size + 1);
+    } else {
+        vsnprintf((char *) str, (u64) size + 1, format, args);
+    }
+    return (String8) { str, (u64) size };
+}
@@ -0,0 +1,185 @@
+#include <stdlib.h>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI       // avoid clashing with raylib names if this file ever includes it
+    #define NOUSER
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+#endif
+
+#include "thread.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+struct ThreadStart {
+    Thread_Func func;
+    void *arg;
+};
+
+#if defined(_WIN32)
+_Static_assert(sizeof(SRWLOCK) <= sizeof(((Mutex *) 0)->storage), "Mutex storage too small");
+_Static_assert(sizeof(CONDITION_VARIABLE) <= sizeof(((CondVar *) 0)->storage), "CondVar storage too small");
+#define NATIVE_MUTEX(mutex) ((SRWLOCK *) (mutex)->storage)
+#define NATIVE_COND(cond)   ((CONDITION_VARIABLE *) (cond)->storage)
+#else
+_Static_assert(sizeof(pthread_mutex_t) <= sizeof(((Mutex *) 0)->storage), "Mutex storage too small");
+_Static_assert(sizeof(pthread_cond_t) <= sizeof(((CondVar *) 0)->storage), "CondVar storage too small");
+#define NATIVE_MUTEX(mutex) ((pthread_mutex_t *) (mutex)->storage)
+#define NATIVE_COND(cond)   ((pthread_cond_t *) (cond)->storage)
+#endif
+
+// ----------------------------------------------------------------------------
+// Threads
+// ----------------------------------------------------------------------------
+
+#if defined(_WIN32)
+static DWORD WINAPI ThreadEntry(LPVOID param) {
+    struct ThreadStart start = *(struct ThreadStart *) param;
+    free(param);
+    return (DWORD) start.func(start.arg);
+}
+#else
+static void *ThreadEntry(void *param) {
+    struct ThreadStart start = *(struct ThreadStart *) param;
+    free(param);
+    start.func(start.arg);
+    return NULL;
+}
+#endif
+
+b8 Thread_Create(Thread *thread, Thread_Func func, void *arg) {
+    struct ThreadStart *start = malloc(sizeof(struct ThreadStart));
+    if (start == NULL) return false;
+    *start = (struct ThreadStart) { func, arg };
+
+#if defined(_WIN32)
+    HANDLE handle = CreateThread(NULL, 0, ThreadEntry, start, 0, NULL);
+    if (handle == NULL) {
+        free(start);
+        return false;
+    }
+    thread->handle = handle;
+#else
+    pthread_t *handle = malloc(sizeof(pthread_t));
+    if (handle == NULL || pthread_create(handle, NULL, ThreadEntry, start) != 0) {
+        free(handle);
+        free(start);
+        return false;
+    }
+    thread->handle = handle;
+#endif
+    return true;
+}
+
+void Thread_Join(Thread *thread) {
+    if (thread->handle == NULL) return;
+#if defined(_WIN32)
+    WaitForSingleObject((HANDLE) thread->handle, INFINITE);
+    CloseHandle((HANDLE) thread->handle);
+#else
+    pthread_join(*(pthread_t *) thread->handle, NULL);
+    free(thread->handle);
+#endif
+    thread->handle = NULL;
+}
+
+void Thread_Yield(void) {
+#if defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+int Thread_HardwareConcurrency(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int) info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int) count : 1;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Mutex + condition variables
+// ----------------------------------------------------------------------------
+
+void Mutex_Init(Mutex *mutex) {
+#if defined(_WIN32)
+    InitializeSRWLock(NATIVE_MUTEX(mutex));
+#else
+    pthread_mutex_init(NATIVE_MUTEX(mutex), NULL);
+#endif
+}
+
+void Mutex_Destroy(Mutex *mutex) {
+#if !defined(_WIN32)
+    pthread_mutex_destroy(NATIVE_MUTEX(mutex));
+#else
+    (void) mutex;
+#endif
+}
+
+void Mutex_Lock(Mutex *mutex) {
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(NATIVE_MUTEX(mutex));
+#else
+    pthread_mutex_lock(NATIVE_MUTEX(mutex));
+#endif
+}
+
+void Mutex_Unlock(Mutex *mutex) {
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(NATIVE_MUTEX(mutex));
+#else
+    pthread_mutex_unlock(NATIVE_MUTEX(mutex));
+#endif
+}
+
+void CondVar_Init(CondVar *cond) {
+#if defined(_WIN32)
+    InitializeConditionVariable(NATIVE_COND(cond));
+#else
+    pthread_cond_init(NATIVE_COND(cond), NULL);
+#endif
+}
+
+void CondVar_Destroy(CondVar *cond) {
+#if !defined(_WIN32)
+    pthread_cond_destroy(NATIVE_COND(cond));
+#else
+    (void) cond;
+#endif
+}
+
+void CondVar_Wait(CondVar *cond, Mutex *mutex) {
+#if defined(_WIN32)
+    SleepConditionVariableSRW(NATIVE_COND(cond), NATIVE_MUTEX(mutex), INFINITE, 0);
+#else
+    pthread_cond_wait(NATIVE_COND(cond), NATIVE_MUTEX(mutex));
+#endif
+}
+
+void CondVar_Signal(CondVar *cond) {
+#if defined(_WIN32)
+    WakeConditionVariable(NATIVE_COND(cond));
+#else
+    pthread_cond_signal(NATIVE_COND(cond));
+#endif
+}
+
+void CondVar_Broadcast(CondVar *cond) {
+#if defined(_WIN32)
+    WakeAllConditionVariable(NATIVE_COND(cond));
+#else
+    pthread_cond_broadcast(NATIVE_COND(cond));
+#endif
+}
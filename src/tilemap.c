@@ -0,0 +1,383 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#include "job.h"
+#include "tilemap.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum TileMapConstExpr {
+    TILEMAP_INITIAL_QUADS = 16,
+};
+
+struct TileMapChunk {
+    TileMap_Quad *quads;
+    u32 quadCount;
+    u32 quadCapacity;
+    b8 dirty;
+};
+
+struct TileMap {
+    u32 width;
+    u32 height;
+    u32 chunksX;
+    u32 chunksY;
+    f32 tileSize;
+
+    u8 *tiles;                      // chunk major, TILEMAP_CHUNK_TILES per chunk, row major inside
+    struct TileMapChunk *chunks;
+
+    Color palette[256];
+    u32 paletteKeys[256];           // palette colors packed for fast compares while meshing
+
+    u32 version;                    // bumped by every edit
+
+    u32 *visible;                   // chunk indices from the last TileMap_PrepareView()
+    u32 visibleCount;
+    u32 *rebuild;                   // the dirty ones among them, rebuilt as jobs
+
+    TileMap_Stats stats;
+};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u32 PackColor(Color color) {
+    return (u32) color.r | ((u32) color.g << 8) | ((u32) color.b << 16) | ((u32) color.a << 24);
+}
+
+static u8 *ChunkTiles(const TileMap *map, u32 chunkX, u32 chunkY) {
+    return map->tiles + (u64) (chunkY * map->chunksX + chunkX) * TILEMAP_CHUNK_TILES;
+}
+
+static void PushQuad(struct TileMapChunk *chunk, TileMap_Quad quad) {
+    if (chunk->quadCount == chunk->quadCapacity) {
+        chunk->quadCapacity = chunk->quadCapacity ? chunk->quadCapacity * 2 : TILEMAP_INITIAL_QUADS;
+        chunk->quads = realloc(chunk->quads, chunk->quadCapacity * sizeof(TileMap_Quad));
+    }
+    chunk->quads[chunk->quadCount++] = quad;
+}
+
+// greedy meshing: grow each unclaimed tile into the widest run of its color, then down while whole rows match
+static void RebuildChunk(TileMap *map, u32 chunkX, u32 chunkY) {
+    struct TileMapChunk *chunk = &map->chunks[chunkY * map->chunksX + chunkX];
+    const u8 *tiles = ChunkTiles(map, chunkX, chunkY);
+
+    // partial chunks on the right / bottom edge of the map
+    u32 sizeX = map->width - chunkX * TILEMAP_CHUNK_SIZE;
+    u32 sizeY = map->height - chunkY * TILEMAP_CHUNK_SIZE;
+    if (sizeX > TILEMAP_CHUNK_SIZE) sizeX = TILEMAP_CHUNK_SIZE;
+    if (sizeY > TILEMAP_CHUNK_SIZE) sizeY = TILEMAP_CHUNK_SIZE;
+
+    u32 keys[TILEMAP_CHUNK_TILES];
+    for (u32 y = 0; y < sizeY; y++) {
+        for (u32 x = 0; x < sizeX; x++) {
+            keys[y * TILEMAP_CHUNK_SIZE + x] = map->paletteKeys[tiles[y * TILEMAP_CHUNK_SIZE + x]];
+        }
+    }
+
+    // one bit per claimed tile
+    u32 claimed[TILEMAP_CHUNK_SIZE] = {0};
+
+    chunk->quadCount = 0;
+    for (u32 y = 0; y < sizeY; y++) {
+        const u32 *row = keys + y * TILEMAP_CHUNK_SIZE;
+        for (u32 x = 0; x < sizeX;) {
+            if (claimed[y] & (1u << x)) {
+                x++;
+                continue;
+            }
+
+            u32 key = row[x];
+            u32 width = 1;
+            while (x + width < sizeX && !(claimed[y] & (1u << (x + width))) && row[x + width] == key) {
+                width++;
+            }
+
+            u32 span = (width == 32) ? 0xFFFFFFFFu : ((1u << width) - 1) << x;
+            u32 height = 1;
+            while (y + height < sizeY && !(claimed[y + height] & span)) {
+                const u32 *next = keys + (y + height) * TILEMAP_CHUNK_SIZE;
+                u32 i = 0;
+                while (i < width && next[x + i] == key) i++;
+                if (i < width) break;
+                height++;
+            }
+
+            for (u32 i = 0; i < height; i++) {
+                claimed[y + i] |= span;
+            }
+
+            u8 value = tiles[y * TILEMAP_CHUNK_SIZE + x];
+            PushQuad(chunk, (TileMap_Quad) {
+                    .x = (u8) x, .y = (u8) y,
+                    .width = (u8) width, .height = (u8) height,
+                    .color = map->palette[value]
+            });
+            x += width;
+        }
+    }
+    chunk->dirty = false;
+}
+
+static void RebuildChunks(void *arg, u32 first, u32 end) {
+    TileMap *map = arg;
+    for (u32 i = first; i < end; i++) {
+        u32 index = map->rebuild[i];
+        RebuildChunk(map, index % map->chunksX, index / map->chunksX);
+    }
+}
+
+static void MarkDirty(TileMap *map, u32 chunkX, u32 chunkY) {
+    map->chunks[chunkY * map->chunksX + chunkX].dirty = true;
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+TileMap *TileMap_Create(u32 width, u32 height, f32 tileSize) {
+    TileMap *map = calloc(1, sizeof(TileMap));
+    map->width = width;
+    map->height = height;
+    map->tileSize = tileSize;
+    map->chunksX = (width + TILEMAP_CHUNK_MASK) >> TILEMAP_CHUNK_SHIFT;
+    map->chunksY = (height + TILEMAP_CHUNK_MASK) >> TILEMAP_CHUNK_SHIFT;
+
+    u32 chunkCount = map->chunksX * map->chunksY;
+    map->tiles = calloc((u64) chunkCount * TILEMAP_CHUNK_TILES, 1);
+    map->chunks = calloc(chunkCount ? chunkCount : 1, sizeof(struct TileMapChunk));
+    map->visible = malloc((chunkCount ? chunkCount : 1) * sizeof(u32));
+    map->rebuild = malloc((chunkCount ? chunkCount : 1) * sizeof(u32));
+    for (u32 i = 0; i < chunkCount; i++) {
+        map->chunks[i].dirty = true;
+    }
+    for (int i = 0; i < 256; i++) {
+        map->palette[i] = MAGENTA;
+        map->paletteKeys[i] = PackColor(MAGENTA);
+    }
+
+    map->stats.chunks = chunkCount;
+    return map;
+}
+
+void TileMap_Unload(TileMap *map) {
+    if (map == NULL) return;
+
+    for (u32 i = 0; i < map->chunksX * map->chunksY; i++) {
+        free(map->chunks[i].quads);
+    }
+    free(map->visible);
+    free(map->rebuild);
+    free(map->chunks);
+    free(map->tiles);
+    free(map);
+}
+
+u32 TileMap_Width(const TileMap *map) {
+    return map->width;
+}
+
+u32 TileMap_Height(const TileMap *map) {
+    return map->height;
+}
+
+f32 TileMap_TileSize(const TileMap *map) {
+    return map->tileSize;
+}
+
+u8 TileMap_Get(const TileMap *map, i32 x, i32 y) {
+    if (x < 0 || y < 0 || (u32) x >= map->width || (u32) y >= map->height) return 0;
+
+    const u8 *tiles = ChunkTiles(map, (u32) x >> TILEMAP_CHUNK_SHIFT, (u32) y >> TILEMAP_CHUNK_SHIFT);
+    return tiles[((u32) y & TILEMAP_CHUNK_MASK) * TILEMAP_CHUNK_SIZE + ((u32) x & TILEMAP_CHUNK_MASK)];
+}
+
+void TileMap_Set(TileMap *map, i32 x, i32 y, u8 value) {
+    if (x < 0 || y < 0 || (u32) x >= map->width || (u32) y >= map->height) return;
+
+    u32 chunkX = (u32) x >> TILEMAP_CHUNK_SHIFT;
+    u32 chunkY = (u32) y >> TILEMAP_CHUNK_SHIFT;
+    u8 *tile = ChunkTiles(map, chunkX, chunkY) + ((u32) y & TILEMAP_CHUNK_MASK) * TILEMAP_CHUNK_SIZE + ((u32) x & TILEMAP_CHUNK_MASK);
+    if (*tile == value) return;
+
+    *tile = value;
+    MarkDirty(map, chunkX, chunkY);
+    map->version++;
+}
+
+void TileMap_Fill(TileMap *map, i32 x, i32 y, i32 width, i32 height, u8 value) {
+    // clip to the map
+    i32 x0 = (x > 0) ? x : 0;
+    i32 y0 = (y > 0) ? y : 0;
+    i64 x1 = (i64) x + width;
+    i64 y1 = (i64) y + height;
+    if (x1 > (i64) map->width) x1 = map->width;
+    if (y1 > (i64) map->height) y1 = map->height;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // one memset per chunk row segment
+    for (u32 ty = (u32) y0; ty < (u32) y1; ty++) {
+        u32 chunkY = ty >> TILEMAP_CHUNK_SHIFT;
+        for (u32 tx = (u32) x0; tx < (u32) x1;) {
+            u32 chunkX = tx >> TILEMAP_CHUNK_SHIFT;
+            u32 end = (chunkX + 1) << TILEMAP_CHUNK_SHIFT;
+            if (end > (u32) x1) end = (u32) x1;
+
+            u8 *row = ChunkTiles(map, chunkX, chunkY) + (ty & TILEMAP_CHUNK_MASK) * TILEMAP_CHUNK_SIZE;
+            memset(row + (tx & TILEMAP_CHUNK_MASK), value, end - tx);
+            MarkDirty(map, chunkX, chunkY);
+            tx = end;
+        }
+    }
+    map->version++;
+}
+
+u32 TileMap_Version(const TileMap *map) {
+    return map->version;
+}
+
+const u8 *TileMap_Tiles(const TileMap *map) {
+    return map->tiles;
+}
+
+void TileMap_SetColor(TileMap *map, u8 value, Color color) {
+    if (PackColor(color) == map->paletteKeys[value]) return;
+
+    map->palette[value] = color;
+    map->paletteKeys[value] = PackColor(color);
+    for (u32 i = 0; i < map->chunksX * map->chunksY; i++) {
+        map->chunks[i].dirty = true;
+    }
+    map->version++;
+}
+
+Color TileMap_GetColor(const TileMap *map, u8 value) {
+    return map->palette[value];
+}
+
+u32 TileMap_PrepareView(TileMap *map, Camera2D camera, Vector2 viewport) {
+    TileMap_Stats stats = { .chunks = map->chunksX * map->chunksY };
+    map->visibleCount = 0;
+
+    // world space bounds of the viewport, all four corners since the camera can rotate
+    Vector2 corners[4] = {
+            GetScreenToWorld2D((Vector2) { 0, 0 }, camera),
+            GetScreenToWorld2D((Vector2) { viewport.x, 0 }, camera),
+            GetScreenToWorld2D((Vector2) { 0, viewport.y }, camera),
+            GetScreenToWorld2D((Vector2) { viewport.x, viewport.y }, camera)
+    };
+    Vector2 min = corners[0], max = corners[0];
+    for (int i = 1; i < 4; i++) {
+        min.x = fminf(min.x, corners[i].x);
+        min.y = fminf(min.y, corners[i].y);
+        max.x = fmaxf(max.x, corners[i].x);
+        max.y = fmaxf(max.y, corners[i].y);
+    }
+
+    f32 chunkSize = map->tileSize * TILEMAP_CHUNK_SIZE;
+    if (max.x < 0 || max.y < 0 || min.x >= chunkSize * map->chunksX || min.y >= chunkSize * map->chunksY) {
+        map->stats = stats;
+        return 0;
+    }
+
+    u32 chunkX0 = (min.x > 0) ? (u32) (min.x / chunkSize) : 0;
+    u32 chunkY0 = (min.y > 0) ? (u32) (min.y / chunkSize) : 0;
+    u32 chunkX1 = (u32) (max.x / chunkSize);
+    u32 chunkY1 = (u32) (max.y / chunkSize);
+    if (chunkX1 >= map->chunksX) chunkX1 = map->chunksX - 1;
+    if (chunkY1 >= map->chunksY) chunkY1 = map->chunksY - 1;
+
+    for (u32 chunkY = chunkY0; chunkY <= chunkY1; chunkY++) {
+        for (u32 chunkX = chunkX0; chunkX <= chunkX1; chunkX++) {
+            u32 index = chunkY * map->chunksX + chunkX;
+            if (map->chunks[index].dirty) {
+                map->rebuild[stats.chunksRebuilt++] = index;
+            }
+            map->visible[map->visibleCount++] = index;
+        }
+    }
+
+    // chunks only touch their own tiles and quads, so they rebuild independently, a few per job
+    if (stats.chunksRebuilt > 0) {
+        Job_Counter counter = {0};
+        Job_ParallelFor(RebuildChunks, map, stats.chunksRebuilt, 4, &counter);
+        Job_Wait(&counter);
+    }
+
+    for (u32 chunkY = chunkY0; chunkY <= chunkY1; chunkY++) {
+        for (u32 chunkX = chunkX0; chunkX <= chunkX1; chunkX++) {
+            u32 index = chunkY * map->chunksX + chunkX;
+            u32 sizeX = map->width - chunkX * TILEMAP_CHUNK_SIZE;
+            u32 sizeY = map->height - chunkY * TILEMAP_CHUNK_SIZE;
+            stats.tilesVisible += ((sizeX < TILEMAP_CHUNK_SIZE) ? sizeX : TILEMAP_CHUNK_SIZE)
+                                * ((sizeY < TILEMAP_CHUNK_SIZE) ? sizeY : TILEMAP_CHUNK_SIZE);
+            stats.quadsVisible += map->chunks[index].quadCount;
+        }
+    }
+
+    stats.chunksVisible = map->visibleCount;
+    map->stats = stats;
+    return map->visibleCount;
+}
+
+void TileMap_Draw(const TileMap *map) {
+    f32 tileSize = map->tileSize;
+    f32 chunkSize = tileSize * TILEMAP_CHUNK_SIZE;
+
+    for (u32 i = 0; i < map->visibleCount; i++) {
+        u32 index = map->visible[i];
+        const struct TileMapChunk *chunk = &map->chunks[index];
+        if (chunk->quadCount == 0) continue;
+
+        f32 originX = (f32) (index % map->chunksX) * chunkSize;
+        f32 originY = (f32) (index / map->chunksX) * chunkSize;
+
+        // a whole chunk goes into rlgl's batch in one go, same vertex order as DrawRectangleRec()
+        rlCheckRenderBatchLimit((int) chunk->quadCount * 4);
+        rlBegin(RL_QUADS);
+        for (u32 q = 0; q < chunk->quadCount; q++) {
+            const TileMap_Quad *quad = &chunk->quads[q];
+            f32 x0 = originX + (f32) quad->x * tileSize;
+            f32 y0 = originY + (f32) quad->y * tileSize;
+            f32 x1 = x0 + (f32) quad->width * tileSize;
+            f32 y1 = y0 + (f32) quad->height * tileSize;
+
+            rlColor4ub(quad->color.r, quad->color.g, quad->color.b, quad->color.a);
+            rlVertex2f(x0, y0);
+            rlVertex2f(x0, y1);
+            rlVertex2f(x1, y1);
+            rlVertex2f(x1, y0);
+        }
+        rlEnd();
+    }
+}
+
+u32 TileMap_ChunkCount(const TileMap *map, u32 *chunksX, u32 *chunksY) {
+    if (chunksX) *chunksX = map->chunksX;
+    if (chunksY) *chunksY = map->chunksY;
+    return map->chunksX * map->chunksY;
+}
+
+const TileMap_Quad *TileMap_GetChunkQuads(TileMap *map, u32 chunkX, u32 chunkY, u32 *count) {
+    if (chunkX >= map->chunksX || chunkY >= map->chunksY) {
+        *count = 0;
+        return NULL;
+    }
+
+    struct TileMapChunk *chunk = &map->chunks[chunkY * map->chunksX + chunkX];
+    if (chunk->dirty) RebuildChunk(map, chunkX, chunkY);
+    *count = chunk->quadCount;
+    return chunk->quads;
+}
+
+TileMap_Stats TileMap_GetStats(const TileMap *map) {
+    return map->stats;
+}
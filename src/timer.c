@@ -0,0 +1,28 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 199309L // clock_gettime
+#endif
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+#include "timer.h"
+
+f64 Timer_Seconds(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency = {0};
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (f64) counter.QuadPart / (f64) frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64) ts.tv_sec + (f64) ts.tv_nsec * 1e-9;
+#endif
+}
@@ -0,0 +1,607 @@
+#include <string.h>
+
+#include "raylib.h"
+
+#include "ui.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum UIConstExpr {
+    UI_HASH_SLOTS = 8192,                   // widget cache buckets, must be a power of 2
+    UI_MAX_PARENT_DEPTH = 128,
+    UI_MAX_SIZE_STACK = 64,
+    UI_FRAME_ARENA_BLOCK = 256 * 1024,
+    UI_PERSISTENT_ARENA_BLOCK = 256 * 1024,
+};
+
+static const f32 UI_ANIMATION_RATE = 12.0f;
+
+struct UI_HashSlot {
+    UI_Widget *first;
+    UI_Widget *last;
+};
+
+static struct UI {
+    b8 initialized;
+
+    Arena persistent;       // widget pool, only grows
+    Arena frame;            // reset every frame
+    UI_Widget *freeList;    // evicted widgets, reused before the pool grows
+    struct UI_HashSlot slots[UI_HASH_SLOTS];
+
+    UI_MeasureTextFunc measureText;
+    f32 fontSize;
+
+    long frameIndex;
+    UI_Input input;
+    f32 dt;
+
+    UI_Widget *root;
+    UI_Widget *parents[UI_MAX_PARENT_DEPTH];
+    int parentCount;
+
+    UI_Size prefSize[Axis2_COUNT][UI_MAX_SIZE_STACK];
+    int prefSizeCount[Axis2_COUNT];
+
+    UI_Key hot;
+    UI_Key active;
+
+    u32 cachedTouched;      // cached widgets built this frame, nothing is stale when it matches the cache size
+    UI_Stats stats;
+} ui = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static f32 MeasureTextFixed(String8 text, f32 fontSize) {
+    return (f32) text.size * fontSize * 0.5f;
+}
+
+// splits a builder string into the part that's displayed and the part that's hashed, see the NOTES in ui.h
+static void SplitKeyString(String8 string, String8 *display, String8 *hashed) {
+    u64 marker = Str8_FindFirst(string, Str8Lit("##"), 0);
+    *display = Str8_Prefix(string, marker);
+    *hashed = string;
+    if (marker + 2 < string.size && string.str[marker + 2] == '#') {
+        *hashed = Str8_Skip(string, marker + 3);
+    }
+}
+
+static struct UI_HashSlot *SlotFromKey(UI_Key key) {
+    return &ui.slots[key.u64[0] & (UI_HASH_SLOTS - 1)];
+}
+
+static void SlotRemove(struct UI_HashSlot *slot, UI_Widget *widget) {
+    if (widget->hash_prev) widget->hash_prev->hash_next = widget->hash_next;
+    else                   slot->first = widget->hash_next;
+    if (widget->hash_next) widget->hash_next->hash_prev = widget->hash_prev;
+    else                   slot->last = widget->hash_prev;
+    widget->hash_next = widget->hash_prev = NULL;
+}
+
+static void SlotAppend(struct UI_HashSlot *slot, UI_Widget *widget) {
+    widget->hash_prev = slot->last;
+    widget->hash_next = NULL;
+    if (slot->last) slot->last->hash_next = widget;
+    else            slot->first = widget;
+    slot->last = widget;
+}
+
+static UI_Widget *AllocWidget(void) {
+    UI_Widget *widget = ui.freeList;
+    if (widget != NULL) {
+        ui.freeList = widget->hash_next;
+    } else {
+        widget = Arena_PushStruct(&ui.persistent, UI_Widget);
+    }
+    memset(widget, 0, sizeof(*widget));
+    return widget;
+}
+
+static UI_Widget *TopParent(void) {
+    return (ui.parentCount > 0) ? ui.parents[ui.parentCount - 1] : NULL;
+}
+
+static UI_Size TopPrefSize(enum Axis2 axis) {
+    return ui.prefSize[axis][ui.prefSizeCount[axis] - 1];
+}
+
+static void EvictStaleWidgets(void) {
+    ui.stats.evicted = 0;
+    if (ui.cachedTouched == ui.stats.cached) return;
+
+    for (int i = 0; i < UI_HASH_SLOTS; i++) {
+        struct UI_HashSlot *slot = &ui.slots[i];
+        UI_Widget *widget = slot->first;
+        while (widget != NULL) {
+            UI_Widget *next = widget->hash_next;
+            if (widget->last_frame_touched_index < ui.frameIndex - 1) {
+                if (UI_KeyMatch(widget->key, ui.active)) ui.active = UI_KeyNull();
+
+                SlotRemove(slot, widget);
+                widget->hash_next = ui.freeList;
+                ui.freeList = widget;
+                ui.stats.cached--;
+                ui.stats.evicted++;
+            }
+            widget = next;
+        }
+    }
+}
+
+// iterative tree walks, the tree can be far deeper than is comfortable to recurse
+static UI_Widget *NextPreOrder(UI_Widget *widget, UI_Widget *root) {
+    if (widget->first) return widget->first;
+    for (; widget != NULL && widget != root; widget = widget->parent) {
+        if (widget->next) return widget->next;
+    }
+    return NULL;
+}
+
+static UI_Widget *FirstPostOrder(UI_Widget *widget) {
+    while (widget->first) widget = widget->first;
+    return widget;
+}
+
+static UI_Widget *NextPostOrder(UI_Widget *widget, UI_Widget *root) {
+    if (widget == root) return NULL;
+    if (widget->next) return FirstPostOrder(widget->next);
+    return widget->parent;
+}
+
+static b8 OverflowsOnAxis(const UI_Widget *widget, enum Axis2 axis) {
+    return (widget->flags & (axis == Axis2_X ? UI_WidgetFlag_OverflowX : UI_WidgetFlag_OverflowY)) != 0;
+}
+
+// ----------------------------------------------------------------------------
+// Autolayout passes
+// ----------------------------------------------------------------------------
+
+static void LayoutStandalone(UI_Widget *root) {
+    for (UI_Widget *widget = root; widget != NULL; widget = NextPreOrder(widget, root)) {
+        for (int axis = 0; axis < Axis2_COUNT; axis++) {
+            UI_Size size = widget->semantic_size[axis];
+            switch (size.kind) {
+                case UI_SizeKind_Pixels: {
+                    widget->computed_size[axis] = size.value;
+                } break;
+                case UI_SizeKind_TextContent: {
+                    f32 content = (axis == Axis2_X) ? ui.measureText(widget->string, ui.fontSize) : ui.fontSize;
+                    widget->computed_size[axis] = content + 2.0f * size.value;
+                } break;
+                case UI_SizeKind_Null: {
+                    widget->computed_size[axis] = 0;
+                } break;
+                default: break;
+            }
+        }
+    }
+}
+
+static void LayoutUpwardsDependent(UI_Widget *root) {
+    for (UI_Widget *widget = root; widget != NULL; widget = NextPreOrder(widget, root)) {
+        for (int axis = 0; axis < Axis2_COUNT; axis++) {
+            UI_Size size = widget->semantic_size[axis];
+            if (size.kind != UI_SizeKind_PercentOfParent) continue;
+
+            // skip ancestors that are themselves sized by their children, they aren't known yet
+            UI_Widget *ancestor = widget->parent;
+            while (ancestor != NULL && ancestor->semantic_size[axis].kind == UI_SizeKind_ChildrenSum) {
+                ancestor = ancestor->parent;
+            }
+            widget->computed_size[axis] = ancestor ? ancestor->computed_size[axis] * size.value : 0;
+        }
+    }
+}
+
+static void LayoutDownwardsDependent(UI_Widget *root) {
+    for (UI_Widget *widget = FirstPostOrder(root); widget != NULL; widget = NextPostOrder(widget, root)) {
+        for (int axis = 0; axis < Axis2_COUNT; axis++) {
+            if (widget->semantic_size[axis].kind != UI_SizeKind_ChildrenSum) continue;
+
+            f32 size = 0;
+            b8 along = (widget->child_layout_axis == (enum Axis2) axis);
+            for (UI_Widget *child = widget->first; child != NULL; child = child->next) {
+                f32 childSize = child->computed_size[axis];
+                if (along) size += childSize;
+                else if (childSize > size) size = childSize;
+            }
+            widget->computed_size[axis] = size;
+        }
+    }
+}
+
+static void SolveViolationsOnAxis(UI_Widget *widget, enum Axis2 axis) {
+    f32 allowed = widget->computed_size[axis];
+
+    // this widget may have been shrunk by its own parent, re-derive children sized relative to it
+    if (widget->semantic_size[axis].kind != UI_SizeKind_ChildrenSum) {
+        for (UI_Widget *child = widget->first; child != NULL; child = child->next) {
+            if (child->semantic_size[axis].kind == UI_SizeKind_PercentOfParent) {
+                child->computed_size[axis] = allowed * child->semantic_size[axis].value;
+            }
+        }
+    }
+
+    if (OverflowsOnAxis(widget, axis)) return;
+
+    if (widget->child_layout_axis == axis) {
+        // children are laid out one after another, shrink each in proportion to what it can give up
+        f32 total = 0;
+        f32 budget = 0;
+        for (UI_Widget *child = widget->first; child != NULL; child = child->next) {
+            total += child->computed_size[axis];
+            budget += child->computed_size[axis] * (1.0f - child->semantic_size[axis].strictness);
+        }
+
+        f32 violation = total - allowed;
+        if (violation > 0 && budget > 0) {
+            f32 fraction = (violation < budget) ? violation / budget : 1.0f;
+            for (UI_Widget *child = widget->first; child != NULL; child = child->next) {
+                f32 give = child->computed_size[axis] * (1.0f - child->semantic_size[axis].strictness);
+                child->computed_size[axis] -= give * fraction;
+            }
+        }
+    } else {
+        // children overlap on this axis, each one just has to fit on its own
+        for (UI_Widget *child = widget->first; child != NULL; child = child->next) {
+            f32 violation = child->computed_size[axis] - allowed;
+            if (violation <= 0) continue;
+
+            f32 give = child->computed_size[axis] * (1.0f - child->semantic_size[axis].strictness);
+            child->computed_size[axis] -= (violation < give) ? violation : give;
+        }
+    }
+}
+
+static void LayoutSolveViolations(UI_Widget *root) {
+    for (UI_Widget *widget = root; widget != NULL; widget = NextPreOrder(widget, root)) {
+        if (widget->first == NULL) continue;
+        SolveViolationsOnAxis(widget, Axis2_X);
+        SolveViolationsOnAxis(widget, Axis2_Y);
+    }
+}
+
+// final rects, hot/active transitions are stepped in the same walk
+static void LayoutPositionsAndAnimate(UI_Widget *root) {
+    f32 rate = ui.dt * UI_ANIMATION_RATE;
+    if (rate > 1.0f) rate = 1.0f;
+
+    for (UI_Widget *widget = root; widget != NULL; widget = NextPreOrder(widget, root)) {
+        Vector2 origin = widget->parent ? (Vector2) { widget->parent->rect.x, widget->parent->rect.y } : (Vector2) {0};
+        widget->rect = (Rectangle) {
+                .x = origin.x + widget->computed_rel_position[Axis2_X],
+                .y = origin.y + widget->computed_rel_position[Axis2_Y],
+                .width = widget->computed_size[Axis2_X],
+                .height = widget->computed_size[Axis2_Y]
+        };
+
+        // relative positions of the children, used when the walk reaches them
+        enum Axis2 along = widget->child_layout_axis;
+        enum Axis2 across = (along == Axis2_X) ? Axis2_Y : Axis2_X;
+        f32 cursor = 0;
+        for (UI_Widget *child = widget->first; child != NULL; child = child->next) {
+            child->computed_rel_position[along] = cursor;
+            child->computed_rel_position[across] = 0;
+            cursor += child->computed_size[along];
+        }
+
+        if (widget->flags & (UI_WidgetFlag_HotAnimation | UI_WidgetFlag_ActiveAnimation)) {
+            f32 hot = UI_KeyMatch(widget->key, ui.hot) ? 1.0f : 0.0f;
+            f32 active = UI_KeyMatch(widget->key, ui.active) ? 1.0f : 0.0f;
+            widget->hot += (hot - widget->hot) * rate;
+            widget->active += (active - widget->active) * rate;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Drawing
+// ----------------------------------------------------------------------------
+
+static Color LerpColor(Color a, Color b, f32 t) {
+    return (Color) {
+            .r = (u8) ((f32) a.r + ((f32) b.r - (f32) a.r) * t),
+            .g = (u8) ((f32) a.g + ((f32) b.g - (f32) a.g) * t),
+            .b = (u8) ((f32) a.b + ((f32) b.b - (f32) a.b) * t),
+            .a = (u8) ((f32) a.a + ((f32) b.a - (f32) a.a) * t),
+    };
+}
+
+static void DrawWidget(UI_Widget *widget) {
+    const Color background = { 40, 40, 40, 230 };
+    const Color hot = { 70, 70, 70, 240 };
+    const Color active = { 100, 100, 100, 255 };
+    const Color border = { 110, 110, 110, 255 };
+
+    if (widget->flags & UI_WidgetFlag_DrawDropShadow) {
+        Rectangle shadow = { widget->rect.x + 3, widget->rect.y + 3, widget->rect.width, widget->rect.height };
+        DrawRectangleRec(shadow, Fade(BLACK, 0.4f));
+    }
+
+    if (widget->flags & UI_WidgetFlag_DrawBackground) {
+        Color color = background;
+        if (widget->flags & UI_WidgetFlag_HotAnimation) color = LerpColor(color, hot, widget->hot);
+        if (widget->flags & UI_WidgetFlag_ActiveAnimation) color = LerpColor(color, active, widget->active);
+        DrawRectangleRec(widget->rect, color);
+    }
+
+    if (widget->flags & UI_WidgetFlag_DrawBorder) {
+        DrawRectangleLinesEx(widget->rect, 1, border);
+    }
+
+    if ((widget->flags & UI_WidgetFlag_DrawText) && widget->string.size > 0) {
+        // NOTE: display strings are null terminated in the frame arena, see UI_WidgetMake()
+        f32 textWidth = ui.measureText(widget->string, ui.fontSize);
+        int x = (int) (widget->rect.x + (widget->rect.width - textWidth) * 0.5f);
+        int y = (int) (widget->rect.y + (widget->rect.height - ui.fontSize) * 0.5f);
+        DrawText((const char *) widget->string.str, x, y, (int) ui.fontSize, RAYWHITE);
+    }
+
+    if (widget->flags & UI_WidgetFlag_Clip) {
+        BeginScissorMode((int) widget->rect.x, (int) widget->rect.y, (int) widget->rect.width, (int) widget->rect.height);
+    }
+
+    for (UI_Widget *child = widget->first; child != NULL; child = child->next) {
+        DrawWidget(child);
+    }
+
+    // NOTE: raylib doesn't stack scissor rects, nested clipping widgets end all clipping
+    if (widget->flags & UI_WidgetFlag_Clip) {
+        EndScissorMode();
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void UI_Init(UI_MeasureTextFunc measureText, f32 fontSize) {
+    memset(&ui, 0, sizeof(ui));
+    Arena_Init(&ui.persistent, UI_PERSISTENT_ARENA_BLOCK);
+    Arena_Init(&ui.frame, UI_FRAME_ARENA_BLOCK);
+    ui.measureText = measureText ? measureText : MeasureTextFixed;
+    ui.fontSize = fontSize;
+    ui.initialized = true;
+}
+
+void UI_Shutdown(void) {
+    Arena_Release(&ui.persistent);
+    Arena_Release(&ui.frame);
+    memset(&ui, 0, sizeof(ui));
+}
+
+void UI_BeginFrame(Vector2 rootSize, UI_Input input, f32 dt) {
+    ui.frameIndex++;
+    ui.input = input;
+    ui.dt = dt;
+
+    Arena_Reset(&ui.frame);
+    EvictStaleWidgets();
+    ui.cachedTouched = 0;
+
+    ui.stats.widgets = 0;
+    ui.stats.created = 0;
+    ui.hot = UI_KeyNull();
+    ui.parentCount = 0;
+
+    // default sizing fits the text on both axes
+    ui.prefSize[Axis2_X][0] = UI_SizeText(8, 1);
+    ui.prefSize[Axis2_Y][0] = UI_SizeText(4, 1);
+    ui.prefSizeCount[Axis2_X] = 1;
+    ui.prefSizeCount[Axis2_Y] = 1;
+
+    UI_PushPrefSize(Axis2_X, UI_SizePx(rootSize.x, 1));
+    UI_PushPrefSize(Axis2_Y, UI_SizePx(rootSize.y, 1));
+    ui.root = UI_WidgetMake(0, Str8Lit("###ui_root"));
+    UI_WidgetEquipChildLayoutAxis(ui.root, Axis2_Y);
+    UI_PopPrefSize(Axis2_X);
+    UI_PopPrefSize(Axis2_Y);
+
+    UI_PushParent(ui.root);
+}
+
+void UI_EndFrame(void) {
+    ui.parentCount = 0;
+    if (ui.root == NULL) return;
+
+    // NOTE: every pass handles both axes while it visits a widget, the axes are still independent
+    LayoutStandalone(ui.root);
+    LayoutUpwardsDependent(ui.root);
+    LayoutDownwardsDependent(ui.root);
+    LayoutSolveViolations(ui.root);
+    LayoutPositionsAndAnimate(ui.root);
+
+    u64 used = Arena_Used(&ui.frame);
+    if (used > ui.stats.frameArenaBytes) ui.stats.frameArenaBytes = used;
+}
+
+void UI_Draw(void) {
+    if (ui.root != NULL) DrawWidget(ui.root);
+}
+
+UI_Widget *UI_Root(void) {
+    return ui.root;
+}
+
+UI_Stats UI_GetStats(void) {
+    return ui.stats;
+}
+
+Arena *UI_FrameArena(void) {
+    return &ui.frame;
+}
+
+void UI_PushPrefSize(enum Axis2 axis, UI_Size size) {
+    if (ui.prefSizeCount[axis] < UI_MAX_SIZE_STACK) {
+        ui.prefSize[axis][ui.prefSizeCount[axis]++] = size;
+    }
+}
+
+void UI_PopPrefSize(enum Axis2 axis) {
+    // the default at the bottom of the stack is never popped
+    if (ui.prefSizeCount[axis] > 1) ui.prefSizeCount[axis]--;
+}
+
+UI_Size UI_SizePx(f32 pixels, f32 strictness) {
+    return (UI_Size) { UI_SizeKind_Pixels, pixels, strictness };
+}
+
+UI_Size UI_SizeText(f32 padding, f32 strictness) {
+    return (UI_Size) { UI_SizeKind_TextContent, padding, strictness };
+}
+
+UI_Size UI_SizePct(f32 percent, f32 strictness) {
+    return (UI_Size) { UI_SizeKind_PercentOfParent, percent, strictness };
+}
+
+UI_Size UI_SizeChildrenSum(f32 strictness) {
+    return (UI_Size) { UI_SizeKind_ChildrenSum, 0, strictness };
+}
+
+UI_Key UI_KeyNull(void) {
+    return (UI_Key) {0};
+}
+
+UI_Key UI_KeyFromString(String8 string) {
+    return UI_KeyFromStringSeeded(UI_KeyNull(), string);
+}
+
+UI_Key UI_KeyFromStringSeeded(UI_Key seed, String8 string) {
+    UI_Key key = {0};
+    if (string.size == 0) return key;
+
+    // seeded so identical strings under different parents get different keys
+    u64 hash = Str8_Hash(string, seed.u64[0]);
+    key.u64[0] = hash ? hash : 1;   // 0 is reserved for the null key
+    return key;
+}
+
+b8 UI_KeyMatch(UI_Key a, UI_Key b) {
+    return a.u64[0] == b.u64[0];
+}
+
+UI_Widget *UI_WidgetMake(UI_WidgetFlags flags, String8 string) {
+    UI_Widget *parent = TopParent();
+    String8 display, hashed;
+    SplitKeyString(string, &display, &hashed);
+    UI_Key key = UI_KeyFromStringSeeded(parent ? parent->key : UI_KeyNull(), hashed);
+
+    UI_Widget *widget = NULL;
+    if (!UI_KeyMatch(key, UI_KeyNull())) {
+        struct UI_HashSlot *slot = SlotFromKey(key);
+        for (UI_Widget *candidate = slot->first; candidate != NULL; candidate = candidate->hash_next) {
+            if (UI_KeyMatch(candidate->key, key)) {
+                widget = candidate;
+                break;
+            }
+        }
+
+        if (widget != NULL && widget->last_frame_touched_index == ui.frameIndex) {
+            // same key built twice in one frame, keep the first and treat this one as keyless
+            TraceLog(LOG_WARNING, "UI: Duplicate widget key, use '##' to disambiguate");
+            widget = NULL;
+            key = UI_KeyNull();
+        } else if (widget == NULL) {
+            widget = AllocWidget();
+            widget->key = key;
+            SlotAppend(slot, widget);
+            ui.stats.cached++;
+            ui.stats.created++;
+        }
+        if (widget != NULL) ui.cachedTouched++;
+    }
+
+    if (widget == NULL) {
+        widget = Arena_PushStruct(&ui.frame, UI_Widget);
+    }
+
+    // per-frame state, persistent state (rect, hot, active) carries over for cached widgets
+    widget->first = widget->last = widget->next = widget->prev = widget->parent = NULL;
+    widget->last_frame_touched_index = ui.frameIndex;
+    widget->flags = flags;
+    widget->semantic_size[Axis2_X] = TopPrefSize(Axis2_X);
+    widget->semantic_size[Axis2_Y] = TopPrefSize(Axis2_Y);
+    widget->child_layout_axis = Axis2_X;
+
+    // copy the display string, builders are free to format into temporary buffers
+    widget->string = Str8_PushCopy(&ui.frame, display);
+
+    if (parent != NULL) {
+        widget->parent = parent;
+        widget->prev = parent->last;
+        if (parent->last) parent->last->next = widget;
+        else              parent->first = widget;
+        parent->last = widget;
+    }
+
+    ui.stats.widgets++;
+    return widget;
+}
+
+UI_Widget *UI_WidgetEquipChildLayoutAxis(UI_Widget *widget, enum Axis2 axis) {
+    widget->child_layout_axis = axis;
+    return widget;
+}
+
+UI_Widget *UI_PushParent(UI_Widget *widget) {
+    if (ui.parentCount < UI_MAX_PARENT_DEPTH) {
+        ui.parents[ui.parentCount++] = widget;
+    }
+    return widget;
+}
+
+UI_Widget *UI_PopParent(void) {
+    // the root stays at the bottom of the stack until the frame ends
+    return (ui.parentCount > 1) ? ui.parents[--ui.parentCount] : TopParent();
+}
+
+struct UI_Interaction UI_InteractionFromWidget(UI_Widget *widget) {
+    struct UI_Interaction interaction = { .widget = widget };
+    if (!(widget->flags & UI_WidgetFlag_Clickable) || UI_KeyMatch(widget->key, UI_KeyNull())) {
+        return interaction;
+    }
+
+    // NOTE: rect is from the previous frame's layout, which is what was on screen when the input happened
+    b8 isActive = UI_KeyMatch(widget->key, ui.active);
+    interaction.hovering = CheckCollisionPointRec(ui.input.mouse, widget->rect);
+    if (interaction.hovering) ui.hot = widget->key;
+
+    if (interaction.hovering && ui.input.mousePressed) {
+        ui.active = widget->key;
+        interaction.pressed = true;
+        isActive = true;
+    }
+
+    if (isActive) {
+        interaction.dragging = ui.input.mouseDown;
+        if (ui.input.mouseReleased) {
+            interaction.released = true;
+            interaction.clicked = interaction.hovering;
+            ui.active = UI_KeyNull();
+        }
+    }
+
+    return interaction;
+}
+
+struct UI_Interaction UI_Button(String8 string) {
+    UI_WidgetFlags flags =
+              UI_WidgetFlag_Clickable
+            | UI_WidgetFlag_DrawBorder
+            | UI_WidgetFlag_DrawText
+            | UI_WidgetFlag_DrawBackground
+            | UI_WidgetFlag_HotAnimation
+            | UI_WidgetFlag_ActiveAnimation
+            ;
+    struct UI_Widget *widget = UI_WidgetMake(flags, string);
+    struct UI_Interaction interaction = UI_InteractionFromWidget(widget);
+    return interaction;
+}
+
+UI_Widget *UI_Label(String8 string) {
+    return UI_WidgetMake(UI_WidgetFlag_DrawText, string);
+}
@@ -0,0 +1,246 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+
+#include "uniform.h"
+
+// ----------------------------------------------------------------------------
+// Internal data
+// ----------------------------------------------------------------------------
+
+enum UniformConstExpr {
+    UNIFORM_CACHE_SLOTS = 1024,         // power of two, open addressing
+    UNIFORM_MAX_VALUE_SIZE = 64,        // a mat4
+    UNIFORM_MAX_FRAME_FIELDS = 16,
+    UNIFORM_MAX_FRAME_SHADERS = 8,
+    UNIFORM_MAX_NAME_LENGTH = 32,
+};
+
+struct UniformSlot {
+    u32 shaderId;
+    int loc;
+    u32 size;                           // 0 until a value is remembered, or after Uniform_Invalidate()
+    b8 used;
+    u8 value[UNIFORM_MAX_VALUE_SIZE];
+};
+
+struct UniformFrameField {
+    char name[UNIFORM_MAX_NAME_LENGTH];
+    int type;
+    u32 size;
+    b8 set;
+    b8 dirty;
+    int locs[UNIFORM_MAX_FRAME_SHADERS];
+    u8 value[UNIFORM_MAX_VALUE_SIZE];
+};
+
+static struct Uniform {
+    struct UniformSlot *slots;
+    b8 fullWarned;
+
+    struct UniformFrameField fields[UNIFORM_MAX_FRAME_FIELDS];
+    u32 fieldCount;
+    Shader shaders[UNIFORM_MAX_FRAME_SHADERS];
+    u32 shaderCount;
+
+    Uniform_Stats frame;                // counters for the frame in progress
+    Uniform_Stats stats;                // last completed frame
+} uniform = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u32 TypeSize(int uniformType) {
+    switch (uniformType) {
+        case SHADER_UNIFORM_VEC2:
+        case SHADER_UNIFORM_IVEC2: return 8;
+        case SHADER_UNIFORM_VEC3:
+        case SHADER_UNIFORM_IVEC3: return 12;
+        case SHADER_UNIFORM_VEC4:
+        case SHADER_UNIFORM_IVEC4: return 16;
+        default: return 4;              // float, int, sampler2d
+    }
+}
+
+// slot for (shader, loc), claimed if it isn't cached yet, NULL when the table is full
+static struct UniformSlot *FindSlot(u32 shaderId, int loc) {
+    if (uniform.slots == NULL) return NULL;
+
+    u32 mask = UNIFORM_CACHE_SLOTS - 1;
+    u32 index = (shaderId * 0x9E3779B1u ^ (u32) loc * 0x85EBCA6Bu) & mask;
+    for (u32 probe = 0; probe < UNIFORM_CACHE_SLOTS; probe++, index = (index + 1) & mask) {
+        struct UniformSlot *slot = &uniform.slots[index];
+        if (!slot->used) {
+            *slot = (struct UniformSlot) { .shaderId = shaderId, .loc = loc, .used = true };
+            return slot;
+        }
+        if (slot->shaderId == shaderId && slot->loc == loc) return slot;
+    }
+
+    if (!uniform.fullWarned) {
+        TraceLog(LOG_WARNING, "UNIFORM: Cache full (%i slots), uploading uncached", UNIFORM_CACHE_SLOTS);
+        uniform.fullWarned = true;
+    }
+    return NULL;
+}
+
+// true when the value differs from the remembered one, which is then replaced
+static b8 Changed(Shader shader, int loc, const void *value, u32 size) {
+    if (size > UNIFORM_MAX_VALUE_SIZE) return true;
+
+    struct UniformSlot *slot = FindSlot(shader.id, loc);
+    if (slot == NULL) return true;
+
+    if (slot->size == size && memcmp(slot->value, value, size) == 0) {
+        uniform.frame.skipped++;
+        uniform.frame.bytesSkipped += size;
+        return false;
+    }
+    slot->size = size;
+    memcpy(slot->value, value, size);
+    return true;
+}
+
+static void CountUpload(u32 size) {
+    uniform.frame.uploads++;
+    uniform.frame.bytesUploaded += size;
+}
+
+// ----------------------------------------------------------------------------
+// Implementation
+// ----------------------------------------------------------------------------
+
+void Uniform_Init(void) {
+    if (uniform.slots != NULL) Uniform_Shutdown();
+    uniform.slots = calloc(UNIFORM_CACHE_SLOTS, sizeof(struct UniformSlot));
+}
+
+void Uniform_Shutdown(void) {
+    free(uniform.slots);
+    memset(&uniform, 0, sizeof(uniform));
+}
+
+void Uniform_Set(Shader shader, int loc, const void *value, int uniformType) {
+    Uniform_SetV(shader, loc, value, uniformType, 1);
+}
+
+void Uniform_SetV(Shader shader, int loc, const void *value, int uniformType, int count) {
+    if (loc < 0) return;
+
+    u32 size = TypeSize(uniformType) * (u32) count;
+    if (!Changed(shader, loc, value, size)) return;
+
+    SetShaderValueV(shader, loc, value, uniformType, count);
+    CountUpload(size);
+}
+
+void Uniform_SetMatrix(Shader shader, int loc, Matrix mat) {
+    if (loc < 0) return;
+    if (!Changed(shader, loc, &mat, sizeof(Matrix))) return;
+
+    SetShaderValueMatrix(shader, loc, mat);
+    CountUpload(sizeof(Matrix));
+}
+
+void Uniform_Invalidate(Shader shader) {
+    if (uniform.slots == NULL) return;
+
+    // keys stay in place so probe chains aren't broken, a zero size never matches
+    for (u32 i = 0; i < UNIFORM_CACHE_SLOTS; i++) {
+        if (uniform.slots[i].used && uniform.slots[i].shaderId == shader.id) {
+            uniform.slots[i].size = 0;
+        }
+    }
+
+    // and the frame block has to send everything again
+    for (u32 i = 0; i < uniform.fieldCount; i++) {
+        uniform.fields[i].dirty = uniform.fields[i].set;
+    }
+}
+
+u32 Uniform_FrameField(const char *name, int uniformType) {
+    for (u32 i = 0; i < uniform.fieldCount; i++) {
+        if (strcmp(uniform.fields[i].name, name) == 0) return i;
+    }
+    if (uniform.fieldCount >= UNIFORM_MAX_FRAME_FIELDS) {
+        TraceLog(LOG_WARNING, "UNIFORM: Frame field limit (%i) reached", UNIFORM_MAX_FRAME_FIELDS);
+        return UNIFORM_MAX_FRAME_FIELDS - 1;
+    }
+
+    u32 index = uniform.fieldCount++;
+    struct UniformFrameField *field = &uniform.fields[index];
+    *field = (struct UniformFrameField) { .type = uniformType, .size = TypeSize(uniformType) };
+    strncpy(field->name, name, UNIFORM_MAX_NAME_LENGTH - 1);
+    for (u32 s = 0; s < uniform.shaderCount; s++) {
+        field->locs[s] = GetShaderLocation(uniform.shaders[s], field->name);
+    }
+    return index;
+}
+
+void Uniform_FrameAttach(Shader shader) {
+    if (uniform.shaderCount >= UNIFORM_MAX_FRAME_SHADERS) {
+        TraceLog(LOG_WARNING, "UNIFORM: Frame shader limit (%i) reached", UNIFORM_MAX_FRAME_SHADERS);
+        return;
+    }
+
+    u32 s = uniform.shaderCount++;
+    uniform.shaders[s] = shader;
+    for (u32 i = 0; i < uniform.fieldCount; i++) {
+        struct UniformFrameField *field = &uniform.fields[i];
+        field->locs[s] = GetShaderLocation(shader, field->name);
+        // the cache skips the shaders that are already up to date
+        field->dirty = field->set;
+    }
+}
+
+void Uniform_FrameDetach(Shader shader) {
+    for (u32 s = 0; s < uniform.shaderCount; s++) {
+        if (uniform.shaders[s].id != shader.id) continue;
+
+        // the last shader takes its place, along with its locations
+        u32 last = --uniform.shaderCount;
+        uniform.shaders[s] = uniform.shaders[last];
+        for (u32 i = 0; i < uniform.fieldCount; i++) {
+            uniform.fields[i].locs[s] = uniform.fields[i].locs[last];
+        }
+        return;
+    }
+}
+
+void Uniform_FrameSet(u32 field, const void *value) {
+    if (field >= uniform.fieldCount) return;
+
+    struct UniformFrameField *f = &uniform.fields[field];
+    if (f->set && memcmp(f->value, value, f->size) == 0) return;
+
+    memcpy(f->value, value, f->size);
+    f->set = true;
+    f->dirty = true;
+}
+
+void Uniform_FrameFlush(void) {
+    for (u32 i = 0; i < uniform.fieldCount; i++) {
+        struct UniformFrameField *field = &uniform.fields[i];
+        if (!field->dirty) continue;
+
+        for (u32 s = 0; s < uniform.shaderCount; s++) {
+            Uniform_Set(uniform.shaders[s], field->locs[s], field->value, field->type);
+        }
+        field->dirty = false;
+    }
+}
+
+void Uniform_EndFrame(void) {
+    uniform.stats = uniform.frame;
+    uniform.stats.cached = 0;
+    for (u32 i = 0; uniform.slots != NULL && i < UNIFORM_CACHE_SLOTS; i++) {
+        uniform.stats.cached += (uniform.slots[i].size > 0);
+    }
+    uniform.frame = (Uniform_Stats) {0};
+}
+
+Uniform_Stats Uniform_GetStats(void) {
+    return uniform.stats;
+}
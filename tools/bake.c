@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+
+#include "common.h"
+#include "job.h"
+#include "level.h"
+#include "lightmap.h"
+#include "thread.h"
+#include "timer.h"
+
+// ----------------------------------------------------------------------------
+// Offline light baker
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - usage: fiddle-bake <output lightmap> [--texels=per unit] [--samples=per texel] [--bounces=count] [--threads=count]
+// - bakes the static level (see level.h) with its lights into a lightmap the game loads at startup (see lightmap.h),
+//   direct light and as many bounces as asked for
+// - atlas rows are baked as jobs, one worker per core besides the main thread unless --threads says otherwise,
+//   the result is the same for any number of threads
+// - no GL context is created, this runs headless as part of the build
+
+enum BakeConstExpr {
+    BAKE_DEFAULT_SAMPLES = 64,
+    BAKE_DEFAULT_BOUNCES = 2,
+    BAKE_ROW_GRAIN = 1,                 // rows cost very different amounts, small jobs keep the workers even
+};
+
+static const f32 BAKE_DEFAULT_TEXELS_PER_UNIT = 2;
+
+static void BakeRows(void *arg, u32 first, u32 end) {
+    Lightmap_Bake(arg, first, end);
+}
+
+// ----------------------------------------------------------------------------
+// Entry point
+// ----------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+    if (argc < 2 || strncmp(argv[1], "--", 2) == 0) {
+        printf("usage: %s <output lightmap> [--texels=per unit] [--samples=per texel] [--bounces=count] [--threads=count]\n",
+               argv[0]);
+        return 1;
+    }
+
+    Lightmap_BakeDesc desc = {
+            .texelsPerUnit = BAKE_DEFAULT_TEXELS_PER_UNIT,
+            .samples = BAKE_DEFAULT_SAMPLES,
+            .bounces = BAKE_DEFAULT_BOUNCES
+    };
+    int threads = Thread_HardwareConcurrency();
+    for (int i = 2; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--texels=", 9) == 0) {
+            desc.texelsPerUnit = strtof(arg + 9, NULL);
+        } else if (strncmp(arg, "--samples=", 10) == 0) {
+            desc.samples = (u32) strtoul(arg + 10, NULL, 10);
+        } else if (strncmp(arg, "--bounces=", 10) == 0) {
+            desc.bounces = (u32) strtoul(arg + 10, NULL, 10);
+        } else if (strncmp(arg, "--threads=", 10) == 0) {
+            threads = atoi(arg + 10);
+        } else {
+            fprintf(stderr, "unknown argument '%s'\n", arg);
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (threads > JOB_MAX_WORKERS + 1) threads = JOB_MAX_WORKERS + 1;
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    static Level_Box boxes[LEVEL_MAX_BOXES];
+    static Cluster_Light lights[LEVEL_MAX_LIGHTS];
+    desc.boxes = boxes;
+    desc.boxCount = Level_StaticBoxes(Level_StartingRoom, boxes, LEVEL_MAX_BOXES);
+    desc.lights = lights;
+    desc.lightCount = Level_StaticLights(lights, LEVEL_MAX_LIGHTS);
+    if (desc.boxCount > LEVEL_MAX_BOXES) desc.boxCount = LEVEL_MAX_BOXES;
+    if (desc.lightCount > LEVEL_MAX_LIGHTS) desc.lightCount = LEVEL_MAX_LIGHTS;
+
+    Lightmap_Baker *baker = Lightmap_BakerCreate(desc);
+    if (baker == NULL) {
+        fprintf(stderr, "couldn't set up the bake, out of memory or nothing to bake\n");
+        return 1;
+    }
+
+    Lightmap_BakeStats stats = Lightmap_GetBakeStats(baker);
+    printf("baking %u boxes, %u lights into %ux%u texels (%u charts), %u samples per texel, %u bounces, %i threads\n",
+           desc.boxCount, desc.lightCount, stats.width, stats.height, stats.charts, desc.samples, desc.bounces, threads);
+
+    Job_Init(threads - 1);
+    f64 start = Timer_Seconds();
+    Job_Counter counter = {0};
+    Job_ParallelFor(BakeRows, baker, Lightmap_BakeRows(baker), BAKE_ROW_GRAIN, &counter);
+    Job_Wait(&counter);
+    f64 seconds = Timer_Seconds() - start;
+    Job_Shutdown();
+
+    b8 saved = Lightmap_BakerSave(baker, argv[1]);
+    stats = Lightmap_GetBakeStats(baker);
+    Lightmap_BakerUnload(baker);
+    if (!saved) {
+        fprintf(stderr, "failed to write '%s'\n", argv[1]);
+        return 1;
+    }
+
+    printf("baked %llu texels into %s in %.2f s\n", (unsigned long long) stats.texels, argv[1], seconds);
+    printf("  %.2f M samples/s, %.2f M rays/s, %.1f rays per sample\n",
+           (f64) stats.samples / seconds / 1e6, (f64) stats.rays / seconds / 1e6,
+           stats.samples ? (f64) stats.rays / (f64) stats.samples : 0);
+    printf("  %.1f KB of lightmap\n", (f64) GetFileLength(argv[1]) / 1024.0);
+
+    return 0;
+}
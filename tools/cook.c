@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+
+#include "common.h"
+#include "glb.h"
+#include "lod.h"
+#include "pack.h"
+#include "timer.h"
+
+// ----------------------------------------------------------------------------
+// Offline model cooker
+// ----------------------------------------------------------------------------
+
+// NOTES
+// - usage: fiddle-cook <input directory> <output pack>
+// - parses every .glb in the directory with the same reader the runtime loader uses
+//   and writes a pack (see pack.h) that can be memory mapped and uploaded as-is
+// - identical decoded textures are stored once, our content shares one atlas across every model
+// - each model's LOD chain (see lod.h) is generated here and stored after its meshes, levels that repeat
+//   the previous one point at the same data
+// - no GL context is created, this runs headless as part of the build
+
+// growable array of plain structs
+#define ARRAY_PUSH(array, count, capacity, value) do {                                      \
+        if ((count) == (capacity)) {                                                        \
+            (capacity) = (capacity) ? (capacity) * 2 : 64;                                  \
+            (array) = realloc((array), (capacity) * sizeof(*(array)));                      \
+            if ((array) == NULL) { fprintf(stderr, "out of memory\n"); exit(1); }           \
+        }                                                                                   \
+        (array)[(count)++] = (value);                                                       \
+    } while (0)
+
+static struct Cooker {
+    Pack_ModelRecord *models;
+    u32 modelCount, modelCapacity;
+    Pack_MeshRecord *meshes;
+    u32 meshCount, meshCapacity;
+    Pack_MaterialRecord *materials;
+    u32 materialCount, materialCapacity;
+    Pack_TextureRecord *textures;
+    u32 textureCount, textureCapacity;
+    u64 *textureHashes;             // parallel to textures
+
+    // everything after the tables, offsets into it are rebased once the table sizes are known
+    u8 *blob;
+    u64 blobSize, blobCapacity;
+
+    u64 sourceBytes;
+    u64 textureBytesSaved;
+    u64 sourceTriangles;
+    u64 lodTriangles;                   // in the lowest level of every model
+} cooker = {0};
+
+// ----------------------------------------------------------------------------
+// Internal helpers
+// ----------------------------------------------------------------------------
+
+static u64 AlignUp(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static u64 HashBytes(const void *data, u64 size) {
+    // FNV-1a, good enough to find candidates, matches are confirmed with memcmp
+    const u8 *bytes = data;
+    u64 hash = 0xcbf29ce484222325ull;
+    for (u64 i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// returns the blob relative offset of the copied data, offset 0 is reserved for "absent"
+static u64 PushBlob(const void *data, u64 size) {
+    if (data == NULL || size == 0) return 0;
+
+    u64 offset = AlignUp(cooker.blobSize, PACK_ALIGNMENT);
+    if (offset == 0) offset = PACK_ALIGNMENT;
+
+    if (offset + size > cooker.blobCapacity) {
+        u64 capacity = cooker.blobCapacity ? cooker.blobCapacity : (1 << 20);
+        while (offset + size > capacity) capacity *= 2;
+        cooker.blob = realloc(cooker.blob, capacity);
+        if (cooker.blob == NULL) { fprintf(stderr, "out of memory\n"); exit(1); }
+        memset(cooker.blob + cooker.blobCapacity, 0, capacity - cooker.blobCapacity);
+        cooker.blobCapacity = capacity;
+    }
+
+    memcpy(cooker.blob + offset, data, size);
+    cooker.blobSize = offset + size;
+    return offset;
+}
+
+static i32 AddTexture(Image image) {
+    if (image.data == NULL) return -1;
+
+    u64 size = (u64) GetPixelDataSize(image.width, image.height, image.format);
+    u64 hash = HashBytes(image.data, size);
+    for (u32 i = 0; i < cooker.textureCount; i++) {
+        const Pack_TextureRecord *existing = &cooker.textures[i];
+        if (cooker.textureHashes[i] == hash && existing->dataSize == size
+            && existing->width == (u32) image.width && existing->height == (u32) image.height
+            && existing->format == (u32) image.format
+            && memcmp(cooker.blob + existing->data, image.data, size) == 0) {
+            cooker.textureBytesSaved += size;
+            return (i32) i;
+        }
+    }
+
+    Pack_TextureRecord record = {
+            .width = (u32) image.width,
+            .height = (u32) image.height,
+            .format = (u32) image.format,
+            .mipmaps = 1,
+            .data = PushBlob(image.data, size),
+            .dataSize = size
+    };
+    u32 textureCapacity = cooker.textureCapacity;
+    ARRAY_PUSH(cooker.textures, cooker.textureCount, cooker.textureCapacity, record);
+    if (cooker.textureCapacity != textureCapacity) {
+        cooker.textureHashes = realloc(cooker.textureHashes, cooker.textureCapacity * sizeof(u64));
+        if (cooker.textureHashes == NULL) { fprintf(stderr, "out of memory\n"); exit(1); }
+    }
+    cooker.textureHashes[cooker.textureCount - 1] = hash;
+    return (i32) cooker.textureCount - 1;
+}
+
+static void AddMesh(const Mesh *mesh, u32 material) {
+    u64 vertexCount = (u64) mesh->vertexCount;
+    Pack_MeshRecord record = {
+            .vertexCount = (u32) mesh->vertexCount,
+            .triangleCount = (u32) mesh->triangleCount,
+            .material = material,
+            .vertices = PushBlob(mesh->vertices, vertexCount * 3 * sizeof(f32)),
+            .texcoords = PushBlob(mesh->texcoords, vertexCount * 2 * sizeof(f32)),
+            .normals = PushBlob(mesh->normals, vertexCount * 3 * sizeof(f32)),
+            .colors = PushBlob(mesh->colors, vertexCount * 4),
+            .indices = PushBlob(mesh->indices, (u64) mesh->triangleCount * 3 * sizeof(u16))
+    };
+    ARRAY_PUSH(cooker.meshes, cooker.meshCount, cooker.meshCapacity, record);
+}
+
+// generated levels are compacted copies, a level that couldn't shrink is an exact copy of the one before
+static b8 SameMesh(const Mesh *a, const Mesh *b) {
+    if (a->vertexCount != b->vertexCount || a->triangleCount != b->triangleCount) return false;
+    if (a->indices == NULL || b->indices == NULL) return false;
+    return memcmp(a->indices, b->indices, (size_t) a->triangleCount * 3 * sizeof(u16)) == 0
+           && memcmp(a->vertices, b->vertices, (size_t) a->vertexCount * 3 * sizeof(f32)) == 0;
+}
+
+static b8 AddModel(const char *fileName) {
+    const char *name = GetFileName(fileName);
+    if (strlen(name) >= PACK_NAME_SIZE) {
+        fprintf(stderr, "  skipping %s, name longer than %u characters\n", fileName, PACK_NAME_SIZE - 1);
+        return false;
+    }
+
+    GLB_ModelData data;
+    if (!GLB_LoadModelData(fileName, &data)) {
+        fprintf(stderr, "  skipping %s, failed to parse\n", fileName);
+        return false;
+    }
+    cooker.sourceBytes += (u64) GetFileLength(fileName);
+
+    Pack_ModelRecord model = {
+            .firstMesh = cooker.meshCount,
+            .meshCount = (u32) data.meshCount,
+            .firstMaterial = cooker.materialCount,
+            .materialCount = (u32) data.materialCount
+    };
+    strcpy(model.name, name);
+    ARRAY_PUSH(cooker.models, cooker.modelCount, cooker.modelCapacity, model);
+
+    for (int i = 0; i < data.meshCount; i++) {
+        AddMesh(&data.meshes[i], (u32) data.meshMaterial[i]);
+        cooker.sourceTriangles += (u64) data.meshes[i].triangleCount;
+    }
+
+    u32 meshCount = (u32) data.meshCount;
+    Mesh *levels = calloc((LOD_MAX_LEVELS - 1) * meshCount + 1, sizeof(Mesh));
+    if (levels == NULL) { fprintf(stderr, "out of memory\n"); exit(1); }
+
+    u32 lodCount = Lod_GenerateLevels(data.meshes, meshCount, levels);
+    cooker.models[cooker.modelCount - 1].lodCount = lodCount;
+    for (u32 l = 0; l < lodCount; l++) {
+        for (u32 i = 0; i < meshCount; i++) {
+            const Mesh *level = &levels[l * meshCount + i];
+            const Mesh *previous = (l > 0) ? &levels[(l - 1) * meshCount + i] : NULL;
+            if (previous != NULL && SameMesh(level, previous)) {
+                // stopped simplifying, share the previous level's data
+                Pack_MeshRecord record = cooker.meshes[cooker.meshCount - meshCount];
+                ARRAY_PUSH(cooker.meshes, cooker.meshCount, cooker.meshCapacity, record);
+            } else {
+                AddMesh(level, (u32) data.meshMaterial[i]);
+            }
+            if (l == lodCount - 1) cooker.lodTriangles += (u64) level->triangleCount;
+        }
+    }
+    if (lodCount == 0) {
+        for (u32 i = 0; i < meshCount; i++) cooker.lodTriangles += (u64) data.meshes[i].triangleCount;
+    }
+
+    for (u32 i = 0; i < lodCount * meshCount; i++) {
+        Lod_FreeMesh(&levels[i]);
+    }
+    free(levels);
+
+    for (int i = 0; i < data.materialCount; i++) {
+        Pack_MaterialRecord record = {
+                .color = data.materials[i].color,
+                .texture = AddTexture(data.materials[i].albedo)
+        };
+        ARRAY_PUSH(cooker.materials, cooker.materialCount, cooker.materialCapacity, record);
+    }
+
+    GLB_UnloadModelData(&data);
+    return true;
+}
+
+static void RebaseOffset(u64 *offset, u64 base) {
+    if (*offset != 0) *offset += base;
+}
+
+static b8 WritePack(const char *fileName) {
+    Pack_Header header = {
+            .magic = PACK_MAGIC,
+            .version = PACK_VERSION,
+            .modelCount = cooker.modelCount,
+            .meshCount = cooker.meshCount,
+            .materialCount = cooker.materialCount,
+            .textureCount = cooker.textureCount
+    };
+    header.modelsOffset = AlignUp(sizeof(Pack_Header), PACK_ALIGNMENT);
+    header.meshesOffset = AlignUp(header.modelsOffset + cooker.modelCount * sizeof(Pack_ModelRecord), PACK_ALIGNMENT);
+    header.materialsOffset = AlignUp(header.meshesOffset + cooker.meshCount * sizeof(Pack_MeshRecord), PACK_ALIGNMENT);
+    header.texturesOffset = AlignUp(header.materialsOffset + cooker.materialCount * sizeof(Pack_MaterialRecord), PACK_ALIGNMENT);
+    u64 blobOffset = AlignUp(header.texturesOffset + cooker.textureCount * sizeof(Pack_TextureRecord), PACK_ALIGNMENT);
+
+    for (u32 i = 0; i < cooker.meshCount; i++) {
+        Pack_MeshRecord *mesh = &cooker.meshes[i];
+        RebaseOffset(&mesh->vertices, blobOffset);
+        RebaseOffset(&mesh->texcoords, blobOffset);
+        RebaseOffset(&mesh->normals, blobOffset);
+        RebaseOffset(&mesh->colors, blobOffset);
+        RebaseOffset(&mesh->indices, blobOffset);
+    }
+    for (u32 i = 0; i < cooker.textureCount; i++) {
+        RebaseOffset(&cooker.textures[i].data, blobOffset);
+    }
+
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) return false;
+
+    // tables are padded out to their aligned offsets with zeros
+    static const u8 padding[PACK_ALIGNMENT] = {0};
+    u64 written = 0;
+#define WRITE_AT(offset, data, size) do {                                       \
+        fwrite(padding, 1, (size_t) ((offset) - written), file);                \
+        fwrite((data), 1, (size_t) (size), file);                               \
+        written = (offset) + (size);                                            \
+    } while (0)
+
+    WRITE_AT(0, &header, sizeof(header));
+    WRITE_AT(header.modelsOffset, cooker.models, cooker.modelCount * sizeof(Pack_ModelRecord));
+    WRITE_AT(header.meshesOffset, cooker.meshes, cooker.meshCount * sizeof(Pack_MeshRecord));
+    WRITE_AT(header.materialsOffset, cooker.materials, cooker.materialCount * sizeof(Pack_MaterialRecord));
+    WRITE_AT(header.texturesOffset, cooker.textures, cooker.textureCount * sizeof(Pack_TextureRecord));
+    WRITE_AT(blobOffset, cooker.blob, cooker.blobSize);
+#undef WRITE_AT
+
+    b8 ok = !ferror(file);
+    ok &= (fclose(file) == 0);
+    return ok;
+}
+
+static int CompareFileNames(const void *a, const void *b) {
+    return strcmp(GetFileName(*(const char **) a), GetFileName(*(const char **) b));
+}
+
+// ----------------------------------------------------------------------------
+// Entry point
+// ----------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        printf("usage: %s <input directory> <output pack>\n", argv[0]);
+        return 1;
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    f64 start = Timer_Seconds();
+
+    FilePathList files = LoadDirectoryFilesEx(argv[1], ".glb", false);
+    if (files.count == 0) {
+        fprintf(stderr, "no .glb files found in '%s'\n", argv[1]);
+        UnloadDirectoryFiles(files);
+        return 1;
+    }
+
+    // the runtime binary searches model records by name
+    qsort(files.paths, files.count, sizeof(char *), CompareFileNames);
+
+    int failed = 0;
+    for (u32 i = 0; i < files.count; i++) {
+        if (i > 0 && strcmp(GetFileName(files.paths[i - 1]), GetFileName(files.paths[i])) == 0) {
+            fprintf(stderr, "  skipping %s, duplicate name\n", files.paths[i]);
+            failed++;
+            continue;
+        }
+        if (!AddModel(files.paths[i])) failed++;
+    }
+    UnloadDirectoryFiles(files);
+
+    if (!WritePack(argv[2])) {
+        fprintf(stderr, "failed to write '%s'\n", argv[2]);
+        return 1;
+    }
+
+    printf("cooked %u models (%i skipped) into %s in %.2f s\n", cooker.modelCount, failed, argv[2], Timer_Seconds() - start);
+    printf("  %u meshes, %u materials, %u unique textures (%.1f MB of duplicate pixels dropped)\n",
+           cooker.meshCount, cooker.materialCount, cooker.textureCount, (f64) cooker.textureBytesSaved / (1024.0 * 1024.0));
+    printf("  %llu triangles, %llu in the lowest LODs\n",
+           (unsigned long long) cooker.sourceTriangles, (unsigned long long) cooker.lodTriangles);
+    printf("  %.1f MB of .glb in, %.1f MB of pack out\n",
+           (f64) cooker.sourceBytes / (1024.0 * 1024.0), (f64) GetFileLength(argv[2]) / (1024.0 * 1024.0));
+
+    return (failed > 0) ? 1 : 0;
+}